@@ -1,7 +1,7 @@
 # ARM64 Architecture Configuration
 # Author: Fedi Nabli
 # Date: 26 Feb 2025
-# Last Modified: 26 Feb 2025
+# Last Modified: 18 Oct 2026
 
 # Target Architecture
 ARCH := arm64
@@ -11,8 +11,9 @@ CPU := cortex-a53
 ASFLAGS := -mcpu=$(CPU) -g
 
 # Architecture specific compiler flags
-# For bare-metal development with aarch64-linux-gnu toolchain
-ARCH_CFLAGS := -mcpu=$(CPU) -mgeneral-regs-only -mno-outline-atomics
+# For bare-metal development with aarch64-linux-gnu toolchain. Tensor
+# kernels use FP/SIMD, its state is saved on exceptions and task switches
+ARCH_CFLAGS := -mcpu=$(CPU) -mno-outline-atomics
 
 # Boot info magic number
 BOOT_INFO_MAGIC := 0x424F4F54
@@ -22,4 +23,4 @@ CFLAGS += -DBOOT_INFO_MAGIC=$(BOOT_INFO_MAGIC)
 ARCH_INCLUDES := -I$(CURDIR)/arch/$(ARCH)/includes
 
 # Export architecture flags
-CFLAGS += $(AACH_CFLAGS) $(ARCH_INCLUDES)
\ No newline at end of file
+CFLAGS += $(ARCH_CFLAGS) $(ARCH_INCLUDES)
\ No newline at end of file
@@ -6,7 +6,7 @@
  * 
  * Author: Fedi Nabli
  * Date: 26 Feb 2025
- * Last Modified: 26 Feb 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __BOOT_INFO_
@@ -34,6 +34,7 @@ typedef struct
   uint64_t architecture; // Architecture version
   uint64_t ram_size; // Total RAM size
   uint64_t kernel_size; // Size of kernel image
+  uint64_t dtb_address; // Device tree blob address, 0 if none
 } boot_info_t;
 
 #ifdef __cplusplus
@@ -0,0 +1,45 @@
+/*
+ * pmu.h - Performance Monitor Unit definitions for AArch64 ArmV8
+ *
+ * This header defines the PMU event numbers and the assembly helpers
+ * used by kernel benchmarks to count cycles and cache refills.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __ARM_PMU_H_
+#define __ARM_PMU_H_
+
+#include <synapse/types.h>
+
+/* Number of event counters we use (Cortex-A53 implements 6) */
+#define PMU_MAX_EVENT_COUNTERS  6
+
+/* Common architectural events (ARMv8-A, Cortex-A53 TRM 12.9) */
+#define PMU_EVENT_SW_INCR           0x00 // Software increment
+#define PMU_EVENT_L1I_CACHE_REFILL  0x01 // L1 instruction cache refill
+#define PMU_EVENT_L1D_CACHE_REFILL  0x03 // L1 data cache refill
+#define PMU_EVENT_L1D_CACHE         0x04 // L1 data cache access
+#define PMU_EVENT_INST_RETIRED      0x08 // Instruction architecturally executed
+#define PMU_EVENT_BR_MIS_PRED       0x10 // Mispredicted branch
+#define PMU_EVENT_CPU_CYCLES        0x11 // Cycle
+#define PMU_EVENT_L2D_CACHE         0x16 // L2 data cache access
+#define PMU_EVENT_L2D_CACHE_REFILL  0x17 // L2 data cache refill
+
+/* PMCR_EL0 bits */
+#define PMU_PMCR_E  (1 << 0) // Enable all counters
+#define PMU_PMCR_P  (1 << 1) // Reset event counters
+#define PMU_PMCR_C  (1 << 2) // Reset cycle counter
+
+/* PMCNTENSET_EL0 cycle counter bit */
+#define PMU_CYCLE_COUNTER_BIT (1UL << 31)
+
+void pmu_init();
+void pmu_config_event(uint32_t counter, uint32_t event);
+void pmu_reset_counters();
+uint64_t pmu_read_counter(uint32_t counter);
+uint64_t pmu_read_cycles();
+
+#endif
@@ -6,7 +6,7 @@
  *
  * Author: Fedi Nabli
  * Date: 25 Feb 2025
- * Last Modified: 25 Feb 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __BOOT_UART_H_
@@ -41,6 +41,7 @@ extern "C" {
 #endif
 
 void uart_init(void);
+void uart_set_base(unsigned long base);
 void uart_send_char(char c);
 void uart_send_string(const char* str);
 
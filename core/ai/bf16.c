@@ -0,0 +1,556 @@
+/*
+ * bf16.c - This file implements the BFLOAT16 conversions and kernels.
+ * BF16 tensors are loaded into FP32 registers, accumulated in FP32
+ * and optionally rounded back to BF16 on store.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "bf16.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/scheduler/preempt.h>
+
+// BF16 GEMM test configuration (M x K by K x N)
+#define BF16_TEST_M 6
+#define BF16_TEST_K 40
+#define BF16_TEST_N 18
+
+// 4 BF16 values, half a NEON register, only element aligned
+typedef uint16_t v4u16 __attribute__((vector_size(8), aligned(2)));
+// 4 FP32 bit patterns, one NEON register
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+// 4 floats, one NEON register, only element aligned
+typedef float v4f __attribute__((vector_size(16), aligned(4)));
+
+// FLOAT32 and its bit pattern
+typedef union
+{
+  float f;
+  uint32_t u;
+} bf16_bits_t;
+
+/**
+ * @brief Convert a FLOAT32 value to BF16, round to nearest even
+ * 
+ * @param value FLOAT32 value
+ * @return uint16_t BF16 bits, NaN stays a (quiet) NaN
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint16_t ai_bf16_from_f32(float value)
+{
+  bf16_bits_t bits = { .f = value };
+
+  // Truncating could turn a NaN with only low mantissa bits into infinity
+  if ((bits.u & 0x7FFFFFFF) > 0x7F800000)
+  {
+    return (uint16_t)((bits.u >> 16) | 0x0040);
+  }
+
+  // Add just under half an ulp, plus one when the kept lsb is odd
+  bits.u += 0x7FFF + ((bits.u >> 16) & 1);
+  return (uint16_t)(bits.u >> 16);
+}
+
+/**
+ * @brief Convert a BF16 value to FLOAT32 (exact)
+ * 
+ * @param value BF16 bits
+ * @return float FLOAT32 value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float ai_bf16_to_f32(uint16_t value)
+{
+  bf16_bits_t bits = { .u = (uint32_t)value << 16 };
+  return bits.f;
+}
+
+/**
+ * @brief Check that a tensor can be used by the kernels
+ * 
+ * @param tensor Tensor to check
+ * @return bool true for a dense FLOAT32 or BFLOAT16 tensor
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool bf16_is_operand(tensor_t* tensor)
+{
+  return tensor && tensor->data && !tensor->sparse &&
+         (tensor->dtype == TENSOR_TYPE_FLOAT32 || tensor->dtype == TENSOR_TYPE_BFLOAT16);
+}
+
+/**
+ * @brief Get the number of elements of a tensor
+ * 
+ * @param tensor Tensor
+ * @return size_t Number of elements
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t bf16_elems(tensor_t* tensor)
+{
+  size_t elems = 1;
+  for (size_t i = 0; i < tensor->ndim; i++)
+  {
+    elems *= tensor->shape[i];
+  }
+
+  return elems;
+}
+
+/**
+ * @brief Load one element as FLOAT32
+ * 
+ * @param data Tensor data
+ * @param is_bf16 true if the data is BFLOAT16
+ * @param index Element index
+ * @return float Element value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline float bf16_load(const void* data, bool is_bf16, size_t index)
+{
+  if (is_bf16)
+  {
+    return ai_bf16_to_f32(((const uint16_t*)data)[index]);
+  }
+
+  return ((const float*)data)[index];
+}
+
+/**
+ * @brief Store one FLOAT32 value
+ * 
+ * @param data Tensor data
+ * @param is_bf16 true if the data is BFLOAT16, the value is rounded
+ * @param index Element index
+ * @param value Value to store
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void bf16_store(void* data, bool is_bf16, size_t index, float value)
+{
+  if (is_bf16)
+  {
+    ((uint16_t*)data)[index] = ai_bf16_from_f32(value);
+    return;
+  }
+
+  ((float*)data)[index] = value;
+}
+
+/**
+ * @brief Load four elements into a FLOAT32 register, BF16 is widened
+ * with a shift into the upper half of each lane
+ * 
+ * @param data Tensor data
+ * @param is_bf16 true if the data is BFLOAT16
+ * @param index Index of the first element
+ * @return v4f Element values
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f bf16_load4(const void* data, bool is_bf16, size_t index)
+{
+  if (is_bf16)
+  {
+    v4u16 half = *(const v4u16*)((const uint16_t*)data + index);
+    return (v4f)(__builtin_convertvector(half, v4u32) << 16);
+  }
+
+  return *(const v4f*)((const float*)data + index);
+}
+
+/**
+ * @brief Store four FLOAT32 values, BF16 is rounded to nearest even
+ * 
+ * @param data Tensor data
+ * @param is_bf16 true if the data is BFLOAT16
+ * @param index Index of the first element
+ * @param value Values to store
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void bf16_store4(void* data, bool is_bf16, size_t index, v4f value)
+{
+  if (!is_bf16)
+  {
+    *(v4f*)((float*)data + index) = value;
+    return;
+  }
+
+  v4u32 bits = (v4u32)value;
+  v4u32 rounded = (bits + 0x7FFF + ((bits >> 16) & 1)) >> 16;
+  v4u32 nan = (v4u32)((bits & 0x7FFFFFFF) > 0x7F800000);
+  v4u32 result = (rounded & ~nan) | (((bits >> 16) | 0x0040) & nan);
+
+  *(v4u16*)((uint16_t*)data + index) = __builtin_convertvector(result, v4u16);
+}
+
+/**
+ * @brief Convert a tensor between FLOAT32 and BFLOAT16 (either direction)
+ * 
+ * @param src Source tensor
+ * @param dst Destination tensor with the same number of elements
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_bf16_convert(tensor_t* src, tensor_t* dst)
+{
+  if (!bf16_is_operand(src) || !bf16_is_operand(dst) || bf16_elems(src) != bf16_elems(dst))
+  {
+    return -EINVARG;
+  }
+
+  bool src_bf16 = src->dtype == TENSOR_TYPE_BFLOAT16;
+  bool dst_bf16 = dst->dtype == TENSOR_TYPE_BFLOAT16;
+  size_t elems = bf16_elems(src);
+  size_t i = 0;
+
+  for (; i + 4 <= elems; i += 4)
+  {
+    bf16_store4(dst->data, dst_bf16, i, bf16_load4(src->data, src_bf16, i));
+  }
+
+  // Remaining elements
+  for (; i < elems; i++)
+  {
+    bf16_store(dst->data, dst_bf16, i, bf16_load(src->data, src_bf16, i));
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Matrix product C = A x B with FP32 accumulation
+ * 
+ * Each output row is accumulated in an FP32 scratch row as a sum of
+ * rows of B scaled by A, so B is read sequentially and only rounded
+ * once when C is BFLOAT16.
+ * 
+ * @param a Left operand
+ * @param b Right operand
+ * @param c Output
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_bf16_gemm(tensor_t* a, tensor_t* b, tensor_t* c)
+{
+  if (!bf16_is_operand(a) || !bf16_is_operand(b) || !bf16_is_operand(c) ||
+      a->ndim != 2 || b->ndim != 2 || c->ndim != 2 || c->data == a->data || c->data == b->data)
+  {
+    return -EINVARG;
+  }
+
+  size_t m = a->shape[0];
+  size_t k = a->shape[1];
+  size_t n = b->shape[1];
+  if (b->shape[0] != k || c->shape[0] != m || c->shape[1] != n)
+  {
+    return -EINVARG;
+  }
+
+  float* acc = (float*)kmalloc(n * sizeof(float));
+  if (!acc)
+  {
+    return -ENOMEM;
+  }
+
+  bool a_bf16 = a->dtype == TENSOR_TYPE_BFLOAT16;
+  bool b_bf16 = b->dtype == TENSOR_TYPE_BFLOAT16;
+  bool c_bf16 = c->dtype == TENSOR_TYPE_BFLOAT16;
+
+  for (size_t i = 0; i < m; i++)
+  {
+    memset(acc, 0, n * sizeof(float));
+
+    for (size_t p = 0; p < k; p++)
+    {
+      float a_val = bf16_load(a->data, a_bf16, (i * k) + p);
+      v4f a_vec = { a_val, a_val, a_val, a_val };
+      size_t b_row = p * n;
+      size_t j = 0;
+
+      for (; j + 4 <= n; j += 4)
+      {
+        *(v4f*)(acc + j) += a_vec * bf16_load4(b->data, b_bf16, b_row + j);
+      }
+
+      // Remaining columns
+      for (; j < n; j++)
+      {
+        acc[j] += a_val * bf16_load(b->data, b_bf16, b_row + j);
+      }
+    }
+
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4)
+    {
+      bf16_store4(c->data, c_bf16, (i * n) + j, *(v4f*)(acc + j));
+    }
+
+    for (; j < n; j++)
+    {
+      bf16_store(c->data, c_bf16, (i * n) + j, acc[j]);
+    }
+
+    cond_resched();
+  }
+
+  kfree(acc);
+  return EOK;
+}
+
+/**
+ * @brief Elementwise operation computed in FP32
+ * 
+ * @param op Operation
+ * @param a First operand
+ * @param b Second operand
+ * @param c Output, FLOAT32 or BFLOAT16 (rounded on store)
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_bf16_elementwise(bf16_op_t op, tensor_t* a, tensor_t* b, tensor_t* c)
+{
+  if (op >= BF16_OP_COUNT || !bf16_is_operand(a) || !bf16_is_operand(b) || !bf16_is_operand(c))
+  {
+    return -EINVARG;
+  }
+
+  size_t elems = bf16_elems(a);
+  if (bf16_elems(b) != elems || bf16_elems(c) != elems)
+  {
+    return -EINVARG;
+  }
+
+  bool a_bf16 = a->dtype == TENSOR_TYPE_BFLOAT16;
+  bool b_bf16 = b->dtype == TENSOR_TYPE_BFLOAT16;
+  bool c_bf16 = c->dtype == TENSOR_TYPE_BFLOAT16;
+  size_t i = 0;
+
+  for (; i + 4 <= elems; i += 4)
+  {
+    v4f x = bf16_load4(a->data, a_bf16, i);
+    v4f y = bf16_load4(b->data, b_bf16, i);
+    v4f r;
+
+    switch (op)
+    {
+      case BF16_OP_ADD:
+        r = x + y;
+        break;
+      case BF16_OP_SUB:
+        r = x - y;
+        break;
+      default:
+        r = x * y;
+        break;
+    }
+
+    bf16_store4(c->data, c_bf16, i, r);
+  }
+
+  // Remaining elements
+  for (; i < elems; i++)
+  {
+    float x = bf16_load(a->data, a_bf16, i);
+    float y = bf16_load(b->data, b_bf16, i);
+    float r;
+
+    switch (op)
+    {
+      case BF16_OP_ADD:
+        r = x + y;
+        break;
+      case BF16_OP_SUB:
+        r = x - y;
+        break;
+      default:
+        r = x * y;
+        break;
+    }
+
+    bf16_store(c->data, c_bf16, i, r);
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Absolute value of a float
+ * 
+ * @param value Value
+ * @return float Absolute value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static float bf16_test_fabs(float value)
+{
+  return value < 0 ? -value : value;
+}
+
+/**
+ * @brief Test BF16 tensors: round to nearest even conversion, FP32 range,
+ * GEMM with FP32 and BF16 output and elementwise operations
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int bf16_test()
+{
+  size_t a_shape[2] = { BF16_TEST_M, BF16_TEST_K };
+  size_t b_shape[2] = { BF16_TEST_K, BF16_TEST_N };
+  size_t c_shape[2] = { BF16_TEST_M, BF16_TEST_N };
+  int res = EOK;
+
+  uart_send_string("\n=== Testing BF16 Tensors ===\n");
+
+  tensor_t* a = ai_tensor_create(a_shape, 2, TENSOR_TYPE_BFLOAT16, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* b = ai_tensor_create(b_shape, 2, TENSOR_TYPE_BFLOAT16, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* c32 = ai_tensor_create(c_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* c16 = ai_tensor_create(c_shape, 2, TENSOR_TYPE_BFLOAT16, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* sum = ai_tensor_create(c_shape, 2, TENSOR_TYPE_BFLOAT16, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  if (!a || !b || !c32 || !c16 || !sum)
+  {
+    uart_send_string("FAIL: Tensor creation failed\n");
+    res = -ENOMEM;
+    goto out;
+  }
+
+  if (ai_tensor_get_size(a) != BF16_TEST_M * BF16_TEST_K * 2)
+  {
+    uart_send_string("FAIL: BF16 tensor is not 2 bytes per element\n");
+    res = -EIO;
+    goto out;
+  }
+
+  // 1 + 2^-8 is halfway between 1 and the next BF16 value, ties go to even
+  if (ai_bf16_from_f32(1.00390625f) != 0x3F80 || ai_bf16_from_f32(1.01171875f) != 0x3F82 ||
+      ai_bf16_from_f32(1.0f) != 0x3F80 || ai_bf16_from_f32(-2.0f) != 0xC000)
+  {
+    uart_send_string("FAIL: Round to nearest even\n");
+    res = -EIO;
+    goto out;
+  }
+
+  // FP32 range survives, NaN stays NaN
+  float large = ai_bf16_to_f32(ai_bf16_from_f32(3.0e38f));
+  uint16_t nan = ai_bf16_from_f32(ai_bf16_to_f32(0x7FC0));
+  if (large < 2.98e38f || large > 3.02e38f || (nan & 0x7F80) != 0x7F80 || (nan & 0x007F) == 0)
+  {
+    uart_send_string("FAIL: BF16 range or NaN\n");
+    res = -EIO;
+    goto out;
+  }
+
+  uint16_t* a_data = (uint16_t*)a->data;
+  uint16_t* b_data = (uint16_t*)b->data;
+  for (size_t i = 0; i < BF16_TEST_M * BF16_TEST_K; i++)
+  {
+    a_data[i] = ai_bf16_from_f32((float)((int)(i % 13) - 6) / 3);
+  }
+
+  for (size_t i = 0; i < BF16_TEST_K * BF16_TEST_N; i++)
+  {
+    b_data[i] = ai_bf16_from_f32((float)((int)(i % 7) - 3) / 5);
+  }
+
+  res = ai_bf16_gemm(a, b, c32);
+  if (res == EOK)
+  {
+    res = ai_bf16_gemm(a, b, c16);
+  }
+  if (res != EOK)
+  {
+    uart_send_string("FAIL: BF16 GEMM failed\n");
+    goto out;
+  }
+
+  float* c32_data = (float*)c32->data;
+  uint16_t* c16_data = (uint16_t*)c16->data;
+  for (size_t i = 0; i < BF16_TEST_M; i++)
+  {
+    for (size_t j = 0; j < BF16_TEST_N; j++)
+    {
+      float expected = 0;
+      for (size_t k = 0; k < BF16_TEST_K; k++)
+      {
+        expected += ai_bf16_to_f32(a_data[(i * BF16_TEST_K) + k]) * ai_bf16_to_f32(b_data[(k * BF16_TEST_N) + j]);
+      }
+
+      // FP32 accumulation, the BF16 output is that result rounded once
+      size_t index = (i * BF16_TEST_N) + j;
+      if (bf16_test_fabs(c32_data[index] - expected) > 0.0001f * (1 + bf16_test_fabs(expected)) ||
+          c16_data[index] != ai_bf16_from_f32(c32_data[index]))
+      {
+        uart_send_string("FAIL: BF16 GEMM result mismatch\n");
+        res = -EIO;
+        goto out;
+      }
+    }
+  }
+
+  res = ai_bf16_elementwise(BF16_OP_ADD, c16, c32, sum);
+  if (res != EOK)
+  {
+    uart_send_string("FAIL: BF16 elementwise failed\n");
+    goto out;
+  }
+
+  uint16_t* sum_data = (uint16_t*)sum->data;
+  for (size_t i = 0; i < BF16_TEST_M * BF16_TEST_N; i++)
+  {
+    if (sum_data[i] != ai_bf16_from_f32(ai_bf16_to_f32(c16_data[i]) + c32_data[i]))
+    {
+      uart_send_string("FAIL: BF16 elementwise result mismatch\n");
+      res = -EIO;
+      goto out;
+    }
+  }
+
+  uart_send_string("BF16 tests PASSED\n");
+
+out:
+  if (a)
+    ai_tensor_destroy(a);
+  if (b)
+    ai_tensor_destroy(b);
+  if (c32)
+    ai_tensor_destroy(c32);
+  if (c16)
+    ai_tensor_destroy(c16);
+  if (sum)
+    ai_tensor_destroy(sum);
+
+  return res;
+}
@@ -0,0 +1,916 @@
+/*
+ * detect.c - This file implements the object detection post-processing
+ * kernels. Thresholding compacts surviving anchor indices, top-k keeps
+ * a min-heap of the best candidates and NMS compares each candidate with
+ * the kept boxes four at a time, stopping at the first overlap.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "detect.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/scheduler/preempt.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// 4 floats, one NEON register, only element aligned
+typedef float v4f __attribute__((vector_size(16), aligned(4)));
+// 4 lane masks or class ids, one NEON register
+typedef int32_t v4i __attribute__((vector_size(16)));
+
+// Benchmark configuration
+#define DETECT_BENCH_ANCHORS 10000
+#define DETECT_BENCH_CLASSES 8
+#define DETECT_BENCH_OBJECTS 64     // Clusters the anchors gather around
+#define DETECT_BENCH_IMAGE 640      // Square image side, in pixels
+#define DETECT_BENCH_SCORE 0.25f
+#define DETECT_BENCH_TOP_K 1000
+#define DETECT_BENCH_IOU 0.45f
+#define DETECT_BENCH_MAX_OUT 100
+
+// Kept boxes, one array per coordinate so four boxes load as one vector
+typedef struct detect_kept
+{
+  float* x1;
+  float* y1;
+  float* x2;
+  float* y2;
+  float* area;
+  int32_t* class_id;
+} detect_kept_t;
+
+// Detection test configuration (random anchors for the top-k check)
+#define DETECT_TEST_ANCHORS 1001
+#define DETECT_TEST_TOP_K 50
+
+/**
+ * @brief Check that a tensor is dense with the given type
+ * 
+ * @param tensor Tensor to check
+ * @param dtype Expected type
+ * @return bool true if the tensor can be used by the kernels
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool detect_is_operand(tensor_t* tensor, tensor_dtype_t dtype)
+{
+  return tensor && tensor->data && !tensor->sparse && tensor->dtype == dtype;
+}
+
+/**
+ * @brief Get the number of elements of a tensor
+ * 
+ * @param tensor Tensor
+ * @return size_t Number of elements
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t detect_elems(tensor_t* tensor)
+{
+  size_t elems = 1;
+  for (size_t i = 0; i < tensor->ndim; i++)
+  {
+    elems *= tensor->shape[i];
+  }
+
+  return elems;
+}
+
+/**
+ * @brief Lane-wise maximum
+ * 
+ * @param a First operand
+ * @param b Second operand
+ * @return v4f Maximum of each lane
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f detect_max4(v4f a, v4f b)
+{
+  v4i take_a = a > b;
+  return (v4f)(((v4i)a & take_a) | ((v4i)b & ~take_a));
+}
+
+/**
+ * @brief Lane-wise minimum
+ * 
+ * @param a First operand
+ * @param b Second operand
+ * @return v4f Minimum of each lane
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f detect_min4(v4f a, v4f b)
+{
+  v4i take_a = a < b;
+  return (v4f)(((v4i)a & take_a) | ((v4i)b & ~take_a));
+}
+
+/**
+ * @brief Check if a candidate ranks before another, ties go to the
+ * lower anchor so results do not depend on the scan order
+ * 
+ * @param scores Scores
+ * @param a First anchor
+ * @param b Second anchor
+ * @return bool true if a ranks before b
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool detect_better(const float* scores, int32_t a, int32_t b)
+{
+  return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+}
+
+/**
+ * @brief Restore the min-heap order below a node, the worst candidate
+ * sits at the root
+ * 
+ * @param scores Scores
+ * @param heap Heap of anchor indices
+ * @param size Heap size
+ * @param node Node to sift down
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void detect_sift_down(const float* scores, int32_t* heap, size_t size, size_t node)
+{
+  while (true)
+  {
+    size_t worst = node;
+    size_t left = (node * 2) + 1;
+    size_t right = left + 1;
+
+    if (left < size && detect_better(scores, heap[worst], heap[left]))
+    {
+      worst = left;
+    }
+
+    if (right < size && detect_better(scores, heap[worst], heap[right]))
+    {
+      worst = right;
+    }
+
+    if (worst == node)
+    {
+      return;
+    }
+
+    int32_t temp = heap[node];
+    heap[node] = heap[worst];
+    heap[worst] = temp;
+    node = worst;
+  }
+}
+
+/**
+ * @brief Keep the best class of every anchor
+ * 
+ * @param class_scores FLOAT32 scores, N x C
+ * @param scores FLOAT32 output, N elements
+ * @param classes INT32 output, N elements
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_best_class(tensor_t* class_scores, tensor_t* scores, tensor_t* classes)
+{
+  if (!detect_is_operand(class_scores, TENSOR_TYPE_FLOAT32) || !detect_is_operand(scores, TENSOR_TYPE_FLOAT32) ||
+      !detect_is_operand(classes, TENSOR_TYPE_INT32) || class_scores->ndim != 2)
+  {
+    return -EINVARG;
+  }
+
+  size_t anchors = class_scores->shape[0];
+  size_t class_count = class_scores->shape[1];
+  if (class_count == 0 || detect_elems(scores) != anchors || detect_elems(classes) != anchors)
+  {
+    return -EINVARG;
+  }
+
+  const float* in = (const float*)class_scores->data;
+  float* best_score = (float*)scores->data;
+  int32_t* best_class = (int32_t*)classes->data;
+
+  for (size_t i = 0; i < anchors; i++)
+  {
+    const float* row = in + (i * class_count);
+    float best = row[0];
+    int32_t best_id = 0;
+
+    for (size_t c = 1; c < class_count; c++)
+    {
+      if (row[c] > best)
+      {
+        best = row[c];
+        best_id = (int32_t)c;
+      }
+    }
+
+    best_score[i] = best;
+    best_class[i] = best_id;
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Compact the indices of the anchors scoring above a threshold
+ * 
+ * @param scores FLOAT32 scores, N elements
+ * @param threshold Lowest score kept (exclusive)
+ * @param indices INT32 output of at least N elements
+ * @param count Output for the number of survivors
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_threshold(tensor_t* scores, float threshold, tensor_t* indices, size_t* count)
+{
+  if (!detect_is_operand(scores, TENSOR_TYPE_FLOAT32) || !detect_is_operand(indices, TENSOR_TYPE_INT32) || !count)
+  {
+    return -EINVARG;
+  }
+
+  size_t elems = detect_elems(scores);
+  if (detect_elems(indices) < elems)
+  {
+    return -EINVARG;
+  }
+
+  const float* in = (const float*)scores->data;
+  int32_t* out = (int32_t*)indices->data;
+  v4f limit = { threshold, threshold, threshold, threshold };
+  size_t kept = 0;
+  size_t i = 0;
+
+  for (; i + 4 <= elems; i += 4)
+  {
+    // Lanes are -1 where the score passes, NaN never does
+    v4i pass = *(const v4f*)(in + i) > limit;
+    if ((pass[0] | pass[1] | pass[2] | pass[3]) == 0)
+    {
+      continue;
+    }
+
+    // Branchless compaction, a slot is overwritten unless its lane passed
+    out[kept] = (int32_t)i;
+    kept -= pass[0];
+    out[kept] = (int32_t)i + 1;
+    kept -= pass[1];
+    out[kept] = (int32_t)i + 2;
+    kept -= pass[2];
+    out[kept] = (int32_t)i + 3;
+    kept -= pass[3];
+  }
+
+  for (; i < elems; i++)
+  {
+    if (in[i] > threshold)
+    {
+      out[kept++] = (int32_t)i;
+    }
+  }
+
+  *count = kept;
+  return EOK;
+}
+
+/**
+ * @brief Move the k best candidates to the front, by decreasing score
+ * 
+ * @param scores FLOAT32 scores, N elements
+ * @param indices INT32 candidate indices into scores, sorted in place
+ * @param count Number of candidates
+ * @param k Candidates to keep
+ * @param out_count Output for min(k, count)
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_top_k(tensor_t* scores, tensor_t* indices, size_t count, size_t k, size_t* out_count)
+{
+  if (!detect_is_operand(scores, TENSOR_TYPE_FLOAT32) || !detect_is_operand(indices, TENSOR_TYPE_INT32) ||
+      !out_count || count > detect_elems(indices))
+  {
+    return -EINVARG;
+  }
+
+  const float* s = (const float*)scores->data;
+  int32_t* idx = (int32_t*)indices->data;
+  size_t elems = detect_elems(scores);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    if (idx[i] < 0 || (size_t)idx[i] >= elems)
+    {
+      return -EINVARG;
+    }
+  }
+
+  if (k > count)
+  {
+    k = count;
+  }
+
+  // Min-heap of the k best so far, its root is the candidate to evict
+  for (size_t i = k / 2; i-- > 0;)
+  {
+    detect_sift_down(s, idx, k, i);
+  }
+
+  for (size_t i = k; i < count && k > 0; i++)
+  {
+    if (detect_better(s, idx[i], idx[0]))
+    {
+      int32_t temp = idx[0];
+      idx[0] = idx[i];
+      idx[i] = temp;
+      detect_sift_down(s, idx, k, 0);
+    }
+  }
+
+  // Heap sort: the worst goes to the back, leaving the best first
+  for (size_t end = k; end > 1; end--)
+  {
+    int32_t temp = idx[0];
+    idx[0] = idx[end - 1];
+    idx[end - 1] = temp;
+    detect_sift_down(s, idx, end - 1, 0);
+  }
+
+  *out_count = k;
+  return EOK;
+}
+
+/**
+ * @brief Non-maximum suppression over candidates sorted by decreasing
+ * score, kept candidates are moved to the front
+ * 
+ * @param boxes FLOAT32 boxes, N x DETECT_BOX_COORDS (x1, y1, x2, y2)
+ * @param classes INT32 class per anchor, N elements, NULL to ignore classes
+ * @param indices INT32 candidate indices into boxes, compacted in place
+ * @param count Number of candidates
+ * @param iou_threshold Overlap above which the weaker box is suppressed
+ * @param max_out Most boxes kept
+ * @param out_count Output for the number of boxes kept
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_nms(tensor_t* boxes, tensor_t* classes, tensor_t* indices, size_t count, float iou_threshold,
+                  size_t max_out, size_t* out_count)
+{
+  if (!detect_is_operand(boxes, TENSOR_TYPE_FLOAT32) || !detect_is_operand(indices, TENSOR_TYPE_INT32) ||
+      !out_count || boxes->ndim != 2 || boxes->shape[1] != DETECT_BOX_COORDS || count > detect_elems(indices))
+  {
+    return -EINVARG;
+  }
+
+  size_t anchors = boxes->shape[0];
+  if (classes && (!detect_is_operand(classes, TENSOR_TYPE_INT32) || detect_elems(classes) != anchors))
+  {
+    return -EINVARG;
+  }
+
+  const float* box = (const float*)boxes->data;
+  const int32_t* cls = classes ? (const int32_t*)classes->data : NULL;
+  int32_t* idx = (int32_t*)indices->data;
+
+  size_t capacity = max_out < count ? max_out : count;
+  *out_count = 0;
+  if (capacity == 0)
+  {
+    return EOK;
+  }
+
+  // One block for the six arrays, each rounded up to whole vectors
+  size_t stride = (capacity + 3) & ~(size_t)3;
+  float* scratch = (float*)kmalloc(6 * stride * sizeof(float));
+  if (!scratch)
+  {
+    return -ENOMEM;
+  }
+
+  detect_kept_t kept = {
+    scratch, scratch + stride, scratch + (2 * stride), scratch + (3 * stride), scratch + (4 * stride),
+    (int32_t*)(scratch + (5 * stride))
+  };
+
+  const v4i lanes = { 0, 1, 2, 3 };
+  v4f thr = { iou_threshold, iou_threshold, iou_threshold, iou_threshold };
+  size_t kept_count = 0;
+
+  for (size_t i = 0; i < count && kept_count < capacity; i++)
+  {
+    int32_t anchor = idx[i];
+    if (anchor < 0 || (size_t)anchor >= anchors)
+    {
+      kfree(scratch);
+      return -EINVARG;
+    }
+
+    const float* b = box + ((size_t)anchor * DETECT_BOX_COORDS);
+    float w = b[DETECT_BOX_X2] - b[DETECT_BOX_X1];
+    float h = b[DETECT_BOX_Y2] - b[DETECT_BOX_Y1];
+    float area = w > 0 && h > 0 ? w * h : 0;
+    int32_t class_id = cls ? cls[anchor] : 0;
+
+    v4f x1 = { b[0], b[0], b[0], b[0] };
+    v4f y1 = { b[1], b[1], b[1], b[1] };
+    v4f x2 = { b[2], b[2], b[2], b[2] };
+    v4f y2 = { b[3], b[3], b[3], b[3] };
+    v4f cand_area = { area, area, area, area };
+    v4i cand_class = { class_id, class_id, class_id, class_id };
+    v4f zero = { 0, 0, 0, 0 };
+    bool suppressed = false;
+
+    // One row of the IoU matrix, four kept boxes at a time
+    for (size_t j = 0; j < kept_count && !suppressed; j += 4)
+    {
+      v4f ix = detect_max4(detect_min4(x2, *(v4f*)(kept.x2 + j)) - detect_max4(x1, *(v4f*)(kept.x1 + j)), zero);
+      v4f iy = detect_max4(detect_min4(y2, *(v4f*)(kept.y2 + j)) - detect_max4(y1, *(v4f*)(kept.y1 + j)), zero);
+      v4f inter = ix * iy;
+
+      // inter / union > thr without a division, lanes past the end never match
+      v4i overlap = inter > thr * (cand_area + *(v4f*)(kept.area + j) - inter);
+      v4i valid = lanes < (v4i){ (int32_t)(kept_count - j), (int32_t)(kept_count - j),
+                                 (int32_t)(kept_count - j), (int32_t)(kept_count - j) };
+      v4i hit = overlap & valid & (cand_class == *(v4i*)(kept.class_id + j));
+
+      suppressed = (hit[0] | hit[1] | hit[2] | hit[3]) != 0;
+    }
+
+    // A row costs up to max_out comparisons, thousands of rows per call
+    cond_resched();
+
+    if (suppressed)
+    {
+      continue;
+    }
+
+    kept.x1[kept_count] = b[DETECT_BOX_X1];
+    kept.y1[kept_count] = b[DETECT_BOX_Y1];
+    kept.x2[kept_count] = b[DETECT_BOX_X2];
+    kept.y2[kept_count] = b[DETECT_BOX_Y2];
+    kept.area[kept_count] = area;
+    kept.class_id[kept_count] = class_id;
+
+    // Never ahead of the scan, so the slot was already read
+    idx[kept_count++] = anchor;
+  }
+
+  kfree(scratch);
+  *out_count = kept_count;
+  return EOK;
+}
+
+/**
+ * @brief Threshold, top-k and NMS in one call
+ * 
+ * @param boxes FLOAT32 boxes, N x DETECT_BOX_COORDS
+ * @param scores FLOAT32 scores, N elements
+ * @param classes INT32 class per anchor, NULL to ignore classes
+ * @param score_threshold Lowest score kept (exclusive)
+ * @param k Candidates passed to NMS
+ * @param iou_threshold NMS overlap threshold
+ * @param max_out Most detections
+ * @param indices INT32 output of at least N elements, detections first
+ * @param out_count Output for the number of detections
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_postprocess(tensor_t* boxes, tensor_t* scores, tensor_t* classes, float score_threshold, size_t k,
+                          float iou_threshold, size_t max_out, tensor_t* indices, size_t* out_count)
+{
+  size_t count = 0;
+
+  int res = ai_detect_threshold(scores, score_threshold, indices, &count);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  res = ai_detect_top_k(scores, indices, count, k, &count);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  return ai_detect_nms(boxes, classes, indices, count, iou_threshold, max_out, out_count);
+}
+
+/**
+ * @brief Scalar baseline: sort every survivor by decreasing score
+ * 
+ * @param scores Scores
+ * @param idx Anchor indices
+ * @param count Number of indices
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void detect_bench_sort(const float* scores, int32_t* idx, size_t count)
+{
+  // Shell sort, what a port of the host code without qsort ends up with
+  for (size_t gap = count / 2; gap > 0; gap /= 2)
+  {
+    for (size_t i = gap; i < count; i++)
+    {
+      int32_t value = idx[i];
+      size_t j = i;
+      while (j >= gap && detect_better(scores, value, idx[j - gap]))
+      {
+        idx[j] = idx[j - gap];
+        j -= gap;
+      }
+      idx[j] = value;
+    }
+  }
+}
+
+/**
+ * @brief Scalar baseline: compare every pair of survivors
+ * 
+ * @param box Boxes
+ * @param cls Classes
+ * @param idx Anchor indices sorted by decreasing score
+ * @param count Number of indices
+ * @param suppressed One flag per index
+ * @param iou_threshold Overlap threshold
+ * @return size_t Boxes kept
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t detect_bench_nms(const float* box, const int32_t* cls, const int32_t* idx, size_t count,
+                               bool* suppressed, float iou_threshold)
+{
+  size_t kept = 0;
+  memset(suppressed, 0, count * sizeof(bool));
+
+  for (size_t i = 0; i < count; i++)
+  {
+    if (suppressed[i])
+    {
+      continue;
+    }
+    kept++;
+
+    const float* a = box + ((size_t)idx[i] * DETECT_BOX_COORDS);
+    float area_a = (a[2] - a[0]) * (a[3] - a[1]);
+    for (size_t j = i + 1; j < count; j++)
+    {
+      const float* b = box + ((size_t)idx[j] * DETECT_BOX_COORDS);
+      if (suppressed[j] || cls[idx[i]] != cls[idx[j]])
+      {
+        continue;
+      }
+
+      float w = (a[2] < b[2] ? a[2] : b[2]) - (a[0] > b[0] ? a[0] : b[0]);
+      float h = (a[3] < b[3] ? a[3] : b[3]) - (a[1] > b[1] ? a[1] : b[1]);
+      float inter = w > 0 && h > 0 ? w * h : 0;
+      float iou = inter / (area_a + ((b[2] - b[0]) * (b[3] - b[1])) - inter);
+      if (iou > iou_threshold)
+      {
+        suppressed[j] = true;
+      }
+    }
+  }
+
+  return kept;
+}
+
+/**
+ * @brief Print the time of one step
+ * 
+ * @param name Step name
+ * @param ticks Elapsed timer ticks
+ * @param count Candidates left after the step
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void detect_bench_print(const char* name, uint64_t ticks, size_t count)
+{
+  uart_send_string(name);
+  uart_send_string(": ");
+  uart_send_string(uint_to_str((ticks * 1000000) / timer_read_frequency()));
+  uart_send_string(" us, ");
+  uart_send_string(uint_to_str(count));
+  uart_send_string(" left\n");
+}
+
+/**
+ * @brief Time every step on 10k synthetic anchors against a scalar full
+ * sort and all-pairs NMS
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_benchmark()
+{
+  size_t box_shape[2] = { DETECT_BENCH_ANCHORS, DETECT_BOX_COORDS };
+  size_t class_shape[2] = { DETECT_BENCH_ANCHORS, DETECT_BENCH_CLASSES };
+  size_t anchor_shape[1] = { DETECT_BENCH_ANCHORS };
+  bool* suppressed = NULL;
+  int res = EOK;
+
+  tensor_t* boxes = ai_tensor_create(box_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* class_scores = ai_tensor_create(class_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* scores = ai_tensor_create(anchor_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* classes = ai_tensor_create(anchor_shape, 1, TENSOR_TYPE_INT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* indices = ai_tensor_create(anchor_shape, 1, TENSOR_TYPE_INT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  if (!boxes || !class_scores || !scores || !classes || !indices)
+  {
+    res = -ENOMEM;
+    goto out;
+  }
+
+  // Anchors gather around a few objects, like the output of a real head
+  float* box = (float*)boxes->data;
+  float* class_data = (float*)class_scores->data;
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  for (size_t i = 0; i < DETECT_BENCH_ANCHORS; i++)
+  {
+    seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+    uint32_t object = (uint32_t)(seed >> 33) % DETECT_BENCH_OBJECTS;
+    float cx = (float)((object * 97) % DETECT_BENCH_IMAGE);
+    float cy = (float)((object * 193) % DETECT_BENCH_IMAGE);
+    float size = (float)(16 + ((object * 37) % 96));
+    float jitter_x = (float)((seed >> 20) % 17) - 8;
+    float jitter_y = (float)((seed >> 40) % 17) - 8;
+
+    box[(i * DETECT_BOX_COORDS) + DETECT_BOX_X1] = cx + jitter_x - (size / 2);
+    box[(i * DETECT_BOX_COORDS) + DETECT_BOX_Y1] = cy + jitter_y - (size / 2);
+    box[(i * DETECT_BOX_COORDS) + DETECT_BOX_X2] = cx + jitter_x + (size / 2);
+    box[(i * DETECT_BOX_COORDS) + DETECT_BOX_Y2] = cy + jitter_y + (size / 2);
+
+    for (size_t c = 0; c < DETECT_BENCH_CLASSES; c++)
+    {
+      seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+      float score = (float)((seed >> 40) % 1000) / 1000;
+      class_data[(i * DETECT_BENCH_CLASSES) + c] = c == object % DETECT_BENCH_CLASSES ? score : score / 4;
+    }
+  }
+
+  suppressed = (bool*)kmalloc(DETECT_BENCH_ANCHORS * sizeof(bool));
+  if (!suppressed)
+  {
+    res = -ENOMEM;
+    goto out;
+  }
+
+  uart_send_string("\n=== Detection Post-processing Benchmark ===\n");
+
+  size_t count = 0;
+  uint64_t start = timer_read_counter();
+  res = ai_detect_best_class(class_scores, scores, classes);
+  uint64_t ticks = timer_read_counter() - start;
+  if (res < 0)
+  {
+    goto out;
+  }
+  detect_bench_print("Best class", ticks, DETECT_BENCH_ANCHORS);
+  uint64_t total = ticks;
+
+  start = timer_read_counter();
+  res = ai_detect_threshold(scores, DETECT_BENCH_SCORE, indices, &count);
+  ticks = timer_read_counter() - start;
+  if (res < 0)
+  {
+    goto out;
+  }
+  detect_bench_print("Threshold", ticks, count);
+  total += ticks;
+
+  // The baseline works on the same survivors
+  size_t survivors = count;
+  int32_t* idx = (int32_t*)indices->data;
+  int32_t* baseline = (int32_t*)kmalloc((survivors + 1) * sizeof(int32_t));
+  if (!baseline)
+  {
+    res = -ENOMEM;
+    goto out;
+  }
+  memcpy(baseline, idx, (int)(survivors * sizeof(int32_t)));
+
+  start = timer_read_counter();
+  res = ai_detect_top_k(scores, indices, count, DETECT_BENCH_TOP_K, &count);
+  ticks = timer_read_counter() - start;
+  if (res < 0)
+  {
+    kfree(baseline);
+    goto out;
+  }
+  detect_bench_print("Top-k", ticks, count);
+  total += ticks;
+
+  start = timer_read_counter();
+  res = ai_detect_nms(boxes, classes, indices, count, DETECT_BENCH_IOU, DETECT_BENCH_MAX_OUT, &count);
+  ticks = timer_read_counter() - start;
+  if (res < 0)
+  {
+    kfree(baseline);
+    goto out;
+  }
+  detect_bench_print("NMS", ticks, count);
+  total += ticks;
+  detect_bench_print("Total", total, count);
+
+  start = timer_read_counter();
+  detect_bench_sort((const float*)scores->data, baseline, survivors);
+  size_t baseline_kept = detect_bench_nms(box, (const int32_t*)classes->data, baseline, survivors, suppressed,
+                                          DETECT_BENCH_IOU);
+  ticks = timer_read_counter() - start;
+  detect_bench_print("Scalar sort + all-pairs NMS", ticks, baseline_kept);
+
+  kfree(baseline);
+
+out:
+  if (suppressed)
+    kfree(suppressed);
+  if (boxes)
+    ai_tensor_destroy(boxes);
+  if (class_scores)
+    ai_tensor_destroy(class_scores);
+  if (scores)
+    ai_tensor_destroy(scores);
+  if (classes)
+    ai_tensor_destroy(classes);
+  if (indices)
+    ai_tensor_destroy(indices);
+  return res;
+}
+
+/**
+ * @brief Test detection post-processing: threshold compaction, top-k
+ * order and class-aware NMS on a hand-made scene, then top-k against a
+ * full scan on random scores
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int detect_test()
+{
+  // Box, score and class per anchor: 1 overlaps 0, 3 overlaps 5, 2 is
+  // the same box as 1 in another class and 4 scores below the threshold
+  static const float scene_boxes[8][DETECT_BOX_COORDS] = {
+    { 0, 0, 10, 10 }, { 1, 1, 11, 11 }, { 1, 1, 11, 11 }, { 20, 20, 30, 30 },
+    { 50, 50, 60, 60 }, { 21, 21, 31, 31 }, { 100, 100, 110, 110 }, { 5, 0, 15, 10 }
+  };
+  static const float scene_scores[8] = { 0.9f, 0.8f, 0.85f, 0.7f, 0.2f, 0.75f, 0.6f, 0.5f };
+  static const int32_t scene_classes[8] = { 0, 0, 1, 0, 0, 0, 0, 0 };
+  static const int32_t expected_survivors[7] = { 0, 1, 2, 3, 5, 6, 7 };
+  static const int32_t expected_top_k[5] = { 0, 2, 1, 5, 3 };
+
+  size_t box_shape[2] = { 8, DETECT_BOX_COORDS };
+  size_t scene_shape[1] = { 8 };
+  size_t random_shape[1] = { DETECT_TEST_ANCHORS };
+  size_t count = 0;
+  int res = EOK;
+
+  uart_send_string("\n=== Testing Detection Post-processing ===\n");
+
+  tensor_t* boxes = ai_tensor_create(box_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* scores = ai_tensor_create(scene_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* classes = ai_tensor_create(scene_shape, 1, TENSOR_TYPE_INT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* indices = ai_tensor_create(scene_shape, 1, TENSOR_TYPE_INT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* random_scores = ai_tensor_create(random_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* random_indices = ai_tensor_create(random_shape, 1, TENSOR_TYPE_INT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  if (!boxes || !scores || !classes || !indices || !random_scores || !random_indices)
+  {
+    uart_send_string("FAIL: Tensor creation failed\n");
+    res = -ENOMEM;
+    goto out;
+  }
+
+  memcpy(boxes->data, (void*)scene_boxes, sizeof(scene_boxes));
+  memcpy(scores->data, (void*)scene_scores, sizeof(scene_scores));
+  memcpy(classes->data, (void*)scene_classes, sizeof(scene_classes));
+  int32_t* idx = (int32_t*)indices->data;
+
+  res = ai_detect_threshold(scores, 0.3f, indices, &count);
+  if (res != EOK || count != 7 || memcmp(idx, (void*)expected_survivors, sizeof(expected_survivors)) != 0)
+  {
+    uart_send_string("FAIL: Threshold compaction\n");
+    res = res != EOK ? res : -EIO;
+    goto out;
+  }
+
+  res = ai_detect_top_k(scores, indices, count, 5, &count);
+  if (res != EOK || count != 5 || memcmp(idx, (void*)expected_top_k, sizeof(expected_top_k)) != 0)
+  {
+    uart_send_string("FAIL: Top-k order\n");
+    res = res != EOK ? res : -EIO;
+    goto out;
+  }
+
+  // Class-aware: 1 goes to 0 and 3 to 5, 2 survives in its own class
+  res = ai_detect_nms(boxes, classes, indices, count, 0.5f, 10, &count);
+  if (res != EOK || count != 3 || idx[0] != 0 || idx[1] != 2 || idx[2] != 5)
+  {
+    uart_send_string("FAIL: Class-aware NMS\n");
+    res = res != EOK ? res : -EIO;
+    goto out;
+  }
+
+  // Without classes 2 goes to 0 as well
+  res = ai_detect_postprocess(boxes, scores, NULL, 0.3f, 5, 0.5f, 10, indices, &count);
+  if (res != EOK || count != 2 || idx[0] != 0 || idx[1] != 5)
+  {
+    uart_send_string("FAIL: Class-agnostic NMS\n");
+    res = res != EOK ? res : -EIO;
+    goto out;
+  }
+
+  // Random scores, every one passes the threshold
+  float* random = (float*)random_scores->data;
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  for (size_t i = 0; i < DETECT_TEST_ANCHORS; i++)
+  {
+    seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+    random[i] = (float)((seed >> 33) % 100000) / 100000;
+  }
+
+  res = ai_detect_threshold(random_scores, -1.0f, random_indices, &count);
+  if (res == EOK)
+  {
+    res = ai_detect_top_k(random_scores, random_indices, count, DETECT_TEST_TOP_K, &count);
+  }
+  if (res != EOK || count != DETECT_TEST_TOP_K)
+  {
+    uart_send_string("FAIL: Top-k on random scores\n");
+    res = res != EOK ? res : -EIO;
+    goto out;
+  }
+
+  int32_t* random_idx = (int32_t*)random_indices->data;
+  size_t better = 0;
+  for (size_t i = 0; i < DETECT_TEST_ANCHORS; i++)
+  {
+    if (random[i] > random[random_idx[DETECT_TEST_TOP_K - 1]])
+    {
+      better++;
+    }
+  }
+
+  for (size_t i = 1; i < DETECT_TEST_TOP_K; i++)
+  {
+    if (random[random_idx[i]] > random[random_idx[i - 1]])
+    {
+      better = DETECT_TEST_ANCHORS;
+    }
+  }
+
+  if (better >= DETECT_TEST_TOP_K)
+  {
+    uart_send_string("FAIL: Top-k missed a better score or is not sorted\n");
+    res = -EIO;
+    goto out;
+  }
+
+  uart_send_string("Detection post-processing tests passed\n");
+
+out:
+  if (boxes)
+    ai_tensor_destroy(boxes);
+  if (scores)
+    ai_tensor_destroy(scores);
+  if (classes)
+    ai_tensor_destroy(classes);
+  if (indices)
+    ai_tensor_destroy(indices);
+  if (random_scores)
+    ai_tensor_destroy(random_scores);
+  if (random_indices)
+    ai_tensor_destroy(random_indices);
+  return res;
+}
@@ -0,0 +1,709 @@
+/*
+ * int4.c - This file implements the packed 4-bit weight operations.
+ * Weights are stored as two INT4 / UINT4 values per byte with one
+ * scale per group and widened in registers by the GEMV / GEMM kernels.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "int4.h"
+
+#include <uart.h>
+#include <pmu.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/scheduler/preempt.h>
+#include <synapse/string/string.h>
+
+// Packed INT4 test configuration (N x K weights)
+#define INT4_TEST_N 64
+#define INT4_TEST_K 256
+#define INT4_TEST_GROUP 32
+#define INT4_TEST_REPEATS 16
+
+// Elements unpacked per step of the vector kernels (16 packed bytes)
+#define INT4_CHUNK 32
+
+// 16 packed bytes, no alignment requirement
+typedef uint8_t v16u8 __attribute__((vector_size(16), aligned(1)));
+// 16 nibbles widened to int8, one NEON register
+typedef int8_t v16i8 __attribute__((vector_size(16)));
+// 16 floats, four NEON registers, only element aligned
+typedef float v16f __attribute__((vector_size(64), aligned(4)));
+// 4 floats, one NEON register, only element aligned
+typedef float v4f __attribute__((vector_size(16), aligned(4)));
+
+// Interleave low and high nibbles back into element order (zip1 / zip2)
+static const v16i8 int4_zip_lo = { 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23 };
+static const v16i8 int4_zip_hi = { 8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31 };
+
+/**
+ * @brief Round to the nearest integer, halfway cases away from zero
+ * 
+ * @param value Value to round
+ * @return int32_t Rounded value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int32_t int4_round(float value)
+{
+  return (int32_t)(value >= 0 ? value + 0.5f : value - 0.5f);
+}
+
+/**
+ * @brief Clamp an integer to a range
+ * 
+ * @param value Value to clamp
+ * @param min Lower bound
+ * @param max Upper bound
+ * @return int32_t Clamped value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int32_t int4_clamp(int32_t value, int32_t min, int32_t max)
+{
+  if (value < min)
+  {
+    return min;
+  }
+
+  if (value > max)
+  {
+    return max;
+  }
+
+  return value;
+}
+
+/**
+ * @brief Get the number of elements of a tensor
+ * 
+ * @param tensor Tensor
+ * @return size_t Number of elements
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t int4_elems(tensor_t* tensor)
+{
+  size_t elems = 1;
+  for (size_t i = 0; i < tensor->ndim; i++)
+  {
+    elems *= tensor->shape[i];
+  }
+
+  return elems;
+}
+
+/**
+ * @brief Check that a tensor is a packed tensor with group scales
+ * 
+ * @param tensor Tensor to check
+ * @return bool true if the tensor can be used by the kernels
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool int4_is_packed(tensor_t* tensor)
+{
+  return tensor && tensor->data && tensor->quant && !tensor->sparse &&
+         (tensor->dtype == TENSOR_TYPE_INT4 || tensor->dtype == TENSOR_TYPE_UINT4);
+}
+
+/**
+ * @brief Widen 32 packed nibbles into two vectors of 16 int8 in element order
+ * 
+ * @param packed 16 packed bytes
+ * @param is_signed true for INT4, nibbles are sign extended
+ * @param e0 Output for elements 0 to 15
+ * @param e1 Output for elements 16 to 31
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void int4_widen(const uint8_t* packed, bool is_signed, v16i8* e0, v16i8* e1)
+{
+  v16i8 raw = (v16i8)*(const v16u8*)packed;
+  v16i8 lo = raw & 0x0F;
+  v16i8 hi = (v16i8)((v16u8)raw >> 4);
+
+  if (is_signed)
+  {
+    lo = (lo ^ 8) - 8;
+    hi = (hi ^ 8) - 8;
+  }
+
+  *e0 = __builtin_shuffle(lo, hi, int4_zip_lo);
+  *e1 = __builtin_shuffle(lo, hi, int4_zip_hi);
+}
+
+/**
+ * @brief Read one 4-bit element
+ * 
+ * @param packed Packed data
+ * @param index Element index
+ * @param is_signed true for INT4
+ * @return int32_t Element value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline int32_t int4_get(const uint8_t* packed, size_t index, bool is_signed)
+{
+  int32_t q = (packed[index / 2] >> ((index % 2) * 4)) & 0x0F;
+  return is_signed ? (q ^ 8) - 8 : q;
+}
+
+/**
+ * @brief Dot product of one group of packed weights with FLOAT32 input
+ * 
+ * @param packed Packed weights of the group, byte aligned
+ * @param x Input values of the group
+ * @param count Number of elements (even)
+ * @param is_signed true for INT4
+ * @param x_sum Output for the sum of the inputs, NULL if not needed
+ * @return float Sum of q * x over the group
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static float int4_group_dot(const uint8_t* packed, const float* x, size_t count, bool is_signed, float* x_sum)
+{
+  v16f acc = { 0 };
+  v16f acc_x = { 0 };
+  size_t k = 0;
+
+  for (; k + INT4_CHUNK <= count; k += INT4_CHUNK)
+  {
+    v16i8 e0, e1;
+    int4_widen(packed + (k / 2), is_signed, &e0, &e1);
+
+    v16f x0 = *(const v16f*)(x + k);
+    v16f x1 = *(const v16f*)(x + k + 16);
+    acc += __builtin_convertvector(e0, v16f) * x0 + __builtin_convertvector(e1, v16f) * x1;
+    if (x_sum)
+    {
+      acc_x += x0 + x1;
+    }
+  }
+
+  float sum = 0;
+  float sum_x = 0;
+  for (size_t i = 0; i < 16; i++)
+  {
+    sum += acc[i];
+    sum_x += acc_x[i];
+  }
+
+  // Remaining elements
+  for (; k < count; k++)
+  {
+    sum += (float)int4_get(packed, k, is_signed) * x[k];
+    sum_x += x[k];
+  }
+
+  if (x_sum)
+  {
+    *x_sum = sum_x;
+  }
+
+  return sum;
+}
+
+/**
+ * @brief Dequantise one row of a packed tensor
+ * 
+ * @param tensor Packed tensor
+ * @param row Row index
+ * @param out Output of shape[ndim - 1] floats
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void int4_unpack_row(tensor_t* tensor, size_t row, float* out)
+{
+  tensor_quant_t* quant = tensor->quant;
+  bool is_signed = tensor->dtype == TENSOR_TYPE_INT4;
+  size_t cols = tensor->shape[tensor->ndim - 1];
+  size_t groups_per_row = (cols + quant->group_size - 1) / quant->group_size;
+  const uint8_t* packed = (const uint8_t*)tensor->data + ((row * cols) / 2);
+
+  for (size_t g = 0; g < groups_per_row; g++)
+  {
+    size_t group = (row * groups_per_row) + g;
+    size_t start = g * quant->group_size;
+    size_t count = cols - start < quant->group_size ? cols - start : quant->group_size;
+    const uint8_t* group_data = packed + (start / 2);
+    float* group_out = out + start;
+    float scale = quant->scales[group];
+    float zero = quant->zero_points ? (float)quant->zero_points[group] : 0;
+
+    size_t k = 0;
+    for (; k + INT4_CHUNK <= count; k += INT4_CHUNK)
+    {
+      v16i8 e0, e1;
+      int4_widen(group_data + (k / 2), is_signed, &e0, &e1);
+
+      *(v16f*)(group_out + k) = (__builtin_convertvector(e0, v16f) - zero) * scale;
+      *(v16f*)(group_out + k + 16) = (__builtin_convertvector(e1, v16f) - zero) * scale;
+    }
+
+    // Remaining elements
+    for (; k < count; k++)
+    {
+      group_out[k] = ((float)int4_get(group_data, k, is_signed) - zero) * scale;
+    }
+  }
+}
+
+/**
+ * @brief Dot product of two FLOAT32 vectors
+ * 
+ * @param a First vector
+ * @param b Second vector
+ * @param count Number of elements
+ * @return float Dot product
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static float int4_f32_dot(const float* a, const float* b, size_t count)
+{
+  v4f acc0 = { 0, 0, 0, 0 };
+  v4f acc1 = { 0, 0, 0, 0 };
+  size_t k = 0;
+
+  for (; k + 8 <= count; k += 8)
+  {
+    acc0 += *(const v4f*)(a + k) * *(const v4f*)(b + k);
+    acc1 += *(const v4f*)(a + k + 4) * *(const v4f*)(b + k + 4);
+  }
+
+  acc0 += acc1;
+  float sum = acc0[0] + acc0[1] + acc0[2] + acc0[3];
+  for (; k < count; k++)
+  {
+    sum += a[k] * b[k];
+  }
+
+  return sum;
+}
+
+/**
+ * @brief Quantise a FLOAT32 tensor into a packed tensor of the same shape,
+ * INT4 groups are symmetric, UINT4 groups get a zero point
+ * 
+ * @param src FLOAT32 tensor
+ * @param dst Packed tensor from ai_tensor_create_packed
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_int4_pack(tensor_t* src, tensor_t* dst)
+{
+  if (!src || !src->data || src->sparse || src->dtype != TENSOR_TYPE_FLOAT32 || !int4_is_packed(dst))
+  {
+    return -EINVARG;
+  }
+
+  size_t elems = int4_elems(dst);
+  size_t cols = dst->shape[dst->ndim - 1];
+  if (int4_elems(src) != elems || src->shape[src->ndim - 1] != cols)
+  {
+    return -EINVARG;
+  }
+
+  tensor_quant_t* quant = dst->quant;
+  bool is_signed = dst->dtype == TENSOR_TYPE_INT4;
+  size_t groups_per_row = (cols + quant->group_size - 1) / quant->group_size;
+  const float* values = (const float*)src->data;
+  uint8_t* packed = (uint8_t*)dst->data;
+
+  memset(packed, 0, elems / 2);
+
+  for (size_t group = 0; group < quant->group_count; group++)
+  {
+    size_t row = group / groups_per_row;
+    size_t start = (row * cols) + ((group % groups_per_row) * quant->group_size);
+    size_t end = start + quant->group_size;
+    if (end > (row + 1) * cols)
+    {
+      end = (row + 1) * cols;
+    }
+
+    // Range of the group, zero always representable
+    float min = 0;
+    float max = 0;
+    for (size_t i = start; i < end; i++)
+    {
+      min = values[i] < min ? values[i] : min;
+      max = values[i] > max ? values[i] : max;
+    }
+
+    float scale;
+    int32_t zero = 0;
+    if (is_signed)
+    {
+      float max_abs = -min > max ? -min : max;
+      scale = max_abs / 7;
+    }
+    else
+    {
+      scale = (max - min) / 15;
+      zero = scale > 0 ? int4_clamp(int4_round(-min / scale), 0, 15) : 0;
+      quant->zero_points[group] = zero;
+    }
+    quant->scales[group] = scale;
+
+    float inv_scale = scale > 0 ? 1 / scale : 0;
+    for (size_t i = start; i < end; i++)
+    {
+      int32_t q = int4_round(values[i] * inv_scale) + zero;
+      q = is_signed ? int4_clamp(q, -8, 7) : int4_clamp(q, 0, 15);
+      packed[i / 2] |= (uint8_t)((q & 0x0F) << ((i % 2) * 4));
+    }
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Dequantise a packed tensor into a FLOAT32 tensor of the same shape
+ * 
+ * @param src Packed tensor
+ * @param dst FLOAT32 tensor
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_int4_unpack(tensor_t* src, tensor_t* dst)
+{
+  if (!int4_is_packed(src) || !dst || !dst->data || dst->sparse || dst->dtype != TENSOR_TYPE_FLOAT32)
+  {
+    return -EINVARG;
+  }
+
+  size_t cols = src->shape[src->ndim - 1];
+  if (int4_elems(dst) != int4_elems(src) || dst->shape[dst->ndim - 1] != cols)
+  {
+    return -EINVARG;
+  }
+
+  size_t rows = int4_elems(src) / cols;
+  float* out = (float*)dst->data;
+  for (size_t row = 0; row < rows; row++)
+  {
+    int4_unpack_row(src, row, out + (row * cols));
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Matrix-vector product with packed weights, y = W x
+ * 
+ * @param w Packed N x K weights
+ * @param x FLOAT32 input of K elements
+ * @param y FLOAT32 output of N elements
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_int4_gemv(tensor_t* w, tensor_t* x, tensor_t* y)
+{
+  if (!int4_is_packed(w) || w->ndim != 2 || !x || !x->data || !y || !y->data ||
+      x->dtype != TENSOR_TYPE_FLOAT32 || y->dtype != TENSOR_TYPE_FLOAT32)
+  {
+    return -EINVARG;
+  }
+
+  size_t n = w->shape[0];
+  size_t k = w->shape[1];
+  if (int4_elems(x) != k || int4_elems(y) != n)
+  {
+    return -EINVARG;
+  }
+
+  tensor_quant_t* quant = w->quant;
+  bool is_signed = w->dtype == TENSOR_TYPE_INT4;
+  size_t groups_per_row = (k + quant->group_size - 1) / quant->group_size;
+  const uint8_t* packed = (const uint8_t*)w->data;
+  const float* in = (const float*)x->data;
+  float* out = (float*)y->data;
+
+  for (size_t row = 0; row < n; row++)
+  {
+    const uint8_t* row_data = packed + ((row * k) / 2);
+    float sum = 0;
+
+    for (size_t g = 0; g < groups_per_row; g++)
+    {
+      size_t group = (row * groups_per_row) + g;
+      size_t start = g * quant->group_size;
+      size_t count = k - start < quant->group_size ? k - start : quant->group_size;
+      float x_sum = 0;
+
+      // (q - z) . x = q . x - z * sum(x)
+      float dot = int4_group_dot(row_data + (start / 2), in + start, count, is_signed,
+                                 quant->zero_points ? &x_sum : NULL);
+      if (quant->zero_points)
+      {
+        dot -= (float)quant->zero_points[group] * x_sum;
+      }
+
+      sum += dot * quant->scales[group];
+    }
+
+    out[row] = sum;
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Matrix product with packed weights, Y = X W^T (linear layer)
+ * 
+ * Each weight row is widened once into a scratch row and reused for
+ * every activation row.
+ * 
+ * @param x FLOAT32 M x K activations
+ * @param w Packed N x K weights
+ * @param y FLOAT32 M x N output
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_int4_gemm(tensor_t* x, tensor_t* w, tensor_t* y)
+{
+  if (!int4_is_packed(w) || w->ndim != 2 || !x || !x->data || x->ndim != 2 || !y || !y->data || y->ndim != 2 ||
+      x->dtype != TENSOR_TYPE_FLOAT32 || y->dtype != TENSOR_TYPE_FLOAT32)
+  {
+    return -EINVARG;
+  }
+
+  size_t m = x->shape[0];
+  size_t n = w->shape[0];
+  size_t k = w->shape[1];
+  if (x->shape[1] != k || y->shape[0] != m || y->shape[1] != n)
+  {
+    return -EINVARG;
+  }
+
+  float* scratch = (float*)kmalloc(k * sizeof(float));
+  if (!scratch)
+  {
+    return -ENOMEM;
+  }
+
+  const float* in = (const float*)x->data;
+  float* out = (float*)y->data;
+
+  for (size_t row = 0; row < n; row++)
+  {
+    int4_unpack_row(w, row, scratch);
+
+    for (size_t i = 0; i < m; i++)
+    {
+      out[(i * n) + row] = int4_f32_dot(in + (i * k), scratch, k);
+    }
+
+    cond_resched();
+  }
+
+  kfree(scratch);
+  return EOK;
+}
+
+/**
+ * @brief Absolute value of a float
+ * 
+ * @param value Value
+ * @return float Absolute value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static float int4_test_fabs(float value)
+{
+  return value < 0 ? -value : value;
+}
+
+/**
+ * @brief Test packed INT4 / UINT4 weights: quantisation error, GEMV
+ * against the dequantised weights and GEMV cycles against FLOAT32
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int int4_test()
+{
+  static const tensor_dtype_t dtypes[2] = { TENSOR_TYPE_INT4, TENSOR_TYPE_UINT4 };
+
+  size_t w_shape[2] = { INT4_TEST_N, INT4_TEST_K };
+  size_t x_shape[1] = { INT4_TEST_K };
+  size_t y_shape[1] = { INT4_TEST_N };
+  tensor_t* packed = NULL;
+  int res = EOK;
+
+  uart_send_string("\n=== Testing Packed INT4 Tensors ===\n");
+
+  tensor_t* w = ai_tensor_create(w_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* dequant = ai_tensor_create(w_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* x = ai_tensor_create(x_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* y = ai_tensor_create(y_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  if (!w || !dequant || !x || !y)
+  {
+    uart_send_string("FAIL: Tensor creation failed\n");
+    res = -ENOMEM;
+    goto out;
+  }
+
+  float* w_data = (float*)w->data;
+  float* d_data = (float*)dequant->data;
+  float* x_data = (float*)x->data;
+  float* y_data = (float*)y->data;
+
+  for (size_t i = 0; i < INT4_TEST_N * INT4_TEST_K; i++)
+  {
+    w_data[i] = (float)((int)((i * 37) % 29) - 14) / 7;
+  }
+
+  for (size_t i = 0; i < INT4_TEST_K; i++)
+  {
+    x_data[i] = (float)((int)((i * 13) % 17) - 8) / 8;
+  }
+
+  pmu_init();
+
+  // FLOAT32 GEMV as the throughput reference
+  uint64_t start = pmu_read_cycles();
+  for (size_t r = 0; r < INT4_TEST_REPEATS; r++)
+  {
+    for (size_t n = 0; n < INT4_TEST_N; n++)
+    {
+      float sum = 0;
+      for (size_t k = 0; k < INT4_TEST_K; k++)
+      {
+        sum += w_data[(n * INT4_TEST_K) + k] * x_data[k];
+      }
+      y_data[n] = sum;
+    }
+  }
+  uint64_t f32_cycles = pmu_read_cycles() - start;
+
+  for (size_t t = 0; t < 2; t++)
+  {
+    packed = ai_tensor_create_packed(w_shape, 2, dtypes[t], INT4_TEST_GROUP, TENSOR_MEM_ALIGNED);
+    if (!packed)
+    {
+      uart_send_string("FAIL: Packed tensor creation failed\n");
+      res = -ENOMEM;
+      goto out;
+    }
+
+    res = ai_int4_pack(w, packed);
+    if (res == EOK)
+    {
+      res = ai_int4_unpack(packed, dequant);
+    }
+    if (res != EOK)
+    {
+      uart_send_string("FAIL: Pack or unpack failed\n");
+      goto out;
+    }
+
+    // Round to nearest, no element may be off by more than half a step
+    float max_error = 0;
+    for (size_t i = 0; i < INT4_TEST_N * INT4_TEST_K; i++)
+    {
+      float error = int4_test_fabs(d_data[i] - w_data[i]);
+      float scale = packed->quant->scales[i / INT4_TEST_GROUP];
+      if (error > scale * 0.501f)
+      {
+        uart_send_string("FAIL: Quantisation error above half a step\n");
+        res = -EIO;
+        goto out;
+      }
+      max_error = error > max_error ? error : max_error;
+    }
+
+    start = pmu_read_cycles();
+    for (size_t r = 0; r < INT4_TEST_REPEATS && res == EOK; r++)
+    {
+      res = ai_int4_gemv(packed, x, y);
+    }
+    uint64_t int4_cycles = pmu_read_cycles() - start;
+    if (res != EOK)
+    {
+      uart_send_string("FAIL: GEMV failed\n");
+      goto out;
+    }
+
+    // The kernel must match the dequantised weights up to float rounding
+    for (size_t n = 0; n < INT4_TEST_N; n++)
+    {
+      float expected = 0;
+      float magnitude = 0;
+      for (size_t k = 0; k < INT4_TEST_K; k++)
+      {
+        expected += d_data[(n * INT4_TEST_K) + k] * x_data[k];
+        magnitude += int4_test_fabs(d_data[(n * INT4_TEST_K) + k] * x_data[k]);
+      }
+
+      if (int4_test_fabs(y_data[n] - expected) > (magnitude * 0.0001f) + 0.0001f)
+      {
+        uart_send_string("FAIL: GEMV result mismatch\n");
+        res = -EIO;
+        goto out;
+      }
+    }
+
+    uart_send_string(t == 0 ? "INT4" : "UINT4");
+    uart_send_string(": max error x1000=");
+    uart_send_string(uint_to_str((uint64_t)(max_error * 1000)));
+    uart_send_string(" weights=");
+    uart_send_string(uint_to_str(ai_tensor_get_size(packed)));
+    uart_send_string(" bytes (FLOAT32 ");
+    uart_send_string(uint_to_str(ai_tensor_get_size(w)));
+    uart_send_string(") GEMV cycles=");
+    uart_send_string(uint_to_str(int4_cycles));
+    uart_send_string(" (FLOAT32 ");
+    uart_send_string(uint_to_str(f32_cycles));
+    uart_send_string(")\n");
+
+    ai_tensor_destroy(packed);
+    packed = NULL;
+  }
+
+  uart_send_string("Packed INT4 tests PASSED\n");
+
+out:
+  if (packed)
+    ai_tensor_destroy(packed);
+  if (w)
+    ai_tensor_destroy(w);
+  if (dequant)
+    ai_tensor_destroy(dequant);
+  if (x)
+    ai_tensor_destroy(x);
+  if (y)
+    ai_tensor_destroy(y);
+
+  return res;
+}
@@ -0,0 +1,861 @@
+/*
+ * pipeline.c - This file implements the sensor frame pipeline. Stages
+ * are polled from the sink back to the source, frames move between them
+ * through lock-free rings and come back to a lock-free free list, so the
+ * stages can be polled from different CPUs without locks.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "pipeline.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/semihost/semihost.h>
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// Benchmark configuration (64 x 64 RGB frames)
+#define PIPELINE_BENCH_HEIGHT 64
+#define PIPELINE_BENCH_WIDTH 64
+#define PIPELINE_BENCH_CHANNELS 3
+#define PIPELINE_BENCH_FRAMES 48
+#define PIPELINE_BENCH_INFER_PASSES 3 // Inference costs three preprocess passes
+#define PIPELINE_BENCH_RESULTS "pipeline_bench.bin" // Host file of semihosted runs
+
+// Frame pipeline test configuration (4 x 4 RGB frames)
+#define PIPELINE_TEST_FRAMES 20
+#define PIPELINE_TEST_DROP_FRAMES 40
+
+// Frame pipeline test sink state
+typedef struct
+{
+  uint64_t frames;
+  uint64_t next_sequence; // Lowest sequence the next frame may have
+  bool ordered;
+  bool intact;
+} pipeline_test_sink_t;
+
+/**
+ * @brief Add a frame to a ring, only called by the producer
+ * 
+ * @param queue Ring
+ * @param frame Frame
+ * @return bool false if the ring is full
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool pipeline_queue_push(pipeline_queue_t* queue, pipeline_frame_t* frame)
+{
+  uint32_t tail = queue->tail;
+  if (tail - __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) >= PIPELINE_QUEUE_SIZE)
+  {
+    return false;
+  }
+
+  queue->entries[tail & (PIPELINE_QUEUE_SIZE - 1)] = frame;
+
+  // Publish the entry before the new tail
+  __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+/**
+ * @brief Take the oldest frame of a ring
+ * 
+ * The consumer pops and the producer drops through the same head, both
+ * claim the entry with a compare and swap so a frame leaves only once.
+ * 
+ * @param queue Ring
+ * @return pipeline_frame_t* Frame, NULL if the ring is empty
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static pipeline_frame_t* pipeline_queue_pop(pipeline_queue_t* queue)
+{
+  uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+  while (head != __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE))
+  {
+    pipeline_frame_t* frame = queue->entries[head & (PIPELINE_QUEUE_SIZE - 1)];
+    if (__atomic_compare_exchange_n(&queue->head, &head, head + 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+      return frame;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Check if a ring has no free entry
+ * 
+ * @param queue Ring
+ * @return bool true if the ring is full
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool pipeline_queue_full(pipeline_queue_t* queue)
+{
+  return queue->tail - __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) >= PIPELINE_QUEUE_SIZE;
+}
+
+/**
+ * @brief Give a frame back to the pool
+ * 
+ * @param pipeline Pipeline
+ * @param frame Frame
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void pipeline_frame_put(pipeline_t* pipeline, pipeline_frame_t* frame)
+{
+  uint64_t head = __atomic_load_n(&pipeline->free_head, __ATOMIC_ACQUIRE);
+  uint64_t next;
+
+  do
+  {
+    pipeline->free_next[frame->index] = (uint32_t)head;
+
+    // The tag changes on every update, a stale head cannot be swapped back in
+    next = ((head >> 32) + 1) << 32 | (frame->index + 1);
+  } while (!__atomic_compare_exchange_n(&pipeline->free_head, &head, next, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+  __atomic_add_fetch(&pipeline->free_count, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Take a frame from the pool
+ * 
+ * @param pipeline Pipeline
+ * @return pipeline_frame_t* Frame, NULL if every frame is in flight
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static pipeline_frame_t* pipeline_frame_get(pipeline_t* pipeline)
+{
+  uint64_t head = __atomic_load_n(&pipeline->free_head, __ATOMIC_ACQUIRE);
+  uint64_t next;
+
+  do
+  {
+    if ((uint32_t)head == 0)
+    {
+      return NULL;
+    }
+
+    next = ((head >> 32) + 1) << 32 | pipeline->free_next[(uint32_t)head - 1];
+  } while (!__atomic_compare_exchange_n(&pipeline->free_head, &head, next, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+  __atomic_sub_fetch(&pipeline->free_count, 1, __ATOMIC_RELEASE);
+  return &pipeline->frames[(uint32_t)head - 1];
+}
+
+/**
+ * @brief Get the frame a stage works on next
+ * 
+ * @param pipeline Pipeline
+ * @param index Stage index
+ * @return pipeline_frame_t* Frame, NULL if the stage has nothing to do
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static pipeline_frame_t* pipeline_stage_input(pipeline_t* pipeline, size_t index)
+{
+  pipeline_stage_t* stage = &pipeline->stages[index];
+
+  if (index > 0)
+  {
+    return pipeline_queue_pop(&pipeline->stages[index - 1].out);
+  }
+
+  if (pipeline->next_sequence >= __atomic_load_n(&pipeline->capture_limit, __ATOMIC_ACQUIRE))
+  {
+    return NULL;
+  }
+
+  pipeline_frame_t* frame = pipeline_frame_get(pipeline);
+
+  // A sensor cannot wait, reuse the oldest frame nobody has started on
+  if (!frame && stage->config.policy == PIPELINE_POLICY_DROP_OLDEST)
+  {
+    frame = pipeline_queue_pop(&stage->out);
+    if (frame)
+    {
+      stage->stats.drops++;
+    }
+  }
+
+  if (!frame)
+  {
+    stage->stats.stalls++;
+    return NULL;
+  }
+
+  frame->sequence = pipeline->next_sequence++;
+  frame->timestamp = timer_read_counter();
+  if (frame->sequence == 0)
+  {
+    pipeline->first_capture = frame->timestamp;
+  }
+
+  return frame;
+}
+
+/**
+ * @brief Hand a processed frame to the next stage, or back to the pool
+ * after the sink
+ * 
+ * @param pipeline Pipeline
+ * @param index Stage index
+ * @param frame Frame
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void pipeline_stage_output(pipeline_t* pipeline, size_t index, pipeline_frame_t* frame)
+{
+  pipeline_stage_t* stage = &pipeline->stages[index];
+
+  if (index == pipeline->stage_count - 1)
+  {
+    uint64_t now = timer_read_counter();
+    uint64_t latency = now - frame->timestamp;
+
+    pipeline->latency_ticks += latency;
+    pipeline->max_latency_ticks = latency > pipeline->max_latency_ticks ? latency : pipeline->max_latency_ticks;
+    pipeline->last_complete = now;
+    pipeline->completed++;
+
+    pipeline_frame_put(pipeline, frame);
+    return;
+  }
+
+  // Blocking stages checked for space before taking their input
+  while (!pipeline_queue_push(&stage->out, frame))
+  {
+    pipeline_frame_t* oldest = pipeline_queue_pop(&stage->out);
+    if (oldest)
+    {
+      stage->stats.drops++;
+      pipeline_frame_put(pipeline, oldest);
+    }
+  }
+}
+
+/**
+ * @brief Run one step of a stage
+ * 
+ * @param pipeline Pipeline
+ * @param index Stage index
+ * @return bool true if the stage processed a frame
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool pipeline_stage_step(pipeline_t* pipeline, size_t index)
+{
+  pipeline_stage_t* stage = &pipeline->stages[index];
+
+  // Back-pressure, keep the input queued until the next stage makes room
+  if (index < pipeline->stage_count - 1 && stage->config.policy == PIPELINE_POLICY_BLOCK &&
+      pipeline_queue_full(&stage->out))
+  {
+    stage->stats.stalls++;
+    return false;
+  }
+
+  pipeline_frame_t* frame = pipeline_stage_input(pipeline, index);
+  if (!frame)
+  {
+    return false;
+  }
+
+  uint64_t start = timer_read_counter();
+  int res = stage->config.fn(frame, stage->config.private_data);
+  uint64_t ticks = timer_read_counter() - start;
+
+  stage->stats.frames++;
+  stage->stats.busy_ticks += ticks;
+  stage->stats.max_ticks = ticks > stage->stats.max_ticks ? ticks : stage->stats.max_ticks;
+
+  if (res < 0)
+  {
+    stage->stats.errors++;
+    pipeline_frame_put(pipeline, frame);
+    return true;
+  }
+
+  pipeline_stage_output(pipeline, index, frame);
+  return true;
+}
+
+/**
+ * @brief Create a pipeline and its frame pool
+ * 
+ * The pool holds PIPELINE_BUFFERS_PER_LINK frames per stage link, plus
+ * the one the sink works on. The first stage is the source: it fills
+ * frames taken from the pool. The last one is the sink: its frames go
+ * back to the pool.
+ * 
+ * @param stages Stage configurations, copied (2 to PIPELINE_MAX_STAGES)
+ * @param stage_count Number of stages
+ * @param shape Frame tensor shape
+ * @param ndim Number of dimensions
+ * @param dtype Frame tensor type
+ * @param out_pipeline Output for the pipeline
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_create(pipeline_stage_config_t* stages, size_t stage_count, size_t* shape, size_t ndim,
+                    tensor_dtype_t dtype, pipeline_t** out_pipeline)
+{
+  if (!stages || stage_count < 2 || stage_count > PIPELINE_MAX_STAGES || !shape || ndim == 0 || !out_pipeline)
+  {
+    return -EINVARG;
+  }
+
+  for (size_t i = 0; i < stage_count; i++)
+  {
+    if (!stages[i].fn)
+    {
+      return -EINVARG;
+    }
+  }
+
+  pipeline_t* pipeline = (pipeline_t*)kzalloc(sizeof(pipeline_t));
+  if (!pipeline)
+  {
+    return -ENOMEM;
+  }
+
+  for (size_t i = 0; i < stage_count; i++)
+  {
+    pipeline->stages[i].config = stages[i];
+  }
+  pipeline->stage_count = stage_count;
+
+  uint32_t frame_count = PIPELINE_BUFFERS_PER_LINK * (stage_count - 1) + 1;
+  for (uint32_t i = 0; i < frame_count; i++)
+  {
+    pipeline_frame_t* frame = &pipeline->frames[i];
+    frame->index = i;
+    frame->tensor = ai_tensor_create(shape, ndim, dtype, TENSOR_LAYOUT_NHWC, TENSOR_MEM_ALIGNED | TENSOR_MEM_ZEROED);
+    if (!frame->tensor)
+    {
+      pipeline_destroy(pipeline);
+      return -ENOMEM;
+    }
+
+    pipeline->frame_count++;
+    pipeline_frame_put(pipeline, frame);
+  }
+
+  *out_pipeline = pipeline;
+  return EOK;
+}
+
+/**
+ * @brief Destroy a pipeline and its frame pool
+ * 
+ * @param pipeline Pipeline
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void pipeline_destroy(pipeline_t* pipeline)
+{
+  if (!pipeline)
+  {
+    return;
+  }
+
+  for (uint32_t i = 0; i < pipeline->frame_count; i++)
+  {
+    ai_tensor_destroy(pipeline->frames[i].tensor);
+  }
+
+  kfree(pipeline);
+}
+
+/**
+ * @brief Let the source capture more frames
+ * 
+ * @param pipeline Pipeline
+ * @param frames Frames to capture
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void pipeline_start(pipeline_t* pipeline, uint64_t frames)
+{
+  if (!pipeline)
+  {
+    return;
+  }
+
+  __atomic_add_fetch(&pipeline->capture_limit, frames, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Run one step of every stage pinned to a CPU
+ * 
+ * Stages are polled from the sink back to the source, a frame moves one
+ * stage per poll. With one CPU per stage a step lasts as long as the
+ * slowest stage.
+ * 
+ * @param pipeline Pipeline
+ * @param cpu CPU polling, PIPELINE_CPU_ANY polls every stage
+ * @return int Number of stages that processed a frame
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_poll(pipeline_t* pipeline, uint32_t cpu)
+{
+  if (!pipeline)
+  {
+    return 0;
+  }
+
+  int busy = 0;
+  for (size_t i = pipeline->stage_count; i-- > 0;)
+  {
+    uint32_t stage_cpu = pipeline->stages[i].config.cpu;
+    if (cpu != PIPELINE_CPU_ANY && stage_cpu != PIPELINE_CPU_ANY && stage_cpu != cpu)
+    {
+      continue;
+    }
+
+    if (pipeline_stage_step(pipeline, i))
+    {
+      busy++;
+    }
+  }
+
+  return busy;
+}
+
+/**
+ * @brief Check if every allowed frame was captured and left the pipeline
+ * 
+ * @param pipeline Pipeline
+ * @return bool true once the pool is full again
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool pipeline_idle(pipeline_t* pipeline)
+{
+  return pipeline->next_sequence >= __atomic_load_n(&pipeline->capture_limit, __ATOMIC_ACQUIRE) &&
+         __atomic_load_n(&pipeline->free_count, __ATOMIC_ACQUIRE) == pipeline->frame_count;
+}
+
+/**
+ * @brief Capture frames and poll every stage on this CPU until they
+ * have all left the pipeline
+ * 
+ * @param pipeline Pipeline
+ * @param frames Frames to capture
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_run(pipeline_t* pipeline, uint64_t frames)
+{
+  if (!pipeline)
+  {
+    return -EINVARG;
+  }
+
+  pipeline_start(pipeline, frames);
+
+  while (!pipeline_idle(pipeline))
+  {
+    pipeline_poll(pipeline, PIPELINE_CPU_ANY);
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Get the end to end statistics of a pipeline
+ * 
+ * @param pipeline Pipeline
+ * @param stats Output for the statistics
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void pipeline_get_stats(pipeline_t* pipeline, pipeline_stats_t* stats)
+{
+  if (!pipeline || !stats)
+  {
+    return;
+  }
+
+  memset(stats, 0, sizeof(pipeline_stats_t));
+  stats->captured = pipeline->next_sequence;
+  stats->completed = pipeline->completed;
+  stats->max_latency = pipeline->max_latency_ticks;
+
+  for (size_t i = 0; i < pipeline->stage_count; i++)
+  {
+    pipeline_stage_stats_t* stage = &pipeline->stages[i].stats;
+    stats->dropped += stage->drops + stage->errors;
+
+    uint64_t mean = stage->frames ? stage->busy_ticks / stage->frames : 0;
+    stats->slowest_stage = mean > stats->slowest_stage ? mean : stats->slowest_stage;
+  }
+
+  if (pipeline->completed > 0)
+  {
+    stats->avg_latency = pipeline->latency_ticks / pipeline->completed;
+
+    uint64_t elapsed = pipeline->last_complete - pipeline->first_capture;
+    if (elapsed > 0)
+    {
+      stats->frames_per_sec = (uint32_t)((pipeline->completed * timer_read_frequency()) / elapsed);
+    }
+  }
+}
+
+/**
+ * @brief Synthetic camera for testing, fills an INT8 frame with a
+ * pattern derived from its sequence number
+ * 
+ * @param frame Frame
+ * @param private_data Unused
+ * @return int EOK
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_synthetic_source(pipeline_frame_t* frame, void* private_data)
+{
+  int8_t* data = (int8_t*)frame->tensor->data;
+  size_t size = ai_tensor_get_size(frame->tensor);
+
+  for (size_t i = 0; i < size; i++)
+  {
+    data[i] = (int8_t)(frame->sequence * 7 + i);
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Check a frame filled by pipeline_synthetic_source()
+ * 
+ * @param frame Frame
+ * @param offset Value added to every byte by the stages
+ * @return bool true if the pattern matches
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool pipeline_synthetic_check(pipeline_frame_t* frame, int8_t offset)
+{
+  int8_t* data = (int8_t*)frame->tensor->data;
+  size_t size = ai_tensor_get_size(frame->tensor);
+
+  for (size_t i = 0; i < size; i++)
+  {
+    if (data[i] != (int8_t)(frame->sequence * 7 + i + offset))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Benchmark preprocess stage, centres the pixels
+ * 
+ * @param frame Frame
+ * @param private_data Passes over the frame
+ * @return int EOK
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int pipeline_bench_filter(pipeline_frame_t* frame, void* private_data)
+{
+  uint32_t passes = (uint32_t)(uintptr_t)private_data;
+  int8_t* data = (int8_t*)frame->tensor->data;
+  size_t size = ai_tensor_get_size(frame->tensor);
+
+  for (uint32_t pass = 0; pass < passes; pass++)
+  {
+    for (size_t i = 0; i < size; i++)
+    {
+      data[i] = (int8_t)((data[i] >> 1) + (int8_t)pass);
+    }
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Benchmark post-process stage, reduces the frame to a checksum
+ * 
+ * @param frame Frame
+ * @param private_data Checksum accumulator
+ * @return int EOK
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int pipeline_bench_reduce(pipeline_frame_t* frame, void* private_data)
+{
+  uint64_t* checksum = (uint64_t*)private_data;
+  int8_t* data = (int8_t*)frame->tensor->data;
+  size_t size = ai_tensor_get_size(frame->tensor);
+
+  for (size_t i = 0; i < size; i++)
+  {
+    *checksum += (uint8_t)data[i];
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Run a capture / preprocess / infer / post-process pipeline on
+ * synthetic frames and report latency and throughput per stage
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_benchmark()
+{
+  uint64_t checksum = 0;
+  size_t shape[4] = { 1, PIPELINE_BENCH_HEIGHT, PIPELINE_BENCH_WIDTH, PIPELINE_BENCH_CHANNELS };
+  pipeline_stage_config_t stages[4] = {
+    { "capture", pipeline_synthetic_source, NULL, PIPELINE_POLICY_BLOCK, PIPELINE_CPU_ANY },
+    { "preprocess", pipeline_bench_filter, (void*)(uintptr_t)1, PIPELINE_POLICY_BLOCK, PIPELINE_CPU_ANY },
+    { "infer", pipeline_bench_filter, (void*)(uintptr_t)PIPELINE_BENCH_INFER_PASSES, PIPELINE_POLICY_BLOCK, PIPELINE_CPU_ANY },
+    { "postprocess", pipeline_bench_reduce, &checksum, PIPELINE_POLICY_BLOCK, PIPELINE_CPU_ANY }
+  };
+
+  pipeline_t* pipeline = NULL;
+  int res = pipeline_create(stages, 4, shape, 4, TENSOR_TYPE_INT8, &pipeline);
+  if (res < 0)
+  {
+    uart_send_string("pipeline: creation failed\n");
+    return res;
+  }
+
+  uart_send_string("\n=== Frame Pipeline Benchmark ===\n");
+
+  res = pipeline_run(pipeline, PIPELINE_BENCH_FRAMES);
+  if (res < 0)
+  {
+    pipeline_destroy(pipeline);
+    return res;
+  }
+
+  for (size_t i = 0; i < pipeline->stage_count; i++)
+  {
+    pipeline_stage_t* stage = &pipeline->stages[i];
+    uart_send_string(stage->config.name);
+    uart_send_string(": ");
+    uart_send_string(uint_to_str(stage->stats.frames ? stage->stats.busy_ticks / stage->stats.frames : 0));
+    uart_send_string(" ticks/frame, max ");
+    uart_send_string(uint_to_str(stage->stats.max_ticks));
+    uart_send_string(", stalls ");
+    uart_send_string(uint_to_str(stage->stats.stalls));
+    uart_send_string("\n");
+  }
+
+  pipeline_stats_t stats;
+  pipeline_get_stats(pipeline, &stats);
+
+  // On one CPU a step runs every stage, with one CPU per stage it lasts as long as the slowest
+  uart_send_string(uint_to_str(stats.completed));
+  uart_send_string(" frames, ");
+  uart_send_string(uint_to_str(stats.frames_per_sec));
+  uart_send_string(" fps, latency ");
+  uart_send_string(uint_to_str(stats.avg_latency));
+  uart_send_string(" ticks (max ");
+  uart_send_string(uint_to_str(stats.max_latency));
+  uart_send_string("), depth x slowest stage ");
+  uart_send_string(uint_to_str(pipeline->stage_count * stats.slowest_stage));
+  uart_send_string(" ticks\n");
+
+  // Regression runs keep the raw numbers on the host: the end to end
+  // stats followed by one record per stage
+  if (semihost_present())
+  {
+    size_t size = sizeof(stats) + (pipeline->stage_count * sizeof(pipeline_stage_stats_t));
+    uint8_t* results = (uint8_t*)kmalloc(size);
+    if (results)
+    {
+      memcpy(results, &stats, sizeof(stats));
+      for (size_t i = 0; i < pipeline->stage_count; i++)
+      {
+        memcpy(results + sizeof(stats) + (i * sizeof(pipeline_stage_stats_t)), &pipeline->stages[i].stats,
+               sizeof(pipeline_stage_stats_t));
+      }
+
+      if (semihost_write_file(PIPELINE_BENCH_RESULTS, results, size) < 0)
+      {
+        uart_send_string("pipeline: could not write " PIPELINE_BENCH_RESULTS "\n");
+      }
+      kfree(results);
+    }
+  }
+
+  pipeline_destroy(pipeline);
+  return EOK;
+}
+
+// Frame pipeline test stage, adds 1 to every byte
+static int pipeline_test_add(pipeline_frame_t* frame, void* private_data)
+{
+  int8_t* data = (int8_t*)frame->tensor->data;
+  size_t size = ai_tensor_get_size(frame->tensor);
+
+  for (size_t i = 0; i < size; i++)
+  {
+    data[i]++;
+  }
+
+  return EOK;
+}
+
+// Frame pipeline test sink, checks the order and contents of the frames
+static int pipeline_test_sink(pipeline_frame_t* frame, void* private_data)
+{
+  pipeline_test_sink_t* sink = (pipeline_test_sink_t*)private_data;
+
+  if (frame->sequence < sink->next_sequence)
+  {
+    sink->ordered = false;
+  }
+  if (!pipeline_synthetic_check(frame, 1))
+  {
+    sink->intact = false;
+  }
+
+  sink->next_sequence = frame->sequence + 1;
+  sink->frames++;
+  return EOK;
+}
+
+/**
+ * @brief Test the frame pipeline: in order delivery with back-pressure,
+ * drop-oldest on a slow sink pinned to another CPU and pool accounting
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_test()
+{
+  uart_send_string("\n=== Testing Frame Pipeline ===\n");
+
+  pipeline_test_sink_t sink = { 0, 0, true, true };
+  size_t shape[4] = { 1, 4, 4, 3 };
+  pipeline_stage_config_t stages[3] = {
+    { "capture", pipeline_synthetic_source, NULL, PIPELINE_POLICY_BLOCK, PIPELINE_CPU_ANY },
+    { "add", pipeline_test_add, NULL, PIPELINE_POLICY_BLOCK, PIPELINE_CPU_ANY },
+    { "sink", pipeline_test_sink, &sink, PIPELINE_POLICY_BLOCK, PIPELINE_CPU_ANY }
+  };
+
+  pipeline_t* pipeline = NULL;
+  if (pipeline_create(stages, 1, shape, 4, TENSOR_TYPE_INT8, &pipeline) != -EINVARG)
+  {
+    uart_send_string("FAIL: Single stage pipeline accepted\n");
+    return -EINVAL;
+  }
+
+  // Blocking stages lose nothing
+  int res = pipeline_create(stages, 3, shape, 4, TENSOR_TYPE_INT8, &pipeline);
+  if (res < 0)
+  {
+    uart_send_string("FAIL: Pipeline creation failed\n");
+    return res;
+  }
+
+  pipeline_stats_t stats;
+  res = pipeline_run(pipeline, PIPELINE_TEST_FRAMES);
+  pipeline_get_stats(pipeline, &stats);
+  if (res < 0 || sink.frames != PIPELINE_TEST_FRAMES || !sink.ordered || !sink.intact ||
+      stats.completed != PIPELINE_TEST_FRAMES || stats.dropped != 0 || !pipeline_idle(pipeline))
+  {
+    uart_send_string("FAIL: Blocking pipeline lost or reordered frames\n");
+    pipeline_destroy(pipeline);
+    return -EINVAL;
+  }
+
+  uart_send_string("Blocking pipeline: ");
+  uart_send_string(uint_to_str(stats.completed));
+  uart_send_string(" frames, latency ");
+  uart_send_string(uint_to_str(stats.avg_latency));
+  uart_send_string(" ticks\n");
+  pipeline_destroy(pipeline);
+
+  // The sink runs at a third of the source rate, the capture drops the oldest frames
+  sink = (pipeline_test_sink_t){ 0, 0, true, true };
+  stages[0].policy = PIPELINE_POLICY_DROP_OLDEST;
+  stages[0].cpu = 0;
+  stages[1].cpu = 0;
+  stages[2].cpu = 1;
+  res = pipeline_create(stages, 3, shape, 4, TENSOR_TYPE_INT8, &pipeline);
+  if (res < 0)
+  {
+    uart_send_string("FAIL: Pipeline creation failed\n");
+    return res;
+  }
+
+  pipeline_start(pipeline, PIPELINE_TEST_DROP_FRAMES);
+  while (!pipeline_idle(pipeline))
+  {
+    pipeline_poll(pipeline, 0);
+    pipeline_poll(pipeline, 0);
+    pipeline_poll(pipeline, 0);
+    pipeline_poll(pipeline, 1);
+  }
+
+  pipeline_get_stats(pipeline, &stats);
+  if (stats.dropped == 0 || !sink.ordered || !sink.intact || stats.captured != PIPELINE_TEST_DROP_FRAMES ||
+      sink.frames + stats.dropped != PIPELINE_TEST_DROP_FRAMES)
+  {
+    uart_send_string("FAIL: Drop-oldest accounting\n");
+    pipeline_destroy(pipeline);
+    return -EINVAL;
+  }
+
+  uart_send_string("Drop-oldest pipeline: ");
+  uart_send_string(uint_to_str(sink.frames));
+  uart_send_string(" delivered, ");
+  uart_send_string(uint_to_str(stats.dropped));
+  uart_send_string(" dropped\n");
+  pipeline_destroy(pipeline);
+
+  uart_send_string("Frame pipeline tests PASSED\n");
+  return EOK;
+}
@@ -0,0 +1,1283 @@
+/*
+ * rnn.c - This file implements the recurrent cells. Weights are packed
+ * once into tiles of four rows stored column by column: the GEMV
+ * broadcasts each element of [x; h] against a whole tile and never
+ * reduces across lanes. Gate activations come from the fast math
+ * library and the state is updated in place, a step allocates nothing.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "rnn.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/math/fastmath.h>
+#include <synapse/scheduler/preempt.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// 4 floats, one NEON register, only element aligned
+typedef float v4f __attribute__((vector_size(16), aligned(4)));
+// 4 INT32 accumulators, one NEON register
+typedef int32_t v4i __attribute__((vector_size(16)));
+// One column of an INT8 tile
+typedef int8_t v4i8 __attribute__((vector_size(4), aligned(1)));
+
+// Gates per cell type, in the PyTorch weights
+#define RNN_LSTM_GATES 4
+#define RNN_GRU_GATES 3
+// GRU bias layout: r and z merged, then n on x and n on h
+#define RNN_GRU_BIAS_GATES 4
+
+#define RNN_INT8_MAX 127
+
+// Benchmark configuration (6-axis IMU input)
+#define RNN_BENCH_INPUT 6
+#define RNN_BENCH_HIDDEN 64
+#define RNN_BENCH_STEPS 1000
+#define RNN_BENCH_STREAM 0x494D55 // "IMU"
+
+// States bound to streams
+static ai_rnn_state_t rnn_states[AI_RNN_MAX_STATES];
+
+// Recurrent cell test configuration (hidden size not a multiple of 4)
+#define RNN_TEST_INPUT 3
+#define RNN_TEST_HIDDEN 5
+#define RNN_TEST_STEPS 3
+#define RNN_TEST_FP32_TOLERANCE 1e-5f
+#define RNN_TEST_INT8_TOLERANCE 0.01f
+#define RNN_TEST_STREAM 7
+
+/**
+ * @brief Check that a tensor is dense with the given type
+ * 
+ * @param tensor Tensor to check
+ * @param dtype Expected type
+ * @return bool true if the tensor can be used by the kernels
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool rnn_is_operand(tensor_t* tensor, tensor_dtype_t dtype)
+{
+  return tensor && tensor->data && !tensor->sparse && tensor->dtype == dtype;
+}
+
+/**
+ * @brief Get the number of elements of a tensor
+ * 
+ * @param tensor Tensor
+ * @return size_t Number of elements
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t rnn_elems(tensor_t* tensor)
+{
+  size_t elems = 1;
+  for (size_t i = 0; i < tensor->ndim; i++)
+  {
+    elems *= tensor->shape[i];
+  }
+
+  return elems;
+}
+
+/**
+ * @brief Round a row count up to whole tiles
+ * 
+ * @param rows Rows
+ * @return size_t Rows including the padding of the last tile
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t rnn_pad(size_t rows)
+{
+  return (rows + AI_RNN_TILE_ROWS - 1) & ~(size_t)(AI_RNN_TILE_ROWS - 1);
+}
+
+/**
+ * @brief Round to the nearest integer, halves away from zero
+ * 
+ * @param value Value
+ * @return int32_t Rounded value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int32_t rnn_round(float value)
+{
+  return (int32_t)(value + (value >= 0 ? 0.5f : -0.5f));
+}
+
+/**
+ * @brief Create a zeroed vector
+ * 
+ * @param elems Number of elements
+ * @param dtype TENSOR_TYPE_FLOAT32 or TENSOR_TYPE_INT8
+ * @return tensor_t* Tensor, NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static tensor_t* rnn_vector_create(size_t elems, tensor_dtype_t dtype)
+{
+  size_t shape[1] = { elems };
+  tensor_t* tensor = ai_tensor_create(shape, 1, dtype, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  if (tensor)
+  {
+    memset(tensor->data, 0, elems * (dtype == TENSOR_TYPE_INT8 ? sizeof(int8_t) : sizeof(float)));
+  }
+
+  return tensor;
+}
+
+/**
+ * @brief Pack rows of the PyTorch weights into GEMV tiles
+ * 
+ * Packed row r of gate g is row j = r % hidden of source gate
+ * gate_order[g], its w_ih part followed by its w_hh part. Either part
+ * may be absent, padding rows are zero.
+ * 
+ * @param matrix Matrix to fill
+ * @param dtype FLOAT32 or INT8 (quantized per row)
+ * @param w_ih Input weights, NULL to leave them out
+ * @param ih_cols Columns of w_ih
+ * @param w_hh Hidden weights, NULL to leave them out
+ * @param hh_cols Columns of w_hh
+ * @param gate_order Source gate of each packed gate
+ * @param gates Number of packed gates
+ * @param hidden Rows per gate
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int rnn_matrix_pack(ai_rnn_matrix_t* matrix, tensor_dtype_t dtype, const float* w_ih, size_t ih_cols,
+                           const float* w_hh, size_t hh_cols, const size_t* gate_order, size_t gates, size_t hidden)
+{
+  if (!w_ih)
+  {
+    ih_cols = 0;
+  }
+  if (!w_hh)
+  {
+    hh_cols = 0;
+  }
+
+  size_t rows = gates * hidden;
+  size_t cols = ih_cols + hh_cols;
+  size_t padded = rnn_pad(rows);
+  size_t shape[2] = { padded / AI_RNN_TILE_ROWS, cols * AI_RNN_TILE_ROWS };
+
+  matrix->rows = rows;
+  matrix->cols = cols;
+  matrix->weights = ai_tensor_create(shape, 2, dtype, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  if (!matrix->weights)
+  {
+    return -ENOMEM;
+  }
+
+  if (dtype == TENSOR_TYPE_INT8)
+  {
+    matrix->scales = rnn_vector_create(padded, TENSOR_TYPE_FLOAT32);
+    if (!matrix->scales)
+    {
+      return -ENOMEM;
+    }
+  }
+
+  float* f32 = (float*)matrix->weights->data;
+  int8_t* i8 = (int8_t*)matrix->weights->data;
+  for (size_t r = 0; r < padded; r++)
+  {
+    const float* ih = NULL;
+    const float* hh = NULL;
+    if (r < rows)
+    {
+      size_t src = (gate_order[r / hidden] * hidden) + (r % hidden);
+      ih = w_ih ? w_ih + (src * ih_cols) : NULL;
+      hh = w_hh ? w_hh + (src * hh_cols) : NULL;
+    }
+
+    // Symmetric per row scale, a zero row keeps a scale of 1
+    float scale = 1.0f;
+    if (dtype == TENSOR_TYPE_INT8)
+    {
+      float max_abs = 0;
+      for (size_t k = 0; k < cols && r < rows; k++)
+      {
+        float value = k < ih_cols ? ih[k] : hh[k - ih_cols];
+        value = value < 0 ? -value : value;
+        max_abs = value > max_abs ? value : max_abs;
+      }
+      scale = max_abs > 0 ? max_abs / RNN_INT8_MAX : 1.0f;
+      ((float*)matrix->scales->data)[r] = scale;
+    }
+
+    size_t base = (r / AI_RNN_TILE_ROWS) * cols * AI_RNN_TILE_ROWS + (r % AI_RNN_TILE_ROWS);
+    for (size_t k = 0; k < cols; k++)
+    {
+      float value = r >= rows ? 0 : (k < ih_cols ? ih[k] : hh[k - ih_cols]);
+      if (dtype == TENSOR_TYPE_INT8)
+      {
+        // |value| <= 127 * scale, rounding cannot leave the range
+        i8[base + (k * AI_RNN_TILE_ROWS)] = (int8_t)rnn_round(value / scale);
+      }
+      else
+      {
+        f32[base + (k * AI_RNN_TILE_ROWS)] = value;
+      }
+    }
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Free the tensors of a packed matrix
+ * 
+ * @param matrix Matrix
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rnn_matrix_free(ai_rnn_matrix_t* matrix)
+{
+  if (matrix->weights)
+    ai_tensor_destroy(matrix->weights);
+  if (matrix->scales)
+    ai_tensor_destroy(matrix->scales);
+  matrix->weights = NULL;
+  matrix->scales = NULL;
+}
+
+/**
+ * @brief y = W x with FLOAT32 tiles, two accumulators per tile
+ * 
+ * @param matrix Packed matrix
+ * @param x Input, cols elements
+ * @param y Output, rows rounded up to whole tiles
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rnn_gemv_f32(const ai_rnn_matrix_t* matrix, const float* x, float* y)
+{
+  const float* w = (const float*)matrix->weights->data;
+  size_t cols = matrix->cols;
+  size_t tiles = rnn_pad(matrix->rows) / AI_RNN_TILE_ROWS;
+
+  for (size_t t = 0; t < tiles; t++)
+  {
+    const float* tile = w + (t * cols * AI_RNN_TILE_ROWS);
+    v4f acc0 = { 0, 0, 0, 0 };
+    v4f acc1 = { 0, 0, 0, 0 };
+
+    size_t k = 0;
+    for (; k + 2 <= cols; k += 2)
+    {
+      acc0 += *(const v4f*)(tile + (k * AI_RNN_TILE_ROWS)) * x[k];
+      acc1 += *(const v4f*)(tile + ((k + 1) * AI_RNN_TILE_ROWS)) * x[k + 1];
+    }
+    if (k < cols)
+    {
+      acc0 += *(const v4f*)(tile + (k * AI_RNN_TILE_ROWS)) * x[k];
+    }
+
+    *(v4f*)(y + (t * AI_RNN_TILE_ROWS)) = acc0 + acc1;
+  }
+}
+
+/**
+ * @brief y = W x with INT8 tiles and INT8 input, INT32 accumulators
+ * 
+ * @param matrix Packed matrix
+ * @param x Quantized input, cols elements
+ * @param x_scale Scale of the input
+ * @param y Output, rows rounded up to whole tiles
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rnn_gemv_int8(const ai_rnn_matrix_t* matrix, const int8_t* x, float x_scale, float* y)
+{
+  const int8_t* w = (const int8_t*)matrix->weights->data;
+  const float* scales = (const float*)matrix->scales->data;
+  size_t cols = matrix->cols;
+  size_t tiles = rnn_pad(matrix->rows) / AI_RNN_TILE_ROWS;
+
+  for (size_t t = 0; t < tiles; t++)
+  {
+    const int8_t* tile = w + (t * cols * AI_RNN_TILE_ROWS);
+    v4i acc0 = { 0, 0, 0, 0 };
+    v4i acc1 = { 0, 0, 0, 0 };
+
+    size_t k = 0;
+    for (; k + 2 <= cols; k += 2)
+    {
+      acc0 += __builtin_convertvector(*(const v4i8*)(tile + (k * AI_RNN_TILE_ROWS)), v4i) * (int32_t)x[k];
+      acc1 += __builtin_convertvector(*(const v4i8*)(tile + ((k + 1) * AI_RNN_TILE_ROWS)), v4i) * (int32_t)x[k + 1];
+    }
+    if (k < cols)
+    {
+      acc0 += __builtin_convertvector(*(const v4i8*)(tile + (k * AI_RNN_TILE_ROWS)), v4i) * (int32_t)x[k];
+    }
+
+    v4f row_scale = *(const v4f*)(scales + (t * AI_RNN_TILE_ROWS));
+    *(v4f*)(y + (t * AI_RNN_TILE_ROWS)) = __builtin_convertvector(acc0 + acc1, v4f) * row_scale * x_scale;
+  }
+}
+
+/**
+ * @brief y = W x with the weights of the cell
+ * 
+ * @param cell Cell
+ * @param matrix Packed matrix of the cell
+ * @param x FLOAT32 input
+ * @param x_q Quantized input, INT8 cells only
+ * @param x_scale Scale of x_q
+ * @param y Output
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rnn_gemv(ai_rnn_cell_t* cell, const ai_rnn_matrix_t* matrix, const float* x, const int8_t* x_q,
+                     float x_scale, float* y)
+{
+  if (cell->dtype == TENSOR_TYPE_INT8)
+  {
+    rnn_gemv_int8(matrix, x_q, x_scale, y);
+  }
+  else
+  {
+    rnn_gemv_f32(matrix, x, y);
+  }
+}
+
+/**
+ * @brief Quantize a vector symmetrically with one scale
+ * 
+ * @param src FLOAT32 values
+ * @param dst INT8 output
+ * @param count Number of values
+ * @return float Scale of the output
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static float rnn_quantize(const float* src, int8_t* dst, size_t count)
+{
+  float max_abs = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    float value = src[i] < 0 ? -src[i] : src[i];
+    max_abs = value > max_abs ? value : max_abs;
+  }
+
+  float scale = max_abs > 0 ? max_abs / RNN_INT8_MAX : 1.0f;
+  float inv = 1.0f / scale;
+  for (size_t i = 0; i < count; i++)
+  {
+    dst[i] = (int8_t)rnn_round(src[i] * inv);
+  }
+
+  return scale;
+}
+
+/**
+ * @brief Get the gates of a cell type
+ * 
+ * @param type Cell type
+ * @return size_t Gates in the PyTorch weights
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t rnn_gates(ai_rnn_type_t type)
+{
+  return type == AI_RNN_LSTM ? RNN_LSTM_GATES : RNN_GRU_GATES;
+}
+
+/**
+ * @brief Create a cell and prepack its weights
+ * 
+ * @param type Cell type
+ * @param dtype TENSOR_TYPE_FLOAT32, or TENSOR_TYPE_INT8 to quantize the
+ * weights per row
+ * @param w_ih FLOAT32 input weights, G*H x I (G = 4 for LSTM, 3 for GRU)
+ * @param w_hh FLOAT32 hidden weights, G*H x H
+ * @param b_ih FLOAT32 input bias, G*H elements, may be NULL
+ * @param b_hh FLOAT32 hidden bias, G*H elements, may be NULL
+ * @param out_cell Output for the cell
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_cell_create(ai_rnn_type_t type, tensor_dtype_t dtype, tensor_t* w_ih, tensor_t* w_hh, tensor_t* b_ih,
+                       tensor_t* b_hh, ai_rnn_cell_t** out_cell)
+{
+  if (!out_cell || (type != AI_RNN_LSTM && type != AI_RNN_GRU) ||
+      (dtype != TENSOR_TYPE_FLOAT32 && dtype != TENSOR_TYPE_INT8))
+  {
+    return -EINVARG;
+  }
+
+  if (!rnn_is_operand(w_ih, TENSOR_TYPE_FLOAT32) || !rnn_is_operand(w_hh, TENSOR_TYPE_FLOAT32) ||
+      w_ih->ndim != 2 || w_hh->ndim != 2)
+  {
+    return -EINVARG;
+  }
+
+  size_t gates = rnn_gates(type);
+  size_t rows = w_ih->shape[0];
+  size_t hidden = rows / gates;
+  size_t input = w_ih->shape[1];
+  if (hidden == 0 || input == 0 || rows % gates != 0 || w_hh->shape[0] != rows || w_hh->shape[1] != hidden)
+  {
+    return -EINVARG;
+  }
+
+  if ((b_ih && (!rnn_is_operand(b_ih, TENSOR_TYPE_FLOAT32) || rnn_elems(b_ih) != rows)) ||
+      (b_hh && (!rnn_is_operand(b_hh, TENSOR_TYPE_FLOAT32) || rnn_elems(b_hh) != rows)))
+  {
+    return -EINVARG;
+  }
+
+  ai_rnn_cell_t* cell = (ai_rnn_cell_t*)kzalloc(sizeof(ai_rnn_cell_t));
+  if (!cell)
+  {
+    return -ENOMEM;
+  }
+
+  cell->type = type;
+  cell->dtype = dtype;
+  cell->input_size = input;
+  cell->hidden_size = hidden;
+
+  const float* wi = (const float*)w_ih->data;
+  const float* wh = (const float*)w_hh->data;
+  const float* bi = b_ih ? (const float*)b_ih->data : NULL;
+  const float* bh = b_hh ? (const float*)b_hh->data : NULL;
+  size_t preact = 0;
+  int res = EOK;
+
+  if (type == AI_RNN_LSTM)
+  {
+    // Sigmoid gates first so one call activates i, f and o
+    static const size_t order[RNN_LSTM_GATES] = { 0, 1, 3, 2 };
+    res = rnn_matrix_pack(&cell->gates, dtype, wi, input, wh, hidden, order, RNN_LSTM_GATES, hidden);
+    preact = rnn_pad(rows);
+
+    cell->bias = rnn_vector_create(rows, TENSOR_TYPE_FLOAT32);
+    if (res == EOK && cell->bias)
+    {
+      float* bias = (float*)cell->bias->data;
+      for (size_t r = 0; r < rows; r++)
+      {
+        size_t src = (order[r / hidden] * hidden) + (r % hidden);
+        bias[r] = (bi ? bi[src] : 0) + (bh ? bh[src] : 0);
+      }
+    }
+  }
+  else
+  {
+    static const size_t gates_order[2] = { 0, 1 };
+    static const size_t candidate_order[1] = { 2 };
+    res = rnn_matrix_pack(&cell->gates, dtype, wi, input, wh, hidden, gates_order, 2, hidden);
+    if (res == EOK)
+    {
+      res = rnn_matrix_pack(&cell->candidate_x, dtype, wi, input, NULL, 0, candidate_order, 1, hidden);
+    }
+    if (res == EOK)
+    {
+      res = rnn_matrix_pack(&cell->candidate_h, dtype, NULL, 0, wh, hidden, candidate_order, 1, hidden);
+    }
+    preact = rnn_pad(2 * hidden) + (2 * rnn_pad(hidden));
+
+    // r and z biases add up, the n biases stay apart
+    cell->bias = rnn_vector_create(RNN_GRU_BIAS_GATES * hidden, TENSOR_TYPE_FLOAT32);
+    if (res == EOK && cell->bias)
+    {
+      float* bias = (float*)cell->bias->data;
+      for (size_t r = 0; r < 2 * hidden; r++)
+      {
+        bias[r] = (bi ? bi[r] : 0) + (bh ? bh[r] : 0);
+      }
+      for (size_t j = 0; j < hidden; j++)
+      {
+        bias[(2 * hidden) + j] = bi ? bi[(2 * hidden) + j] : 0;
+        bias[(3 * hidden) + j] = bh ? bh[(2 * hidden) + j] : 0;
+      }
+    }
+  }
+
+  cell->xh = rnn_vector_create(input + hidden, TENSOR_TYPE_FLOAT32);
+  cell->preact = rnn_vector_create(preact, TENSOR_TYPE_FLOAT32);
+  if (dtype == TENSOR_TYPE_INT8)
+  {
+    cell->xh_q = rnn_vector_create(input + hidden, TENSOR_TYPE_INT8);
+  }
+
+  if (res == EOK && (!cell->bias || !cell->xh || !cell->preact || (dtype == TENSOR_TYPE_INT8 && !cell->xh_q)))
+  {
+    res = -ENOMEM;
+  }
+
+  if (res < 0)
+  {
+    ai_rnn_cell_destroy(cell);
+    return res;
+  }
+
+  *out_cell = cell;
+  return EOK;
+}
+
+/**
+ * @brief Destroy a cell
+ * 
+ * @param cell Cell
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void ai_rnn_cell_destroy(ai_rnn_cell_t* cell)
+{
+  if (!cell)
+  {
+    return;
+  }
+
+  rnn_matrix_free(&cell->gates);
+  rnn_matrix_free(&cell->candidate_x);
+  rnn_matrix_free(&cell->candidate_h);
+  if (cell->bias)
+    ai_tensor_destroy(cell->bias);
+  if (cell->xh)
+    ai_tensor_destroy(cell->xh);
+  if (cell->xh_q)
+    ai_tensor_destroy(cell->xh_q);
+  if (cell->preact)
+    ai_tensor_destroy(cell->preact);
+
+  kfree(cell);
+}
+
+/**
+ * @brief Find the state of a stream
+ * 
+ * @param stream_id Stream id
+ * @return ai_rnn_state_t* State, NULL if the stream has none
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+ai_rnn_state_t* ai_rnn_state_find(uint32_t stream_id)
+{
+  for (size_t i = 0; i < AI_RNN_MAX_STATES; i++)
+  {
+    if (rnn_states[i].in_use && rnn_states[i].stream_id == stream_id)
+    {
+      return &rnn_states[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Get the state of a stream, creating a zeroed one on first use
+ * 
+ * @param stream_id Stream id chosen by the caller
+ * @param cell Cell the state is used with
+ * @param out_state Output for the state
+ * @return int EOK on success, -EINVAL if the stream is bound to another
+ * cell shape, -ENOMEM if every state is in use
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_state_bind(uint32_t stream_id, ai_rnn_cell_t* cell, ai_rnn_state_t** out_state)
+{
+  if (!cell || !out_state)
+  {
+    return -EINVARG;
+  }
+
+  ai_rnn_state_t* state = ai_rnn_state_find(stream_id);
+  if (state)
+  {
+    if (state->type != cell->type || state->hidden_size != cell->hidden_size)
+    {
+      return -EINVAL;
+    }
+
+    *out_state = state;
+    return EOK;
+  }
+
+  for (size_t i = 0; i < AI_RNN_MAX_STATES && !state; i++)
+  {
+    if (!rnn_states[i].in_use)
+    {
+      state = &rnn_states[i];
+    }
+  }
+
+  if (!state)
+  {
+    return -ENOMEM;
+  }
+
+  state->hidden = rnn_vector_create(cell->hidden_size, TENSOR_TYPE_FLOAT32);
+  state->cell = cell->type == AI_RNN_LSTM ? rnn_vector_create(cell->hidden_size, TENSOR_TYPE_FLOAT32) : NULL;
+  if (!state->hidden || (cell->type == AI_RNN_LSTM && !state->cell))
+  {
+    if (state->hidden)
+      ai_tensor_destroy(state->hidden);
+    if (state->cell)
+      ai_tensor_destroy(state->cell);
+    memset(state, 0, sizeof(ai_rnn_state_t));
+    return -ENOMEM;
+  }
+
+  state->stream_id = stream_id;
+  state->type = cell->type;
+  state->hidden_size = cell->hidden_size;
+  state->steps = 0;
+  state->in_use = true;
+
+  *out_state = state;
+  return EOK;
+}
+
+/**
+ * @brief Zero the state of a stream, at the start of a new sequence
+ * 
+ * @param stream_id Stream id
+ * @return int EOK on success, -ENOENT if the stream has no state
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_state_reset(uint32_t stream_id)
+{
+  ai_rnn_state_t* state = ai_rnn_state_find(stream_id);
+  if (!state)
+  {
+    return -ENOENT;
+  }
+
+  memset(state->hidden->data, 0, state->hidden_size * sizeof(float));
+  if (state->cell)
+  {
+    memset(state->cell->data, 0, state->hidden_size * sizeof(float));
+  }
+  state->steps = 0;
+
+  return EOK;
+}
+
+/**
+ * @brief Free the state of a stream
+ * 
+ * @param stream_id Stream id
+ * @return int EOK on success, -ENOENT if the stream has no state
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_state_release(uint32_t stream_id)
+{
+  ai_rnn_state_t* state = ai_rnn_state_find(stream_id);
+  if (!state)
+  {
+    return -ENOENT;
+  }
+
+  ai_tensor_destroy(state->hidden);
+  if (state->cell)
+  {
+    ai_tensor_destroy(state->cell);
+  }
+  memset(state, 0, sizeof(ai_rnn_state_t));
+
+  return EOK;
+}
+
+/**
+ * @brief Run one time step and update the state in place
+ * 
+ * @param cell Cell
+ * @param state State bound with the cell
+ * @param x FLOAT32 input, I elements
+ * @param y FLOAT32 output for the new h, may be NULL
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_cell_step(ai_rnn_cell_t* cell, ai_rnn_state_t* state, tensor_t* x, tensor_t* y)
+{
+  if (!cell || !state || !state->in_use || state->type != cell->type || state->hidden_size != cell->hidden_size)
+  {
+    return -EINVARG;
+  }
+
+  if (!rnn_is_operand(x, TENSOR_TYPE_FLOAT32) || rnn_elems(x) != cell->input_size)
+  {
+    return -EINVARG;
+  }
+
+  if (y && (!rnn_is_operand(y, TENSOR_TYPE_FLOAT32) || rnn_elems(y) != cell->hidden_size))
+  {
+    return -EINVARG;
+  }
+
+  size_t input = cell->input_size;
+  size_t hidden = cell->hidden_size;
+  float* xh = (float*)cell->xh->data;
+  float* pre = (float*)cell->preact->data;
+  const float* bias = (const float*)cell->bias->data;
+  float* h = (float*)state->hidden->data;
+
+  // [x; h] feeds every gate in one GEMV
+  memcpy(xh, x->data, (int)(input * sizeof(float)));
+  memcpy(xh + input, h, (int)(hidden * sizeof(float)));
+
+  int8_t* xh_q = NULL;
+  float scale = 0;
+  if (cell->dtype == TENSOR_TYPE_INT8)
+  {
+    xh_q = (int8_t*)cell->xh_q->data;
+    scale = rnn_quantize(xh, xh_q, input + hidden);
+  }
+
+  if (cell->type == AI_RNN_LSTM)
+  {
+    // pre = [i f o g], c = f c + i g, h = o tanh(c)
+    float* c = (float*)state->cell->data;
+    rnn_gemv(cell, &cell->gates, xh, xh_q, scale, pre);
+    for (size_t r = 0; r < RNN_LSTM_GATES * hidden; r++)
+    {
+      pre[r] += bias[r];
+    }
+
+    fastmath_apply(FASTMATH_OP_SIGMOID, pre, pre, 3 * hidden);
+    fastmath_apply(FASTMATH_OP_TANH, pre + (3 * hidden), pre + (3 * hidden), hidden);
+
+    for (size_t j = 0; j < hidden; j++)
+    {
+      c[j] = (pre[hidden + j] * c[j]) + (pre[j] * pre[(3 * hidden) + j]);
+    }
+
+    fastmath_apply(FASTMATH_OP_TANH, c, h, hidden);
+    for (size_t j = 0; j < hidden; j++)
+    {
+      h[j] *= pre[(2 * hidden) + j];
+    }
+  }
+  else
+  {
+    // pre = [r z | n_x | n_h], n = tanh(n_x + r n_h), h = n + z (h - n)
+    float* n = pre + rnn_pad(2 * hidden);
+    float* n_h = n + rnn_pad(hidden);
+    rnn_gemv(cell, &cell->gates, xh, xh_q, scale, pre);
+    rnn_gemv(cell, &cell->candidate_x, xh, xh_q, scale, n);
+    rnn_gemv(cell, &cell->candidate_h, xh + input, xh_q ? xh_q + input : NULL, scale, n_h);
+
+    for (size_t r = 0; r < 2 * hidden; r++)
+    {
+      pre[r] += bias[r];
+    }
+    fastmath_apply(FASTMATH_OP_SIGMOID, pre, pre, 2 * hidden);
+
+    for (size_t j = 0; j < hidden; j++)
+    {
+      n[j] += bias[(2 * hidden) + j] + (pre[j] * (n_h[j] + bias[(3 * hidden) + j]));
+    }
+    fastmath_apply(FASTMATH_OP_TANH, n, n, hidden);
+
+    for (size_t j = 0; j < hidden; j++)
+    {
+      h[j] = n[j] + (pre[hidden + j] * (h[j] - n[j]));
+    }
+  }
+
+  state->steps++;
+  if (y)
+  {
+    memcpy(y->data, h, (int)(hidden * sizeof(float)));
+  }
+
+  // Sequences are stepped one call at a time, yield between steps
+  cond_resched();
+
+  return EOK;
+}
+
+/**
+ * @brief One LSTM step on the unpacked PyTorch weights, row by row
+ * 
+ * @param w_ih Input weights, 4H x I
+ * @param w_hh Hidden weights, 4H x H
+ * @param bias Summed biases, 4H
+ * @param x Input
+ * @param h Hidden state, updated
+ * @param c Cell state, updated
+ * @param gates Scratch of 4H elements
+ * @param input Input size
+ * @param hidden Hidden size
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rnn_bench_lstm_step(const float* w_ih, const float* w_hh, const float* bias, const float* x, float* h,
+                                float* c, float* gates, size_t input, size_t hidden)
+{
+  for (size_t r = 0; r < RNN_LSTM_GATES * hidden; r++)
+  {
+    float sum = bias[r];
+    for (size_t k = 0; k < input; k++)
+    {
+      sum += w_ih[(r * input) + k] * x[k];
+    }
+    for (size_t k = 0; k < hidden; k++)
+    {
+      sum += w_hh[(r * hidden) + k] * h[k];
+    }
+    gates[r] = sum;
+  }
+
+  for (size_t j = 0; j < hidden; j++)
+  {
+    float i = fastmath_sigmoid(gates[j]);
+    float f = fastmath_sigmoid(gates[hidden + j]);
+    float g = fastmath_tanh(gates[(2 * hidden) + j]);
+    float o = fastmath_sigmoid(gates[(3 * hidden) + j]);
+    c[j] = (f * c[j]) + (i * g);
+    h[j] = o * fastmath_tanh(c[j]);
+  }
+}
+
+/**
+ * @brief Print a benchmark line
+ * 
+ * @param name Cell name
+ * @param ticks Timer ticks taken
+ * @param steps Steps run
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rnn_bench_print(const char* name, uint64_t ticks, uint64_t steps)
+{
+  uart_send_string(name);
+  uart_send_string(": ");
+  uart_send_string(uint_to_str((ticks * 1000000000ULL) / timer_read_frequency() / steps));
+  uart_send_string(" ns/step\n");
+}
+
+/**
+ * @brief Fill weights with deterministic values on the usual 1 / sqrt(H)
+ * scale
+ * 
+ * @param values Values to fill
+ * @param count Number of values
+ * @param seed Generator state, advanced
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rnn_bench_fill(float* values, size_t count, uint64_t* seed)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    *seed = (*seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+    values[i] = ((float)((*seed >> 40) % 2001) / 1000 - 1) * 0.125f;
+  }
+}
+
+/**
+ * @brief Create a benchmark cell with deterministic weights
+ * 
+ * @param type Cell type
+ * @param dtype Weight type
+ * @param out_cell Output for the cell
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int rnn_bench_cell(ai_rnn_type_t type, tensor_dtype_t dtype, ai_rnn_cell_t** out_cell)
+{
+  size_t rows = rnn_gates(type) * RNN_BENCH_HIDDEN;
+  size_t ih_shape[2] = { rows, RNN_BENCH_INPUT };
+  size_t hh_shape[2] = { rows, RNN_BENCH_HIDDEN };
+  size_t bias_shape[1] = { rows };
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  int res = -ENOMEM;
+
+  tensor_t* w_ih = ai_tensor_create(ih_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* w_hh = ai_tensor_create(hh_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* bias = ai_tensor_create(bias_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  if (w_ih && w_hh && bias)
+  {
+    rnn_bench_fill((float*)w_ih->data, rows * RNN_BENCH_INPUT, &seed);
+    rnn_bench_fill((float*)w_hh->data, rows * RNN_BENCH_HIDDEN, &seed);
+    rnn_bench_fill((float*)bias->data, rows, &seed);
+    res = ai_rnn_cell_create(type, dtype, w_ih, w_hh, bias, NULL, out_cell);
+  }
+
+  if (w_ih)
+    ai_tensor_destroy(w_ih);
+  if (w_hh)
+    ai_tensor_destroy(w_hh);
+  if (bias)
+    ai_tensor_destroy(bias);
+  return res;
+}
+
+/**
+ * @brief Time a step of IMU sized LSTM and GRU cells, FP32 and INT8,
+ * against an unpacked row-major step
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_benchmark()
+{
+  static const char* names[4] = { "LSTM FP32", "LSTM INT8", "GRU FP32", "GRU INT8" };
+  const size_t rows = RNN_LSTM_GATES * RNN_BENCH_HIDDEN;
+  size_t input_shape[1] = { RNN_BENCH_INPUT };
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  int res = EOK;
+
+  // Unpacked weights of the row-major step, then h, c and the gates
+  size_t floats = (rows * (RNN_BENCH_INPUT + RNN_BENCH_HIDDEN + 2)) + (2 * RNN_BENCH_HIDDEN);
+  float* baseline = (float*)kzalloc(floats * sizeof(float));
+  tensor_t* x = ai_tensor_create(input_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  if (!baseline || !x)
+  {
+    res = -ENOMEM;
+    goto out;
+  }
+
+  float* in = (float*)x->data;
+  for (size_t k = 0; k < RNN_BENCH_INPUT; k++)
+  {
+    in[k] = ((float)k - 2.5f) / 4;
+  }
+
+  uart_send_string("\n=== Recurrent Cell Benchmark ===\n");
+
+  for (int variant = 0; variant < 4; variant++)
+  {
+    ai_rnn_cell_t* cell = NULL;
+    ai_rnn_state_t* state = NULL;
+    res = rnn_bench_cell(variant < 2 ? AI_RNN_LSTM : AI_RNN_GRU,
+                         variant % 2 ? TENSOR_TYPE_INT8 : TENSOR_TYPE_FLOAT32, &cell);
+    if (res == EOK)
+    {
+      res = ai_rnn_state_bind(RNN_BENCH_STREAM, cell, &state);
+    }
+
+    uint64_t start = timer_read_counter();
+    for (size_t s = 0; res == EOK && s < RNN_BENCH_STEPS; s++)
+    {
+      res = ai_rnn_cell_step(cell, state, x, NULL);
+    }
+    uint64_t ticks = timer_read_counter() - start;
+
+    if (res == EOK)
+    {
+      rnn_bench_print(names[variant], ticks, RNN_BENCH_STEPS);
+    }
+
+    if (state)
+      ai_rnn_state_release(RNN_BENCH_STREAM);
+    ai_rnn_cell_destroy(cell);
+    if (res < 0)
+    {
+      goto out;
+    }
+  }
+
+  float* w_ih = baseline;
+  float* w_hh = w_ih + (rows * RNN_BENCH_INPUT);
+  float* bias = w_hh + (rows * RNN_BENCH_HIDDEN);
+  float* gates = bias + rows;
+  float* h = gates + rows;
+  rnn_bench_fill(w_ih, rows * RNN_BENCH_INPUT, &seed);
+  rnn_bench_fill(w_hh, rows * RNN_BENCH_HIDDEN, &seed);
+  rnn_bench_fill(bias, rows, &seed);
+
+  uint64_t start = timer_read_counter();
+  for (size_t s = 0; s < RNN_BENCH_STEPS; s++)
+  {
+    rnn_bench_lstm_step(w_ih, w_hh, bias, in, h, h + RNN_BENCH_HIDDEN, gates, RNN_BENCH_INPUT, RNN_BENCH_HIDDEN);
+  }
+  uint64_t ticks = timer_read_counter() - start;
+  rnn_bench_print("LSTM FP32 row-major", ticks, RNN_BENCH_STEPS);
+
+out:
+  if (baseline)
+    kfree(baseline);
+  if (x)
+    ai_tensor_destroy(x);
+  return res;
+}
+
+/**
+ * @brief One recurrent step on the PyTorch weights, gate by gate
+ * 
+ * @param type Cell type
+ * @param w_ih Input weights, G*H x I
+ * @param w_hh Hidden weights, G*H x H
+ * @param b_ih Input bias, G*H
+ * @param b_hh Hidden bias, G*H
+ * @param x Input
+ * @param h Hidden state, updated
+ * @param c Cell state (LSTM), updated
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rnn_test_reference(ai_rnn_type_t type, const float* w_ih, const float* w_hh, const float* b_ih,
+                                      const float* b_hh, const float* x, float* h, float* c)
+{
+  float gi[4 * RNN_TEST_HIDDEN];
+  float gh[4 * RNN_TEST_HIDDEN];
+  size_t rows = (type == AI_RNN_LSTM ? 4 : 3) * RNN_TEST_HIDDEN;
+
+  for (size_t r = 0; r < rows; r++)
+  {
+    gi[r] = b_ih[r];
+    gh[r] = b_hh[r];
+    for (size_t k = 0; k < RNN_TEST_INPUT; k++)
+    {
+      gi[r] += w_ih[(r * RNN_TEST_INPUT) + k] * x[k];
+    }
+    for (size_t k = 0; k < RNN_TEST_HIDDEN; k++)
+    {
+      gh[r] += w_hh[(r * RNN_TEST_HIDDEN) + k] * h[k];
+    }
+  }
+
+  for (size_t j = 0; j < RNN_TEST_HIDDEN; j++)
+  {
+    if (type == AI_RNN_LSTM)
+    {
+      float i = fastmath_sigmoid(gi[j] + gh[j]);
+      float f = fastmath_sigmoid(gi[RNN_TEST_HIDDEN + j] + gh[RNN_TEST_HIDDEN + j]);
+      float g = fastmath_tanh(gi[(2 * RNN_TEST_HIDDEN) + j] + gh[(2 * RNN_TEST_HIDDEN) + j]);
+      float o = fastmath_sigmoid(gi[(3 * RNN_TEST_HIDDEN) + j] + gh[(3 * RNN_TEST_HIDDEN) + j]);
+      c[j] = (f * c[j]) + (i * g);
+      h[j] = o * fastmath_tanh(c[j]);
+    }
+    else
+    {
+      float r = fastmath_sigmoid(gi[j] + gh[j]);
+      float z = fastmath_sigmoid(gi[RNN_TEST_HIDDEN + j] + gh[RNN_TEST_HIDDEN + j]);
+      float n = fastmath_tanh(gi[(2 * RNN_TEST_HIDDEN) + j] + (r * gh[(2 * RNN_TEST_HIDDEN) + j]));
+      h[j] = ((1 - z) * n) + (z * h[j]);
+    }
+  }
+}
+
+/**
+ * @brief Test the recurrent cells: FP32 and INT8 LSTM and GRU steps
+ * against a gate by gate reference, and states bound to streams
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rnn_test()
+{
+  size_t x_shape[1] = { RNN_TEST_INPUT };
+  size_t y_shape[1] = { RNN_TEST_HIDDEN };
+  tensor_t* params[2][4] = { { NULL } };
+  ai_rnn_cell_t* cell = NULL;
+  int res = EOK;
+
+  uart_send_string("\n=== Testing Recurrent Cells ===\n");
+
+  // w_ih, w_hh, b_ih and b_hh of the LSTM (4 gates) and the GRU (3 gates)
+  for (size_t t = 0; t < 2; t++)
+  {
+    size_t rows = (t == 0 ? 4 : 3) * RNN_TEST_HIDDEN;
+    size_t ih_shape[2] = { rows, RNN_TEST_INPUT };
+    size_t hh_shape[2] = { rows, RNN_TEST_HIDDEN };
+    size_t bias_shape[1] = { rows };
+    params[t][0] = ai_tensor_create(ih_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+    params[t][1] = ai_tensor_create(hh_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+    params[t][2] = ai_tensor_create(bias_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+    params[t][3] = ai_tensor_create(bias_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  }
+
+  tensor_t* x = ai_tensor_create(x_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* y = ai_tensor_create(y_shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  for (size_t i = 0; i < 4; i++)
+  {
+    if (!params[0][i] || !params[1][i])
+    {
+      res = -ENOMEM;
+    }
+  }
+  if (res != EOK || !x || !y)
+  {
+    uart_send_string("FAIL: Tensor creation failed\n");
+    res = -ENOMEM;
+    goto out;
+  }
+
+  // Weights in [-0.5, 0.5], the GRU takes the first three gates
+  size_t widths[4] = { RNN_TEST_INPUT, RNN_TEST_HIDDEN, 1, 1 };
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  for (size_t i = 0; i < 4; i++)
+  {
+    float* lstm = (float*)params[0][i]->data;
+    for (size_t k = 0; k < 4 * RNN_TEST_HIDDEN * widths[i]; k++)
+    {
+      seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+      lstm[k] = (float)((seed >> 40) % 1001) / 1000 - 0.5f;
+    }
+    memcpy(params[1][i]->data, lstm, (int)(3 * RNN_TEST_HIDDEN * widths[i] * sizeof(float)));
+  }
+
+  for (int variant = 0; variant < 4; variant++)
+  {
+    ai_rnn_type_t type = variant < 2 ? AI_RNN_LSTM : AI_RNN_GRU;
+    tensor_t** p = params[variant < 2 ? 0 : 1];
+    bool int8 = variant % 2;
+    float tolerance = int8 ? RNN_TEST_INT8_TOLERANCE : RNN_TEST_FP32_TOLERANCE;
+    ai_rnn_state_t* state = NULL;
+
+    res = ai_rnn_cell_create(type, int8 ? TENSOR_TYPE_INT8 : TENSOR_TYPE_FLOAT32, p[0], p[1], p[2], p[3], &cell);
+    if (res == EOK)
+    {
+      res = ai_rnn_state_bind(RNN_TEST_STREAM, cell, &state);
+    }
+    if (res != EOK)
+    {
+      uart_send_string("FAIL: Recurrent cell creation\n");
+      goto out;
+    }
+
+    float h[RNN_TEST_HIDDEN] = { 0 };
+    float c[RNN_TEST_HIDDEN] = { 0 };
+    float* in = (float*)x->data;
+    float* out = (float*)y->data;
+    for (size_t step = 0; step < RNN_TEST_STEPS; step++)
+    {
+      for (size_t k = 0; k < RNN_TEST_INPUT; k++)
+      {
+        in[k] = (float)((step * 3) + k) / 4 - 1;
+      }
+
+      rnn_test_reference(type, (float*)p[0]->data, (float*)p[1]->data, (float*)p[2]->data,
+                                (float*)p[3]->data, in, h, c);
+      res = ai_rnn_cell_step(cell, state, x, y);
+      for (size_t j = 0; res == EOK && j < RNN_TEST_HIDDEN; j++)
+      {
+        float diff = out[j] > h[j] ? out[j] - h[j] : h[j] - out[j];
+        if (diff > tolerance)
+        {
+          res = -EIO;
+        }
+      }
+
+      if (res != EOK)
+      {
+        uart_send_string("FAIL: Recurrent step differs from the reference, variant ");
+        uart_send_string(uint_to_str(variant));
+        uart_send_string("\n");
+        goto out;
+      }
+    }
+
+    // The stream keeps its state until reset
+    if (ai_rnn_state_find(RNN_TEST_STREAM) != state || state->steps != RNN_TEST_STEPS)
+    {
+      uart_send_string("FAIL: Stream state not kept\n");
+      res = -EIO;
+      goto out;
+    }
+
+    ai_rnn_state_reset(RNN_TEST_STREAM);
+    if (state->steps != 0 || ((float*)state->hidden->data)[0] != 0)
+    {
+      uart_send_string("FAIL: Stream state reset\n");
+      res = -EIO;
+      goto out;
+    }
+
+    // A GRU cannot pick up the state of an LSTM stream
+    if (variant == 1)
+    {
+      ai_rnn_state_t* other = NULL;
+      ai_rnn_cell_t* gru = NULL;
+      res = ai_rnn_cell_create(AI_RNN_GRU, TENSOR_TYPE_FLOAT32, params[1][0], params[1][1], NULL, NULL, &gru);
+      if (res == EOK)
+      {
+        res = ai_rnn_state_bind(RNN_TEST_STREAM, gru, &other) == -EINVAL ? EOK : -EIO;
+        ai_rnn_cell_destroy(gru);
+      }
+      if (res != EOK)
+      {
+        uart_send_string("FAIL: Stream bound to two cell shapes\n");
+        goto out;
+      }
+    }
+
+    if (ai_rnn_state_release(RNN_TEST_STREAM) != EOK || ai_rnn_state_find(RNN_TEST_STREAM) ||
+        ai_rnn_state_release(RNN_TEST_STREAM) != -ENOENT)
+    {
+      uart_send_string("FAIL: Stream state release\n");
+      res = -EIO;
+      goto out;
+    }
+
+    ai_rnn_cell_destroy(cell);
+    cell = NULL;
+  }
+
+  uart_send_string("Recurrent cell tests passed\n");
+
+out:
+  if (cell)
+  {
+    ai_rnn_state_release(RNN_TEST_STREAM);
+    ai_rnn_cell_destroy(cell);
+  }
+  for (size_t t = 0; t < 2; t++)
+  {
+    for (size_t i = 0; i < 4; i++)
+    {
+      if (params[t][i])
+        ai_tensor_destroy(params[t][i]);
+    }
+  }
+  if (x)
+    ai_tensor_destroy(x);
+  if (y)
+    ai_tensor_destroy(y);
+  return res;
+}
@@ -0,0 +1,674 @@
+/*
+ * sparse.c - This file implements the sparse tensor operations.
+ * Pruned weights are stored as CSR or block sparse (BSR) tensors
+ * and multiplied with dense activations.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "sparse.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/memory/memory.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/scheduler/preempt.h>
+#include <synapse/string/string.h>
+
+// Sparse tensor test configuration (M x K weights, K x N activations)
+#define SPARSE_TEST_M 8
+#define SPARSE_TEST_K 8
+#define SPARSE_TEST_N 6 // Not a multiple of 4, covers the column tail
+
+// Four float lanes held in one NEON register, only element aligned so
+// rows of any width can be loaded
+typedef float v4f __attribute__((vector_size(16), aligned(4)));
+
+/**
+ * @brief Check that a tensor is a dense 2D row-major matrix
+ * 
+ * @param tensor Tensor to check
+ * @return bool true if the tensor can be used as a dense matrix
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool sparse_is_dense_matrix(tensor_t* tensor)
+{
+  return tensor && !tensor->sparse && tensor->data && tensor->ndim == 2 &&
+         tensor->layout == TENSOR_LAYOUT_ROW_MAJOR &&
+         tensor->strides[1] == 1 && tensor->strides[0] == tensor->shape[1];
+}
+
+/**
+ * @brief Check if a block of a dense matrix only holds zeros
+ * 
+ * @param row First row of the block
+ * @param row_size Size of a matrix row in bytes
+ * @param block_rows Rows of the block
+ * @param block_size Size of a block row in bytes
+ * @return bool true if every byte of the block is zero
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool sparse_block_is_zero(const uint8_t* row, size_t row_size, size_t block_rows, size_t block_size)
+{
+  for (size_t i = 0; i < block_rows; i++)
+  {
+    for (size_t j = 0; j < block_size; j++)
+    {
+      if (row[j])
+      {
+        return false;
+      }
+    }
+    row += row_size;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Convert a dense 2D row-major tensor to a sparse tensor, elements
+ * (or whole blocks) equal to zero are not stored
+ * 
+ * @param dense Dense tensor to convert
+ * @param format TENSOR_FORMAT_CSR or TENSOR_FORMAT_BSR
+ * @param block_rows Rows per block (BSR only, 1 or 4 use the fast kernels)
+ * @param block_cols Columns per block (BSR only, 4 uses the fast kernels)
+ * @return tensor_t* Sparse tensor, or NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+tensor_t* ai_sparse_from_dense(tensor_t* dense, tensor_format_t format, size_t block_rows, size_t block_cols)
+{
+  if (!sparse_is_dense_matrix(dense))
+  {
+    return NULL;
+  }
+
+  if (format == TENSOR_FORMAT_CSR)
+  {
+    block_rows = 1;
+    block_cols = 1;
+  }
+
+  size_t rows = dense->shape[0];
+  size_t cols = dense->shape[1];
+  if (format != TENSOR_FORMAT_CSR && (format != TENSOR_FORMAT_BSR || block_rows == 0 || block_cols == 0 ||
+      (rows % block_rows) != 0 || (cols % block_cols) != 0))
+  {
+    return NULL;
+  }
+
+  size_t row_size = cols * dense->elem_size;
+  size_t block_size = block_cols * dense->elem_size;
+  size_t block_row_count = rows / block_rows;
+  size_t block_col_count = cols / block_cols;
+  uint8_t* src = (uint8_t*)dense->data;
+
+  // First pass counts the stored blocks
+  size_t nnz = 0;
+  for (size_t rb = 0; rb < block_row_count; rb++)
+  {
+    uint8_t* row = src + (rb * block_rows * row_size);
+    for (size_t cb = 0; cb < block_col_count; cb++)
+    {
+      if (!sparse_block_is_zero(row + (cb * block_size), row_size, block_rows, block_size))
+      {
+        nnz++;
+      }
+    }
+  }
+
+  tensor_t* sparse = ai_tensor_create_sparse(rows, cols, dense->dtype, format, block_rows, block_cols, nnz, dense->flags & TENSOR_MEM_ALIGNED);
+  if (!sparse)
+  {
+    return NULL;
+  }
+
+  // Second pass copies the stored blocks
+  uint32_t* row_ptr = sparse->sparse->row_ptr;
+  uint32_t* col_idx = sparse->sparse->col_idx;
+  uint8_t* values = (uint8_t*)sparse->data;
+  uint32_t p = 0;
+
+  for (size_t rb = 0; rb < block_row_count; rb++)
+  {
+    uint8_t* row = src + (rb * block_rows * row_size);
+    row_ptr[rb] = p;
+
+    for (size_t cb = 0; cb < block_col_count; cb++)
+    {
+      uint8_t* block = row + (cb * block_size);
+      if (sparse_block_is_zero(block, row_size, block_rows, block_size))
+      {
+        continue;
+      }
+
+      col_idx[p] = cb;
+      for (size_t i = 0; i < block_rows; i++)
+      {
+        memcpy(values, block + (i * row_size), block_size);
+        values += block_size;
+      }
+      p++;
+    }
+  }
+  row_ptr[block_row_count] = p;
+
+  return sparse;
+}
+
+/**
+ * @brief Expand a sparse tensor into a dense 2D row-major tensor
+ * 
+ * @param sparse Sparse tensor
+ * @param dense Dense tensor of the same shape and type
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_sparse_to_dense(tensor_t* sparse, tensor_t* dense)
+{
+  if (!sparse || !sparse->sparse || !sparse_is_dense_matrix(dense) ||
+      sparse->dtype != dense->dtype ||
+      sparse->shape[0] != dense->shape[0] || sparse->shape[1] != dense->shape[1])
+  {
+    return -EINVARG;
+  }
+
+  tensor_sparse_t* index = sparse->sparse;
+  size_t row_size = dense->shape[1] * dense->elem_size;
+  size_t block_size = index->block_cols * dense->elem_size;
+  size_t block_row_count = dense->shape[0] / index->block_rows;
+  uint8_t* values = (uint8_t*)sparse->data;
+  uint8_t* dst = (uint8_t*)dense->data;
+
+  memset(dst, 0, dense->shape[0] * row_size);
+
+  for (size_t rb = 0; rb < block_row_count; rb++)
+  {
+    uint8_t* row = dst + (rb * index->block_rows * row_size);
+    for (uint32_t p = index->row_ptr[rb]; p < index->row_ptr[rb + 1]; p++)
+    {
+      uint8_t* block = row + (index->col_idx[p] * block_size);
+      for (size_t i = 0; i < index->block_rows; i++)
+      {
+        memcpy(block + (i * row_size), values, block_size);
+        values += block_size;
+      }
+    }
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief FLOAT32 SpMM for 4x4 blocks, each block row produces four output
+ * rows, four columns at a time kept in registers across the whole block row
+ * 
+ * @param a Sparse weights (BSR 4x4)
+ * @param b Dense activations
+ * @param c Dense output
+ * @param n Number of columns of B and C
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void sparse_matmul_f32_bsr4x4(tensor_t* a, const float* b, float* c, size_t n)
+{
+  tensor_sparse_t* index = a->sparse;
+  const float* values = (const float*)a->data;
+  size_t block_row_count = a->shape[0] / 4;
+
+  for (size_t rb = 0; rb < block_row_count; rb++)
+  {
+    float* c0 = c + (rb * 4 * n);
+    float* c1 = c0 + n;
+    float* c2 = c1 + n;
+    float* c3 = c2 + n;
+    uint32_t start = index->row_ptr[rb];
+    uint32_t end = index->row_ptr[rb + 1];
+
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4)
+    {
+      v4f acc0 = {0, 0, 0, 0};
+      v4f acc1 = {0, 0, 0, 0};
+      v4f acc2 = {0, 0, 0, 0};
+      v4f acc3 = {0, 0, 0, 0};
+
+      for (uint32_t p = start; p < end; p++)
+      {
+        const float* blk = values + (p * 16);
+        const float* b0 = b + (index->col_idx[p] * 4 * n) + j;
+        v4f x0 = *(const v4f*)b0;
+        v4f x1 = *(const v4f*)(b0 + n);
+        v4f x2 = *(const v4f*)(b0 + (2 * n));
+        v4f x3 = *(const v4f*)(b0 + (3 * n));
+
+        acc0 += x0 * blk[0] + x1 * blk[1] + x2 * blk[2] + x3 * blk[3];
+        acc1 += x0 * blk[4] + x1 * blk[5] + x2 * blk[6] + x3 * blk[7];
+        acc2 += x0 * blk[8] + x1 * blk[9] + x2 * blk[10] + x3 * blk[11];
+        acc3 += x0 * blk[12] + x1 * blk[13] + x2 * blk[14] + x3 * blk[15];
+      }
+
+      *(v4f*)(c0 + j) = acc0;
+      *(v4f*)(c1 + j) = acc1;
+      *(v4f*)(c2 + j) = acc2;
+      *(v4f*)(c3 + j) = acc3;
+    }
+
+    // Remaining columns
+    for (; j < n; j++)
+    {
+      float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+      for (uint32_t p = start; p < end; p++)
+      {
+        const float* blk = values + (p * 16);
+        const float* b0 = b + (index->col_idx[p] * 4 * n) + j;
+        float x0 = b0[0];
+        float x1 = b0[n];
+        float x2 = b0[2 * n];
+        float x3 = b0[3 * n];
+
+        s0 += blk[0] * x0 + blk[1] * x1 + blk[2] * x2 + blk[3] * x3;
+        s1 += blk[4] * x0 + blk[5] * x1 + blk[6] * x2 + blk[7] * x3;
+        s2 += blk[8] * x0 + blk[9] * x1 + blk[10] * x2 + blk[11] * x3;
+        s3 += blk[12] * x0 + blk[13] * x1 + blk[14] * x2 + blk[15] * x3;
+      }
+
+      c0[j] = s0;
+      c1[j] = s1;
+      c2[j] = s2;
+      c3[j] = s3;
+    }
+
+    cond_resched();
+  }
+}
+
+/**
+ * @brief FLOAT32 SpMM for 1x4 blocks, finer pruning granularity than 4x4
+ * with the same four wide loads of B
+ * 
+ * @param a Sparse weights (BSR 1x4)
+ * @param b Dense activations
+ * @param c Dense output
+ * @param n Number of columns of B and C
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void sparse_matmul_f32_bsr1x4(tensor_t* a, const float* b, float* c, size_t n)
+{
+  tensor_sparse_t* index = a->sparse;
+  const float* values = (const float*)a->data;
+  size_t rows = a->shape[0];
+
+  for (size_t r = 0; r < rows; r++)
+  {
+    float* c0 = c + (r * n);
+    uint32_t start = index->row_ptr[r];
+    uint32_t end = index->row_ptr[r + 1];
+
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4)
+    {
+      v4f acc = {0, 0, 0, 0};
+
+      for (uint32_t p = start; p < end; p++)
+      {
+        const float* blk = values + (p * 4);
+        const float* b0 = b + (index->col_idx[p] * 4 * n) + j;
+
+        acc += *(const v4f*)b0 * blk[0] + *(const v4f*)(b0 + n) * blk[1] +
+               *(const v4f*)(b0 + (2 * n)) * blk[2] + *(const v4f*)(b0 + (3 * n)) * blk[3];
+      }
+
+      *(v4f*)(c0 + j) = acc;
+    }
+
+    // Remaining columns
+    for (; j < n; j++)
+    {
+      float s = 0;
+
+      for (uint32_t p = start; p < end; p++)
+      {
+        const float* blk = values + (p * 4);
+        const float* b0 = b + (index->col_idx[p] * 4 * n) + j;
+
+        s += blk[0] * b0[0] + blk[1] * b0[n] + blk[2] * b0[2 * n] + blk[3] * b0[3 * n];
+      }
+
+      c0[j] = s;
+    }
+
+    cond_resched();
+  }
+}
+
+/**
+ * @brief FLOAT32 SpMM for CSR and any block size
+ * 
+ * @param a Sparse weights
+ * @param b Dense activations
+ * @param c Dense output
+ * @param n Number of columns of B and C
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void sparse_matmul_f32(tensor_t* a, const float* b, float* c, size_t n)
+{
+  tensor_sparse_t* index = a->sparse;
+  const float* values = (const float*)a->data;
+  size_t block_row_count = a->shape[0] / index->block_rows;
+
+  memset(c, 0, a->shape[0] * n * sizeof(float));
+
+  for (size_t rb = 0; rb < block_row_count; rb++)
+  {
+    for (uint32_t p = index->row_ptr[rb]; p < index->row_ptr[rb + 1]; p++)
+    {
+      const float* blk = values + (p * index->block_rows * index->block_cols);
+
+      for (size_t i = 0; i < index->block_rows; i++)
+      {
+        float* c_row = c + (((rb * index->block_rows) + i) * n);
+
+        for (size_t k = 0; k < index->block_cols; k++)
+        {
+          float w = blk[(i * index->block_cols) + k];
+          if (w == 0)
+          {
+            continue;
+          }
+
+          const float* b_row = b + (((index->col_idx[p] * index->block_cols) + k) * n);
+          for (size_t j = 0; j < n; j++)
+          {
+            c_row[j] += w * b_row[j];
+          }
+        }
+      }
+    }
+
+    cond_resched();
+  }
+}
+
+/**
+ * @brief INT8 SpMM with INT32 accumulation for CSR and any block size
+ * 
+ * @param a Sparse weights
+ * @param b Dense activations
+ * @param c Dense output
+ * @param n Number of columns of B and C
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void sparse_matmul_i8(tensor_t* a, const int8_t* b, int32_t* c, size_t n)
+{
+  tensor_sparse_t* index = a->sparse;
+  const int8_t* values = (const int8_t*)a->data;
+  size_t block_row_count = a->shape[0] / index->block_rows;
+
+  memset(c, 0, a->shape[0] * n * sizeof(int32_t));
+
+  for (size_t rb = 0; rb < block_row_count; rb++)
+  {
+    for (uint32_t p = index->row_ptr[rb]; p < index->row_ptr[rb + 1]; p++)
+    {
+      const int8_t* blk = values + (p * index->block_rows * index->block_cols);
+
+      for (size_t i = 0; i < index->block_rows; i++)
+      {
+        int32_t* c_row = c + (((rb * index->block_rows) + i) * n);
+
+        for (size_t k = 0; k < index->block_cols; k++)
+        {
+          int32_t w = blk[(i * index->block_cols) + k];
+          if (w == 0)
+          {
+            continue;
+          }
+
+          const int8_t* b_row = b + (((index->col_idx[p] * index->block_cols) + k) * n);
+          for (size_t j = 0; j < n; j++)
+          {
+            c_row[j] += w * b_row[j];
+          }
+        }
+      }
+    }
+
+    cond_resched();
+  }
+}
+
+/**
+ * @brief Multiply sparse weights with dense activations, C = A x B
+ * 
+ * A is a sparse M x K tensor, B a dense K x N tensor and C a dense M x N
+ * tensor, all row-major. FLOAT32 x FLOAT32 gives FLOAT32, INT8 x INT8
+ * gives INT32.
+ * 
+ * @param a Sparse weights
+ * @param b Dense activations
+ * @param c Dense output
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_sparse_matmul(tensor_t* a, tensor_t* b, tensor_t* c)
+{
+  if (!a || !a->sparse || !sparse_is_dense_matrix(b) || !sparse_is_dense_matrix(c))
+  {
+    return -EINVARG;
+  }
+
+  size_t m = a->shape[0];
+  size_t k = a->shape[1];
+  size_t n = b->shape[1];
+  if (b->shape[0] != k || c->shape[0] != m || c->shape[1] != n)
+  {
+    return -EINVARG;
+  }
+
+  tensor_sparse_t* index = a->sparse;
+
+  if (a->dtype == TENSOR_TYPE_FLOAT32 && b->dtype == TENSOR_TYPE_FLOAT32 && c->dtype == TENSOR_TYPE_FLOAT32)
+  {
+    if (a->format == TENSOR_FORMAT_BSR && index->block_rows == 4 && index->block_cols == 4)
+    {
+      sparse_matmul_f32_bsr4x4(a, (const float*)b->data, (float*)c->data, n);
+    }
+    else if (a->format == TENSOR_FORMAT_BSR && index->block_rows == 1 && index->block_cols == 4)
+    {
+      sparse_matmul_f32_bsr1x4(a, (const float*)b->data, (float*)c->data, n);
+    }
+    else
+    {
+      sparse_matmul_f32(a, (const float*)b->data, (float*)c->data, n);
+    }
+
+    return EOK;
+  }
+
+  if (a->dtype == TENSOR_TYPE_INT8 && b->dtype == TENSOR_TYPE_INT8 && c->dtype == TENSOR_TYPE_INT32)
+  {
+    sparse_matmul_i8(a, (const int8_t*)b->data, (int32_t*)c->data, n);
+    return EOK;
+  }
+
+  return -EINVARG;
+}
+
+/**
+ * @brief Get the number of stored elements of a sparse tensor, zeros
+ * inside stored blocks included
+ * 
+ * @param sparse Sparse tensor
+ * @return size_t Number of stored elements
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t ai_sparse_get_stored_elements(tensor_t* sparse)
+{
+  if (!sparse || !sparse->sparse)
+  {
+    return 0;
+  }
+
+  return sparse->sparse->nnz * sparse->sparse->block_rows * sparse->sparse->block_cols;
+}
+
+/**
+ * @brief Test sparse tensor conversion and sparse-dense matmul against
+ * a dense reference for every sparse format
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int sparse_test()
+{
+  static const size_t formats[3][3] = {
+    { TENSOR_FORMAT_CSR, 1, 1 },
+    { TENSOR_FORMAT_BSR, 1, 4 },
+    { TENSOR_FORMAT_BSR, 4, 4 }
+  };
+
+  size_t a_shape[2] = { SPARSE_TEST_M, SPARSE_TEST_K };
+  size_t b_shape[2] = { SPARSE_TEST_K, SPARSE_TEST_N };
+  size_t c_shape[2] = { SPARSE_TEST_M, SPARSE_TEST_N };
+  float expected[SPARSE_TEST_M][SPARSE_TEST_N];
+  int res = EOK;
+
+  uart_send_string("\n=== Testing Sparse Tensors ===\n");
+
+  tensor_t* a = ai_tensor_create(a_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ZEROED);
+  tensor_t* b = ai_tensor_create(b_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ZEROED);
+  tensor_t* c = ai_tensor_create(c_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ZEROED);
+  tensor_t* round_trip = ai_tensor_create(a_shape, 2, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ZEROED);
+  if (!a || !b || !c || !round_trip)
+  {
+    uart_send_string("FAIL: Dense tensor creation failed\n");
+    res = -ENOMEM;
+    goto out;
+  }
+
+  // Roughly 80% sparse weights, small integers keep the float sums exact
+  float* a_data = (float*)a->data;
+  float* b_data = (float*)b->data;
+  for (size_t i = 0; i < SPARSE_TEST_M * SPARSE_TEST_K; i++)
+  {
+    a_data[i] = (i % 5 == 0) ? (float)((i % 7) + 1) : 0;
+  }
+
+  for (size_t i = 0; i < SPARSE_TEST_K * SPARSE_TEST_N; i++)
+  {
+    b_data[i] = (float)((int)(i % 9) - 4);
+  }
+
+  for (size_t m = 0; m < SPARSE_TEST_M; m++)
+  {
+    for (size_t n = 0; n < SPARSE_TEST_N; n++)
+    {
+      float sum = 0;
+      for (size_t k = 0; k < SPARSE_TEST_K; k++)
+      {
+        sum += a_data[(m * SPARSE_TEST_K) + k] * b_data[(k * SPARSE_TEST_N) + n];
+      }
+      expected[m][n] = sum;
+    }
+  }
+
+  for (size_t f = 0; f < 3; f++)
+  {
+    tensor_t* sparse = ai_sparse_from_dense(a, (tensor_format_t)formats[f][0], formats[f][1], formats[f][2]);
+    if (!sparse)
+    {
+      uart_send_string("FAIL: Sparse conversion failed\n");
+      res = -ENOMEM;
+      goto out;
+    }
+
+    uart_send_string("Format ");
+    uart_send_string(uint_to_str(formats[f][0]));
+    uart_send_string(" block ");
+    uart_send_string(uint_to_str(formats[f][1]));
+    uart_send_string("x");
+    uart_send_string(uint_to_str(formats[f][2]));
+    uart_send_string(": ");
+    uart_send_string(uint_to_str(ai_sparse_get_stored_elements(sparse)));
+    uart_send_string(" of ");
+    uart_send_string(uint_to_str(SPARSE_TEST_M * SPARSE_TEST_K));
+    uart_send_string(" elements stored\n");
+
+    res = ai_sparse_matmul(sparse, b, c);
+    if (res == EOK)
+    {
+      res = ai_sparse_to_dense(sparse, round_trip);
+    }
+    ai_tensor_destroy(sparse);
+
+    if (res != EOK)
+    {
+      uart_send_string("FAIL: Sparse matmul or expansion failed\n");
+      goto out;
+    }
+
+    float* c_data = (float*)c->data;
+    for (size_t m = 0; m < SPARSE_TEST_M; m++)
+    {
+      for (size_t n = 0; n < SPARSE_TEST_N; n++)
+      {
+        if (c_data[(m * SPARSE_TEST_N) + n] != expected[m][n])
+        {
+          uart_send_string("FAIL: Sparse matmul result mismatch\n");
+          res = -EIO;
+          goto out;
+        }
+      }
+    }
+
+    if (memcmp(round_trip->data, a->data, ai_tensor_get_size(a)) != 0)
+    {
+      uart_send_string("FAIL: Sparse round trip mismatch\n");
+      res = -EIO;
+      goto out;
+    }
+  }
+
+  uart_send_string("Sparse tensor tests PASSED\n");
+
+out:
+  if (a)
+    ai_tensor_destroy(a);
+  if (b)
+    ai_tensor_destroy(b);
+  if (c)
+    ai_tensor_destroy(c);
+  if (round_trip)
+    ai_tensor_destroy(round_trip);
+
+  return res;
+}
@@ -0,0 +1,791 @@
+/*
+ * stream.c - This file implements the streaming weight loader.
+ * Models larger than the AI pool keep their weights on block storage
+ * or in a model image, layer N + 1 is fetched into a ring of weight
+ * buffers while layer N computes.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "stream.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/virtio/virtio_blk.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// Benchmark configuration
+#define AI_STREAM_BENCH_LAYERS 8
+#define AI_STREAM_BENCH_LAYER_SIZE (256 * 1024)
+#define AI_STREAM_BENCH_PASSES 4 // Compute passes over each layer's weights
+
+// Weight stream test configuration (layers streamed through a ring of 2)
+#define STREAM_TEST_LAYERS 5
+#define STREAM_TEST_SLOTS 2
+#define STREAM_TEST_PASSES 2
+
+/**
+ * @brief Record the completion time of a block read
+ * 
+ * @param req Completed request, private_data is the slot
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void ai_stream_read_done(virtio_blk_request_t* req)
+{
+  ai_stream_slot_t* slot = (ai_stream_slot_t*)req->private_data;
+  slot->io_end = timer_read_counter();
+}
+
+/**
+ * @brief Find the buffer holding a layer
+ * 
+ * @param stream Stream
+ * @param layer Layer index
+ * @return ai_stream_slot_t* Buffer, or NULL if the layer is not resident
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static ai_stream_slot_t* ai_stream_find(ai_weight_stream_t* stream, size_t layer)
+{
+  for (size_t i = 0; i < stream->slot_count; i++)
+  {
+    if (stream->slots[i].state != AI_STREAM_SLOT_FREE && stream->slots[i].layer == layer)
+    {
+      return &stream->slots[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Find a free buffer
+ * 
+ * @param stream Stream
+ * @return ai_stream_slot_t* Buffer, or NULL if none is free
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static ai_stream_slot_t* ai_stream_find_free(ai_weight_stream_t* stream)
+{
+  for (size_t i = 0; i < stream->slot_count; i++)
+  {
+    if (stream->slots[i].state == AI_STREAM_SLOT_FREE)
+    {
+      return &stream->slots[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Free every buffer that is not acquired, waiting for the reads
+ * in flight
+ * 
+ * @param stream Stream
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void ai_stream_drop(ai_weight_stream_t* stream)
+{
+  for (size_t i = 0; i < stream->slot_count; i++)
+  {
+    ai_stream_slot_t* slot = &stream->slots[i];
+    if (slot->state == AI_STREAM_SLOT_LOADING)
+    {
+      virtio_blk_wait(&slot->req);
+      stream->stats.io_ticks += slot->io_end - slot->io_start;
+    }
+
+    if (slot->state != AI_STREAM_SLOT_IN_USE)
+    {
+      slot->state = AI_STREAM_SLOT_FREE;
+    }
+  }
+}
+
+/**
+ * @brief Start loading a layer into a free buffer
+ * 
+ * Block reads are only queued, the caller kicks the device once for the
+ * whole batch. A memory image has no engine to copy in the background,
+ * so the copy is done here and counted as a stall.
+ * 
+ * @param stream Stream
+ * @param slot Free buffer
+ * @param layer Layer index
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int ai_stream_load(ai_weight_stream_t* stream, ai_stream_slot_t* slot, size_t layer)
+{
+  ai_stream_layer_t* info = &stream->layers[layer];
+
+  slot->layer = layer;
+  slot->io_start = timer_read_counter();
+  slot->io_end = 0;
+
+  if (stream->source.type == AI_STREAM_SOURCE_MEMORY)
+  {
+    memcpy(slot->buffer->data, (void*)(stream->source.image + info->offset), info->size);
+
+    uint64_t ticks = timer_read_counter() - slot->io_start;
+    stream->stats.io_ticks += ticks;
+    stream->stats.stall_ticks += ticks;
+    slot->state = AI_STREAM_SLOT_READY;
+  }
+  else
+  {
+    // Whole sectors straight into the weight buffer
+    size_t bytes = (info->size + VIRTIO_BLK_SECTOR_SIZE - 1) & ~((size_t)VIRTIO_BLK_SECTOR_SIZE - 1);
+    uint64_t sector = stream->source.base_sector + (info->offset / VIRTIO_BLK_SECTOR_SIZE);
+
+    int res = virtio_blk_request_init(&slot->req, VIRTIO_BLK_OP_READ, sector, slot->buffer->data, bytes);
+    if (res < 0)
+    {
+      return res;
+    }
+
+    slot->req.callback = ai_stream_read_done;
+    slot->req.private_data = slot;
+
+    res = virtio_blk_submit(&slot->req);
+    if (res < 0)
+    {
+      return res;
+    }
+
+    slot->state = AI_STREAM_SLOT_LOADING;
+  }
+
+  stream->stats.loads++;
+  stream->stats.bytes += info->size;
+
+  return EOK;
+}
+
+/**
+ * @brief Fill the free buffers with the next layers that are not resident
+ * 
+ * @param stream Stream
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int ai_stream_prefetch(ai_weight_stream_t* stream)
+{
+  int res = EOK;
+
+  // At most one pass ahead, resident layers are skipped
+  for (size_t i = 0; i < stream->layer_count; i++)
+  {
+    ai_stream_slot_t* slot = ai_stream_find_free(stream);
+    if (!slot)
+    {
+      break;
+    }
+
+    size_t layer = stream->next_fetch;
+    if (ai_stream_find(stream, layer))
+    {
+      stream->next_fetch = (layer + 1) % stream->layer_count;
+      continue;
+    }
+
+    res = ai_stream_load(stream, slot, layer);
+    if (res < 0)
+    {
+      break;
+    }
+
+    stream->next_fetch = (layer + 1) % stream->layer_count;
+  }
+
+  if (stream->source.type == AI_STREAM_SOURCE_BLOCK)
+  {
+    virtio_blk_kick();
+  }
+
+  return res;
+}
+
+/**
+ * @brief Create a weight stream
+ * 
+ * @param source Where the weights live
+ * @param layers Layer table, copied
+ * @param layer_count Number of layers
+ * @param slot_count Weight buffers in the ring (1 to AI_STREAM_MAX_SLOTS)
+ * @param out_stream Output for the stream
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_stream_create(ai_stream_source_t* source, ai_stream_layer_t* layers, size_t layer_count,
+                     size_t slot_count, ai_weight_stream_t** out_stream)
+{
+  if (!source || !layers || layer_count == 0 || slot_count == 0 || slot_count > AI_STREAM_MAX_SLOTS || !out_stream)
+  {
+    return -EINVARG;
+  }
+
+  if (source->type == AI_STREAM_SOURCE_MEMORY && !source->image)
+  {
+    return -EINVARG;
+  }
+
+  if (source->type == AI_STREAM_SOURCE_BLOCK && !virtio_blk_present())
+  {
+    return -ENOTREADY;
+  }
+
+  // Buffers are sized for the largest layer, rounded to whole sectors
+  size_t slot_size = 0;
+  for (size_t i = 0; i < layer_count; i++)
+  {
+    if (layers[i].size == 0 ||
+        (source->type == AI_STREAM_SOURCE_BLOCK && layers[i].offset % VIRTIO_BLK_SECTOR_SIZE != 0))
+    {
+      return -EINVARG;
+    }
+
+    slot_size = layers[i].size > slot_size ? layers[i].size : slot_size;
+  }
+  slot_size = (slot_size + VIRTIO_BLK_SECTOR_SIZE - 1) & ~((size_t)VIRTIO_BLK_SECTOR_SIZE - 1);
+
+  ai_weight_stream_t* stream = (ai_weight_stream_t*)kzalloc(sizeof(ai_weight_stream_t));
+  if (!stream)
+  {
+    return -ENOMEM;
+  }
+
+  stream->layers = (ai_stream_layer_t*)kmalloc(layer_count * sizeof(ai_stream_layer_t));
+  if (!stream->layers)
+  {
+    kfree(stream);
+    return -ENOMEM;
+  }
+
+  memcpy(stream->layers, layers, layer_count * sizeof(ai_stream_layer_t));
+  stream->source = *source;
+  stream->layer_count = layer_count;
+  stream->slot_size = slot_size;
+
+  size_t shape[1] = { slot_size };
+  for (size_t i = 0; i < slot_count; i++)
+  {
+    stream->slots[i].buffer = ai_tensor_create(shape, 1, TENSOR_TYPE_INT8, TENSOR_LAYOUT_ROW_MAJOR,
+                                               TENSOR_MEM_ALIGNED | TENSOR_MEM_DMA);
+    if (!stream->slots[i].buffer)
+    {
+      ai_stream_destroy(stream);
+      return -ENOMEM;
+    }
+
+    stream->slots[i].state = AI_STREAM_SLOT_FREE;
+    stream->slot_count++;
+  }
+
+  *out_stream = stream;
+  return EOK;
+}
+
+/**
+ * @brief Destroy a weight stream, waiting for reads in flight
+ * 
+ * @param stream Stream
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void ai_stream_destroy(ai_weight_stream_t* stream)
+{
+  if (!stream)
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < stream->slot_count; i++)
+  {
+    // The device must be done with the buffer before it goes back to the pool
+    if (stream->slots[i].state == AI_STREAM_SLOT_LOADING)
+    {
+      virtio_blk_wait(&stream->slots[i].req);
+    }
+
+    if (stream->slots[i].buffer)
+    {
+      ai_tensor_destroy(stream->slots[i].buffer);
+    }
+  }
+
+  if (stream->layers)
+  {
+    kfree(stream->layers);
+  }
+  kfree(stream);
+}
+
+/**
+ * @brief Get the weights of a layer, waiting for them if needed, and
+ * start fetching the following layers into the free buffers
+ * 
+ * @param stream Stream
+ * @param layer Layer index
+ * @param weights Output for the weights
+ * @param size Output for the size of the weights, may be NULL
+ * @return int EOK on success, -EINUSE if every buffer is acquired,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_stream_acquire(ai_weight_stream_t* stream, size_t layer, void** weights, size_t* size)
+{
+  if (!stream || layer >= stream->layer_count || !weights)
+  {
+    return -EINVARG;
+  }
+
+  int res = EOK;
+  ai_stream_slot_t* slot = ai_stream_find(stream, layer);
+  if (!slot)
+  {
+    // Out of order access, drop the prefetched layers and restart from this one
+    ai_stream_drop(stream);
+    slot = ai_stream_find_free(stream);
+    if (!slot)
+    {
+      return -EINUSE;
+    }
+
+    stream->next_fetch = layer;
+    res = ai_stream_prefetch(stream);
+    if (res < 0)
+    {
+      return res;
+    }
+    slot = ai_stream_find(stream, layer);
+  }
+
+  if (!slot || slot->state == AI_STREAM_SLOT_IN_USE)
+  {
+    return -EINUSE;
+  }
+
+  if (slot->state == AI_STREAM_SLOT_LOADING)
+  {
+    uint64_t start = timer_read_counter();
+    res = virtio_blk_wait(&slot->req);
+    stream->stats.stall_ticks += timer_read_counter() - start;
+    stream->stats.io_ticks += slot->io_end - slot->io_start;
+
+    if (res < 0)
+    {
+      slot->state = AI_STREAM_SLOT_FREE;
+      return res;
+    }
+  }
+
+  slot->state = AI_STREAM_SLOT_IN_USE;
+  slot->compute_start = timer_read_counter();
+  stream->stats.layers++;
+
+  *weights = slot->buffer->data;
+  if (size)
+  {
+    *size = stream->layers[layer].size;
+  }
+
+  // Keep the other buffers busy while this layer computes
+  res = ai_stream_prefetch(stream);
+
+  return res;
+}
+
+/**
+ * @brief Give back the buffer of a layer once its compute is done
+ * 
+ * @param stream Stream
+ * @param layer Layer index
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_stream_release(ai_weight_stream_t* stream, size_t layer)
+{
+  if (!stream || layer >= stream->layer_count)
+  {
+    return -EINVARG;
+  }
+
+  ai_stream_slot_t* slot = ai_stream_find(stream, layer);
+  if (!slot || slot->state != AI_STREAM_SLOT_IN_USE)
+  {
+    return -EINVARG;
+  }
+
+  stream->stats.compute_ticks += timer_read_counter() - slot->compute_start;
+
+  // A ring as large as the model keeps every layer resident
+  if (stream->slot_count >= stream->layer_count)
+  {
+    slot->state = AI_STREAM_SLOT_READY;
+    return EOK;
+  }
+
+  slot->state = AI_STREAM_SLOT_FREE;
+  return ai_stream_prefetch(stream);
+}
+
+/**
+ * @brief Run every layer in order, one acquire / compute / release each
+ * 
+ * @param stream Stream
+ * @param fn Compute callback
+ * @param private_data Data passed to the callback
+ * @return int EOK on success, first error otherwise
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_stream_run(ai_weight_stream_t* stream, AI_STREAM_LAYER_FN fn, void* private_data)
+{
+  if (!stream || !fn)
+  {
+    return -EINVARG;
+  }
+
+  for (size_t layer = 0; layer < stream->layer_count; layer++)
+  {
+    void* weights = NULL;
+    size_t size = 0;
+
+    int res = ai_stream_acquire(stream, layer, &weights, &size);
+    if (res < 0)
+    {
+      return res;
+    }
+
+    res = fn(layer, weights, size, private_data);
+    int release_res = ai_stream_release(stream, layer);
+    if (res < 0)
+    {
+      return res;
+    }
+    if (release_res < 0)
+    {
+      return release_res;
+    }
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Get the statistics of a stream
+ * 
+ * @param stream Stream
+ * @param stats Output for the statistics
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void ai_stream_get_stats(ai_weight_stream_t* stream, ai_stream_stats_t* stats)
+{
+  if (!stream || !stats)
+  {
+    return;
+  }
+
+  *stats = stream->stats;
+}
+
+/**
+ * @brief Get the share of read time hidden behind compute
+ * 
+ * @param stream Stream
+ * @return uint32_t Overlap efficiency in percent
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t ai_stream_get_overlap(ai_weight_stream_t* stream)
+{
+  if (!stream || stream->stats.io_ticks == 0 || stream->stats.stall_ticks >= stream->stats.io_ticks)
+  {
+    return 0;
+  }
+
+  return (uint32_t)(((stream->stats.io_ticks - stream->stats.stall_ticks) * 100) / stream->stats.io_ticks);
+}
+
+/**
+ * @brief Synthetic layer compute for the benchmark, a few passes over
+ * the weights
+ * 
+ * @param layer Layer index
+ * @param weights Layer weights
+ * @param size Size of the weights
+ * @param private_data Checksum accumulator
+ * @return int EOK
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int ai_stream_bench_layer(size_t layer, void* weights, size_t size, void* private_data)
+{
+  const uint64_t* words = (const uint64_t*)weights;
+  uint64_t sum = *(uint64_t*)private_data + layer;
+
+  for (size_t pass = 0; pass < AI_STREAM_BENCH_PASSES; pass++)
+  {
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++)
+    {
+      sum = (sum * 31) + words[i];
+    }
+  }
+
+  *(uint64_t*)private_data = sum;
+  return EOK;
+}
+
+/**
+ * @brief Stream layers from the block device with rings of 1 to 3
+ * buffers and report the compute / IO overlap
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_stream_benchmark()
+{
+  ai_stream_layer_t layers[AI_STREAM_BENCH_LAYERS];
+  ai_stream_source_t source = { .type = AI_STREAM_SOURCE_BLOCK, .image = NULL, .base_sector = 0 };
+
+  if (!virtio_blk_present())
+  {
+    return -ENOTREADY;
+  }
+
+  if (virtio_blk_get_capacity() * VIRTIO_BLK_SECTOR_SIZE < AI_STREAM_BENCH_LAYERS * AI_STREAM_BENCH_LAYER_SIZE)
+  {
+    uart_send_string("ai_stream: device too small for the benchmark\n");
+    return -EINVARG;
+  }
+
+  for (size_t i = 0; i < AI_STREAM_BENCH_LAYERS; i++)
+  {
+    layers[i].offset = i * AI_STREAM_BENCH_LAYER_SIZE;
+    layers[i].size = AI_STREAM_BENCH_LAYER_SIZE;
+  }
+
+  uart_send_string("\n=== Streaming Weight Loader Benchmark ===\n");
+
+  for (size_t slots = 1; slots <= 3; slots++)
+  {
+    ai_weight_stream_t* stream = NULL;
+    uint64_t checksum = 0;
+
+    int res = ai_stream_create(&source, layers, AI_STREAM_BENCH_LAYERS, slots, &stream);
+    if (res < 0)
+    {
+      uart_send_string("ai_stream: stream creation failed\n");
+      return res;
+    }
+
+    res = ai_stream_run(stream, ai_stream_bench_layer, &checksum);
+    if (res < 0)
+    {
+      uart_send_string("ai_stream: streaming failed\n");
+      ai_stream_destroy(stream);
+      return res;
+    }
+
+    uart_send_string(uint_to_str(slots));
+    uart_send_string(" buffer(s), ");
+    uart_send_string(uint_to_str((slots * stream->slot_size) / 1024));
+    uart_send_string(" KB: io ");
+    uart_send_string(uint_to_str(stream->stats.io_ticks));
+    uart_send_string(" ticks, compute ");
+    uart_send_string(uint_to_str(stream->stats.compute_ticks));
+    uart_send_string(" ticks, stalled ");
+    uart_send_string(uint_to_str(stream->stats.stall_ticks));
+    uart_send_string(" ticks, overlap ");
+    uart_send_string(uint_to_str(ai_stream_get_overlap(stream)));
+    uart_send_string("%\n");
+
+    ai_stream_destroy(stream);
+  }
+
+  return EOK;
+}
+
+// Layers seen by the weight stream test callback
+static size_t stream_test_expected_layer = 0;
+
+static uint8_t stream_test_byte(ai_stream_layer_t* layer, size_t i)
+{
+  return (uint8_t)((layer->offset + i) * 7);
+}
+
+static int stream_test_layer(size_t layer, void* weights, size_t size, void* private_data)
+{
+  ai_stream_layer_t* layers = (ai_stream_layer_t*)private_data;
+  uint8_t* bytes = (uint8_t*)weights;
+
+  if (layer != stream_test_expected_layer || size != layers[layer].size)
+  {
+    return -EIO;
+  }
+
+  for (size_t i = 0; i < size; i++)
+  {
+    if (bytes[i] != stream_test_byte(&layers[layer], i))
+    {
+      return -EIO;
+    }
+  }
+
+  stream_test_expected_layer++;
+  return EOK;
+}
+
+/**
+ * @brief Test the streaming weight loader: layers larger than the ring
+ * stream in order, out of order acquires and buffer exhaustion
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int stream_test()
+{
+  ai_stream_layer_t layers[STREAM_TEST_LAYERS];
+  ai_weight_stream_t* stream = NULL;
+  uint8_t* image = NULL;
+  size_t image_size = 0;
+  int res = EOK;
+
+  uart_send_string("\n=== Testing Weight Streaming ===\n");
+
+  // Layers of different sizes packed back to back
+  for (size_t i = 0; i < STREAM_TEST_LAYERS; i++)
+  {
+    layers[i].offset = image_size;
+    layers[i].size = 1000 + (i * 1500);
+    image_size += layers[i].size;
+  }
+
+  image = (uint8_t*)kmalloc(image_size);
+  if (!image)
+  {
+    uart_send_string("FAIL: Model image allocation failed\n");
+    return -ENOMEM;
+  }
+
+  for (size_t i = 0; i < STREAM_TEST_LAYERS; i++)
+  {
+    for (size_t j = 0; j < layers[i].size; j++)
+    {
+      image[layers[i].offset + j] = stream_test_byte(&layers[i], j);
+    }
+  }
+
+  ai_stream_source_t source = { .type = AI_STREAM_SOURCE_MEMORY, .image = image, .base_sector = 0 };
+  res = ai_stream_create(&source, layers, STREAM_TEST_LAYERS, STREAM_TEST_SLOTS, &stream);
+  if (res != EOK)
+  {
+    uart_send_string("FAIL: Stream creation failed\n");
+    goto out;
+  }
+
+  for (size_t pass = 0; pass < STREAM_TEST_PASSES; pass++)
+  {
+    stream_test_expected_layer = 0;
+    res = ai_stream_run(stream, stream_test_layer, layers);
+    if (res != EOK || stream_test_expected_layer != STREAM_TEST_LAYERS)
+    {
+      uart_send_string("FAIL: Streamed weights mismatch\n");
+      res = -EIO;
+      goto out;
+    }
+  }
+
+  // Every layer is fetched once per pass, the ring never holds them all
+  ai_stream_stats_t stats;
+  ai_stream_get_stats(stream, &stats);
+  if (stats.layers != STREAM_TEST_LAYERS * STREAM_TEST_PASSES || stats.bytes < image_size * STREAM_TEST_PASSES)
+  {
+    uart_send_string("FAIL: Stream statistics mismatch\n");
+    res = -EIO;
+    goto out;
+  }
+
+  // Out of order acquire, then every buffer held
+  void* first = NULL;
+  void* second = NULL;
+  void* third = NULL;
+  res = ai_stream_acquire(stream, 3, &first, NULL);
+  if (res == EOK)
+  {
+    res = ai_stream_acquire(stream, 1, &second, NULL);
+  }
+  if (res != EOK || ((uint8_t*)first)[10] != stream_test_byte(&layers[3], 10) ||
+      ((uint8_t*)second)[10] != stream_test_byte(&layers[1], 10))
+  {
+    uart_send_string("FAIL: Out of order acquire\n");
+    res = -EIO;
+    goto out;
+  }
+
+  if (ai_stream_acquire(stream, 0, &third, NULL) != -EINUSE)
+  {
+    uart_send_string("FAIL: Acquire with every buffer held\n");
+    res = -EIO;
+    goto out;
+  }
+
+  res = ai_stream_release(stream, 3);
+  if (res == EOK)
+  {
+    res = ai_stream_release(stream, 1);
+  }
+  if (res != EOK)
+  {
+    uart_send_string("FAIL: Stream release failed\n");
+    goto out;
+  }
+
+  uart_send_string("Weight streaming tests PASSED\n");
+
+out:
+  if (stream)
+    ai_stream_destroy(stream);
+  kfree(image);
+
+  return res;
+}
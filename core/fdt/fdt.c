@@ -0,0 +1,1083 @@
+/*
+ * fdt.c - This file implements the flattened device tree parser.
+ * The blob is read in place and parsed once into the platform
+ * description, nothing is allocated so it can run before the memory
+ * system.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "fdt.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <kernel/config.h>
+
+#include <synapse/string/string.h>
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+
+// Device tree state
+typedef struct
+{
+  const uint8_t* blob; // Blob handed over by the loader
+  size_t size; // Total size of the blob
+  const uint8_t* structs; // Structure block
+  uint32_t struct_size; // Size of the structure block
+  const char* strings; // Strings block
+  uint32_t strings_size; // Size of the strings block
+} fdt_t;
+
+static fdt_t fdt;
+
+// Platform description, filled by fdt_init() or with the defaults
+static fdt_platform_t platform;
+static bool platform_ready = false;
+static bool uart_found = false;
+
+// Kernel start symbol from the linker
+extern char _start[];
+
+// Device tree test configuration (heap blocks checked against reserved ranges)
+#define DT_TEST_ALLOCATIONS 16
+
+/**
+ * @brief Get the token at an offset of the structure block
+ * 
+ * @param offset Offset, 4-byte aligned
+ * @return uint32_t Token, FDT_END past the end of the block
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t fdt_token(uint32_t offset)
+{
+  if (offset + 4 > fdt.struct_size)
+  {
+    return FDT_END;
+  }
+
+  return fdt_read_u32(fdt.structs + offset);
+}
+
+/**
+ * @brief Check that a property fits in the structure block and that its
+ * name is inside the strings block
+ * 
+ * @param offset Offset of an FDT_PROP token
+ * @return true If the property can be read
+ * @return false If its header, value or name offset is out of bounds
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool fdt_prop_valid(uint32_t offset)
+{
+  if (offset > fdt.struct_size || fdt.struct_size - offset < 12)
+  {
+    return false;
+  }
+
+  uint32_t len = fdt_read_u32(fdt.structs + offset + 4);
+  uint32_t name_offset = fdt_read_u32(fdt.structs + offset + 8);
+
+  return len <= fdt.struct_size - offset - 12 && name_offset < fdt.strings_size;
+}
+
+/**
+ * @brief Get the offset following a token and its payload
+ * 
+ * @param offset Token offset
+ * @return uint32_t Offset of the next token
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t fdt_next_token(uint32_t offset)
+{
+  switch (fdt_token(offset))
+  {
+    case FDT_BEGIN_NODE:
+    {
+      // Node name, NUL terminated and padded
+      const char* name = (const char*)(fdt.structs + offset + 4);
+      size_t len = strnlen(name, fdt.struct_size - offset - 4) + 1;
+      return offset + 4 + ((len + 3) & ~3);
+    }
+
+    case FDT_PROP:
+    {
+      // A truncated property ends the walk
+      if (!fdt_prop_valid(offset))
+      {
+        return fdt.struct_size;
+      }
+
+      uint32_t len = fdt_read_u32(fdt.structs + offset + 4);
+      uint32_t next = offset + 12 + ((len + 3) & ~3);
+      return next < fdt.struct_size ? next : fdt.struct_size;
+    }
+
+    case FDT_END:
+      return fdt.struct_size;
+
+    default:
+      return offset + 4;
+  }
+}
+
+/**
+ * @brief Compare a node name with one component of a path
+ * 
+ * @param name Node name, with its unit address if any
+ * @param component Path component
+ * @param len Length of the component
+ * @return bool true if they match
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool fdt_name_matches(const char* name, const char* component, size_t len)
+{
+  if (strncmp(name, component, len) != 0)
+  {
+    return false;
+  }
+
+  // "memory" matches "memory@40000000"
+  return name[len] == '\0' || (name[len] == '@' && strnlen_terminator(component, len, '@') == len);
+}
+
+/**
+ * @brief Skip the NOP tokens following an offset
+ * 
+ * @param offset Offset
+ * @return uint32_t Offset of the first token that is not a NOP
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t fdt_skip_nops(uint32_t offset)
+{
+  while (fdt_token(offset) == FDT_NOP)
+  {
+    offset = fdt_next_token(offset);
+  }
+
+  return offset;
+}
+
+/**
+ * @brief Fill the platform description with the QEMU virt layout
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void fdt_platform_defaults()
+{
+  memset(&platform, 0, sizeof(platform));
+
+  platform.memory[0].base = FDT_DEFAULT_RAM_BASE;
+  platform.memory[0].size = FDT_DEFAULT_RAM_SIZE;
+  platform.memory_count = 1;
+
+  platform.gicd_base = FDT_DEFAULT_GICD_BASE;
+  platform.gicc_base = FDT_DEFAULT_GICC_BASE;
+  platform.uart_base = FDT_DEFAULT_UART_BASE;
+  platform.uart_irq = FDT_DEFAULT_UART_IRQ;
+
+  // PPIs 13, 14, 11 and 10
+  platform.timer_irqs[FDT_TIMER_SECURE_PHYS] = 29;
+  platform.timer_irqs[FDT_TIMER_PHYS] = 30;
+  platform.timer_irqs[FDT_TIMER_VIRT] = 27;
+  platform.timer_irqs[FDT_TIMER_HYP] = 26;
+
+  for (uint32_t i = 0; i < FDT_MAX_VIRTIO_SLOTS; i++)
+  {
+    platform.virtio[i].base = FDT_DEFAULT_VIRTIO_BASE + i * FDT_DEFAULT_VIRTIO_STRIDE;
+    platform.virtio[i].irq = FDT_DEFAULT_VIRTIO_IRQ + i;
+  }
+  platform.virtio_count = FDT_MAX_VIRTIO_SLOTS;
+
+  platform.cpu_count = 1;
+}
+
+/**
+ * @brief Read a 32-bit cell property
+ * 
+ * @param node Node offset
+ * @param name Property name
+ * @param fallback Value if the node has no such property
+ * @return uint32_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t fdt_get_u32(int node, const char* name, uint32_t fallback)
+{
+  uint32_t len;
+  const void* prop = fdt_get_property(node, name, &len);
+
+  return prop && len >= 4 ? fdt_read_u32(prop) : fallback;
+}
+
+/**
+ * @brief Read one entry of the reg property of a node
+ * 
+ * @param node Node offset
+ * @param address_cells #address-cells of the parent
+ * @param size_cells #size-cells of the parent
+ * @param index Entry
+ * @param range Output for the entry
+ * @return bool true if the entry exists
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool fdt_get_reg(int node, uint32_t address_cells, uint32_t size_cells, uint32_t index, fdt_range_t* range)
+{
+  uint32_t len;
+  const uint32_t* reg = (const uint32_t*)fdt_get_property(node, "reg", &len);
+  uint32_t entry_cells = address_cells + size_cells;
+  if (!reg || address_cells == 0 || address_cells > 2 || size_cells > 2 || (index + 1) * entry_cells * 4 > len)
+  {
+    return false;
+  }
+
+  reg += index * entry_cells;
+  range->base = fdt_read_cells(reg, address_cells);
+  range->size = size_cells ? fdt_read_cells(reg + address_cells, size_cells) : 0;
+  return true;
+}
+
+/**
+ * @brief Convert one GIC interrupt specifier of a node to an interrupt ID
+ * 
+ * @param node Node offset
+ * @param index Specifier, 3 cells each (type, number, flags)
+ * @param irq Output for the interrupt ID
+ * @return bool true if the specifier exists
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool fdt_get_irq(int node, uint32_t index, uint32_t* irq)
+{
+  uint32_t len;
+  const uint32_t* spec = (const uint32_t*)fdt_get_property(node, "interrupts", &len);
+  if (!spec || (index + 1) * 12 > len)
+  {
+    return false;
+  }
+
+  spec += index * 3;
+
+  // SPIs start at 32, PPIs at 16
+  *irq = fdt_read_u32(spec + 1) + (fdt_read_u32(spec) == 0 ? 32 : 16);
+  return true;
+}
+
+/**
+ * @brief Check if a node has a device_type property
+ * 
+ * @param node Node offset
+ * @param type Device type
+ * @return bool true if the device type matches
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool fdt_node_is_type(int node, const char* type)
+{
+  uint32_t len;
+  const char* prop = (const char*)fdt_get_property(node, "device_type", &len);
+
+  return prop && len == strlen(type) + 1 && strncmp(prop, type, len) == 0;
+}
+
+/**
+ * @brief Add a range to a list of the platform description
+ * 
+ * @param list List
+ * @param count Number of entries in the list
+ * @param max Capacity of the list
+ * @param range Range, ignored if empty
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void fdt_add_range(fdt_range_t* list, uint32_t* count, uint32_t max, const fdt_range_t* range)
+{
+  if (range->size == 0 || *count >= max)
+  {
+    return;
+  }
+
+  list[(*count)++] = *range;
+}
+
+/**
+ * @brief Add a virtio-mmio slot, keeping the list sorted by address
+ * 
+ * The virt board assigns the command line devices from the highest slot
+ * down, sorting keeps the slot numbers of the fixed layout.
+ * 
+ * @param base Slot address
+ * @param irq Slot interrupt ID
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void fdt_add_virtio(uint64_t base, uint32_t irq)
+{
+  if (platform.virtio_count >= FDT_MAX_VIRTIO_SLOTS)
+  {
+    return;
+  }
+
+  uint32_t i = platform.virtio_count++;
+  while (i > 0 && platform.virtio[i - 1].base > base)
+  {
+    platform.virtio[i] = platform.virtio[i - 1];
+    i--;
+  }
+
+  platform.virtio[i].base = base;
+  platform.virtio[i].irq = irq;
+}
+
+/**
+ * @brief Fill the platform description from one node
+ * 
+ * @param node Node offset
+ * @param parent Parent offset
+ * @param address_cells #address-cells of the parent
+ * @param size_cells #size-cells of the parent
+ * @param memory_found Set once the first memory node replaces the default bank
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void fdt_parse_node(int node, int parent, uint32_t address_cells, uint32_t size_cells, bool* memory_found)
+{
+  fdt_range_t range;
+  const char* name = fdt_node_name(node);
+
+  if (fdt_node_is_type(node, "memory"))
+  {
+    if (!*memory_found)
+    {
+      platform.memory_count = 0;
+      *memory_found = true;
+    }
+
+    for (uint32_t i = 0; fdt_get_reg(node, address_cells, size_cells, i, &range); i++)
+    {
+      fdt_add_range(platform.memory, &platform.memory_count, FDT_MAX_MEMORY_BANKS, &range);
+    }
+  }
+  else if (fdt_node_is_type(node, "cpu"))
+  {
+    // The reg of a CPU node is its MPIDR affinity, the target of PSCI CPU_ON
+    if (platform.cpu_count < FDT_MAX_CPUS && fdt_get_reg(node, address_cells, size_cells, 0, &range))
+    {
+      platform.cpu_mpidr[platform.cpu_count] = range.base;
+    }
+    platform.cpu_count++;
+  }
+  else if (parent >= 0 && fdt_name_matches(fdt_node_name(parent), "reserved-memory", 15))
+  {
+    // Dynamic reservations without a reg are placed by the OS, none are used
+    for (uint32_t i = 0; fdt_get_reg(node, address_cells, size_cells, i, &range); i++)
+    {
+      fdt_add_range(platform.reserved, &platform.reserved_count, FDT_MAX_RESERVED, &range);
+    }
+  }
+  else if (parent >= 0 && fdt_node_name(parent)[0] == '\0' && fdt_name_matches(name, "chosen", 6))
+  {
+    uint32_t start_len, end_len;
+    const void* start = fdt_get_property(node, "linux,initrd-start", &start_len);
+    const void* end = fdt_get_property(node, "linux,initrd-end", &end_len);
+    if (start && end && (start_len == 4 || start_len == 8) && (end_len == 4 || end_len == 8))
+    {
+      platform.initrd_start = fdt_read_cells(start, start_len / 4);
+      platform.initrd_end = fdt_read_cells(end, end_len / 4);
+    }
+  }
+  else if (fdt_node_is_compatible(node, "arm,cortex-a15-gic") ||
+           fdt_node_is_compatible(node, "arm,gic-400") ||
+           fdt_node_is_compatible(node, "arm,cortex-a7-gic") ||
+           fdt_node_is_compatible(node, "arm,cortex-a9-gic"))
+  {
+    fdt_range_t gicc;
+    if (fdt_get_reg(node, address_cells, size_cells, 0, &range) &&
+        fdt_get_reg(node, address_cells, size_cells, 1, &gicc))
+    {
+      platform.gicd_base = range.base;
+      platform.gicc_base = gicc.base;
+    }
+  }
+  else if (fdt_node_is_compatible(node, "arm,pl011"))
+  {
+    // The first UART is the console, like the stdout-path of the virt board
+    if (!uart_found && fdt_get_reg(node, address_cells, size_cells, 0, &range))
+    {
+      uart_found = true;
+      platform.uart_base = range.base;
+      fdt_get_irq(node, 0, &platform.uart_irq);
+    }
+  }
+  else if (fdt_node_is_compatible(node, "arm,armv8-timer") || fdt_node_is_compatible(node, "arm,armv7-timer"))
+  {
+    for (uint32_t i = 0; i < FDT_TIMER_IRQ_COUNT; i++)
+    {
+      fdt_get_irq(node, i, &platform.timer_irqs[i]);
+    }
+  }
+  else if (fdt_node_is_compatible(node, "arm,psci") ||
+           fdt_node_is_compatible(node, "arm,psci-0.2") ||
+           fdt_node_is_compatible(node, "arm,psci-1.0"))
+  {
+    uint32_t len;
+    const char* method = (const char*)fdt_get_property(node, "method", &len);
+    if (method && strncmp(method, "hvc", 4) == 0)
+    {
+      platform.psci_method = FDT_PSCI_HVC;
+    }
+    else if (method && strncmp(method, "smc", 4) == 0)
+    {
+      platform.psci_method = FDT_PSCI_SMC;
+    }
+  }
+  else if (fdt_node_is_compatible(node, "virtio,mmio"))
+  {
+    uint32_t irq;
+    if (fdt_get_reg(node, address_cells, size_cells, 0, &range) && fdt_get_irq(node, 0, &irq))
+    {
+      fdt_add_virtio(range.base, irq);
+    }
+  }
+}
+
+/**
+ * @brief Walk a subtree and fill the platform description
+ * 
+ * Bus ranges are assumed to be identity, as on the virt board.
+ * 
+ * @param node Node offset
+ * @param depth Depth of the node, the walk stops at FDT_MAX_DEPTH
+ * @param memory_found Set once the first memory node replaces the default bank
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void fdt_parse_subtree(int node, int depth, bool* memory_found)
+{
+  // Cells of the children reg properties
+  uint32_t address_cells = fdt_get_u32(node, "#address-cells", 2);
+  uint32_t size_cells = fdt_get_u32(node, "#size-cells", 1);
+
+  for (int child = fdt_first_subnode(node); child >= 0; child = fdt_next_subnode(child))
+  {
+    fdt_parse_node(child, node, address_cells, size_cells, memory_found);
+
+    if (depth + 1 < FDT_MAX_DEPTH)
+    {
+      fdt_parse_subtree(child, depth + 1, memory_found);
+    }
+  }
+}
+
+/**
+ * @brief Fill the platform description from the blob
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void fdt_parse_platform()
+{
+  fdt_platform_defaults();
+
+  // Only nodes found in the tree count, missing ones keep the defaults
+  platform.cpu_count = 0;
+  platform.virtio_count = 0;
+  platform.from_device_tree = true;
+  uart_found = false;
+
+  // Memory reservation block, (address, size) pairs ending with an empty one
+  const struct fdt_header* header = (const struct fdt_header*)fdt.blob;
+  uint32_t rsv_offset = fdt_read_u32(&header->off_mem_rsvmap);
+  fdt_range_t range;
+  for (; rsv_offset + 16 <= fdt.size; rsv_offset += 16)
+  {
+    range.base = fdt_read_cells(fdt.blob + rsv_offset, 2);
+    range.size = fdt_read_cells(fdt.blob + rsv_offset + 8, 2);
+    if (range.base == 0 && range.size == 0)
+    {
+      break;
+    }
+
+    fdt_add_range(platform.reserved, &platform.reserved_count, FDT_MAX_RESERVED, &range);
+  }
+
+  bool memory_found = false;
+  fdt_parse_subtree((int)fdt_skip_nops(0), 0, &memory_found);
+
+  if (platform.cpu_count == 0)
+  {
+    platform.cpu_count = 1;
+  }
+}
+
+/**
+ * @brief Check the blob handed over by the loader and parse the platform
+ * description, nothing is allocated
+ * 
+ * @param address Blob address
+ * @return int EOK on success, -EINVARG if there is no blob,
+ * -EINVAL if the blob is not a supported device tree
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fdt_init(uintptr_t address)
+{
+  if (address == 0 || (address & 0x7) != 0)
+  {
+    return -EINVARG;
+  }
+
+  const struct fdt_header* header = (const struct fdt_header*)address;
+  if (fdt_read_u32(&header->magic) != FDT_MAGIC ||
+      fdt_read_u32(&header->last_comp_version) > FDT_MIN_VERSION ||
+      fdt_read_u32(&header->version) < FDT_MIN_VERSION)
+  {
+    return -EINVAL;
+  }
+
+  uint32_t total = fdt_read_u32(&header->totalsize);
+  uint32_t struct_offset = fdt_read_u32(&header->off_dt_struct);
+  uint32_t struct_size = fdt_read_u32(&header->size_dt_struct);
+  uint32_t strings_offset = fdt_read_u32(&header->off_dt_strings);
+  uint32_t strings_size = fdt_read_u32(&header->size_dt_strings);
+  if (struct_offset + struct_size > total || strings_offset + strings_size > total || (struct_offset & 0x3) != 0)
+  {
+    return -EINVAL;
+  }
+
+  fdt.blob = (const uint8_t*)address;
+  fdt.size = total;
+  fdt.structs = fdt.blob + struct_offset;
+  fdt.struct_size = struct_size;
+  fdt.strings = (const char*)(fdt.blob + strings_offset);
+  fdt.strings_size = strings_size;
+
+  fdt_parse_platform();
+  platform_ready = true;
+
+  return EOK;
+}
+
+/**
+ * @brief Check if a device tree is available
+ * 
+ * @return bool true if fdt_init() succeeded
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool fdt_present()
+{
+  return fdt.blob != NULL;
+}
+
+/**
+ * @brief Get the blob address
+ * 
+ * @return const void* Blob, NULL if there is none
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const void* fdt_get_blob()
+{
+  return fdt.blob;
+}
+
+/**
+ * @brief Get the blob size
+ * 
+ * @return size_t Size in bytes, 0 if there is no blob
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t fdt_get_size()
+{
+  return fdt.size;
+}
+
+/**
+ * @brief Find a node by its full path, a component without a unit
+ * address matches the node whatever its unit address
+ * 
+ * @param path Absolute path (e.g. "/chosen")
+ * @return int Node offset, -ENOENT if there is no such node
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fdt_path_offset(const char* path)
+{
+  if (!fdt.blob || !path || path[0] != '/')
+  {
+    return -ENOENT;
+  }
+
+  const char* component = path + 1;
+  int depth = 0;
+  int matched = 0; // Depth of the deepest node matching the path so far
+
+  for (uint32_t offset = 0; offset < fdt.struct_size; offset = fdt_next_token(offset))
+  {
+    switch (fdt_token(offset))
+    {
+      case FDT_BEGIN_NODE:
+      {
+        depth++;
+
+        // The root matches the leading '/'
+        if (depth == 1)
+        {
+          matched = 1;
+        }
+        else if (depth == matched + 1)
+        {
+          size_t len = strnlen_terminator(component, 256, '/');
+          if (!fdt_name_matches((const char*)(fdt.structs + offset + 4), component, len))
+          {
+            break;
+          }
+
+          matched = depth;
+          component += len;
+          if (*component == '/')
+          {
+            component++;
+          }
+        }
+        else
+        {
+          break;
+        }
+
+        if (*component == '\0')
+        {
+          return (int)offset;
+        }
+        break;
+      }
+
+      case FDT_END_NODE:
+        depth--;
+
+        // The last matching node ended without the next component
+        if (depth < matched)
+        {
+          return -ENOENT;
+        }
+        break;
+
+      case FDT_END:
+        return -ENOENT;
+
+      default:
+        break;
+    }
+  }
+
+  return -ENOENT;
+}
+
+/**
+ * @brief Get a property of a node
+ * 
+ * @param node Node offset
+ * @param name Property name
+ * @param len Output for the value length, may be NULL
+ * @return const void* Value, NULL if the node has no such property
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const void* fdt_get_property(int node, const char* name, uint32_t* len)
+{
+  if (!fdt.blob || node < 0 || !name || fdt_token((uint32_t)node) != FDT_BEGIN_NODE)
+  {
+    return NULL;
+  }
+
+  size_t name_len = strlen(name);
+
+  // Properties come before the subnodes
+  for (uint32_t offset = fdt_next_token((uint32_t)node); offset < fdt.struct_size; offset = fdt_next_token(offset))
+  {
+    uint32_t token = fdt_token(offset);
+    if (token == FDT_NOP)
+    {
+      continue;
+    }
+    if (token != FDT_PROP || !fdt_prop_valid(offset))
+    {
+      break;
+    }
+
+    uint32_t name_offset = fdt_read_u32(fdt.structs + offset + 8);
+    if (name_len >= fdt.strings_size - name_offset ||
+        strncmp(fdt.strings + name_offset, name, name_len + 1) != 0)
+    {
+      continue;
+    }
+
+    if (len)
+    {
+      *len = fdt_read_u32(fdt.structs + offset + 4);
+    }
+    return fdt.structs + offset + 12;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Get the first subnode of a node
+ * 
+ * @param node Node offset
+ * @return int Subnode offset, -ENOENT if the node has none
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fdt_first_subnode(int node)
+{
+  if (!fdt.blob || node < 0 || fdt_token((uint32_t)node) != FDT_BEGIN_NODE)
+  {
+    return -ENOENT;
+  }
+
+  // Subnodes follow the properties
+  uint32_t offset = fdt_next_token((uint32_t)node);
+  while (fdt_token(offset) == FDT_PROP || fdt_token(offset) == FDT_NOP)
+  {
+    offset = fdt_next_token(offset);
+  }
+
+  return fdt_token(offset) == FDT_BEGIN_NODE ? (int)offset : -ENOENT;
+}
+
+/**
+ * @brief Get the next sibling of a node
+ * 
+ * @param node Node offset
+ * @return int Sibling offset, -ENOENT if the node is the last one
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fdt_next_subnode(int node)
+{
+  if (!fdt.blob || node < 0 || fdt_token((uint32_t)node) != FDT_BEGIN_NODE)
+  {
+    return -ENOENT;
+  }
+
+  // Skip the whole subtree of the node
+  int depth = 0;
+  uint32_t offset = (uint32_t)node;
+  do
+  {
+    switch (fdt_token(offset))
+    {
+      case FDT_BEGIN_NODE:
+        depth++;
+        break;
+
+      case FDT_END_NODE:
+        depth--;
+        break;
+
+      case FDT_END:
+        return -ENOENT;
+
+      default:
+        break;
+    }
+
+    offset = fdt_next_token(offset);
+  } while (depth > 0);
+
+  offset = fdt_skip_nops(offset);
+  return fdt_token(offset) == FDT_BEGIN_NODE ? (int)offset : -ENOENT;
+}
+
+/**
+ * @brief Get the name of a node, with its unit address
+ * 
+ * @param node Node offset
+ * @return const char* Name, NULL if the offset is not a node
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const char* fdt_node_name(int node)
+{
+  if (!fdt.blob || node < 0 || fdt_token((uint32_t)node) != FDT_BEGIN_NODE)
+  {
+    return NULL;
+  }
+
+  return (const char*)(fdt.structs + node + 4);
+}
+
+/**
+ * @brief Check if a node lists a string in its compatible property
+ * 
+ * @param node Node offset
+ * @param compatible Compatible string
+ * @return bool true if the node is compatible
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool fdt_node_is_compatible(int node, const char* compatible)
+{
+  uint32_t len;
+  const char* list = (const char*)fdt_get_property(node, "compatible", &len);
+  if (!list || !compatible)
+  {
+    return false;
+  }
+
+  // NUL separated string list
+  size_t compatible_len = strlen(compatible);
+  uint32_t offset = 0;
+  while (offset < len)
+  {
+    size_t entry_len = strnlen(list + offset, len - offset);
+    if (entry_len == compatible_len && strncmp(list + offset, compatible, compatible_len) == 0)
+    {
+      return true;
+    }
+
+    offset += entry_len + 1;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Get the platform description
+ * 
+ * @return const fdt_platform_t* Description from the device tree, or the
+ * QEMU virt defaults if there is none
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const fdt_platform_t* fdt_get_platform()
+{
+  if (!platform_ready)
+  {
+    fdt_platform_defaults();
+    platform_ready = true;
+  }
+
+  return &platform;
+}
+
+/**
+ * @brief Print the platform description
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void fdt_print_platform()
+{
+  const fdt_platform_t* p = fdt_get_platform();
+
+  uart_send_string(p->from_device_tree ? "Platform (device tree):\n" : "Platform (QEMU virt defaults):\n");
+
+  for (uint32_t i = 0; i < p->memory_count; i++)
+  {
+    uart_send_string("  RAM: 0x");
+    uart_send_string(uint_to_str(p->memory[i].base));
+    uart_send_string(", ");
+    uart_send_string(uint_to_str(p->memory[i].size / (1024 * 1024)));
+    uart_send_string(" MB\n");
+  }
+
+  for (uint32_t i = 0; i < p->reserved_count; i++)
+  {
+    uart_send_string("  Reserved: 0x");
+    uart_send_string(uint_to_str(p->reserved[i].base));
+    uart_send_string(", ");
+    uart_send_string(uint_to_str(p->reserved[i].size / 1024));
+    uart_send_string(" KB\n");
+  }
+
+  uart_send_string("  GIC: 0x");
+  uart_send_string(uint_to_str(p->gicd_base));
+  uart_send_string(" / 0x");
+  uart_send_string(uint_to_str(p->gicc_base));
+  uart_send_string("\n  UART: 0x");
+  uart_send_string(uint_to_str(p->uart_base));
+  uart_send_string(", IRQ ");
+  uart_send_string(uint_to_str(p->uart_irq));
+  uart_send_string("\n  Timer IRQ: ");
+  uart_send_string(uint_to_str(p->timer_irqs[FDT_TIMER_PHYS]));
+  uart_send_string("\n  PSCI: ");
+  uart_send_string(p->psci_method == FDT_PSCI_HVC ? "hvc" : p->psci_method == FDT_PSCI_SMC ? "smc" : "none");
+  uart_send_string("\n  CPUs: ");
+  uart_send_string(uint_to_str(p->cpu_count));
+  uart_send_string("\n  virtio-mmio slots: ");
+  uart_send_string(uint_to_str(p->virtio_count));
+  uart_send_string("\n");
+
+  if (p->initrd_end > p->initrd_start)
+  {
+    uart_send_string("  initrd: 0x");
+    uart_send_string(uint_to_str(p->initrd_start));
+    uart_send_string(", ");
+    uart_send_string(uint_to_str((p->initrd_end - p->initrd_start) / 1024));
+    uart_send_string(" KB\n");
+  }
+}
+
+/**
+ * @brief Test the platform description: RAM banks, device bases, sorted
+ * virtio slots, node walking and heap reservations
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fdt_test()
+{
+  uart_send_string("\n=== Testing Device Tree Platform ===\n");
+
+  const fdt_platform_t* platform = fdt_get_platform();
+  uintptr_t kernel_start = (uintptr_t)&_start;
+
+  // The kernel runs from one of the RAM banks
+  bool kernel_in_ram = false;
+  for (uint32_t i = 0; i < platform->memory_count; i++)
+  {
+    if (kernel_start >= platform->memory[i].base && kernel_start < platform->memory[i].base + platform->memory[i].size)
+    {
+      kernel_in_ram = true;
+    }
+  }
+  if (!kernel_in_ram)
+  {
+    uart_send_string("FAIL: Kernel outside of the RAM banks\n");
+    return -EINVAL;
+  }
+
+  if (platform->gicd_base == 0 || platform->gicc_base == 0 || platform->uart_base == 0)
+  {
+    uart_send_string("FAIL: Missing device base address\n");
+    return -EINVAL;
+  }
+
+  // The timer interrupt is banked per CPU
+  if (platform->timer_irqs[FDT_TIMER_PHYS] < 16 || platform->timer_irqs[FDT_TIMER_PHYS] >= 32)
+  {
+    uart_send_string("FAIL: Timer interrupt is not a PPI\n");
+    return -EINVAL;
+  }
+
+  for (uint32_t i = 1; i < platform->virtio_count; i++)
+  {
+    if (platform->virtio[i].base <= platform->virtio[i - 1].base)
+    {
+      uart_send_string("FAIL: virtio-mmio slots not sorted\n");
+      return -EINVAL;
+    }
+  }
+
+  if (fdt_present())
+  {
+    int root = fdt_path_offset("/");
+    uint32_t nodes = 0;
+    for (int node = fdt_first_subnode(root); node >= 0; node = fdt_next_subnode(node))
+    {
+      if (!fdt_node_name(node))
+      {
+        uart_send_string("FAIL: Subnode without a name\n");
+        return -EINVAL;
+      }
+      nodes++;
+    }
+
+    if (root < 0 || nodes == 0 || fdt_path_offset("/chosen") < 0)
+    {
+      uart_send_string("FAIL: Device tree walk\n");
+      return -EINVAL;
+    }
+
+    uart_send_string("Root subnodes: ");
+    uart_send_string(uint_to_str(nodes));
+    uart_send_string("\n");
+  }
+
+  // Reserved ranges are never handed out by the heap
+  void* blocks[DT_TEST_ALLOCATIONS];
+  int res = EOK;
+  for (int i = 0; i < DT_TEST_ALLOCATIONS; i++)
+  {
+    blocks[i] = kmalloc(KERNEL_HEAP_BLOCK_SIZE);
+    if (!blocks[i])
+    {
+      continue;
+    }
+
+    uintptr_t block = (uintptr_t)blocks[i];
+    for (uint32_t j = 0; j < platform->reserved_count; j++)
+    {
+      if (block + KERNEL_HEAP_BLOCK_SIZE > platform->reserved[j].base && block < platform->reserved[j].base + platform->reserved[j].size)
+      {
+        res = -EINVAL;
+      }
+    }
+
+    uintptr_t blob = (uintptr_t)fdt_get_blob();
+    if (blob && block + KERNEL_HEAP_BLOCK_SIZE > blob && block < blob + fdt_get_size())
+    {
+      res = -EINVAL;
+    }
+  }
+
+  for (int i = 0; i < DT_TEST_ALLOCATIONS; i++)
+  {
+    if (blocks[i])
+    {
+      kfree(blocks[i]);
+    }
+  }
+
+  if (res != EOK)
+  {
+    uart_send_string("FAIL: Heap handed out reserved memory\n");
+    return res;
+  }
+
+  uart_send_string("Device tree platform tests PASSED\n");
+  return EOK;
+}
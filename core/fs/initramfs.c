@@ -0,0 +1,931 @@
+/*
+ * initramfs.c - This file implements the read-only RAM filesystem built
+ * from the cpio archive handed over by the loader. Mounting only builds
+ * a hashed path index, file contents are read from the archive.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "initramfs.h"
+
+#include <uart.h>
+
+#include <kernel/config.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/fdt/fdt.h>
+#include <synapse/string/string.h>
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+
+// Root filesystem, from the -initrd archive
+static initramfs_t root_fs;
+static bool root_mounted = false;
+
+// Initramfs test configuration (archive built in memory)
+#define INITRAMFS_TEST_ARCHIVE_SIZE (4 * PAGE_SIZE)
+#define INITRAMFS_TEST_SMALL_SIZE 100
+#define INITRAMFS_TEST_LARGE_SIZE 5000
+
+/**
+ * @brief Parse an 8 digit hexadecimal field of a cpio header
+ * 
+ * @param field Field
+ * @param value Output for the value
+ * @return int EOK on success, -EINVAL if the field is not hexadecimal
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int initramfs_parse_hex(const char* field, uint32_t* value)
+{
+  uint32_t result = 0;
+
+  for (int i = 0; i < 8; i++)
+  {
+    char c = tolower(field[i]);
+    if (isdigit(c))
+    {
+      result = (result << 4) | (uint32_t)tonumericdigit(c);
+    }
+    else if (c >= 'a' && c <= 'f')
+    {
+      result = (result << 4) | (uint32_t)(c - 'a' + 10);
+    }
+    else
+    {
+      return -EINVAL;
+    }
+  }
+
+  *value = result;
+  return EOK;
+}
+
+/**
+ * @brief Strip the leading "/" and "./" of a path
+ * 
+ * @param path Path
+ * @param len Output for the length of the stripped path
+ * @return const char* Stripped path, "" for the root directory
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static const char* initramfs_normalize(const char* path, uint32_t* len)
+{
+  while (path[0] == '/' || (path[0] == '.' && (path[1] == '/' || path[1] == '\0')))
+  {
+    path++;
+  }
+
+  size_t path_len = strnlen(path, INITRAMFS_MAX_PATH);
+
+  // "dir/" names the same file as "dir"
+  while (path_len > 0 && path[path_len - 1] == '/')
+  {
+    path_len--;
+  }
+
+  *len = (uint32_t)path_len;
+  return path;
+}
+
+/**
+ * @brief Hash a path (FNV-1a)
+ * 
+ * @param path Path
+ * @param len Path length
+ * @return uint32_t Hash
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t initramfs_hash(const char* path, uint32_t len)
+{
+  uint32_t hash = 2166136261u;
+
+  for (uint32_t i = 0; i < len; i++)
+  {
+    hash ^= (uint8_t)path[i];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+/**
+ * @brief Find the inode of a path
+ * 
+ * @param fs Filesystem
+ * @param path Path
+ * @return int Inode index, -ENOENT if there is no such file
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int initramfs_find(initramfs_t* fs, const char* path)
+{
+  if (!fs || !fs->archive || !path)
+  {
+    return -ENOENT;
+  }
+
+  uint32_t len;
+  path = initramfs_normalize(path, &len);
+  uint32_t hash = initramfs_hash(path, len);
+
+  for (int i = fs->buckets[hash & (INITRAMFS_HASH_BUCKETS - 1)]; i >= 0; i = fs->inodes[i].next)
+  {
+    initramfs_inode_t* inode = &fs->inodes[i];
+    if (inode->hash == hash && inode->path_len == len && memcmp((void*)inode->path, (void*)path, len) == 0)
+    {
+      return i;
+    }
+  }
+
+  return -ENOENT;
+}
+
+/**
+ * @brief Get an open file of a process
+ * 
+ * @param fs Filesystem
+ * @param owner Process owning the file
+ * @param fd File descriptor
+ * @return initramfs_file_t* File, NULL if the descriptor is not valid
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static initramfs_file_t* initramfs_get_file(initramfs_t* fs, pid_t owner, int fd)
+{
+  if (!fs || fd < 0 || fd >= INITRAMFS_MAX_OPEN_FILES)
+  {
+    return NULL;
+  }
+
+  initramfs_file_t* file = &fs->files[fd];
+  if (!file->used || file->owner != owner)
+  {
+    return NULL;
+  }
+
+  return file;
+}
+
+/**
+ * @brief Walk the archive, counting its files or filling the inodes
+ * 
+ * @param fs Filesystem, inodes are filled if fs->inodes is set
+ * @param count Output for the number of files
+ * @return int EOK on success, -EINVAL if the archive is malformed
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int initramfs_scan(initramfs_t* fs, size_t* count)
+{
+  size_t offset = 0;
+  size_t files = 0;
+
+  while (true)
+  {
+    if (offset + CPIO_NEWC_HEADER_SIZE > fs->archive_size)
+    {
+      return -EINVAL;
+    }
+
+    const char* header = (const char*)(fs->archive + offset);
+    bool has_check = strncmp(header, CPIO_CRC_MAGIC, 6) == 0;
+    if (!has_check && strncmp(header, CPIO_NEWC_MAGIC, 6) != 0)
+    {
+      return -EINVAL;
+    }
+
+    // Fields after the magic: ino, mode, uid, gid, nlink, mtime, filesize,
+    // devmajor, devminor, rdevmajor, rdevminor, namesize, check
+    uint32_t mode, file_size, name_size, check;
+    if (initramfs_parse_hex(header + 14, &mode) < 0 || initramfs_parse_hex(header + 54, &file_size) < 0 ||
+        initramfs_parse_hex(header + 94, &name_size) < 0 || name_size == 0 ||
+        initramfs_parse_hex(header + 102, &check) < 0)
+    {
+      return -EINVAL;
+    }
+
+    // Name and data are each padded to 4 bytes
+    const char* name = header + CPIO_NEWC_HEADER_SIZE;
+    size_t data_offset = (offset + CPIO_NEWC_HEADER_SIZE + name_size + 3) & ~(size_t)3;
+    size_t next_offset = (data_offset + file_size + 3) & ~(size_t)3;
+    if (offset + CPIO_NEWC_HEADER_SIZE + name_size > fs->archive_size ||
+        data_offset + file_size > fs->archive_size || name[name_size - 1] != '\0')
+    {
+      return -EINVAL;
+    }
+
+    if (name_size == sizeof(CPIO_TRAILER) && strncmp(name, CPIO_TRAILER, name_size) == 0)
+    {
+      break;
+    }
+
+    if (fs->inodes)
+    {
+      initramfs_inode_t* inode = &fs->inodes[files];
+      inode->path = initramfs_normalize(name, &inode->path_len);
+      inode->hash = initramfs_hash(inode->path, inode->path_len);
+      inode->mode = mode;
+      inode->data = fs->archive + data_offset;
+      inode->size = file_size;
+      inode->copy = NULL;
+      inode->map_count = 0;
+      inode->has_check = has_check;
+      inode->check = check;
+
+      // Later entries of the same path win, as when unpacking
+      int* bucket = &fs->buckets[inode->hash & (INITRAMFS_HASH_BUCKETS - 1)];
+      inode->next = *bucket;
+      *bucket = (int)files;
+    }
+
+    files++;
+    offset = next_offset;
+  }
+
+  *count = files;
+  return EOK;
+}
+
+/**
+ * @brief Mount the archive passed with -initrd as the root filesystem,
+ * its location comes from the /chosen node of the device tree
+ * 
+ * @return int EOK on success, -ENOENT if there is no archive,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_init()
+{
+  // The memory system already keeps the heap off the archive
+  const fdt_platform_t* platform = fdt_get_platform();
+  if (platform->initrd_start == 0 || platform->initrd_end <= platform->initrd_start)
+  {
+    return -ENOENT;
+  }
+
+  uintptr_t start = (uintptr_t)platform->initrd_start;
+  uintptr_t end = (uintptr_t)platform->initrd_end;
+
+  int res = initramfs_mount(&root_fs, (const void*)start, end - start);
+  if (res < 0)
+  {
+    uart_send_string("initramfs: malformed archive\n");
+    return res;
+  }
+
+  root_mounted = true;
+
+  uart_send_string("initramfs: ");
+  uart_send_string(uint_to_str(root_fs.inode_count));
+  uart_send_string(" files, ");
+  uart_send_string(uint_to_str((end - start) / 1024));
+  uart_send_string(" KB\n");
+
+  return EOK;
+}
+
+/**
+ * @brief Get the root filesystem
+ * 
+ * @return initramfs_t* Root filesystem, NULL if none is mounted
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+initramfs_t* initramfs_get_root()
+{
+  return root_mounted ? &root_fs : NULL;
+}
+
+/**
+ * @brief Index a cpio archive, the archive must stay in memory until the
+ * filesystem is unmounted
+ * 
+ * @param fs Filesystem
+ * @param archive cpio "newc" archive
+ * @param size Archive size in bytes
+ * @return int EOK on success, -EINVAL if the archive is malformed,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_mount(initramfs_t* fs, const void* archive, size_t size)
+{
+  if (!fs || !archive || size == 0)
+  {
+    return -EINVARG;
+  }
+
+  memset(fs, 0, sizeof(initramfs_t));
+  for (int i = 0; i < INITRAMFS_HASH_BUCKETS; i++)
+  {
+    fs->buckets[i] = -1;
+  }
+
+  fs->archive = (const uint8_t*)archive;
+  fs->archive_size = size;
+
+  size_t count = 0;
+  int res = initramfs_scan(fs, &count);
+  if (res < 0)
+  {
+    goto fail;
+  }
+
+  if (count > 0)
+  {
+    fs->inodes = (initramfs_inode_t*)kzalloc(count * sizeof(initramfs_inode_t));
+    if (!fs->inodes)
+    {
+      res = -ENOMEM;
+      goto fail;
+    }
+
+    res = initramfs_scan(fs, &count);
+    if (res < 0)
+    {
+      goto fail;
+    }
+  }
+
+  fs->inode_count = count;
+  return EOK;
+
+fail:
+  if (fs->inodes)
+  {
+    kfree(fs->inodes);
+  }
+  memset(fs, 0, sizeof(initramfs_t));
+  return res;
+}
+
+/**
+ * @brief Drop the index of a filesystem
+ * 
+ * @param fs Filesystem
+ * @return int EOK on success, -EINUSE while files are open
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_unmount(initramfs_t* fs)
+{
+  if (!fs)
+  {
+    return -EINVARG;
+  }
+
+  for (int i = 0; i < INITRAMFS_MAX_OPEN_FILES; i++)
+  {
+    if (fs->files[i].used)
+    {
+      return -EINUSE;
+    }
+  }
+
+  if (fs->inodes)
+  {
+    kfree(fs->inodes);
+  }
+
+  if (fs == &root_fs)
+  {
+    root_mounted = false;
+  }
+
+  memset(fs, 0, sizeof(initramfs_t));
+  return EOK;
+}
+
+/**
+ * @brief Check the contents of every file of a "crc" archive against the
+ * checksum of its header, before a model image is trusted
+ * 
+ * @param fs Filesystem
+ * @return int Files checked, -EIO if one does not match, -EINVARG on a
+ * bad filesystem
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_verify(initramfs_t* fs)
+{
+  if (!fs || !fs->archive)
+  {
+    return -EINVARG;
+  }
+
+  int checked = 0;
+  for (size_t i = 0; i < fs->inode_count; i++)
+  {
+    const initramfs_inode_t* inode = &fs->inodes[i];
+    if (!inode->has_check || (inode->mode & INITRAMFS_MODE_TYPE_MASK) != INITRAMFS_MODE_FILE)
+    {
+      continue;
+    }
+
+    uint32_t sum = 0;
+    for (size_t j = 0; j < inode->size; j++)
+    {
+      sum += inode->data[j];
+    }
+
+    if (sum != inode->check)
+    {
+      uart_send_string("initramfs: checksum mismatch in ");
+      uart_send_string(inode->path);
+      uart_send_string("\n");
+      return -EIO;
+    }
+
+    checked++;
+  }
+
+  return checked;
+}
+
+/**
+ * @brief Find a file, for kernel users that read it in place
+ * 
+ * @param fs Filesystem
+ * @param path Path, with or without a leading "/"
+ * @param data Output for the contents, inside the archive
+ * @param size Output for the size, may be NULL
+ * @return int EOK on success, -ENOENT if there is no such file
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_lookup(initramfs_t* fs, const char* path, const void** data, size_t* size)
+{
+  if (!data)
+  {
+    return -EINVARG;
+  }
+
+  int ino = initramfs_find(fs, path);
+  if (ino < 0)
+  {
+    return ino;
+  }
+
+  *data = fs->inodes[ino].data;
+  if (size)
+  {
+    *size = fs->inodes[ino].size;
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Get the information of a file
+ * 
+ * @param fs Filesystem
+ * @param path Path
+ * @param stat Output for the information
+ * @return int EOK on success, -ENOENT if there is no such file
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_stat(initramfs_t* fs, const char* path, initramfs_stat_t* stat)
+{
+  if (!stat)
+  {
+    return -EINVARG;
+  }
+
+  int ino = initramfs_find(fs, path);
+  if (ino < 0)
+  {
+    return ino;
+  }
+
+  initramfs_inode_t* inode = &fs->inodes[ino];
+  stat->ino = (uint32_t)ino;
+  stat->mode = inode->mode;
+  stat->size = inode->size;
+  stat->zero_copy = ((uintptr_t)inode->data & (PAGE_SIZE - 1)) == 0;
+
+  return EOK;
+}
+
+/**
+ * @brief Open a file for reading
+ * 
+ * @param fs Filesystem
+ * @param owner Process opening the file, or INITRAMFS_OWNER_KERNEL
+ * @param path Path
+ * @return int File descriptor, -ENOENT if there is no such file,
+ * -EPMAX if too many files are open
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_open(initramfs_t* fs, pid_t owner, const char* path)
+{
+  int ino = initramfs_find(fs, path);
+  if (ino < 0)
+  {
+    return ino;
+  }
+
+  for (int fd = 0; fd < INITRAMFS_MAX_OPEN_FILES; fd++)
+  {
+    initramfs_file_t* file = &fs->files[fd];
+    if (!file->used)
+    {
+      file->used = true;
+      file->owner = owner;
+      file->inode = ino;
+      file->offset = 0;
+      file->mapped = false;
+      return fd;
+    }
+  }
+
+  return -EPMAX;
+}
+
+/**
+ * @brief Read from the current position of a file
+ * 
+ * @param fs Filesystem
+ * @param owner Process owning the file
+ * @param fd File descriptor
+ * @param buffer Destination
+ * @param size Bytes to read
+ * @return int Bytes read, 0 at the end of the file, negative error code
+ * on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_read(initramfs_t* fs, pid_t owner, int fd, void* buffer, size_t size)
+{
+  initramfs_file_t* file = initramfs_get_file(fs, owner, fd);
+  if (!file || !buffer)
+  {
+    return -EINVARG;
+  }
+
+  initramfs_inode_t* inode = &fs->inodes[file->inode];
+  if ((inode->mode & INITRAMFS_MODE_TYPE_MASK) == INITRAMFS_MODE_DIR)
+  {
+    return -EINVARG;
+  }
+
+  size_t remaining = inode->size - file->offset;
+  size_t count = size < remaining ? size : remaining;
+
+  // The return value is an int
+  if (count > 0x7FFFFFFF)
+  {
+    count = 0x7FFFFFFF;
+  }
+
+  memcpy(buffer, (void*)(inode->data + file->offset), (int)count);
+  file->offset += count;
+
+  return (int)count;
+}
+
+/**
+ * @brief Get the contents of a file without copying them
+ * 
+ * Page aligned contents are returned in place. Others are copied once to
+ * a page aligned buffer shared by every mapping of the file. The address
+ * stays valid until the file is closed.
+ * 
+ * @param fs Filesystem
+ * @param owner Process owning the file
+ * @param fd File descriptor
+ * @param addr Output for the contents
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_mmap(initramfs_t* fs, pid_t owner, int fd, const void** addr)
+{
+  initramfs_file_t* file = initramfs_get_file(fs, owner, fd);
+  if (!file || !addr)
+  {
+    return -EINVARG;
+  }
+
+  initramfs_inode_t* inode = &fs->inodes[file->inode];
+  if ((inode->mode & INITRAMFS_MODE_TYPE_MASK) == INITRAMFS_MODE_DIR)
+  {
+    return -EINVARG;
+  }
+
+  if (((uintptr_t)inode->data & (PAGE_SIZE - 1)) == 0 || inode->size == 0)
+  {
+    *addr = inode->data;
+    return EOK;
+  }
+
+  if (!inode->copy)
+  {
+    // Heap blocks are page aligned
+    inode->copy = kmalloc(inode->size);
+    if (!inode->copy)
+    {
+      return -ENOMEM;
+    }
+
+    memcpy(inode->copy, (void*)inode->data, (int)inode->size);
+  }
+
+  if (!file->mapped)
+  {
+    file->mapped = true;
+    inode->map_count++;
+  }
+
+  *addr = inode->copy;
+  return EOK;
+}
+
+/**
+ * @brief Close a file
+ * 
+ * @param fs Filesystem
+ * @param owner Process owning the file
+ * @param fd File descriptor
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_close(initramfs_t* fs, pid_t owner, int fd)
+{
+  initramfs_file_t* file = initramfs_get_file(fs, owner, fd);
+  if (!file)
+  {
+    return -EINVARG;
+  }
+
+  // The shared copy goes with its last mapping
+  initramfs_inode_t* inode = &fs->inodes[file->inode];
+  if (file->mapped && --inode->map_count == 0 && inode->copy)
+  {
+    kfree(inode->copy);
+    inode->copy = NULL;
+  }
+
+  file->used = false;
+  return EOK;
+}
+
+/**
+ * @brief Close every file of a process
+ * 
+ * @param fs Filesystem
+ * @param owner Process
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void initramfs_close_all(initramfs_t* fs, pid_t owner)
+{
+  if (!fs)
+  {
+    return;
+  }
+
+  for (int fd = 0; fd < INITRAMFS_MAX_OPEN_FILES; fd++)
+  {
+    if (fs->files[fd].used && fs->files[fd].owner == owner)
+    {
+      initramfs_close(fs, owner, fd);
+    }
+  }
+}
+
+// Write a cpio "newc" header field
+static void initramfs_test_hex(uint8_t* field, uint32_t value)
+{
+  for (int i = 7; i >= 0; i--)
+  {
+    uint32_t digit = value & 0xF;
+    field[i] = digit < 10 ? '0' + digit : 'a' + (digit - 10);
+    value >>= 4;
+  }
+}
+
+// Append an entry to a cpio archive, returns the offset of the next entry
+static size_t initramfs_test_add(uint8_t* archive, size_t offset, const char* name, uint32_t mode, size_t size)
+{
+  uint8_t* header = archive + offset;
+  size_t name_size = strlen(name) + 1;
+
+  memset(header, '0', CPIO_NEWC_HEADER_SIZE);
+  memcpy(header, CPIO_NEWC_MAGIC, 6);
+  initramfs_test_hex(header + 14, mode);
+  initramfs_test_hex(header + 38, 1);
+  initramfs_test_hex(header + 54, (uint32_t)size);
+  initramfs_test_hex(header + 94, (uint32_t)name_size);
+  memcpy(header + CPIO_NEWC_HEADER_SIZE, (void*)name, name_size);
+
+  size_t data_offset = (offset + CPIO_NEWC_HEADER_SIZE + name_size + 3) & ~(size_t)3;
+  for (size_t i = 0; i < size; i++)
+  {
+    archive[data_offset + i] = (uint8_t)(i * 13);
+  }
+
+  return (data_offset + size + 3) & ~(size_t)3;
+}
+
+/**
+ * @brief Test the initramfs: archive parsing, hashed lookup, stat, read,
+ * in place and copied mmap, open file accounting and checksums
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_test()
+{
+  static initramfs_t fs;
+  uint8_t buffer[64];
+  int res = EOK;
+
+  uart_send_string("\n=== Testing Initramfs ===\n");
+
+  uint8_t* archive = (uint8_t*)kzalloc(INITRAMFS_TEST_ARCHIVE_SIZE);
+  if (!archive)
+  {
+    uart_send_string("FAIL: Archive allocation failed\n");
+    return -ENOMEM;
+  }
+
+  size_t offset = initramfs_test_add(archive, 0, ".", INITRAMFS_MODE_DIR | 0755, 0);
+  offset = initramfs_test_add(archive, offset, "models", INITRAMFS_MODE_DIR | 0755, 0);
+  size_t tiny_offset = offset;
+  offset = initramfs_test_add(archive, offset, "models/tiny.bin", INITRAMFS_MODE_FILE | 0644, INITRAMFS_TEST_SMALL_SIZE);
+
+  // Padding file so that the data of the next one starts on a page
+  size_t pad_data = (offset + CPIO_NEWC_HEADER_SIZE + sizeof("pad") + 3) & ~(size_t)3;
+  size_t next_header = (CPIO_NEWC_HEADER_SIZE + sizeof("models/weights.bin") + 3) & ~(size_t)3;
+  size_t pad_size = (PAGE_SIZE - ((pad_data + next_header) % PAGE_SIZE)) % PAGE_SIZE;
+  offset = initramfs_test_add(archive, offset, "pad", INITRAMFS_MODE_FILE | 0644, pad_size);
+  offset = initramfs_test_add(archive, offset, "models/weights.bin", INITRAMFS_MODE_FILE | 0644, INITRAMFS_TEST_LARGE_SIZE);
+  offset = initramfs_test_add(archive, offset, "bin/hello", INITRAMFS_MODE_FILE | 0755, 37);
+  offset = initramfs_test_add(archive, offset, CPIO_TRAILER, 0, 0);
+
+  if (initramfs_mount(&fs, archive, 64) != -EINVAL)
+  {
+    uart_send_string("FAIL: Truncated archive accepted\n");
+    res = -EIO;
+    goto out;
+  }
+
+  res = initramfs_mount(&fs, archive, offset);
+  if (res != EOK || fs.inode_count != 6 || initramfs_verify(&fs) != 0)
+  {
+    uart_send_string("FAIL: Archive mount\n");
+    res = -EIO;
+    goto out;
+  }
+
+  initramfs_stat_t stat;
+  if (initramfs_stat(&fs, "/models/weights.bin", &stat) != EOK || stat.size != INITRAMFS_TEST_LARGE_SIZE ||
+      !stat.zero_copy || (stat.mode & INITRAMFS_MODE_TYPE_MASK) != INITRAMFS_MODE_FILE ||
+      initramfs_stat(&fs, "models/", &stat) != EOK || (stat.mode & INITRAMFS_MODE_TYPE_MASK) != INITRAMFS_MODE_DIR ||
+      initramfs_stat(&fs, "/", &stat) != EOK || initramfs_stat(&fs, "/models/missing", &stat) != -ENOENT)
+  {
+    uart_send_string("FAIL: Path lookup\n");
+    res = -EIO;
+    goto out;
+  }
+
+  // Page aligned contents come straight from the archive
+  const void* weights = NULL;
+  int large = initramfs_open(&fs, INITRAMFS_OWNER_KERNEL, "models/weights.bin");
+  if (large < 0 || initramfs_mmap(&fs, INITRAMFS_OWNER_KERNEL, large, &weights) != EOK ||
+      (const uint8_t*)weights < archive || (const uint8_t*)weights >= archive + offset ||
+      ((const uint8_t*)weights)[4999] != (uint8_t)(4999 * 13))
+  {
+    uart_send_string("FAIL: In place mmap\n");
+    res = -EIO;
+    goto out;
+  }
+
+  // Reads stop at the end of the file
+  int small = initramfs_open(&fs, INITRAMFS_OWNER_KERNEL, "/models/tiny.bin");
+  if (small < 0 || initramfs_read(&fs, INITRAMFS_OWNER_KERNEL, small, buffer, 60) != 60 ||
+      buffer[59] != (uint8_t)(59 * 13) ||
+      initramfs_read(&fs, INITRAMFS_OWNER_KERNEL, small, buffer, 60) != INITRAMFS_TEST_SMALL_SIZE - 60 ||
+      buffer[0] != (uint8_t)(60 * 13) || initramfs_read(&fs, INITRAMFS_OWNER_KERNEL, small, buffer, 60) != 0 ||
+      initramfs_read(&fs, 1, small, buffer, 60) != -EINVARG)
+  {
+    uart_send_string("FAIL: File read\n");
+    res = -EIO;
+    goto out;
+  }
+
+  // Unaligned contents share one page aligned copy
+  const void* first = NULL;
+  const void* second = NULL;
+  int again = initramfs_open(&fs, INITRAMFS_OWNER_KERNEL, "models/tiny.bin");
+  if (again < 0 || initramfs_mmap(&fs, INITRAMFS_OWNER_KERNEL, small, &first) != EOK ||
+      initramfs_mmap(&fs, INITRAMFS_OWNER_KERNEL, again, &second) != EOK || first != second ||
+      ((uintptr_t)first & (PAGE_SIZE - 1)) != 0 || ((const uint8_t*)first)[99] != (uint8_t)(99 * 13))
+  {
+    uart_send_string("FAIL: Copied mmap\n");
+    res = -EIO;
+    goto out;
+  }
+
+  if (initramfs_unmount(&fs) != -EINUSE)
+  {
+    uart_send_string("FAIL: Unmount with open files\n");
+    res = -EIO;
+    goto out;
+  }
+
+  // The copy goes with the last mapping
+  initramfs_close(&fs, INITRAMFS_OWNER_KERNEL, small);
+  initramfs_close_all(&fs, INITRAMFS_OWNER_KERNEL);
+  if (initramfs_stat(&fs, "models/tiny.bin", &stat) != EOK || fs.inodes[stat.ino].copy != NULL)
+  {
+    uart_send_string("FAIL: Shared copy not released\n");
+    res = -EIO;
+    goto out;
+  }
+
+  res = initramfs_unmount(&fs);
+  if (res != EOK)
+  {
+    uart_send_string("FAIL: Unmount\n");
+    goto out;
+  }
+
+  // A "crc" entry is checked against the sum of its contents
+  uint8_t* tiny = archive + tiny_offset;
+  uint8_t* tiny_data = archive + ((tiny_offset + CPIO_NEWC_HEADER_SIZE + sizeof("models/tiny.bin") + 3) & ~(size_t)3);
+  uint32_t sum = 0;
+  for (size_t i = 0; i < INITRAMFS_TEST_SMALL_SIZE; i++)
+  {
+    sum += tiny_data[i];
+  }
+  memcpy(tiny, CPIO_CRC_MAGIC, 6);
+  initramfs_test_hex(tiny + 102, sum);
+
+  res = initramfs_mount(&fs, archive, offset);
+  if (res != EOK || initramfs_verify(&fs) != 1)
+  {
+    uart_send_string("FAIL: Checksum of a valid file\n");
+    res = -EIO;
+    goto out;
+  }
+
+  tiny_data[7]++;
+  if (initramfs_verify(&fs) != -EIO)
+  {
+    uart_send_string("FAIL: Corrupted file accepted\n");
+    res = -EIO;
+    goto out;
+  }
+
+  res = initramfs_unmount(&fs);
+  if (res != EOK)
+  {
+    uart_send_string("FAIL: Unmount\n");
+    goto out;
+  }
+
+  uart_send_string("Initramfs tests PASSED\n");
+
+out:
+  if (fs.archive)
+  {
+    initramfs_close_all(&fs, INITRAMFS_OWNER_KERNEL);
+    initramfs_unmount(&fs);
+  }
+  kfree(archive);
+
+  return res;
+}
@@ -0,0 +1,333 @@
+/*
+ * init.c - This file implements parallel boot initialisation: the loop
+ * every CPU runs to take ready tasks from the table, and the report of
+ * where the boot time went.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "init.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/smp/smp.h>
+#include <synapse/sync/atomic.h>
+#include <synapse/task/task.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// Table shared by the CPUs of a run
+typedef struct
+{
+  init_task_t* tasks;
+  uint32_t count;
+  volatile uint32_t remaining; // Tasks not done
+} init_table_t;
+
+/**
+ * @brief Check the dependencies of a task
+ * 
+ * @param table Table of the run
+ * @param task Task
+ * @return int EOK if all are done, -ENOTREADY if one is not done yet,
+ * -EIO if one failed
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int init_deps_ready(init_table_t* table, const init_task_t* task)
+{
+  for (uint32_t i = 0; i < table->count; i++)
+  {
+    if (!(task->deps & (1U << i)))
+    {
+      continue;
+    }
+
+    init_task_t* dep = &table->tasks[i];
+    if (atomic_load_acquire_32(&dep->state) != INIT_DONE)
+    {
+      return -ENOTREADY;
+    }
+
+    if (dep->result < 0)
+    {
+      return -EIO;
+    }
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Loop of every CPU of a run: claim the first ready task, run it,
+ * start over, until no task is left
+ * 
+ * @param arg Table of the run
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void init_worker(void* arg)
+{
+  init_table_t* table = (init_table_t*)arg;
+  uint32_t cpu = smp_processor_id();
+
+  while (atomic_load_acquire_32(&table->remaining) > 0)
+  {
+    bool claimed = false;
+
+    for (uint32_t i = 0; i < table->count && !claimed; i++)
+    {
+      init_task_t* task = &table->tasks[i];
+      if (task->state != INIT_PENDING || (task->cpu != TASK_CPU_ANY && (uint32_t)task->cpu != cpu))
+      {
+        continue;
+      }
+
+      int ready = init_deps_ready(table, task);
+      if (ready == -ENOTREADY)
+      {
+        continue;
+      }
+
+      if (atomic_cas_32(&task->state, INIT_PENDING, INIT_RUNNING) != INIT_PENDING)
+      {
+        continue;
+      }
+
+      claimed = true;
+      task->ran_on = cpu;
+      task->start = timer_read_counter();
+      task->result = ready == EOK ? task->function(task->arg) : -ENOTREADY;
+      task->end = timer_read_counter();
+
+      atomic_store_release_32(&task->state, INIT_DONE);
+      atomic_fetch_add_32(&table->remaining, (uint32_t)-1);
+    }
+
+    if (!claimed)
+    {
+      cpu_relax();
+    }
+  }
+}
+
+/**
+ * @brief Run a table of init tasks on the first CPUs and wait until every
+ * task is done. A task whose dependency failed is skipped
+ * 
+ * @param tasks Tasks, their state is reset
+ * @param count Number of tasks, up to INIT_MAX_TASKS
+ * @param cpus CPUs to use, 1 to smp_cpu_count()
+ * @return int Number of failed or skipped tasks, -EINVARG on a bad table:
+ * a dependency on the task itself or a later one, or a task pinned to a
+ * CPU not used
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int init_run(init_task_t* tasks, uint32_t count, uint32_t cpus)
+{
+  if (!tasks || count == 0 || count > INIT_MAX_TASKS || cpus == 0 || cpus > smp_cpu_count())
+  {
+    return -EINVARG;
+  }
+
+  // Only earlier tasks may be waited for, so the table cannot deadlock
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (!tasks[i].function || (tasks[i].deps >> i) != 0)
+    {
+      return -EINVARG;
+    }
+
+    if (tasks[i].cpu != TASK_CPU_ANY && (tasks[i].cpu < 0 || (uint32_t)tasks[i].cpu >= cpus))
+    {
+      return -EINVARG;
+    }
+  }
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    tasks[i].state = INIT_PENDING;
+    tasks[i].result = EOK;
+    tasks[i].start = 0;
+    tasks[i].end = 0;
+    tasks[i].ran_on = 0;
+  }
+
+  init_table_t table = { .tasks = tasks, .count = count, .remaining = count };
+  int res = smp_run(cpus, init_worker, &table);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  int failed = 0;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (tasks[i].result < 0)
+    {
+      failed++;
+    }
+  }
+
+  return failed;
+}
+
+/**
+ * @brief Print the time and CPU of each task of a run, and the boot time
+ * saved against running them one after another
+ * 
+ * @param tasks Tasks of a finished run
+ * @param count Number of tasks
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void init_print_report(const init_task_t* tasks, uint32_t count)
+{
+  if (!tasks || count == 0)
+  {
+    return;
+  }
+
+  uint64_t frequency = timer_read_frequency();
+  uint64_t first = tasks[0].start;
+  uint64_t last = tasks[0].end;
+  uint64_t serial = 0;
+
+  uart_send_string("\n=== Boot Initialisation ===\n");
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint64_t ticks = tasks[i].end - tasks[i].start;
+    serial += ticks;
+
+    if (tasks[i].start < first)
+    {
+      first = tasks[i].start;
+    }
+
+    if (tasks[i].end > last)
+    {
+      last = tasks[i].end;
+    }
+
+    uart_send_string("  ");
+    uart_send_string(tasks[i].name);
+    uart_send_string(": ");
+    uart_send_string(uint_to_str((ticks * 1000000ULL) / frequency));
+    uart_send_string(" us on CPU ");
+    uart_send_string(uint_to_str(tasks[i].ran_on));
+    if (tasks[i].result == -ENOTREADY)
+    {
+      uart_send_string(", skipped");
+    }
+    else if (tasks[i].result < 0)
+    {
+      uart_send_string(", failed");
+    }
+    uart_send_string("\n");
+  }
+
+  uint64_t wall = last - first;
+
+  uart_send_string("  parallel: ");
+  uart_send_string(uint_to_str((wall * 1000000ULL) / frequency));
+  uart_send_string(" us, one after another: ");
+  uart_send_string(uint_to_str((serial * 1000000ULL) / frequency));
+  uart_send_string(" us, saved: ");
+  uart_send_string(uint_to_str(serial > wall ? ((serial - wall) * 100) / serial : 0));
+  uart_send_string("%\n");
+}
+
+// Init task of the tests that succeeds
+static int init_test_ok(void* arg)
+{
+  return EOK;
+}
+
+// Init task of the tests that fails
+static int init_test_fail(void* arg)
+{
+  return -EIO;
+}
+
+/**
+ * @brief Test parallel boot initialisation: dependency order, tasks
+ * pinned to a CPU, skipping after a failure and bad tables
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int init_test()
+{
+  uart_send_string("\n=== Testing Boot Initialisation ===\n");
+
+  uint32_t cpus = smp_cpu_count();
+  init_task_t tasks[5] = {
+    { .name = "a", .function = init_test_ok, .cpu = TASK_CPU_ANY },
+    { .name = "b", .function = init_test_ok, .deps = 1U << 0, .cpu = TASK_CPU_ANY },
+    { .name = "c", .function = init_test_fail, .cpu = TASK_CPU_ANY },
+    { .name = "d", .function = init_test_ok, .deps = 1U << 2, .cpu = TASK_CPU_ANY },
+    { .name = "e", .function = init_test_ok, .deps = 1U << 1, .cpu = (int32_t)(cpus - 1) },
+  };
+
+  // c fails and d, waiting for it, is skipped
+  int res = init_run(tasks, 5, cpus);
+  if (res != 2 || tasks[2].result != -EIO || tasks[3].result != -ENOTREADY)
+  {
+    uart_send_string("FAIL: Failed dependency\n");
+    return -EIO;
+  }
+
+  for (uint32_t i = 0; i < 5; i++)
+  {
+    if (tasks[i].state != INIT_DONE)
+    {
+      uart_send_string("FAIL: Task left undone\n");
+      return -EIO;
+    }
+  }
+
+  if (tasks[1].start < tasks[0].end || tasks[4].start < tasks[1].end)
+  {
+    uart_send_string("FAIL: Dependency order\n");
+    return -EIO;
+  }
+
+  if (tasks[4].ran_on != cpus - 1 || tasks[4].result != EOK)
+  {
+    uart_send_string("FAIL: Pinned task\n");
+    return -EIO;
+  }
+
+  // Waiting for a later task could never finish
+  tasks[0].deps = 1U << 1;
+  if (init_run(tasks, 5, cpus) != -EINVARG)
+  {
+    uart_send_string("FAIL: Dependency on a later task accepted\n");
+    return -EIO;
+  }
+
+  tasks[0].deps = 0;
+  tasks[4].cpu = (int32_t)cpus;
+  if (init_run(tasks, 5, cpus) != -EINVARG)
+  {
+    uart_send_string("FAIL: Task pinned to an unused CPU accepted\n");
+    return -EIO;
+  }
+
+  uart_send_string("Boot initialisation tests passed\n");
+  return EOK;
+}
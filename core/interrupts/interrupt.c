@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 28 Mar 2025
- * Last Modified: 28 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "interrupt.h"
@@ -16,17 +16,104 @@
 #include <synapse/types.h>
 #include <synapse/status.h>
 
+#include <synapse/fdt/fdt.h>
 #include <synapse/task/task.h>
+#include <synapse/task/kthread.h>
+#include <synapse/timer/timer.h>
+#include <synapse/smp/smp.h>
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/rcu.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/scheduler/preempt.h>
 #include <synapse/memory/memory.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
 
-#define TIMER_IRQ 30
+// GIC bases
+uintptr_t gic_distributor_base = GIC_BASE_ADDRESS;
+uintptr_t gic_cpu_base = GIC_BASE_ADDRESS + 0x10000;
 
-// Interrupt handler table
+// Interrupt handler table, read under RCU by irq_handler()
 static INTERRUPT_HANDLER interrupt_handlers[MAX_INTERRUPT_HANDLERS] = { 0 };
 
 // Interrupt initialization status
 static bool interrupt_initialized = false;
 
+// IRQ statistics, per CPU so the handler never touches a shared line
+static DEFINE_PER_CPU_COUNTER(interrupt_irq_count);
+static DEFINE_PER_CPU_COUNTER(interrupt_spurious_count);
+static DEFINE_PER_CPU(percpu_counter_t, interrupt_counts[MAX_INTERRUPT_HANDLERS]);
+
+// CPUs each shared peripheral interrupt is routed to, as in GICD_ITARGETSR
+static uint8_t interrupt_affinity[MAX_INTERRUPT_HANDLERS];
+// Set by interrupt_set_affinity(), the balancer leaves those alone
+static bool interrupt_affinity_fixed[MAX_INTERRUPT_HANDLERS];
+// Set by interrupt_pin_affinity(), nothing moves those
+static bool interrupt_affinity_pinned[MAX_INTERRUPT_HANDLERS];
+static spinlock_t interrupt_affinity_lock = SPINLOCK_INIT;
+
+// Benchmark configuration
+#define INTERRUPT_BENCH_SPI (MAX_INTERRUPT_HANDLERS - 1)
+#define INTERRUPT_BENCH_ITERATIONS 100
+
+/**
+ * @brief Get the CPUs a shared peripheral interrupt may be routed to
+ * 
+ * @return uint32_t Bit i set for online CPU i
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t interrupt_online_mask()
+{
+  uint32_t cpus = smp_cpu_count();
+  if (cpus > GIC_MAX_TARGET_CPUS)
+  {
+    cpus = GIC_MAX_TARGET_CPUS;
+  }
+
+  return (1U << cpus) - 1;
+}
+
+/**
+ * @brief Route a shared peripheral interrupt, the caller holds
+ * interrupt_affinity_lock
+ * 
+ * @param interrupt_num Interrupt number, GIC_SPI_BASE or above
+ * @param cpu_mask Bit i set for CPU i
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void interrupt_route(uint32_t interrupt_num, uint32_t cpu_mask)
+{
+  interrupt_affinity[interrupt_num] = (uint8_t)cpu_mask;
+  GICD_ITARGETSR(interrupt_num) = (uint8_t)cpu_mask;
+}
+
+/**
+ * @brief Enable the GIC CPU interface of the calling CPU, its registers
+ * are banked per CPU. Secondary CPUs take IRQs from then on, CPU 0 waits
+ * for interrupt_enable_all()
+ * 
+ * @param arg Not used
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void interrupt_init_cpu(void* arg)
+{
+  GICC_CTLR = 0x0; // Diable CPU Interface
+  GICC_PMR = 0xFF; // No priority masking (lowest priority level)
+  GICC_BPR = 0x0; // Use all priority bits for group integrity
+  GICC_CTLR = 0x2; // Enable CPU Interface
+
+  if (smp_processor_id() != 0)
+  {
+    __asm__ volatile("msr daifclr, #2" ::: "memory");
+  }
+}
+
 /**
  * @brief Initialize interrupt subsystem for AArch64
  * 
@@ -46,10 +133,15 @@ int interrupt_init()
     return EOK;
   }
 
-  // Clear all handlers
+  // Clear all handlers, shared peripheral interrupts go to CPU 0 until moved
   memset(interrupt_handlers, 0, sizeof(interrupt_handlers));
+  memset(interrupt_affinity, 0x01, sizeof(interrupt_affinity));
+  memset(interrupt_affinity_fixed, 0, sizeof(interrupt_affinity_fixed));
 
   // Initialize GIC (Generic Interrupt Controller)
+  const fdt_platform_t* platform = fdt_get_platform();
+  gic_distributor_base = (uintptr_t)platform->gicd_base;
+  gic_cpu_base = (uintptr_t)platform->gicc_base;
 
   // 1: Initialize GIC Distributor (GICD)
   GICD_CTLR = 0x00; // Disable GIC Distributor
@@ -67,21 +159,13 @@ int interrupt_init()
     GICD_ICPENDR(i) = 0xFFFFFFFF;
   }
 
-  // Clean any pending interrupts
-  for (int i = 0; i < MAX_INTERRUPT_HANDLERS/32; i++)
-  {
-    GICD_ISPENDR(i) = 0xFFFFFFFF;
-  }
-
-  GICD_ISENABLER(0) |= (1 << 30); // IRQ 30 is a PPI → bit 30 in register 0
+  // The timer PPI lives in register 0
+  GICD_ISENABLER(0) |= (1 << timer_get_irq());
 
   GICD_CTLR = 0x2; // Enable GIC Distributor
 
-  // 2: Initialize GIC CPU Interface (GICC)
-  GICC_CTLR = 0x0; // Diable CPU Interface
-  GICC_PMR = 0xFF; // No priority masking (lowest priority level)
-  GICC_BPR = 0x0; // Use all priority bits for group integrity
-  GICC_CTLR = 0x2; // Enable CPU Interface
+  // 2: Initialize GIC CPU Interface (GICC) of every CPU
+  smp_run(smp_cpu_count(), interrupt_init_cpu, NULL);
 
   // 3: Set up exception vector table
   // This is done in vector.S and loaded during boot
@@ -113,19 +197,18 @@ int interrupt_register_handler(uint32_t interrupt_num, INTERRUPT_HANDLER handler
     return -EINVARG;
   }
 
-  if (interrupt_handlers[interrupt_num] != NULL)
+  // Register handler, publishing it only if the slot is still empty
+  if (atomic_cas_64((volatile uint64_t*)&interrupt_handlers[interrupt_num], 0, (uint64_t)(uintptr_t)handler) != 0)
   {
     return -EINUSE; // Handler already registered
   }
 
-  // Register handler
-  interrupt_handlers[interrupt_num] = handler;
-
   return EOK;
 }
 
 /**
- * @brief Unregister an interrupt handler
+ * @brief Unregister an interrupt handler, on return it no longer runs
+ * on any CPU (unless called from the handler itself)
  * 
  * @param interrupt_num Interrupt number to unregister
  * @return int EOK on success, negative error code on failure
@@ -146,7 +229,14 @@ int interrupt_unregister_handler(uint32_t interrupt_num)
   }
 
   // Unregister handler
-  interrupt_handlers[interrupt_num] = NULL;
+  rcu_assign_pointer(interrupt_handlers[interrupt_num], NULL);
+
+  // Once every CPU has left irq_handler() the old handler no longer runs,
+  // a handler unregistering itself cannot wait for itself
+  if (!rcu_read_lock_held())
+  {
+    synchronize_rcu();
+  }
 
   return EOK;
 }
@@ -176,6 +266,13 @@ int interrupt_enable(uint32_t interrupt_num)
   uint32_t reg_idx = interrupt_num / 32;
   uint32_t bit_offset = interrupt_num % 32;
 
+  // Shared peripheral interrupts are only delivered once routed to a CPU
+  if (interrupt_num >= GIC_SPI_BASE)
+  {
+    GICD_IPRIORITYR(interrupt_num) = GIC_SPI_PRIORITY;
+    GICD_ITARGETSR(interrupt_num) = interrupt_affinity[interrupt_num];
+  }
+
   GICD_ISENABLER(reg_idx) = (1 << bit_offset);
 
   return EOK;
@@ -255,6 +352,518 @@ int interrupt_disable_all()
   return EOK;
 }
 
+/**
+ * @brief Mask IRQs on the current CPU and return the previous mask state
+ * 
+ * @return uint64_t Saved DAIF value for interrupt_local_restore()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t interrupt_local_save()
+{
+  uint64_t flags;
+  __asm__ volatile("mrs %0, daif" : "=r" (flags));
+  __asm__ volatile("msr daifset, #2" ::: "memory");
+
+  return flags;
+}
+
+/**
+ * @brief Restore the IRQ mask state saved by interrupt_local_save()
+ * 
+ * @param flags Saved DAIF value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void interrupt_local_restore(uint64_t flags)
+{
+  __asm__ volatile("msr daif, %0" :: "r" (flags) : "memory");
+}
+
+/**
+ * @brief Check if IRQs are masked on the current CPU
+ * 
+ * @return true If IRQs are masked
+ * @return false If IRQs are taken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool interrupt_local_masked()
+{
+  uint64_t flags;
+  __asm__ volatile("mrs %0, daif" : "=r" (flags));
+
+  return (flags & (1 << 7)) != 0; // DAIF.I
+}
+
+/**
+ * @brief Send a software generated interrupt to the current CPU
+ * 
+ * @param sgi_id SGI ID, below GIC_SGI_COUNT
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int interrupt_send_sgi_self(uint32_t sgi_id)
+{
+  if (!interrupt_initialized)
+  {
+    return -ENOTREADY;
+  }
+
+  if (sgi_id >= GIC_SGI_COUNT)
+  {
+    return -EINVARG;
+  }
+
+  // Everything written before is visible to the handler
+  __asm__ volatile("dsb sy" ::: "memory");
+  GICD_SGIR = GIC_SGI_TARGET_SELF | sgi_id;
+
+  return EOK;
+}
+
+/**
+ * @brief Get the number of IRQs taken, summed over every CPU
+ * 
+ * @return uint64_t IRQs taken, spurious ones included
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t interrupt_get_irq_count()
+{
+  return percpu_counter_sum(&interrupt_irq_count);
+}
+
+/**
+ * @brief Get the number of spurious IRQs, summed over every CPU
+ * 
+ * @return uint64_t IRQs the GIC acknowledged with a special ID
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t interrupt_get_spurious_count()
+{
+  return percpu_counter_sum(&interrupt_spurious_count);
+}
+
+/**
+ * @brief Get the number of times an interrupt was taken
+ * 
+ * @param interrupt_num Interrupt number
+ * @param cpu CPU index, SMP_MAX_CPUS for the sum over every CPU
+ * @return uint64_t Times taken, 0 on a bad argument
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t interrupt_get_count(uint32_t interrupt_num, uint32_t cpu)
+{
+  if (interrupt_num >= MAX_INTERRUPT_HANDLERS)
+  {
+    return 0;
+  }
+
+  if (cpu == SMP_MAX_CPUS)
+  {
+    return percpu_counter_sum(&interrupt_counts[interrupt_num]);
+  }
+
+  if (cpu >= smp_cpu_count())
+  {
+    return 0;
+  }
+
+  return atomic_load_acquire_64(per_cpu_ptr(&interrupt_counts[interrupt_num], cpu));
+}
+
+/**
+ * @brief Route a shared peripheral interrupt to a set of CPUs, the
+ * balancer leaves it there afterwards
+ * 
+ * @param interrupt_num Interrupt number, GIC_SPI_BASE or above
+ * @param cpu_mask Bit i set for CPU i, online CPUs only
+ * @return int EOK on success, -EINVARG on a bad argument, -EINUSE if the
+ * interrupt is pinned, -ENOTREADY before interrupt_init()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int interrupt_set_affinity(uint32_t interrupt_num, uint32_t cpu_mask)
+{
+  if (!interrupt_initialized)
+  {
+    return -ENOTREADY;
+  }
+
+  // SGIs and PPIs are banked, each CPU has its own
+  if (interrupt_num < GIC_SPI_BASE || interrupt_num >= MAX_INTERRUPT_HANDLERS ||
+      cpu_mask == 0 || (cpu_mask & ~interrupt_online_mask()) != 0)
+  {
+    return -EINVARG;
+  }
+
+  int res = EOK;
+  uint64_t flags = spin_lock_irqsave(&interrupt_affinity_lock);
+
+  // Reachable from EL0, a pinned interrupt must stay where its driver waits
+  if (interrupt_affinity_pinned[interrupt_num])
+  {
+    res = -EINUSE;
+  }
+  else
+  {
+    interrupt_route(interrupt_num, cpu_mask);
+    interrupt_affinity_fixed[interrupt_num] = true;
+  }
+
+  spin_unlock_irqrestore(&interrupt_affinity_lock, flags);
+
+  return res;
+}
+
+/**
+ * @brief Route a shared peripheral interrupt to one CPU for good, for
+ * drivers that wait for it on that CPU. Neither the balancer nor
+ * interrupt_set_affinity() move it afterwards
+ * 
+ * @param interrupt_num Interrupt number, GIC_SPI_BASE or above
+ * @param cpu Online CPU
+ * @return int EOK on success, -EINVARG on a bad argument, -EINUSE if the
+ * interrupt is already pinned, -ENOTREADY before interrupt_init()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int interrupt_pin_affinity(uint32_t interrupt_num, uint32_t cpu)
+{
+  if (!interrupt_initialized)
+  {
+    return -ENOTREADY;
+  }
+
+  if (interrupt_num < GIC_SPI_BASE || interrupt_num >= MAX_INTERRUPT_HANDLERS ||
+      cpu >= GIC_MAX_TARGET_CPUS || !(interrupt_online_mask() & (1U << cpu)))
+  {
+    return -EINVARG;
+  }
+
+  int res = EOK;
+  uint64_t flags = spin_lock_irqsave(&interrupt_affinity_lock);
+
+  if (interrupt_affinity_pinned[interrupt_num])
+  {
+    res = -EINUSE;
+  }
+  else
+  {
+    interrupt_route(interrupt_num, 1U << cpu);
+    interrupt_affinity_fixed[interrupt_num] = true;
+    interrupt_affinity_pinned[interrupt_num] = true;
+  }
+
+  spin_unlock_irqrestore(&interrupt_affinity_lock, flags);
+
+  return res;
+}
+
+/**
+ * @brief Get the CPUs a shared peripheral interrupt is routed to
+ * 
+ * @param interrupt_num Interrupt number, GIC_SPI_BASE or above
+ * @return uint32_t Bit i set for CPU i, 0 on a bad argument
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t interrupt_get_affinity(uint32_t interrupt_num)
+{
+  if (!interrupt_initialized || interrupt_num < GIC_SPI_BASE || interrupt_num >= MAX_INTERRUPT_HANDLERS)
+  {
+    return 0;
+  }
+
+  return interrupt_affinity[interrupt_num];
+}
+
+/**
+ * @brief Spread the device interrupts whose affinity was never set over
+ * the CPUs running no real-time thread, busiest interrupt first
+ * 
+ * @return int Interrupts moved, -ENOTREADY before interrupt_init()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int interrupt_balance()
+{
+  if (!interrupt_initialized)
+  {
+    return -ENOTREADY;
+  }
+
+  // With every CPU real-time there is nowhere better to go
+  uint32_t online = interrupt_online_mask();
+  uint32_t allowed = online & ~kthread_rt_cpu_mask();
+  if (allowed == 0)
+  {
+    allowed = online;
+  }
+
+  uint64_t load[GIC_MAX_TARGET_CPUS] = {0};
+  bool placed[MAX_INTERRUPT_HANDLERS] = {false};
+  int moved = 0;
+
+  // Sum the per-CPU counters once, outside the lock
+  uint64_t counts[MAX_INTERRUPT_HANDLERS] = {0};
+  for (uint32_t irq = GIC_SPI_BASE; irq < MAX_INTERRUPT_HANDLERS; irq++)
+  {
+    counts[irq] = interrupt_get_count(irq, SMP_MAX_CPUS) + 1;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&interrupt_affinity_lock);
+
+  // Interrupts routed by hand load their CPUs first
+  for (uint32_t irq = GIC_SPI_BASE; irq < MAX_INTERRUPT_HANDLERS; irq++)
+  {
+    if (interrupt_handlers[irq] == NULL || interrupt_affinity_fixed[irq])
+    {
+      placed[irq] = true;
+      if (interrupt_handlers[irq] == NULL)
+      {
+        continue;
+      }
+
+      for (uint32_t cpu = 0; cpu < GIC_MAX_TARGET_CPUS; cpu++)
+      {
+        if (interrupt_affinity[irq] & (1U << cpu))
+        {
+          load[cpu] += counts[irq];
+        }
+      }
+    }
+  }
+
+  // Busiest interrupt since boot to the least loaded allowed CPU. Idle
+  // ones weigh one so they spread too
+  while (1)
+  {
+    uint32_t busiest = MAX_INTERRUPT_HANDLERS;
+    uint64_t busiest_count = 0;
+    for (uint32_t irq = GIC_SPI_BASE; irq < MAX_INTERRUPT_HANDLERS; irq++)
+    {
+      if (!placed[irq] && counts[irq] > busiest_count)
+      {
+        busiest = irq;
+        busiest_count = counts[irq];
+      }
+    }
+
+    if (busiest == MAX_INTERRUPT_HANDLERS)
+    {
+      break;
+    }
+
+    uint32_t target = GIC_MAX_TARGET_CPUS;
+    for (uint32_t cpu = 0; cpu < GIC_MAX_TARGET_CPUS; cpu++)
+    {
+      if ((allowed & (1U << cpu)) && (target == GIC_MAX_TARGET_CPUS || load[cpu] < load[target]))
+      {
+        target = cpu;
+      }
+    }
+
+    load[target] += busiest_count;
+    placed[busiest] = true;
+
+    if (interrupt_affinity[busiest] != (1U << target))
+    {
+      interrupt_route(busiest, 1U << target);
+      moved++;
+    }
+  }
+
+  spin_unlock_irqrestore(&interrupt_affinity_lock, flags);
+
+  return moved;
+}
+
+/**
+ * @brief Print the routing and the per-CPU count of every interrupt taken
+ * or handled
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void interrupt_print_stats()
+{
+  uart_send_string("\nInterrupt statistics:\n");
+  uart_send_string("  IRQs taken: ");
+  uart_send_string(uint_to_str(interrupt_get_irq_count()));
+  uart_send_string(", spurious: ");
+  uart_send_string(uint_to_str(interrupt_get_spurious_count()));
+  uart_send_string("\n");
+
+  for (uint32_t irq = 0; irq < MAX_INTERRUPT_HANDLERS; irq++)
+  {
+    if (interrupt_handlers[irq] == NULL && interrupt_get_count(irq, SMP_MAX_CPUS) == 0)
+    {
+      continue;
+    }
+
+    uart_send_string("  IRQ ");
+    uart_send_string(uint_to_str(irq));
+    if (irq < GIC_SPI_BASE)
+    {
+      uart_send_string(" (per CPU):");
+    }
+    else
+    {
+      uart_send_string(interrupt_affinity_pinned[irq] ? " (pinned, CPUs" :
+                       interrupt_affinity_fixed[irq] ? " (fixed, CPUs" : " (CPUs");
+      for (uint32_t cpu = 0; cpu < GIC_MAX_TARGET_CPUS; cpu++)
+      {
+        if (interrupt_affinity[irq] & (1U << cpu))
+        {
+          uart_send_string(" ");
+          uart_send_string(uint_to_str(cpu));
+        }
+      }
+      uart_send_string("):");
+    }
+
+    for (uint32_t cpu = 0; cpu < smp_cpu_count(); cpu++)
+    {
+      uart_send_string(" ");
+      uart_send_string(uint_to_str(interrupt_get_count(irq, cpu)));
+    }
+    uart_send_string("\n");
+  }
+}
+
+/**
+ * @brief Handler of the benchmark interrupt, counting is done by
+ * irq_handler()
+ * 
+ * @param int_frame Interrupt frame
+ * @return int EOK
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int interrupt_bench_handler(struct interrupt_frame* int_frame)
+{
+  return EOK;
+}
+
+/**
+ * @brief Time the delivery of a shared peripheral interrupt routed to
+ * each CPU in turn
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int interrupt_affinity_benchmark()
+{
+  const uint32_t irq = INTERRUPT_BENCH_SPI;
+  uint64_t frequency = timer_read_frequency();
+  int res = EOK;
+
+  uart_send_string("\n=== Interrupt Affinity Benchmark ===\n");
+
+  res = interrupt_register_handler(irq, interrupt_bench_handler);
+  if (res != EOK)
+  {
+    uart_send_string("  IRQ ");
+    uart_send_string(uint_to_str(irq));
+    uart_send_string(" in use, skipped\n");
+    return res == -EINUSE ? EOK : res;
+  }
+
+  // Edge-triggered so each write to GICD_ISPENDR is one interrupt
+  uint32_t cfg_shift = (irq % 16) * 2;
+  uint32_t cfg = GICD_ICFGR(irq / 16);
+  GICD_ICFGR(irq / 16) = cfg | (2U << cfg_shift);
+
+  uint64_t flags = spin_lock_irqsave(&interrupt_affinity_lock);
+  uint32_t saved_mask = interrupt_affinity[irq];
+  spin_unlock_irqrestore(&interrupt_affinity_lock, flags);
+
+  interrupt_enable(irq);
+
+  for (uint32_t cpu = 0; cpu < smp_cpu_count() && cpu < GIC_MAX_TARGET_CPUS; cpu++)
+  {
+    uart_send_string("  CPU ");
+    uart_send_string(uint_to_str(cpu));
+
+    // The calling CPU only takes it with IRQs unmasked
+    if (cpu == smp_processor_id() && interrupt_local_masked())
+    {
+      uart_send_string(": skipped, IRQs masked\n");
+      continue;
+    }
+
+    flags = spin_lock_irqsave(&interrupt_affinity_lock);
+    interrupt_route(irq, 1U << cpu);
+    spin_unlock_irqrestore(&interrupt_affinity_lock, flags);
+
+    uint64_t total_ticks = 0;
+    uint32_t delivered = 0;
+    for (uint32_t i = 0; i < INTERRUPT_BENCH_ITERATIONS; i++)
+    {
+      uint64_t before = interrupt_get_count(irq, cpu);
+      uint64_t start = timer_read_counter();
+      GICD_ISPENDR(irq / 32) = 1U << (irq % 32);
+
+      // Give up on a lost interrupt after 10ms
+      uint64_t now = start;
+      while (interrupt_get_count(irq, cpu) == before && now - start < frequency / 100)
+      {
+        cpu_relax();
+        now = timer_read_counter();
+      }
+
+      if (interrupt_get_count(irq, cpu) != before)
+      {
+        total_ticks += now - start;
+        delivered++;
+      }
+    }
+
+    uart_send_string(": ");
+    uart_send_string(uint_to_str(delivered));
+    uart_send_string("/");
+    uart_send_string(uint_to_str(INTERRUPT_BENCH_ITERATIONS));
+    uart_send_string(" delivered, ");
+    uart_send_string(uint_to_str(delivered ? (total_ticks * 1000000000ULL) / frequency / delivered : 0));
+    uart_send_string(" ns each\n");
+
+    if (delivered != INTERRUPT_BENCH_ITERATIONS)
+    {
+      res = -EIO;
+    }
+  }
+
+  interrupt_disable(irq);
+  GICD_ICFGR(irq / 16) = cfg;
+
+  flags = spin_lock_irqsave(&interrupt_affinity_lock);
+  interrupt_route(irq, saved_mask);
+  spin_unlock_irqrestore(&interrupt_affinity_lock, flags);
+
+  interrupt_unregister_handler(irq);
+
+  return res;
+}
+
 /**
  * @brief Main IRQ handler called from exception vector
  * 
@@ -273,25 +882,46 @@ int irq_handler(struct interrupt_frame* int_frame)
 
   uart_send_string(">> irq_handler() was called!\n");
 
+  // Read sections mask IRQs, the interrupted code is outside any. An
+  // idle secondary CPU is woken out of idle for the handler
+  rcu_irq_enter();
+  rcu_quiescent_state();
+
   // Ready interrupt ID from GIC CPU Interface
   uint32_t iar = GICC_IAR;
   uint32_t interrupt_id = iar & 0x3FF; // Interrupt ID is in the low 10 bits
+  percpu_counter_inc(&interrupt_irq_count);
 
   // Special IDs (1020, 1021, 1023) are not actual interrupts
   if (interrupt_id >= 1020)
   {
+    percpu_counter_inc(&interrupt_spurious_count);
+    rcu_irq_exit();
     return EOK;
   }
 
+  // Signal End of Interrupt to GIC before the handler, the task switch
+  // on IRQ exit does not return. IRQs stay masked until the eret
+  GICC_EOIR = iar;
+
   // Call registered handler
   int res = EOK;
-  if (interrupt_handlers[interrupt_id] != NULL)
+  if (interrupt_id < MAX_INTERRUPT_HANDLERS)
   {
-    res = interrupt_handlers[interrupt_id](int_frame);
+    percpu_counter_inc(&interrupt_counts[interrupt_id]);
+
+    rcu_read_lock();
+    INTERRUPT_HANDLER handler = rcu_dereference(interrupt_handlers[interrupt_id]);
+    if (handler != NULL)
+    {
+      res = handler(int_frame);
+    }
+    rcu_read_unlock();
   }
+  rcu_irq_exit();
 
-  // Signal End of Interrupt to GIC
-  GICC_EOIR = iar;
+  // Switch tasks if the scheduler asked for it, does not return then
+  preempt_irq_exit(int_frame);
 
   return res;
 }
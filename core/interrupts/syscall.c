@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 8 Apr 2025
- * Last Modified: 9 Apr 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "syscall.h"
@@ -15,17 +15,24 @@
 #include <synapse/status.h>
 
 #include <synapse/task/task.h>
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/rcu.h>
 #include <synapse/memory/memory.h>
 #include <synapse/interrupts/svc.h>
+#include <synapse/fs/initramfs.h>
 #include <synapse/process/process.h>
 #include <synapse/interrupts/interrupt.h>
+#include <synapse/memory/pressure/pressure.h>
 
 // System call handler 
 typedef int (*SYSCALL_HANDLER)(long arg1, long arg2, long arg3, long arg4);
 
-// System call table
+// System call table, read under RCU by syscall_handler()
 static SYSCALL_HANDLER syscall_table[SYSCALL_MAX] = {0};
 
+// Calls dispatched per system call number, per CPU
+static DEFINE_PER_CPU(percpu_counter_t, syscall_counts[SYSCALL_MAX]);
+
 /**
  * @brief Handler process exit system call
  * 
@@ -176,6 +183,188 @@ static int syscall_internal_print_string(long str, long arg2, long arg3, long ar
   return EOK;
 }
 
+/**
+ * @brief Handle memory pressure subscription syscall
+ * 
+ * @param arg1 Not used
+ * @param arg2 Not used
+ * @param arg3 Not used
+ * @param arg4 Not used
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int syscall_memory_pressure_subscribe_handler(long arg1, long arg2, long arg3, long arg4)
+{
+  struct process* current = process_current();
+  if (current == NULL)
+  {
+    return -EINVARG;
+  }
+
+  return memory_pressure_subscribe(current->id);
+}
+
+/**
+ * @brief Handle memory pressure poll syscall
+ * 
+ * @param arg1 Not used
+ * @param arg2 Not used
+ * @param arg3 Not used
+ * @param arg4 Not used
+ * @return int Highest pressure level since the last poll, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int syscall_memory_pressure_poll_handler(long arg1, long arg2, long arg3, long arg4)
+{
+  struct process* current = process_current();
+  if (current == NULL)
+  {
+    return -EINVARG;
+  }
+
+  return memory_pressure_poll(current->id);
+}
+
+/**
+ * @brief Handle open file syscall
+ * 
+ * @param path Path of the file
+ * @param arg2 Not used
+ * @param arg3 Not used
+ * @param arg4 Not used
+ * @return int File descriptor, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int syscall_file_open_handler(long path, long arg2, long arg3, long arg4)
+{
+  struct process* current = process_current();
+  if (current == NULL || path == 0)
+  {
+    return -EINVARG;
+  }
+
+  return initramfs_open(initramfs_get_root(), current->id, (const char*)path);
+}
+
+/**
+ * @brief Handle read file syscall
+ * 
+ * @param fd File descriptor
+ * @param buffer Destination
+ * @param size Bytes to read
+ * @param arg4 Not used
+ * @return int Bytes read, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int syscall_file_read_handler(long fd, long buffer, long size, long arg4)
+{
+  struct process* current = process_current();
+  if (current == NULL || buffer == 0 || size < 0)
+  {
+    return -EINVARG;
+  }
+
+  return initramfs_read(initramfs_get_root(), current->id, (int)fd, (void*)buffer, (size_t)size);
+}
+
+/**
+ * @brief Handle file information syscall
+ * 
+ * @param path Path of the file
+ * @param stat Output for the information
+ * @param arg3 Not used
+ * @param arg4 Not used
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int syscall_file_stat_handler(long path, long stat, long arg3, long arg4)
+{
+  if (path == 0 || stat == 0)
+  {
+    return -EINVARG;
+  }
+
+  return initramfs_stat(initramfs_get_root(), (const char*)path, (initramfs_stat_t*)stat);
+}
+
+/**
+ * @brief Handle map file syscall
+ * 
+ * @param fd File descriptor
+ * @param addr Output for the contents
+ * @param arg3 Not used
+ * @param arg4 Not used
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int syscall_file_mmap_handler(long fd, long addr, long arg3, long arg4)
+{
+  struct process* current = process_current();
+  if (current == NULL || addr == 0)
+  {
+    return -EINVARG;
+  }
+
+  return initramfs_mmap(initramfs_get_root(), current->id, (int)fd, (const void**)addr);
+}
+
+/**
+ * @brief Handle close file syscall
+ * 
+ * @param fd File descriptor
+ * @param arg2 Not used
+ * @param arg3 Not used
+ * @param arg4 Not used
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int syscall_file_close_handler(long fd, long arg2, long arg3, long arg4)
+{
+  struct process* current = process_current();
+  if (current == NULL)
+  {
+    return -EINVARG;
+  }
+
+  return initramfs_close(initramfs_get_root(), current->id, (int)fd);
+}
+
+/**
+ * @brief Handle the IRQ affinity system call
+ * 
+ * @param irq Shared peripheral interrupt number
+ * @param cpu_mask Bit i set for CPU i
+ * @param arg3 Not used
+ * @param arg4 Not used
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int syscall_irq_set_affinity_handler(long irq, long cpu_mask, long arg3, long arg4)
+{
+  if (irq < 0 || cpu_mask <= 0 || cpu_mask > 0xFFFFFFFFL)
+  {
+    return -EINVARG;
+  }
+
+  return interrupt_set_affinity((uint32_t)irq, (uint32_t)cpu_mask);
+}
+
 /**
  * @brief Initialize system call interface
  * 
@@ -187,12 +376,20 @@ static int syscall_internal_print_string(long str, long arg2, long arg3, long ar
 int syscall_init()
 {
   // Register system call handlers
-  syscall_table[SYSCALL_PROCESS_EXIT] = syscall_process_exit;
-  syscall_table[SYSCALL_PROCESS_MALLOC] = syscall_process_malloc;
-  syscall_table[SYSCALL_PROCESS_FREE] = syscall_process_free;
-  syscall_table[SYSCALL_PROCESS_GET_ARGS] = syscall_process_get_args;
-  syscall_table[SYSCALL_PRINT_CHAR] = syscall_internal_print_char;
-  syscall_table[SYSCALL_PRINT_STRING] = syscall_internal_print_string;
+  rcu_assign_pointer(syscall_table[SYSCALL_PROCESS_EXIT], syscall_process_exit);
+  rcu_assign_pointer(syscall_table[SYSCALL_PROCESS_MALLOC], syscall_process_malloc);
+  rcu_assign_pointer(syscall_table[SYSCALL_PROCESS_FREE], syscall_process_free);
+  rcu_assign_pointer(syscall_table[SYSCALL_PROCESS_GET_ARGS], syscall_process_get_args);
+  rcu_assign_pointer(syscall_table[SYSCALL_PRINT_CHAR], syscall_internal_print_char);
+  rcu_assign_pointer(syscall_table[SYSCALL_PRINT_STRING], syscall_internal_print_string);
+  rcu_assign_pointer(syscall_table[SYSCALL_MEMORY_PRESSURE_SUBSCRIBE], syscall_memory_pressure_subscribe_handler);
+  rcu_assign_pointer(syscall_table[SYSCALL_MEMORY_PRESSURE_POLL], syscall_memory_pressure_poll_handler);
+  rcu_assign_pointer(syscall_table[SYSCALL_FILE_OPEN], syscall_file_open_handler);
+  rcu_assign_pointer(syscall_table[SYSCALL_FILE_READ], syscall_file_read_handler);
+  rcu_assign_pointer(syscall_table[SYSCALL_FILE_STAT], syscall_file_stat_handler);
+  rcu_assign_pointer(syscall_table[SYSCALL_FILE_MMAP], syscall_file_mmap_handler);
+  rcu_assign_pointer(syscall_table[SYSCALL_FILE_CLOSE], syscall_file_close_handler);
+  rcu_assign_pointer(syscall_table[SYSCALL_IRQ_SET_AFFINITY], syscall_irq_set_affinity_handler);
 
   // SVC handler is setup in vector.S
   return svc_init(syscall_handler);
@@ -214,13 +411,50 @@ int syscall_init()
 int syscall_handler(int syscall_num, long arg1, long arg2, long arg3, long arg4)
 {
   // Validate system call number
-  if (syscall_num < 0 || syscall_num >= SYSCALL_MAX || syscall_table[syscall_num] == NULL)
+  if (syscall_num < 0 || syscall_num >= SYSCALL_MAX)
   {
     return -EINVSYSCALL;
   }
 
+  // Handlers are kernel code, only the lookup needs the read section
+  rcu_read_lock();
+  SYSCALL_HANDLER handler = rcu_dereference(syscall_table[syscall_num]);
+  rcu_read_unlock();
+
+  if (handler == NULL)
+  {
+    return -EINVSYSCALL;
+  }
+
+  percpu_counter_inc(&syscall_counts[syscall_num]);
+
   // Dispatch to handler
-  return syscall_table[syscall_num](arg1, arg2, arg3, arg4);
+  return handler(arg1, arg2, arg3, arg4);
+}
+
+/**
+ * @brief Get the number of system calls dispatched, summed over every CPU
+ * 
+ * @param syscall_num System call number, or SYSCALL_MAX for all of them
+ * @return uint64_t System calls dispatched
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t syscall_get_count(int syscall_num)
+{
+  if (syscall_num >= 0 && syscall_num < SYSCALL_MAX)
+  {
+    return percpu_counter_sum(&syscall_counts[syscall_num]);
+  }
+
+  uint64_t total = 0;
+  for (int i = 0; i < SYSCALL_MAX; i++)
+  {
+    total += percpu_counter_sum(&syscall_counts[i]);
+  }
+
+  return total;
 }
 
 /**
@@ -343,3 +577,120 @@ int syscall_print_string(const char* str)
 {
   return syscall(SYSCALL_PRINT_STRING, (uint64_t)str, 0, 0, 0);
 }
+
+/**
+ * @brief Memory pressure subscription system call wrapper
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_memory_pressure_subscribe()
+{
+  return syscall(SYSCALL_MEMORY_PRESSURE_SUBSCRIBE, 0, 0, 0, 0);
+}
+
+/**
+ * @brief Memory pressure poll system call wrapper
+ * 
+ * @return int Highest pressure level since the last poll (MEMORY_PRESSURE_*),
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_memory_pressure_poll()
+{
+  return syscall(SYSCALL_MEMORY_PRESSURE_POLL, 0, 0, 0, 0);
+}
+
+/**
+ * @brief Open file system call wrapper
+ * 
+ * @param path Path of the file
+ * @return int File descriptor, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_open(const char* path)
+{
+  return syscall(SYSCALL_FILE_OPEN, (uint64_t)path, 0, 0, 0);
+}
+
+/**
+ * @brief Read file system call wrapper
+ * 
+ * @param fd File descriptor
+ * @param buffer Destination
+ * @param size Bytes to read
+ * @return int Bytes read, 0 at the end of the file, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_read(int fd, void* buffer, size_t size)
+{
+  return syscall(SYSCALL_FILE_READ, fd, (uint64_t)buffer, size, 0);
+}
+
+/**
+ * @brief File information system call wrapper
+ * 
+ * @param path Path of the file
+ * @param stat Output for the information
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_stat(const char* path, initramfs_stat_t* stat)
+{
+  return syscall(SYSCALL_FILE_STAT, (uint64_t)path, (uint64_t)stat, 0, 0);
+}
+
+/**
+ * @brief Map file system call wrapper, the contents are not copied
+ * 
+ * @param fd File descriptor
+ * @param addr Output for the contents, valid until the file is closed
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_mmap(int fd, const void** addr)
+{
+  return syscall(SYSCALL_FILE_MMAP, fd, (uint64_t)addr, 0, 0);
+}
+
+/**
+ * @brief Close file system call wrapper
+ * 
+ * @param fd File descriptor
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_close(int fd)
+{
+  return syscall(SYSCALL_FILE_CLOSE, fd, 0, 0, 0);
+}
+
+/**
+ * @brief IRQ affinity system call wrapper
+ * 
+ * @param irq Shared peripheral interrupt number
+ * @param cpu_mask Bit i set for CPU i
+ * @return int EOK on success, -EINUSE if a driver pinned the interrupt,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_irq_set_affinity(uint32_t irq, uint32_t cpu_mask)
+{
+  return syscall(SYSCALL_IRQ_SET_AFFINITY, irq, cpu_mask, 0, 0);
+}
@@ -6,15 +6,42 @@
  * 
  * Author: Fedi Nabli
  * Date: 26 Feb 2025
- * Last Modified: 17 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include <uart.h>
 #include <boot_info.h>
 
+#include <synapse/status.h>
+
+#include <synapse/fdt/fdt.h>
+#include <synapse/fs/initramfs.h>
+#include <synapse/init/init.h>
+#include <synapse/semihost/semihost.h>
+#include <synapse/smp/smp.h>
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/queue.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/lib/rbtree.h>
+#include <synapse/lib/hashtable.h>
+#include <synapse/task/kthread.h>
+#include <synapse/scheduler/preempt.h>
 #include <synapse/process/process.h>
+#include <synapse/ai/stream.h>
+#include <synapse/ai/pipeline.h>
+#include <synapse/ai/detect.h>
+#include <synapse/ai/rnn.h>
+#include <synapse/math/fastmath.h>
+#include <synapse/virtio/virtio.h>
+#include <synapse/virtio/virtio_blk.h>
+#include <synapse/virtio/virtio_console.h>
 #include <synapse/interrupts/syscall.h>
+#include <synapse/interrupts/interrupt.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/memory/zero_pool/zero_pool.h>
 #include <synapse/memory/memory_system.h>
+#include <synapse/selftest/selftest.h>
+#include <synapse/string/string.h>
 
 // Define the kernel start and end symbols from the linker
 extern char _start[];
@@ -24,37 +51,89 @@ extern char _end[];
 void kernel_process_test();
 void user_process_test();
 
-static void uint_to_str(uint64_t value, char* buf, size_t size)
+// Boot steps run in parallel, the heap table is cleared by this many CPUs
+#define BOOT_HEAP_TABLE_PARTS 4
+
+/* Boot task indexes, a task only depends on earlier ones */
+#define BOOT_TASK_HEAP_TABLE  0 // BOOT_HEAP_TABLE_PARTS tasks
+#define BOOT_TASK_HEAP        (BOOT_TASK_HEAP_TABLE + BOOT_HEAP_TABLE_PARTS)
+#define BOOT_TASK_INITRAMFS   (BOOT_TASK_HEAP + 1)
+#define BOOT_TASK_AI_POOL     (BOOT_TASK_INITRAMFS + 1)
+#define BOOT_TASK_MODEL_CHECK (BOOT_TASK_AI_POOL + 1)
+#define BOOT_TASK_VIRTIO      (BOOT_TASK_MODEL_CHECK + 1)
+#define BOOT_TASK_COUNT       (BOOT_TASK_VIRTIO + 1)
+
+// Memory layout shared by the boot tasks
+typedef struct
+{
+  size_t ram_size;
+  uintptr_t kernel_start;
+  uintptr_t kernel_end;
+} boot_layout_t;
+
+static boot_layout_t boot_layout;
+static init_task_t boot_tasks[BOOT_TASK_COUNT];
+
+// Clear one part of the kernel heap table
+static int boot_heap_table(void* arg)
 {
-  if (!buf || size == 0)
+  kheap_clear_table((uint32_t)(uintptr_t)arg, BOOT_HEAP_TABLE_PARTS);
+  return EOK;
+}
+
+// Claim the reserved memory once the whole table is clear
+static int boot_heap(void* arg)
+{
+  boot_layout_t* layout = (boot_layout_t*)arg;
+  return memory_system_claim_reserved(layout->kernel_start, layout->kernel_end);
+}
+
+// The root filesystem is optional, QEMU only passes one with -initrd
+static int boot_initramfs(void* arg)
+{
+  int res = initramfs_init();
+  if (res == -ENOENT)
   {
-    return;
+    return EOK;
   }
-  
-  // Handle zero case
-  if (value == 0)
+
+  if (res < 0)
   {
-    buf[0] = '0';
-    buf[1] = '\0';
-    return;
+    uart_send_string("Initramfs mount failed!\n");
   }
-  
-  // Convert digits
-  size_t i = 0;
-  while (value > 0 && i < size - 1)
+
+  return res;
+}
+
+// Fill the AI pool
+static int boot_ai_pool(void* arg)
+{
+  boot_layout_t* layout = (boot_layout_t*)arg;
+  return memory_system_init_ai(layout->ram_size);
+}
+
+// Check the model images of the root filesystem before anything loads them
+static int boot_model_check(void* arg)
+{
+  initramfs_t* root = initramfs_get_root();
+  if (!root)
   {
-    buf[i++] = '0' + (value % 10);
-    value /= 10;
+    return EOK;
   }
-  buf[i] = '\0';
-  
-  // Reverse the string
-  for (size_t j = 0; j < i / 2; j++)
+
+  int res = initramfs_verify(root);
+  if (res < 0)
   {
-    char temp = buf[j];
-    buf[j] = buf[i - j - 1];
-    buf[i - j - 1] = temp;
+    uart_send_string("Initramfs checksum failed!\n");
   }
+
+  return res;
+}
+
+// List the virtio devices, drivers bind to them once interrupts are up
+static int boot_virtio_probe(void* arg)
+{
+  return virtio_mmio_init();
 }
 
 void kernel_main(boot_info_t* boot_info)
@@ -65,14 +144,19 @@ void kernel_main(boot_info_t* boot_info)
   // Send confirmation message
   uart_send_string("Kernel started successfully!\n");
 
+  // Per-CPU copies before anything counts into them
+  if (percpu_init() < 0)
+  {
+    uart_send_string("Per-CPU initialization failed!\n");
+    while (1) {} // Halt
+  }
+
   // Verify boot info
   if (boot_info && boot_info->magic == BOOT_INFO_MAGIC)
   {
     uart_send_string("Boot info verified. System details:\n");
     uart_send_string("- RAM: ");
-    char buffer[32];
-    uint_to_str(boot_info->ram_size / (1024 * 1024), buffer, sizeof(buffer));
-    uart_send_string(buffer);
+    uart_send_string(uint_to_str(boot_info->ram_size / (1024 * 1024)));
     uart_send_string(" MB\n");
   }
   else
@@ -80,26 +164,110 @@ void kernel_main(boot_info_t* boot_info)
     uart_send_string("WARNING: Boot info invalid or missing\n");
   }
 
+  // Device tree handed over by the loader, read in place
+  if (boot_info && boot_info->magic == BOOT_INFO_MAGIC && fdt_init(boot_info->dtb_address) == EOK)
+  {
+    uart_send_string("- Device tree found\n");
+  }
+
+  // Move the console if the board puts its UART elsewhere
+  const fdt_platform_t* platform = fdt_get_platform();
+  if (platform->uart_base != UART_BASE)
+  {
+    uart_set_base(platform->uart_base);
+    uart_init();
+  }
+  fdt_print_platform();
+
+  // Bring up the secondary CPUs, they idle until given work
+  smp_init();
+
   // Get kernel addresses
   uintptr_t kernel_start = (uintptr_t)&_start;
   uintptr_t kernel_end = (uintptr_t)&_end;
 
-  // Initialize the memory system
-  uart_send_string("Initializing memory system...\n");
-  int res = memory_system_init(boot_info->ram_size, kernel_start, kernel_end);
-  if (res < 0)
+  // The heap follows the kernel, size it from the RAM bank holding the kernel
+  size_t ram_size = boot_info->ram_size;
+  for (uint32_t i = 0; i < platform->memory_count; i++)
+  {
+    if (kernel_start >= platform->memory[i].base && kernel_end <= platform->memory[i].base + platform->memory[i].size)
+    {
+      ram_size = platform->memory[i].size;
+      break;
+    }
+  }
+
+  // Lay the heap out, the steps below run on every CPU
+  memory_system_init_heap(ram_size, kernel_start, kernel_end);
+  boot_layout.ram_size = ram_size;
+  boot_layout.kernel_start = kernel_start;
+  boot_layout.kernel_end = kernel_end;
+
+  for (uint32_t i = 0; i < BOOT_HEAP_TABLE_PARTS; i++)
+  {
+    boot_tasks[BOOT_TASK_HEAP_TABLE + i] = (init_task_t){ .name = "heap table", .function = boot_heap_table, .arg = (void*)(uintptr_t)i, .cpu = TASK_CPU_ANY };
+  }
+
+  // Allocations wait for the reserved ranges to be claimed, after that the
+  // heap lock lets the boot tasks allocate side by side
+  boot_tasks[BOOT_TASK_HEAP] = (init_task_t){ .name = "heap", .function = boot_heap, .arg = &boot_layout, .deps = ((1U << BOOT_HEAP_TABLE_PARTS) - 1) << BOOT_TASK_HEAP_TABLE, .cpu = TASK_CPU_ANY };
+  boot_tasks[BOOT_TASK_INITRAMFS] = (init_task_t){ .name = "initramfs", .function = boot_initramfs, .deps = 1U << BOOT_TASK_HEAP, .cpu = TASK_CPU_ANY };
+  boot_tasks[BOOT_TASK_AI_POOL] = (init_task_t){ .name = "ai pool", .function = boot_ai_pool, .arg = &boot_layout, .deps = 1U << BOOT_TASK_HEAP, .cpu = TASK_CPU_ANY };
+  boot_tasks[BOOT_TASK_MODEL_CHECK] = (init_task_t){ .name = "model check", .function = boot_model_check, .deps = 1U << BOOT_TASK_INITRAMFS, .cpu = TASK_CPU_ANY };
+  boot_tasks[BOOT_TASK_VIRTIO] = (init_task_t){ .name = "virtio probe", .function = boot_virtio_probe, .cpu = TASK_CPU_ANY };
+
+  int res = init_run(boot_tasks, BOOT_TASK_COUNT, smp_cpu_count());
+  if (res < 0 || boot_tasks[BOOT_TASK_HEAP].result < 0 || boot_tasks[BOOT_TASK_AI_POOL].result < 0)
   {
     uart_send_string("Memory system initialization failed!\n");
     while (1) {} // Halt
   }
+  init_print_report(boot_tasks, BOOT_TASK_COUNT);
 
-  // Run memory tests
-  res = memory_run_tests();
-  if (res < 0)
+  // Run the kernel self-tests
+  res = selftest_run();
+  bool tests_failed = res < 0;
+  if (tests_failed)
   {
-    uart_send_string("Memory tests failed!\n");
+    uart_send_string("Kernel self-tests failed!\n");
   }
 
+#ifdef SYNAPSE_BENCHMARKS
+  // Perception pipeline on synthetic frames
+  pipeline_benchmark();
+
+  // Detection post-processing on 10k anchors
+  ai_detect_benchmark();
+
+  // Activation functions, FP32 polynomials and INT8 tables
+  fastmath_benchmark();
+
+  // Recurrent cells, one step of an IMU sized model
+  ai_rnn_benchmark();
+
+  // Locks under contention, run with SMP=4
+  spinlock_benchmark();
+
+  // Lock-free queues, producers and consumers on separate CPUs
+  queue_benchmark();
+
+  // Kernel indexes against the linear scans they replace
+  rb_tree_benchmark();
+  hash_table_benchmark();
+
+  // Kernel threads against kernel processes
+  kthread_benchmark();
+
+  // Preemption primitives and the longest non-preemptible section
+  preempt_benchmark();
+
+  // Zeroed allocations from the pre-zeroed pool and cleared on demand
+  zero_pool_benchmark();
+
+  // Conflict misses of aliased and coloured tensors, QEMU does not model caches
+  memory_bench_page_colouring();
+#endif
+
   // Initialize process management subsystem
   uart_send_string("\n=== Testing Process Management ===\n");
   res = process_management_init();
@@ -109,6 +277,54 @@ void kernel_main(boot_info_t* boot_info)
     while (1) {} // Halt
   }
 
+  // Block storage is optional, QEMU only adds it with -device virtio-blk-device
+  res = virtio_blk_init();
+  if (res < 0 && res != -ENOENT)
+  {
+    uart_send_string("Block device initialization failed!\n");
+  }
+#ifdef SYNAPSE_BENCHMARKS
+  if (res == EOK)
+  {
+    virtio_blk_benchmark();
+    ai_stream_benchmark();
+  }
+#endif
+
+  // Trace export is optional, QEMU adds it with -device virtio-serial-device
+  // and a virtserialport named synapse.trace
+  res = virtio_console_init();
+  if (res < 0 && res != -ENOENT)
+  {
+    uart_send_string("Console device initialization failed!\n");
+  }
+#ifdef SYNAPSE_BENCHMARKS
+  if (res == EOK)
+  {
+    virtio_console_benchmark();
+  }
+
+  // Device interrupts routed to each CPU in turn
+  interrupt_affinity_benchmark();
+#endif
+
+  // Where the device interrupts went
+  interrupt_print_stats();
+
+  // Regression runs (SEMIHOSTING=1) stop here, QEMU exits with the result
+  if (semihost_present())
+  {
+    uart_send_string(tests_failed ? "Self-tests failed, exiting\n" : "Self-tests passed, exiting\n");
+    semihost_exit(tests_failed ? 1 : 0);
+  }
+
+  // The pool is refilled while the CPU has nothing else to run
+  res = zero_pool_start();
+  if (res < 0)
+  {
+    uart_send_string("Zero pool worker failed to start!\n");
+  }
+
   // Create a kernel process
   res = create_kernel_process(kernel_process_test, "kernel_test");
   if (res < 0)
@@ -0,0 +1,292 @@
+/*
+ * hashtable.c - This file implements the Robin Hood hash table. An entry
+ * is never farther from its home slot than the entries it passes, so a
+ * lookup stops at the first slot whose entry is closer to home than the
+ * probe, and removal shifts the rest of the cluster back by one.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "hashtable.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/memory/memory.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// Benchmark configuration, keys and slots as in a process allocation table
+#define HASH_BENCH_KEYS 128
+#define HASH_BENCH_SLOTS 256
+#define HASH_BENCH_LOOKUPS 4096
+
+static hash_slot_t hash_bench_slots[HASH_BENCH_SLOTS];
+static uint64_t hash_bench_keys[HASH_BENCH_KEYS];
+
+/**
+ * @brief Find the slot holding a key
+ * 
+ * @param table Table
+ * @param key Key
+ * @return hash_slot_t* Slot, NULL if the key is absent
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static hash_slot_t* hash_table_lookup(const hash_table_t* table, uint64_t key)
+{
+  uint64_t index = hash_u64(key) & table->mask;
+
+  for (uint32_t distance = 1; ; distance++)
+  {
+    hash_slot_t* slot = &table->slots[index];
+
+    // Empty, or an entry closer to home: the key would have taken its place
+    if (slot->distance < distance)
+    {
+      return NULL;
+    }
+
+    if (slot->key == key)
+    {
+      return slot;
+    }
+
+    index = (index + 1) & table->mask;
+  }
+}
+
+/**
+ * @brief Initialize an empty table
+ * 
+ * @param table Table
+ * @param slots Storage of capacity slots
+ * @param capacity Slots, a power of two
+ * @return int EOK on success, -EINVARG on a bad argument
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int hash_table_init(hash_table_t* table, hash_slot_t* slots, size_t capacity)
+{
+  if (!table || !slots || capacity < 2 || (capacity & (capacity - 1)) != 0)
+  {
+    return -EINVARG;
+  }
+
+  memset(slots, 0, capacity * sizeof(hash_slot_t));
+  table->slots = slots;
+  table->mask = capacity - 1;
+  table->count = 0;
+
+  return EOK;
+}
+
+/**
+ * @brief Add a key
+ * 
+ * @param table Table
+ * @param key Key
+ * @param value Value, returned by lookups
+ * @return int EOK on success, -EINUSE if the key is present, -ENOMEM
+ * if the table is at HASH_TABLE_MAX_LOAD
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int hash_table_insert(hash_table_t* table, uint64_t key, void* value)
+{
+  if (hash_table_lookup(table, key))
+  {
+    return -EINUSE;
+  }
+
+  // A free slot always remains, so every probe loop ends
+  if ((table->count + 1) * 8 > (table->mask + 1) * HASH_TABLE_MAX_LOAD)
+  {
+    return -ENOMEM;
+  }
+
+  hash_slot_t entry = { .key = key, .value = value, .distance = 1 };
+  uint64_t index = hash_u64(key) & table->mask;
+
+  for (;;)
+  {
+    hash_slot_t* slot = &table->slots[index];
+
+    if (slot->distance == 0)
+    {
+      *slot = entry;
+      break;
+    }
+
+    // Take from the rich: the entry closer to home moves on instead
+    if (slot->distance < entry.distance)
+    {
+      hash_slot_t displaced = *slot;
+      *slot = entry;
+      entry = displaced;
+    }
+
+    entry.distance++;
+    index = (index + 1) & table->mask;
+  }
+
+  table->count++;
+
+  return EOK;
+}
+
+/**
+ * @brief Look a key up
+ * 
+ * @param table Table
+ * @param key Key
+ * @return void* Value, NULL if the key is absent
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* hash_table_find(const hash_table_t* table, uint64_t key)
+{
+  hash_slot_t* slot = hash_table_lookup(table, key);
+  return slot ? slot->value : NULL;
+}
+
+/**
+ * @brief Remove a key
+ * 
+ * @param table Table
+ * @param key Key
+ * @return void* Value of the key, NULL if it was absent
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* hash_table_remove(hash_table_t* table, uint64_t key)
+{
+  hash_slot_t* slot = hash_table_lookup(table, key);
+  if (!slot)
+  {
+    return NULL;
+  }
+
+  void* value = slot->value;
+  uint64_t index = (uint64_t)(slot - table->slots);
+
+  // Shift the cluster back until an empty slot or an entry at home
+  for (;;)
+  {
+    uint64_t next_index = (index + 1) & table->mask;
+    hash_slot_t* next = &table->slots[next_index];
+
+    if (next->distance <= 1)
+    {
+      memset(&table->slots[index], 0, sizeof(hash_slot_t));
+      break;
+    }
+
+    table->slots[index] = *next;
+    table->slots[index].distance--;
+    index = next_index;
+  }
+
+  table->count--;
+
+  return value;
+}
+
+/**
+ * @brief Time lookups in the table against a linear scan of the same keys
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int hash_table_benchmark()
+{
+  hash_table_t table;
+  uint64_t frequency = timer_read_frequency();
+  uint64_t found = 0;
+
+  uart_send_string("\n=== Hash Table Benchmark ===\n");
+
+  hash_table_init(&table, hash_bench_slots, HASH_BENCH_SLOTS);
+
+  // Heap-like keys: 64-byte aligned addresses
+  uint64_t start = timer_read_counter();
+  for (size_t i = 0; i < HASH_BENCH_KEYS; i++)
+  {
+    hash_bench_keys[i] = 0x40000000ULL + (i * 0x1C0);
+    if (hash_table_insert(&table, hash_bench_keys[i], &hash_bench_keys[i]) != EOK)
+    {
+      uart_send_string("  Insert failed\n");
+      return -EFAULT;
+    }
+  }
+  uint64_t insert_ticks = timer_read_counter() - start;
+
+  // Table lookups, half of them hits
+  start = timer_read_counter();
+  for (size_t i = 0; i < HASH_BENCH_LOOKUPS; i++)
+  {
+    uint64_t key = hash_bench_keys[(i * 7) % HASH_BENCH_KEYS] + (i & 1);
+    found += hash_table_find(&table, key) != NULL;
+  }
+  uint64_t table_ticks = timer_read_counter() - start;
+
+  // Linear scans of the same keys
+  start = timer_read_counter();
+  for (size_t i = 0; i < HASH_BENCH_LOOKUPS; i++)
+  {
+    uint64_t key = hash_bench_keys[(i * 7) % HASH_BENCH_KEYS] + (i & 1);
+    for (size_t j = 0; j < HASH_BENCH_KEYS; j++)
+    {
+      if (*(volatile uint64_t*)&hash_bench_keys[j] == key)
+      {
+        found--;
+        break;
+      }
+    }
+  }
+  uint64_t scan_ticks = timer_read_counter() - start;
+
+  start = timer_read_counter();
+  for (size_t i = 0; i < HASH_BENCH_KEYS; i++)
+  {
+    if (hash_table_remove(&table, hash_bench_keys[i]) != &hash_bench_keys[i])
+    {
+      found++;
+    }
+  }
+  uint64_t remove_ticks = timer_read_counter() - start;
+
+  uart_send_string("  ");
+  uart_send_string(uint_to_str(HASH_BENCH_KEYS));
+  uart_send_string(" keys in ");
+  uart_send_string(uint_to_str(HASH_BENCH_SLOTS));
+  uart_send_string(" slots, insert: ");
+  uart_send_string(uint_to_str((insert_ticks * 1000000000ULL) / frequency / HASH_BENCH_KEYS));
+  uart_send_string(" ns, remove: ");
+  uart_send_string(uint_to_str((remove_ticks * 1000000000ULL) / frequency / HASH_BENCH_KEYS));
+  uart_send_string(" ns\n  lookup: ");
+  uart_send_string(uint_to_str((table_ticks * 1000000000ULL) / frequency / HASH_BENCH_LOOKUPS));
+  uart_send_string(" ns, linear scan: ");
+  uart_send_string(uint_to_str((scan_ticks * 1000000000ULL) / frequency / HASH_BENCH_LOOKUPS));
+  uart_send_string(" ns\n");
+
+  if (found != 0 || hash_table_count(&table) != 0)
+  {
+    uart_send_string("  LOOKUP MISMATCH\n");
+    return -EFAULT;
+  }
+
+  return EOK;
+}
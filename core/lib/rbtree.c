@@ -0,0 +1,1005 @@
+/*
+ * rbtree.c - This file implements the intrusive red-black tree. Leaves
+ * are NULL and black, every node keeps its parent so the fix-ups walk up
+ * without a stack. After a change the augment callback runs from the
+ * lowest node touched up to the root, rotations recompute the two nodes
+ * they move.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "rbtree.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+#include <synapse/lib/hashtable.h>
+
+// Benchmark configuration
+#define RB_BENCH_NODES 1024
+#define RB_BENCH_LOOKUPS 4096
+
+// Object of the benchmark
+typedef struct
+{
+  rb_node_t node;
+  uint64_t key;
+} rb_bench_entry_t;
+
+static rb_bench_entry_t rb_bench_entries[RB_BENCH_NODES];
+
+// Container test configuration
+#define CONTAINER_TEST_NODES 256
+#define CONTAINER_TEST_OPERATIONS 4000
+#define CONTAINER_TEST_SLOTS 512
+
+// Tree node of the container test, caching the size of its subtree
+typedef struct
+{
+  rb_node_t node;
+  uint64_t key;
+  size_t subtree_size;
+} rb_test_entry_t;
+
+static rb_test_entry_t container_test_entries[CONTAINER_TEST_NODES];
+static bool container_test_present[CONTAINER_TEST_NODES];
+static hash_slot_t container_test_slots[CONTAINER_TEST_SLOTS];
+
+/**
+ * @brief Recompute the cached data of one node
+ * 
+ * @param tree Tree
+ * @param node Node, may be NULL
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void rb_augment_node(rb_tree_t* tree, rb_node_t* node)
+{
+  if (tree->augment && node)
+  {
+    tree->augment(node);
+  }
+}
+
+/**
+ * @brief Recompute the cached data from a node up to the root
+ * 
+ * @param tree Tree
+ * @param node Lowest node whose subtree changed, may be NULL
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rb_augment_path(rb_tree_t* tree, rb_node_t* node)
+{
+  if (!tree->augment)
+  {
+    return;
+  }
+
+  while (node)
+  {
+    tree->augment(node);
+    node = node->parent;
+  }
+}
+
+/**
+ * @brief Put a node in the place of another in the link of its parent
+ * 
+ * @param tree Tree
+ * @param old Node replaced
+ * @param node New node, may be NULL
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rb_replace_child(rb_tree_t* tree, rb_node_t* old, rb_node_t* node)
+{
+  rb_node_t* parent = old->parent;
+
+  if (!parent)
+  {
+    tree->root = node;
+  }
+  else if (parent->left == old)
+  {
+    parent->left = node;
+  }
+  else
+  {
+    parent->right = node;
+  }
+
+  if (node)
+  {
+    node->parent = parent;
+  }
+}
+
+/**
+ * @brief Rotate left around a node, its right child takes its place
+ * 
+ * @param tree Tree
+ * @param node Node
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rb_rotate_left(rb_tree_t* tree, rb_node_t* node)
+{
+  rb_node_t* pivot = node->right;
+
+  node->right = pivot->left;
+  if (pivot->left)
+  {
+    pivot->left->parent = node;
+  }
+
+  rb_replace_child(tree, node, pivot);
+  pivot->left = node;
+  node->parent = pivot;
+
+  // The lowered node first, the pivot covers it now
+  rb_augment_node(tree, node);
+  rb_augment_node(tree, pivot);
+}
+
+/**
+ * @brief Rotate right around a node, its left child takes its place
+ * 
+ * @param tree Tree
+ * @param node Node
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rb_rotate_right(rb_tree_t* tree, rb_node_t* node)
+{
+  rb_node_t* pivot = node->left;
+
+  node->left = pivot->right;
+  if (pivot->right)
+  {
+    pivot->right->parent = node;
+  }
+
+  rb_replace_child(tree, node, pivot);
+  pivot->right = node;
+  node->parent = pivot;
+
+  rb_augment_node(tree, node);
+  rb_augment_node(tree, pivot);
+}
+
+/**
+ * @brief Check if a node is red, NULL leaves are black
+ * 
+ * @param node Node, may be NULL
+ * @return bool true if red
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool rb_is_red(const rb_node_t* node)
+{
+  return node && node->colour == RB_RED;
+}
+
+/**
+ * @brief Initialize an empty tree
+ * 
+ * @param tree Tree
+ * @param compare Order of the nodes
+ * @param augment Callback keeping cached data up to date, or NULL
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rb_tree_init(rb_tree_t* tree, RB_COMPARE compare, RB_AUGMENT augment)
+{
+  tree->root = NULL;
+  tree->compare = compare;
+  tree->augment = augment;
+  tree->count = 0;
+}
+
+/**
+ * @brief Insert a node
+ * 
+ * @param tree Tree
+ * @param node Node, not in any tree
+ * @return int EOK on success, -EINUSE if an equal node is in the tree
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rb_insert(rb_tree_t* tree, rb_node_t* node)
+{
+  rb_node_t* parent = NULL;
+  rb_node_t** link = &tree->root;
+
+  while (*link)
+  {
+    parent = *link;
+    int order = tree->compare(node, parent);
+    if (order == 0)
+    {
+      return -EINUSE;
+    }
+    link = order < 0 ? &parent->left : &parent->right;
+  }
+
+  node->parent = parent;
+  node->left = NULL;
+  node->right = NULL;
+  node->colour = RB_RED;
+  *link = node;
+  tree->count++;
+
+  rb_augment_path(tree, node);
+
+  // Restore the colours, the only violation is a red node under a red parent
+  while (rb_is_red(node->parent))
+  {
+    parent = node->parent;
+    rb_node_t* grandparent = parent->parent; // Black, the root is never red here
+
+    if (parent == grandparent->left)
+    {
+      rb_node_t* uncle = grandparent->right;
+      if (rb_is_red(uncle))
+      {
+        parent->colour = RB_BLACK;
+        uncle->colour = RB_BLACK;
+        grandparent->colour = RB_RED;
+        node = grandparent;
+        continue;
+      }
+
+      if (node == parent->right)
+      {
+        rb_rotate_left(tree, parent);
+        node = parent;
+        parent = node->parent;
+      }
+
+      parent->colour = RB_BLACK;
+      grandparent->colour = RB_RED;
+      rb_rotate_right(tree, grandparent);
+    }
+    else
+    {
+      rb_node_t* uncle = grandparent->left;
+      if (rb_is_red(uncle))
+      {
+        parent->colour = RB_BLACK;
+        uncle->colour = RB_BLACK;
+        grandparent->colour = RB_RED;
+        node = grandparent;
+        continue;
+      }
+
+      if (node == parent->left)
+      {
+        rb_rotate_right(tree, parent);
+        node = parent;
+        parent = node->parent;
+      }
+
+      parent->colour = RB_BLACK;
+      grandparent->colour = RB_RED;
+      rb_rotate_left(tree, grandparent);
+    }
+  }
+
+  tree->root->colour = RB_BLACK;
+
+  return EOK;
+}
+
+/**
+ * @brief Remove a node
+ * 
+ * @param tree Tree
+ * @param node Node of the tree
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rb_erase(rb_tree_t* tree, rb_node_t* node)
+{
+  rb_node_t* child; // Takes the place of the node removed from its position
+  rb_node_t* parent; // Parent of child, child may be NULL
+  uint32_t removed_colour = node->colour;
+
+  if (!node->left || !node->right)
+  {
+    child = node->left ? node->left : node->right;
+    parent = node->parent;
+    rb_replace_child(tree, node, child);
+  }
+  else
+  {
+    // Two children: the successor leaves its position and replaces the node
+    rb_node_t* successor = node->right;
+    while (successor->left)
+    {
+      successor = successor->left;
+    }
+
+    removed_colour = successor->colour;
+    child = successor->right;
+
+    if (successor->parent == node)
+    {
+      parent = successor;
+    }
+    else
+    {
+      parent = successor->parent;
+      rb_replace_child(tree, successor, child);
+      successor->right = node->right;
+      successor->right->parent = successor;
+    }
+
+    rb_replace_child(tree, node, successor);
+    successor->left = node->left;
+    successor->left->parent = successor;
+    successor->colour = node->colour;
+  }
+
+  tree->count--;
+  node->parent = NULL;
+  node->left = NULL;
+  node->right = NULL;
+
+  rb_augment_path(tree, parent);
+
+  if (removed_colour == RB_RED)
+  {
+    return;
+  }
+
+  // A black node left its path, child carries an extra black up the tree
+  while (child != tree->root && !rb_is_red(child))
+  {
+    if (child == parent->left)
+    {
+      rb_node_t* sibling = parent->right;
+      if (rb_is_red(sibling))
+      {
+        sibling->colour = RB_BLACK;
+        parent->colour = RB_RED;
+        rb_rotate_left(tree, parent);
+        sibling = parent->right;
+      }
+
+      if (!rb_is_red(sibling->left) && !rb_is_red(sibling->right))
+      {
+        sibling->colour = RB_RED;
+        child = parent;
+        parent = child->parent;
+        continue;
+      }
+
+      if (!rb_is_red(sibling->right))
+      {
+        sibling->left->colour = RB_BLACK;
+        sibling->colour = RB_RED;
+        rb_rotate_right(tree, sibling);
+        sibling = parent->right;
+      }
+
+      sibling->colour = parent->colour;
+      parent->colour = RB_BLACK;
+      sibling->right->colour = RB_BLACK;
+      rb_rotate_left(tree, parent);
+      child = tree->root;
+    }
+    else
+    {
+      rb_node_t* sibling = parent->left;
+      if (rb_is_red(sibling))
+      {
+        sibling->colour = RB_BLACK;
+        parent->colour = RB_RED;
+        rb_rotate_right(tree, parent);
+        sibling = parent->left;
+      }
+
+      if (!rb_is_red(sibling->left) && !rb_is_red(sibling->right))
+      {
+        sibling->colour = RB_RED;
+        child = parent;
+        parent = child->parent;
+        continue;
+      }
+
+      if (!rb_is_red(sibling->left))
+      {
+        sibling->right->colour = RB_BLACK;
+        sibling->colour = RB_RED;
+        rb_rotate_left(tree, sibling);
+        sibling = parent->left;
+      }
+
+      sibling->colour = parent->colour;
+      parent->colour = RB_BLACK;
+      sibling->left->colour = RB_BLACK;
+      rb_rotate_right(tree, parent);
+      child = tree->root;
+    }
+  }
+
+  if (child)
+  {
+    child->colour = RB_BLACK;
+  }
+}
+
+/**
+ * @brief Find the node equal to a key
+ * 
+ * @param tree Tree
+ * @param key Node filled with the fields compared, not in the tree
+ * @return rb_node_t* Node, NULL if none
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_find(const rb_tree_t* tree, const rb_node_t* key)
+{
+  rb_node_t* node = tree->root;
+
+  while (node)
+  {
+    int order = tree->compare(key, node);
+    if (order == 0)
+    {
+      return node;
+    }
+    node = order < 0 ? node->left : node->right;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Find the first node not ordered before a key
+ * 
+ * @param tree Tree
+ * @param key Node filled with the fields compared, not in the tree
+ * @return rb_node_t* Node, NULL if every node is smaller
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_lower_bound(const rb_tree_t* tree, const rb_node_t* key)
+{
+  rb_node_t* node = tree->root;
+  rb_node_t* best = NULL;
+
+  while (node)
+  {
+    if (tree->compare(node, key) >= 0)
+    {
+      best = node;
+      node = node->left;
+    }
+    else
+    {
+      node = node->right;
+    }
+  }
+
+  return best;
+}
+
+/**
+ * @brief Get the smallest node
+ * 
+ * @param tree Tree
+ * @return rb_node_t* Node, NULL if the tree is empty
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_first(const rb_tree_t* tree)
+{
+  rb_node_t* node = tree->root;
+
+  while (node && node->left)
+  {
+    node = node->left;
+  }
+
+  return node;
+}
+
+/**
+ * @brief Get the largest node
+ * 
+ * @param tree Tree
+ * @return rb_node_t* Node, NULL if the tree is empty
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_last(const rb_tree_t* tree)
+{
+  rb_node_t* node = tree->root;
+
+  while (node && node->right)
+  {
+    node = node->right;
+  }
+
+  return node;
+}
+
+/**
+ * @brief Get the next node in order
+ * 
+ * @param node Node of a tree
+ * @return rb_node_t* Node, NULL after the largest
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_next(const rb_node_t* node)
+{
+  if (node->right)
+  {
+    node = node->right;
+    while (node->left)
+    {
+      node = node->left;
+    }
+    return (rb_node_t*)node;
+  }
+
+  // Climb until we come up from a left subtree
+  while (node->parent && node == node->parent->right)
+  {
+    node = node->parent;
+  }
+
+  return node->parent;
+}
+
+/**
+ * @brief Get the previous node in order
+ * 
+ * @param node Node of a tree
+ * @return rb_node_t* Node, NULL before the smallest
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_prev(const rb_node_t* node)
+{
+  if (node->left)
+  {
+    node = node->left;
+    while (node->right)
+    {
+      node = node->right;
+    }
+    return (rb_node_t*)node;
+  }
+
+  while (node->parent && node == node->parent->left)
+  {
+    node = node->parent;
+  }
+
+  return node->parent;
+}
+
+/**
+ * @brief Check a subtree
+ * 
+ * @param tree Tree
+ * @param node Root of the subtree, may be NULL
+ * @return int Black height on success, -EFAULT if the subtree is broken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int rb_validate_node(const rb_tree_t* tree, const rb_node_t* node)
+{
+  if (!node)
+  {
+    return 1;
+  }
+
+  if (rb_is_red(node) && (rb_is_red(node->left) || rb_is_red(node->right)))
+  {
+    return -EFAULT;
+  }
+
+  if ((node->left && (node->left->parent != node || tree->compare(node->left, node) >= 0)) ||
+      (node->right && (node->right->parent != node || tree->compare(node->right, node) <= 0)))
+  {
+    return -EFAULT;
+  }
+
+  int left = rb_validate_node(tree, node->left);
+  int right = rb_validate_node(tree, node->right);
+  if (left < 0 || right < 0 || left != right)
+  {
+    return -EFAULT;
+  }
+
+  return left + (node->colour == RB_BLACK ? 1 : 0);
+}
+
+/**
+ * @brief Check the tree: order, no red node with a red child, the same
+ * black height on every path, consistent parent links
+ * 
+ * @param tree Tree
+ * @return int Black height on success, -EFAULT if the tree is broken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rb_tree_validate(const rb_tree_t* tree)
+{
+  if (tree->root && (tree->root->parent || rb_is_red(tree->root)))
+  {
+    return -EFAULT;
+  }
+
+  // Global order follows from each node being between its neighbours
+  size_t count = 0;
+  const rb_node_t* prev = NULL;
+  for (const rb_node_t* node = rb_first(tree); node; node = rb_next(node))
+  {
+    if (prev && tree->compare(prev, node) >= 0)
+    {
+      return -EFAULT;
+    }
+    prev = node;
+    count++;
+  }
+
+  if (count != tree->count)
+  {
+    return -EFAULT;
+  }
+
+  return rb_validate_node(tree, tree->root);
+}
+
+/**
+ * @brief Order the benchmark entries by key
+ * 
+ * @param a First node
+ * @param b Second node
+ * @return int Order
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int rb_bench_compare(const rb_node_t* a, const rb_node_t* b)
+{
+  uint64_t key_a = rb_entry(a, rb_bench_entry_t, node)->key;
+  uint64_t key_b = rb_entry(b, rb_bench_entry_t, node)->key;
+
+  return key_a < key_b ? -1 : (key_a > key_b ? 1 : 0);
+}
+
+/**
+ * @brief Time lookups in the tree against a linear scan of the same keys
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rb_tree_benchmark()
+{
+  rb_tree_t tree;
+  rb_bench_entry_t probe;
+  uint64_t frequency = timer_read_frequency();
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  uint64_t found = 0;
+
+  uart_send_string("\n=== Red-Black Tree Benchmark ===\n");
+
+  rb_tree_init(&tree, rb_bench_compare, NULL);
+
+  uint64_t start = timer_read_counter();
+  for (size_t i = 0; i < RB_BENCH_NODES; i++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    rb_bench_entries[i].key = (seed >> 16) | 1; // Odd keys, even probes miss
+    if (rb_insert(&tree, &rb_bench_entries[i].node) != EOK)
+    {
+      rb_bench_entries[i].key = 0; // Duplicate, left out
+    }
+  }
+  uint64_t insert_ticks = timer_read_counter() - start;
+
+  if (rb_tree_validate(&tree) < 0)
+  {
+    uart_send_string("Tree invalid after inserts\n");
+    return -EFAULT;
+  }
+
+  // Tree lookups, half of them hits
+  start = timer_read_counter();
+  for (size_t i = 0; i < RB_BENCH_LOOKUPS; i++)
+  {
+    probe.key = rb_bench_entries[i % RB_BENCH_NODES].key + (i & 1);
+    found += rb_find(&tree, &probe.node) != NULL;
+  }
+  uint64_t tree_ticks = timer_read_counter() - start;
+
+  // Linear scans of the same keys
+  start = timer_read_counter();
+  for (size_t i = 0; i < RB_BENCH_LOOKUPS; i++)
+  {
+    uint64_t key = rb_bench_entries[i % RB_BENCH_NODES].key + (i & 1);
+    for (size_t j = 0; j < RB_BENCH_NODES; j++)
+    {
+      if (*(volatile uint64_t*)&rb_bench_entries[j].key == key)
+      {
+        found--;
+        break;
+      }
+    }
+  }
+  uint64_t scan_ticks = timer_read_counter() - start;
+
+  start = timer_read_counter();
+  for (size_t i = 0; i < RB_BENCH_NODES; i++)
+  {
+    if (rb_bench_entries[i].key != 0)
+    {
+      rb_erase(&tree, &rb_bench_entries[i].node);
+    }
+  }
+  uint64_t erase_ticks = timer_read_counter() - start;
+
+  uart_send_string("  ");
+  uart_send_string(uint_to_str(RB_BENCH_NODES));
+  uart_send_string(" nodes, insert: ");
+  uart_send_string(uint_to_str((insert_ticks * 1000000000ULL) / frequency / RB_BENCH_NODES));
+  uart_send_string(" ns, erase: ");
+  uart_send_string(uint_to_str((erase_ticks * 1000000000ULL) / frequency / RB_BENCH_NODES));
+  uart_send_string(" ns\n  lookup: ");
+  uart_send_string(uint_to_str((tree_ticks * 1000000000ULL) / frequency / RB_BENCH_LOOKUPS));
+  uart_send_string(" ns, linear scan: ");
+  uart_send_string(uint_to_str((scan_ticks * 1000000000ULL) / frequency / RB_BENCH_LOOKUPS));
+  uart_send_string(" ns\n");
+
+  // Both searches must agree, and every node must be gone
+  if (found != 0 || tree.root || tree.count != 0)
+  {
+    uart_send_string("  LOOKUP MISMATCH\n");
+    return -EFAULT;
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Order the tree entries of the container test by key
+ * 
+ * @param a First node
+ * @param b Second node
+ * @return int Order
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int rb_test_compare(const rb_node_t* a, const rb_node_t* b)
+{
+  uint64_t key_a = rb_entry(a, rb_test_entry_t, node)->key;
+  uint64_t key_b = rb_entry(b, rb_test_entry_t, node)->key;
+
+  return key_a < key_b ? -1 : (key_a > key_b ? 1 : 0);
+}
+
+/**
+ * @brief Augment callback of the container test: size of the subtree
+ * 
+ * @param node Node
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rb_test_augment(rb_node_t* node)
+{
+  rb_test_entry_t* entry = rb_entry(node, rb_test_entry_t, node);
+
+  entry->subtree_size = 1;
+  if (node->left)
+  {
+    entry->subtree_size += rb_entry(node->left, rb_test_entry_t, node)->subtree_size;
+  }
+  if (node->right)
+  {
+    entry->subtree_size += rb_entry(node->right, rb_test_entry_t, node)->subtree_size;
+  }
+}
+
+/**
+ * @brief Check the cached subtree sizes of the container test
+ * 
+ * @param node Root of the subtree, may be NULL
+ * @return size_t Size of the subtree, (size_t)-1 if a cached size is wrong
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t rb_test_check_sizes(const rb_node_t* node)
+{
+  if (!node)
+  {
+    return 0;
+  }
+
+  size_t left = rb_test_check_sizes(node->left);
+  size_t right = rb_test_check_sizes(node->right);
+  if (left == (size_t)-1 || right == (size_t)-1 ||
+      rb_entry(node, rb_test_entry_t, node)->subtree_size != left + right + 1)
+  {
+    return (size_t)-1;
+  }
+
+  return left + right + 1;
+}
+
+/**
+ * @brief Test the red-black tree and the hash table: random inserts and
+ * removals checked against a plain array, tree invariants, augmented
+ * data, ordered walks, and the load limit of the table
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rb_tree_test()
+{
+  uart_send_string("\n=== Testing Tree and Hash Table ===\n");
+
+  rb_tree_t tree;
+  hash_table_t table;
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+  rb_tree_init(&tree, rb_test_compare, rb_test_augment);
+  if (hash_table_init(&table, container_test_slots, 100) != -EINVARG ||
+      hash_table_init(&table, container_test_slots, CONTAINER_TEST_SLOTS) != EOK)
+  {
+    uart_send_string("FAIL: Hash table accepted a capacity that is not a power of two\n");
+    return -EIO;
+  }
+
+  for (size_t i = 0; i < CONTAINER_TEST_NODES; i++)
+  {
+    container_test_entries[i].key = i * 3; // Gaps for the lower bound checks
+    container_test_present[i] = false;
+  }
+
+  // Toggle random keys in both containers
+  for (size_t op = 0; op < CONTAINER_TEST_OPERATIONS; op++)
+  {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    size_t i = (seed >> 33) % CONTAINER_TEST_NODES;
+    rb_test_entry_t* entry = &container_test_entries[i];
+
+    if (container_test_present[i])
+    {
+      rb_erase(&tree, &entry->node);
+      if (hash_table_remove(&table, entry->key) != entry)
+      {
+        uart_send_string("FAIL: Hash table lost a key\n");
+        return -EIO;
+      }
+    }
+    else if (rb_insert(&tree, &entry->node) != EOK ||
+             hash_table_insert(&table, entry->key, entry) != EOK)
+    {
+      uart_send_string("FAIL: Insert of a new key refused\n");
+      return -EIO;
+    }
+    container_test_present[i] = !container_test_present[i];
+
+    if ((op % 64) == 0 && (rb_tree_validate(&tree) < 0 ||
+                           rb_test_check_sizes(tree.root) != tree.count))
+    {
+      uart_send_string("FAIL: Red-black tree invariants or subtree sizes broken\n");
+      return -EIO;
+    }
+  }
+
+  // Every key agrees with the reference array
+  size_t present = 0;
+  for (size_t i = 0; i < CONTAINER_TEST_NODES; i++)
+  {
+    rb_test_entry_t probe = { .key = container_test_entries[i].key };
+    rb_node_t* found = rb_find(&tree, &probe.node);
+    void* value = hash_table_find(&table, probe.key);
+    bool expected = container_test_present[i];
+
+    if ((found != NULL) != expected || (value != NULL) != expected ||
+        (expected && (found != &container_test_entries[i].node || value != &container_test_entries[i])))
+    {
+      uart_send_string("FAIL: Lookup disagrees with the inserted keys\n");
+      return -EIO;
+    }
+    present += expected;
+
+    // Lower bound of a key between two entries is the next present entry
+    probe.key++;
+    rb_node_t* bound = rb_lower_bound(&tree, &probe.node);
+    size_t next = i + 1;
+    while (next < CONTAINER_TEST_NODES && !container_test_present[next])
+    {
+      next++;
+    }
+    if (bound != (next < CONTAINER_TEST_NODES ? &container_test_entries[next].node : NULL))
+    {
+      uart_send_string("FAIL: Red-black tree lower bound wrong\n");
+      return -EIO;
+    }
+  }
+
+  if (tree.count != present || hash_table_count(&table) != present)
+  {
+    uart_send_string("FAIL: Container counts wrong\n");
+    return -EIO;
+  }
+
+  // Duplicates are refused, walks in both directions cover every node
+  rb_node_t* first = rb_first(&tree);
+  size_t walked = 0;
+  for (rb_node_t* node = rb_last(&tree); node; node = rb_prev(node))
+  {
+    walked++;
+  }
+  if (first && (rb_insert(&tree, first) != -EINUSE ||
+                hash_table_insert(&table, rb_entry(first, rb_test_entry_t, node)->key, NULL) != -EINUSE))
+  {
+    uart_send_string("FAIL: Duplicate key accepted\n");
+    return -EIO;
+  }
+  if (walked != present)
+  {
+    uart_send_string("FAIL: Red-black tree walk missed nodes\n");
+    return -EIO;
+  }
+
+  // The table stops at HASH_TABLE_MAX_LOAD, lookups still end
+  size_t limit = (CONTAINER_TEST_SLOTS * HASH_TABLE_MAX_LOAD) / 8;
+  uint64_t key = 1;
+  while (hash_table_count(&table) < limit)
+  {
+    if (hash_table_insert(&table, key * 1000003, &table) == -ENOMEM)
+    {
+      break;
+    }
+    key++;
+  }
+  if (hash_table_count(&table) != limit || hash_table_insert(&table, 7, &table) != -ENOMEM ||
+      hash_table_find(&table, 7) != NULL)
+  {
+    uart_send_string("FAIL: Hash table load limit wrong\n");
+    return -EIO;
+  }
+
+  uart_send_string("Tree and hash table tests passed\n");
+  return EOK;
+}
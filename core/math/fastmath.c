@@ -0,0 +1,1040 @@
+/*
+ * fastmath.c - This file implements the fast math library. Every FP32
+ * function is written once on four lanes: exp reduces x to r in
+ * [-ln2/2, ln2/2] and rebuilds 2^n in the exponent bits, log splits the
+ * mantissa from the exponent, the others are built on exp. INT8
+ * activations evaluate the FP32 function once per input code and only
+ * index a table afterwards.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "fastmath.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// 4 floats, one NEON register, only element aligned
+typedef float v4f __attribute__((vector_size(16), aligned(4)));
+// 4 lane masks or raw float bits, one NEON register
+typedef int32_t v4i __attribute__((vector_size(16)));
+
+// Splat a constant on every lane
+#define FASTMATH_V4F(c) ((v4f){ (c), (c), (c), (c) })
+#define FASTMATH_V4I(c) ((v4i){ (c), (c), (c), (c) })
+
+// exp: inputs above overflow to infinity, below flush to 0
+#define FASTMATH_EXP_HI 88.7228393555f
+#define FASTMATH_EXP_LO -87.3365478516f
+#define FASTMATH_LOG2E 1.44269504089f
+#define FASTMATH_LN2_HI 0.693359375f    // Exact in 9 bits, n * LN2_HI has no rounding
+#define FASTMATH_LN2_LO -2.12194440e-4f
+// 1.5 * 2^23, adding it rounds to an integer kept in the low mantissa bits
+#define FASTMATH_ROUND_MAGIC 12582912.0f
+
+// Below this the odd polynomial of tanh is more accurate than exp
+#define FASTMATH_TANH_SMALL 0.625f
+#define FASTMATH_SQRT_HALF 0.707106781187f
+#define FASTMATH_GELU_K 0.797884560803f // sqrt(2 / pi)
+#define FASTMATH_GELU_C 0.044715f
+
+// IEEE 754 single precision fields
+#define FASTMATH_SIGN_MASK 0x80000000
+#define FASTMATH_ABS_MASK 0x7FFFFFFF
+#define FASTMATH_MANT_MASK 0x007FFFFF
+#define FASTMATH_EXP_BIAS 127
+#define FASTMATH_MANT_BITS 23
+#define FASTMATH_HALF_BITS 0x3F000000   // 0.5f
+#define FASTMATH_INF_BITS 0x7F800000
+#define FASTMATH_NAN_BITS 0x7FC00000
+#define FASTMATH_MIN_NORMAL 1.17549435e-38f
+#define FASTMATH_DENORM_SCALE 8388608.0f // 2^23
+
+// INT8 code range
+#define FASTMATH_INT8_MIN -128
+#define FASTMATH_INT8_MAX 127
+
+// Benchmark configuration
+#define FASTMATH_BENCH_ELEMS 16384
+#define FASTMATH_BENCH_RANGE 8.0f  // Inputs span [-RANGE, RANGE]
+#define FASTMATH_BENCH_LOOPS 8
+
+// Fast math test configuration, errors against libm reference values
+#define FASTMATH_TEST_MAX_ULP 2
+#define FASTMATH_TEST_MAX_ABS 2e-7f // GELU cancels to tiny values, also checked absolute
+#define FASTMATH_TEST_ELEMS 11      // Not a multiple of 4 or 8, covers the tails
+
+/**
+ * @brief Pick a lane from a where the mask is set, from b elsewhere
+ * 
+ * @param mask Lane mask, all ones or all zeros
+ * @param a Value where set
+ * @param b Value where clear
+ * @return v4f Selected lanes
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f fastmath_select4(v4i mask, v4f a, v4f b)
+{
+  return (v4f)(((v4i)a & mask) | ((v4i)b & ~mask));
+}
+
+/**
+ * @brief Exponential on four lanes
+ * 
+ * e^x = 2^n * e^r with n = round(x / ln2), r is reduced with a two part
+ * ln2 and e^r is a degree 7 polynomial (Cephes coefficients).
+ * 
+ * @param x Input
+ * @return v4f e^x
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f fastmath_exp4(v4f x)
+{
+  v4i over = x > FASTMATH_V4F(FASTMATH_EXP_HI);
+  v4i under = x < FASTMATH_V4F(FASTMATH_EXP_LO);
+  v4i nan = x != x;
+
+  // Out of range lanes are fixed at the end, keep them finite meanwhile
+  v4f xc = fastmath_select4(over | under | nan, FASTMATH_V4F(0.0f), x);
+
+  v4f t = (xc * FASTMATH_V4F(FASTMATH_LOG2E)) + FASTMATH_V4F(FASTMATH_ROUND_MAGIC);
+  v4f n = t - FASTMATH_V4F(FASTMATH_ROUND_MAGIC);
+  v4i ni = (v4i)t - (v4i)FASTMATH_V4F(FASTMATH_ROUND_MAGIC);
+
+  v4f r = xc - (n * FASTMATH_V4F(FASTMATH_LN2_HI));
+  r = r - (n * FASTMATH_V4F(FASTMATH_LN2_LO));
+
+  v4f p = FASTMATH_V4F(1.9875691500e-4f);
+  p = (p * r) + FASTMATH_V4F(1.3981999507e-3f);
+  p = (p * r) + FASTMATH_V4F(8.3334519073e-3f);
+  p = (p * r) + FASTMATH_V4F(4.1665795894e-2f);
+  p = (p * r) + FASTMATH_V4F(1.6666665459e-1f);
+  p = (p * r) + FASTMATH_V4F(5.0000001201e-1f);
+  p = (p * r * r) + r + FASTMATH_V4F(1.0f);
+
+  // Multiply by 2^n in the exponent field, n is within [-126, 128]
+  v4f res = (v4f)((v4i)p + (ni << FASTMATH_MANT_BITS));
+
+  res = fastmath_select4(over, (v4f)FASTMATH_V4I(FASTMATH_INF_BITS), res);
+  res = fastmath_select4(under, FASTMATH_V4F(0.0f), res);
+  return fastmath_select4(nan, x, res);
+}
+
+/**
+ * @brief Natural logarithm on four lanes
+ * 
+ * x = m * 2^e with m in [sqrt(1/2), sqrt(2)), ln(m) is a degree 9
+ * polynomial in m - 1 (Cephes coefficients) and e * ln2 is added in two
+ * parts.
+ * 
+ * @param x Input
+ * @return v4f ln(x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f fastmath_log4(v4f x)
+{
+  v4i invalid = (x < FASTMATH_V4F(0.0f)) | (x != x);
+  v4i zero = x == FASTMATH_V4F(0.0f);
+  v4i inf = (v4i)x == FASTMATH_V4I(FASTMATH_INF_BITS);
+
+  // Denormals are brought into the normal range first
+  v4i denormal = x < FASTMATH_V4F(FASTMATH_MIN_NORMAL);
+  x = fastmath_select4(denormal, x * FASTMATH_V4F(FASTMATH_DENORM_SCALE), x);
+
+  v4i bits = (v4i)x;
+  v4i e = ((bits >> FASTMATH_MANT_BITS) & FASTMATH_V4I(0xFF)) - FASTMATH_V4I(FASTMATH_EXP_BIAS - 1);
+  e = e + (denormal & FASTMATH_V4I(-FASTMATH_MANT_BITS));
+
+  // m in [0.5, 1), then moved to [sqrt(1/2), sqrt(2)) and centred on 0
+  v4f m = (v4f)((bits & FASTMATH_V4I(FASTMATH_MANT_MASK)) | FASTMATH_V4I(FASTMATH_HALF_BITS));
+  v4i small = m < FASTMATH_V4F(FASTMATH_SQRT_HALF);
+  e = e + small;
+  v4f f = fastmath_select4(small, m + m, m) - FASTMATH_V4F(1.0f);
+  v4f ef = __builtin_convertvector(e, v4f);
+
+  v4f z = f * f;
+  v4f p = FASTMATH_V4F(7.0376836292e-2f);
+  p = (p * f) + FASTMATH_V4F(-1.1514610310e-1f);
+  p = (p * f) + FASTMATH_V4F(1.1676998740e-1f);
+  p = (p * f) + FASTMATH_V4F(-1.2420140846e-1f);
+  p = (p * f) + FASTMATH_V4F(1.4249322787e-1f);
+  p = (p * f) + FASTMATH_V4F(-1.6668057665e-1f);
+  p = (p * f) + FASTMATH_V4F(2.0000714765e-1f);
+  p = (p * f) + FASTMATH_V4F(-2.4999993993e-1f);
+  p = (p * f) + FASTMATH_V4F(3.3333331174e-1f);
+
+  v4f y = p * f * z;
+  y = y + (ef * FASTMATH_V4F(FASTMATH_LN2_LO));
+  y = y - (z * FASTMATH_V4F(0.5f));
+  v4f res = f + y + (ef * FASTMATH_V4F(FASTMATH_LN2_HI));
+
+  res = fastmath_select4(inf, (v4f)FASTMATH_V4I(FASTMATH_INF_BITS), res);
+  res = fastmath_select4(zero, (v4f)FASTMATH_V4I(FASTMATH_INF_BITS | FASTMATH_SIGN_MASK), res);
+  return fastmath_select4(invalid, (v4f)FASTMATH_V4I(FASTMATH_NAN_BITS), res);
+}
+
+/**
+ * @brief Logistic function on four lanes
+ * 
+ * @param x Input
+ * @return v4f 1 / (1 + e^-x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f fastmath_sigmoid4(v4f x)
+{
+  return FASTMATH_V4F(1.0f) / (FASTMATH_V4F(1.0f) + fastmath_exp4(-x));
+}
+
+/**
+ * @brief Hyperbolic tangent on four lanes
+ * 
+ * Small inputs use an odd polynomial (Cephes coefficients), larger ones
+ * 1 - 2 / (e^2|x| + 1) with the sign of x.
+ * 
+ * @param x Input
+ * @return v4f tanh(x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f fastmath_tanh4(v4f x)
+{
+  v4i sign = (v4i)x & FASTMATH_V4I(FASTMATH_SIGN_MASK);
+  v4f a = (v4f)((v4i)x & FASTMATH_V4I(FASTMATH_ABS_MASK));
+
+  v4f z = x * x;
+  v4f p = FASTMATH_V4F(-5.70498872745e-3f);
+  p = (p * z) + FASTMATH_V4F(2.06390887954e-2f);
+  p = (p * z) + FASTMATH_V4F(-5.37397155531e-2f);
+  p = (p * z) + FASTMATH_V4F(1.33314422036e-1f);
+  p = (p * z) + FASTMATH_V4F(-3.33332819422e-1f);
+  v4f small = x + (x * z * p);
+
+  v4f e = fastmath_exp4(a + a);
+  v4f large = FASTMATH_V4F(1.0f) - (FASTMATH_V4F(2.0f) / (e + FASTMATH_V4F(1.0f)));
+  large = (v4f)((v4i)large | sign);
+
+  return fastmath_select4(a < FASTMATH_V4F(FASTMATH_TANH_SMALL), small, large);
+}
+
+/**
+ * @brief GELU on four lanes, tanh form
+ * 
+ * @param x Input
+ * @return v4f 0.5x(1 + tanh(sqrt(2/pi)(x + 0.044715x^3)))
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f fastmath_gelu4(v4f x)
+{
+  v4f inner = FASTMATH_V4F(FASTMATH_GELU_K) * (x + (FASTMATH_V4F(FASTMATH_GELU_C) * x * x * x));
+  return FASTMATH_V4F(0.5f) * x * (FASTMATH_V4F(1.0f) + fastmath_tanh4(inner));
+}
+
+/**
+ * @brief Swish on four lanes
+ * 
+ * @param x Input
+ * @return v4f x * sigmoid(x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f fastmath_swish4(v4f x)
+{
+  return x * fastmath_sigmoid4(x);
+}
+
+/**
+ * @brief Evaluate a function on four lanes
+ * 
+ * @param op Function
+ * @param x Input
+ * @return v4f Result
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline v4f fastmath_eval4(fastmath_op_t op, v4f x)
+{
+  switch (op)
+  {
+    case FASTMATH_OP_EXP:
+      return fastmath_exp4(x);
+    case FASTMATH_OP_LOG:
+      return fastmath_log4(x);
+    case FASTMATH_OP_SIGMOID:
+      return fastmath_sigmoid4(x);
+    case FASTMATH_OP_TANH:
+      return fastmath_tanh4(x);
+    case FASTMATH_OP_GELU:
+      return fastmath_gelu4(x);
+    case FASTMATH_OP_SWISH:
+    default:
+      return fastmath_swish4(x);
+  }
+}
+
+/**
+ * @brief Exponential
+ * 
+ * @param x Input
+ * @return float e^x
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_exp(float x)
+{
+  return fastmath_exp4(FASTMATH_V4F(x))[0];
+}
+
+/**
+ * @brief Natural logarithm
+ * 
+ * @param x Input
+ * @return float ln(x), NaN below 0 and -infinity at 0
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_log(float x)
+{
+  return fastmath_log4(FASTMATH_V4F(x))[0];
+}
+
+/**
+ * @brief Logistic function
+ * 
+ * @param x Input
+ * @return float 1 / (1 + e^-x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_sigmoid(float x)
+{
+  return fastmath_sigmoid4(FASTMATH_V4F(x))[0];
+}
+
+/**
+ * @brief Hyperbolic tangent
+ * 
+ * @param x Input
+ * @return float tanh(x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_tanh(float x)
+{
+  return fastmath_tanh4(FASTMATH_V4F(x))[0];
+}
+
+/**
+ * @brief GELU activation, tanh form
+ * 
+ * @param x Input
+ * @return float GELU(x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_gelu(float x)
+{
+  return fastmath_gelu4(FASTMATH_V4F(x))[0];
+}
+
+/**
+ * @brief Swish (SiLU) activation
+ * 
+ * @param x Input
+ * @return float x * sigmoid(x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_swish(float x)
+{
+  return fastmath_swish4(FASTMATH_V4F(x))[0];
+}
+
+/**
+ * @brief Apply a function to an array, four elements at a time
+ * 
+ * @param op Function
+ * @param src Input
+ * @param dst Output, may be src
+ * @param count Number of elements
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_apply(fastmath_op_t op, const float* src, float* dst, size_t count)
+{
+  if ((unsigned int)op >= FASTMATH_OP_COUNT || ((!src || !dst) && count > 0))
+  {
+    return -EINVARG;
+  }
+
+  // One loop per function, the switch stays out of the hot path
+  size_t i = 0;
+  switch (op)
+  {
+    case FASTMATH_OP_EXP:
+      for (; i + 4 <= count; i += 4)
+        *(v4f*)(dst + i) = fastmath_exp4(*(const v4f*)(src + i));
+      break;
+    case FASTMATH_OP_LOG:
+      for (; i + 4 <= count; i += 4)
+        *(v4f*)(dst + i) = fastmath_log4(*(const v4f*)(src + i));
+      break;
+    case FASTMATH_OP_SIGMOID:
+      for (; i + 4 <= count; i += 4)
+        *(v4f*)(dst + i) = fastmath_sigmoid4(*(const v4f*)(src + i));
+      break;
+    case FASTMATH_OP_TANH:
+      for (; i + 4 <= count; i += 4)
+        *(v4f*)(dst + i) = fastmath_tanh4(*(const v4f*)(src + i));
+      break;
+    case FASTMATH_OP_GELU:
+      for (; i + 4 <= count; i += 4)
+        *(v4f*)(dst + i) = fastmath_gelu4(*(const v4f*)(src + i));
+      break;
+    case FASTMATH_OP_SWISH:
+    default:
+      for (; i + 4 <= count; i += 4)
+        *(v4f*)(dst + i) = fastmath_swish4(*(const v4f*)(src + i));
+      break;
+  }
+
+  // Tail, padded with 1 which is in the domain of every function
+  if (i < count)
+  {
+    v4f tail = FASTMATH_V4F(1.0f);
+    for (size_t j = 0; i + j < count; j++)
+    {
+      tail[j] = src[i + j];
+    }
+
+    tail = fastmath_eval4(op, tail);
+    for (size_t j = 0; i + j < count; j++)
+    {
+      dst[i + j] = tail[j];
+    }
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Check that a tensor is dense with the given type
+ * 
+ * @param tensor Tensor to check
+ * @param dtype Expected type
+ * @return bool true if the tensor can be used by the kernels
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool fastmath_is_operand(tensor_t* tensor, tensor_dtype_t dtype)
+{
+  return tensor && tensor->data && !tensor->sparse && tensor->dtype == dtype;
+}
+
+/**
+ * @brief Get the number of elements of a tensor
+ * 
+ * @param tensor Tensor
+ * @return size_t Number of elements
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t fastmath_elems(tensor_t* tensor)
+{
+  size_t elems = 1;
+  for (size_t i = 0; i < tensor->ndim; i++)
+  {
+    elems *= tensor->shape[i];
+  }
+
+  return elems;
+}
+
+/**
+ * @brief Apply a function to a FLOAT32 tensor
+ * 
+ * @param op Function
+ * @param src Input
+ * @param dst Output with the same number of elements, may be src
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_tensor(fastmath_op_t op, tensor_t* src, tensor_t* dst)
+{
+  if (!fastmath_is_operand(src, TENSOR_TYPE_FLOAT32) || !fastmath_is_operand(dst, TENSOR_TYPE_FLOAT32))
+  {
+    return -EINVARG;
+  }
+
+  size_t count = fastmath_elems(src);
+  if (fastmath_elems(dst) != count)
+  {
+    return -EINVARG;
+  }
+
+  return fastmath_apply(op, (const float*)src->data, (float*)dst->data, count);
+}
+
+/**
+ * @brief Quantize a value to an INT8 code, rounding half away from zero
+ * 
+ * @param value Real value
+ * @param scale Scale
+ * @param zero_point Zero point
+ * @return int8_t Saturated code
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int8_t fastmath_quantize(float value, float scale, int32_t zero_point)
+{
+  if (value != value)
+  {
+    return (int8_t)zero_point;
+  }
+
+  // Saturate before the conversion, infinities included
+  float r = value / scale;
+  if (r > 1024.0f)
+  {
+    r = 1024.0f;
+  }
+  else if (r < -1024.0f)
+  {
+    r = -1024.0f;
+  }
+
+  int32_t q = (int32_t)(r + (r >= 0 ? 0.5f : -0.5f)) + zero_point;
+  if (q > FASTMATH_INT8_MAX)
+  {
+    q = FASTMATH_INT8_MAX;
+  }
+  else if (q < FASTMATH_INT8_MIN)
+  {
+    q = FASTMATH_INT8_MIN;
+  }
+
+  return (int8_t)q;
+}
+
+/**
+ * @brief Build the lookup table of an INT8 activation, done once when
+ * the model is loaded
+ * 
+ * @param lut Table to fill
+ * @param op Function
+ * @param in_scale Input scale
+ * @param in_zero_point Input zero point
+ * @param out_scale Output scale
+ * @param out_zero_point Output zero point
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_lut_init(fastmath_lut_t* lut, fastmath_op_t op, float in_scale, int32_t in_zero_point,
+                      float out_scale, int32_t out_zero_point)
+{
+  if (!lut || (unsigned int)op >= FASTMATH_OP_COUNT || !(in_scale > 0) || !(out_scale > 0))
+  {
+    return -EINVARG;
+  }
+
+  if (in_zero_point < FASTMATH_INT8_MIN || in_zero_point > FASTMATH_INT8_MAX ||
+      out_zero_point < FASTMATH_INT8_MIN || out_zero_point > FASTMATH_INT8_MAX)
+  {
+    return -EINVARG;
+  }
+
+  // Every input code, dequantized and evaluated four at a time
+  float real[FASTMATH_LUT_SIZE];
+  for (int32_t code = FASTMATH_INT8_MIN; code <= FASTMATH_INT8_MAX; code++)
+  {
+    real[(uint8_t)(int8_t)code] = in_scale * (float)(code - in_zero_point);
+  }
+
+  int res = fastmath_apply(op, real, real, FASTMATH_LUT_SIZE);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  for (size_t i = 0; i < FASTMATH_LUT_SIZE; i++)
+  {
+    lut->table[i] = fastmath_quantize(real[i], out_scale, out_zero_point);
+  }
+
+  lut->op = op;
+  lut->in_scale = in_scale;
+  lut->in_zero_point = in_zero_point;
+  lut->out_scale = out_scale;
+  lut->out_zero_point = out_zero_point;
+
+  return EOK;
+}
+
+/**
+ * @brief Apply an INT8 activation to a tensor
+ * 
+ * @param lut Table built by fastmath_lut_init()
+ * @param src INT8 input
+ * @param dst INT8 output with the same number of elements, may be src
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_lut_apply(const fastmath_lut_t* lut, tensor_t* src, tensor_t* dst)
+{
+  if (!lut || !fastmath_is_operand(src, TENSOR_TYPE_INT8) || !fastmath_is_operand(dst, TENSOR_TYPE_INT8))
+  {
+    return -EINVARG;
+  }
+
+  size_t count = fastmath_elems(src);
+  if (fastmath_elems(dst) != count)
+  {
+    return -EINVARG;
+  }
+
+  const uint8_t* in = (const uint8_t*)src->data;
+  int8_t* out = (int8_t*)dst->data;
+  const int8_t* table = lut->table;
+
+  // Eight independent loads per iteration, the table stays in L1
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    int8_t r0 = table[in[i]];
+    int8_t r1 = table[in[i + 1]];
+    int8_t r2 = table[in[i + 2]];
+    int8_t r3 = table[in[i + 3]];
+    int8_t r4 = table[in[i + 4]];
+    int8_t r5 = table[in[i + 5]];
+    int8_t r6 = table[in[i + 6]];
+    int8_t r7 = table[in[i + 7]];
+    out[i] = r0;
+    out[i + 1] = r1;
+    out[i + 2] = r2;
+    out[i + 3] = r3;
+    out[i + 4] = r4;
+    out[i + 5] = r5;
+    out[i + 6] = r6;
+    out[i + 7] = r7;
+  }
+
+  for (; i < count; i++)
+  {
+    out[i] = table[in[i]];
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Print a benchmark line
+ * 
+ * @param name Step name
+ * @param ticks Timer ticks taken
+ * @param elems Elements processed
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void fastmath_bench_print(const char* name, uint64_t ticks, uint64_t elems)
+{
+  if (ticks == 0)
+  {
+    ticks = 1;
+  }
+
+  uart_send_string(name);
+  uart_send_string(": ");
+  uart_send_string(uint_to_str((ticks * 1000000) / timer_read_frequency()));
+  uart_send_string(" us, ");
+  uart_send_string(uint_to_str((elems * timer_read_frequency()) / ticks / 1000));
+  uart_send_string(" K elem/s\n");
+}
+
+/**
+ * @brief Measure the throughput of every function, FP32 and INT8
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_benchmark()
+{
+  static const char* names[FASTMATH_OP_COUNT] = { "exp", "log", "sigmoid", "tanh", "gelu", "swish" };
+  const uint64_t elems = (uint64_t)FASTMATH_BENCH_ELEMS * FASTMATH_BENCH_LOOPS;
+  size_t shape[1] = { FASTMATH_BENCH_ELEMS };
+  int res = EOK;
+
+  tensor_t* fp_in = ai_tensor_create(shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* fp_abs = ai_tensor_create(shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* fp_out = ai_tensor_create(shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* q_in = ai_tensor_create(shape, 1, TENSOR_TYPE_INT8, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* q_out = ai_tensor_create(shape, 1, TENSOR_TYPE_INT8, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  if (!fp_in || !fp_abs || !fp_out || !q_in || !q_out)
+  {
+    res = -ENOMEM;
+    goto out;
+  }
+
+  float* in = (float*)fp_in->data;
+  float* abs_in = (float*)fp_abs->data;
+  int8_t* codes = (int8_t*)q_in->data;
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  for (size_t i = 0; i < FASTMATH_BENCH_ELEMS; i++)
+  {
+    seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+    in[i] = ((float)((seed >> 40) % 20001) / 10000 - 1) * FASTMATH_BENCH_RANGE;
+    abs_in[i] = in[i] < 0 ? -in[i] : in[i];
+    codes[i] = (int8_t)(seed >> 56);
+  }
+
+  uart_send_string("\n=== Fast Math Benchmark ===\n");
+
+  for (int op = 0; op < FASTMATH_OP_COUNT; op++)
+  {
+    // log runs on |x|, the other functions on the signed inputs
+    fastmath_op_t fn = (fastmath_op_t)op;
+    tensor_t* src = fn == FASTMATH_OP_LOG ? fp_abs : fp_in;
+
+    uint64_t start = timer_read_counter();
+    for (int loop = 0; loop < FASTMATH_BENCH_LOOPS; loop++)
+    {
+      res = fastmath_tensor(fn, src, fp_out);
+      if (res < 0)
+      {
+        goto out;
+      }
+    }
+    uint64_t ticks = timer_read_counter() - start;
+
+    uart_send_string("FP32 ");
+    fastmath_bench_print(names[op], ticks, elems);
+  }
+
+  // INT8: the table against dequantize, FP32 function and quantize
+  const float scale = FASTMATH_BENCH_RANGE / FASTMATH_INT8_MAX;
+  const float out_scale = 1.0f / FASTMATH_INT8_MAX;
+  fastmath_lut_t lut;
+
+  uint64_t start = timer_read_counter();
+  res = fastmath_lut_init(&lut, FASTMATH_OP_TANH, scale, 0, out_scale, 0);
+  uint64_t ticks = timer_read_counter() - start;
+  if (res < 0)
+  {
+    goto out;
+  }
+  fastmath_bench_print("INT8 tanh table build", ticks, FASTMATH_LUT_SIZE);
+
+  start = timer_read_counter();
+  for (int loop = 0; loop < FASTMATH_BENCH_LOOPS; loop++)
+  {
+    res = fastmath_lut_apply(&lut, q_in, q_out);
+    if (res < 0)
+    {
+      goto out;
+    }
+  }
+  ticks = timer_read_counter() - start;
+  fastmath_bench_print("INT8 tanh table", ticks, elems);
+
+  int8_t* q = (int8_t*)q_out->data;
+  float* work = (float*)fp_out->data;
+  size_t mismatches = 0;
+  start = timer_read_counter();
+  for (int loop = 0; loop < FASTMATH_BENCH_LOOPS; loop++)
+  {
+    for (size_t i = 0; i < FASTMATH_BENCH_ELEMS; i++)
+    {
+      work[i] = scale * (float)codes[i];
+    }
+    fastmath_apply(FASTMATH_OP_TANH, work, work, FASTMATH_BENCH_ELEMS);
+    for (size_t i = 0; i < FASTMATH_BENCH_ELEMS; i++)
+    {
+      mismatches += fastmath_quantize(work[i], out_scale, 0) != q[i];
+    }
+  }
+  ticks = timer_read_counter() - start;
+  fastmath_bench_print("INT8 tanh through FP32", ticks, elems);
+
+  if (mismatches > 0)
+  {
+    uart_send_string("Fast math: table and FP32 path disagree\n");
+    res = -EFAULT;
+  }
+
+out:
+  if (fp_in)
+    ai_tensor_destroy(fp_in);
+  if (fp_abs)
+    ai_tensor_destroy(fp_abs);
+  if (fp_out)
+    ai_tensor_destroy(fp_out);
+  if (q_in)
+    ai_tensor_destroy(q_in);
+  if (q_out)
+    ai_tensor_destroy(q_out);
+  return res;
+}
+
+/**
+ * @brief Distance between two floats in units in the last place
+ * 
+ * @param a First value
+ * @param b Second value
+ * @return uint32_t Number of floats between a and b
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t fastmath_test_ulp_distance(float a, float b)
+{
+  int32_t ia;
+  int32_t ib;
+  memcpy(&ia, &a, sizeof(ia));
+  memcpy(&ib, &b, sizeof(ib));
+
+  // Negative floats are ordered backwards, map them below 0
+  int64_t la = ia < 0 ? (int64_t)INT32_MIN - ia : ia;
+  int64_t lb = ib < 0 ? (int64_t)INT32_MIN - ib : ib;
+  int64_t diff = la > lb ? la - lb : lb - la;
+
+  return diff > UINT32_MAX ? UINT32_MAX : (uint32_t)diff;
+}
+
+/**
+ * @brief Test the fast math library: every function against libm
+ * reference values, special values, the vector array path against the
+ * scalar one and INT8 tables
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_test()
+{
+  // Expected values are glibc results rounded to FP32
+  static const struct
+  {
+    fastmath_op_t op;
+    float x;
+    float expected;
+  } cases[] = {
+    { FASTMATH_OP_EXP, -87.0f, 1.64581145e-38f },
+    { FASTMATH_OP_EXP, -10.5f, 2.75364491e-05f },
+    { FASTMATH_OP_EXP, -1.0f, 0.36787945f },
+    { FASTMATH_OP_EXP, -0.001f, 0.99900049f },
+    { FASTMATH_OP_EXP, 0.0f, 1.0f },
+    { FASTMATH_OP_EXP, 0.5f, 1.64872122f },
+    { FASTMATH_OP_EXP, 1.0f, 2.71828175f },
+    { FASTMATH_OP_EXP, 3.25f, 25.7903404f },
+    { FASTMATH_OP_EXP, 20.0f, 485165184.0f },
+    { FASTMATH_OP_EXP, 88.5f, 2.72308792e+38f },
+    { FASTMATH_OP_LOG, 1e-40f, -92.1034088f },
+    { FASTMATH_OP_LOG, 1e-10f, -23.0258503f },
+    { FASTMATH_OP_LOG, 0.1f, -2.30258512f },
+    { FASTMATH_OP_LOG, 0.5f, -0.693147182f },
+    { FASTMATH_OP_LOG, 0.7f, -0.356674969f },
+    { FASTMATH_OP_LOG, 1.0f, 0.0f },
+    { FASTMATH_OP_LOG, 1.5f, 0.405465096f },
+    { FASTMATH_OP_LOG, 2.71828175f, 0.99999994f },
+    { FASTMATH_OP_LOG, 1000.0f, 6.90775537f },
+    { FASTMATH_OP_LOG, 3e38f, 88.5968475f },
+    { FASTMATH_OP_SIGMOID, -30.0f, 9.35762291e-14f },
+    { FASTMATH_OP_SIGMOID, -5.0f, 0.00669285096f },
+    { FASTMATH_OP_SIGMOID, -0.5f, 0.377540678f },
+    { FASTMATH_OP_SIGMOID, 0.0f, 0.5f },
+    { FASTMATH_OP_SIGMOID, 0.25f, 0.562176526f },
+    { FASTMATH_OP_SIGMOID, 3.0f, 0.952574134f },
+    { FASTMATH_OP_SIGMOID, 15.0f, 0.999999702f },
+    { FASTMATH_OP_TANH, -9.0f, -0.99999994f },
+    { FASTMATH_OP_TANH, -2.0f, -0.964027584f },
+    { FASTMATH_OP_TANH, -0.6f, -0.537049592f },
+    { FASTMATH_OP_TANH, -0.1f, -0.0996679962f },
+    { FASTMATH_OP_TANH, 0.001f, 0.000999999698f },
+    { FASTMATH_OP_TANH, 0.3f, 0.291312635f },
+    { FASTMATH_OP_TANH, 0.625f, 0.554599702f },
+    { FASTMATH_OP_TANH, 1.0f, 0.761594176f },
+    { FASTMATH_OP_TANH, 4.0f, 0.999329329f },
+    { FASTMATH_OP_GELU, -6.0f, -8.43964898e-11f },
+    { FASTMATH_OP_GELU, -3.0f, -0.00363739207f },
+    { FASTMATH_OP_GELU, -1.0f, -0.158808008f },
+    { FASTMATH_OP_GELU, -0.2f, -0.0841485709f },
+    { FASTMATH_OP_GELU, 0.0f, 0.0f },
+    { FASTMATH_OP_GELU, 0.5f, 0.345714003f },
+    { FASTMATH_OP_GELU, 1.5f, 1.39957154f },
+    { FASTMATH_OP_GELU, 4.0f, 3.99992967f },
+    { FASTMATH_OP_SWISH, -6.0f, -0.0148357386f },
+    { FASTMATH_OP_SWISH, -3.0f, -0.142277613f },
+    { FASTMATH_OP_SWISH, -1.0f, -0.268941432f },
+    { FASTMATH_OP_SWISH, -0.2f, -0.0900332034f },
+    { FASTMATH_OP_SWISH, 0.0f, 0.0f },
+    { FASTMATH_OP_SWISH, 0.5f, 0.311229676f },
+    { FASTMATH_OP_SWISH, 1.5f, 1.22636175f },
+    { FASTMATH_OP_SWISH, 4.0f, 3.92805505f }
+  };
+
+  size_t shape[1] = { FASTMATH_TEST_ELEMS };
+  int res = EOK;
+
+  uart_send_string("\n=== Testing Fast Math ===\n");
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+  {
+    float value = 0;
+    fastmath_apply(cases[i].op, &cases[i].x, &value, 1);
+
+    float error = value > cases[i].expected ? value - cases[i].expected : cases[i].expected - value;
+    bool ok = fastmath_test_ulp_distance(value, cases[i].expected) <= FASTMATH_TEST_MAX_ULP;
+    if (!ok && cases[i].op == FASTMATH_OP_GELU)
+    {
+      ok = error <= FASTMATH_TEST_MAX_ABS;
+    }
+
+    if (!ok)
+    {
+      uart_send_string("FAIL: Fast math result out of tolerance, case ");
+      uart_send_string(uint_to_str(i));
+      uart_send_string("\n");
+      return -EIO;
+    }
+  }
+
+  // Overflow, underflow and domain errors
+  float inf = fastmath_exp(100.0f);
+  float nan = fastmath_log(-1.0f);
+  if (inf <= 3.4e38f || fastmath_exp(-100.0f) != 0 || nan == nan || fastmath_log(0.0f) != -inf ||
+      fastmath_log(inf) != inf || fastmath_tanh(20.0f) != 1.0f || fastmath_tanh(-inf) != -1.0f ||
+      fastmath_sigmoid(-inf) != 0 || fastmath_sigmoid(inf) != 1.0f)
+  {
+    uart_send_string("FAIL: Fast math special values\n");
+    return -EIO;
+  }
+
+  tensor_t* fp = ai_tensor_create(shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* q_in = ai_tensor_create(shape, 1, TENSOR_TYPE_INT8, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  tensor_t* q_out = ai_tensor_create(shape, 1, TENSOR_TYPE_INT8, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ALIGNED);
+  if (!fp || !q_in || !q_out)
+  {
+    uart_send_string("FAIL: Tensor creation failed\n");
+    res = -ENOMEM;
+    goto out;
+  }
+
+  // The vector body and the tail give the scalar results
+  float* data = (float*)fp->data;
+  for (size_t i = 0; i < FASTMATH_TEST_ELEMS; i++)
+  {
+    data[i] = ((float)i - 5) * 0.75f;
+  }
+
+  res = fastmath_tensor(FASTMATH_OP_SWISH, fp, fp);
+  for (size_t i = 0; res == EOK && i < FASTMATH_TEST_ELEMS; i++)
+  {
+    if (data[i] != fastmath_swish(((float)i - 5) * 0.75f))
+    {
+      res = -EIO;
+    }
+  }
+  if (res != EOK)
+  {
+    uart_send_string("FAIL: Fast math array path differs from scalar\n");
+    goto out;
+  }
+
+  // Sigmoid on [-8, 8) in steps of 1/16, output on [0, 1) in steps of 1/256
+  fastmath_lut_t lut;
+  res = fastmath_lut_init(&lut, FASTMATH_OP_SIGMOID, 1.0f / 16, 0, 1.0f / 256, -128);
+  if (res != EOK || lut.table[0] != 0 || lut.table[(uint8_t)(int8_t)127] != 127 ||
+      lut.table[(uint8_t)(int8_t)-128] != -128 || lut.table[16] != 59)
+  {
+    uart_send_string("FAIL: INT8 sigmoid table\n");
+    res = res != EOK ? res : -EIO;
+    goto out;
+  }
+
+  if (fastmath_lut_init(&lut, FASTMATH_OP_TANH, 0.0f, 0, 1.0f, 0) != -EINVARG ||
+      fastmath_lut_init(&lut, FASTMATH_OP_TANH, 1.0f, 200, 1.0f, 0) != -EINVARG)
+  {
+    uart_send_string("FAIL: INT8 table accepted a bad quantization\n");
+    res = -EIO;
+    goto out;
+  }
+
+  res = fastmath_lut_init(&lut, FASTMATH_OP_TANH, 1.0f / 32, 3, 1.0f / 127, 0);
+  int8_t* in = (int8_t*)q_in->data;
+  int8_t* out_codes = (int8_t*)q_out->data;
+  for (size_t i = 0; i < FASTMATH_TEST_ELEMS; i++)
+  {
+    in[i] = (int8_t)((i * 29) - 128);
+  }
+
+  if (res == EOK)
+  {
+    res = fastmath_lut_apply(&lut, q_in, q_out);
+  }
+  for (size_t i = 0; res == EOK && i < FASTMATH_TEST_ELEMS; i++)
+  {
+    if (out_codes[i] != lut.table[(uint8_t)in[i]])
+    {
+      res = -EIO;
+    }
+  }
+  if (res != EOK)
+  {
+    uart_send_string("FAIL: INT8 table apply\n");
+    goto out;
+  }
+
+  uart_send_string("Fast math tests passed\n");
+
+out:
+  if (fp)
+    ai_tensor_destroy(fp);
+  if (q_in)
+    ai_tensor_destroy(q_in);
+  if (q_out)
+    ai_tensor_destroy(q_out);
+  return res;
+}
@@ -4,7 +4,7 @@
  *
  * Author: Fedi Nabli
  * Date: 20 Mar 2025
- * Last Modified: 26 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "ai_memory.h"
@@ -19,6 +19,23 @@
 
 #include <synapse/memory/memory.h>
 #include <synapse/memory/heap/kheap.h>
+#include <synapse/memory/pressure/pressure.h>
+#include <synapse/memory/zero_pool/zero_pool.h>
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/lib/rbtree.h>
+#include <synapse/scheduler/preempt.h>
+#include <synapse/string/string.h>
+
+// Free block of the pool, kept outside the block: freed sizes are estimates
+// and the memory may still be overlapped by a neighbour
+typedef struct ai_memory_free_block
+{
+  rb_node_t node; // In the free tree, ordered by size then address
+  void* addr;
+  size_t size;
+  struct ai_memory_free_block* next_unused;
+} ai_memory_free_block_t;
 
 // Memory pool structure
 typedef struct
@@ -27,56 +44,39 @@ typedef struct
   size_t total_size; // Total size of the pool
   size_t used_size; // Used size within the pool
 
-  // Simple free list allocator
-  void** free_blocks; // Array of free block pointers
-  size_t* free_block_sizes; // Array of free block sizes
+  // Best-fit allocator, the free tree gives the smallest block that fits
+  ai_memory_free_block_t* free_block_entries; // AI_MEMORY_MAX_BLOCKS entries
+  ai_memory_free_block_t* unused_entries; // Entries not in the free tree
+  rb_tree_t free_tree;
   size_t free_block_count; // Number of free blocks
 
   // Small block allocator for tensor
   void* small_block_pool; // Pool for small tensors
   uint64_t* small_block_bitmap; // Bitmap for small block allocations
+  uint64_t* small_block_zero_bitmap; // Free small blocks known to hold zeros
+  size_t small_block_zero_cursor; // Next block the zero pool worker looks at
   size_t small_block_count; // Number of small blocks
 
-  // Statistics
-  size_t allocations; // Total number of allocations
-  size_t deallocations; // Total number of deallocations
+  // Page colouring
+  uint32_t colour_count; // Number of page colours of the last level cache
+  uint32_t next_colour; // Next colour handed out for AI_MEMORY_COLOUR_ANY
+
+  // Statistics, event counts are per-CPU counters below
   size_t peak_usage; // Peak memory usage
+  size_t reclaimed_size; // Bytes given back to the kernel heap under pressure
+
+  // Protects everything above once the pool is up. Never held across
+  // kmalloc(), whose reclaim may call ai_memory_shrink()
+  spinlock_t lock;
 } ai_memory_pool_t;
 
 // Global memory pool
 static ai_memory_pool_t ai_mem_pool;
 
-// Temporary buffer for early boot string operations
-static char temp_str_buffer[32];
-
-// Convert a number to a string for UART output
-static char* uint_to_str(uint64_t value)
-{
-  int i = 0;
-  char* p = temp_str_buffer;
-
-  do
-  {
-    temp_str_buffer[i++] = '0' + (value % 10);
-    value /= 10;
-  } while (value > 0 && i < 31);
-  
-  temp_str_buffer[i] = '\0';
-
-  // Reverse the string
-  int j = 0;
-  i--;
-  while (j < i)
-  {
-    char temp = p[j];
-    p[j] = p[i];
-    p[i] = temp;
-    j++;
-    i--;
-  }
-
-  return temp_str_buffer;
-}
+// Event counts, per CPU so they need neither the pool lock nor a shared line
+static DEFINE_PER_CPU_COUNTER(ai_memory_allocations);
+static DEFINE_PER_CPU_COUNTER(ai_memory_deallocations);
+static DEFINE_PER_CPU_COUNTER(ai_memory_coloured_allocations); // Allocations with a colour constraint
 
 /**
  * @brief Calculate tensor strides
@@ -156,10 +156,13 @@ static size_t ai_memory_get_optimal_alignment(tensor_dtype_t dtype)
 {
   switch (dtype)
   {
+    case TENSOR_TYPE_INT4:
+    case TENSOR_TYPE_UINT4:
     case TENSOR_TYPE_INT8:
       return 16; // 16-byte alignment for 128-bit SIMD
     case TENSOR_TYPE_INT16:
     case TENSOR_TYPE_FLOAT16:
+    case TENSOR_TYPE_BFLOAT16:
       return 16; // 16-byte alignment for 128-bit SIMD
     case TENSOR_TYPE_INT32:
     case TENSOR_TYPE_FLOAT32:
@@ -186,15 +189,52 @@ static size_t ai_tensor_get_elem_size(tensor_dtype_t dtype)
       return 1;
     case TENSOR_TYPE_INT16:
     case TENSOR_TYPE_FLOAT16:
+    case TENSOR_TYPE_BFLOAT16:
       return 2;
     case TENSOR_TYPE_INT32:
     case TENSOR_TYPE_FLOAT32:
       return 4;
     default:
-      return 0;
+      return 0; // Packed sub-byte types have no whole byte size
   }
 }
 
+/**
+ * @brief Get the number of bits of an element of a tensor type
+ * 
+ * @param dtype Tensor data type
+ * @return size_t Element size in bits
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t ai_tensor_get_elem_bits(tensor_dtype_t dtype)
+{
+  switch (dtype)
+  {
+    case TENSOR_TYPE_INT4:
+    case TENSOR_TYPE_UINT4:
+      return 4;
+    default:
+      return ai_tensor_get_elem_size(dtype) * 8;
+  }
+}
+
+/**
+ * @brief Get the number of bytes holding a number of elements
+ * 
+ * @param dtype Tensor data type
+ * @param elems Number of elements
+ * @return size_t Size in bytes, rounded up to a whole byte
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t ai_tensor_elems_to_bytes(tensor_dtype_t dtype, size_t elems)
+{
+  return ((elems * ai_tensor_get_elem_bits(dtype)) + 7) / 8;
+}
+
 /**
  * @brief Helper to align a pointer
  * 
@@ -213,44 +253,282 @@ static void* align_pointer(void* ptr, size_t alignment)
 }
 
 /**
- * @brief Small block allocation
+ * @brief Read the geometry of a cache level
+ * 
+ * @param level Cache level (0 = L1, 1 = L2)
+ * @return uint64_t CCSIDR_EL1 value for the data/unified cache of that level
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint64_t read_ccsidr(uint32_t level)
+{
+  uint64_t ccsidr;
+  __asm__ volatile("msr csselr_el1, %0" :: "r" ((uint64_t)(level << 1)));
+  __asm__ volatile("isb");
+  __asm__ volatile("mrs %0, ccsidr_el1" : "=r" (ccsidr));
+  return ccsidr;
+}
+
+/**
+ * @brief Compute the number of page colours of the last level data cache
+ * 
+ * A colour is a group of pages mapping to the same cache sets, there are
+ * (sets * line size) / PAGE_SIZE of them
+ * 
+ * @return uint32_t Number of colours, clamped to [1, AI_MEMORY_MAX_COLOURS]
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t ai_memory_detect_colours()
+{
+  uint64_t clidr;
+  __asm__ volatile("mrs %0, clidr_el1" : "=r" (clidr));
+
+  // Use L2 if it is a data or unified cache, otherwise fall back to L1D
+  uint32_t level = (((clidr >> 3) & 0x7) >= 2) ? 1 : 0;
+  uint64_t ccsidr = read_ccsidr(level);
+
+  size_t line_size = 1UL << ((ccsidr & 0x7) + 4);
+  size_t sets = ((ccsidr >> 13) & 0x7FFF) + 1;
+  size_t way_size = line_size * sets;
+
+  uint32_t colours = way_size / PAGE_SIZE;
+  if (colours < 1)
+    colours = 1;
+  if (colours > AI_MEMORY_MAX_COLOURS)
+    colours = AI_MEMORY_MAX_COLOURS;
+
+  return colours;
+}
+
+/**
+ * @brief Align a pointer and advance it to the first page of the requested colour
+ * 
+ * @param ptr Pointer to be aligned
+ * @param alignment Alignment boundary
+ * @param colour Requested colour, AI_MEMORY_COLOUR_NONE for plain alignment
+ * @return void* Aligned pointer
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void* colour_align_pointer(void* ptr, size_t alignment, uint32_t colour)
+{
+  if (colour == AI_MEMORY_COLOUR_NONE || ai_mem_pool.colour_count <= 1)
+  {
+    return align_pointer(ptr, alignment);
+  }
+
+  uintptr_t addr = (uintptr_t)align_pointer(ptr, alignment > PAGE_SIZE ? alignment : PAGE_SIZE);
+  uint32_t current = ai_memory_get_colour((void*)addr);
+  uint32_t skip = (colour + ai_mem_pool.colour_count - current) % ai_mem_pool.colour_count;
+
+  return (void*)(addr + (skip * PAGE_SIZE));
+}
+
+/**
+ * @brief Resolve a colour request to a concrete colour
+ * 
+ * @param colour Requested colour or AI_MEMORY_COLOUR_ANY/AI_MEMORY_COLOUR_NONE
+ * @param size Size of the allocation, used to advance the rotation
+ * @return uint32_t Concrete colour or AI_MEMORY_COLOUR_NONE
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t ai_memory_resolve_colour(uint32_t colour, size_t size)
+{
+  if (colour == AI_MEMORY_COLOUR_NONE || ai_mem_pool.colour_count <= 1)
+  {
+    return AI_MEMORY_COLOUR_NONE;
+  }
+
+  if (colour == AI_MEMORY_COLOUR_ANY)
+  {
+    // Next allocation starts right after the colours this one covers
+    size_t pages = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+    uint64_t flags = spin_lock_irqsave(&ai_mem_pool.lock);
+    colour = ai_mem_pool.next_colour;
+    ai_mem_pool.next_colour = (colour + pages) % ai_mem_pool.colour_count;
+    spin_unlock_irqrestore(&ai_mem_pool.lock, flags);
+    return colour;
+  }
+
+  return colour % ai_mem_pool.colour_count;
+}
+
+/**
+ * @brief Order free blocks by size, then address
+ * 
+ * @param a First node
+ * @param b Second node
+ * @return int Order
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int free_block_compare(const rb_node_t* a, const rb_node_t* b)
+{
+  const ai_memory_free_block_t* block_a = rb_entry(a, ai_memory_free_block_t, node);
+  const ai_memory_free_block_t* block_b = rb_entry(b, ai_memory_free_block_t, node);
+
+  if (block_a->size != block_b->size)
+  {
+    return block_a->size < block_b->size ? -1 : 1;
+  }
+
+  if (block_a->addr != block_b->addr)
+  {
+    return (uintptr_t)block_a->addr < (uintptr_t)block_b->addr ? -1 : 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Add a free block, called with the pool lock held
+ * 
+ * @param addr Start of the block
+ * @param size Size of the block
+ * @return int EOK on success, -ENOMEM if AI_MEMORY_MAX_BLOCKS blocks are
+ * free already, -EINUSE if the block is already free
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int free_block_add(void* addr, size_t size)
+{
+  ai_memory_free_block_t* block = ai_mem_pool.unused_entries;
+  if (!block)
+  {
+    return -ENOMEM;
+  }
+
+  block->addr = addr;
+  block->size = size;
+  int res = rb_insert(&ai_mem_pool.free_tree, &block->node);
+  if (res != EOK)
+  {
+    return res;
+  }
+
+  ai_mem_pool.unused_entries = block->next_unused;
+  ai_mem_pool.free_block_count++;
+
+  return EOK;
+}
+
+/**
+ * @brief Remove a free block, called with the pool lock held
+ * 
+ * @param block Free block
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void free_block_remove(ai_memory_free_block_t* block)
+{
+  rb_erase(&ai_mem_pool.free_tree, &block->node);
+  block->next_unused = ai_mem_pool.unused_entries;
+  ai_mem_pool.unused_entries = block;
+  ai_mem_pool.free_block_count--;
+}
+
+/**
+ * @brief Move or resize a free block, called with the pool lock held
+ * 
+ * @param block Free block
+ * @param addr New start
+ * @param size New size
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void free_block_update(ai_memory_free_block_t* block, void* addr, size_t size)
+{
+  // The key changes, so does the position in the tree
+  rb_erase(&ai_mem_pool.free_tree, &block->node);
+  block->addr = addr;
+  block->size = size;
+  if (rb_insert(&ai_mem_pool.free_tree, &block->node) != EOK)
+  {
+    // Same block already free, drop the duplicate
+    block->next_unused = ai_mem_pool.unused_entries;
+    ai_mem_pool.unused_entries = block;
+    ai_mem_pool.free_block_count--;
+  }
+}
+
+/**
+ * @brief Allocate a small block. Zeroed requests take a block the zero
+ * pool worker cleared when there is one, others leave those alone
  * 
  * @param size Size of the block to allocate
+ * @param zeroed Return the block cleared
  * @return void* Pointer to the allocated block, or NULL if allocation failed
  * 
  * @author Fedi Nabli
  * @date 20 Mar 2025
  */
-static void* alloc_small_block(size_t size)
+static void* alloc_small_block(size_t size, bool zeroed)
 {
-  // Find a free small block
+  // Find a free small block, preferring one of the requested kind
+  size_t found = ai_mem_pool.small_block_count;
   for (size_t i = 0; i < ai_mem_pool.small_block_count; i++)
   {
     size_t byte_idx = i / 64;
     size_t bit_idx = i % 64;
 
-    if (!(ai_mem_pool.small_block_bitmap[byte_idx] & (1ULL << bit_idx)))
+    if (ai_mem_pool.small_block_bitmap[byte_idx] & (1ULL << bit_idx))
     {
-      // Mark block as used
-      ai_mem_pool.small_block_bitmap[byte_idx] |= (1ULL << bit_idx);
-
-      // Calculate block address
-      void* block_addr = (void*)((uintptr_t)ai_mem_pool.small_block_pool + (i * AI_MEMORY_MIN_BLOCK_SIZE));
+      continue;
+    }
 
-      // Update statistics
-      ai_mem_pool.used_size += AI_MEMORY_MIN_BLOCK_SIZE;
-      ai_mem_pool.allocations++;
-      if (ai_mem_pool.used_size > ai_mem_pool.peak_usage)
-      {
-        ai_mem_pool.peak_usage = ai_mem_pool.used_size;
-      }
+    if (found == ai_mem_pool.small_block_count)
+    {
+      found = i;
+    }
 
-      return block_addr;
+    bool is_zero = (ai_mem_pool.small_block_zero_bitmap[byte_idx] & (1ULL << bit_idx)) != 0;
+    if (is_zero == zeroed)
+    {
+      found = i;
+      break;
     }
   }
 
-  // No free small blocks
-  return NULL;
+  if (found == ai_mem_pool.small_block_count)
+  {
+    // No free small blocks
+    return NULL;
+  }
+
+  size_t byte_idx = found / 64;
+  uint64_t bit = 1ULL << (found % 64);
+  bool is_zero = (ai_mem_pool.small_block_zero_bitmap[byte_idx] & bit) != 0;
+
+  // Mark block as used
+  ai_mem_pool.small_block_bitmap[byte_idx] |= bit;
+  ai_mem_pool.small_block_zero_bitmap[byte_idx] &= ~bit;
+
+  // Calculate block address
+  void* block_addr = (void*)((uintptr_t)ai_mem_pool.small_block_pool + (found * AI_MEMORY_MIN_BLOCK_SIZE));
+  if (zeroed && !is_zero)
+  {
+    memset(block_addr, 0, AI_MEMORY_MIN_BLOCK_SIZE);
+  }
+
+  // Update statistics
+  ai_mem_pool.used_size += AI_MEMORY_MIN_BLOCK_SIZE;
+  percpu_counter_inc(&ai_memory_allocations);
+  if (ai_mem_pool.used_size > ai_mem_pool.peak_usage)
+  {
+    ai_mem_pool.peak_usage = ai_mem_pool.used_size;
+  }
+
+  return block_addr;
 }
 
 /**
@@ -292,7 +570,7 @@ static int free_small_block(void* ptr)
 
   // Update statistics
   ai_mem_pool.used_size -= AI_MEMORY_MIN_BLOCK_SIZE;
-  ai_mem_pool.deallocations++;
+  percpu_counter_inc(&ai_memory_deallocations);
 
   return EOK;
 }
@@ -300,14 +578,19 @@ static int free_small_block(void* ptr)
 /**
  * @brief Allocate memory from the pool
  * 
+ * Coloured allocations start on a page of the requested colour, so buffers
+ * used together can be placed in disjoint cache sets
+ * 
  * @param size Size of the memory to allocate
  * @param alignment Alignment requirement for the allocation
+ * @param colour Page colour of the first page, AI_MEMORY_COLOUR_NONE for none
+ * @param zeroed Return the memory cleared
  * @return void* Pointer to the allocated memory, or NULL if allocation failed
  * 
  * @author Fedi Nabli
  * @date 20 Mar 2025
  */
-static void* ai_memory_alloc(size_t size, size_t alignment)
+static void* ai_memory_alloc(size_t size, size_t alignment, uint32_t colour, bool zeroed)
 {
   if (size == 0)
   {
@@ -316,39 +599,61 @@ static void* ai_memory_alloc(size_t size, size_t alignment)
 
   // Round up size to alignment
   size = (size + alignment - 1) & ~(alignment - 1);
+  size_t zero_size = zeroed ? size : 0;
+
+  uint64_t flags = spin_lock_irqsave(&ai_mem_pool.lock);
 
   // For a small allocations, use the small block allocator
   if (size <= AI_MEMORY_MIN_BLOCK_SIZE)
   {
-    return alloc_small_block(size);
+    void* block = alloc_small_block(size, zeroed);
+    spin_unlock_irqrestore(&ai_mem_pool.lock, flags);
+    return block;
+  }
+
+  if (colour != AI_MEMORY_COLOUR_NONE)
+  {
+    percpu_counter_inc(&ai_memory_coloured_allocations);
   }
 
-  // Find best-fit free block
-  size_t best_idx = (size_t)-1;
-  size_t best_size = (size_t)-1;
+  // Find best-fit free block: the smallest one of at least size, walking
+  // up while alignment (and colour) make a block too short
+  ai_memory_free_block_t key = { .addr = NULL, .size = size };
+  ai_memory_free_block_t* best = NULL;
 
-  for (size_t i = 0; i < ai_mem_pool.free_block_count; i++)
+  for (rb_node_t* node = rb_lower_bound(&ai_mem_pool.free_tree, &key.node); node; node = rb_next(node))
   {
-    void* block = ai_mem_pool.free_blocks[i];
-    size_t block_size = ai_mem_pool.free_block_sizes[i];
+    ai_memory_free_block_t* candidate = rb_entry(node, ai_memory_free_block_t, node);
 
-    // Ensure alignment
-    void* aligned_block = align_pointer(block, alignment);
-    size_t alignment_overhead = (uint64_t)aligned_block - (uintptr_t)block;
+    // Ensure alignment (and colour)
+    void* aligned_block = colour_align_pointer(candidate->addr, alignment, colour);
+    size_t alignment_overhead = (uint64_t)aligned_block - (uintptr_t)candidate->addr;
 
-    if (block_size >= size + alignment_overhead && block_size < best_size)
+    if (candidate->size >= size + alignment_overhead)
     {
-      best_idx = i;
-      best_size = block_size;
+      best = candidate;
+      break;
     }
   }
 
-  if (best_idx == (size_t)-1)
+  if (!best)
   {
     // No suitable block found, allocate from system
     // MODIFIED: Use kmalloc instead of kpage_alloc_contiguous
     size_t alloc_size = size + alignment;
-    void* new_block = kmalloc(alloc_size);
+    void* new_block = NULL;
+    uint32_t colour_count = ai_mem_pool.colour_count;
+    spin_unlock_irqrestore(&ai_mem_pool.lock, flags);
+
+    if (colour != AI_MEMORY_COLOUR_NONE)
+    {
+      // Heap blocks are pages, ask the heap for a page of that colour
+      new_block = kmalloc_coloured(alloc_size, colour, colour_count);
+    }
+    else
+    {
+      new_block = kmalloc(alloc_size);
+    }
 
     if (!new_block)
     {
@@ -361,35 +666,56 @@ static void* ai_memory_alloc(size_t size, size_t alignment)
     // size_t alignment_overhead = (uintptr_t)aligned_block - (uintptr_t)new_block;
 
     // Update statistics
+    percpu_counter_inc(&ai_memory_allocations);
+    flags = spin_lock_irqsave(&ai_mem_pool.lock);
     ai_mem_pool.used_size += alloc_size;
-    ai_mem_pool.allocations++;
     if (ai_mem_pool.used_size > ai_mem_pool.peak_usage)
     {
       ai_mem_pool.peak_usage = ai_mem_pool.used_size;
     }
+    spin_unlock_irqrestore(&ai_mem_pool.lock, flags);
 
+    zero_pool_clear(aligned_block, zero_size);
     return aligned_block;
   }
 
   // Use the best-fit block
-  void* block = ai_mem_pool.free_blocks[best_idx];
-  size_t block_size = ai_mem_pool.free_block_sizes[best_idx];
+  void* block = best->addr;
+  size_t block_size = best->size;
 
   // Align the block
-  void* aligned_block = align_pointer(block, alignment);
+  void* aligned_block = colour_align_pointer(block, alignment, colour);
   size_t alignment_overhead = (uintptr_t)aligned_block - (uintptr_t)block;
 
   // Calculate remaining size after allocation
   size_t remaining_size = block_size - (size + alignment_overhead);
 
+  // Coloured allocations may skip whole pages, keep that prefix free
+  bool keep_prefix = alignment_overhead >= AI_MEMORY_MIN_BLOCK_SIZE;
+
   // If we have enough space left, split the block
-  if (remaining_size >= AI_MEMORY_MIN_BLOCK_SIZE)
+  if (remaining_size >= AI_MEMORY_MIN_BLOCK_SIZE &&
+      (!keep_prefix || ai_mem_pool.free_block_count < AI_MEMORY_MAX_BLOCKS))
   {
     void* new_free_block = (void*)((uintptr_t)aligned_block + size);
 
-    // Replace the current free block with the new one
-    ai_mem_pool.free_blocks[best_idx] = new_free_block;
-    ai_mem_pool.free_block_sizes[best_idx] = remaining_size;
+    if (keep_prefix)
+    {
+      // Prefix stays in place, the remainder becomes a new free block
+      free_block_update(best, block, alignment_overhead);
+      free_block_add(new_free_block, remaining_size);
+    }
+    else
+    {
+      // Replace the current free block with the new one
+      free_block_update(best, new_free_block, remaining_size);
+    }
+  }
+  else if (keep_prefix)
+  {
+    // Use the rest of the block, the prefix stays on the free list
+    size = block_size - alignment_overhead;
+    free_block_update(best, block, alignment_overhead);
   }
   else
   {
@@ -397,23 +723,26 @@ static void* ai_memory_alloc(size_t size, size_t alignment)
     size = block_size - alignment_overhead;
 
     // Remove the block from free list
-    for (size_t i = best_idx; i < ai_mem_pool.free_block_count - 1; i++)
-    {
-      ai_mem_pool.free_blocks[i] = ai_mem_pool.free_blocks[i + 1];
-      ai_mem_pool.free_block_sizes[i] = ai_mem_pool.free_block_sizes[i + 1];
-    }
+    free_block_remove(best);
+  }
 
-    ai_mem_pool.free_block_count--;
+  if (keep_prefix)
+  {
+    // The prefix is not used by this allocation
+    alignment_overhead = 0;
   }
 
   // Update statistics
   ai_mem_pool.used_size += size + alignment_overhead;
-  ai_mem_pool.allocations++;
+  percpu_counter_inc(&ai_memory_allocations);
   if (ai_mem_pool.used_size > ai_mem_pool.peak_usage)
   {
     ai_mem_pool.peak_usage = ai_mem_pool.used_size;
   }
 
+  spin_unlock_irqrestore(&ai_mem_pool.lock, flags);
+
+  zero_pool_clear(aligned_block, zero_size);
   return aligned_block;
 }
 
@@ -433,12 +762,14 @@ static int ai_memory_free(void* ptr)
     return -EINVARG;
   }
 
+  uint64_t flags = spin_lock_irqsave(&ai_mem_pool.lock);
+
   // Check if it's a small block
   int res = free_small_block(ptr);
   if (res == EOK)
   {
     // Successfully freed a small block
-    return EOK;
+    goto out;
   }
 
   // Add to free list if there's space
@@ -447,26 +778,91 @@ static int ai_memory_free(void* ptr)
     // We don't know the true size, but we'll just use a conservative estimate
     size_t block_size = PAGE_SIZE; // Assume one page for now
 
-    ai_mem_pool.free_blocks[ai_mem_pool.free_block_count] = ptr;
-    ai_mem_pool.free_block_sizes[ai_mem_pool.free_block_count] = block_size;
-    ai_mem_pool.free_block_count++;
+    if (free_block_add(ptr, block_size) != EOK)
+    {
+      // Already on the free list
+      res = -EINVARG;
+      goto out;
+    }
 
     // Update statistics
     ai_mem_pool.used_size -= block_size;
-    ai_mem_pool.deallocations++;
+    percpu_counter_inc(&ai_memory_deallocations);
 
-    return EOK;
+    res = EOK;
+    goto out;
   }
 
-  // Free list is full, use kfree directly
-  // MODIFIED: Use kfree instead of kpage_free
-  kfree(ptr);
-
-  // Update statistics (approximate)
+  // Free list is full, use kfree directly. Update statistics (approximate)
+  // under the lock, then drop it: kfree() may reclaim through the
+  // pressure shrinkers and ai_memory_shrink() takes the same lock
   ai_mem_pool.used_size -= PAGE_SIZE; // Assume one page size
-  ai_mem_pool.deallocations++;
+  percpu_counter_inc(&ai_memory_deallocations);
+  spin_unlock_irqrestore(&ai_mem_pool.lock, flags);
 
+  kfree(ptr);
   return EOK;
+
+out:
+  spin_unlock_irqrestore(&ai_mem_pool.lock, flags);
+  return res;
+}
+
+/**
+ * @brief Shrinker for the AI memory pool, gives whole unused heap chunks
+ * on the free list back to the kernel heap
+ * 
+ * @param target Number of bytes to release
+ * @param private_data Unused
+ * @return size_t Number of bytes released
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t ai_memory_shrink(size_t target, void* private_data)
+{
+  size_t released = 0;
+  void* release_list = NULL;
+
+  // Reclaim runs from kmalloc() callers that never hold the pool lock
+  uint64_t flags = spin_lock_irqsave(&ai_mem_pool.lock);
+  rb_node_t* node = rb_first(&ai_mem_pool.free_tree);
+  while (node && released < target)
+  {
+    ai_memory_free_block_t* entry = rb_entry(node, ai_memory_free_block_t, node);
+    void* block = entry->addr;
+    size_t block_size = entry->size;
+    node = rb_next(node);
+
+    // Only a free entry covering a whole heap allocation can be released,
+    // split entries still share their chunk with live tensors
+    if (kheap_allocation_size(block) != block_size)
+    {
+      continue;
+    }
+
+    // Remove the block from free list, it is ours alone from here and
+    // links the blocks to give back
+    free_block_remove(entry);
+    *(void**)block = release_list;
+    release_list = block;
+    released += block_size;
+  }
+
+  // Fallback kmalloc() blocks were never counted in the pool size
+  ai_mem_pool.total_size -= released < ai_mem_pool.total_size ? released : ai_mem_pool.total_size;
+  ai_mem_pool.reclaimed_size += released;
+  spin_unlock_irqrestore(&ai_mem_pool.lock, flags);
+
+  // kfree() may update the pressure level, never under the pool lock
+  while (release_list)
+  {
+    void* block = release_list;
+    release_list = *(void**)block;
+    kfree(block);
+  }
+
+  return released;
 }
 
 /**
@@ -491,21 +887,26 @@ int ai_memory_init(size_t pool_size)
   memset(&ai_mem_pool, 0, sizeof(ai_memory_pool_t));
   ai_mem_pool.total_size = requested_pool_size;
 
+  // Detect page colours of the last level cache
+  ai_mem_pool.colour_count = ai_memory_detect_colours();
+  uart_send_string("Page colours: ");
+  uart_send_string(uint_to_str(ai_mem_pool.colour_count));
+  uart_send_string("\n");
+
   // Allocate management structures
-  ai_mem_pool.free_blocks = (void**)kmalloc(AI_MEMORY_MAX_BLOCKS * sizeof(void*));
-  if (!ai_mem_pool.free_blocks)
+  ai_mem_pool.free_block_entries = (ai_memory_free_block_t*)kmalloc(AI_MEMORY_MAX_BLOCKS * sizeof(ai_memory_free_block_t));
+  if (!ai_mem_pool.free_block_entries)
   {
-    uart_send_string("Failed to allocate free block array\n");
+    uart_send_string("Failed to allocate free block entries\n");
     return -ENOMEM;
   }
 
-  ai_mem_pool.free_block_sizes = (size_t*)kmalloc(AI_MEMORY_MAX_BLOCKS * sizeof(size_t));
-  if (!ai_mem_pool.free_block_sizes)
+  rb_tree_init(&ai_mem_pool.free_tree, free_block_compare, NULL);
+  for (size_t i = 0; i < AI_MEMORY_MAX_BLOCKS; i++)
   {
-    kfree(ai_mem_pool.free_blocks);
-    uart_send_string("Failed to allocate free block sizes array\n");
-    return -ENOMEM;
+    ai_mem_pool.free_block_entries[i].next_unused = i + 1 < AI_MEMORY_MAX_BLOCKS ? &ai_mem_pool.free_block_entries[i + 1] : NULL;
   }
+  ai_mem_pool.unused_entries = &ai_mem_pool.free_block_entries[0];
 
   // Calculate small block pool size (1/4 of total)
   size_t small_pool_size = requested_pool_size / 4; 
@@ -522,14 +923,22 @@ int ai_memory_init(size_t pool_size)
   ai_mem_pool.small_block_bitmap = (uint64_t*)kmalloc(bitmap_size);
   if (!ai_mem_pool.small_block_bitmap)
   {
-    kfree(ai_mem_pool.free_block_sizes);
-    kfree(ai_mem_pool.free_blocks);
+    kfree(ai_mem_pool.free_block_entries);
     uart_send_string("Failed to allocate small block bitmap\n");
     return -ENOMEM;
   }
 
   // Clear bitmap
   memset(ai_mem_pool.small_block_bitmap, 0, bitmap_size);
+
+  ai_mem_pool.small_block_zero_bitmap = (uint64_t*)kzalloc(bitmap_size);
+  if (!ai_mem_pool.small_block_zero_bitmap)
+  {
+    kfree(ai_mem_pool.small_block_bitmap);
+    kfree(ai_mem_pool.free_block_entries);
+    uart_send_string("Failed to allocate small block bitmap\n");
+    return -ENOMEM;
+  }
   
   // MODIFIED: Use kmalloc instead of page allocator for small block pool
   uart_send_string("Allocating small block pool using kmalloc...\n");
@@ -547,9 +956,9 @@ int ai_memory_init(size_t pool_size)
     if (!ai_mem_pool.small_block_pool)
     {
       uart_send_string("Critical failure: Cannot allocate small block pool\n");
+      kfree(ai_mem_pool.small_block_zero_bitmap);
       kfree(ai_mem_pool.small_block_bitmap);
-      kfree(ai_mem_pool.free_block_sizes);
-      kfree(ai_mem_pool.free_blocks);
+      kfree(ai_mem_pool.free_block_entries);
       return -ENOMEM;
     }
     
@@ -557,8 +966,8 @@ int ai_memory_init(size_t pool_size)
     ai_mem_pool.small_block_count = small_pool_size / AI_MEMORY_MIN_BLOCK_SIZE;
   }
   
-  // Clear the small block pool
-  memset(ai_mem_pool.small_block_pool, 0, small_pool_size);
+  // Not cleared here: the zero pool worker clears free blocks while idle
+  // and a zeroed allocation clears a block not done yet
   
   uart_send_string("Small block pool allocated at: 0x");
   uart_send_string(uint_to_str((uintptr_t)ai_mem_pool.small_block_pool));
@@ -584,9 +993,7 @@ int ai_memory_init(size_t pool_size)
     void* block = kmalloc(block_size);
     if (block)
     {
-      ai_mem_pool.free_blocks[ai_mem_pool.free_block_count] = block;
-      ai_mem_pool.free_block_sizes[ai_mem_pool.free_block_count] = block_size;
-      ai_mem_pool.free_block_count++;
+      free_block_add(block, block_size);
       blocks_allocated++;
     }
     else
@@ -606,6 +1013,12 @@ int ai_memory_init(size_t pool_size)
   uart_send_string(uint_to_str(ai_mem_pool.total_size / 1024));
   uart_send_string(" KB total capacity\n");
   
+  // Untouched free blocks can go back to the kernel heap under pressure
+  if (memory_pressure_register_shrinker("ai_pool", ai_memory_shrink, NULL, SHRINKER_PRIORITY_NORMAL) < 0)
+  {
+    uart_send_string("Failed to register AI memory shrinker\n");
+  }
+
   // Print some stats
   ai_memory_print_stats();
 
@@ -626,6 +1039,25 @@ int ai_memory_init(size_t pool_size)
  * @date 21 Mar 2025
  */
 tensor_t* ai_tensor_create(size_t* shape, size_t ndim, tensor_dtype_t dtype, tensor_layout_t layout, uint32_t flags)
+{
+  return ai_tensor_create_coloured(shape, ndim, dtype, layout, flags, AI_MEMORY_COLOUR_NONE);
+}
+
+/**
+ * @brief Create a tensor whose data starts on a page of the given cache colour
+ * 
+ * @param shape Pointer to the shape array
+ * @param ndim Number of dimensions
+ * @param dtype Data type of the tensor elements
+ * @param layout Memory layout of the tensor
+ * @param flags Allocation flags
+ * @param colour Page colour, AI_MEMORY_COLOUR_ANY to rotate or AI_MEMORY_COLOUR_NONE
+ * @return tensor_t* Pointer to the created tensor, or NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+tensor_t* ai_tensor_create_coloured(size_t* shape, size_t ndim, tensor_dtype_t dtype, tensor_layout_t layout, uint32_t flags, uint32_t colour)
 {
   uart_send_string("ai_tensor_create: Starting tensor creation\n");
   
@@ -653,7 +1085,7 @@ tensor_t* ai_tensor_create(size_t* shape, size_t ndim, tensor_dtype_t dtype, ten
   uart_send_string("\n");
 
   size_t elem_size = ai_tensor_get_elem_size(dtype);
-  size_t memory_size = total_elems * elem_size;
+  size_t memory_size = ai_tensor_elems_to_bytes(dtype, total_elems);
 
   uart_send_string("ai_tensor_create: Element size: ");
   uart_send_string(uint_to_str(elem_size));
@@ -718,8 +1150,10 @@ tensor_t* ai_tensor_create(size_t* shape, size_t ndim, tensor_dtype_t dtype, ten
   tensor->ndim = ndim;
   tensor->dtype = dtype;
   tensor->elem_size = elem_size;
+  tensor->elem_bits = ai_tensor_get_elem_bits(dtype);
   tensor->layout = layout;
   tensor->flags = flags;
+  tensor->colour = ai_memory_resolve_colour(colour, memory_size);
 
   // Calculate strides
   uart_send_string("ai_tensor_create: Calculating strides\n");
@@ -727,7 +1161,7 @@ tensor_t* ai_tensor_create(size_t* shape, size_t ndim, tensor_dtype_t dtype, ten
 
   // Use direct kmalloc for data
   uart_send_string("ai_tensor_create: Allocating tensor data with kmalloc\n");
-  tensor->data = ai_memory_alloc(memory_size, alignment);
+  tensor->data = ai_memory_alloc(memory_size, alignment, tensor->colour, (flags & TENSOR_MEM_ZEROED) != 0);
   if (!tensor->data)
   {
     uart_send_string("ai_tensor_create: Failed to allocate tensor data\n");
@@ -741,15 +1175,208 @@ tensor_t* ai_tensor_create(size_t* shape, size_t ndim, tensor_dtype_t dtype, ten
   uart_send_string(uint_to_str((uintptr_t)tensor->data));
   uart_send_string("\n");
 
-  // Zero data if requested
-  if (flags & TENSOR_MEM_ZEROED)
+  uart_send_string("ai_tensor_create: Tensor creation successful\n");
+  return tensor;
+}
+
+/**
+ * @brief Create a packed INT4 / UINT4 tensor with per-group scales, groups
+ * run along the last dimension which must be even
+ * 
+ * @param shape Pointer to the shape array
+ * @param ndim Number of dimensions
+ * @param dtype TENSOR_TYPE_INT4 or TENSOR_TYPE_UINT4
+ * @param group_size Elements per group, even
+ * @param flags Allocation flags
+ * @return tensor_t* Pointer to the created tensor, or NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+tensor_t* ai_tensor_create_packed(size_t* shape, size_t ndim, tensor_dtype_t dtype, size_t group_size, uint32_t flags)
+{
+  if (!shape || ndim == 0 || (dtype != TENSOR_TYPE_INT4 && dtype != TENSOR_TYPE_UINT4) ||
+      group_size == 0 || (group_size % 2) != 0 || (shape[ndim - 1] % 2) != 0)
   {
-    uart_send_string("ai_tensor_create: Zeroing tensor data\n");
-    memset(tensor->data, 0, memory_size);
+    uart_send_string("ai_tensor_create_packed: Invalid parameters\n");
+    return NULL;
+  }
+
+  tensor_t* tensor = ai_tensor_create(shape, ndim, dtype, TENSOR_LAYOUT_ROW_MAJOR, flags);
+  if (!tensor)
+  {
+    return NULL;
+  }
+
+  // Groups never cross rows, a partial group closes each row
+  size_t cols = shape[ndim - 1];
+  size_t rows = 1;
+  for (size_t i = 0; i + 1 < ndim; i++)
+  {
+    rows *= shape[i];
+  }
+
+  tensor_quant_t* quant = (tensor_quant_t*)kzalloc(sizeof(tensor_quant_t));
+  if (!quant)
+  {
+    goto fail;
+  }
+  tensor->quant = quant;
+
+  quant->group_size = group_size;
+  quant->group_count = rows * ((cols + group_size - 1) / group_size);
+  quant->scales = (float*)kzalloc(quant->group_count * sizeof(float));
+  if (!quant->scales)
+  {
+    goto fail;
+  }
+
+  if (dtype == TENSOR_TYPE_UINT4)
+  {
+    quant->zero_points = (uint8_t*)kzalloc(quant->group_count);
+    if (!quant->zero_points)
+    {
+      goto fail;
+    }
   }
 
-  uart_send_string("ai_tensor_create: Tensor creation successful\n");
   return tensor;
+
+fail:
+  uart_send_string("ai_tensor_create_packed: Failed to allocate group scales\n");
+  ai_tensor_destroy(tensor);
+  return NULL;
+}
+
+/**
+ * @brief Create an empty 2D sparse tensor, the caller fills the index
+ * and the values
+ * 
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param dtype Data type of the tensor elements
+ * @param format TENSOR_FORMAT_CSR or TENSOR_FORMAT_BSR
+ * @param block_rows Rows per block (BSR only, must divide rows)
+ * @param block_cols Columns per block (BSR only, must divide cols)
+ * @param nnz Number of stored elements (CSR) or blocks (BSR)
+ * @param flags Allocation flags
+ * @return tensor_t* Pointer to the created tensor, or NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+tensor_t* ai_tensor_create_sparse(size_t rows, size_t cols, tensor_dtype_t dtype, tensor_format_t format, size_t block_rows, size_t block_cols, size_t nnz, uint32_t flags)
+{
+  if (rows == 0 || cols == 0 || dtype >= TENSOR_TYPE_COUNT)
+  {
+    uart_send_string("ai_tensor_create_sparse: Invalid parameters\n");
+    return NULL;
+  }
+
+  if (format == TENSOR_FORMAT_CSR)
+  {
+    block_rows = 1;
+    block_cols = 1;
+  }
+  else if (format != TENSOR_FORMAT_BSR || block_rows == 0 || block_cols == 0 ||
+           (rows % block_rows) != 0 || (cols % block_cols) != 0)
+  {
+    uart_send_string("ai_tensor_create_sparse: Invalid format or block size\n");
+    return NULL;
+  }
+
+  size_t elem_size = ai_tensor_get_elem_size(dtype);
+  size_t value_size = nnz * block_rows * block_cols * elem_size;
+  if (elem_size == 0)
+  {
+    uart_send_string("ai_tensor_create_sparse: Packed types can not be sparse\n");
+    return NULL;
+  }
+
+  size_t alignment = 8; // Default alignment
+  if (flags & TENSOR_MEM_ALIGNED)
+  {
+    alignment = ai_memory_get_optimal_alignment(dtype);
+  }
+
+  tensor_t* tensor = (tensor_t*)kzalloc(sizeof(tensor_t));
+  if (!tensor)
+  {
+    return NULL;
+  }
+
+  tensor->shape = (size_t*)kmalloc(2 * sizeof(size_t));
+  tensor->strides = (size_t*)kmalloc(2 * sizeof(size_t));
+  tensor->sparse = (tensor_sparse_t*)kzalloc(sizeof(tensor_sparse_t));
+  if (!tensor->shape || !tensor->strides || !tensor->sparse)
+  {
+    goto fail;
+  }
+
+  tensor->shape[0] = rows;
+  tensor->shape[1] = cols;
+  tensor->ndim = 2;
+  tensor->dtype = dtype;
+  tensor->elem_size = elem_size;
+  tensor->elem_bits = elem_size * 8;
+  tensor->layout = TENSOR_LAYOUT_ROW_MAJOR;
+  tensor->flags = flags;
+  tensor->colour = AI_MEMORY_COLOUR_NONE;
+  tensor->format = format;
+  calculate_strides(tensor);
+
+  tensor_sparse_t* sparse = tensor->sparse;
+  sparse->block_rows = block_rows;
+  sparse->block_cols = block_cols;
+  sparse->nnz = nnz;
+
+  // An empty row_ptr describes a tensor with no stored entries
+  sparse->row_ptr = (uint32_t*)kzalloc(((rows / block_rows) + 1) * sizeof(uint32_t));
+  sparse->col_idx = (uint32_t*)kmalloc((nnz ? nnz : 1) * sizeof(uint32_t));
+  if (!sparse->row_ptr || !sparse->col_idx)
+  {
+    goto fail;
+  }
+
+  tensor->data = ai_memory_alloc(value_size ? value_size : elem_size, alignment, AI_MEMORY_COLOUR_NONE, (flags & TENSOR_MEM_ZEROED) != 0);
+  if (!tensor->data)
+  {
+    goto fail;
+  }
+
+  uart_send_string("ai_tensor_create_sparse: Created tensor with ");
+  uart_send_string(uint_to_str(nnz));
+  uart_send_string(" stored entries, ");
+  uart_send_string(uint_to_str(value_size));
+  uart_send_string(" bytes of values\n");
+
+  return tensor;
+
+fail:
+  uart_send_string("ai_tensor_create_sparse: Allocation failed\n");
+  if (tensor->sparse)
+  {
+    if (tensor->sparse->row_ptr)
+    {
+      kfree(tensor->sparse->row_ptr);
+    }
+    if (tensor->sparse->col_idx)
+    {
+      kfree(tensor->sparse->col_idx);
+    }
+    kfree(tensor->sparse);
+  }
+  if (tensor->strides)
+  {
+    kfree(tensor->strides);
+  }
+  if (tensor->shape)
+  {
+    kfree(tensor->shape);
+  }
+  kfree(tensor);
+
+  return NULL;
 }
 
 /**
@@ -785,6 +1412,30 @@ int ai_tensor_destroy(tensor_t* tensor)
     uart_send_string("ai_tensor_destroy: Tensor has NULL data pointer\n");
   }
 
+  // Free group scales
+  if (tensor->quant)
+  {
+    uart_send_string("ai_tensor_destroy: Freeing group scales\n");
+    if (tensor->quant->scales)
+    {
+      kfree(tensor->quant->scales);
+    }
+    if (tensor->quant->zero_points)
+    {
+      kfree(tensor->quant->zero_points);
+    }
+    kfree(tensor->quant);
+  }
+
+  // Free sparse index
+  if (tensor->sparse)
+  {
+    uart_send_string("ai_tensor_destroy: Freeing sparse index\n");
+    kfree(tensor->sparse->row_ptr);
+    kfree(tensor->sparse->col_idx);
+    kfree(tensor->sparse);
+  }
+
   // Free shape and strides array
   if (tensor->shape)
   {
@@ -819,7 +1470,8 @@ int ai_tensor_destroy(tensor_t* tensor)
  */
 int ai_tensor_reshape(tensor_t* tensor, size_t* new_shape, size_t new_ndim)
 {
-  if (!tensor || !new_shape || new_ndim == 0)
+  // The sparse index is built for a fixed 2D shape
+  if (!tensor || !new_shape || new_ndim == 0 || tensor->sparse)
   {
     return -EINVARG;
   }
@@ -945,7 +1597,7 @@ size_t ai_tensor_get_alignment(tensor_t* tensor)
  * @brief Get total tensor size in bytes
  * 
  * @param tensor Pointer to the tensor
- * @return size_t Total size of the tensor in bytes
+ * @return size_t Total size of the tensor data in bytes (stored values for sparse tensors)
  * 
  * @author Fedi Nabli
  * @date 21 Mar 2025
@@ -957,6 +1609,12 @@ size_t ai_tensor_get_size(tensor_t* tensor)
     return 0;
   }
 
+  // Sparse tensors only store the non-zero values
+  if (tensor->sparse)
+  {
+    return tensor->sparse->nnz * tensor->sparse->block_rows * tensor->sparse->block_cols * tensor->elem_size;
+  }
+
   // Calculate total elements
   size_t total_elems = 1;
   for (size_t i = 0; i < tensor->ndim; i++)
@@ -964,7 +1622,7 @@ size_t ai_tensor_get_size(tensor_t* tensor)
     total_elems *= tensor->shape[i];
   }
 
-  return total_elems * tensor->elem_size;
+  return ((total_elems * tensor->elem_bits) + 7) / 8;
 }
 
 /**
@@ -979,7 +1637,8 @@ size_t ai_tensor_get_size(tensor_t* tensor)
  */
 void* ai_tensor_get_element(tensor_t* tensor, size_t* indices)
 {
-  if (!tensor || !indices)
+  // Sparse elements have no fixed address
+  if (!tensor || !indices || tensor->sparse)
   {
     return NULL;
   }
@@ -991,8 +1650,8 @@ void* ai_tensor_get_element(tensor_t* tensor, size_t* indices)
     offset += indices[i] * tensor->strides[i];
   }
 
-  // Get pointer to element
-  return (void*)((uintptr_t)tensor->data + (offset * tensor->elem_size));
+  // Get pointer to element, packed elements share their byte
+  return (void*)((uintptr_t)tensor->data + ((offset * tensor->elem_bits) / 8));
 }
 
 /**
@@ -1019,8 +1678,13 @@ int ai_tensor_copy_data(tensor_t* tensor, void* data, size_t size)
     size = tensor_size; // Truncate to tensor size
   }
 
-  // Copy data
-  memcpy(tensor->data, data, size);
+  // Copy data, letting the scheduler in between chunks
+  for (size_t offset = 0; offset < size; offset += PREEMPT_CHUNK_SIZE)
+  {
+    size_t chunk = size - offset < PREEMPT_CHUNK_SIZE ? size - offset : PREEMPT_CHUNK_SIZE;
+    memcpy((uint8_t*)tensor->data + offset, (uint8_t*)data + offset, chunk);
+    cond_resched();
+  }
 
   return EOK;
 }
@@ -1038,7 +1702,7 @@ int ai_tensor_copy_data(tensor_t* tensor, void* data, size_t size)
  */
 tensor_t* ai_tensor_view(tensor_t* tensor, size_t* start_indices, size_t* shape)
 {
-  if (!tensor || !start_indices || !shape)
+  if (!tensor || !start_indices || !shape || tensor->sparse)
   {
     return NULL;
   }
@@ -1063,8 +1727,13 @@ tensor_t* ai_tensor_view(tensor_t* tensor, size_t* start_indices, size_t* shape)
   // Copy tensor properties
   view->dtype = tensor->dtype;
   view->elem_size = tensor->elem_size;
+  view->elem_bits = tensor->elem_bits;
+  view->quant = NULL;
   view->layout = tensor->layout;
   view->flags = tensor->flags;
+  view->colour = tensor->colour;
+  view->format = TENSOR_FORMAT_DENSE;
+  view->sparse = NULL;
   view->ndim = tensor->ndim;
 
   // Allocate shape and strides array
@@ -1097,12 +1766,163 @@ tensor_t* ai_tensor_view(tensor_t* tensor, size_t* start_indices, size_t* shape)
     offset += start_indices[i] * tensor->strides[i];
   }
 
+  // Packed views must start on a whole byte
+  if ((offset * tensor->elem_bits) % 8 != 0)
+  {
+    kfree(view->strides);
+    kfree(view->shape);
+    kfree(view);
+    return NULL;
+  }
+
   // Set data pointer
-  view->data = (void*)((uintptr_t)tensor->data + (offset * tensor->elem_size));
+  view->data = (void*)((uintptr_t)tensor->data + ((offset * tensor->elem_bits) / 8));
 
   return view;
 }
 
+/**
+ * @brief Get the number of page colours of the last level data cache
+ * 
+ * @return uint32_t Number of colours (1 if colouring is not possible)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t ai_memory_get_colour_count()
+{
+  return ai_mem_pool.colour_count ? ai_mem_pool.colour_count : 1;
+}
+
+/**
+ * @brief Get the cache colour of an address
+ * 
+ * @param ptr Address to check
+ * @return uint32_t Page colour of the address
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t ai_memory_get_colour(void* ptr)
+{
+  return ((uintptr_t)ptr / PAGE_SIZE) % ai_memory_get_colour_count();
+}
+
+/**
+ * @brief Initialize a tensor arena for tensors used at the same time
+ * 
+ * @param arena Arena to initialize
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void ai_tensor_arena_init(ai_tensor_arena_t* arena)
+{
+  if (!arena)
+  {
+    return;
+  }
+
+  // Start where the global rotation is so arenas spread over the cache
+  arena->next_colour = ai_mem_pool.next_colour % ai_memory_get_colour_count();
+  arena->colours_used = 0;
+}
+
+/**
+ * @brief Create a tensor in an arena, its colours never overlap with the
+ * tensors previously created in the same arena. Once the arena has used
+ * every colour, further tensors are created without a colour
+ * 
+ * @param arena Arena the tensor belongs to
+ * @param shape Pointer to the shape array
+ * @param ndim Number of dimensions
+ * @param dtype Data type of the tensor elements
+ * @param layout Memory layout of the tensor
+ * @param flags Allocation flags
+ * @return tensor_t* Pointer to the created tensor, or NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+tensor_t* ai_tensor_arena_create(ai_tensor_arena_t* arena, size_t* shape, size_t ndim, tensor_dtype_t dtype, tensor_layout_t layout, uint32_t flags)
+{
+  if (!arena || !shape || ndim == 0 || dtype >= TENSOR_TYPE_COUNT)
+  {
+    return NULL;
+  }
+
+  uint32_t colours = ai_memory_get_colour_count();
+
+  // Number of pages (colours) the tensor data covers
+  size_t total_elems = 1;
+  for (size_t i = 0; i < ndim; i++)
+  {
+    total_elems *= shape[i];
+  }
+  size_t pages = (ai_tensor_elems_to_bytes(dtype, total_elems) + PAGE_SIZE - 1) / PAGE_SIZE;
+
+  // Every colour is taken, a reused one would overlap an earlier tensor
+  if ((size_t)arena->colours_used + pages > colours)
+  {
+    arena->colours_used = colours;
+    return ai_tensor_create_coloured(shape, ndim, dtype, layout, flags, AI_MEMORY_COLOUR_NONE);
+  }
+
+  uint32_t colour = arena->next_colour;
+  tensor_t* tensor = ai_tensor_create_coloured(shape, ndim, dtype, layout, flags, colour);
+  if (!tensor)
+  {
+    return NULL;
+  }
+
+  // Next tensor starts on the first colour this one does not cover
+  arena->next_colour = (colour + pages) % colours;
+  arena->colours_used += pages;
+
+  return tensor;
+}
+
+/**
+ * @brief Clear free small blocks ahead of zeroed allocations, called by
+ * the zero pool worker
+ * 
+ * @param max_blocks Most blocks to clear
+ * @return size_t Blocks cleared, 0 once every free block holds zeros
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t ai_memory_zero_free_blocks(size_t max_blocks)
+{
+  size_t cleared = 0;
+  if (!ai_mem_pool.small_block_zero_bitmap || ai_mem_pool.small_block_count == 0)
+  {
+    return 0;
+  }
+
+  // Blocks are 64 bytes, a batch is cleared without dropping the lock
+  uint64_t flags = spin_lock_irqsave(&ai_mem_pool.lock);
+  for (size_t scanned = 0; scanned < ai_mem_pool.small_block_count && cleared < max_blocks; scanned++)
+  {
+    size_t i = ai_mem_pool.small_block_zero_cursor;
+    ai_mem_pool.small_block_zero_cursor = (i + 1) % ai_mem_pool.small_block_count;
+
+    size_t byte_idx = i / 64;
+    uint64_t bit = 1ULL << (i % 64);
+    if ((ai_mem_pool.small_block_bitmap[byte_idx] | ai_mem_pool.small_block_zero_bitmap[byte_idx]) & bit)
+    {
+      continue;
+    }
+
+    zero_pool_clear((uint8_t*)ai_mem_pool.small_block_pool + (i * AI_MEMORY_MIN_BLOCK_SIZE), AI_MEMORY_MIN_BLOCK_SIZE);
+    ai_mem_pool.small_block_zero_bitmap[byte_idx] |= bit;
+    cleared++;
+  }
+  spin_unlock_irqrestore(&ai_mem_pool.lock, flags);
+
+  return cleared;
+}
+
 /**
  * @brief Print AI memory pool statistics
  * 
@@ -1121,10 +1941,17 @@ void ai_memory_print_stats()
   uart_send_string(" KB\n  Peak usage: ");
   uart_send_string(uint_to_str(ai_mem_pool.peak_usage / 1024));
   uart_send_string(" KB\n  Allocations: ");
-  uart_send_string(uint_to_str(ai_mem_pool.allocations));
+  uart_send_string(uint_to_str(percpu_counter_sum(&ai_memory_allocations)));
   uart_send_string("\n  Deallocations: ");
-  uart_send_string(uint_to_str(ai_mem_pool.deallocations));
-  uart_send_string("\n  Small blocks: ");
+  uart_send_string(uint_to_str(percpu_counter_sum(&ai_memory_deallocations)));
+  uart_send_string("\n  Coloured allocations: ");
+  uart_send_string(uint_to_str(percpu_counter_sum(&ai_memory_coloured_allocations)));
+  uart_send_string(" (");
+  uart_send_string(uint_to_str(ai_mem_pool.colour_count));
+  uart_send_string(" colours)");
+  uart_send_string("\n  Reclaimed under pressure: ");
+  uart_send_string(uint_to_str(ai_mem_pool.reclaimed_size / 1024));
+  uart_send_string(" KB\n  Small blocks: ");
   uart_send_string(uint_to_str(ai_mem_pool.small_block_count));
   uart_send_string(" total, ");
 
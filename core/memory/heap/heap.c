@@ -5,7 +5,7 @@
  *
  * Author: Fedi Nabli
  * Date: 4 Mar 2025
- * Last Modified: 5 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "heap.h"
@@ -83,7 +83,8 @@ static int heap_get_start_block(struct heap* heap, uint32_t total_blocks)
     }
   }
 
-  if (bs == -1)
+  // A run at the end of the table may be too short
+  if (bs == -1 || bc != total_blocks)
   {
     return -ENOMEM;
   }
@@ -91,6 +92,32 @@ static int heap_get_start_block(struct heap* heap, uint32_t total_blocks)
   return bs;
 }
 
+static int heap_get_start_block_coloured(struct heap* heap, uint32_t total_blocks, uint32_t colour, uint32_t colours)
+{
+  struct heap_table* table = heap->table;
+
+  // Colour of block 0, the heap start is block aligned
+  uint32_t base_colour = ((uintptr_t)heap->saddr / KERNEL_HEAP_BLOCK_SIZE) % colours;
+  size_t first = (colour + colours - base_colour) % colours;
+
+  // Only runs starting on a block of the requested colour are candidates
+  for (size_t bs = first; bs + total_blocks <= table->total; bs += colours)
+  {
+    uint32_t bc = 0;
+    while (bc < total_blocks && heap_get_entry_type(table->entries[bs + bc]) == HEAP_BLOCK_TABLE_ENTRY_FREE)
+    {
+      bc++;
+    }
+
+    if (bc == total_blocks)
+    {
+      return bs;
+    }
+  }
+
+  return -ENOMEM;
+}
+
 static void* heap_block_to_address(struct heap* heap, int start_block)
 {
   return heap->saddr + (start_block * KERNEL_HEAP_BLOCK_SIZE);
@@ -106,6 +133,8 @@ static void heap_mark_blocks_taken(struct heap* heap, int start_block, uint32_t
     entry |= HEAP_BLOCK_HAS_NEXT;
   }
 
+  heap->used_blocks += total_blocks;
+
   for (int i = start_block; i <= end_block; i++)
   {
     heap->table->entries[i] = entry;
@@ -147,6 +176,10 @@ static void heap_mark_blocks_free(struct heap* heap, int start_block)
   for (int i = start_block; i < (int)table->total; i++)
   {
     HEAP_BLOCK_TABLE_ENTRY entry = table->entries[i];
+    if (heap_get_entry_type(entry) == HEAP_BLOCK_TABLE_ENTRY_TAKEN)
+    {
+      heap->used_blocks--;
+    }
     table->entries[i] = HEAP_BLOCK_TABLE_ENTRY_FREE;
     if (!(entry & HEAP_BLOCK_HAS_NEXT))
     {
@@ -169,29 +202,61 @@ static void heap_mark_blocks_free(struct heap* heap, int start_block)
  */
 int heap_create(struct heap* heap, void* ptr, void* end, struct heap_table* table)
 {
-  int res = 0;
+  int res = heap_create_uncleared(heap, ptr, end, table);
+  if (res < 0)
+  {
+    goto out;
+  }
+
+  heap_table_clear(table, 0, table->total);
 
+out:
+  return res;
+}
+
+/**
+ * @brief Initialize the heap structure like heap_create() but leave the
+ * table as it is, the caller clears it with heap_table_clear() before the
+ * first allocation
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param heap a pointer to the create structure
+ * @param ptr the start address of the heap
+ * @param end the end address of the heap
+ * @param table the pointer to the heap table containing entries and the total size
+ * @return 0 if operation successfull and negative if there was an error
+ */
+int heap_create_uncleared(struct heap* heap, void* ptr, void* end, struct heap_table* table)
+{
   if (!heap_validate_alignment(ptr) || !heap_validate_alignment(end))
   {
-    res = -EINVARG;
-    goto out;
+    return -EINVARG;
   }
 
   memset(heap, 0, sizeof(struct heap));
   heap->saddr = ptr;
   heap->table = table;
+  spin_lock_init(&heap->lock);
 
-  res = heap_validate_table(ptr, end, table);
-  if (res < 0)
-  {
-    goto out;
-  }
-
-  size_t table_size = sizeof(HEAP_BLOCK_TABLE_ENTRY) * table->total;
-  memset(table->entries, HEAP_BLOCK_TABLE_ENTRY_FREE, table_size);
+  return heap_validate_table(ptr, end, table);
+}
 
-out:
-  return res;
+/**
+ * @brief Mark a range of table entries free, disjoint ranges may be
+ * cleared by different CPUs at the same time
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param table the heap table
+ * @param first first entry
+ * @param count number of entries
+ */
+void heap_table_clear(struct heap_table* table, size_t first, size_t count)
+{
+  memset(&table->entries[first], HEAP_BLOCK_TABLE_ENTRY_FREE, count * sizeof(HEAP_BLOCK_TABLE_ENTRY));
 }
 
 /**
@@ -208,7 +273,146 @@ void* heap_malloc(struct heap* heap, size_t size)
 {
   size_t aligned_size = heap_align_value_to_upper(size);
   uint32_t total_blocks = aligned_size / KERNEL_HEAP_BLOCK_SIZE;
-  return heap_malloc_blocks(heap, total_blocks);
+
+  uint64_t flags = spin_lock_irqsave(&heap->lock);
+  void* address = heap_malloc_blocks(heap, total_blocks);
+  spin_unlock_irqrestore(&heap->lock, flags);
+
+  return address;
+}
+
+/**
+ * @brief Allocates memory on the heap whose first block has the requested
+ * cache colour (block index modulo number of colours)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param heap pointer to the kernel heap
+ * @param size requested size
+ * @param colour requested colour of the first block
+ * @param colours total number of colours
+ * @return void* address of the starting block (memory address)
+ */
+void* heap_malloc_coloured(struct heap* heap, size_t size, uint32_t colour, uint32_t colours)
+{
+  if (colours <= 1)
+  {
+    return heap_malloc(heap, size);
+  }
+
+  size_t aligned_size = heap_align_value_to_upper(size);
+  uint32_t total_blocks = aligned_size / KERNEL_HEAP_BLOCK_SIZE;
+
+  void* address = NULL;
+  uint64_t flags = spin_lock_irqsave(&heap->lock);
+
+  int start_block = heap_get_start_block_coloured(heap, total_blocks, colour % colours, colours);
+  if (start_block >= 0)
+  {
+    heap_mark_blocks_taken(heap, start_block, total_blocks);
+    address = heap_block_to_address(heap, start_block);
+  }
+
+  spin_unlock_irqrestore(&heap->lock, flags);
+  return address;
+}
+
+/**
+ * @brief Marks the blocks covering a memory range as taken for good,
+ * so the heap never hands out memory owned by someone else
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param heap pointer to the kernel heap
+ * @param ptr start of the range
+ * @param size size of the range in bytes
+ * @return int 0 on success, -EINUSE if part of the range is allocated
+ */
+int heap_reserve(struct heap* heap, void* ptr, size_t size)
+{
+  void* heap_end = heap->saddr + (heap->table->total * KERNEL_HEAP_BLOCK_SIZE);
+  void* end = ptr + size;
+
+  // Only the part of the range inside the heap matters
+  if (size == 0 || end <= heap->saddr || ptr >= heap_end)
+  {
+    return 0;
+  }
+
+  int start_block = ptr > heap->saddr ? heap_address_to_block(heap, ptr) : 0;
+  int end_block = end < heap_end ? heap_address_to_block(heap, end - 1) : (int)heap->table->total - 1;
+  int res = 0;
+
+  uint64_t flags = spin_lock_irqsave(&heap->lock);
+  for (int i = start_block; i <= end_block; i++)
+  {
+    if (heap_get_entry_type(heap->table->entries[i]) == HEAP_BLOCK_TABLE_ENTRY_TAKEN)
+    {
+      res = -EINUSE;
+      goto out;
+    }
+  }
+
+  heap_mark_blocks_taken(heap, start_block, (end_block - start_block) + 1);
+
+out:
+  spin_unlock_irqrestore(&heap->lock, flags);
+  return res;
+}
+
+/**
+ * @brief Returns the size of the allocation starting at ptr
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param heap pointer to the kernel heap
+ * @param ptr address to check
+ * @return size_t size in bytes, 0 if ptr is not the start of an allocation
+ */
+size_t heap_allocation_size(struct heap* heap, void* ptr)
+{
+  if (ptr < heap->saddr || !heap_validate_alignment(ptr))
+  {
+    return 0;
+  }
+
+  size_t block = heap_address_to_block(heap, ptr);
+  if (block >= heap->table->total)
+  {
+    return 0;
+  }
+
+  size_t blocks = 0;
+  uint64_t flags = spin_lock_irqsave(&heap->lock);
+  if (heap->table->entries[block] & HEAP_BLOCK_IS_FIRST)
+  {
+    blocks = 1;
+    while (heap->table->entries[block] & HEAP_BLOCK_HAS_NEXT)
+    {
+      block++;
+      blocks++;
+    }
+  }
+  spin_unlock_irqrestore(&heap->lock, flags);
+
+  return blocks * KERNEL_HEAP_BLOCK_SIZE;
+}
+
+/**
+ * @brief Returns the number of free bytes in the heap
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param heap pointer to the kernel heap
+ * @return size_t free bytes
+ */
+size_t heap_free_size(struct heap* heap)
+{
+  return (heap->table->total - heap->used_blocks) * KERNEL_HEAP_BLOCK_SIZE;
 }
 
 /**
@@ -222,5 +426,7 @@ void* heap_malloc(struct heap* heap, size_t size)
  */
 void heap_free(struct heap* heap, void* ptr)
 {
+  uint64_t flags = spin_lock_irqsave(&heap->lock);
   heap_mark_blocks_free(heap, heap_address_to_block(heap, ptr));
+  spin_unlock_irqrestore(&heap->lock, flags);
 }
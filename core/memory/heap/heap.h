@@ -4,13 +4,14 @@
  *
  * Author: Fedi Nabli
  * Date: 3 Mar 2025
- * Last Modified: 5 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_MEMORY_HEAP_H_
 #define __SYNAPSE_MEMORY_HEAP_H_
 
 #include <synapse/types.h>
+#include <synapse/sync/spinlock.h>
 
 #define HEAP_BLOCK_TABLE_ENTRY_FREE 0x00
 #define HEAP_BLOCK_TABLE_ENTRY_TAKEN 0x01
@@ -32,6 +33,10 @@ struct heap
   struct heap_table* table;
   // start address of the heap
   void* saddr;
+  // number of blocks currently taken
+  size_t used_blocks;
+  // serializes the block table between CPUs and IRQ handlers
+  spinlock_t lock;
 };
 
 /**
@@ -45,6 +50,35 @@ struct heap
  */
 int heap_create(struct heap* heap, void* ptr, void* end, struct heap_table* table);
 
+/**
+ * @brief Initialize the heap structure like heap_create() but leave the
+ * table as it is, the caller clears it with heap_table_clear() before the
+ * first allocation
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param heap a pointer to the create structure
+ * @param ptr the start address of the heap
+ * @param end the end address of the heap
+ * @param table the pointer to the heap table containing entries and the total size
+ * @return 0 if operation successfull and negative if there was an error
+ */
+int heap_create_uncleared(struct heap* heap, void* ptr, void* end, struct heap_table* table);
+
+/**
+ * @brief Mark a range of table entries free, disjoint ranges may be
+ * cleared by different CPUs at the same time
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param table the heap table
+ * @param first first entry
+ * @param count number of entries
+ */
+void heap_table_clear(struct heap_table* table, size_t first, size_t count);
+
 /**
  * @brief Allocates memory on the heap from the requested size aligned to 4KB
  * 
@@ -57,6 +91,58 @@ int heap_create(struct heap* heap, void* ptr, void* end, struct heap_table* tabl
  */
 void* heap_malloc(struct heap* heap, size_t size);
 
+/**
+ * @brief Allocates memory on the heap whose first block has the requested
+ * cache colour (block index modulo number of colours)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param heap pointer to the kernel heap
+ * @param size requested size
+ * @param colour requested colour of the first block
+ * @param colours total number of colours
+ * @return void* address of the starting block (memory address)
+ */
+void* heap_malloc_coloured(struct heap* heap, size_t size, uint32_t colour, uint32_t colours);
+
+/**
+ * @brief Marks the blocks covering a memory range as taken for good,
+ * so the heap never hands out memory owned by someone else
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param heap pointer to the kernel heap
+ * @param ptr start of the range
+ * @param size size of the range in bytes
+ * @return int 0 on success, -EINUSE if part of the range is allocated
+ */
+int heap_reserve(struct heap* heap, void* ptr, size_t size);
+
+/**
+ * @brief Returns the size of the allocation starting at ptr
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param heap pointer to the kernel heap
+ * @param ptr address to check
+ * @return size_t size in bytes, 0 if ptr is not the start of an allocation
+ */
+size_t heap_allocation_size(struct heap* heap, void* ptr);
+
+/**
+ * @brief Returns the number of free bytes in the heap
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param heap pointer to the kernel heap
+ * @return size_t free bytes
+ */
+size_t heap_free_size(struct heap* heap);
+
 /**
  * @brief Frees memory previously allocated by heap_malloc
  * 
@@ -4,7 +4,7 @@
  *
  * Author: Fedi Nabli
  * Date: 5 Mar 2025
- * Last Modified: 27 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "kheap.h"
@@ -14,6 +14,9 @@
 
 #include <kernel/config.h>
 #include <synapse/memory/memory.h>
+#include <synapse/memory/pressure/pressure.h>
+#include <synapse/memory/zero_pool/zero_pool.h>
+#include <synapse/scheduler/preempt.h>
 
 struct heap kernel_heap;
 struct heap_table kernel_heap_table;
@@ -22,7 +25,8 @@ extern char _end;
 
 /**
  * @brief Initializes the kernel heap with dynamic size based on
- * available RAM
+ * available RAM. Its table is cleared by kheap_clear_table() before the
+ * first allocation, in parts if several CPUs share the work
  * 
  * @author Fedi Nabli
  * @date 6 Mar 2025
@@ -60,7 +64,7 @@ void kheap_init(size_t ram_size)
 
   // Create the heap
   void* heap_end_addr = (void*)((size_t)heap_start_addr + target_heap_size);
-  int res = heap_create(&kernel_heap, heap_start_addr, heap_end_addr, &kernel_heap_table);
+  int res = heap_create_uncleared(&kernel_heap, heap_start_addr, heap_end_addr, &kernel_heap_table);
 
   if (res < 0)
   {
@@ -69,6 +73,28 @@ void kheap_init(size_t ram_size)
   }
 }
 
+/**
+ * @brief Clear one part of the kernel heap table, every part must be
+ * cleared before the first allocation
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param part part to clear, below parts
+ * @param parts number of equal parts the table is split in
+ */
+void kheap_clear_table(uint32_t part, uint32_t parts)
+{
+  if (parts == 0 || part >= parts)
+  {
+    return;
+  }
+
+  size_t first = (kernel_heap_table.total * part) / parts;
+  size_t end = (kernel_heap_table.total * (part + 1)) / parts;
+  heap_table_clear(&kernel_heap_table, first, end - first);
+}
+
 /**
  * @brief Allocated requested amount in the memory
  * and returns the address
@@ -81,11 +107,20 @@ void kheap_init(size_t ram_size)
  */
 void* kmalloc(size_t size)
 {
-  return heap_malloc(&kernel_heap, size);
+  void* ptr = heap_malloc(&kernel_heap, size);
+  if (!ptr && memory_pressure_reclaim(size) > 0)
+  {
+    // Shrinkers released cached memory, try once more
+    ptr = heap_malloc(&kernel_heap, size);
+  }
+
+  memory_pressure_update(heap_free_size(&kernel_heap));
+  return ptr;
 }
 
 /**
- * @brief Allocates memory and initializes it to zero
+ * @brief Allocates memory and initializes it to zero. Sizes the zero pool
+ * keeps are taken from it, others are cleared here
  * 
  * @param size Amount of memory needed in bytes
  * @return void* Start address of the zero-initialized memory allocated
@@ -95,11 +130,46 @@ void* kmalloc(size_t size)
  */
 void* kzalloc(size_t size)
 {
-  void* ptr = kmalloc(size);
+  void* ptr = zero_pool_alloc(size);
+  if (ptr)
+    return ptr;
+
+  ptr = kmalloc(size);
   if (!ptr)
     return NULL;
 
-  memset(ptr, 0x00, size);
+  // Clear large allocations with preemption points in between
+  for (size_t offset = 0; offset < size; offset += PREEMPT_CHUNK_SIZE)
+  {
+    size_t remaining = size - offset;
+    zero_pool_clear((uint8_t*)ptr + offset, remaining < PREEMPT_CHUNK_SIZE ? remaining : PREEMPT_CHUNK_SIZE);
+    cond_resched();
+  }
+
+  return ptr;
+}
+
+/**
+ * @brief Allocates page aligned memory whose first page has the requested
+ * cache colour, used to keep concurrently used buffers in different cache sets
+ * 
+ * @param size Amount of memory needed in bytes
+ * @param colour Requested colour of the first page
+ * @param colours Number of page colours of the cache
+ * @return void* Start address of the memory allocated
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* kmalloc_coloured(size_t size, uint32_t colour, uint32_t colours)
+{
+  void* ptr = heap_malloc_coloured(&kernel_heap, size, colour, colours);
+  if (!ptr && memory_pressure_reclaim(size) > 0)
+  {
+    ptr = heap_malloc_coloured(&kernel_heap, size, colour, colours);
+  }
+
+  memory_pressure_update(heap_free_size(&kernel_heap));
   return ptr;
 }
 
@@ -114,4 +184,50 @@ void* kzalloc(size_t size)
 void kfree(void* ptr)
 {
   heap_free(&kernel_heap, ptr);
+  memory_pressure_update(heap_free_size(&kernel_heap));
+}
+
+/**
+ * @brief Returns the number of free bytes in the kernel heap
+ * 
+ * @return size_t Free bytes
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t kheap_get_free_size()
+{
+  return heap_free_size(&kernel_heap);
+}
+
+/**
+ * @brief Keeps the kernel heap away from a memory range owned by
+ * someone else (boot modules, device tree...)
+ * 
+ * @param ptr Start of the range
+ * @param size Size of the range in bytes
+ * @return int EOK on success, -EINUSE if part of the range is allocated
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int kheap_reserve(void* ptr, size_t size)
+{
+  int res = heap_reserve(&kernel_heap, ptr, size);
+  memory_pressure_update(heap_free_size(&kernel_heap));
+  return res;
+}
+
+/**
+ * @brief Returns the size of the kernel heap allocation starting at ptr
+ * 
+ * @param ptr Start address of the allocation
+ * @return size_t Size in bytes, 0 if ptr is not the start of an allocation
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t kheap_allocation_size(void* ptr)
+{
+  return heap_allocation_size(&kernel_heap, ptr);
 }
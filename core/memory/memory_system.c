@@ -1,16 +1,18 @@
 /*
  * memory_system.c - This file implements different methods related to
  * the memory system management. It initializes and tests all important
- * memory components.
+ * memory components, the tests of the other subsystems live next to
+ * their code.
  *
  * Author: Fedi Nabli
  * Date: 21 Mar 2025
- * Last Modified: 26 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "memory_system.h"
 
 #include <uart.h>
+#include <pmu.h>
 
 #include <synapse/bool.h>
 #include <synapse/types.h>
@@ -18,65 +20,156 @@
 
 #include <kernel/config.h>
 
+#include <synapse/fdt/fdt.h>
+#include <synapse/string/string.h>
 #include <synapse/memory/memory.h>
 #include <synapse/memory/heap/kheap.h>
 #include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/memory/pressure/pressure.h>
+#include <synapse/memory/zero_pool/zero_pool.h>
 
 // Global memory regions array
 static mem_system_region_t memory_regions[MAX_MEMORY_REGIONS];
 static size_t num_memory_regions = 0;
 
-// Temporary buffer for early boot string operations
-static char temp_str_buffer[32];
+// Memory pressure test configuration
+#define PRESSURE_TEST_PID (SYNAPSE_MAX_PROCESSES - 1)
+#define PRESSURE_TEST_CACHE_SIZE (4 * KERNEL_HEAP_BLOCK_SIZE)
 
-// Convert a number to a string for UART output
-static char* uint_to_str(uint64_t value)
-{
-  int i = 0;
-  char* p = temp_str_buffer;
+// Page colouring benchmark configuration
+#define COLOUR_BENCH_PANELS 20 // More than the 16 L2 ways
+#define COLOUR_BENCH_REPEATS 32
 
-  do
+/**
+ * @brief Register a memory region for tracking
+ * 
+ * @param name Region name
+ * @param start Physical start address
+ * @param size Region size in bytes
+ * @param type Region type
+ * @return int EOK on success, -ENOMEM if the region table is full
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int memory_register_region(const char* name, uintptr_t start, size_t size, mem_region_type_t type)
+{
+  if (num_memory_regions >= MAX_MEMORY_REGIONS)
   {
-    temp_str_buffer[i++] = '0' + (value % 10);
-    value /= 10;
-  } while (value > 0 && i < 31);
-  
-  temp_str_buffer[i] = '\0';
+    return -ENOMEM;
+  }
+
+  // Identity mapped, the MMU is off
+  mem_system_region_t* region = &memory_regions[num_memory_regions++];
+  region->phys_start = start;
+  region->phys_end = start + size;
+  region->virt_start = start;
+  region->size = size;
+  region->type = type;
+  strncpy(region->name, name, sizeof(region->name) - 1);
+  region->name[sizeof(region->name) - 1] = '\0';
+
+  return EOK;
+}
 
-  // Reverse the string
-  int j = 0;
-  i--;
-  while (j < i)
+/**
+ * @brief Register a reserved region and keep the heap away from it
+ * 
+ * @param name Region name
+ * @param start Physical start address
+ * @param size Region size in bytes
+ * @return int EOK on success, -EINUSE if part of the range is allocated
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int memory_reserve_region(const char* name, uintptr_t start, size_t size)
+{
+  // The device tree may list the same range twice (e.g. /memreserve/ and initrd)
+  for (size_t i = 0; i < num_memory_regions; i++)
   {
-    char temp = p[j];
-    p[j] = p[i];
-    p[i] = temp;
-    j++;
-    i--;
+    mem_system_region_t* region = &memory_regions[i];
+    if (region->type == MEM_REGION_TYPE_RESERVED && start >= region->phys_start && start + size <= region->phys_end)
+    {
+      return EOK;
+    }
   }
 
-  return temp_str_buffer;
+  memory_register_region(name, start, size, MEM_REGION_TYPE_RESERVED);
+  return kheap_reserve((void*)start, size);
 }
 
 /**
- * @brief Initialize the complete memory system
+ * @brief Register the regions described by the device tree and keep the
+ * heap away from the reserved ones
  * 
- * This function initializes the entire memory system, including the kernel heap,
- * and AI memory subsystem. It also
- * registers memory regions for tracking and creates necessary identity mappings.
+ * @param kernel_start The start address of the kernel in physical memory
+ * @param kernel_end The end address of the kernel in physical memory
+ * @return int EOK on success, -EINUSE if a reserved range is already allocated
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int memory_register_platform(uintptr_t kernel_start, uintptr_t kernel_end)
+{
+  const fdt_platform_t* platform = fdt_get_platform();
+  int res = EOK;
+
+  for (uint32_t i = 0; i < platform->memory_count; i++)
+  {
+    memory_register_region("RAM", platform->memory[i].base, platform->memory[i].size, MEM_REGION_TYPE_RAM);
+  }
+
+  memory_register_region("Kernel", kernel_start, kernel_end - kernel_start, MEM_REGION_TYPE_KERNEL);
+
+  // Boot modules and firmware memory are used in place
+  for (uint32_t i = 0; i < platform->reserved_count; i++)
+  {
+    if (memory_reserve_region("Reserved", platform->reserved[i].base, platform->reserved[i].size) < 0)
+    {
+      res = -EINUSE;
+    }
+  }
+
+  if (fdt_present() && memory_reserve_region("Device tree", (uintptr_t)fdt_get_blob(), fdt_get_size()) < 0)
+  {
+    res = -EINUSE;
+  }
+
+  if (platform->initrd_end > platform->initrd_start &&
+      memory_reserve_region("initrd", platform->initrd_start, platform->initrd_end - platform->initrd_start) < 0)
+  {
+    res = -EINUSE;
+  }
+
+  // Device registers
+  memory_register_region("GIC distributor", platform->gicd_base, 0x10000, MEM_REGION_TYPE_MMIO);
+  memory_register_region("GIC CPU interface", platform->gicc_base, 0x10000, MEM_REGION_TYPE_MMIO);
+  memory_register_region("UART", platform->uart_base, 0x1000, MEM_REGION_TYPE_DEVICE);
+  if (platform->virtio_count > 0)
+  {
+    uintptr_t virtio_start = platform->virtio[0].base;
+    uintptr_t virtio_end = platform->virtio[platform->virtio_count - 1].base + 0x200;
+    memory_register_region("virtio-mmio", virtio_start, virtio_end - virtio_start, MEM_REGION_TYPE_MMIO);
+  }
+
+  return res;
+}
+
+/**
+ * @brief Lay the kernel heap out after the kernel. Its table is cleared
+ * with kheap_clear_table() next, then memory_system_claim_reserved()
+ * makes it usable
  * 
  * @param ram_size The total size of the RAM in bytes
  * @param kernel_start The start address of the kernel in physical memory
  * @param kernel_end The end address of the kernel in physical memory
- * @return int Returns EOK on success, or a negative error code on failure
  * 
  * @author Fedi Nabli
  * @date 21 Mar 2025
  */
-int memory_system_init(size_t ram_size, uintptr_t kernel_start, uintptr_t kernel_end)
+void memory_system_init_heap(size_t ram_size, uintptr_t kernel_start, uintptr_t kernel_end)
 {
-  int res;
-
   uart_send_string("Initializing memory system...\n");
   uart_send_string("RAM size: ");
   uart_send_string(uint_to_str(ram_size / (1024 * 1024)));
@@ -91,15 +184,61 @@ int memory_system_init(size_t ram_size, uintptr_t kernel_start, uintptr_t kernel
   // Step 1: Initialize basic kernel heap
   uart_send_string("Initializing kernel heap...\n");
   kheap_init(ram_size);
+}
+
+/**
+ * @brief Set the memory pressure watermarks and claim the reserved ranges
+ * of the platform, once the heap table is cleared. The heap may be used
+ * afterwards
+ * 
+ * @param kernel_start The start address of the kernel in physical memory
+ * @param kernel_end The end address of the kernel in physical memory
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_system_claim_reserved(uintptr_t kernel_start, uintptr_t kernel_end)
+{
   uart_send_string("Heap initialized!\n");
 
+  // Watermarks are relative to the heap, which is still empty here
+  int res = memory_pressure_init(kheap_get_free_size());
+  if (res < 0)
+  {
+    uart_send_string("Failed to initialize memory pressure\n");
+    return res;
+  }
+
+  // Reserved ranges must be claimed before anything else allocates
+  res = memory_register_platform(kernel_start, kernel_end);
+  if (res < 0)
+  {
+    uart_send_string("Reserved memory overlaps kernel heap allocations\n");
+    return res;
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Fill the AI memory pool from the kernel heap
+ * 
+ * @param ram_size The total size of the RAM in bytes
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_system_init_ai(size_t ram_size)
+{
   // Step 6: Initialize AI memory subsystem
   size_t ai_pool_size = ram_size / AI_MEMORY_POOL_RATIO;
   uart_send_string("Initializing AI memory with ");
   uart_send_string(uint_to_str(ai_pool_size / (1024 * 1024)));
   uart_send_string(" MB pool...\n");
 
-  res = ai_memory_init(ai_pool_size);
+  int res = ai_memory_init(ai_pool_size);
   if (res < 0)
   {
     uart_send_string("Failed to initialize AI memory\n");
@@ -256,6 +395,394 @@ int memory_test_ai_memory()
   return EOK;
 }
 
+/**
+ * @brief Walk all panels line by line, the pattern of a blocked GEMM
+ * reading one row from every panel in turn
+ * 
+ * @param panels Array of tensors to walk
+ * @param l1_refills Output for L1D refills
+ * @param l2_refills Output for L2 refills
+ * @return uint64_t Cycles spent
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint64_t memory_bench_walk_panels(tensor_t** panels, uint64_t* l1_refills, uint64_t* l2_refills)
+{
+  volatile uint64_t sum = 0;
+
+  pmu_reset_counters();
+  uint64_t start = pmu_read_cycles();
+
+  for (size_t rep = 0; rep < COLOUR_BENCH_REPEATS; rep++)
+  {
+    for (size_t line = 0; line < PAGE_SIZE; line += 64)
+    {
+      for (size_t p = 0; p < COLOUR_BENCH_PANELS; p++)
+      {
+        sum += *(volatile uint64_t*)((uintptr_t)panels[p]->data + line);
+      }
+    }
+  }
+
+  uint64_t cycles = pmu_read_cycles() - start;
+  *l1_refills = pmu_read_counter(0);
+  *l2_refills = pmu_read_counter(1);
+
+  return cycles;
+}
+
+/**
+ * @brief Print one benchmark result line
+ * 
+ * @param name Name of the run
+ * @param cycles Cycles spent
+ * @param l1_refills L1D refills
+ * @param l2_refills L2 refills
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void memory_bench_print(const char* name, uint64_t cycles, uint64_t l1_refills, uint64_t l2_refills)
+{
+  uart_send_string(name);
+  uart_send_string(": cycles=");
+  uart_send_string(uint_to_str(cycles));
+  uart_send_string(" L1D refills=");
+  uart_send_string(uint_to_str(l1_refills));
+  uart_send_string(" L2 refills=");
+  uart_send_string(uint_to_str(l2_refills));
+  uart_send_string("\n");
+}
+
+/**
+ * @brief Benchmark cache conflict misses of aliased vs coloured tensors
+ * 
+ * Every panel is one page. In the aliased run all panels have the same
+ * colour and compete for the same sets, in the coloured run the tensor
+ * arena spreads them over all colours.
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_bench_page_colouring()
+{
+  uart_send_string("\n=== Page Colouring Benchmark ===\n");
+
+  tensor_t* panels[COLOUR_BENCH_PANELS] = { 0 };
+  size_t shape[1] = { PAGE_SIZE / sizeof(uint32_t) };
+  uint64_t l1_refills, l2_refills, cycles;
+  int res = EOK;
+
+  pmu_init();
+  pmu_config_event(0, PMU_EVENT_L1D_CACHE_REFILL);
+  pmu_config_event(1, PMU_EVENT_L2D_CACHE_REFILL);
+
+  // Run 1: every panel on colour 0
+  for (size_t i = 0; i < COLOUR_BENCH_PANELS; i++)
+  {
+    panels[i] = ai_tensor_create_coloured(shape, 1, TENSOR_TYPE_INT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ZEROED, 0);
+    if (!panels[i])
+    {
+      res = -ENOMEM;
+      goto out;
+    }
+  }
+
+  cycles = memory_bench_walk_panels(panels, &l1_refills, &l2_refills);
+  memory_bench_print("Aliased panels", cycles, l1_refills, l2_refills);
+
+  for (size_t i = 0; i < COLOUR_BENCH_PANELS; i++)
+  {
+    ai_tensor_destroy(panels[i]);
+    panels[i] = NULL;
+  }
+
+  // Run 2: panels coloured by a tensor arena
+  ai_tensor_arena_t arena;
+  ai_tensor_arena_init(&arena);
+  for (size_t i = 0; i < COLOUR_BENCH_PANELS; i++)
+  {
+    panels[i] = ai_tensor_arena_create(&arena, shape, 1, TENSOR_TYPE_INT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ZEROED);
+    if (!panels[i])
+    {
+      res = -ENOMEM;
+      goto out;
+    }
+  }
+
+  cycles = memory_bench_walk_panels(panels, &l1_refills, &l2_refills);
+  memory_bench_print("Coloured panels", cycles, l1_refills, l2_refills);
+
+out:
+  for (size_t i = 0; i < COLOUR_BENCH_PANELS; i++)
+  {
+    if (panels[i])
+    {
+      ai_tensor_destroy(panels[i]);
+    }
+  }
+
+  if (res != EOK)
+  {
+    uart_send_string("FAIL: Could not allocate benchmark panels\n");
+  }
+
+  return res;
+}
+
+/**
+ * @brief Test the zero pool: clearing around DC ZVA blocks, zeroed
+ * allocations from the pool and without it, draining, and the cleared
+ * small blocks of the AI pool
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_test_zero_pool()
+{
+  uart_send_string("\n=== Testing Zero Pool ===\n");
+
+  // An unaligned range is cleared exactly, its neighbours are kept
+  uint8_t* buffer = (uint8_t*)kmalloc(2 * KERNEL_HEAP_BLOCK_SIZE);
+  if (!buffer)
+  {
+    uart_send_string("FAIL: Out of memory\n");
+    return -ENOMEM;
+  }
+
+  memset(buffer, 0xAA, 2 * KERNEL_HEAP_BLOCK_SIZE);
+  zero_pool_clear(buffer + 3, KERNEL_HEAP_BLOCK_SIZE + 100);
+  for (size_t i = 0; i < 2 * KERNEL_HEAP_BLOCK_SIZE; i++)
+  {
+    uint8_t expected = i >= 3 && i < 3 + KERNEL_HEAP_BLOCK_SIZE + 100 ? 0 : 0xAA;
+    if (buffer[i] != expected)
+    {
+      uart_send_string("FAIL: Clear out of range\n");
+      kfree(buffer);
+      return -EIO;
+    }
+  }
+  kfree(buffer);
+
+  zero_pool_drain();
+  zero_pool_stats_t before;
+  zero_pool_get_stats(&before);
+
+  if (zero_pool_refill(1) != 1)
+  {
+    uart_send_string("FAIL: Refill\n");
+    return -EIO;
+  }
+
+  // A page sized allocation takes the page just cleared
+  uint8_t* page = (uint8_t*)kzalloc(100);
+  zero_pool_stats_t after;
+  zero_pool_get_stats(&after);
+  if (!page || after.hits[ZERO_POOL_PAGE] != before.hits[ZERO_POOL_PAGE] + 1 || after.level[ZERO_POOL_PAGE] != 0)
+  {
+    uart_send_string("FAIL: Zeroed allocation not taken from the pool\n");
+    kfree(page);
+    return -EIO;
+  }
+
+  bool zeroed = true;
+  for (size_t i = 0; i < KERNEL_HEAP_BLOCK_SIZE; i++)
+  {
+    zeroed = zeroed && page[i] == 0;
+  }
+  memset(page, 0x55, KERNEL_HEAP_BLOCK_SIZE);
+  kfree(page);
+
+  // With the pool empty the allocation is cleared on demand
+  page = (uint8_t*)kzalloc(KERNEL_HEAP_BLOCK_SIZE);
+  zero_pool_get_stats(&after);
+  if (!page || after.misses[ZERO_POOL_PAGE] != before.misses[ZERO_POOL_PAGE] + 1)
+  {
+    uart_send_string("FAIL: Empty pool miss not counted\n");
+    kfree(page);
+    return -EIO;
+  }
+
+  for (size_t i = 0; i < KERNEL_HEAP_BLOCK_SIZE; i++)
+  {
+    zeroed = zeroed && page[i] == 0;
+  }
+  kfree(page);
+
+  if (!zeroed)
+  {
+    uart_send_string("FAIL: Zeroed allocation holds data\n");
+    return -EIO;
+  }
+
+  // Sizes without a class are neither hits nor misses
+  void* other = kzalloc(3 * KERNEL_HEAP_BLOCK_SIZE);
+  zero_pool_stats_t last;
+  zero_pool_get_stats(&last);
+  kfree(other);
+  if (!other || last.hits[ZERO_POOL_PAGE] != after.hits[ZERO_POOL_PAGE] || last.misses[ZERO_POOL_PAGE] != after.misses[ZERO_POOL_PAGE])
+  {
+    uart_send_string("FAIL: Size without a class counted\n");
+    return -EIO;
+  }
+
+  zero_pool_refill(2);
+  if (zero_pool_drain() != 2 * KERNEL_HEAP_BLOCK_SIZE)
+  {
+    uart_send_string("FAIL: Drain\n");
+    return -EIO;
+  }
+
+  // A freed small tensor is cleared ahead of the next zeroed one
+  size_t shape[1] = {4};
+  tensor_t* tensor = ai_tensor_create(shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ZEROED);
+  if (!tensor)
+  {
+    uart_send_string("FAIL: Tensor creation\n");
+    return -ENOMEM;
+  }
+  memset(tensor->data, 0xFF, 4 * sizeof(float));
+  ai_tensor_destroy(tensor);
+
+  if (ai_memory_zero_free_blocks(ZERO_POOL_AI_BATCH) == 0)
+  {
+    uart_send_string("FAIL: No free AI block cleared\n");
+    return -EIO;
+  }
+
+  tensor = ai_tensor_create(shape, 1, TENSOR_TYPE_FLOAT32, TENSOR_LAYOUT_ROW_MAJOR, TENSOR_MEM_ZEROED);
+  if (!tensor)
+  {
+    uart_send_string("FAIL: Tensor creation\n");
+    return -ENOMEM;
+  }
+
+  uint8_t* data = (uint8_t*)tensor->data;
+  for (size_t i = 0; i < 4 * sizeof(float); i++)
+  {
+    zeroed = zeroed && data[i] == 0;
+  }
+  ai_tensor_destroy(tensor);
+
+  if (!zeroed)
+  {
+    uart_send_string("FAIL: Zeroed tensor holds data\n");
+    return -EIO;
+  }
+
+  uart_send_string("Zero pool tests passed\n");
+  return EOK;
+}
+
+// Cache released by the memory pressure test shrinker
+static void* pressure_test_cache = NULL;
+
+static size_t pressure_test_shrink(size_t target, void* private_data)
+{
+  if (!pressure_test_cache)
+  {
+    return 0;
+  }
+
+  kfree(pressure_test_cache);
+  pressure_test_cache = NULL;
+
+  return PRESSURE_TEST_CACHE_SIZE;
+}
+
+/**
+ * @brief Test shrinkers and pressure notifications
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_test_memory_pressure()
+{
+  int res = EOK;
+  size_t low = 0;
+  size_t high = 0;
+
+  uart_send_string("\n=== Testing Memory Pressure ===\n");
+
+  pressure_test_cache = kmalloc(PRESSURE_TEST_CACHE_SIZE);
+  if (!pressure_test_cache)
+  {
+    uart_send_string("FAIL: Test cache allocation failed\n");
+    return -ENOMEM;
+  }
+
+  int id = memory_pressure_register_shrinker("test_cache", pressure_test_shrink, NULL, SHRINKER_PRIORITY_CHEAP);
+  if (id < 0)
+  {
+    uart_send_string("FAIL: Shrinker registration failed\n");
+    kfree(pressure_test_cache);
+    pressure_test_cache = NULL;
+    return id;
+  }
+
+  memory_pressure_subscribe(PRESSURE_TEST_PID);
+  memory_pressure_get_watermarks(&low, &high);
+
+  // Move the high watermark just above the free memory
+  size_t free_size = kheap_get_free_size();
+  memory_pressure_set_watermarks(0, free_size + 1);
+  memory_pressure_update(free_size);
+
+  if (memory_pressure_poll(PRESSURE_TEST_PID) != MEMORY_PRESSURE_MODERATE)
+  {
+    uart_send_string("FAIL: Moderate pressure was not notified\n");
+    res = -EIO;
+    goto out;
+  }
+  uart_send_string("Moderate pressure notified\n");
+
+  // The cheap test cache must satisfy the request on its own
+  size_t released = memory_pressure_reclaim(PRESSURE_TEST_CACHE_SIZE);
+  if (released < PRESSURE_TEST_CACHE_SIZE || pressure_test_cache)
+  {
+    uart_send_string("FAIL: Shrinker did not release the test cache\n");
+    res = -EIO;
+    goto out;
+  }
+
+  if (kheap_get_free_size() != free_size + PRESSURE_TEST_CACHE_SIZE)
+  {
+    uart_send_string("FAIL: Released memory is not back in the heap\n");
+    res = -EIO;
+    goto out;
+  }
+  uart_send_string("Shrinker released ");
+  uart_send_string(uint_to_str(released / 1024));
+  uart_send_string(" KB\n");
+
+out:
+  memory_pressure_set_watermarks(low, high);
+  memory_pressure_update(kheap_get_free_size());
+  memory_pressure_unsubscribe(PRESSURE_TEST_PID);
+  memory_pressure_unregister_shrinker(id);
+
+  if (pressure_test_cache)
+  {
+    kfree(pressure_test_cache);
+    pressure_test_cache = NULL;
+  }
+
+  if (res == EOK)
+  {
+    memory_pressure_print_stats();
+    uart_send_string("Memory pressure tests PASSED\n");
+  }
+
+  return res;
+}
+
 /**
  * @brief Print all registered memory regions
  * 
@@ -296,6 +823,9 @@ void memory_print_regions()
       case MEM_REGION_TYPE_KERNEL:
         uart_send_string("Kernel");
         break;
+      case MEM_REGION_TYPE_RESERVED:
+        uart_send_string("Reserved");
+        break;
       default:
         uart_send_string("Unknown");
         break;
@@ -351,12 +881,25 @@ int memory_run_tests()
     return res;
   }
   
-  // // Test memory regions
-  // res = memory_test_regions();
-  // if (res != EOK) {
-  //   uart_send_string("Memory region tests FAILED\n");
-  //   return res;
-  // }
+  res = memory_test_zero_pool();
+  if (res != EOK) {
+    uart_send_string("Zero pool tests FAILED\n");
+    return res;
+  }
+
+  // Test shrinkers and pressure notifications
+  res = memory_test_memory_pressure();
+  if (res != EOK) {
+    uart_send_string("Memory pressure tests FAILED\n");
+    return res;
+  }
+
+  // Test memory regions
+  res = memory_test_regions();
+  if (res != EOK) {
+    uart_send_string("Memory region tests FAILED\n");
+    return res;
+  }
   
   uart_send_string("\n=== All Memory System Tests PASSED ===\n");
   return EOK;
@@ -0,0 +1,494 @@
+/*
+ * pressure.c - This file implements the memory pressure framework.
+ * Subsystems register shrinkers that release cached memory, allocators
+ * call them before failing and processes get notified on watermarks.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "pressure.h"
+
+#include <uart.h>
+
+#include <kernel/config.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/sync/atomic.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/string/string.h>
+#include <synapse/memory/memory.h>
+
+// Registered shrinker
+struct shrinker
+{
+  char name[32]; // Name of the cache
+  SHRINKER_CALLBACK callback; // Function releasing memory
+  void* private_data; // Data passed to the callback
+  int priority; // SHRINKER_PRIORITY_* value
+  bool registered; // Slot in use
+  size_t released; // Total bytes released by this shrinker
+};
+
+// Memory pressure state
+typedef struct
+{
+  struct shrinker shrinkers[MEMORY_PRESSURE_MAX_SHRINKERS];
+
+  size_t low_watermark; // Free bytes below which the pressure is critical
+  size_t high_watermark; // Free bytes below which the pressure is moderate
+  memory_pressure_level_t level; // Current level
+
+  // Per process notifications
+  bool subscribed[SYNAPSE_MAX_PROCESSES];
+  uint8_t pending[SYNAPSE_MAX_PROCESSES]; // Highest level since last poll
+
+  volatile uint32_t reclaiming; // Set while shrinkers run, avoids recursion from kfree
+
+  // Statistics
+  size_t reclaim_calls; // Number of reclaim passes
+  size_t reclaimed_bytes; // Total bytes released by shrinkers
+  size_t notifications; // Number of level changes notified
+} memory_pressure_t;
+
+static memory_pressure_t mem_pressure;
+
+// Protects the level, the shrinker table and the per process notifications.
+// Never held while a shrinker runs: shrinkers take their own locks and free
+// memory, which calls back into memory_pressure_update()
+static spinlock_t mem_pressure_lock = SPINLOCK_INIT;
+
+/**
+ * @brief Compute the pressure level for an amount of free memory
+ * 
+ * @param free_size Free memory in bytes
+ * @return memory_pressure_level_t Pressure level
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static memory_pressure_level_t memory_pressure_level_for(size_t free_size)
+{
+  if (free_size < mem_pressure.low_watermark)
+  {
+    return MEMORY_PRESSURE_CRITICAL;
+  }
+
+  if (free_size < mem_pressure.high_watermark)
+  {
+    return MEMORY_PRESSURE_MODERATE;
+  }
+
+  return MEMORY_PRESSURE_NONE;
+}
+
+/**
+ * @brief Record a level change for every subscribed process, called with
+ * the pressure lock held
+ * 
+ * @param level New pressure level
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void memory_pressure_notify(memory_pressure_level_t level)
+{
+  mem_pressure.notifications++;
+
+  for (int i = 0; i < SYNAPSE_MAX_PROCESSES; i++)
+  {
+    if (mem_pressure.subscribed[i] && mem_pressure.pending[i] < level)
+    {
+      mem_pressure.pending[i] = level;
+    }
+  }
+}
+
+/**
+ * @brief Initialize the memory pressure framework
+ * 
+ * @param total_size Total size of the kernel heap in bytes
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_init(size_t total_size)
+{
+  if (total_size == 0)
+  {
+    return -EINVARG;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+
+  memset(&mem_pressure, 0, sizeof(memory_pressure_t));
+
+  // Default watermarks: critical under 1/16 free, moderate under 1/8 free
+  mem_pressure.low_watermark = total_size / 16;
+  mem_pressure.high_watermark = total_size / 8;
+  mem_pressure.level = MEMORY_PRESSURE_NONE;
+
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+  return EOK;
+}
+
+/**
+ * @brief Register a shrinker
+ * 
+ * @param name Name of the cache (for statistics)
+ * @param callback Function releasing memory
+ * @param private_data Data passed to the callback
+ * @param priority SHRINKER_PRIORITY_* value
+ * @return int Shrinker ID on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_register_shrinker(const char* name, SHRINKER_CALLBACK callback, void* private_data, int priority)
+{
+  if (!name || !callback || priority < SHRINKER_PRIORITY_CHEAP || priority > SHRINKER_PRIORITY_EXPENSIVE)
+  {
+    return -EINVARG;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+
+  for (int i = 0; i < MEMORY_PRESSURE_MAX_SHRINKERS; i++)
+  {
+    struct shrinker* shrinker = &mem_pressure.shrinkers[i];
+    if (!shrinker->registered)
+    {
+      memset(shrinker, 0, sizeof(struct shrinker));
+      strncpy(shrinker->name, name, sizeof(shrinker->name) - 1);
+      shrinker->callback = callback;
+      shrinker->private_data = private_data;
+      shrinker->priority = priority;
+      shrinker->registered = true;
+      spin_unlock_irqrestore(&mem_pressure_lock, flags);
+      return i;
+    }
+  }
+
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+  return -EPMAX;
+}
+
+/**
+ * @brief Unregister a shrinker
+ * 
+ * @param id Shrinker ID returned on registration
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_unregister_shrinker(int id)
+{
+  if (id < 0 || id >= MEMORY_PRESSURE_MAX_SHRINKERS)
+  {
+    return -EINVARG;
+  }
+
+  int res = EOK;
+  uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+
+  if (!mem_pressure.shrinkers[id].registered)
+  {
+    res = -EINVARG;
+  }
+  else
+  {
+    mem_pressure.shrinkers[id].registered = false;
+  }
+
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+  return res;
+}
+
+/**
+ * @brief Run the shrinkers, cheapest first, until target bytes are released
+ * 
+ * @param target Number of bytes to release
+ * @return size_t Number of bytes released
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t memory_pressure_reclaim(size_t target)
+{
+  if (target == 0)
+  {
+    return 0;
+  }
+
+  // One reclaim pass at a time, a CPU finding one running lets it work
+  if (atomic_cas_32(&mem_pressure.reclaiming, 0, 1) != 0)
+  {
+    return 0;
+  }
+
+  size_t released = 0;
+  for (int priority = SHRINKER_PRIORITY_CHEAP; priority <= SHRINKER_PRIORITY_EXPENSIVE && released < target; priority++)
+  {
+    for (int i = 0; i < MEMORY_PRESSURE_MAX_SHRINKERS && released < target; i++)
+    {
+      struct shrinker* shrinker = &mem_pressure.shrinkers[i];
+
+      uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+      bool run = shrinker->registered && shrinker->priority == priority;
+      SHRINKER_CALLBACK callback = shrinker->callback;
+      void* private_data = shrinker->private_data;
+      spin_unlock_irqrestore(&mem_pressure_lock, flags);
+
+      if (!run)
+      {
+        continue;
+      }
+
+      size_t freed = callback(target - released, private_data);
+      released += freed;
+
+      flags = spin_lock_irqsave(&mem_pressure_lock);
+      shrinker->released += freed;
+      spin_unlock_irqrestore(&mem_pressure_lock, flags);
+    }
+  }
+
+  uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+  mem_pressure.reclaim_calls++;
+  mem_pressure.reclaimed_bytes += released;
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+
+  atomic_store_release_32(&mem_pressure.reclaiming, 0);
+  return released;
+}
+
+/**
+ * @brief Update the pressure level from the current free memory, called by
+ * the allocators after each allocation and free
+ * 
+ * @param free_size Free memory in bytes
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void memory_pressure_update(size_t free_size)
+{
+  // Fast path, nothing to do while above the high watermark. Read without
+  // the lock, a stale level only costs one pass through the slow path
+  if (*(volatile memory_pressure_level_t*)&mem_pressure.level == MEMORY_PRESSURE_NONE && free_size >= mem_pressure.high_watermark)
+  {
+    return;
+  }
+
+  if (atomic_load_acquire_32(&mem_pressure.reclaiming))
+  {
+    return;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+  memory_pressure_level_t level = memory_pressure_level_for(free_size);
+  size_t high_watermark = mem_pressure.high_watermark;
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+
+  // Below the low watermark, try to get back above the high watermark first
+  if (level == MEMORY_PRESSURE_CRITICAL)
+  {
+    free_size += memory_pressure_reclaim(high_watermark - free_size);
+  }
+
+  flags = spin_lock_irqsave(&mem_pressure_lock);
+  level = memory_pressure_level_for(free_size);
+  if (level != mem_pressure.level)
+  {
+    mem_pressure.level = level;
+    memory_pressure_notify(level);
+  }
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+}
+
+/**
+ * @brief Set the low and high watermarks
+ * 
+ * @param low Free bytes below which the pressure is critical
+ * @param high Free bytes below which the pressure is moderate
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_set_watermarks(size_t low, size_t high)
+{
+  if (low > high)
+  {
+    return -EINVARG;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+  mem_pressure.low_watermark = low;
+  mem_pressure.high_watermark = high;
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+
+  return EOK;
+}
+
+/**
+ * @brief Get the low and high watermarks
+ * 
+ * @param low Output for the low watermark
+ * @param high Output for the high watermark
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void memory_pressure_get_watermarks(size_t* low, size_t* high)
+{
+  uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+
+  if (low)
+  {
+    *low = mem_pressure.low_watermark;
+  }
+
+  if (high)
+  {
+    *high = mem_pressure.high_watermark;
+  }
+
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+}
+
+/**
+ * @brief Get the current memory pressure level
+ * 
+ * @return memory_pressure_level_t Current level
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+memory_pressure_level_t memory_pressure_get_level()
+{
+  return *(volatile memory_pressure_level_t*)&mem_pressure.level;
+}
+
+/**
+ * @brief Subscribe a process to pressure notifications
+ * 
+ * @param pid Process ID
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_subscribe(pid_t pid)
+{
+  if (pid >= SYNAPSE_MAX_PROCESSES)
+  {
+    return -EINVARG;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+  mem_pressure.subscribed[pid] = true;
+  // A process subscribing under pressure learns the current level right away
+  mem_pressure.pending[pid] = mem_pressure.level;
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+
+  return EOK;
+}
+
+/**
+ * @brief Unsubscribe a process from pressure notifications
+ * 
+ * @param pid Process ID
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_unsubscribe(pid_t pid)
+{
+  if (pid >= SYNAPSE_MAX_PROCESSES)
+  {
+    return -EINVARG;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+  mem_pressure.subscribed[pid] = false;
+  mem_pressure.pending[pid] = MEMORY_PRESSURE_NONE;
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+
+  return EOK;
+}
+
+/**
+ * @brief Get and clear the pending notification of a process
+ * 
+ * @param pid Process ID
+ * @return int Highest level notified since the last poll, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_poll(pid_t pid)
+{
+  if (pid >= SYNAPSE_MAX_PROCESSES)
+  {
+    return -EINVARG;
+  }
+
+  int level = -EINVARG;
+  uint64_t flags = spin_lock_irqsave(&mem_pressure_lock);
+
+  if (mem_pressure.subscribed[pid])
+  {
+    level = mem_pressure.pending[pid];
+    mem_pressure.pending[pid] = MEMORY_PRESSURE_NONE;
+  }
+
+  spin_unlock_irqrestore(&mem_pressure_lock, flags);
+  return level;
+}
+
+/**
+ * @brief Print memory pressure statistics
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void memory_pressure_print_stats()
+{
+  uart_send_string("Memory pressure statistics:\n");
+  uart_send_string("  Level: ");
+  uart_send_string(uint_to_str(mem_pressure.level));
+  uart_send_string("\n  Watermarks: low ");
+  uart_send_string(uint_to_str(mem_pressure.low_watermark / 1024));
+  uart_send_string(" KB, high ");
+  uart_send_string(uint_to_str(mem_pressure.high_watermark / 1024));
+  uart_send_string(" KB\n  Reclaim passes: ");
+  uart_send_string(uint_to_str(mem_pressure.reclaim_calls));
+  uart_send_string("\n  Reclaimed: ");
+  uart_send_string(uint_to_str(mem_pressure.reclaimed_bytes / 1024));
+  uart_send_string(" KB\n  Notifications: ");
+  uart_send_string(uint_to_str(mem_pressure.notifications));
+  uart_send_string("\n");
+
+  for (int i = 0; i < MEMORY_PRESSURE_MAX_SHRINKERS; i++)
+  {
+    struct shrinker* shrinker = &mem_pressure.shrinkers[i];
+    if (!shrinker->registered)
+    {
+      continue;
+    }
+
+    uart_send_string("  Shrinker ");
+    uart_send_string(shrinker->name);
+    uart_send_string(": ");
+    uart_send_string(uint_to_str(shrinker->released / 1024));
+    uart_send_string(" KB released\n");
+  }
+}
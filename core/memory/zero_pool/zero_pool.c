@@ -0,0 +1,594 @@
+/*
+ * zero_pool.c - This file implements the pool of pre-zeroed memory: the
+ * low priority worker clearing heap blocks and AI small blocks while the
+ * CPU is idle, the allocation path taking them, and the shrinker giving
+ * them back under memory pressure.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "zero_pool.h"
+
+#include <uart.h>
+#include <arm_mmu.h>
+
+#include <kernel/config.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/task/task.h>
+#include <synapse/task/kthread.h>
+#include <synapse/scheduler/preempt.h>
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/memory/pressure/pressure.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// DCZID_EL0: DC ZVA prohibited, log2 of the block size in words
+#define DCZID_DZP     (1 << 4)
+#define DCZID_BS_MASK 0xF
+
+// Benchmark configuration
+#define ZERO_POOL_BENCH_CLEAR_SIZE (64 * 1024)
+#define ZERO_POOL_BENCH_ROUNDS 16
+
+// Blocks of one size, the last one pushed is taken first
+typedef struct
+{
+  size_t size;
+  uint32_t target;
+  uint32_t level;
+  void* blocks[ZERO_POOL_PAGES > ZERO_POOL_STACKS ? ZERO_POOL_PAGES : ZERO_POOL_STACKS];
+} zero_pool_class_t;
+
+static zero_pool_class_t zero_pool_classes[ZERO_POOL_CLASSES] = {
+  [ZERO_POOL_PAGE] = { .size = KERNEL_HEAP_BLOCK_SIZE, .target = ZERO_POOL_PAGES },
+  [ZERO_POOL_STACK] = { .size = SYNAPSE_PROCESS_STACK_SIZE, .target = ZERO_POOL_STACKS },
+};
+
+// Protects the classes. Never held across kmalloc(), whose reclaim may
+// call zero_pool_shrink()
+static spinlock_t zero_pool_lock = SPINLOCK_INIT;
+
+static struct kthread* zero_pool_worker_thread = NULL;
+
+// Statistics
+static DEFINE_PER_CPU(percpu_counter_t, zero_pool_hits[ZERO_POOL_CLASSES]);
+static DEFINE_PER_CPU(percpu_counter_t, zero_pool_misses[ZERO_POOL_CLASSES]);
+static DEFINE_PER_CPU_COUNTER(zero_pool_refills);
+static DEFINE_PER_CPU_COUNTER(zero_pool_ai_blocks);
+
+/**
+ * @brief Get the block size of DC ZVA. With the MMU off every data access
+ * is to Device memory, where DC ZVA faults
+ * 
+ * @return size_t Bytes cleared by one DC ZVA, 0 if it cannot be used
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t zero_pool_zva_size()
+{
+  uint64_t sctlr;
+  uint64_t dczid;
+  __asm__ volatile("mrs %0, sctlr_el1" : "=r" (sctlr));
+  __asm__ volatile("mrs %0, dczid_el0" : "=r" (dczid));
+
+  if (!(sctlr & SCTLR_EL1_M) || (dczid & DCZID_DZP))
+  {
+    return 0;
+  }
+
+  return 4UL << (dczid & DCZID_BS_MASK);
+}
+
+/**
+ * @brief Set memory to zero, with DC ZVA when the memory allows it
+ * 
+ * @param ptr Start of the memory
+ * @param size Size in bytes
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void zero_pool_clear(void* ptr, size_t size)
+{
+  size_t zva = zero_pool_zva_size();
+  if (zva == 0 || size < 2 * zva)
+  {
+    memset(ptr, 0, size);
+    return;
+  }
+
+  // Partial blocks at both ends are stored, whole ones cleared in the cache
+  uintptr_t start = (uintptr_t)ptr;
+  uintptr_t end = start + size;
+  uintptr_t first = (start + zva - 1) & ~(zva - 1);
+  uintptr_t last = end & ~(zva - 1);
+
+  memset(ptr, 0, first - start);
+  for (uintptr_t addr = first; addr < last; addr += zva)
+  {
+    __asm__ volatile("dc zva, %0" : : "r" (addr) : "memory");
+  }
+  memset((void*)last, 0, end - last);
+}
+
+/**
+ * @brief Get the class of an allocation size
+ * 
+ * @param size Size in bytes
+ * @return int Class, -1 if the heap would not give a block of a class
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int zero_pool_class_of(size_t size)
+{
+  if (size == 0)
+  {
+    return -1;
+  }
+
+  // The heap hands out whole blocks, a class block is what kmalloc() gives
+  size_t blocks = (size + KERNEL_HEAP_BLOCK_SIZE - 1) / KERNEL_HEAP_BLOCK_SIZE;
+  for (int i = 0; i < ZERO_POOL_CLASSES; i++)
+  {
+    if (blocks * KERNEL_HEAP_BLOCK_SIZE == zero_pool_classes[i].size)
+    {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+/**
+ * @brief Take a zeroed block for an allocation of a pool class size
+ * 
+ * @param size Size of the allocation in bytes
+ * @return void* Zeroed heap allocation, freed with kfree(). NULL if the
+ * size has no class or the pool of its class is empty
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* zero_pool_alloc(size_t size)
+{
+  int class = zero_pool_class_of(size);
+  if (class < 0)
+  {
+    return NULL;
+  }
+
+  void* block = NULL;
+  zero_pool_class_t* pool = &zero_pool_classes[class];
+
+  uint64_t flags = spin_lock_irqsave(&zero_pool_lock);
+  if (pool->level > 0)
+  {
+    block = pool->blocks[--pool->level];
+  }
+  spin_unlock_irqrestore(&zero_pool_lock, flags);
+
+  percpu_counter_inc(block ? &zero_pool_hits[class] : &zero_pool_misses[class]);
+  return block;
+}
+
+/**
+ * @brief Clear heap blocks until every class is at its target, as the
+ * worker does. Does nothing under memory pressure
+ * 
+ * @param max Most blocks to add
+ * @return uint32_t Blocks added
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t zero_pool_refill(uint32_t max)
+{
+  uint32_t added = 0;
+
+  while (added < max && memory_pressure_get_level() == MEMORY_PRESSURE_NONE)
+  {
+    // Pages first, they serve the most allocations
+    zero_pool_class_t* pool = NULL;
+    uint64_t flags = spin_lock_irqsave(&zero_pool_lock);
+    for (int i = 0; i < ZERO_POOL_CLASSES && !pool; i++)
+    {
+      if (zero_pool_classes[i].level < zero_pool_classes[i].target)
+      {
+        pool = &zero_pool_classes[i];
+      }
+    }
+    spin_unlock_irqrestore(&zero_pool_lock, flags);
+
+    if (!pool)
+    {
+      break;
+    }
+
+    void* block = kmalloc(pool->size);
+    if (!block)
+    {
+      break;
+    }
+
+    // The block is private until pushed, clear it with preemption points
+    for (size_t offset = 0; offset < pool->size; offset += PREEMPT_CHUNK_SIZE)
+    {
+      size_t remaining = pool->size - offset;
+      zero_pool_clear((uint8_t*)block + offset, remaining < PREEMPT_CHUNK_SIZE ? remaining : PREEMPT_CHUNK_SIZE);
+      cond_resched();
+    }
+
+    bool pushed = false;
+    flags = spin_lock_irqsave(&zero_pool_lock);
+    if (pool->level < pool->target)
+    {
+      pool->blocks[pool->level++] = block;
+      pushed = true;
+    }
+    spin_unlock_irqrestore(&zero_pool_lock, flags);
+
+    if (!pushed)
+    {
+      // Filled meanwhile by another caller
+      kfree(block);
+      continue;
+    }
+
+    percpu_counter_inc(&zero_pool_refills);
+    added++;
+  }
+
+  return added;
+}
+
+/**
+ * @brief Give up to a number of bytes of the pool back to the kernel heap,
+ * stacks first
+ * 
+ * @param target Bytes to release
+ * @return size_t Bytes released
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t zero_pool_release(size_t target)
+{
+  size_t released = 0;
+
+  for (int i = ZERO_POOL_CLASSES - 1; i >= 0 && released < target; i--)
+  {
+    zero_pool_class_t* pool = &zero_pool_classes[i];
+    while (released < target)
+    {
+      void* block = NULL;
+      uint64_t flags = spin_lock_irqsave(&zero_pool_lock);
+      if (pool->level > 0)
+      {
+        block = pool->blocks[--pool->level];
+      }
+      spin_unlock_irqrestore(&zero_pool_lock, flags);
+
+      if (!block)
+      {
+        break;
+      }
+
+      kfree(block);
+      released += pool->size;
+    }
+  }
+
+  return released;
+}
+
+/**
+ * @brief Shrinker of the pool, cleared blocks are cheap to make again
+ * 
+ * @param target Number of bytes to release
+ * @param private_data Unused
+ * @return size_t Number of bytes released
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static size_t zero_pool_shrink(size_t target, void* private_data)
+{
+  return zero_pool_release(target);
+}
+
+/**
+ * @brief Give every block of the pool back to the kernel heap
+ * 
+ * @return size_t Bytes released
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t zero_pool_drain()
+{
+  return zero_pool_release((size_t)-1);
+}
+
+/**
+ * @brief Function of the worker: refill the pool one block at a time and
+ * clear free AI small blocks, sleep until the next interrupt when there
+ * is nothing left to do
+ * 
+ * @param arg Not used
+ * @return int EOK
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int zero_pool_worker(void* arg)
+{
+  while (!kthread_should_stop())
+  {
+    uint32_t added = zero_pool_refill(1);
+    size_t cleared = ai_memory_zero_free_blocks(ZERO_POOL_AI_BATCH);
+    percpu_counter_add(&zero_pool_ai_blocks, cleared);
+
+    if (added == 0 && cleared == 0)
+    {
+      __asm__ volatile("wfi");
+    }
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Register the shrinker of the pool and start its low priority
+ * worker, which runs once the scheduler does
+ * 
+ * @return int EOK on success, -EINUSE if started, -ENOMEM if the worker
+ * cannot be created
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int zero_pool_start()
+{
+  if (zero_pool_worker_thread)
+  {
+    return -EINUSE;
+  }
+
+  int res = memory_pressure_register_shrinker("zero_pool", zero_pool_shrink, NULL, SHRINKER_PRIORITY_CHEAP);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  // Low priority threads only run when nothing else is ready
+  zero_pool_worker_thread = kthread_create(zero_pool_worker, NULL, TASK_PRIORITY_LOW, TASK_CPU_ANY);
+  if (!zero_pool_worker_thread)
+  {
+    memory_pressure_unregister_shrinker(res);
+    return -ENOMEM;
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Get the level and hit counts of the pool
+ * 
+ * @param stats Output
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void zero_pool_get_stats(zero_pool_stats_t* stats)
+{
+  if (!stats)
+  {
+    return;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&zero_pool_lock);
+  for (int i = 0; i < ZERO_POOL_CLASSES; i++)
+  {
+    stats->level[i] = zero_pool_classes[i].level;
+    stats->target[i] = zero_pool_classes[i].target;
+  }
+  spin_unlock_irqrestore(&zero_pool_lock, flags);
+
+  for (int i = 0; i < ZERO_POOL_CLASSES; i++)
+  {
+    stats->hits[i] = percpu_counter_sum(&zero_pool_hits[i]);
+    stats->misses[i] = percpu_counter_sum(&zero_pool_misses[i]);
+  }
+  stats->refills = percpu_counter_sum(&zero_pool_refills);
+  stats->ai_blocks = percpu_counter_sum(&zero_pool_ai_blocks);
+}
+
+/**
+ * @brief Print the level and hit rate of each class
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void zero_pool_print_stats()
+{
+  static const char* names[ZERO_POOL_CLASSES] = { "pages", "stacks" };
+  zero_pool_stats_t stats;
+  zero_pool_get_stats(&stats);
+
+  for (int i = 0; i < ZERO_POOL_CLASSES; i++)
+  {
+    uint64_t total = stats.hits[i] + stats.misses[i];
+
+    uart_send_string("  ");
+    uart_send_string(names[i]);
+    uart_send_string(": ");
+    uart_send_string(uint_to_str(stats.level[i]));
+    uart_send_string("/");
+    uart_send_string(uint_to_str(stats.target[i]));
+    uart_send_string(" ready, ");
+    uart_send_string(uint_to_str(stats.hits[i]));
+    uart_send_string(" hits, ");
+    uart_send_string(uint_to_str(stats.misses[i]));
+    uart_send_string(" misses, hit rate ");
+    uart_send_string(uint_to_str(total ? (stats.hits[i] * 100) / total : 0));
+    uart_send_string("%\n");
+  }
+
+  uart_send_string("  blocks cleared: ");
+  uart_send_string(uint_to_str(stats.refills));
+  uart_send_string(", AI small blocks cleared ahead: ");
+  uart_send_string(uint_to_str(stats.ai_blocks));
+  uart_send_string("\n");
+}
+
+/**
+ * @brief Time zeroed allocations of a size from the pool and on demand
+ * 
+ * @param size Allocation size
+ * @param count Allocations, at most the target of its class
+ * @param hit_ns Output for the time of an allocation from the pool
+ * @param miss_ns Output for the time of an allocation cleared on demand
+ * @return int EOK on success, -ENOMEM when out of memory
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int zero_pool_bench_size(size_t size, uint32_t count, uint64_t* hit_ns, uint64_t* miss_ns)
+{
+  void* blocks[ZERO_POOL_PAGES > ZERO_POOL_STACKS ? ZERO_POOL_PAGES : ZERO_POOL_STACKS];
+  uint64_t frequency = timer_read_frequency();
+  uint64_t ticks[2] = { 0, 0 };
+
+  // Round 0 takes from a full pool, round 1 from an empty one
+  for (int round = 0; round < 2; round++)
+  {
+    if (round == 0)
+    {
+      zero_pool_refill(ZERO_POOL_PAGES + ZERO_POOL_STACKS);
+    }
+    else
+    {
+      zero_pool_drain();
+    }
+
+    uint32_t done = 0;
+    uint64_t start = timer_read_counter();
+    for (; done < count; done++)
+    {
+      blocks[done] = kzalloc(size);
+      if (!blocks[done])
+      {
+        break;
+      }
+    }
+    ticks[round] = timer_read_counter() - start;
+
+    for (uint32_t i = 0; i < done; i++)
+    {
+      kfree(blocks[i]);
+    }
+
+    if (done < count)
+    {
+      return -ENOMEM;
+    }
+  }
+
+  *hit_ns = (ticks[0] * 1000000000ULL) / frequency / count;
+  *miss_ns = (ticks[1] * 1000000000ULL) / frequency / count;
+  return EOK;
+}
+
+/**
+ * @brief Time zeroed allocations from the pool against clearing them on
+ * demand, and DC ZVA against memset
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int zero_pool_benchmark()
+{
+  uint64_t frequency = timer_read_frequency();
+  uint64_t hit_ns = 0;
+  uint64_t miss_ns = 0;
+
+  uart_send_string("\n=== Zero Pool Benchmark ===\n");
+
+  int res = zero_pool_bench_size(KERNEL_HEAP_BLOCK_SIZE, ZERO_POOL_PAGES, &hit_ns, &miss_ns);
+  if (res != EOK)
+  {
+    uart_send_string("  Out of memory\n");
+    return res;
+  }
+
+  uart_send_string("  kzalloc(page) from the pool: ");
+  uart_send_string(uint_to_str(hit_ns));
+  uart_send_string(" ns, cleared on demand: ");
+  uart_send_string(uint_to_str(miss_ns));
+  uart_send_string(" ns\n");
+
+  res = zero_pool_bench_size(SYNAPSE_PROCESS_STACK_SIZE, ZERO_POOL_STACKS, &hit_ns, &miss_ns);
+  if (res != EOK)
+  {
+    uart_send_string("  Out of memory\n");
+    return res;
+  }
+
+  uart_send_string("  kzalloc(stack) from the pool: ");
+  uart_send_string(uint_to_str(hit_ns));
+  uart_send_string(" ns, cleared on demand: ");
+  uart_send_string(uint_to_str(miss_ns));
+  uart_send_string(" ns\n");
+
+  // Clearing itself, DC ZVA needs the MMU on
+  size_t zva = zero_pool_zva_size();
+  void* buffer = kmalloc(ZERO_POOL_BENCH_CLEAR_SIZE);
+  if (!buffer)
+  {
+    uart_send_string("  Out of memory\n");
+    return -ENOMEM;
+  }
+
+  uint64_t start = timer_read_counter();
+  for (uint32_t i = 0; i < ZERO_POOL_BENCH_ROUNDS; i++)
+  {
+    memset(buffer, 0, ZERO_POOL_BENCH_CLEAR_SIZE);
+  }
+  uint64_t memset_ticks = timer_read_counter() - start;
+
+  start = timer_read_counter();
+  for (uint32_t i = 0; i < ZERO_POOL_BENCH_ROUNDS; i++)
+  {
+    zero_pool_clear(buffer, ZERO_POOL_BENCH_CLEAR_SIZE);
+  }
+  uint64_t clear_ticks = timer_read_counter() - start;
+  kfree(buffer);
+
+  uint64_t bytes = (uint64_t)ZERO_POOL_BENCH_CLEAR_SIZE * ZERO_POOL_BENCH_ROUNDS;
+  uart_send_string("  memset: ");
+  uart_send_string(uint_to_str(memset_ticks ? (bytes * frequency) / memset_ticks / (1024 * 1024) : 0));
+  uart_send_string(" MB/s, ");
+  uart_send_string(zva ? "DC ZVA: " : "DC ZVA unavailable (MMU off), memset: ");
+  uart_send_string(uint_to_str(clear_ticks ? (bytes * frequency) / clear_ticks / (1024 * 1024) : 0));
+  uart_send_string(" MB/s\n");
+
+  // Leave the pool full for the first processes
+  zero_pool_refill(ZERO_POOL_PAGES + ZERO_POOL_STACKS);
+  zero_pool_print_stats();
+
+  return EOK;
+}
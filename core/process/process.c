@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 2 Apr 2025
- * Last Modified: 8 Apr 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "process.h"
@@ -17,36 +17,23 @@
 #include <synapse/status.h>
 
 #include <synapse/task/task.h>
+#include <synapse/fs/initramfs.h>
 #include <synapse/string/string.h>
 #include <synapse/memory/memory.h>
 #include <synapse/memory/heap/kheap.h>
+#include <synapse/memory/pressure/pressure.h>
+#include <synapse/sync/rcu.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/scheduler/preempt.h>
 
 int process_switch(pid_t id);
 
-// Process table
+// Process table, read under RCU, processes are freed a grace period
+// after they leave it
 static struct process* process_table[SYNAPSE_MAX_PROCESSES] = {0};
 static pid_t current_process = 0;
-
-// Helper function to convert uint64_t to string
-static void uint64_to_str(uint64_t value, char* buffer, size_t buffer_size) {
-  if (buffer_size < 3) return; // Need at least space for "0x" and null terminator
-  
-  buffer[0] = '0';
-  buffer[1] = 'x';
-  
-  size_t pos = 2;
-  bool significant = false;
-  
-  for (ssize_t i = 60; i >= 0 && pos < buffer_size - 1; i -= 4) {
-    int digit = (value >> i) & 0xF;
-    if (digit != 0 || significant || i == 0) {
-      buffer[pos++] = digit < 10 ? '0' + digit : 'A' + (digit - 10);
-      significant = true;
-    }
-  }
-  
-  buffer[pos] = '\0';
-}
+// Serializes the writers of process_table, never held across a task switch
+static spinlock_t process_table_lock = SPINLOCK_INIT;
 
 // Safe exit handler for tasks that return unexpectedly
 void process_return_handler(void)
@@ -56,7 +43,7 @@ void process_return_handler(void)
 }
 
 /**
- * @brief Allocate a new process ID
+ * @brief Allocate a new process ID, called with process_table_lock held
  * 
  * @return int Allocated process ID, or negative error code
  * 
@@ -99,6 +86,7 @@ static int process_init(struct process* process, pid_t id, const char* name)
   memset(process, 0, sizeof(struct process));
   process->id = id;
   strncpy(process->name, name, SYNAPSE_MAX_PROCESS_NAME);
+  hash_table_init(&process->allocation_index, process->allocation_slots, SYNAPSE_PROCESS_ALLOCATION_SLOTS);
 
   return EOK;
 }
@@ -152,15 +140,13 @@ static int process_load_binary(struct process* process, void* program_data, size
  */
 static int process_allocate_stack(struct process* process)
 {
-  void* stack = process_malloc(process, SYNAPSE_PROCESS_STACK_SIZE);
+  // Zeroed ahead of time by the zero pool when it has a stack ready
+  void* stack = process_zalloc(process, SYNAPSE_PROCESS_STACK_SIZE);
   if (!stack)
   {
     return -ENOMEM;
   }
 
-  // Zero-initialize stack
-  memset(stack, 0, SYNAPSE_PROCESS_STACK_SIZE);
-
   process->stack = stack;
   return EOK;
 }
@@ -233,16 +219,24 @@ static int process_create_task(struct process* process)
  */
 struct process* process_current()
 {
+  // Kernel threads belong to no process
+  struct task* task = task_current();
+  if (task && task->kthread)
+  {
+    return NULL;
+  }
+
   if (current_process >= SYNAPSE_MAX_PROCESSES)
   {
     return NULL;
   }
 
-  return process_table[current_process];
+  return rcu_dereference(process_table[current_process]);
 }
 
 /**
- * @brief Get a process by ID
+ * @brief Get a process by ID, lock-free. The process stays valid until
+ * the caller leaves its RCU read section
  * 
  * @param id Process ID to look up
  * @return struct process* Pointer to process, NULL if not found
@@ -257,7 +251,25 @@ struct process* process_get(pid_t id)
     return NULL;
   }
 
-  return process_table[id];
+  return rcu_dereference(process_table[id]);
+}
+
+/**
+ * @brief Give back the slot of a process that failed to load, lookups
+ * are done with the process on return so it can be freed
+ * 
+ * @param slot Process slot
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void process_release_slot(int slot)
+{
+  uint64_t flags = spin_lock_irqsave(&process_table_lock);
+  rcu_assign_pointer(process_table[slot], NULL);
+  spin_unlock_irqrestore(&process_table_lock, flags);
+
+  synchronize_rcu();
 }
 
 /**
@@ -286,14 +298,6 @@ int process_create(const char* name, void* program_data, size_t size, struct pro
     return -EINVARG;
   }
 
-  // Allocate process table slot
-  int slot = process_allocate_slot();
-  if (slot < 0)
-  {
-    uart_send_string("process_create: Failed to allocate process slot\n");
-    return slot;
-  }
-
   // Allocate process structure
   struct process* process = kmalloc(sizeof(struct process));
   if (!process)
@@ -302,8 +306,27 @@ int process_create(const char* name, void* program_data, size_t size, struct pro
     return -ENOMEM;
   }
 
-  // Initialize process
-  res = process_init(process, slot, name);
+  // Allocate process table slot, claimed at once so no other CPU gets it.
+  // The process has no task until it is fully loaded
+  uint64_t flags = spin_lock_irqsave(&process_table_lock);
+  int slot = process_allocate_slot();
+  if (slot >= 0)
+  {
+    res = process_init(process, slot, name);
+    if (res == EOK)
+    {
+      rcu_assign_pointer(process_table[slot], process);
+    }
+  }
+  spin_unlock_irqrestore(&process_table_lock, flags);
+
+  if (slot < 0)
+  {
+    uart_send_string("process_create: Failed to allocate process slot\n");
+    kfree(process);
+    return slot;
+  }
+
   if (res < 0)
   {
     uart_send_string("process_create: Failed to initialize process\n");
@@ -317,13 +340,13 @@ int process_create(const char* name, void* program_data, size_t size, struct pro
   if (res < 0)
   {
     uart_send_string("process_create: Failed to allocate stack\n");
+    process_release_slot(slot);
     kfree(process);
     return res;
   }
 
   // Log stack address
-  char buf[20];
-  uint64_to_str((uint64_t)process->stack, buf, sizeof(buf));
+  char* buf = uint_to_hex((uint64_t)process->stack);
   uart_send_string("Stack address: ");
   uart_send_string(buf);
   uart_send_string("\n");
@@ -334,13 +357,14 @@ int process_create(const char* name, void* program_data, size_t size, struct pro
   if (res < 0)
   {
     uart_send_string("process_create: Failed to load binary\n");
+    process_release_slot(slot);
     process_free(process, process->stack);
     kfree(process);
     return res;
   }
 
   // Log program address
-  uint64_to_str((uint64_t)process->ptr, buf, sizeof(buf));
+  buf = uint_to_hex((uint64_t)process->ptr);
   uart_send_string("Program address: ");
   uart_send_string(buf);
   uart_send_string("\n");
@@ -351,16 +375,13 @@ int process_create(const char* name, void* program_data, size_t size, struct pro
   if (res < 0)
   {
     uart_send_string("process_create: Failed to create task\n");
+    process_release_slot(slot);
     process_free(process, process->stack);
     process_free(process, process->ptr);
     kfree(process);
     return res;
   }
 
-  // Store in process table
-  uart_send_string("process_create: Storing in process table\n");
-  process_table[slot] = process;
-
   // Set output parameter
   if (process_out)
   {
@@ -371,6 +392,33 @@ int process_create(const char* name, void* program_data, size_t size, struct pro
   return slot;
 }
 
+/**
+ * @brief Create and load a process from a file of the root filesystem,
+ * the binary is copied once straight from the archive
+ * 
+ * @param name Process name
+ * @param path Path of the program binary
+ * @param process_out Output parameter for created process
+ * @return int Process ID on success, -ENOENT if there is no such file,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int process_create_from_file(const char* name, const char* path, struct process** process_out)
+{
+  const void* program_data = NULL;
+  size_t size = 0;
+
+  int res = initramfs_lookup(initramfs_get_root(), path, &program_data, &size);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  return process_create(name, (void*)program_data, size, process_out);
+}
+
 /**
  * @brief Create a process and immediatly switch to it
  * 
@@ -417,7 +465,7 @@ int process_create_for_slot(const char* name, void* program_data, size_t size, i
     return -EINVARG;
   }
 
-  if (process_table[slot] != NULL)
+  if (process_get(slot) != NULL)
   {
     // Slot already in use
     return -EINUSE;
@@ -425,15 +473,25 @@ int process_create_for_slot(const char* name, void* program_data, size_t size, i
 
   struct process* process;
   int res = process_create(name, program_data, size, &process);
+  if (res < 0 || res == slot)
+  {
+    return res;
+  }
 
-  if (res >= 0 && res != slot)
+  // Move the process, unless the slot was taken meanwhile
+  uint64_t flags = spin_lock_irqsave(&process_table_lock);
+  if (process_table[slot] == NULL)
   {
-    // Update process ID and table entry
     process->id = slot;
-    process_table[res] = NULL; // Clear original slot
-    process_table[slot] = process;
+    rcu_assign_pointer(process_table[slot], process);
+    rcu_assign_pointer(process_table[res], NULL); // Clear original slot
     res = EOK;
   }
+  else
+  {
+    res = -EINUSE;
+  }
+  spin_unlock_irqrestore(&process_table_lock, flags);
 
   return res;
 }
@@ -449,19 +507,22 @@ int process_create_for_slot(const char* name, void* program_data, size_t size, i
  */
 int process_switch(pid_t id)
 {
-  if (id >= SYNAPSE_MAX_PROCESSES || process_table[id] == NULL)
+  // The task switch below ends the read section
+  rcu_read_lock();
+  struct process* process = process_get(id);
+  if (!process || !process->task)
   {
+    rcu_read_unlock();
     return -EINVARG;
   }
 
-  char buf[20];
-  uint64_to_str(id, buf, sizeof(buf));
+  char* buf = uint_to_hex(id);
   uart_send_string("process_switch: current_process = ");
   uart_send_string(buf);
   uart_send_string("\n");
 
   // Save current task state
-  if (process_table[current_process] != NULL)
+  if (process_current() != NULL)
   {
     task_current_save_state();
   }
@@ -470,7 +531,7 @@ int process_switch(pid_t id)
   current_process = id;
 
   // Switch to main task of new process
-  task_switch(process_table[id]->task);
+  task_switch(process->task);
 
   return EOK;
 }
@@ -486,12 +547,24 @@ int process_switch(pid_t id)
  */
 int process_terminate(pid_t id)
 {
-  if (id >= SYNAPSE_MAX_PROCESSES || process_table[id] == NULL)
+  if (id >= SYNAPSE_MAX_PROCESSES)
   {
     return -EINVARG;
   }
 
+  // Take the process out of the table first, lookups stop finding it
+  uint64_t flags = spin_lock_irqsave(&process_table_lock);
   struct process* process = process_table[id];
+  rcu_assign_pointer(process_table[id], NULL);
+  spin_unlock_irqrestore(&process_table_lock, flags);
+
+  if (process == NULL)
+  {
+    return -EINVARG;
+  }
+
+  // Readers that found it before are gone once the grace period is over
+  synchronize_rcu();
 
   // Free allocations
   for (size_t i = 0; i < SYNAPSE_MAX_PROCESSES_ALLOCATIONS; i++)
@@ -500,6 +573,7 @@ int process_terminate(pid_t id)
     {
       kfree(process->allocations[i].ptr);
       process->allocations[i].size = 0;
+      cond_resched();
     }
   }
 
@@ -520,8 +594,11 @@ int process_terminate(pid_t id)
   // Free task
   task_free(process->task);
 
-  // Clear table entry
-  process_table[id] = NULL;
+  // Drop pending memory pressure notifications
+  memory_pressure_unsubscribe(id);
+
+  // Close the files left open
+  initramfs_close_all(initramfs_get_root(), id);
 
   // Free process structure
   kfree(process);
@@ -549,20 +626,24 @@ int process_terminate(pid_t id)
  */
 int process_get_arguments(pid_t id, int* argc, char*** argv)
 {
-  if (id >= SYNAPSE_MAX_PROCESSES || process_table[id] == NULL)
+  rcu_read_lock();
+  struct process* process = process_get(id);
+  if (process == NULL)
   {
+    rcu_read_unlock();
     return -EINVARG;
   }
 
   if (argc != NULL)
   {
-    *argc = process_table[id]->arguments.argc;
+    *argc = process->arguments.argc;
   }
 
   if (argv != NULL)
   {
-    *argv = process_table[id]->arguments.argv;
+    *argv = process->arguments.argv;
   }
+  rcu_read_unlock();
 
   return EOK;
 }
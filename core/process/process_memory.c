@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 3 Apr 2025
- * Last Modified: 7 Apr 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "process.h"
@@ -33,11 +33,13 @@ static int process_find_free_allocation_index(struct process* process)
     return -EINVARG;
   }
 
-  for (size_t i = 0; i < SYNAPSE_MAX_PROCESSES_ALLOCATIONS; i++)
+  // First clear bit of the in-use map
+  for (size_t i = 0; i < SYNAPSE_MAX_PROCESSES_ALLOCATIONS / 64; i++)
   {
-    if (process->allocations[i].ptr == NULL)
+    uint64_t free_entries = ~process->allocations_used[i];
+    if (free_entries != 0)
     {
-      return i;
+      return (i * 64) + __builtin_ctzll(free_entries);
     }
   }
 
@@ -46,16 +48,17 @@ static int process_find_free_allocation_index(struct process* process)
 }
 
 /**
- * @brief Allocate memory for a process
+ * @brief Allocate memory for a process and record it in its table
  * 
  * @param process Process to allocate for
- * @param size Size in bytes to allocatr
+ * @param size Size in bytes to allocate
+ * @param zeroed Clear the memory
  * @return void* Pointer to allocated memory, NULL on failure
  * 
  * @author Fedi Nabli
- * @date 7 Apr 2025
+ * @date 18 Oct 2026
  */
-void* process_malloc(struct process* process, size_t size)
+static void* process_alloc(struct process* process, size_t size, bool zeroed)
 {
   if (!process || size == 0)
   {
@@ -79,22 +82,61 @@ void* process_malloc(struct process* process, size_t size)
   }
 
   // Allocate memory
-  void* ptr = kmalloc(size);
+  void* ptr = zeroed ? kzalloc(size) : kmalloc(size);
   if (!ptr)
   {
     uart_send_string("process_malloc: Kmalloc returned no pointer\n");
     return NULL;
   }
 
+  // Index the entry by pointer for process_free()
+  if (hash_table_insert(&process->allocation_index, (uint64_t)(uintptr_t)ptr, &process->allocations[index]) != EOK)
+  {
+    uart_send_string("process_malloc: Allocation index full\n");
+    kfree(ptr);
+    return NULL;
+  }
+
   // Record only the actual requested size in the allocation table
   process->allocations[index].ptr = ptr;
   process->allocations[index].size = size;
+  process->allocations_used[index / 64] |= 1ULL << (index % 64);
 
   uart_send_string("process_malloc: Finished memory allocation for process\n");
 
   return ptr;
 }
 
+/**
+ * @brief Allocate memory for a process
+ * 
+ * @param process Process to allocate for
+ * @param size Size in bytes to allocatr
+ * @return void* Pointer to allocated memory, NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 7 Apr 2025
+ */
+void* process_malloc(struct process* process, size_t size)
+{
+  return process_alloc(process, size, false);
+}
+
+/**
+ * @brief Allocate zeroed memory for a process
+ * 
+ * @param process Process to allocate for
+ * @param size Size in bytes to allocate
+ * @return void* Pointer to allocated memory, NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* process_zalloc(struct process* process, size_t size)
+{
+  return process_alloc(process, size, true);
+}
+
 /**
  * @brief Free memory allocated to a process
  * 
@@ -113,23 +155,23 @@ int process_free(struct process* process, void* ptr)
   }
 
   // Find allocation entry
-  for (size_t i = 0; i < SYNAPSE_MAX_PROCESSES_ALLOCATIONS; i++)
+  struct process_allocation* allocation = hash_table_remove(&process->allocation_index, (uint64_t)(uintptr_t)ptr);
+  if (!allocation)
   {
-    if (process->allocations[i].ptr == ptr)
-    {
-      // Free memory
-      kfree(ptr);
+    // Allocation not found
+    return -EINVARG;
+  }
 
-      // Clear memory entry
-      process->allocations[i].ptr = NULL;
-      process->allocations[i].size = 0;
+  // Free memory
+  kfree(ptr);
 
-      return EOK;
-    }
-  }
+  // Clear memory entry
+  size_t index = allocation - process->allocations;
+  allocation->ptr = NULL;
+  allocation->size = 0;
+  process->allocations_used[index / 64] &= ~(1ULL << (index % 64));
 
-  // Allocation not found
-  return -EINVARG;
+  return EOK;
 }
 
 /**
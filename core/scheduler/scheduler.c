@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 9 Apr 2025
- * Last Modified: 9 Apr 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "scheduler.h"
@@ -17,25 +17,36 @@
 #include <synapse/status.h>
 
 #include <synapse/task/task.h>
+#include <synapse/task/kthread.h>
+#include <synapse/scheduler/preempt.h>
 #include <synapse/timer/timer.h>
 #include <synapse/process/process.h>
 #include <synapse/interrupts/interrupt.h>
+#include <synapse/sync/rcu.h>
 
 // Flag to indicate if scheduler is running
 static bool scheduler_running = false;
 
 static pid_t task_schedule_next_process()
 {
+  pid_t next = -ENOENT;
+  int best_priority = -1;
+
+  // First ready process of the highest priority
+  rcu_read_lock();
   for (pid_t i = 0; i < SYNAPSE_MAX_PROCESSES; i++)
   {
     struct process* proc = process_get(i);
-    if (proc && proc->task && proc->task->state == TASK_STATE_READY)
+    if (proc && proc->task && proc->task->state == TASK_STATE_READY &&
+        proc->task->priority > best_priority)
     {
-      return i;
+      next = i;
+      best_priority = proc->task->priority;
     }
   }
+  rcu_read_unlock();
 
-  return -ENOENT;
+  return next;
 }
 
 /**
@@ -56,6 +67,31 @@ int scheduler_timer_handler(struct interrupt_frame* int_frame)
 
   uart_send_string("TIMER IRQ scheduler!\n");
 
+  // The switch waits for IRQ exit, or for the end of the section the
+  // tick interrupted
+  preempt_set_need_resched();
+
+  return EOK;
+}
+
+/**
+ * @brief Save the interrupted task and switch to the next one, called on
+ * IRQ exit outside any non-preemptible section
+ * 
+ * @param int_frame Interrupt frame of the interrupted task
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void scheduler_preempt(struct interrupt_frame* int_frame)
+{
+  this_cpu_ptr(&preempt_cpu)->need_resched = 0;
+
+  if (!scheduler_running)
+  {
+    return;
+  }
+
   // Save current task state if one is running
   struct task* current = task_current();
   if (current != NULL)
@@ -69,11 +105,30 @@ int scheduler_timer_handler(struct interrupt_frame* int_frame)
     }
   }
 
-  // Schedule next task
-  pid_t next_pid = task_schedule_next_process();
-  process_switch(next_pid);
-  
-  return EOK;
+  // High priority threads first, then processes and normal threads take
+  // turns, low priority threads only run when nothing else is ready
+  struct task* next = kthread_pick_next(TASK_PRIORITY_HIGH);
+  if (!next && (current == NULL || current->kthread == NULL))
+  {
+    next = kthread_pick_next(TASK_PRIORITY_NORMAL);
+  }
+
+  if (!next)
+  {
+    pid_t next_pid = task_schedule_next_process();
+    if (next_pid < SYNAPSE_MAX_PROCESSES)
+    {
+      process_switch(next_pid);
+      return;
+    }
+
+    next = kthread_pick_next(TASK_PRIORITY_LOW);
+  }
+
+  if (next)
+  {
+    task_switch(next);
+  }
 }
 
 /**
@@ -93,6 +148,13 @@ int scheduler_init()
     return res;
   }
 
+  // Switches outside of the tick go through the reschedule SGI
+  res = preempt_init();
+  if (res < 0)
+  {
+    return res;
+  }
+
   // Register timer interrupt handler
   res = timer_register_handler(scheduler_timer_handler);
   if (res < 0)
@@ -0,0 +1,209 @@
+/*
+ * selftest.c - This file implements the kernel self-test runner. The
+ * memory system is tested first, then the test of every subsystem, each
+ * kept next to the code it covers.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "selftest.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/memory/memory_system.h>
+#include <synapse/ai/sparse.h>
+#include <synapse/ai/int4.h>
+#include <synapse/ai/bf16.h>
+#include <synapse/ai/stream.h>
+#include <synapse/ai/pipeline.h>
+#include <synapse/ai/detect.h>
+#include <synapse/ai/rnn.h>
+#include <synapse/math/fastmath.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/sync/rcu.h>
+#include <synapse/sync/queue.h>
+#include <synapse/smp/percpu.h>
+#include <synapse/lib/rbtree.h>
+#include <synapse/task/kthread.h>
+#include <synapse/scheduler/preempt.h>
+#include <synapse/init/init.h>
+#include <synapse/fs/initramfs.h>
+#include <synapse/fdt/fdt.h>
+
+/**
+ * @brief Run the memory system tests, then the test of every subsystem,
+ * stopping at the first failure
+ * 
+ * @return int EOK if every test passed, the error of the failed test
+ * otherwise
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int selftest_run()
+{
+  int res;
+
+  uart_send_string("\n=== Running Kernel Self-Tests ===\n");
+
+  // Memory first, every other subsystem allocates
+  res = memory_run_tests();
+  if (res != EOK)
+  {
+    uart_send_string("Memory system tests FAILED\n");
+    return res;
+  }
+
+  // Test sparse tensor formats and sparse-dense matmul
+  res = sparse_test();
+  if (res != EOK)
+  {
+    uart_send_string("Sparse tensor tests FAILED\n");
+    return res;
+  }
+
+  // Test packed INT4 weights
+  res = int4_test();
+  if (res != EOK)
+  {
+    uart_send_string("Packed INT4 tests FAILED\n");
+    return res;
+  }
+
+  // Test BF16 tensors and kernels
+  res = bf16_test();
+  if (res != EOK)
+  {
+    uart_send_string("BF16 tests FAILED\n");
+    return res;
+  }
+
+  // Test the streaming weight loader
+  res = stream_test();
+  if (res != EOK)
+  {
+    uart_send_string("Weight streaming tests FAILED\n");
+    return res;
+  }
+
+  // Test the frame pipeline
+  res = pipeline_test();
+  if (res != EOK)
+  {
+    uart_send_string("Frame pipeline tests FAILED\n");
+    return res;
+  }
+
+  // Test detection post-processing
+  res = detect_test();
+  if (res != EOK)
+  {
+    uart_send_string("Detection post-processing tests FAILED\n");
+    return res;
+  }
+
+  // Test the fast math library
+  res = fastmath_test();
+  if (res != EOK)
+  {
+    uart_send_string("Fast math tests FAILED\n");
+    return res;
+  }
+
+  // Test the recurrent cells
+  res = rnn_test();
+  if (res != EOK)
+  {
+    uart_send_string("Recurrent cell tests FAILED\n");
+    return res;
+  }
+
+  // Test the atomics and locks
+  res = spinlock_test();
+  if (res != EOK)
+  {
+    uart_send_string("Lock tests FAILED\n");
+    return res;
+  }
+
+  // Test the per-CPU data
+  res = percpu_test();
+  if (res != EOK)
+  {
+    uart_send_string("Per-CPU tests FAILED\n");
+    return res;
+  }
+
+  // Test RCU
+  res = rcu_test();
+  if (res != EOK)
+  {
+    uart_send_string("RCU tests FAILED\n");
+    return res;
+  }
+
+  // Test the lock-free queues
+  res = queue_test();
+  if (res != EOK)
+  {
+    uart_send_string("Lock-free queue tests FAILED\n");
+    return res;
+  }
+
+  // Test the red-black tree and the hash table
+  res = rb_tree_test();
+  if (res != EOK)
+  {
+    uart_send_string("Tree and hash table tests FAILED\n");
+    return res;
+  }
+
+  // Test kernel threads
+  res = kthread_test();
+  if (res != EOK)
+  {
+    uart_send_string("Kernel thread tests FAILED\n");
+    return res;
+  }
+
+  // Test preemption control
+  res = preempt_test();
+  if (res != EOK)
+  {
+    uart_send_string("Preemption tests FAILED\n");
+    return res;
+  }
+
+  // Test parallel boot initialisation
+  res = init_test();
+  if (res != EOK)
+  {
+    uart_send_string("Boot initialisation tests FAILED\n");
+    return res;
+  }
+
+  // Test the initramfs
+  res = initramfs_test();
+  if (res != EOK)
+  {
+    uart_send_string("Initramfs tests FAILED\n");
+    return res;
+  }
+
+  // Test the platform description from the device tree
+  res = fdt_test();
+  if (res != EOK)
+  {
+    uart_send_string("Device tree tests FAILED\n");
+    return res;
+  }
+
+  uart_send_string("\n=== All Kernel Self-Tests PASSED ===\n");
+  return EOK;
+}
@@ -0,0 +1,290 @@
+/*
+ * semihost.c - This file implements the ARM semihosting client. Each
+ * call traps to the host with HLT #0xF000, the operation in w0 and a
+ * parameter block in x1. Without SEMIHOSTING=1 the trap is compiled
+ * out and every call fails with -ENOTREADY.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "semihost.h"
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/string/string.h>
+
+#ifdef SYNAPSE_SEMIHOSTING
+#define SEMIHOST_ENABLED true
+
+/**
+ * @brief Trap to the host
+ * 
+ * @param op Operation number
+ * @param block Parameter block, or the parameter itself
+ * @return int64_t Host result
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline int64_t semihost_call(uint32_t op, void* block)
+{
+  register uint64_t x0 __asm__("x0") = op;
+  register uint64_t x1 __asm__("x1") = (uint64_t)block;
+
+  // The host reads and writes the block, memory must be up to date
+  __asm__ volatile("hlt #0xf000" : "+r" (x0) : "r" (x1) : "memory");
+  return (int64_t)x0;
+}
+#else
+#define SEMIHOST_ENABLED false
+
+// Production images never trap
+static inline int64_t semihost_call(uint32_t op, void* block)
+{
+  (void)op;
+  (void)block;
+  return -1;
+}
+#endif
+
+/**
+ * @brief Check if the client is built in
+ * 
+ * @return bool true with SEMIHOSTING=1
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool semihost_present()
+{
+  return SEMIHOST_ENABLED;
+}
+
+/**
+ * @brief Open a host file, relative paths start in the directory QEMU
+ * was launched from
+ * 
+ * @param path File path
+ * @param mode Open mode
+ * @return int Host handle, -EIO if the host refused,
+ * -ENOTREADY without semihosting
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_open(const char* path, semihost_mode_t mode)
+{
+  if (!SEMIHOST_ENABLED)
+  {
+    return -ENOTREADY;
+  }
+
+  if (!path)
+  {
+    return -EINVARG;
+  }
+
+  uint64_t block[3] = { (uint64_t)path, (uint64_t)mode, strlen(path) };
+  int64_t handle = semihost_call(SEMIHOST_SYS_OPEN, block);
+
+  return handle < 0 ? -EIO : (int)handle;
+}
+
+/**
+ * @brief Close a host file
+ * 
+ * @param handle Host handle
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_close(int handle)
+{
+  if (!SEMIHOST_ENABLED)
+  {
+    return -ENOTREADY;
+  }
+
+  uint64_t block[1] = { (uint64_t)handle };
+  return semihost_call(SEMIHOST_SYS_CLOSE, block) == 0 ? EOK : -EIO;
+}
+
+/**
+ * @brief Write to a host file
+ * 
+ * @param handle Host handle
+ * @param data Data
+ * @param size Size in bytes
+ * @return int EOK if everything was written, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_write(int handle, const void* data, size_t size)
+{
+  if (!SEMIHOST_ENABLED)
+  {
+    return -ENOTREADY;
+  }
+
+  if (!data && size > 0)
+  {
+    return -EINVARG;
+  }
+
+  // The host returns the number of bytes it did not write
+  uint64_t block[3] = { (uint64_t)handle, (uint64_t)data, size };
+  return semihost_call(SEMIHOST_SYS_WRITE, block) == 0 ? EOK : -EIO;
+}
+
+/**
+ * @brief Read from a host file
+ * 
+ * @param handle Host handle
+ * @param buffer Destination
+ * @param size Bytes to read
+ * @return int Bytes read, 0 at the end of the file, negative error code
+ * on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_read(int handle, void* buffer, size_t size)
+{
+  if (!SEMIHOST_ENABLED)
+  {
+    return -ENOTREADY;
+  }
+
+  if (!buffer && size > 0)
+  {
+    return -EINVARG;
+  }
+
+  // The host returns the number of bytes it did not read
+  uint64_t block[3] = { (uint64_t)handle, (uint64_t)buffer, size };
+  int64_t left = semihost_call(SEMIHOST_SYS_READ, block);
+  if (left < 0 || (uint64_t)left > size)
+  {
+    return -EIO;
+  }
+
+  return (int)(size - (uint64_t)left);
+}
+
+/**
+ * @brief Write a whole host file in one go
+ * 
+ * @param path File path, truncated if it exists
+ * @param data Data
+ * @param size Size in bytes
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_write_file(const char* path, const void* data, size_t size)
+{
+  int handle = semihost_open(path, SEMIHOST_OPEN_WRITE);
+  if (handle < 0)
+  {
+    return handle;
+  }
+
+  int res = semihost_write(handle, data, size);
+  int close_res = semihost_close(handle);
+
+  return res < 0 ? res : close_res;
+}
+
+/**
+ * @brief Read the host clock
+ * 
+ * @return int64_t Centiseconds since the run started, negative error code
+ * on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int64_t semihost_clock()
+{
+  if (!SEMIHOST_ENABLED)
+  {
+    return -ENOTREADY;
+  }
+
+  int64_t centiseconds = semihost_call(SEMIHOST_SYS_CLOCK, NULL);
+  return centiseconds < 0 ? -EIO : centiseconds;
+}
+
+/**
+ * @brief Read the host tick counter
+ * 
+ * @param ticks Output for the ticks since the run started
+ * @param frequency Output for the ticks per second, may be NULL
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_elapsed(uint64_t* ticks, uint64_t* frequency)
+{
+  if (!SEMIHOST_ENABLED)
+  {
+    return -ENOTREADY;
+  }
+
+  if (!ticks)
+  {
+    return -EINVARG;
+  }
+
+  // On AArch64 the host fills a single 64-bit field
+  uint64_t block[1] = { 0 };
+  if (semihost_call(SEMIHOST_SYS_ELAPSED, block) != 0)
+  {
+    return -EIO;
+  }
+  *ticks = block[0];
+
+  if (frequency)
+  {
+    int64_t hz = semihost_call(SEMIHOST_SYS_TICKFREQ, NULL);
+    if (hz <= 0)
+    {
+      return -EIO;
+    }
+    *frequency = (uint64_t)hz;
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Stop the machine, QEMU exits with the status code
+ * 
+ * @param code Status code, 0 for success
+ * @return int -ENOTREADY without semihosting, does not return otherwise
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_exit(int code)
+{
+  if (!SEMIHOST_ENABLED)
+  {
+    return -ENOTREADY;
+  }
+
+  // AArch64 passes the reason and the status code in a block
+  uint64_t block[2] = { SEMIHOST_ADP_STOPPED_APPLICATION_EXIT, (uint64_t)(int64_t)code };
+  semihost_call(SEMIHOST_SYS_EXIT, block);
+
+  // Only reached if the host ignored the request
+  while (1) {}
+}
@@ -0,0 +1,217 @@
+/*
+ * percpu.c - This file implements the per-CPU areas. The .percpu section
+ * is copied once per CPU into a static area at boot, before anything
+ * updates it, and each CPU keeps the offset of its copy in TPIDR_EL1.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "percpu.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/memory/memory.h>
+#include <synapse/string/string.h>
+
+// Template of the per-CPU variables, from the linker script
+extern char __percpu_start[];
+extern char __percpu_end[];
+
+uintptr_t percpu_offsets[SMP_MAX_CPUS];
+
+// Copies of each CPU, a cache line apart from the next
+static uint8_t percpu_areas[SMP_MAX_CPUS][PERCPU_AREA_SIZE] __attribute__((aligned(64)));
+
+// Per-CPU test configuration, counter updates per CPU
+#define PERCPU_TEST_ITERATIONS 1000
+
+static DEFINE_PER_CPU(uint32_t, percpu_test_owner); // CPU index + 1 of the writer
+static DEFINE_PER_CPU_COUNTER(percpu_test_counter);
+
+/**
+ * @brief Give every CPU its copy of the per-CPU variables and point
+ * TPIDR_EL1 of the boot CPU at copy 0
+ * 
+ * @return int EOK on success, -ENOMEM if the .percpu section does not
+ * fit in PERCPU_AREA_SIZE
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int percpu_init()
+{
+  size_t size = (size_t)(__percpu_end - __percpu_start);
+  if (size > PERCPU_AREA_SIZE)
+  {
+    // Every CPU keeps offset 0 and shares the template
+    uart_send_string("Per-CPU section larger than PERCPU_AREA_SIZE\n");
+    return -ENOMEM;
+  }
+
+  for (uint32_t i = 0; i < SMP_MAX_CPUS; i++)
+  {
+    memcpy(percpu_areas[i], __percpu_start, size);
+    percpu_offsets[i] = (uintptr_t)percpu_areas[i] - (uintptr_t)__percpu_start;
+  }
+
+  percpu_set_cpu(0);
+
+  return EOK;
+}
+
+/**
+ * @brief Point TPIDR_EL1 of the calling CPU at the copy of a CPU index
+ * 
+ * @param cpu CPU index
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void percpu_set_cpu(uint32_t cpu)
+{
+  if (cpu >= SMP_MAX_CPUS)
+  {
+    return;
+  }
+
+  __asm__ volatile("msr tpidr_el1, %0" :: "r" (percpu_offsets[cpu]) : "memory");
+}
+
+/**
+ * @brief Sum the copies of a per-CPU counter over every CPU
+ * 
+ * @param counter Per-CPU counter
+ * @return uint64_t Total
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t percpu_counter_sum(percpu_counter_t* counter)
+{
+  uint64_t total = 0;
+
+  // Offline CPUs hold the initial value, zero for counters
+  for (uint32_t i = 0; i < SMP_MAX_CPUS; i++)
+  {
+    total += *(volatile percpu_counter_t*)per_cpu_ptr(counter, i);
+  }
+
+  return total;
+}
+
+/**
+ * @brief Set every copy of a per-CPU counter to zero, updates racing
+ * with it may be lost
+ * 
+ * @param counter Per-CPU counter
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void percpu_counter_reset(percpu_counter_t* counter)
+{
+  for (uint32_t i = 0; i < SMP_MAX_CPUS; i++)
+  {
+    *(volatile percpu_counter_t*)per_cpu_ptr(counter, i) = 0;
+  }
+}
+
+/**
+ * @brief Per-CPU test body run by every CPU: count into its own copy and
+ * record which CPU it ran on
+ * 
+ * @param arg Unused
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void percpu_test_worker(void* arg)
+{
+  uint32_t cpu = smp_processor_id();
+
+  this_cpu_write(percpu_test_owner, cpu + 1);
+  for (uint32_t i = 0; i < PERCPU_TEST_ITERATIONS; i++)
+  {
+    percpu_counter_add(&percpu_test_counter, cpu + 1);
+  }
+}
+
+/**
+ * @brief Test the per-CPU variables: distinct copies per CPU, accessors
+ * of the calling CPU, and counters summed over every CPU
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int percpu_test()
+{
+  uart_send_string("\n=== Testing Per-CPU Data ===\n");
+
+  // Every CPU has its own copy, the calling CPU reaches its own
+  uint32_t self = smp_processor_id();
+  if (this_cpu_ptr(&percpu_test_owner) != per_cpu_ptr(&percpu_test_owner, self) ||
+      per_cpu_ptr(&percpu_test_owner, 0) == per_cpu_ptr(&percpu_test_owner, 1) ||
+      (uintptr_t)this_cpu_ptr(&percpu_test_owner) == (uintptr_t)&percpu_test_owner)
+  {
+    uart_send_string("FAIL: Per-CPU copies not set up\n");
+    return -EIO;
+  }
+
+  this_cpu_write(percpu_test_owner, 42);
+  if (this_cpu_read(percpu_test_owner) != 42 || per_cpu(percpu_test_owner, self) != 42 ||
+      per_cpu(percpu_test_owner, self == 0 ? 1 : 0) != 0)
+  {
+    uart_send_string("FAIL: Per-CPU write reached another copy\n");
+    return -EIO;
+  }
+
+  percpu_counter_reset(&percpu_test_counter);
+  percpu_counter_add(&percpu_test_counter, 5);
+  percpu_counter_inc(&percpu_test_counter);
+  if (percpu_counter_sum(&percpu_test_counter) != 6)
+  {
+    uart_send_string("FAIL: Per-CPU counter sum is wrong\n");
+    return -EIO;
+  }
+
+  // Each CPU counts into its own copy, the sum covers all of them
+  uint32_t cpus = smp_cpu_count();
+  uint64_t expected = 0;
+  percpu_counter_reset(&percpu_test_counter);
+  smp_run(cpus, percpu_test_worker, NULL);
+
+  for (uint32_t i = 0; i < cpus; i++)
+  {
+    uint64_t count = (uint64_t)(i + 1) * PERCPU_TEST_ITERATIONS;
+    if (per_cpu(percpu_test_owner, i) != i + 1 || per_cpu(percpu_test_counter, i) != count)
+    {
+      uart_send_string("FAIL: CPU ");
+      uart_send_string(uint_to_str(i));
+      uart_send_string(" did not count into its own copy\n");
+      return -EIO;
+    }
+    expected += count;
+  }
+
+  if (percpu_counter_sum(&percpu_test_counter) != expected)
+  {
+    uart_send_string("FAIL: Per-CPU counter sum over CPUs is wrong\n");
+    return -EIO;
+  }
+
+  if (cpus == 1)
+  {
+    uart_send_string("Single CPU, secondary copies not tested (run with SMP=4)\n");
+  }
+
+  uart_send_string("Per-CPU tests passed\n");
+  return EOK;
+}
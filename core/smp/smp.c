@@ -0,0 +1,380 @@
+/*
+ * smp.c - This file implements the secondary CPU bring-up. CPU 0 starts
+ * each CPU of the device tree with PSCI CPU_ON, passing its smp_cpu_t as
+ * the context id. start.S drops the CPU to EL1 on the stack found in it
+ * and calls smp_secondary_main(), which sleeps in WFE until CPU 0 posts
+ * a call in the mailbox.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "smp.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/fdt/fdt.h>
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/rcu.h>
+#include <synapse/sync/atomic.h>
+#include <synapse/scheduler/preempt.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// Affinity fields of MPIDR_EL1 (Aff3, Aff2, Aff1, Aff0)
+#define SMP_MPIDR_AFFINITY_MASK 0xFF00FFFFFFULL
+
+// How long a started CPU gets to come online, in ms
+#define SMP_ONLINE_TIMEOUT_MS 100
+
+// Entry of the secondary CPUs, in start.S
+extern char secondary_entry[];
+
+static smp_cpu_t smp_cpus[SMP_MAX_CPUS];
+static uint8_t smp_stacks[SMP_MAX_CPUS][SMP_STACK_SIZE] __attribute__((aligned(16)));
+static uint32_t smp_online_count = 1;
+static fdt_psci_method_t smp_psci_method = FDT_PSCI_NONE;
+
+// Index of the CPU owning each per-CPU copy
+static DEFINE_PER_CPU(uint32_t, smp_cpu_index);
+
+/**
+ * @brief Read the affinity of the calling CPU
+ * 
+ * @return uint64_t MPIDR_EL1 affinity fields
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t smp_read_mpidr()
+{
+  uint64_t value;
+  __asm__ volatile("mrs %0, mpidr_el1" : "=r" (value));
+  return value & SMP_MPIDR_AFFINITY_MASK;
+}
+
+/**
+ * @brief Call the PSCI firmware with the conduit of the device tree
+ * 
+ * @param function PSCI function ID
+ * @param arg0 First argument
+ * @param arg1 Second argument
+ * @param arg2 Third argument
+ * @return int64_t PSCI return code
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int64_t smp_psci_call(uint64_t function, uint64_t arg0, uint64_t arg1, uint64_t arg2)
+{
+  register uint64_t x0 __asm__("x0") = function;
+  register uint64_t x1 __asm__("x1") = arg0;
+  register uint64_t x2 __asm__("x2") = arg1;
+  register uint64_t x3 __asm__("x3") = arg2;
+
+  // SMCCC 1.0 firmware may clobber x4-x17
+  if (smp_psci_method == FDT_PSCI_HVC)
+  {
+    __asm__ volatile("hvc #0"
+                     : "+r" (x0), "+r" (x1), "+r" (x2), "+r" (x3)
+                     :
+                     : "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13", "x14", "x15", "x16", "x17",
+                       "memory");
+  }
+  else
+  {
+    __asm__ volatile("smc #0"
+                     : "+r" (x0), "+r" (x1), "+r" (x2), "+r" (x3)
+                     :
+                     : "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13", "x14", "x15", "x16", "x17",
+                       "memory");
+  }
+
+  return (int64_t)x0;
+}
+
+/**
+ * @brief Start one secondary CPU and wait until it is online
+ * 
+ * @param cpu Bring-up data of the CPU, stack and affinity set
+ * @return int EOK on success, -EIO if the firmware refused,
+ * -ENOTREADY if the CPU did not come online in time
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int smp_start_cpu(smp_cpu_t* cpu)
+{
+  // The CPU starts with its caches off, everything it reads must be in memory
+  smp_mb();
+
+  int64_t res = smp_psci_call(PSCI_CPU_ON_64, cpu->mpidr, (uint64_t)secondary_entry, (uint64_t)cpu);
+  if (res != PSCI_SUCCESS)
+  {
+    return -EIO;
+  }
+
+  uint64_t timeout = (timer_read_frequency() * SMP_ONLINE_TIMEOUT_MS) / 1000;
+  uint64_t start = timer_read_counter();
+  while (!atomic_load_acquire_32(&cpu->online))
+  {
+    if (timer_read_counter() - start > timeout)
+    {
+      return -ENOTREADY;
+    }
+    cpu_relax();
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Start every secondary CPU of the device tree and wait until
+ * they are online
+ * 
+ * @return int EOK on success (also with a single CPU), -ENOTREADY if
+ * the platform has no PSCI
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int smp_init()
+{
+  const fdt_platform_t* platform = fdt_get_platform();
+
+  smp_cpus[0].mpidr = smp_read_mpidr();
+  smp_cpus[0].index = 0;
+  smp_cpus[0].online = 1;
+  smp_online_count = 1;
+
+  uint32_t total = platform->cpu_count < SMP_MAX_CPUS ? platform->cpu_count : SMP_MAX_CPUS;
+  if (total <= 1)
+  {
+    return EOK;
+  }
+
+  if (platform->psci_method == FDT_PSCI_NONE)
+  {
+    uart_send_string("SMP: no PSCI, running on CPU 0 only\n");
+    return -ENOTREADY;
+  }
+  smp_psci_method = platform->psci_method;
+
+  // The boot CPU keeps index 0 wherever the tree lists it
+  uint32_t count = 1;
+  for (uint32_t i = 0; i < total; i++)
+  {
+    uint64_t mpidr = platform->cpu_mpidr[i] & SMP_MPIDR_AFFINITY_MASK;
+    if (mpidr == smp_cpus[0].mpidr)
+    {
+      continue;
+    }
+
+    smp_cpu_t* cpu = &smp_cpus[count];
+    cpu->stack_top = (uint64_t)(uintptr_t)&smp_stacks[count][0] + SMP_STACK_SIZE;
+    cpu->mpidr = mpidr;
+    cpu->index = count;
+
+    int res = smp_start_cpu(cpu);
+    if (res < 0)
+    {
+      uart_send_string("SMP: CPU ");
+      uart_send_string(uint_to_str(count));
+      uart_send_string(res == -EIO ? " refused by PSCI\n" : " did not come online\n");
+
+      // A late CPU still owns this slot, stop here
+      if (res == -ENOTREADY)
+      {
+        break;
+      }
+      continue;
+    }
+
+    count++;
+  }
+
+  smp_online_count = count;
+
+  uart_send_string("SMP: ");
+  uart_send_string(uint_to_str(smp_online_count));
+  uart_send_string(" CPUs online\n");
+
+  return EOK;
+}
+
+/**
+ * @brief Get the number of CPUs online, CPU 0 included
+ * 
+ * @return uint32_t CPUs online
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t smp_cpu_count()
+{
+  return smp_online_count;
+}
+
+/**
+ * @brief Get the index of the calling CPU
+ * 
+ * @return uint32_t Index, 0 for the boot CPU
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t smp_processor_id()
+{
+  return this_cpu_read(smp_cpu_index);
+}
+
+/**
+ * @brief Run a function on a secondary CPU without waiting for it,
+ * a previous call still running is waited for first
+ * 
+ * @param cpu Secondary CPU index
+ * @param fn Function
+ * @param arg Argument passed to fn
+ * @return int EOK on success, -EINVARG if the CPU is not an online secondary
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int smp_call(uint32_t cpu, SMP_CALL_FUNCTION fn, void* arg)
+{
+  if (cpu == 0 || cpu >= smp_online_count || !fn)
+  {
+    return -EINVARG;
+  }
+
+  smp_wait(cpu);
+
+  smp_cpu_t* target = &smp_cpus[cpu];
+  target->call = fn;
+  target->call_arg = arg;
+
+  // Release store, the call is visible before the CPU sees the new sequence
+  atomic_store_release_32(&target->call_seq, target->call_seq + 1);
+  cpu_send_event();
+
+  return EOK;
+}
+
+/**
+ * @brief Wait until the last call of a secondary CPU has returned
+ * 
+ * @param cpu Secondary CPU index
+ * @return int EOK on success, -EINVARG if the CPU is not an online secondary
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int smp_wait(uint32_t cpu)
+{
+  if (cpu == 0 || cpu >= smp_online_count)
+  {
+    return -EINVARG;
+  }
+
+  // Grace periods need not wait for a CPU sleeping outside read sections
+  bool idle = !rcu_read_lock_held();
+  if (idle)
+  {
+    rcu_idle_enter();
+  }
+
+  smp_cpu_t* target = &smp_cpus[cpu];
+  while (atomic_load_exclusive_32(&target->done_seq) != target->call_seq)
+  {
+    cpu_wait_event();
+  }
+
+  if (idle)
+  {
+    rcu_idle_exit();
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Run a function on the first CPUs at the same time, the caller
+ * being CPU 0, and wait until every one has returned
+ * 
+ * @param count CPUs to use, 1 to smp_cpu_count()
+ * @param fn Function
+ * @param arg Argument passed to fn on every CPU
+ * @return int EOK on success, -EINVARG if count is out of range
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int smp_run(uint32_t count, SMP_CALL_FUNCTION fn, void* arg)
+{
+  if (count == 0 || count > smp_online_count || !fn)
+  {
+    return -EINVARG;
+  }
+
+  for (uint32_t i = 1; i < count; i++)
+  {
+    smp_call(i, fn, arg);
+  }
+
+  fn(arg);
+
+  for (uint32_t i = 1; i < count; i++)
+  {
+    smp_wait(i);
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief C entry of a secondary CPU, called by start.S on its own stack
+ * 
+ * @param cpu Bring-up data of the CPU
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void smp_secondary_main(smp_cpu_t* cpu)
+{
+  uint32_t done = 0;
+
+  // Per-CPU data first, everything below may use it
+  percpu_set_cpu(cpu->index);
+  this_cpu_write(smp_cpu_index, cpu->index);
+
+  // Secondaries run no tasks, an IRQ they take once interrupt_init()
+  // routes some to them must return here rather than switch tasks
+  preempt_disable();
+
+  atomic_store_release_32(&cpu->online, 1);
+  cpu_send_event();
+
+  while (1)
+  {
+    // Sleep until CPU 0 bumps the sequence, its store wakes the WFE
+    uint32_t seq;
+    rcu_idle_enter();
+    while ((seq = atomic_load_exclusive_32(&cpu->call_seq)) == done)
+    {
+      cpu_wait_event();
+    }
+    rcu_idle_exit();
+
+    cpu->call(cpu->call_arg);
+    rcu_quiescent_state();
+
+    done = seq;
+    atomic_store_release_32(&cpu->done_seq, done);
+    cpu_send_event();
+  }
+}
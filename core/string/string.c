@@ -4,7 +4,7 @@
  *
  * Author: Fedi Nabli
  * Date: 26 Mar 2025
- * Last Modified: 26 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include <synapse/string/string.h>
@@ -12,6 +12,11 @@
 #include <synapse/bool.h>
 #include <synapse/types.h>
 
+#include <synapse/smp/percpu.h>
+
+// Buffer of the number conversions, one per CPU so CPUs can print at once
+static DEFINE_PER_CPU(char, number_str_buffer[32]);
+
 /**
  * @brief Converts an upper case character to lower case
  * 
@@ -259,3 +264,75 @@ int tonumericdigit(char c)
 {
   return c - 48;
 }
+
+/**
+ * @brief Convert a number to a decimal string for UART output
+ * 
+ * @param value Number to convert
+ * @return char* String in a buffer of the calling CPU, valid until its
+ * next conversion
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+char* uint_to_str(uint64_t value)
+{
+  char* buffer = this_cpu_ptr(&number_str_buffer[0]);
+  int i = 0;
+
+  do
+  {
+    buffer[i++] = '0' + (value % 10);
+    value /= 10;
+  } while (value > 0 && i < 31);
+
+  buffer[i] = '\0';
+
+  // Reverse the string
+  int j = 0;
+  i--;
+  while (j < i)
+  {
+    char temp = buffer[j];
+    buffer[j] = buffer[i];
+    buffer[i] = temp;
+    j++;
+    i--;
+  }
+
+  return buffer;
+}
+
+/**
+ * @brief Convert a number to a hex string with a 0x prefix and no leading
+ * zeros for UART output
+ * 
+ * @param value Number to convert
+ * @return char* String in a buffer of the calling CPU, valid until its
+ * next conversion
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+char* uint_to_hex(uint64_t value)
+{
+  char* buffer = this_cpu_ptr(&number_str_buffer[0]);
+  int i = 0;
+  bool significant = false;
+
+  buffer[i++] = '0';
+  buffer[i++] = 'x';
+
+  for (int shift = 60; shift >= 0; shift -= 4)
+  {
+    uint32_t digit = (value >> shift) & 0xF;
+    if (digit != 0 || significant || shift == 0)
+    {
+      buffer[i++] = digit < 10 ? '0' + digit : 'A' + (digit - 10);
+      significant = true;
+    }
+  }
+
+  buffer[i] = '\0';
+  return buffer;
+}
@@ -0,0 +1,657 @@
+/*
+ * queue.c - This file implements the benchmark of the lock-free queues,
+ * the queues themselves are header-only. Each run moves items from the
+ * producers to the consumers of one queue and reports the cost per item.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "queue.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <kernel/config.h>
+#include <synapse/smp/smp.h>
+#include <synapse/sync/atomic.h>
+#include <synapse/memory/memory.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// Benchmark configuration, items per producer
+#define QUEUE_BENCH_ITERATIONS 20000
+#define QUEUE_BENCH_RING_SIZE 256
+#define QUEUE_BENCH_POOL 64 // MPSC nodes per producer, reused once consumed
+
+// Benchmarked queues
+typedef enum
+{
+  QUEUE_BENCH_SPSC,
+  QUEUE_BENCH_MPSC,
+  QUEUE_BENCH_MPMC,
+  QUEUE_BENCH_COUNT
+} queue_bench_kind_t;
+
+static const char* queue_bench_names[QUEUE_BENCH_COUNT] = {
+  "SPSC ring ",
+  "MPSC queue",
+  "MPMC ring "
+};
+
+// MPSC node of the benchmark, busy until the consumer has taken it
+typedef struct
+{
+  mpsc_node_t node;
+  volatile uint32_t busy;
+} queue_bench_node_t;
+
+// State shared by the CPUs of one benchmark run
+typedef struct
+{
+  queue_bench_kind_t kind;
+  uint32_t cpus;
+  volatile uint32_t arrived; // Start barrier
+  volatile uint64_t consumed; // Items taken
+  volatile uint64_t checksum; // Sum of the items taken
+  spsc_ring_t spsc;
+  mpsc_queue_t mpsc;
+  mpmc_ring_t mpmc;
+} queue_bench_t;
+
+static queue_bench_t queue_bench;
+
+static void* queue_bench_slots[QUEUE_BENCH_RING_SIZE];
+static mpmc_cell_t queue_bench_cells[QUEUE_BENCH_RING_SIZE];
+static queue_bench_node_t queue_bench_nodes[SMP_MAX_CPUS][QUEUE_BENCH_POOL];
+
+// Queue test configuration, items per producer, rings small enough to wrap
+#define QUEUE_TEST_ITEMS 500
+#define QUEUE_TEST_RING_SIZE 16
+
+// Node of the MPSC queue test
+typedef struct
+{
+  mpsc_node_t node;
+  uint32_t producer;
+  uint32_t seq; // 1 for the first node of its producer
+} queue_test_node_t;
+
+// State shared by the CPUs of the queue test
+typedef struct
+{
+  uint32_t kind; // 0 SPSC ring, 1 MPSC queue, 2 MPMC ring
+  uint32_t cpus;
+  volatile uint32_t arrived; // Start barrier
+  volatile uint32_t errors; // Items lost, duplicated or out of order
+  volatile uint64_t consumed;
+  spsc_ring_t spsc;
+  mpsc_queue_t mpsc;
+  mpmc_ring_t mpmc;
+} queue_test_state_t;
+
+static queue_test_state_t queue_test_state;
+static void* queue_test_slots[QUEUE_TEST_RING_SIZE];
+static mpmc_cell_t queue_test_cells[QUEUE_TEST_RING_SIZE];
+static queue_test_node_t queue_test_nodes[SMP_MAX_CPUS][QUEUE_TEST_ITEMS];
+static volatile uint32_t queue_test_taken[SMP_MAX_CPUS][QUEUE_TEST_ITEMS]; // MPMC items taken
+
+/**
+ * @brief Move items through the SPSC ring: CPU 1 produces and CPU 0
+ * consumes, or CPU 0 alone pushes and pops in turn
+ * 
+ * @param bench State of the run
+ * @param cpu Index of the calling CPU
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void queue_bench_spsc(queue_bench_t* bench, uint32_t cpu)
+{
+  uint64_t sum = 0;
+  void* item;
+
+  if (bench->cpus == 1)
+  {
+    for (uint64_t i = 1; i <= QUEUE_BENCH_ITERATIONS; i++)
+    {
+      spsc_ring_push(&bench->spsc, (void*)(uintptr_t)i);
+      if (spsc_ring_pop(&bench->spsc, &item))
+      {
+        sum += (uintptr_t)item;
+      }
+    }
+  }
+  else if (cpu == 1)
+  {
+    for (uint64_t i = 1; i <= QUEUE_BENCH_ITERATIONS; i++)
+    {
+      while (!spsc_ring_push(&bench->spsc, (void*)(uintptr_t)i))
+      {
+        cpu_relax();
+      }
+    }
+    return;
+  }
+  else
+  {
+    for (uint64_t i = 0; i < QUEUE_BENCH_ITERATIONS; i++)
+    {
+      while (!spsc_ring_pop(&bench->spsc, &item))
+      {
+        cpu_relax();
+      }
+      sum += (uintptr_t)item;
+    }
+  }
+
+  bench->consumed = QUEUE_BENCH_ITERATIONS;
+  bench->checksum = sum;
+}
+
+/**
+ * @brief Move nodes through the MPSC queue: every CPU but 0 produces
+ * from its pool and CPU 0 consumes, or CPU 0 alone pushes and pops in turn
+ * 
+ * @param bench State of the run
+ * @param cpu Index of the calling CPU
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void queue_bench_mpsc(queue_bench_t* bench, uint32_t cpu)
+{
+  uint64_t expected = (uint64_t)(bench->cpus == 1 ? 1 : bench->cpus - 1) * QUEUE_BENCH_ITERATIONS;
+  uint64_t taken = 0;
+
+  if (bench->cpus == 1)
+  {
+    for (uint32_t i = 0; i < QUEUE_BENCH_ITERATIONS; i++)
+    {
+      mpsc_queue_push(&bench->mpsc, &queue_bench_nodes[0][i % QUEUE_BENCH_POOL].node);
+      if (mpsc_queue_pop(&bench->mpsc))
+      {
+        taken++;
+      }
+    }
+  }
+  else if (cpu != 0)
+  {
+    for (uint32_t i = 0; i < QUEUE_BENCH_ITERATIONS; i++)
+    {
+      queue_bench_node_t* node = &queue_bench_nodes[cpu][i % QUEUE_BENCH_POOL];
+      while (atomic_load_acquire_32(&node->busy))
+      {
+        cpu_relax();
+      }
+      node->busy = 1;
+      mpsc_queue_push(&bench->mpsc, &node->node);
+    }
+    return;
+  }
+  else
+  {
+    while (taken < expected)
+    {
+      queue_bench_node_t* node = (queue_bench_node_t*)mpsc_queue_pop(&bench->mpsc);
+      if (!node)
+      {
+        cpu_relax();
+        continue;
+      }
+
+      // Hand the node back to its producer
+      atomic_store_release_32(&node->busy, 0);
+      taken++;
+    }
+  }
+
+  bench->consumed = taken;
+  bench->checksum = taken;
+}
+
+/**
+ * @brief Move items through the MPMC ring: every CPU pushes one item then
+ * pops one, at most one item per CPU is queued so the ring never fills
+ * 
+ * @param bench State of the run
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void queue_bench_mpmc(queue_bench_t* bench)
+{
+  uint64_t sum = 0;
+  void* item;
+
+  for (uint64_t i = 1; i <= QUEUE_BENCH_ITERATIONS; i++)
+  {
+    while (!mpmc_ring_push(&bench->mpmc, (void*)(uintptr_t)i))
+    {
+      cpu_relax();
+    }
+
+    // A cell claimed but not filled yet reads as empty
+    while (!mpmc_ring_pop(&bench->mpmc, &item))
+    {
+      cpu_relax();
+    }
+    sum += (uintptr_t)item;
+  }
+
+  atomic_fetch_add_64(&bench->consumed, QUEUE_BENCH_ITERATIONS);
+  atomic_fetch_add_64(&bench->checksum, sum);
+}
+
+/**
+ * @brief Benchmark body run by every CPU
+ * 
+ * @param arg queue_bench_t of the run
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void queue_bench_worker(void* arg)
+{
+  queue_bench_t* bench = (queue_bench_t*)arg;
+  uint32_t cpu = smp_processor_id();
+
+  // Start together so every CPU contends from the first item
+  atomic_fetch_add_32(&bench->arrived, 1);
+  while (atomic_load_acquire_32(&bench->arrived) < bench->cpus)
+  {
+    cpu_relax();
+  }
+
+  switch (bench->kind)
+  {
+    case QUEUE_BENCH_SPSC:
+      queue_bench_spsc(bench, cpu);
+      break;
+
+    case QUEUE_BENCH_MPSC:
+      queue_bench_mpsc(bench, cpu);
+      break;
+
+    default:
+      queue_bench_mpmc(bench);
+      break;
+  }
+}
+
+/**
+ * @brief Time the queues on 1 to all online CPUs, in cycles per item
+ * moved from a producer to a consumer
+ * 
+ * @return int EOK on success, -EFAULT if items were lost or duplicated
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int queue_benchmark()
+{
+  int res = EOK;
+  uint32_t cpus = smp_cpu_count();
+  uint64_t frequency = timer_read_frequency();
+  uint64_t per_producer = ((uint64_t)QUEUE_BENCH_ITERATIONS * (QUEUE_BENCH_ITERATIONS + 1)) / 2;
+
+  uart_send_string("\n=== Queue Benchmark ===\n");
+  uart_send_string("Cycles per item at ");
+  uart_send_string(uint_to_str(CPU_FREQ_HZ / 1000000));
+  uart_send_string(" MHz, CPUs online: ");
+  uart_send_string(uint_to_str(cpus));
+  uart_send_string(cpus > 1 ? "\n" : ", run QEMU with SMP=4 for contention\n");
+
+  for (uint32_t kind = 0; kind < QUEUE_BENCH_COUNT; kind++)
+  {
+    // One producer and one consumer at most
+    uint32_t max_cpus = kind == QUEUE_BENCH_SPSC && cpus > 2 ? 2 : cpus;
+
+    for (uint32_t n = 1; n <= max_cpus; n++)
+    {
+      memset((void*)&queue_bench, 0, sizeof(queue_bench));
+      memset(queue_bench_nodes, 0, sizeof(queue_bench_nodes));
+      queue_bench.kind = (queue_bench_kind_t)kind;
+      queue_bench.cpus = n;
+      spsc_ring_init(&queue_bench.spsc, queue_bench_slots, QUEUE_BENCH_RING_SIZE);
+      mpsc_queue_init(&queue_bench.mpsc);
+      mpmc_ring_init(&queue_bench.mpmc, queue_bench_cells, QUEUE_BENCH_RING_SIZE);
+
+      uint64_t start = timer_read_counter();
+      smp_run(n, queue_bench_worker, &queue_bench);
+      uint64_t ticks = timer_read_counter() - start;
+
+      uint64_t items;
+      uint64_t checksum;
+      switch (kind)
+      {
+        case QUEUE_BENCH_SPSC:
+          items = QUEUE_BENCH_ITERATIONS;
+          checksum = per_producer;
+          break;
+
+        case QUEUE_BENCH_MPSC:
+          items = (uint64_t)(n == 1 ? 1 : n - 1) * QUEUE_BENCH_ITERATIONS;
+          checksum = items;
+          break;
+
+        default:
+          items = (uint64_t)n * QUEUE_BENCH_ITERATIONS;
+          checksum = n * per_producer;
+          break;
+      }
+
+      uart_send_string("  ");
+      uart_send_string(queue_bench_names[kind]);
+      uart_send_string(" x");
+      uart_send_string(uint_to_str(n));
+      uart_send_string(": ");
+      uart_send_string(uint_to_str((ticks * (CPU_FREQ_HZ / 1000)) / (frequency / 1000) / items));
+      uart_send_string(" cycles/item");
+      if (queue_bench.consumed != items || queue_bench.checksum != checksum)
+      {
+        uart_send_string(" ITEM MISMATCH");
+        res = -EFAULT;
+      }
+      uart_send_string("\n");
+    }
+  }
+
+  return res;
+}
+
+/**
+ * @brief Queue test body of the MPMC ring run by every CPU: push its own
+ * items and pop any, until every item has been taken
+ * 
+ * @param state State of the run
+ * @param cpu Index of the calling CPU
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void queue_test_mpmc(queue_test_state_t* state, uint32_t cpu)
+{
+  uint64_t total = (uint64_t)state->cpus * QUEUE_TEST_ITEMS;
+  uint32_t last[SMP_MAX_CPUS] = {0};
+  uint32_t pushed = 0;
+  void* item;
+
+  while (atomic_load_acquire_64(&state->consumed) < total)
+  {
+    if (pushed < QUEUE_TEST_ITEMS &&
+        mpmc_ring_push(&state->mpmc, (void*)(((uintptr_t)cpu << 32) | (pushed + 1))))
+    {
+      pushed++;
+    }
+
+    if (!mpmc_ring_pop(&state->mpmc, &item))
+    {
+      cpu_relax();
+      continue;
+    }
+
+    uint32_t producer = (uint32_t)((uintptr_t)item >> 32);
+    uint32_t seq = (uint32_t)(uintptr_t)item;
+    if (producer >= state->cpus || seq == 0 || seq > QUEUE_TEST_ITEMS)
+    {
+      atomic_fetch_add_32(&state->errors, 1);
+      atomic_fetch_add_64(&state->consumed, 1);
+      continue;
+    }
+
+    // FIFO: one consumer sees the items of a producer in push order
+    if (seq <= last[producer])
+    {
+      atomic_fetch_add_32(&state->errors, 1);
+    }
+    last[producer] = seq;
+
+    atomic_fetch_add_32(&queue_test_taken[producer][seq - 1], 1);
+    atomic_fetch_add_64(&state->consumed, 1);
+  }
+}
+
+/**
+ * @brief Queue test body run by every CPU. SPSC: CPU 1 produces, CPU 0
+ * checks the exact sequence. MPSC: the other CPUs produce, CPU 0 checks
+ * the order of each producer. MPMC: every CPU produces and consumes.
+ * 
+ * @param arg queue_test_state_t of the run
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void queue_test_worker(void* arg)
+{
+  queue_test_state_t* state = (queue_test_state_t*)arg;
+  uint32_t cpu = smp_processor_id();
+
+  atomic_fetch_add_32(&state->arrived, 1);
+  while (atomic_load_acquire_32(&state->arrived) < state->cpus)
+  {
+    cpu_relax();
+  }
+
+  if (state->kind == 0)
+  {
+    void* item;
+
+    for (uint64_t i = 1; i <= QUEUE_TEST_ITEMS; i++)
+    {
+      if (cpu == 1)
+      {
+        while (!spsc_ring_push(&state->spsc, (void*)(uintptr_t)i))
+        {
+          cpu_relax();
+        }
+        continue;
+      }
+
+      while (!spsc_ring_pop(&state->spsc, &item))
+      {
+        cpu_relax();
+      }
+      if ((uintptr_t)item != i)
+      {
+        atomic_fetch_add_32(&state->errors, 1);
+      }
+      state->consumed++;
+    }
+  }
+  else if (state->kind == 1)
+  {
+    if (cpu != 0)
+    {
+      for (uint32_t i = 0; i < QUEUE_TEST_ITEMS; i++)
+      {
+        mpsc_queue_push(&state->mpsc, &queue_test_nodes[cpu][i].node);
+      }
+      return;
+    }
+
+    uint32_t last[SMP_MAX_CPUS] = {0};
+    uint64_t total = (uint64_t)(state->cpus - 1) * QUEUE_TEST_ITEMS;
+    while (state->consumed < total)
+    {
+      queue_test_node_t* node = (queue_test_node_t*)mpsc_queue_pop(&state->mpsc);
+      if (!node)
+      {
+        cpu_relax();
+        continue;
+      }
+
+      // Every node exactly once, in push order per producer
+      if (node->producer == 0 || node->producer >= state->cpus || node->seq != last[node->producer] + 1)
+      {
+        atomic_fetch_add_32(&state->errors, 1);
+      }
+      else
+      {
+        last[node->producer] = node->seq;
+      }
+      state->consumed++;
+    }
+
+    if (!mpsc_queue_empty(&state->mpsc))
+    {
+      atomic_fetch_add_32(&state->errors, 1);
+    }
+  }
+  else
+  {
+    queue_test_mpmc(state, cpu);
+  }
+}
+
+/**
+ * @brief Run one concurrent queue test
+ * 
+ * @param kind 0 SPSC ring, 1 MPSC queue, 2 MPMC ring
+ * @param cpus CPUs used
+ * @return uint32_t Errors seen
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t queue_test_run(uint32_t kind, uint32_t cpus)
+{
+  memset((void*)&queue_test_state, 0, sizeof(queue_test_state));
+  memset((void*)queue_test_taken, 0, sizeof(queue_test_taken));
+  queue_test_state.kind = kind;
+  queue_test_state.cpus = cpus;
+  spsc_ring_init(&queue_test_state.spsc, queue_test_slots, QUEUE_TEST_RING_SIZE);
+  mpsc_queue_init(&queue_test_state.mpsc);
+  mpmc_ring_init(&queue_test_state.mpmc, queue_test_cells, QUEUE_TEST_RING_SIZE);
+
+  for (uint32_t cpu = 0; cpu < SMP_MAX_CPUS; cpu++)
+  {
+    for (uint32_t i = 0; i < QUEUE_TEST_ITEMS; i++)
+    {
+      queue_test_nodes[cpu][i].producer = cpu;
+      queue_test_nodes[cpu][i].seq = i + 1;
+    }
+  }
+
+  smp_run(cpus, queue_test_worker, &queue_test_state);
+
+  uint32_t errors = queue_test_state.errors;
+  if (kind == 2)
+  {
+    for (uint32_t cpu = 0; cpu < cpus; cpu++)
+    {
+      for (uint32_t i = 0; i < QUEUE_TEST_ITEMS; i++)
+      {
+        errors += queue_test_taken[cpu][i] != 1;
+      }
+    }
+  }
+
+  return errors;
+}
+
+/**
+ * @brief Test the lock-free queues: capacity and order on one CPU, then
+ * producers and consumers on separate CPUs, where every item must be
+ * taken exactly once and in push order per producer
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int queue_test()
+{
+  uart_send_string("\n=== Testing Lock-Free Queues ===\n");
+
+  // SPSC ring: power of two capacity, full and empty, FIFO
+  spsc_ring_t* spsc = &queue_test_state.spsc;
+  void* item;
+  bool ok = spsc_ring_init(spsc, queue_test_slots, 12) == -EINVARG &&
+            spsc_ring_init(spsc, queue_test_slots, QUEUE_TEST_RING_SIZE) == EOK;
+  for (uintptr_t i = 1; ok && i <= QUEUE_TEST_RING_SIZE; i++)
+  {
+    ok = spsc_ring_push(spsc, (void*)i);
+  }
+  ok = ok && !spsc_ring_push(spsc, (void*)1) && spsc_ring_count(spsc) == QUEUE_TEST_RING_SIZE;
+  for (uintptr_t i = 1; ok && i <= QUEUE_TEST_RING_SIZE; i++)
+  {
+    ok = spsc_ring_pop(spsc, &item) && item == (void*)i;
+  }
+  if (!ok || spsc_ring_pop(spsc, &item))
+  {
+    uart_send_string("FAIL: SPSC ring capacity or order wrong\n");
+    return -EIO;
+  }
+
+  // MPSC queue: FIFO through the stub, empty afterwards
+  mpsc_queue_t* mpsc = &queue_test_state.mpsc;
+  mpsc_queue_init(mpsc);
+  ok = mpsc_queue_empty(mpsc) && !mpsc_queue_pop(mpsc);
+  for (uint32_t i = 0; i < 3; i++)
+  {
+    mpsc_queue_push(mpsc, &queue_test_nodes[0][i].node);
+  }
+  for (uint32_t i = 0; ok && i < 3; i++)
+  {
+    ok = mpsc_queue_pop(mpsc) == &queue_test_nodes[0][i].node;
+  }
+  if (!ok || mpsc_queue_pop(mpsc) || !mpsc_queue_empty(mpsc))
+  {
+    uart_send_string("FAIL: MPSC queue order wrong\n");
+    return -EIO;
+  }
+
+  // MPMC ring: same contract as the SPSC ring, over several laps
+  mpmc_ring_t* mpmc = &queue_test_state.mpmc;
+  ok = mpmc_ring_init(mpmc, queue_test_cells, 1) == -EINVARG &&
+       mpmc_ring_init(mpmc, queue_test_cells, QUEUE_TEST_RING_SIZE) == EOK;
+  for (uint32_t lap = 0; ok && lap < 3; lap++)
+  {
+    for (uintptr_t i = 1; ok && i <= QUEUE_TEST_RING_SIZE; i++)
+    {
+      ok = mpmc_ring_push(mpmc, (void*)i);
+    }
+    ok = ok && !mpmc_ring_push(mpmc, (void*)1);
+    for (uintptr_t i = 1; ok && i <= QUEUE_TEST_RING_SIZE; i++)
+    {
+      ok = mpmc_ring_pop(mpmc, &item) && item == (void*)i;
+    }
+    ok = ok && !mpmc_ring_pop(mpmc, &item);
+  }
+  if (!ok)
+  {
+    uart_send_string("FAIL: MPMC ring capacity or order wrong\n");
+    return -EIO;
+  }
+
+  uint32_t cpus = smp_cpu_count();
+  if (cpus == 1)
+  {
+    uart_send_string("Single CPU, concurrent producers not tested (run with SMP=4)\n");
+    uart_send_string("Lock-free queue tests passed\n");
+    return EOK;
+  }
+
+  static const char* names[3] = { "SPSC ring", "MPSC queue", "MPMC ring" };
+  for (uint32_t kind = 0; kind < 3; kind++)
+  {
+    uint32_t errors = queue_test_run(kind, kind == 0 ? 2 : cpus);
+    if (errors != 0)
+    {
+      uart_send_string("FAIL: ");
+      uart_send_string(names[kind]);
+      uart_send_string(" lost, duplicated or reordered ");
+      uart_send_string(uint_to_str(errors));
+      uart_send_string(" items\n");
+      return -EIO;
+    }
+  }
+
+  uart_send_string("Lock-free queue tests passed\n");
+  return EOK;
+}
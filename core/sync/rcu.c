@@ -0,0 +1,454 @@
+/*
+ * rcu.c - This file implements the grace periods of read-copy-update.
+ * A writer starts a grace period by bumping rcu_gp_seq. Each CPU copies
+ * the sequence into its own rcu_qs_seq whenever it is outside any read
+ * section, and idle CPUs are skipped, so the grace period is over once
+ * every online CPU shows a sequence at least as new.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "rcu.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/smp/smp.h>
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/atomic.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/memory/memory.h>
+#include <synapse/interrupts/interrupt.h>
+#include <synapse/string/string.h>
+
+DEFINE_PER_CPU(uint32_t, rcu_nesting);
+DEFINE_PER_CPU(uint64_t, rcu_irq_flags);
+
+// Last grace period each CPU has seen from outside a read section
+static DEFINE_PER_CPU(uint64_t, rcu_qs_seq);
+// Set while the CPU sleeps, it holds no reference then
+static DEFINE_PER_CPU(uint32_t, rcu_idle);
+// Set while an IRQ taken from idle runs
+static DEFINE_PER_CPU(uint32_t, rcu_irq_from_idle);
+
+// Latest grace period started
+static volatile uint64_t rcu_gp_seq = 0;
+
+// Callbacks waiting for their grace period, oldest first
+static rcu_head_t* rcu_callback_head = NULL;
+static rcu_head_t* rcu_callback_tail = NULL;
+static spinlock_t rcu_callback_lock = SPINLOCK_INIT;
+
+// RCU test configuration, replacements of the published object
+#define RCU_TEST_UPDATES 200
+#define RCU_TEST_LIVE 0x4C495645U
+#define RCU_TEST_DEAD 0xDEADDEADU
+
+// Object published to the readers of the RCU test
+typedef struct
+{
+  volatile uint32_t magic; // RCU_TEST_LIVE until reclaimed
+  rcu_head_t rcu;
+} rcu_test_object_t;
+
+// State shared by the CPUs of the RCU test
+typedef struct
+{
+  rcu_test_object_t objects[2]; // Published in turn
+  rcu_test_object_t* current;
+  uint32_t cpus;
+  volatile uint32_t arrived; // Start barrier
+  volatile uint32_t done; // Set by CPU 0 after the last update
+  volatile uint32_t stale; // Reads that saw a reclaimed object
+  volatile uint32_t callbacks;
+} rcu_test_state_t;
+
+static rcu_test_state_t rcu_test_state;
+
+/**
+ * @brief Check if every online CPU has passed a quiescent state since a
+ * grace period started
+ * 
+ * @param gp_seq Grace period
+ * @return bool true if the grace period is over
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static bool rcu_gp_completed(uint64_t gp_seq)
+{
+  // Order the unpublish of the writer before the reads below
+  smp_mb();
+
+  uint32_t cpus = smp_cpu_count();
+  for (uint32_t i = 0; i < cpus; i++)
+  {
+    if (atomic_load_acquire_32(per_cpu_ptr(&rcu_idle, i)))
+    {
+      continue;
+    }
+
+    if (atomic_load_acquire_64(per_cpu_ptr(&rcu_qs_seq, i)) < gp_seq)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Report a quiescent state of the calling CPU, ignored inside a
+ * read section
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_quiescent_state()
+{
+  if (this_cpu_read(rcu_nesting) != 0)
+  {
+    return;
+  }
+
+  // Every read before this point is done
+  smp_mb();
+  atomic_store_release_64(this_cpu_ptr(&rcu_qs_seq), atomic_load_acquire_64(&rcu_gp_seq));
+}
+
+/**
+ * @brief Note a task switch on the calling CPU: the outgoing context is
+ * abandoned, so are its read sections, which is a quiescent state
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_note_context_switch()
+{
+  // An IRQ handler switching tasks never returns to its read section
+  this_cpu_write(rcu_nesting, 0);
+  rcu_quiescent_state();
+}
+
+/**
+ * @brief Mark the calling CPU idle, grace periods stop waiting for it
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_idle_enter()
+{
+  smp_mb();
+  atomic_store_release_32(this_cpu_ptr(&rcu_idle), 1);
+}
+
+/**
+ * @brief Mark the calling CPU busy again, before it reads anything
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_idle_exit()
+{
+  atomic_store_release_32(this_cpu_ptr(&rcu_idle), 0);
+
+  // A writer checking afterwards waits for us, one checking before has
+  // unpublished already and the loads below see the new version
+  smp_mb();
+}
+
+/**
+ * @brief Leave idle for an IRQ taken while the CPU sleeps, its handler
+ * reads like any other code
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_irq_enter()
+{
+  if (this_cpu_read(rcu_idle))
+  {
+    this_cpu_write(rcu_irq_from_idle, 1);
+    rcu_idle_exit();
+  }
+}
+
+/**
+ * @brief Go back to idle after an IRQ, if rcu_irq_enter() left it
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_irq_exit()
+{
+  if (this_cpu_read(rcu_irq_from_idle))
+  {
+    this_cpu_write(rcu_irq_from_idle, 0);
+    rcu_idle_enter();
+  }
+}
+
+/**
+ * @brief Wait until every read section running at the call has ended,
+ * must not be called inside a read section
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void synchronize_rcu()
+{
+  if (rcu_read_lock_held())
+  {
+    // The caller would wait for itself forever
+    uart_send_string("synchronize_rcu: called inside a read section\n");
+    return;
+  }
+
+  smp_mb();
+  uint64_t gp_seq = atomic_fetch_add_64(&rcu_gp_seq, 1) + 1;
+  rcu_quiescent_state();
+
+  while (!rcu_gp_completed(gp_seq))
+  {
+    cpu_relax();
+  }
+}
+
+/**
+ * @brief Run a callback once every read section running at the call has
+ * ended, without waiting
+ * 
+ * @param head Request embedded in the object to reclaim
+ * @param func Callback, runs from the timer tick or rcu_barrier()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void call_rcu(rcu_head_t* head, RCU_CALLBACK func)
+{
+  if (!head || !func)
+  {
+    return;
+  }
+
+  head->next = NULL;
+  head->func = func;
+
+  // Grace periods are taken in queue order, the list stays sorted
+  uint64_t flags = spin_lock_irqsave(&rcu_callback_lock);
+  head->gp_seq = atomic_fetch_add_64(&rcu_gp_seq, 1) + 1;
+  if (rcu_callback_tail)
+  {
+    rcu_callback_tail->next = head;
+  }
+  else
+  {
+    rcu_callback_head = head;
+  }
+  rcu_callback_tail = head;
+  spin_unlock_irqrestore(&rcu_callback_lock, flags);
+}
+
+/**
+ * @brief Run the queued callbacks whose grace period is over
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_process_callbacks()
+{
+  rcu_head_t* ready = NULL;
+  rcu_head_t* ready_tail = NULL;
+
+  rcu_quiescent_state();
+
+  uint64_t flags = spin_lock_irqsave(&rcu_callback_lock);
+  while (rcu_callback_head && rcu_gp_completed(rcu_callback_head->gp_seq))
+  {
+    rcu_head_t* head = rcu_callback_head;
+    rcu_callback_head = head->next;
+    if (!rcu_callback_head)
+    {
+      rcu_callback_tail = NULL;
+    }
+
+    head->next = NULL;
+    if (ready_tail)
+    {
+      ready_tail->next = head;
+    }
+    else
+    {
+      ready = head;
+    }
+    ready_tail = head;
+  }
+  spin_unlock_irqrestore(&rcu_callback_lock, flags);
+
+  // Callbacks free memory, never under the queue lock
+  while (ready)
+  {
+    rcu_head_t* next = ready->next;
+    ready->func(ready);
+    ready = next;
+  }
+}
+
+/**
+ * @brief Wait for a grace period and run every callback queued before
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_barrier()
+{
+  // Covers the grace period of every callback already queued
+  synchronize_rcu();
+  rcu_process_callbacks();
+}
+
+/**
+ * @brief RCU test callback, counts the reclaimed objects
+ * 
+ * @param head Request of the object
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rcu_test_callback(rcu_head_t* head)
+{
+  rcu_test_object_t* object = (rcu_test_object_t*)((uintptr_t)head - offsetof(rcu_test_object_t, rcu));
+  object->magic = RCU_TEST_DEAD;
+  atomic_fetch_add_32(&rcu_test_state.callbacks, 1);
+}
+
+/**
+ * @brief RCU test body run by every CPU: CPU 0 keeps replacing the
+ * published object and reclaims the old one after a grace period, the
+ * others read it and count any reclaimed object they see
+ * 
+ * @param arg rcu_test_state_t of the run
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void rcu_test_worker(void* arg)
+{
+  rcu_test_state_t* state = (rcu_test_state_t*)arg;
+
+  atomic_fetch_add_32(&state->arrived, 1);
+  while (atomic_load_acquire_32(&state->arrived) < state->cpus)
+  {
+    cpu_relax();
+  }
+
+  if (smp_processor_id() == 0)
+  {
+    for (uint32_t i = 0; i < RCU_TEST_UPDATES; i++)
+    {
+      rcu_test_object_t* old = state->current;
+      rcu_test_object_t* next = old == &state->objects[0] ? &state->objects[1] : &state->objects[0];
+
+      next->magic = RCU_TEST_LIVE;
+      rcu_assign_pointer(state->current, next);
+      synchronize_rcu();
+      old->magic = RCU_TEST_DEAD;
+    }
+
+    atomic_store_release_32(&state->done, 1);
+    return;
+  }
+
+  while (!atomic_load_acquire_32(&state->done))
+  {
+    rcu_read_lock();
+    rcu_test_object_t* object = rcu_dereference(state->current);
+    uint32_t first = object->magic;
+    cpu_relax();
+    uint32_t second = object->magic;
+    rcu_read_unlock();
+
+    if (first != RCU_TEST_LIVE || second != RCU_TEST_LIVE)
+    {
+      atomic_fetch_add_32(&state->stale, 1);
+    }
+
+    // Long loops report quiescent states themselves
+    rcu_quiescent_state();
+  }
+}
+
+/**
+ * @brief Test RCU: read sections nest and mask IRQs, grace periods end,
+ * callbacks run after rcu_barrier(), and readers on other CPUs never see
+ * an object reclaimed under them
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rcu_test()
+{
+  uart_send_string("\n=== Testing RCU ===\n");
+
+  // Read sections nest, IRQs come back with the outermost unlock
+  bool was_masked = interrupt_local_masked();
+  rcu_read_lock();
+  rcu_read_lock();
+  bool masked = interrupt_local_masked();
+  rcu_read_unlock();
+  bool held = rcu_read_lock_held();
+  rcu_read_unlock();
+  if (!masked || !held || rcu_read_lock_held() || interrupt_local_masked() != was_masked)
+  {
+    uart_send_string("FAIL: RCU read section nesting or IRQ state wrong\n");
+    return -EIO;
+  }
+
+  // Grace periods end and queued callbacks run once they have
+  memset((void*)&rcu_test_state, 0, sizeof(rcu_test_state));
+  rcu_test_state.objects[0].magic = RCU_TEST_LIVE;
+  rcu_test_state.objects[1].magic = RCU_TEST_LIVE;
+  synchronize_rcu();
+  call_rcu(&rcu_test_state.objects[0].rcu, rcu_test_callback);
+  call_rcu(&rcu_test_state.objects[1].rcu, rcu_test_callback);
+  rcu_barrier();
+  if (rcu_test_state.callbacks != 2 || rcu_test_state.objects[0].magic != RCU_TEST_DEAD ||
+      rcu_test_state.objects[1].magic != RCU_TEST_DEAD)
+  {
+    uart_send_string("FAIL: RCU callbacks not run after rcu_barrier()\n");
+    return -EIO;
+  }
+
+  // Readers on the other CPUs while CPU 0 replaces and reclaims
+  uint32_t cpus = smp_cpu_count();
+  if (cpus == 1)
+  {
+    uart_send_string("Single CPU, concurrent readers not tested (run with SMP=4)\n");
+    uart_send_string("RCU tests passed\n");
+    return EOK;
+  }
+
+  memset((void*)&rcu_test_state, 0, sizeof(rcu_test_state));
+  rcu_test_state.objects[0].magic = RCU_TEST_LIVE;
+  rcu_test_state.current = &rcu_test_state.objects[0];
+  rcu_test_state.cpus = cpus;
+  smp_run(cpus, rcu_test_worker, &rcu_test_state);
+
+  if (rcu_test_state.stale != 0)
+  {
+    uart_send_string("FAIL: Readers saw ");
+    uart_send_string(uint_to_str(rcu_test_state.stale));
+    uart_send_string(" reclaimed objects\n");
+    return -EIO;
+  }
+
+  uart_send_string("RCU tests passed\n");
+  return EOK;
+}
@@ -0,0 +1,1082 @@
+/*
+ * spinlock.c - This file implements the kernel locks: ticket spinlock,
+ * MCS queue lock and reader-writer spinlock, their IRQ-saving variants
+ * and the contention statistics of LOCK_STATS=1 builds. Waiters arm the
+ * exclusive monitor on the lock word and sleep in WFE, the releasing
+ * store wakes them.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "spinlock.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/smp/smp.h>
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/atomic.h>
+#include <synapse/memory/memory.h>
+#include <synapse/interrupts/interrupt.h>
+#include <synapse/scheduler/preempt.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// Benchmark configuration, iterations per CPU
+#define SPINLOCK_BENCH_ITERATIONS 20000
+
+// Benchmarked operations on the shared counter
+typedef enum
+{
+  SPINLOCK_BENCH_PERCPU, // Per-CPU counter, no shared line at all
+  SPINLOCK_BENCH_ATOMIC, // Fetch-add, the floor for any lock
+  SPINLOCK_BENCH_TICKET,
+  SPINLOCK_BENCH_MCS,
+  SPINLOCK_BENCH_WRITE,  // Reader-writer lock taken for writing
+  SPINLOCK_BENCH_READ,   // Reader-writer lock taken for reading
+  SPINLOCK_BENCH_COUNT
+} spinlock_bench_kind_t;
+
+static const char* spinlock_bench_names[SPINLOCK_BENCH_COUNT] = {
+  "per-CPU add ",
+  "atomic add  ",
+  "ticket lock ",
+  "MCS lock    ",
+  "rwlock write",
+  "rwlock read "
+};
+
+// State shared by the CPUs of one benchmark run
+typedef struct
+{
+  spinlock_bench_kind_t kind;
+  uint32_t cpus;
+  volatile uint32_t arrived; // Start barrier
+  volatile uint64_t counter; // Updated under the lock
+  spinlock_t ticket;
+  mcs_lock_t mcs;
+  rwlock_t rwlock;
+} spinlock_bench_t;
+
+static spinlock_bench_t spinlock_bench;
+
+// Counter of the per-CPU runs, summed into spinlock_bench.counter after
+static DEFINE_PER_CPU_COUNTER(spinlock_bench_percpu);
+
+// Lock test configuration, counter updates per CPU
+#define LOCK_TEST_ITERATIONS 5000
+#define LOCK_TEST_DAIF_I (1 << 7) // IRQ mask bit
+
+// State shared by the CPUs of the lock test
+typedef struct
+{
+  uint32_t kind; // 0 ticket lock, 1 MCS lock, 2 rwlock writers
+  uint32_t cpus;
+  volatile uint32_t arrived; // Start barrier
+  volatile uint64_t counter;
+  spinlock_t ticket;
+  mcs_lock_t mcs;
+  rwlock_t rwlock;
+} lock_test_state_t;
+
+static lock_test_state_t lock_test_state;
+
+#ifdef SYNAPSE_LOCK_STATS
+/**
+ * @brief Count one acquisition
+ * 
+ * @param stats Statistics of the lock
+ * @param waits Wake-ups spent waiting, 0 if the lock was free
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void lock_stats_record(lock_stats_t* stats, uint64_t waits)
+{
+  // Readers hold the lock together, the counters need atomic updates
+  atomic_fetch_add_64(&stats->acquisitions, 1);
+  if (waits)
+  {
+    atomic_fetch_add_64(&stats->contended, 1);
+    atomic_fetch_add_64(&stats->spins, waits);
+  }
+}
+
+#define LOCK_STATS_RECORD(lock, waits) lock_stats_record(&(lock)->stats, (waits))
+#define LOCK_STATS_GET(lock) ((const lock_stats_t*)&(lock)->stats)
+#else
+#define LOCK_STATS_RECORD(lock, waits) ((void)(waits))
+#define LOCK_STATS_GET(lock) ((const lock_stats_t*)NULL)
+#endif
+
+/**
+ * @brief Initialize a ticket spinlock
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void spin_lock_init(spinlock_t* lock)
+{
+  memset(lock, 0, sizeof(spinlock_t));
+}
+
+/**
+ * @brief Take a ticket spinlock, waiters are served in arrival order
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void spin_lock(spinlock_t* lock)
+{
+  preempt_disable();
+
+  uint32_t ticket = atomic_fetch_add_32(&lock->next, 1);
+  uint64_t waits = 0;
+
+  // The unlock of the ticket before ours writes owner and wakes us
+  while (atomic_load_exclusive_32(&lock->owner) != ticket)
+  {
+    cpu_wait_event();
+    waits++;
+  }
+
+  LOCK_STATS_RECORD(lock, waits);
+}
+
+/**
+ * @brief Take a ticket spinlock if it is free
+ * 
+ * @param lock Lock
+ * @return bool true if the lock was taken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool spin_trylock(spinlock_t* lock)
+{
+  preempt_disable();
+
+  // Free when no ticket is handed out past the owner, take the next one
+  uint32_t owner = atomic_load_acquire_32(&lock->owner);
+  if (atomic_cas_32(&lock->next, owner, owner + 1) != owner)
+  {
+    preempt_enable();
+    return false;
+  }
+
+  LOCK_STATS_RECORD(lock, 0);
+  return true;
+}
+
+/**
+ * @brief Release a ticket spinlock, the section ends at site
+ * 
+ * @param lock Lock
+ * @param site Code releasing it
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void spin_unlock_at(spinlock_t* lock, uintptr_t site)
+{
+  // Only the holder writes owner
+  atomic_store_release_32(&lock->owner, lock->owner + 1);
+  preempt_enable_at(site);
+}
+
+/**
+ * @brief Release a ticket spinlock
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void spin_unlock(spinlock_t* lock)
+{
+  spin_unlock_at(lock, (uintptr_t)__builtin_return_address(0));
+}
+
+/**
+ * @brief Check if a ticket spinlock is held
+ * 
+ * @param lock Lock
+ * @return bool true if held
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool spin_is_locked(spinlock_t* lock)
+{
+  return atomic_load_acquire_32(&lock->next) != atomic_load_acquire_32(&lock->owner);
+}
+
+/**
+ * @brief Mask IRQs on the local CPU, then take a ticket spinlock
+ * 
+ * @param lock Lock
+ * @return uint64_t Saved IRQ state for spin_unlock_irqrestore()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t spin_lock_irqsave(spinlock_t* lock)
+{
+  uint64_t flags = interrupt_local_save();
+  spin_lock(lock);
+  return flags;
+}
+
+/**
+ * @brief Release a ticket spinlock, then restore the IRQ state
+ * 
+ * @param lock Lock
+ * @param flags Value returned by spin_lock_irqsave()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void spin_unlock_irqrestore(spinlock_t* lock, uint64_t flags)
+{
+  spin_unlock_at(lock, (uintptr_t)__builtin_return_address(0));
+  interrupt_local_restore(flags);
+
+  // A switch asked for while IRQs were masked
+  cond_resched();
+}
+
+/**
+ * @brief Initialize a MCS queue lock
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void mcs_lock_init(mcs_lock_t* lock)
+{
+  memset(lock, 0, sizeof(mcs_lock_t));
+}
+
+/**
+ * @brief Take a MCS queue lock
+ * 
+ * @param lock Lock
+ * @param node Queue node of the caller, kept until mcs_unlock()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void mcs_lock(mcs_lock_t* lock, mcs_node_t* node)
+{
+  preempt_disable();
+
+  node->next = 0;
+  node->locked = 0;
+
+  // Queue at the tail, the swap also publishes the cleared node
+  uint64_t prev = atomic_xchg_64(&lock->tail, (uint64_t)(uintptr_t)node);
+  uint64_t waits = 0;
+
+  if (prev)
+  {
+    // Link behind the previous waiter and spin on our own node only
+    atomic_store_release_64(&((mcs_node_t*)(uintptr_t)prev)->next, (uint64_t)(uintptr_t)node);
+    while (!atomic_load_exclusive_32(&node->locked))
+    {
+      cpu_wait_event();
+      waits++;
+    }
+  }
+
+  LOCK_STATS_RECORD(lock, waits);
+}
+
+/**
+ * @brief Take a MCS queue lock if it is free
+ * 
+ * @param lock Lock
+ * @param node Queue node of the caller, kept until mcs_unlock()
+ * @return bool true if the lock was taken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool mcs_trylock(mcs_lock_t* lock, mcs_node_t* node)
+{
+  preempt_disable();
+
+  node->next = 0;
+  node->locked = 0;
+
+  if (atomic_cas_64(&lock->tail, 0, (uint64_t)(uintptr_t)node) != 0)
+  {
+    preempt_enable();
+    return false;
+  }
+
+  LOCK_STATS_RECORD(lock, 0);
+  return true;
+}
+
+/**
+ * @brief Release a MCS queue lock, handing it to the next waiter, the section ends at site
+ * 
+ * @param lock Lock
+ * @param node Node passed to mcs_lock()
+ * @param site Code releasing it
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void mcs_unlock_at(mcs_lock_t* lock, mcs_node_t* node, uintptr_t site)
+{
+  uint64_t next = atomic_load_acquire_64(&node->next);
+  if (!next)
+  {
+    // No successor yet, the lock is free if we are still the tail
+    if (atomic_cas_64(&lock->tail, (uint64_t)(uintptr_t)node, 0) == (uint64_t)(uintptr_t)node)
+    {
+      preempt_enable_at(site);
+      return;
+    }
+
+    // A waiter took the tail but has not linked itself yet
+    while (!(next = atomic_load_exclusive_64(&node->next)))
+    {
+      cpu_wait_event();
+    }
+  }
+
+  atomic_store_release_32(&((mcs_node_t*)(uintptr_t)next)->locked, 1);
+  preempt_enable_at(site);
+}
+
+/**
+ * @brief Release a MCS queue lock, handing it to the next waiter
+ * 
+ * @param lock Lock
+ * @param node Node passed to mcs_lock()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void mcs_unlock(mcs_lock_t* lock, mcs_node_t* node)
+{
+  mcs_unlock_at(lock, node, (uintptr_t)__builtin_return_address(0));
+}
+
+/**
+ * @brief Mask IRQs on the local CPU, then take a MCS queue lock
+ * 
+ * @param lock Lock
+ * @param node Queue node of the caller
+ * @return uint64_t Saved IRQ state for mcs_unlock_irqrestore()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t mcs_lock_irqsave(mcs_lock_t* lock, mcs_node_t* node)
+{
+  uint64_t flags = interrupt_local_save();
+  mcs_lock(lock, node);
+  return flags;
+}
+
+/**
+ * @brief Release a MCS queue lock, then restore the IRQ state
+ * 
+ * @param lock Lock
+ * @param node Node passed to mcs_lock_irqsave()
+ * @param flags Value returned by mcs_lock_irqsave()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void mcs_unlock_irqrestore(mcs_lock_t* lock, mcs_node_t* node, uint64_t flags)
+{
+  mcs_unlock_at(lock, node, (uintptr_t)__builtin_return_address(0));
+  interrupt_local_restore(flags);
+
+  // A switch asked for while IRQs were masked
+  cond_resched();
+}
+
+/**
+ * @brief Initialize a reader-writer spinlock
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rwlock_init(rwlock_t* lock)
+{
+  memset(lock, 0, sizeof(rwlock_t));
+}
+
+/**
+ * @brief Take a reader-writer spinlock for reading
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void read_lock(rwlock_t* lock)
+{
+  uint64_t waits = 0;
+
+  preempt_disable();
+
+  while (1)
+  {
+    uint32_t value = atomic_load_exclusive_32(&lock->value);
+    if (!(value & RWLOCK_WRITER))
+    {
+      if (atomic_cas_32(&lock->value, value, value + 1) == value)
+      {
+        break;
+      }
+
+      // Another reader came or left, retry at once
+      continue;
+    }
+
+    // The writer clears its bit on unlock, which wakes us
+    cpu_wait_event();
+    waits++;
+  }
+
+  LOCK_STATS_RECORD(lock, waits);
+}
+
+/**
+ * @brief Take a reader-writer spinlock for reading if no writer holds it
+ * 
+ * @param lock Lock
+ * @return bool true if the lock was taken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool read_trylock(rwlock_t* lock)
+{
+  preempt_disable();
+
+  uint32_t value = atomic_load_acquire_32(&lock->value);
+  while (!(value & RWLOCK_WRITER))
+  {
+    uint32_t old = atomic_cas_32(&lock->value, value, value + 1);
+    if (old == value)
+    {
+      LOCK_STATS_RECORD(lock, 0);
+      return true;
+    }
+    value = old;
+  }
+
+  preempt_enable();
+  return false;
+}
+
+/**
+ * @brief Release a reader-writer spinlock taken for reading, the section ends at site
+ * 
+ * @param lock Lock
+ * @param site Code releasing it
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void read_unlock_at(rwlock_t* lock, uintptr_t site)
+{
+  atomic_fetch_add_32(&lock->value, (uint32_t)-1);
+  preempt_enable_at(site);
+}
+
+/**
+ * @brief Release a reader-writer spinlock taken for reading
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void read_unlock(rwlock_t* lock)
+{
+  read_unlock_at(lock, (uintptr_t)__builtin_return_address(0));
+}
+
+/**
+ * @brief Take a reader-writer spinlock for writing
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void write_lock(rwlock_t* lock)
+{
+  uint64_t waits = 0;
+
+  preempt_disable();
+
+  while (atomic_cas_32(&lock->value, 0, RWLOCK_WRITER) != 0)
+  {
+    // Wait for the last reader or the writer to leave
+    while (atomic_load_exclusive_32(&lock->value) != 0)
+    {
+      cpu_wait_event();
+      waits++;
+    }
+  }
+
+  LOCK_STATS_RECORD(lock, waits);
+}
+
+/**
+ * @brief Take a reader-writer spinlock for writing if nobody holds it
+ * 
+ * @param lock Lock
+ * @return bool true if the lock was taken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool write_trylock(rwlock_t* lock)
+{
+  preempt_disable();
+
+  if (atomic_cas_32(&lock->value, 0, RWLOCK_WRITER) != 0)
+  {
+    preempt_enable();
+    return false;
+  }
+
+  LOCK_STATS_RECORD(lock, 0);
+  return true;
+}
+
+/**
+ * @brief Release a reader-writer spinlock taken for writing, the section ends at site
+ * 
+ * @param lock Lock
+ * @param site Code releasing it
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void write_unlock_at(rwlock_t* lock, uintptr_t site)
+{
+  atomic_store_release_32(&lock->value, 0);
+  preempt_enable_at(site);
+}
+
+/**
+ * @brief Release a reader-writer spinlock taken for writing
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void write_unlock(rwlock_t* lock)
+{
+  write_unlock_at(lock, (uintptr_t)__builtin_return_address(0));
+}
+
+/**
+ * @brief Mask IRQs on the local CPU, then take a reader-writer spinlock
+ * for reading
+ * 
+ * @param lock Lock
+ * @return uint64_t Saved IRQ state for read_unlock_irqrestore()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t read_lock_irqsave(rwlock_t* lock)
+{
+  uint64_t flags = interrupt_local_save();
+  read_lock(lock);
+  return flags;
+}
+
+/**
+ * @brief Release a reader-writer spinlock taken for reading, then
+ * restore the IRQ state
+ * 
+ * @param lock Lock
+ * @param flags Value returned by read_lock_irqsave()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void read_unlock_irqrestore(rwlock_t* lock, uint64_t flags)
+{
+  read_unlock_at(lock, (uintptr_t)__builtin_return_address(0));
+  interrupt_local_restore(flags);
+
+  // A switch asked for while IRQs were masked
+  cond_resched();
+}
+
+/**
+ * @brief Mask IRQs on the local CPU, then take a reader-writer spinlock
+ * for writing
+ * 
+ * @param lock Lock
+ * @return uint64_t Saved IRQ state for write_unlock_irqrestore()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t write_lock_irqsave(rwlock_t* lock)
+{
+  uint64_t flags = interrupt_local_save();
+  write_lock(lock);
+  return flags;
+}
+
+/**
+ * @brief Release a reader-writer spinlock taken for writing, then
+ * restore the IRQ state
+ * 
+ * @param lock Lock
+ * @param flags Value returned by write_lock_irqsave()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void write_unlock_irqrestore(rwlock_t* lock, uint64_t flags)
+{
+  write_unlock_at(lock, (uintptr_t)__builtin_return_address(0));
+  interrupt_local_restore(flags);
+
+  // A switch asked for while IRQs were masked
+  cond_resched();
+}
+
+/**
+ * @brief Get the statistics of a ticket spinlock
+ * 
+ * @param lock Lock
+ * @return const lock_stats_t* Statistics, NULL without LOCK_STATS=1
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const lock_stats_t* spin_lock_stats(spinlock_t* lock)
+{
+  return LOCK_STATS_GET(lock);
+}
+
+/**
+ * @brief Get the statistics of a MCS queue lock
+ * 
+ * @param lock Lock
+ * @return const lock_stats_t* Statistics, NULL without LOCK_STATS=1
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const lock_stats_t* mcs_lock_stats(mcs_lock_t* lock)
+{
+  return LOCK_STATS_GET(lock);
+}
+
+/**
+ * @brief Get the statistics of a reader-writer spinlock
+ * 
+ * @param lock Lock
+ * @return const lock_stats_t* Statistics, NULL without LOCK_STATS=1
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const lock_stats_t* rwlock_stats(rwlock_t* lock)
+{
+  return LOCK_STATS_GET(lock);
+}
+
+/**
+ * @brief Print the statistics of a lock
+ * 
+ * @param name Lock name
+ * @param stats Statistics, nothing is printed if NULL
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void lock_stats_print(const char* name, const lock_stats_t* stats)
+{
+  if (!name || !stats)
+  {
+    return;
+  }
+
+  uart_send_string("  ");
+  uart_send_string(name);
+  uart_send_string(": ");
+  uart_send_string(uint_to_str(stats->acquisitions));
+  uart_send_string(" acquisitions, ");
+  uart_send_string(uint_to_str(stats->contended));
+  uart_send_string(" contended, ");
+  uart_send_string(uint_to_str(stats->spins));
+  uart_send_string(" wake-ups\n");
+}
+
+/**
+ * @brief Benchmark body run by every CPU: update the shared counter
+ * under the lock being measured
+ * 
+ * @param arg spinlock_bench_t of the run
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void spinlock_bench_worker(void* arg)
+{
+  spinlock_bench_t* bench = (spinlock_bench_t*)arg;
+  mcs_node_t node;
+  uint64_t sum = 0;
+
+  // Start together so every CPU contends from the first iteration
+  atomic_fetch_add_32(&bench->arrived, 1);
+  while (atomic_load_acquire_32(&bench->arrived) < bench->cpus)
+  {
+    cpu_relax();
+  }
+
+  for (uint32_t i = 0; i < SPINLOCK_BENCH_ITERATIONS; i++)
+  {
+    switch (bench->kind)
+    {
+      case SPINLOCK_BENCH_PERCPU:
+        percpu_counter_inc(&spinlock_bench_percpu);
+        break;
+
+      case SPINLOCK_BENCH_ATOMIC:
+        atomic_fetch_add_64(&bench->counter, 1);
+        break;
+
+      case SPINLOCK_BENCH_TICKET:
+        spin_lock(&bench->ticket);
+        bench->counter++;
+        spin_unlock(&bench->ticket);
+        break;
+
+      case SPINLOCK_BENCH_MCS:
+        mcs_lock(&bench->mcs, &node);
+        bench->counter++;
+        mcs_unlock(&bench->mcs, &node);
+        break;
+
+      case SPINLOCK_BENCH_WRITE:
+        write_lock(&bench->rwlock);
+        bench->counter++;
+        write_unlock(&bench->rwlock);
+        break;
+
+      default:
+        read_lock(&bench->rwlock);
+        sum += bench->counter;
+        read_unlock(&bench->rwlock);
+        break;
+    }
+  }
+
+  // Readers never change the counter, a non-zero sum means a writer slipped in
+  if (sum != 0)
+  {
+    atomic_fetch_add_64(&bench->counter, 1);
+  }
+}
+
+/**
+ * @brief Time a contended counter update under every lock on 1 to all
+ * online CPUs, against a per-CPU counter and a plain atomic fetch-add
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int spinlock_benchmark()
+{
+  int res = EOK;
+  uint32_t cpus = smp_cpu_count();
+  uint64_t frequency = timer_read_frequency();
+
+  uart_send_string("\n=== Lock Benchmark ===\n");
+  uart_send_string("Atomics: ");
+  uart_send_string(ATOMIC_LSE_ENABLED ? "LSE" : "LL/SC exclusives");
+  uart_send_string(atomic_lse_supported() ? " (CPU has LSE)\n" : " (CPU without LSE)\n");
+  uart_send_string("CPUs online: ");
+  uart_send_string(uint_to_str(cpus));
+  uart_send_string(cpus > 1 ? "\n" : ", run QEMU with SMP=4 for contention\n");
+
+  for (uint32_t kind = 0; kind < SPINLOCK_BENCH_COUNT; kind++)
+  {
+    for (uint32_t n = 1; n <= cpus; n++)
+    {
+      memset((void*)&spinlock_bench, 0, sizeof(spinlock_bench));
+      spinlock_bench.kind = (spinlock_bench_kind_t)kind;
+      spinlock_bench.cpus = n;
+      percpu_counter_reset(&spinlock_bench_percpu);
+
+      uint64_t start = timer_read_counter();
+      smp_run(n, spinlock_bench_worker, &spinlock_bench);
+      uint64_t ticks = timer_read_counter() - start;
+
+      if (kind == SPINLOCK_BENCH_PERCPU)
+      {
+        spinlock_bench.counter = percpu_counter_sum(&spinlock_bench_percpu);
+      }
+
+      uint64_t operations = (uint64_t)n * SPINLOCK_BENCH_ITERATIONS;
+      uint64_t expected = kind == SPINLOCK_BENCH_READ ? 0 : operations;
+
+      uart_send_string("  ");
+      uart_send_string(spinlock_bench_names[kind]);
+      uart_send_string(" x");
+      uart_send_string(uint_to_str(n));
+      uart_send_string(": ");
+      uart_send_string(uint_to_str((ticks * 1000000000ULL) / frequency / operations));
+      uart_send_string(" ns/op");
+      if (spinlock_bench.counter != expected)
+      {
+        uart_send_string(" COUNTER MISMATCH");
+        res = -EFAULT;
+      }
+      uart_send_string("\n");
+    }
+
+    // Contention of the widest run, LOCK_STATS=1 builds only
+    switch (kind)
+    {
+      case SPINLOCK_BENCH_TICKET:
+        lock_stats_print("ticket lock", spin_lock_stats(&spinlock_bench.ticket));
+        break;
+
+      case SPINLOCK_BENCH_MCS:
+        lock_stats_print("MCS lock", mcs_lock_stats(&spinlock_bench.mcs));
+        break;
+
+      case SPINLOCK_BENCH_WRITE:
+      case SPINLOCK_BENCH_READ:
+        lock_stats_print("rwlock", rwlock_stats(&spinlock_bench.rwlock));
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  return res;
+}
+
+/**
+ * @brief Read the interrupt mask bits of the current CPU
+ * 
+ * @return uint64_t DAIF register
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t lock_test_read_daif()
+{
+  uint64_t value;
+  __asm__ volatile("mrs %0, daif" : "=r" (value));
+  return value;
+}
+
+/**
+ * @brief Lock test body run by every CPU: update the shared counter
+ * under the lock being tested
+ * 
+ * @param arg lock_test_state_t of the run
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void lock_test_worker(void* arg)
+{
+  lock_test_state_t* state = (lock_test_state_t*)arg;
+  mcs_node_t node;
+
+  atomic_fetch_add_32(&state->arrived, 1);
+  while (atomic_load_acquire_32(&state->arrived) < state->cpus)
+  {
+    cpu_relax();
+  }
+
+  for (uint32_t i = 0; i < LOCK_TEST_ITERATIONS; i++)
+  {
+    if (state->kind == 0)
+    {
+      spin_lock(&state->ticket);
+      state->counter++;
+      spin_unlock(&state->ticket);
+    }
+    else if (state->kind == 1)
+    {
+      mcs_lock(&state->mcs, &node);
+      state->counter++;
+      mcs_unlock(&state->mcs, &node);
+    }
+    else
+    {
+      write_lock(&state->rwlock);
+      state->counter++;
+      write_unlock(&state->rwlock);
+    }
+  }
+}
+
+/**
+ * @brief Test the atomics and locks: results of every atomic operation,
+ * trylock exclusion rules, IRQ mask save and restore, and lost updates
+ * of a counter shared by every online CPU
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int spinlock_test()
+{
+  uart_send_string("\n=== Testing Atomics and Locks ===\n");
+
+  // Atomics, the 64-bit add carries across the low word
+  volatile uint32_t word32 = 5;
+  volatile uint64_t word64 = 0xFFFFFFFFULL;
+  if (atomic_cas_32(&word32, 4, 9) != 5 || word32 != 5 ||
+      atomic_cas_32(&word32, 5, 9) != 5 || word32 != 9 ||
+      atomic_fetch_add_32(&word32, (uint32_t)-2) != 9 || word32 != 7 ||
+      atomic_xchg_32(&word32, 3) != 7 || atomic_load_acquire_32(&word32) != 3)
+  {
+    uart_send_string("FAIL: 32-bit atomic returned a wrong value\n");
+    return -EIO;
+  }
+
+  if (atomic_fetch_add_64(&word64, 1) != 0xFFFFFFFFULL || word64 != 0x100000000ULL ||
+      atomic_cas_64(&word64, 0, 1) != 0x100000000ULL || word64 != 0x100000000ULL ||
+      atomic_cas_64(&word64, 0x100000000ULL, 2) != 0x100000000ULL || word64 != 2 ||
+      atomic_xchg_64(&word64, 1ULL << 63) != 2 || atomic_load_acquire_64(&word64) != 1ULL << 63)
+  {
+    uart_send_string("FAIL: 64-bit atomic returned a wrong value\n");
+    return -EIO;
+  }
+
+  // Ticket spinlock
+  spinlock_t lock = SPINLOCK_INIT;
+  if (!spin_trylock(&lock) || spin_trylock(&lock) || !spin_is_locked(&lock))
+  {
+    uart_send_string("FAIL: Ticket lock taken twice\n");
+    return -EIO;
+  }
+  spin_unlock(&lock);
+  spin_lock(&lock);
+  spin_unlock(&lock);
+  if (spin_is_locked(&lock))
+  {
+    uart_send_string("FAIL: Ticket lock held after unlock\n");
+    return -EIO;
+  }
+
+  // IRQs masked while held, the previous mask restored after
+  uint64_t daif = lock_test_read_daif();
+  uint64_t flags = spin_lock_irqsave(&lock);
+  bool masked = (lock_test_read_daif() & LOCK_TEST_DAIF_I) != 0;
+  spin_unlock_irqrestore(&lock, flags);
+  if (!masked || lock_test_read_daif() != daif)
+  {
+    uart_send_string("FAIL: IRQ state not saved and restored by the lock\n");
+    return -EIO;
+  }
+
+  // MCS queue lock
+  mcs_lock_t mcs = MCS_LOCK_INIT;
+  mcs_node_t first;
+  mcs_node_t second;
+  if (!mcs_trylock(&mcs, &first) || mcs_trylock(&mcs, &second))
+  {
+    uart_send_string("FAIL: MCS lock taken twice\n");
+    return -EIO;
+  }
+  mcs_unlock(&mcs, &first);
+  flags = mcs_lock_irqsave(&mcs, &second);
+  mcs_unlock_irqrestore(&mcs, &second, flags);
+  if (mcs.tail != 0 || lock_test_read_daif() != daif)
+  {
+    uart_send_string("FAIL: MCS lock held after unlock\n");
+    return -EIO;
+  }
+
+  // Reader-writer lock, readers share and writers are alone
+  rwlock_t rwlock = RWLOCK_INIT;
+  read_lock(&rwlock);
+  if (!read_trylock(&rwlock) || write_trylock(&rwlock))
+  {
+    uart_send_string("FAIL: Readers not sharing the rwlock or a writer let in\n");
+    return -EIO;
+  }
+  read_unlock(&rwlock);
+  read_unlock(&rwlock);
+  if (!write_trylock(&rwlock) || read_trylock(&rwlock) || write_trylock(&rwlock))
+  {
+    uart_send_string("FAIL: rwlock writer not exclusive\n");
+    return -EIO;
+  }
+  write_unlock(&rwlock);
+  flags = read_lock_irqsave(&rwlock);
+  read_unlock_irqrestore(&rwlock, flags);
+  flags = write_lock_irqsave(&rwlock);
+  write_unlock_irqrestore(&rwlock, flags);
+  if (rwlock.value != 0 || lock_test_read_daif() != daif)
+  {
+    uart_send_string("FAIL: rwlock held after unlock\n");
+    return -EIO;
+  }
+
+  // Every CPU hammers one counter, a lost update means a broken lock
+  uint32_t cpus = smp_cpu_count();
+  if (cpus == 1)
+  {
+    uart_send_string("Single CPU, contention not tested (run with SMP=4)\n");
+  }
+
+  for (uint32_t kind = 0; kind < 3 && cpus > 1; kind++)
+  {
+    memset((void*)&lock_test_state, 0, sizeof(lock_test_state));
+    lock_test_state.kind = kind;
+    lock_test_state.cpus = cpus;
+    smp_run(cpus, lock_test_worker, &lock_test_state);
+
+    if (lock_test_state.counter != (uint64_t)cpus * LOCK_TEST_ITERATIONS)
+    {
+      uart_send_string("FAIL: Lost counter updates under the ");
+      uart_send_string(kind == 0 ? "ticket lock" : kind == 1 ? "MCS lock" : "rwlock");
+      uart_send_string(", ");
+      uart_send_string(uint_to_str(lock_test_state.counter));
+      uart_send_string(" of ");
+      uart_send_string(uint_to_str((uint64_t)cpus * LOCK_TEST_ITERATIONS));
+      uart_send_string("\n");
+      return -EIO;
+    }
+  }
+
+  uart_send_string("Lock tests passed\n");
+  return EOK;
+}
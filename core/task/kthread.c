@@ -0,0 +1,550 @@
+/*
+ * kthread.c - This file implements kernel threads. A thread is a task
+ * entering kthread_entry() at EL1 on its own stack, the scheduler finds
+ * threads in a small table next to the process table.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "kthread.h"
+
+#include <uart.h>
+
+#include <kernel/config.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/task/task.h>
+#include <synapse/process/process.h>
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/smp/smp.h>
+#include <synapse/sync/atomic.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/interrupts/interrupt.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// SPSR of a thread: EL1h, IRQs unmasked, SErrors and debug masked
+#define KTHREAD_SPSR 0x305
+
+// Benchmark configuration
+#define KTHREAD_BENCH_THREADS 8
+#define KTHREAD_BENCH_ROUNDS 16
+
+// Threads the scheduler may pick, NULL for a free slot
+static struct kthread* kthread_table[SYNAPSE_MAX_KTHREADS] = {0};
+// Slot after the last thread picked, for round robin
+static uint32_t kthread_next_slot = 0;
+// Protects kthread_table and kthread_next_slot, taken by the scheduler tick
+static spinlock_t kthread_table_lock = SPINLOCK_INIT;
+
+// Kernel threads of the thread test
+static struct kthread* kthread_test_threads[SYNAPSE_MAX_KTHREADS + 1];
+
+/**
+ * @brief First code run by every thread: run the function unless the
+ * thread was stopped before, then wait for the scheduler to drop it
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void kthread_entry()
+{
+  struct kthread* thread = kthread_current();
+
+  if (atomic_cas_32(&thread->run_state, KTHREAD_CREATED, KTHREAD_RUNNING) == KTHREAD_CREATED)
+  {
+    thread->result = thread->function(thread->arg);
+  }
+
+  // A finished task is never picked again, the next tick switches away
+  thread->task->state = TASK_STATE_FINISHED;
+  atomic_store_release_32(&thread->run_state, KTHREAD_EXITED);
+
+  while (1)
+  {
+    __asm__ volatile("wfi");
+  }
+}
+
+/**
+ * @brief Free what kthread_create() allocated
+ * 
+ * @param thread Thread, out of the table
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void kthread_release(struct kthread* thread)
+{
+  if (thread->task)
+  {
+    task_free(thread->task);
+  }
+
+  if (thread->stack)
+  {
+    kfree(thread->stack);
+  }
+
+  kfree(thread);
+}
+
+/**
+ * @brief Move device IRQs off the CPUs running real-time threads once
+ * one starts or goes away
+ * 
+ * @param priority Priority of the thread
+ * @param cpu CPU it is pinned to
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void kthread_rt_changed(uint8_t priority, int32_t cpu)
+{
+#ifdef SYNAPSE_IRQ_BALANCE
+  if (priority == TASK_PRIORITY_HIGH && cpu != TASK_CPU_ANY)
+  {
+    // Before interrupt_init() nothing is routed yet
+    interrupt_balance();
+  }
+#endif
+}
+
+/**
+ * @brief Create a kernel thread, ready to be scheduled
+ * 
+ * @param function Function to run
+ * @param arg Argument of the function
+ * @param priority TASK_PRIORITY_LOW threads only run when nothing else is
+ * ready, TASK_PRIORITY_NORMAL ones take turns with processes and
+ * TASK_PRIORITY_HIGH ones run first
+ * @param cpu CPU to run on, below smp_cpu_count(), TASK_CPU_ANY for any.
+ * A thread pinned to a secondary waits until that CPU schedules
+ * @return struct kthread* New thread, NULL on a bad argument, when out of
+ * memory or when SYNAPSE_MAX_KTHREADS threads exist
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+struct kthread* kthread_create(KTHREAD_FUNCTION function, void* arg, uint8_t priority, int32_t cpu)
+{
+  if (!function || (cpu != TASK_CPU_ANY && (cpu < 0 || (uint32_t)cpu >= smp_cpu_count())))
+  {
+    return NULL;
+  }
+
+  struct kthread* thread = kzalloc(sizeof(struct kthread));
+  if (!thread)
+  {
+    return NULL;
+  }
+
+  thread->function = function;
+  thread->arg = arg;
+  thread->run_state = KTHREAD_CREATED;
+
+  // Never zeroed, the thread only reads what it wrote
+  thread->stack = kmalloc(SYNAPSE_KTHREAD_STACK_SIZE);
+  thread->task = task_new(priority);
+  if (!thread->stack || !thread->task)
+  {
+    goto out_err;
+  }
+
+  struct task* task = thread->task;
+  task->kthread = thread;
+  task->cpu = cpu;
+  task->registers.sp = ((uint64_t)thread->stack + SYNAPSE_KTHREAD_STACK_SIZE) & ~15ULL;
+  task->registers.pc = (reg_t)kthread_entry;
+  task->registers.elr_el1 = (reg_t)kthread_entry;
+  task->registers.spsr_el1 = KTHREAD_SPSR;
+
+  // The scheduler picks ready threads under the lock, publish both at once
+  bool published = false;
+  uint64_t flags = spin_lock_irqsave(&kthread_table_lock);
+  for (uint32_t i = 0; i < SYNAPSE_MAX_KTHREADS; i++)
+  {
+    if (kthread_table[i] == NULL)
+    {
+      kthread_table[i] = thread;
+      task->state = TASK_STATE_READY;
+      published = true;
+      break;
+    }
+  }
+  spin_unlock_irqrestore(&kthread_table_lock, flags);
+
+  if (published)
+  {
+    kthread_rt_changed(priority, cpu);
+    return thread;
+  }
+
+out_err:
+  kthread_release(thread);
+  return NULL;
+}
+
+/**
+ * @brief Ask a thread to stop, wait for its function to return and free
+ * it. The caller must let the scheduler run, IRQs unmasked
+ * 
+ * @param thread Thread, not the calling one
+ * @return int Result of the function, -ENOTREADY if it never started,
+ * -EINVARG on a bad thread
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int kthread_stop(struct kthread* thread)
+{
+  if (!thread || thread == kthread_current())
+  {
+    return -EINVARG;
+  }
+
+  atomic_store_release_32(&thread->should_stop, 1);
+
+  // A thread not started yet never will, one started runs to its end
+  uint64_t flags = spin_lock_irqsave(&kthread_table_lock);
+  if (atomic_cas_32(&thread->run_state, KTHREAD_CREATED, KTHREAD_EXITED) == KTHREAD_CREATED)
+  {
+    thread->result = -ENOTREADY;
+    thread->task->state = TASK_STATE_FINISHED;
+  }
+  spin_unlock_irqrestore(&kthread_table_lock, flags);
+
+  task_unblock(thread->task);
+
+  // Its stack is only free once the scheduler switched away from it
+  while (atomic_load_acquire_32(&thread->run_state) != KTHREAD_EXITED ||
+         task_current() == thread->task)
+  {
+    cpu_relax();
+  }
+
+  flags = spin_lock_irqsave(&kthread_table_lock);
+  for (uint32_t i = 0; i < SYNAPSE_MAX_KTHREADS; i++)
+  {
+    if (kthread_table[i] == thread)
+    {
+      kthread_table[i] = NULL;
+      break;
+    }
+  }
+  spin_unlock_irqrestore(&kthread_table_lock, flags);
+
+  int result = thread->result;
+  uint8_t priority = thread->task->priority;
+  int32_t cpu = thread->task->cpu;
+  kthread_release(thread);
+
+  kthread_rt_changed(priority, cpu);
+
+  return result;
+}
+
+/**
+ * @brief Check if the running thread was asked to stop
+ * 
+ * @return true If kthread_stop() was called on the running thread
+ * @return false Otherwise, or outside a kernel thread
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool kthread_should_stop()
+{
+  struct kthread* thread = kthread_current();
+  return thread && atomic_load_acquire_32(&thread->should_stop);
+}
+
+/**
+ * @brief Get the running kernel thread
+ * 
+ * @return struct kthread* Thread, NULL outside a kernel thread
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+struct kthread* kthread_current()
+{
+  struct task* task = task_current();
+  return task ? task->kthread : NULL;
+}
+
+/**
+ * @brief Pick the next ready thread the calling CPU may run, round robin
+ * 
+ * @param min_priority Lowest priority picked
+ * @return struct task* Task of the thread, NULL if none is ready
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+struct task* kthread_pick_next(uint8_t min_priority)
+{
+  struct task* next = NULL;
+  uint32_t cpu = smp_processor_id();
+
+  uint64_t flags = spin_lock_irqsave(&kthread_table_lock);
+  for (uint32_t n = 0; n < SYNAPSE_MAX_KTHREADS; n++)
+  {
+    uint32_t slot = (kthread_next_slot + n) % SYNAPSE_MAX_KTHREADS;
+    struct kthread* thread = kthread_table[slot];
+    if (thread && thread->task->state == TASK_STATE_READY &&
+        thread->task->priority >= min_priority && task_runs_on(thread->task, cpu))
+    {
+      next = thread->task;
+      kthread_next_slot = (slot + 1) % SYNAPSE_MAX_KTHREADS;
+      break;
+    }
+  }
+  spin_unlock_irqrestore(&kthread_table_lock, flags);
+
+  return next;
+}
+
+/**
+ * @brief Do-nothing thread function of the benchmark
+ * 
+ * @param arg Not used
+ * @return int EOK
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int kthread_bench_function(void* arg)
+{
+  return EOK;
+}
+
+/**
+ * @brief Get the CPUs running real-time threads: high priority threads
+ * pinned to a CPU
+ * 
+ * @return uint32_t Bit i set for CPU i
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t kthread_rt_cpu_mask()
+{
+  uint32_t mask = 0;
+
+  uint64_t flags = spin_lock_irqsave(&kthread_table_lock);
+  for (uint32_t i = 0; i < SYNAPSE_MAX_KTHREADS; i++)
+  {
+    struct kthread* thread = kthread_table[i];
+    if (thread && thread->run_state != KTHREAD_EXITED &&
+        thread->task->priority == TASK_PRIORITY_HIGH && thread->task->cpu != TASK_CPU_ANY)
+    {
+      mask |= 1U << thread->task->cpu;
+    }
+  }
+  spin_unlock_irqrestore(&kthread_table_lock, flags);
+
+  return mask;
+}
+
+/**
+ * @brief Time thread creation and stopping, and compare the memory of a
+ * thread with the one of a kernel process
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int kthread_benchmark()
+{
+  struct kthread* threads[KTHREAD_BENCH_THREADS];
+  uint64_t frequency = timer_read_frequency();
+  uint64_t create_ticks = 0;
+  uint64_t stop_ticks = 0;
+
+  uart_send_string("\n=== Kernel Thread Benchmark ===\n");
+
+  // Threads never scheduled here, stopping them skips their function
+  for (uint32_t round = 0; round < KTHREAD_BENCH_ROUNDS; round++)
+  {
+    uint64_t start = timer_read_counter();
+    for (uint32_t i = 0; i < KTHREAD_BENCH_THREADS; i++)
+    {
+      threads[i] = kthread_create(kthread_bench_function, NULL, TASK_PRIORITY_LOW, TASK_CPU_ANY);
+      if (!threads[i])
+      {
+        uart_send_string("  Create failed\n");
+        for (uint32_t j = 0; j < i; j++)
+        {
+          kthread_stop(threads[j]);
+        }
+        return -ENOMEM;
+      }
+    }
+    create_ticks += timer_read_counter() - start;
+
+    start = timer_read_counter();
+    for (uint32_t i = 0; i < KTHREAD_BENCH_THREADS; i++)
+    {
+      kthread_stop(threads[i]);
+    }
+    stop_ticks += timer_read_counter() - start;
+  }
+
+  uint64_t created = KTHREAD_BENCH_THREADS * KTHREAD_BENCH_ROUNDS;
+  uart_send_string("  create: ");
+  uart_send_string(uint_to_str((create_ticks * 1000000000ULL) / frequency / created));
+  uart_send_string(" ns, stop: ");
+  uart_send_string(uint_to_str((stop_ticks * 1000000000ULL) / frequency / created));
+  uart_send_string(" ns\n  memory per thread: ");
+  uart_send_string(uint_to_str(sizeof(struct kthread) + sizeof(struct task) + SYNAPSE_KTHREAD_STACK_SIZE));
+  uart_send_string(" bytes, per kernel process: ");
+  uart_send_string(uint_to_str(sizeof(struct process) + sizeof(struct task) + SYNAPSE_PROCESS_STACK_SIZE));
+  uart_send_string(" bytes\n");
+
+  return EOK;
+}
+
+/**
+ * @brief Thread function of the kernel thread test, never run since the
+ * scheduler is not started yet
+ * 
+ * @param arg Not used
+ * @return int EOK
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int kthread_test_function(void* arg)
+{
+  return EOK;
+}
+
+/**
+ * @brief Test kernel threads: argument checks, the initial context, the
+ * picks of the scheduler with priorities and pinning, the real-time CPUs,
+ * the thread limit, and stopping threads that never started
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int kthread_test()
+{
+  uart_send_string("\n=== Testing Kernel Threads ===\n");
+
+  if (kthread_create(NULL, NULL, TASK_PRIORITY_NORMAL, TASK_CPU_ANY) != NULL ||
+      kthread_create(kthread_test_function, NULL, 7, TASK_CPU_ANY) != NULL ||
+      kthread_create(kthread_test_function, NULL, TASK_PRIORITY_NORMAL, (int32_t)smp_cpu_count()) != NULL)
+  {
+    uart_send_string("FAIL: Thread created with a bad argument\n");
+    return -EIO;
+  }
+
+  struct kthread* thread = kthread_create(kthread_test_function, NULL, TASK_PRIORITY_NORMAL, TASK_CPU_ANY);
+  if (!thread)
+  {
+    uart_send_string("FAIL: Could not create a thread\n");
+    return -EIO;
+  }
+
+  // Ready task at EL1h on the top of its own stack, no process
+  struct task* task = thread->task;
+  uint64_t stack_top = (uint64_t)thread->stack + SYNAPSE_KTHREAD_STACK_SIZE;
+  if (task->kthread != thread || task->process != NULL || task->state != TASK_STATE_READY ||
+      task->registers.sp > stack_top || task->registers.sp < stack_top - 16 ||
+      (task->registers.sp & 15) != 0 || (task->registers.spsr_el1 & 0xF) != 0x5 ||
+      task->registers.pc == 0 || task->registers.elr_el1 != task->registers.pc)
+  {
+    uart_send_string("FAIL: Initial thread context wrong\n");
+    kthread_stop(thread);
+    return -EIO;
+  }
+
+  // No thread runs during the self-tests
+  if (kthread_current() != NULL || kthread_should_stop())
+  {
+    uart_send_string("FAIL: Thread reported outside of any thread\n");
+    kthread_stop(thread);
+    return -EIO;
+  }
+
+  // A normal thread is not picked as high priority, a thread pinned to
+  // another CPU is never picked here
+  struct kthread* pinned = NULL;
+  if (smp_cpu_count() > 1)
+  {
+    int32_t other = (int32_t)((smp_processor_id() + 1) % smp_cpu_count());
+    pinned = kthread_create(kthread_test_function, NULL, TASK_PRIORITY_HIGH, other);
+  }
+  bool picks_ok = kthread_pick_next(TASK_PRIORITY_HIGH) == NULL &&
+                  kthread_pick_next(TASK_PRIORITY_LOW) == task &&
+                  kthread_pick_next(TASK_PRIORITY_NORMAL) == task;
+
+  // The pinned high priority thread makes its CPU real-time until stopped
+  uint32_t rt_mask = pinned ? 1U << pinned->task->cpu : 0;
+  if (kthread_rt_cpu_mask() != rt_mask)
+  {
+    picks_ok = false;
+  }
+  if (pinned && kthread_stop(pinned) != -ENOTREADY)
+  {
+    picks_ok = false;
+  }
+  if (kthread_rt_cpu_mask() != 0)
+  {
+    picks_ok = false;
+  }
+  if (!picks_ok)
+  {
+    uart_send_string("FAIL: Scheduler pick ignores priority or pinning\n");
+    kthread_stop(thread);
+    return -EIO;
+  }
+
+  // The table holds SYNAPSE_MAX_KTHREADS threads
+  size_t created = 0;
+  kthread_test_threads[created++] = thread;
+  while (created <= SYNAPSE_MAX_KTHREADS)
+  {
+    struct kthread* extra = kthread_create(kthread_test_function, NULL, TASK_PRIORITY_LOW, TASK_CPU_ANY);
+    if (!extra)
+    {
+      break;
+    }
+    kthread_test_threads[created++] = extra;
+  }
+
+  // Threads stopped before they start report it and leave no task behind
+  int res = EOK;
+  for (size_t i = 0; i < created; i++)
+  {
+    if (kthread_stop(kthread_test_threads[i]) != -ENOTREADY)
+    {
+      res = -EIO;
+    }
+  }
+
+  if (created != SYNAPSE_MAX_KTHREADS)
+  {
+    uart_send_string("FAIL: Thread limit not enforced\n");
+    return -EIO;
+  }
+
+  if (res != EOK || kthread_pick_next(TASK_PRIORITY_LOW) != NULL)
+  {
+    uart_send_string("FAIL: Stopped thread still scheduled\n");
+    return -EIO;
+  }
+
+  uart_send_string("Kernel thread tests passed\n");
+  return EOK;
+}
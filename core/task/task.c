@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 31 Mar 2025
- * Last Modified: 31 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "task.h"
@@ -19,38 +19,23 @@
 #include <synapse/memory/memory.h>
 #include <synapse/memory/heap/kheap.h>
 #include <synapse/interrupts/interrupt.h>
+#include <synapse/smp/smp.h>
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/rcu.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/scheduler/preempt.h>
+#include <synapse/scheduler/scheduler.h>
+#include <synapse/string/string.h>
 
 // Task list
 static struct task* task_list_head = NULL;
 struct task* current_task = NULL; // Defined as global for assembly access
 static tid_t next_task_id = 0;
+// Protects the task list and next_task_id, never held across a task switch
+static spinlock_t task_list_lock = SPINLOCK_INIT;
 
-/**
- * @brief Convert number to hex string (without stdlib)
- * 
- * @param value The value to convert
- * @param buffer Buffer to store the string
- * @param buffer_size Size of the buffer
- */
-void uint64_to_hex(uint64_t value, char* buffer, size_t buffer_size) {
-  if (buffer_size < 3) return; // Need at least "0x" and null
-  
-  buffer[0] = '0';
-  buffer[1] = 'x';
-  
-  size_t pos = 2;
-  bool significant = false;
-  
-  for (ssize_t i = 60; i >= 0 && pos < buffer_size - 1; i -= 4) {
-    int digit = (value >> i) & 0xF;
-    if (digit != 0 || significant || i == 0) {
-      buffer[pos++] = digit < 10 ? '0' + digit : 'A' + (digit - 10);
-      significant = true;
-    }
-  }
-  
-  buffer[pos] = '\0';
-}
+// Task switches of each CPU
+static DEFINE_PER_CPU_COUNTER(task_switch_count);
 
 /**
  * @brief Get current running task
@@ -88,15 +73,17 @@ struct task* task_new(uint8_t task_priority)
 
   // Initialize task
   memset(task, 0, sizeof(struct task));
-  task->id = next_task_id++;
   task->state = TASK_STATE_NEW;
   task->priority = TASK_PRIORITY_NORMAL;
+  task->cpu = TASK_CPU_ANY;
   if (task_priority)
   {
     task->priority = task_priority;
   }
 
   // Add to task list
+  uint64_t flags = spin_lock_irqsave(&task_list_lock);
+  task->id = next_task_id++;
   if (task_list_head == NULL)
   {
     // First task in list
@@ -113,6 +100,7 @@ struct task* task_new(uint8_t task_priority)
   task_list_head->prev = task;
 
 out:
+  spin_unlock_irqrestore(&task_list_lock, flags);
   return task;
 }
 
@@ -132,6 +120,8 @@ int task_free(struct task* task)
     return -EINVARG;
   }
 
+  uint64_t flags = spin_lock_irqsave(&task_list_lock);
+
   // Only task in list
   if (task->next == task && task->prev == task)
   {
@@ -160,6 +150,8 @@ int task_free(struct task* task)
     current_task = NULL;
   }
 
+  spin_unlock_irqrestore(&task_list_lock, flags);
+
   // Free task structure
   kfree(task);
   
@@ -220,6 +212,13 @@ int task_save_state(struct task* task, struct interrupt_frame* int_frame)
   task->registers.spsr_el1 = int_frame->spsr_el1;
   task->registers.elr_el1 = int_frame->elr_el1;
 
+  task->registers.fpsr = int_frame->fpsr;
+  task->registers.fpcr = int_frame->fpcr;
+  for (int i = 0; i < 64; i++)
+  {
+    task->registers.fp_regs[i] = int_frame->fp_regs[i];
+  }
+
   return EOK;
 }
 
@@ -277,13 +276,10 @@ int task_switch(struct task* task)
   }
   
   // Extra debug prints using your existing utility function
-  char buf[32];
   uart_send_string("task_switch: task SP=");
-  uint64_to_hex(task->registers.sp, buf, sizeof(buf));
-  uart_send_string(buf);
+  uart_send_string(uint_to_hex(task->registers.sp));
   uart_send_string(" PC=");
-  uint64_to_hex(task->registers.pc, buf, sizeof(buf));
-  uart_send_string(buf);
+  uart_send_string(uint_to_hex(task->registers.pc));
   uart_send_string("\n");
 
   // CRITICAL: Explicitly set the current_task global before calling assembly
@@ -291,6 +287,10 @@ int task_switch(struct task* task)
   
   // Set task state to running
   task->state = TASK_STATE_RUNNING;
+  percpu_counter_inc(&task_switch_count);
+
+  // The outgoing context is never resumed from here
+  rcu_note_context_switch();
 
   uart_send_string("task_switch: task now running...\n");
 
@@ -303,6 +303,19 @@ int task_switch(struct task* task)
   return -EFAULT;
 }
 
+/**
+ * @brief Get the number of task switches, summed over every CPU
+ * 
+ * @return uint64_t Task switches
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t task_get_switch_count()
+{
+  return percpu_counter_sum(&task_switch_count);
+}
+
 /**
  * @brief Schedule next task to run
  * 
@@ -313,14 +326,19 @@ int task_switch(struct task* task)
  */
 int task_schedule()
 {
+  int res = EOK;
+  uint64_t flags = spin_lock_irqsave(&task_list_lock);
+
   if (task_list_head == NULL)
   {
     // No taslk to schedule
-    return -ENOTASK;
+    res = -ENOTASK;
+    goto out;
   }
 
   // Simple round robin scheduling
   struct task* next = NULL;
+  uint32_t cpu = smp_processor_id();
 
   if (current_task == NULL)
   {
@@ -336,7 +354,7 @@ int task_schedule()
     struct task* start = next;
     do
     {
-      if (next->state == TASK_STATE_READY)
+      if (next->state == TASK_STATE_READY && task_runs_on(next, cpu))
       {
         // Found ready task
         break;
@@ -350,17 +368,24 @@ int task_schedule()
         if (current_task->state == TASK_STATE_RUNNING)
         {
           // Continue with current task
-          return EOK;
+          goto out;
         }
 
         // No suitable task found
-        return -ENOTASK;
+        res = -ENOTASK;
+        goto out;
       }
     } while (1);
   }
 
+  spin_unlock_irqrestore(&task_list_lock, flags);
+
   // Switch to selected task
   return task_switch(next);
+
+out:
+  spin_unlock_irqrestore(&task_list_lock, flags);
+  return res;
 }
 
 /**
@@ -373,8 +398,10 @@ int task_schedule()
  */
 int task_run_first_ever_task()
 {
+  uint64_t flags = spin_lock_irqsave(&task_list_lock);
   if (task_list_head == NULL)
   {
+    spin_unlock_irqrestore(&task_list_lock, flags);
     return -ENOTASK;
   }
   uart_send_string("task_run_first_ever_task: found task...\n");
@@ -382,12 +409,15 @@ int task_run_first_ever_task()
   // Find first ready task
   struct task* task = task_list_head;
   struct task* start = task;
+  uint32_t cpu = smp_processor_id();
 
   do
   {
-    if (task->state == TASK_STATE_READY)
+    if (task->state == TASK_STATE_READY && task_runs_on(task, cpu))
     {
       uart_send_string("task_run_first_ever_task: found ready task...\n");
+      spin_unlock_irqrestore(&task_list_lock, flags);
+
       // Switch to first ready task
       return task_switch(task);
     }
@@ -396,6 +426,7 @@ int task_run_first_ever_task()
     // If we're gone through all tasks and none are ready
     if (task == start)
     {
+      spin_unlock_irqrestore(&task_list_lock, flags);
       return -ENOTASK;
     }
   } while (1);
@@ -465,6 +496,13 @@ int task_unblock(struct task* task)
   if (task->state == TASK_STATE_BLOCKED)
   {
     task->state = TASK_STATE_READY;
+
+    // A high priority task runs at the next preemption point, not the next tick
+    if (task->priority == TASK_PRIORITY_HIGH && scheduler_is_running())
+    {
+      preempt_set_need_resched();
+      cond_resched();
+    }
   }
 
   return EOK;
@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 8 Apr 2025
- * Last Modified: 8 Apr 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #include "timer.h"
@@ -16,65 +16,21 @@
 #include <synapse/types.h>
 #include <synapse/status.h>
 
+#include <synapse/fdt/fdt.h>
 #include <synapse/task/task.h>
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/rcu.h>
 #include <synapse/interrupts/interrupt.h>
+#include <synapse/timer/counter.h>
+#include <synapse/string/string.h>
 
 // Timer state
 static bool timer_initialized = false;
 static INTERRUPT_HANDLER timer_handler = NULL;
-static uint64_t timer_ticks = 0;
 static uint32_t timer_interval_ms = 0;
 
-// Helper function to convert uint64_t to string
-static void uint64_to_str(uint64_t value, char* buffer, size_t buffer_size) {
-  if (buffer_size < 3) return; // Need at least space for "0x" and null terminator
-  
-  buffer[0] = '0';
-  buffer[1] = 'x';
-  
-  size_t pos = 2;
-  bool significant = false;
-  
-  for (ssize_t i = 60; i >= 0 && pos < buffer_size - 1; i -= 4) {
-    int digit = (value >> i) & 0xF;
-    if (digit != 0 || significant || i == 0) {
-      buffer[pos++] = digit < 10 ? '0' + digit : 'A' + (digit - 10);
-      significant = true;
-    }
-  }
-  
-  buffer[pos] = '\0';
-}
-
-/**
- * @brief Get the current counter value from the system timer
- * 
- * @return uint64_t Current counter value
- * 
- * @author Fedi Nabli
- * @date 8 Apr 2025
- */
-static inline uint64_t read_cntpct_el0()
-{
-  uint64_t result;
-  __asm__ volatile("mrs %0, cntpct_el0" : "=r" (result));
-  return result;
-}
-
-/**
- * @brief Get the timer frequency
- * 
- * @return uint64_t Timer frequency in Hz
- * 
- * @author Fedi Nabli
- * @date 8 Apr 2025
- */
-static inline uint64_t read_cntfrq_el0()
-{
-  uint64_t result;
-  __asm__ volatile("mrs %0, cntfrq_el0" : "=r" (result));
-  return result;
-}
+// Ticks of the timer of each CPU, its PPI is banked
+static DEFINE_PER_CPU_COUNTER(timer_ticks);
 
 /**
  * @brief Set the timer compare value
@@ -132,11 +88,14 @@ int timer_irq_handler(struct interrupt_frame* int_frame)
   uart_send_string("TIMER IRQ!\n");
   
   // Increment tick counter
-  timer_ticks++;
+  percpu_counter_inc(&timer_ticks);
+
+  // Reclaim what RCU writers left behind once its grace period is over
+  rcu_process_callbacks();
 
   // Set next timer compare value
-  uint64_t current = read_cntpct_el0();
-  uint64_t frequency = read_cntfrq_el0();
+  uint64_t current = timer_read_counter_relaxed();
+  uint64_t frequency = timer_read_frequency();
   uint64_t interval = (frequency * timer_interval_ms) / 1000;
   write_cntp_cval_el0(current + interval);
 
@@ -165,7 +124,7 @@ int timer_init(void)
   }
   
   // Register IRQ handler with GIC
-  int res = interrupt_register_handler(TIMER_IRQ, timer_irq_handler);
+  int res = interrupt_register_handler(timer_get_irq(), timer_irq_handler);
   if (res == EOK)
   {
     uart_send_string("timer_init: handler registered!\n");
@@ -181,7 +140,7 @@ int timer_init(void)
   write_cntp_ctl_el0(0);
   
   // Set timer frequency in CNTFRQ_EL0 if not already set
-  uint64_t freq = read_cntfrq_el0();
+  uint64_t freq = timer_read_frequency();
   if (freq == 0)
   {
     __asm__ volatile("msr cntfrq_el0, %0" :: "r" (CPU_FREQ_HZ));
@@ -257,8 +216,8 @@ int timer_set_interval(uint32_t ms)
   write_cntp_ctl_el0(0);
 
   // Calculate and set compare value
-  uint64_t current = read_cntpct_el0();
-  uint64_t frequency = read_cntfrq_el0();
+  uint64_t current = timer_read_counter_relaxed();
+  uint64_t frequency = timer_read_frequency();
   uint64_t interval = (frequency * ms) / 1000;
   write_cntp_cval_el0(current + interval);
 
@@ -294,15 +253,13 @@ int timer_enable()
   );
 
   // 4. Enable timer interrupt in the GIC
-  interrupt_enable(TIMER_IRQ);
+  interrupt_enable(timer_get_irq());
 
   // Debug output
   uint32_t val;
   __asm__ volatile("mrs %0, cntp_ctl_el0" : "=r"(val));
   uart_send_string("CNT_CTL after enable: ");
-  char buf[20];
-  uint64_to_str(val, buf, sizeof(buf));
-  uart_send_string(buf);
+  uart_send_string(uint_to_hex(val));
   uart_send_string("\n");
 
   return EOK;
@@ -328,13 +285,13 @@ int timer_disable()
   write_cntp_ctl_el0(0);
 
   // Disable timer IRQ in GOC
-  interrupt_disable(TIMER_IRQ);
+  interrupt_disable(timer_get_irq());
 
   return EOK;
 }
 
 /**
- * @brief Get the number of timer ticks
+ * @brief Get the number of timer ticks of the calling CPU
  * 
  * @return uint64_t Current tick cout
  * 
@@ -343,7 +300,7 @@ int timer_disable()
  */
 uint64_t timer_get_ticks()
 {
-  return timer_ticks;
+  return this_cpu_read(timer_ticks);
 }
 
 /**
@@ -361,5 +318,21 @@ uint64_t timer_get_ms()
     return 0;
   }
 
-  return timer_ticks * timer_interval_ms;
+  return timer_get_ticks() * timer_interval_ms;
+}
+
+/**
+ * @brief Get the interrupt of the non-secure physical timer
+ * 
+ * @return uint32_t PPI interrupt ID, from the device tree
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t timer_get_irq()
+{
+  uint32_t irq = fdt_get_platform()->timer_irqs[FDT_TIMER_PHYS];
+
+  // Only PPIs are banked per CPU
+  return irq >= 16 && irq < GIC_SPI_BASE ? irq : TIMER_IRQ;
 }
@@ -0,0 +1,576 @@
+/*
+ * virtio.c - This file implements the virtio-mmio transport and the
+ * split virtqueues shared by the virtio device drivers
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "virtio.h"
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/fdt/fdt.h>
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+
+// Devices found on the bus
+static virtio_device_t virtio_devices[VIRTIO_MMIO_SLOTS];
+static uint32_t virtio_device_count = 0;
+static bool virtio_initialized = false;
+
+/**
+ * @brief Read a 32-bit device register
+ * 
+ * @param dev Device
+ * @param offset Register offset
+ * @return uint32_t Register value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint32_t virtio_read32(virtio_device_t* dev, uint32_t offset)
+{
+  return *((volatile uint32_t*)(dev->base + offset));
+}
+
+/**
+ * @brief Write a 32-bit device register
+ * 
+ * @param dev Device
+ * @param offset Register offset
+ * @param value Value to write
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void virtio_write32(virtio_device_t* dev, uint32_t offset, uint32_t value)
+{
+  *((volatile uint32_t*)(dev->base + offset)) = value;
+}
+
+/**
+ * @brief Order ring updates against the device (and the notify register)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void virtio_barrier()
+{
+  __asm__ volatile("dsb sy" ::: "memory");
+}
+
+/**
+ * @brief Probe the virtio-mmio transports listed by the device tree
+ * 
+ * @return int Number of devices found, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_mmio_init()
+{
+  if (virtio_initialized)
+  {
+    return virtio_device_count;
+  }
+
+  memset(virtio_devices, 0, sizeof(virtio_devices));
+  virtio_device_count = 0;
+
+  // Without a device tree these are the 32 slots of the virt board
+  const fdt_platform_t* platform = fdt_get_platform();
+  for (uint32_t slot = 0; slot < platform->virtio_count && slot < VIRTIO_MMIO_SLOTS; slot++)
+  {
+    virtio_device_t probe = { .base = (uintptr_t)platform->virtio[slot].base };
+
+    // Empty slots report device ID 0
+    if (virtio_read32(&probe, VIRTIO_MMIO_MAGIC_VALUE) != VIRTIO_MMIO_MAGIC ||
+        virtio_read32(&probe, VIRTIO_MMIO_DEVICE_ID) == 0)
+    {
+      continue;
+    }
+
+    virtio_device_t* dev = &virtio_devices[virtio_device_count++];
+    dev->base = probe.base;
+    dev->version = virtio_read32(&probe, VIRTIO_MMIO_VERSION);
+    dev->device_id = virtio_read32(&probe, VIRTIO_MMIO_DEVICE_ID);
+    dev->irq = platform->virtio[slot].irq;
+  }
+
+  virtio_initialized = true;
+  return virtio_device_count;
+}
+
+/**
+ * @brief Bind the first unclaimed device of a type to a driver
+ * 
+ * @param device_id VIRTIO_ID_* value
+ * @return virtio_device_t* Device, or NULL if none is left
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+virtio_device_t* virtio_mmio_claim(uint32_t device_id)
+{
+  if (virtio_mmio_init() < 0)
+  {
+    return NULL;
+  }
+
+  for (uint32_t i = 0; i < virtio_device_count; i++)
+  {
+    if (virtio_devices[i].device_id == device_id && !virtio_devices[i].claimed)
+    {
+      virtio_devices[i].claimed = true;
+      return &virtio_devices[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Reset a device, acknowledge it and negotiate features
+ * 
+ * @param dev Device
+ * @param driver_features Features understood by the driver
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_device_setup(virtio_device_t* dev, uint64_t driver_features)
+{
+  if (!dev || (dev->version != 1 && dev->version != 2))
+  {
+    return -EINVARG;
+  }
+
+  virtio_device_reset(dev);
+  virtio_write32(dev, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE);
+  virtio_write32(dev, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER);
+
+  virtio_write32(dev, VIRTIO_MMIO_DEVICE_FEATURES_SEL, 0);
+  uint64_t device_features = virtio_read32(dev, VIRTIO_MMIO_DEVICE_FEATURES);
+  virtio_write32(dev, VIRTIO_MMIO_DEVICE_FEATURES_SEL, 1);
+  device_features |= (uint64_t)virtio_read32(dev, VIRTIO_MMIO_DEVICE_FEATURES) << 32;
+
+  // Modern devices must be driven with the virtio 1.0 layout
+  if (dev->version == 2)
+  {
+    driver_features |= 1ULL << VIRTIO_F_VERSION_1;
+  }
+
+  dev->features = device_features & driver_features;
+
+  virtio_write32(dev, VIRTIO_MMIO_DRIVER_FEATURES_SEL, 0);
+  virtio_write32(dev, VIRTIO_MMIO_DRIVER_FEATURES, (uint32_t)dev->features);
+  virtio_write32(dev, VIRTIO_MMIO_DRIVER_FEATURES_SEL, 1);
+  virtio_write32(dev, VIRTIO_MMIO_DRIVER_FEATURES, (uint32_t)(dev->features >> 32));
+
+  // Legacy devices have no FEATURES_OK handshake
+  if (dev->version == 1)
+  {
+    virtio_write32(dev, VIRTIO_MMIO_GUEST_PAGE_SIZE, VIRTQ_ALIGN);
+    return EOK;
+  }
+
+  uint32_t status = VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER | VIRTIO_STATUS_FEATURES_OK;
+  virtio_write32(dev, VIRTIO_MMIO_STATUS, status);
+  if (!(virtio_read32(dev, VIRTIO_MMIO_STATUS) & VIRTIO_STATUS_FEATURES_OK))
+  {
+    virtio_write32(dev, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_FAILED);
+    return -EIO;
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Tell the device the driver is ready, after the queues are set up
+ * 
+ * @param dev Device
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtio_device_ready(virtio_device_t* dev)
+{
+  virtio_barrier();
+  virtio_write32(dev, VIRTIO_MMIO_STATUS, virtio_read32(dev, VIRTIO_MMIO_STATUS) | VIRTIO_STATUS_DRIVER_OK);
+}
+
+/**
+ * @brief Reset a device, stopping all queues
+ * 
+ * @param dev Device
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtio_device_reset(virtio_device_t* dev)
+{
+  virtio_write32(dev, VIRTIO_MMIO_STATUS, 0);
+  while (virtio_read32(dev, VIRTIO_MMIO_STATUS) != 0) {}
+}
+
+/**
+ * @brief Acknowledge the pending interrupts of a device
+ * 
+ * @param dev Device
+ * @return uint32_t VIRTIO_INTERRUPT_* bits that were pending
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t virtio_device_ack_interrupt(virtio_device_t* dev)
+{
+  uint32_t status = virtio_read32(dev, VIRTIO_MMIO_INTERRUPT_STATUS);
+  if (status)
+  {
+    virtio_write32(dev, VIRTIO_MMIO_INTERRUPT_ACK, status);
+  }
+
+  return status;
+}
+
+/**
+ * @brief Check if a feature was negotiated
+ * 
+ * @param dev Device
+ * @param bit Feature bit
+ * @return bool true if the feature is in use
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool virtio_device_has_feature(virtio_device_t* dev, uint32_t bit)
+{
+  return (dev->features >> bit) & 1;
+}
+
+/**
+ * @brief Read a byte of the device configuration space
+ * 
+ * @param dev Device
+ * @param offset Offset in the configuration space
+ * @return uint8_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint8_t virtio_config_read8(virtio_device_t* dev, uint32_t offset)
+{
+  return *((volatile uint8_t*)(dev->base + VIRTIO_MMIO_CONFIG + offset));
+}
+
+/**
+ * @brief Read a 16-bit value of the device configuration space
+ * 
+ * @param dev Device
+ * @param offset Offset in the configuration space
+ * @return uint16_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint16_t virtio_config_read16(virtio_device_t* dev, uint32_t offset)
+{
+  return *((volatile uint16_t*)(dev->base + VIRTIO_MMIO_CONFIG + offset));
+}
+
+/**
+ * @brief Read a 32-bit value of the device configuration space
+ * 
+ * @param dev Device
+ * @param offset Offset in the configuration space
+ * @return uint32_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t virtio_config_read32(virtio_device_t* dev, uint32_t offset)
+{
+  return virtio_read32(dev, VIRTIO_MMIO_CONFIG + offset);
+}
+
+/**
+ * @brief Read a 64-bit value of the device configuration space, retried
+ * until both halves come from the same configuration generation
+ * 
+ * @param dev Device
+ * @param offset Offset in the configuration space
+ * @return uint64_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t virtio_config_read64(virtio_device_t* dev, uint32_t offset)
+{
+  uint32_t generation;
+  uint64_t value;
+
+  do
+  {
+    generation = dev->version == 2 ? virtio_read32(dev, VIRTIO_MMIO_CONFIG_GENERATION) : 0;
+    value = virtio_config_read32(dev, offset);
+    value |= (uint64_t)virtio_config_read32(dev, offset + 4) << 32;
+  } while (dev->version == 2 && generation != virtio_read32(dev, VIRTIO_MMIO_CONFIG_GENERATION));
+
+  return value;
+}
+
+/**
+ * @brief Create a split virtqueue and hand it to the device
+ * 
+ * The descriptor table, driver ring and device ring share one page
+ * aligned allocation laid out as legacy devices expect, modern devices
+ * are given the address of each part.
+ * 
+ * @param dev Device
+ * @param index Queue index
+ * @param max_size Upper bound on the queue size (VIRTQ_MAX_SIZE at most)
+ * @param out_vq Output for the queue
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtqueue_create(virtio_device_t* dev, uint32_t index, uint16_t max_size, virtqueue_t** out_vq)
+{
+  if (!dev || !out_vq || max_size == 0 || max_size > VIRTQ_MAX_SIZE)
+  {
+    return -EINVARG;
+  }
+
+  virtio_write32(dev, VIRTIO_MMIO_QUEUE_SEL, index);
+
+  uint32_t num_max = virtio_read32(dev, VIRTIO_MMIO_QUEUE_NUM_MAX);
+  if (num_max == 0)
+  {
+    return -ENOENT;
+  }
+
+  // Queue sizes are powers of two
+  uint16_t size = 1;
+  while ((uint32_t)(size * 2) <= num_max && size * 2 <= max_size)
+  {
+    size *= 2;
+  }
+
+  size_t avail_offset = size * sizeof(struct virtq_desc);
+  size_t used_offset = avail_offset + sizeof(struct virtq_avail) + ((size + 1) * sizeof(uint16_t));
+  used_offset = (used_offset + VIRTQ_ALIGN - 1) & ~((size_t)VIRTQ_ALIGN - 1);
+  size_t total = used_offset + sizeof(struct virtq_used) + (size * sizeof(struct virtq_used_elem)) + sizeof(uint16_t);
+
+  virtqueue_t* vq = (virtqueue_t*)kzalloc(sizeof(virtqueue_t));
+  if (!vq)
+  {
+    return -ENOMEM;
+  }
+
+  // Kernel heap blocks are page aligned
+  uint8_t* ring = (uint8_t*)kzalloc(total);
+  if (!ring)
+  {
+    kfree(vq);
+    return -ENOMEM;
+  }
+
+  vq->dev = dev;
+  vq->index = index;
+  vq->size = size;
+  vq->ring_memory = ring;
+  vq->desc = (struct virtq_desc*)ring;
+  vq->avail = (struct virtq_avail*)(ring + avail_offset);
+  vq->used = (struct virtq_used*)(ring + used_offset);
+  vq->free_head = 0;
+  vq->num_free = size;
+  vq->last_used = 0;
+
+  for (uint16_t i = 0; i < size; i++)
+  {
+    vq->desc[i].next = i + 1;
+  }
+
+  virtio_write32(dev, VIRTIO_MMIO_QUEUE_NUM, size);
+
+  if (dev->version == 1)
+  {
+    virtio_write32(dev, VIRTIO_MMIO_QUEUE_ALIGN, VIRTQ_ALIGN);
+    virtio_write32(dev, VIRTIO_MMIO_QUEUE_PFN, (uint32_t)((uintptr_t)ring / VIRTQ_ALIGN));
+  }
+  else
+  {
+    uint64_t desc = (uintptr_t)vq->desc;
+    uint64_t avail = (uintptr_t)vq->avail;
+    uint64_t used = (uintptr_t)vq->used;
+
+    virtio_write32(dev, VIRTIO_MMIO_QUEUE_DESC_LOW, (uint32_t)desc);
+    virtio_write32(dev, VIRTIO_MMIO_QUEUE_DESC_HIGH, (uint32_t)(desc >> 32));
+    virtio_write32(dev, VIRTIO_MMIO_QUEUE_DRIVER_LOW, (uint32_t)avail);
+    virtio_write32(dev, VIRTIO_MMIO_QUEUE_DRIVER_HIGH, (uint32_t)(avail >> 32));
+    virtio_write32(dev, VIRTIO_MMIO_QUEUE_DEVICE_LOW, (uint32_t)used);
+    virtio_write32(dev, VIRTIO_MMIO_QUEUE_DEVICE_HIGH, (uint32_t)(used >> 32));
+    virtio_write32(dev, VIRTIO_MMIO_QUEUE_READY, 1);
+  }
+
+  *out_vq = vq;
+  return EOK;
+}
+
+/**
+ * @brief Free a virtqueue, the device must be reset first
+ * 
+ * @param vq Queue
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtqueue_destroy(virtqueue_t* vq)
+{
+  if (!vq)
+  {
+    return;
+  }
+
+  kfree(vq->ring_memory);
+  kfree(vq);
+}
+
+/**
+ * @brief Offer a descriptor chain to the device, without notifying it
+ * 
+ * @param vq Queue
+ * @param bufs Buffers of the chain
+ * @param count Number of buffers
+ * @param cookie Caller data returned by virtqueue_get_used(), not NULL
+ * @return int EOK on success, -ENOMEM if the queue is full
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtqueue_add(virtqueue_t* vq, virtio_buf_t* bufs, uint16_t count, void* cookie)
+{
+  if (!vq || !bufs || count == 0 || !cookie)
+  {
+    return -EINVARG;
+  }
+
+  if (count > vq->num_free)
+  {
+    return -ENOMEM;
+  }
+
+  uint16_t head = vq->free_head;
+  uint16_t idx = head;
+  uint16_t last = head;
+
+  for (uint16_t i = 0; i < count; i++)
+  {
+    struct virtq_desc* desc = &vq->desc[idx];
+    desc->addr = (uintptr_t)bufs[i].addr;
+    desc->len = bufs[i].len;
+    desc->flags = bufs[i].device_writes ? VIRTQ_DESC_F_WRITE : 0;
+    if (i + 1 < count)
+    {
+      desc->flags |= VIRTQ_DESC_F_NEXT;
+    }
+
+    last = idx;
+    idx = desc->next;
+  }
+
+  vq->free_head = vq->desc[last].next;
+  vq->num_free -= count;
+  vq->cookies[head] = cookie;
+  vq->chain_len[head] = count;
+
+  // Descriptors must be visible before the ring entry, the entry before the index
+  vq->avail->ring[vq->avail->idx % vq->size] = head;
+  virtio_barrier();
+  vq->avail->idx++;
+
+  return EOK;
+}
+
+/**
+ * @brief Get the number of free descriptors
+ * 
+ * @param vq Queue
+ * @return uint16_t Free descriptors
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint16_t virtqueue_free_count(virtqueue_t* vq)
+{
+  return vq ? vq->num_free : 0;
+}
+
+/**
+ * @brief Notify the device of all chains added since the last kick
+ * 
+ * @param vq Queue
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtqueue_kick(virtqueue_t* vq)
+{
+  virtio_barrier();
+
+  if (!(vq->used->flags & VIRTQ_USED_F_NO_NOTIFY))
+  {
+    virtio_write32(vq->dev, VIRTIO_MMIO_QUEUE_NOTIFY, vq->index);
+  }
+}
+
+/**
+ * @brief Take the next chain completed by the device
+ * 
+ * @param vq Queue
+ * @param len Output for the bytes written by the device, may be NULL
+ * @return void* Cookie of the chain, NULL if nothing completed
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* virtqueue_get_used(virtqueue_t* vq, uint32_t* len)
+{
+  if (vq->last_used == *((volatile uint16_t*)&vq->used->idx))
+  {
+    return NULL;
+  }
+
+  // Read the element only after seeing the index move
+  virtio_barrier();
+
+  struct virtq_used_elem* elem = &vq->used->ring[vq->last_used % vq->size];
+  uint16_t head = (uint16_t)elem->id;
+  if (len)
+  {
+    *len = elem->len;
+  }
+  vq->last_used++;
+
+  // Return the chain to the free list
+  uint16_t tail = head;
+  for (uint16_t i = 1; i < vq->chain_len[head]; i++)
+  {
+    tail = vq->desc[tail].next;
+  }
+
+  vq->desc[tail].next = vq->free_head;
+  vq->free_head = head;
+  vq->num_free += vq->chain_len[head];
+
+  void* cookie = vq->cookies[head];
+  vq->cookies[head] = NULL;
+
+  return cookie;
+}
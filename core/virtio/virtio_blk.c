@@ -0,0 +1,969 @@
+/*
+ * virtio_blk.c - This file implements the virtio block device driver.
+ * Requests are queued, merged with their neighbours when their sectors
+ * are adjacent and completed asynchronously from the device interrupt.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "virtio_blk.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/virtio/virtio.h>
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/smp/smp.h>
+#include <synapse/interrupts/interrupt.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+#include <synapse/string/string.h>
+#include <synapse/timer/counter.h>
+
+// Benchmark configuration
+#define VIRTIO_BLK_BENCH_IO_SIZE 4096             // Bytes per request
+#define VIRTIO_BLK_BENCH_BATCH 32                 // Requests in flight
+#define VIRTIO_BLK_BENCH_SEQ_BYTES (16 * 1024 * 1024)
+#define VIRTIO_BLK_BENCH_RANDOM_IOS 1024
+
+// Request header read by the device
+struct virtio_blk_outhdr
+{
+  uint32_t type;
+  uint32_t reserved;
+  uint64_t sector;
+};
+
+// One request in flight on the device, a chain of merged caller requests
+typedef struct virtio_blk_slot
+{
+  struct virtio_blk_outhdr header; // Read by the device
+  uint8_t status;                  // Written by the device
+  bool in_use;
+  virtio_blk_request_t* first;     // Merged requests, linked through next
+} virtio_blk_slot_t;
+
+// Block device state
+typedef struct virtio_blk_device
+{
+  virtio_device_t* dev;
+  virtqueue_t* vq;
+  uint64_t capacity;  // Sectors
+  uint32_t seg_max;   // Data descriptors per device request
+  uint32_t size_max;  // Bytes per data descriptor, 0 if unlimited
+  bool read_only;
+  bool use_irq;       // Completion interrupt registered
+  bool ready;
+
+  virtio_blk_slot_t* slots; // Requests in flight, each takes at least 3 descriptors
+  uint32_t slot_count;
+
+  virtio_blk_request_t* pending; // Submitted, not yet on the device
+  virtio_blk_request_t* pending_tail;
+
+  virtio_blk_stats_t stats;
+} virtio_blk_device_t;
+
+static virtio_blk_device_t blk_dev;
+
+// Guards the ring, the slots, the pending list and the statistics. Taken
+// with IRQs masked, the completion handler may run on any CPU
+static spinlock_t blk_lock = SPINLOCK_INIT;
+
+// Descriptor chain being built, only used with blk_lock held
+static virtio_buf_t blk_bufs[VIRTQ_MAX_SIZE];
+
+/**
+ * @brief Get the number of bytes of a request
+ * 
+ * @param req Request
+ * @return uint64_t Bytes
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint64_t virtio_blk_request_bytes(virtio_blk_request_t* req)
+{
+  uint64_t bytes = 0;
+  for (uint32_t i = 0; i < req->segment_count; i++)
+  {
+    bytes += req->segments[i].len;
+  }
+
+  return bytes;
+}
+
+/**
+ * @brief Get the number of data descriptors of a request, segments
+ * larger than the device limit take several
+ * 
+ * @param req Request
+ * @return uint32_t Descriptors
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t virtio_blk_request_descs(virtio_blk_request_t* req)
+{
+  uint32_t descs = 0;
+  for (uint32_t i = 0; i < req->segment_count; i++)
+  {
+    if (blk_dev.size_max == 0)
+    {
+      descs++;
+      continue;
+    }
+
+    descs += (req->segments[i].len + blk_dev.size_max - 1) / blk_dev.size_max;
+  }
+
+  return descs;
+}
+
+/**
+ * @brief Sort the pending requests by sector so neighbours can merge,
+ * only done when every pending request is a read (reads commute)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void virtio_blk_sort_pending()
+{
+  for (virtio_blk_request_t* req = blk_dev.pending; req; req = req->next)
+  {
+    if (req->op != VIRTIO_BLK_OP_READ)
+    {
+      return;
+    }
+  }
+
+  // Insertion sort, the list is at most a few queue sizes long
+  virtio_blk_request_t* sorted = NULL;
+  virtio_blk_request_t* req = blk_dev.pending;
+  while (req)
+  {
+    virtio_blk_request_t* next = req->next;
+    virtio_blk_request_t** pos = &sorted;
+    while (*pos && (*pos)->sector <= req->sector)
+    {
+      pos = &(*pos)->next;
+    }
+
+    req->next = *pos;
+    *pos = req;
+    req = next;
+  }
+
+  blk_dev.pending = sorted;
+  blk_dev.pending_tail = sorted;
+  while (blk_dev.pending_tail && blk_dev.pending_tail->next)
+  {
+    blk_dev.pending_tail = blk_dev.pending_tail->next;
+  }
+}
+
+/**
+ * @brief Find a free in-flight slot
+ * 
+ * @return virtio_blk_slot_t* Slot, or NULL if all are in use
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static virtio_blk_slot_t* virtio_blk_get_slot()
+{
+  for (uint32_t i = 0; i < blk_dev.slot_count; i++)
+  {
+    if (!blk_dev.slots[i].in_use)
+    {
+      return &blk_dev.slots[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Send pending requests to the device, merging runs of requests
+ * of the same type on adjacent sectors into one descriptor chain.
+ * Called with blk_lock held.
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void virtio_blk_dispatch()
+{
+  bool added = false;
+
+  virtio_blk_sort_pending();
+
+  while (blk_dev.pending)
+  {
+    virtio_blk_slot_t* slot = virtio_blk_get_slot();
+    if (!slot)
+    {
+      break;
+    }
+
+    virtio_blk_request_t* first = blk_dev.pending;
+    virtio_blk_request_t* last = first;
+    uint32_t descs = virtio_blk_request_descs(first);
+    uint32_t count = 1;
+
+    if (first->op != VIRTIO_BLK_OP_FLUSH)
+    {
+      uint64_t end = first->sector + (virtio_blk_request_bytes(first) / VIRTIO_BLK_SECTOR_SIZE);
+      while (last->next && last->next->op == first->op && last->next->sector == end)
+      {
+        uint32_t next_descs = virtio_blk_request_descs(last->next);
+        if (descs + next_descs > blk_dev.seg_max || descs + next_descs + 2 > virtqueue_free_count(blk_dev.vq))
+        {
+          break;
+        }
+
+        last = last->next;
+        descs += next_descs;
+        end += virtio_blk_request_bytes(last) / VIRTIO_BLK_SECTOR_SIZE;
+        count++;
+      }
+    }
+
+    // Wait for completions to free descriptors
+    if (descs + 2 > virtqueue_free_count(blk_dev.vq))
+    {
+      break;
+    }
+
+    slot->header.type = first->op;
+    slot->header.reserved = 0;
+    slot->header.sector = first->sector;
+    slot->status = 0xFF;
+
+    uint16_t n = 0;
+    blk_bufs[n++] = (virtio_buf_t){ &slot->header, sizeof(slot->header), false };
+
+    // Data goes straight to the caller buffers, no bounce copy
+    for (virtio_blk_request_t* req = first; ; req = req->next)
+    {
+      for (uint32_t i = 0; i < req->segment_count; i++)
+      {
+        uint8_t* addr = (uint8_t*)req->segments[i].addr;
+        uint32_t left = req->segments[i].len;
+        while (left > 0)
+        {
+          uint32_t len = blk_dev.size_max && left > blk_dev.size_max ? blk_dev.size_max : left;
+          blk_bufs[n++] = (virtio_buf_t){ addr, len, req->op == VIRTIO_BLK_OP_READ };
+          addr += len;
+          left -= len;
+        }
+      }
+
+      if (req == last)
+      {
+        break;
+      }
+    }
+
+    blk_bufs[n++] = (virtio_buf_t){ &slot->status, 1, true };
+
+    if (virtqueue_add(blk_dev.vq, blk_bufs, n, slot) != EOK)
+    {
+      break;
+    }
+
+    // Detach the merged run from the pending list
+    blk_dev.pending = last->next;
+    if (!blk_dev.pending)
+    {
+      blk_dev.pending_tail = NULL;
+    }
+    last->next = NULL;
+
+    slot->first = first;
+    slot->in_use = true;
+    blk_dev.stats.issued++;
+    blk_dev.stats.merged += count - 1;
+    added = true;
+  }
+
+  // One notification for the whole batch
+  if (added)
+  {
+    virtqueue_kick(blk_dev.vq);
+  }
+}
+
+/**
+ * @brief Complete the requests the device has finished and send more.
+ * Called with blk_lock held.
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void virtio_blk_complete()
+{
+  virtio_blk_slot_t* slot;
+  while ((slot = (virtio_blk_slot_t*)virtqueue_get_used(blk_dev.vq, NULL)) != NULL)
+  {
+    int result = slot->status == 0 ? EOK : -EIO;
+    virtio_blk_request_t* req = slot->first;
+
+    slot->first = NULL;
+    slot->in_use = false;
+
+    while (req)
+    {
+      virtio_blk_request_t* next = req->next;
+      req->next = NULL;
+      req->result = result;
+
+      blk_dev.stats.completed++;
+      if (result == EOK)
+      {
+        blk_dev.stats.bytes += virtio_blk_request_bytes(req);
+      }
+
+      if (req->callback)
+      {
+        req->callback(req);
+      }
+
+      // The owner may reuse the request as soon as it is done
+      req->done = true;
+      req = next;
+    }
+  }
+
+  virtio_blk_dispatch();
+}
+
+/**
+ * @brief Find the first virtio block device and set it up
+ * 
+ * @return int EOK on success, -ENOENT if there is no device,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_init()
+{
+  int res = EOK;
+
+  if (blk_dev.ready)
+  {
+    return EOK;
+  }
+
+  memset(&blk_dev, 0, sizeof(blk_dev));
+
+  blk_dev.dev = virtio_mmio_claim(VIRTIO_ID_BLOCK);
+  if (!blk_dev.dev)
+  {
+    return -ENOENT;
+  }
+
+  uint64_t features = (1ULL << VIRTIO_BLK_F_SIZE_MAX) | (1ULL << VIRTIO_BLK_F_SEG_MAX) |
+                      (1ULL << VIRTIO_BLK_F_RO) | (1ULL << VIRTIO_BLK_F_FLUSH);
+  res = virtio_device_setup(blk_dev.dev, features);
+  if (res < 0)
+  {
+    goto fail;
+  }
+
+  // Configuration: capacity (u64), size_max (u32), seg_max (u32)
+  blk_dev.capacity = virtio_config_read64(blk_dev.dev, 0);
+  blk_dev.read_only = virtio_device_has_feature(blk_dev.dev, VIRTIO_BLK_F_RO);
+  if (virtio_device_has_feature(blk_dev.dev, VIRTIO_BLK_F_SIZE_MAX))
+  {
+    blk_dev.size_max = virtio_config_read32(blk_dev.dev, 8);
+  }
+
+  res = virtqueue_create(blk_dev.dev, 0, VIRTQ_MAX_SIZE, &blk_dev.vq);
+  if (res < 0)
+  {
+    goto fail;
+  }
+
+  // Header and status take two descriptors
+  blk_dev.seg_max = blk_dev.vq->size - 2;
+  if (virtio_device_has_feature(blk_dev.dev, VIRTIO_BLK_F_SEG_MAX))
+  {
+    uint32_t seg_max = virtio_config_read32(blk_dev.dev, 12);
+    if (seg_max > 0 && seg_max < blk_dev.seg_max)
+    {
+      blk_dev.seg_max = seg_max;
+    }
+  }
+
+  blk_dev.slot_count = blk_dev.vq->size / 3;
+  blk_dev.slots = (virtio_blk_slot_t*)kzalloc(blk_dev.slot_count * sizeof(virtio_blk_slot_t));
+  if (!blk_dev.slots)
+  {
+    res = -ENOMEM;
+    goto fail;
+  }
+
+  // Without the interrupt controller the waiters poll the used ring. The
+  // interrupt is pinned to this CPU, waiters sleep in wfi for it
+  blk_dev.use_irq = interrupt_register_handler(blk_dev.dev->irq, virtio_blk_irq_handler) == EOK &&
+                    interrupt_pin_affinity(blk_dev.dev->irq, smp_processor_id()) == EOK &&
+                    interrupt_enable(blk_dev.dev->irq) == EOK;
+
+  virtio_device_ready(blk_dev.dev);
+  blk_dev.ready = true;
+
+  uart_send_string("virtio-blk: ");
+  uart_send_string(uint_to_str(blk_dev.capacity / 2048));
+  uart_send_string(" MB, queue ");
+  uart_send_string(uint_to_str(blk_dev.vq->size));
+  uart_send_string(", seg_max ");
+  uart_send_string(uint_to_str(blk_dev.seg_max));
+  uart_send_string(blk_dev.read_only ? ", read-only" : "");
+  uart_send_string(blk_dev.use_irq ? ", interrupt driven\n" : ", polled\n");
+
+  return EOK;
+
+fail:
+  virtio_device_reset(blk_dev.dev);
+  if (blk_dev.vq)
+    virtqueue_destroy(blk_dev.vq);
+  blk_dev.vq = NULL;
+  blk_dev.dev->claimed = false;
+  uart_send_string("virtio-blk: device setup failed\n");
+  return res;
+}
+
+/**
+ * @brief Check if a block device is ready
+ * 
+ * @return bool true if virtio_blk_init() succeeded
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool virtio_blk_present()
+{
+  return blk_dev.ready;
+}
+
+/**
+ * @brief Get the capacity of the device
+ * 
+ * @return uint64_t Number of sectors
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t virtio_blk_get_capacity()
+{
+  return blk_dev.ready ? blk_dev.capacity : 0;
+}
+
+/**
+ * @brief Prepare a request with a single buffer
+ * 
+ * @param req Request
+ * @param op Request type
+ * @param sector First sector
+ * @param buffer Buffer, used in place
+ * @param size Size in bytes (multiple of the sector size)
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_request_init(virtio_blk_request_t* req, virtio_blk_op_t op, uint64_t sector, void* buffer, size_t size)
+{
+  if (!req)
+  {
+    return -EINVARG;
+  }
+
+  memset(req, 0, sizeof(virtio_blk_request_t));
+  req->op = op;
+  req->sector = sector;
+
+  if (op == VIRTIO_BLK_OP_FLUSH)
+  {
+    return EOK;
+  }
+
+  return virtio_blk_request_add_segment(req, buffer, size);
+}
+
+/**
+ * @brief Add a buffer to a request
+ * 
+ * @param req Request
+ * @param buffer Buffer, used in place
+ * @param size Size in bytes
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_request_add_segment(virtio_blk_request_t* req, void* buffer, size_t size)
+{
+  if (!req || !buffer || size == 0 || size > 0xFFFFFFFF || req->op == VIRTIO_BLK_OP_FLUSH ||
+      req->segment_count >= VIRTIO_BLK_MAX_SEGMENTS)
+  {
+    return -EINVARG;
+  }
+
+  req->segments[req->segment_count].addr = buffer;
+  req->segments[req->segment_count].len = (uint32_t)size;
+  req->segment_count++;
+
+  return EOK;
+}
+
+/**
+ * @brief Prepare a request transferring straight into or out of a tensor
+ * 
+ * @param req Request
+ * @param op VIRTIO_BLK_OP_READ or VIRTIO_BLK_OP_WRITE
+ * @param sector First sector
+ * @param tensor Dense tensor whose size is a multiple of the sector size
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_request_tensor(virtio_blk_request_t* req, virtio_blk_op_t op, uint64_t sector, tensor_t* tensor)
+{
+  if (!tensor || !tensor->data || tensor->sparse || op == VIRTIO_BLK_OP_FLUSH)
+  {
+    return -EINVARG;
+  }
+
+  size_t size = ai_tensor_get_size(tensor);
+  if (size == 0 || size % VIRTIO_BLK_SECTOR_SIZE != 0)
+  {
+    return -EINVARG;
+  }
+
+  return virtio_blk_request_init(req, op, sector, tensor->data, size);
+}
+
+/**
+ * @brief Queue a request, it is sent to the device by virtio_blk_kick()
+ * 
+ * @param req Prepared request
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_submit(virtio_blk_request_t* req)
+{
+  if (!blk_dev.ready)
+  {
+    return -ENOTREADY;
+  }
+
+  if (!req || (req->op != VIRTIO_BLK_OP_READ && req->op != VIRTIO_BLK_OP_WRITE && req->op != VIRTIO_BLK_OP_FLUSH))
+  {
+    return -EINVARG;
+  }
+
+  if (req->op == VIRTIO_BLK_OP_FLUSH)
+  {
+    if (!virtio_device_has_feature(blk_dev.dev, VIRTIO_BLK_F_FLUSH) || req->segment_count != 0)
+    {
+      return -EINVARG;
+    }
+  }
+  else
+  {
+    uint64_t bytes = virtio_blk_request_bytes(req);
+    if (req->segment_count == 0 || bytes % VIRTIO_BLK_SECTOR_SIZE != 0 ||
+        req->sector + (bytes / VIRTIO_BLK_SECTOR_SIZE) > blk_dev.capacity ||
+        virtio_blk_request_descs(req) > blk_dev.seg_max)
+    {
+      return -EINVARG;
+    }
+
+    if (req->op == VIRTIO_BLK_OP_WRITE && blk_dev.read_only)
+    {
+      return -EINVARG;
+    }
+  }
+
+  req->done = false;
+  req->result = EOK;
+  req->next = NULL;
+
+  uint64_t flags = spin_lock_irqsave(&blk_lock);
+  if (blk_dev.pending_tail)
+  {
+    blk_dev.pending_tail->next = req;
+  }
+  else
+  {
+    blk_dev.pending = req;
+  }
+  blk_dev.pending_tail = req;
+  blk_dev.stats.submitted++;
+  spin_unlock_irqrestore(&blk_lock, flags);
+
+  return EOK;
+}
+
+/**
+ * @brief Merge the queued requests and send as many as fit to the device
+ * with a single notification
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtio_blk_kick()
+{
+  if (!blk_dev.ready)
+  {
+    return;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&blk_lock);
+  virtio_blk_dispatch();
+  spin_unlock_irqrestore(&blk_lock, flags);
+}
+
+/**
+ * @brief Wait for a request to complete
+ * 
+ * IRQs stay masked while checking so a completion cannot slip in between
+ * the check and the wfi, a pending interrupt still wakes the core. The
+ * lock is dropped around the wfi so another CPU can complete requests.
+ * 
+ * @param req Submitted request
+ * @return int Result of the request
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_wait(virtio_blk_request_t* req)
+{
+  if (!blk_dev.ready || !req)
+  {
+    return -EINVARG;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&blk_lock);
+  while (!req->done)
+  {
+    virtio_device_ack_interrupt(blk_dev.dev);
+    virtio_blk_complete();
+    if (req->done)
+    {
+      break;
+    }
+
+    if (blk_dev.use_irq)
+    {
+      spin_unlock(&blk_lock);
+      __asm__ volatile("wfi");
+      spin_lock(&blk_lock);
+    }
+  }
+  spin_unlock_irqrestore(&blk_lock, flags);
+
+  return req->result;
+}
+
+/**
+ * @brief Submit a single buffer request and wait for it
+ * 
+ * @param op Request type
+ * @param sector First sector
+ * @param buffer Buffer
+ * @param size Size in bytes
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int virtio_blk_transfer(virtio_blk_op_t op, uint64_t sector, void* buffer, size_t size)
+{
+  virtio_blk_request_t req;
+
+  int res = virtio_blk_request_init(&req, op, sector, buffer, size);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  res = virtio_blk_submit(&req);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  virtio_blk_kick();
+  return virtio_blk_wait(&req);
+}
+
+/**
+ * @brief Read sectors synchronously
+ * 
+ * @param sector First sector
+ * @param buffer Destination
+ * @param size Size in bytes (multiple of the sector size)
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_read(uint64_t sector, void* buffer, size_t size)
+{
+  return virtio_blk_transfer(VIRTIO_BLK_OP_READ, sector, buffer, size);
+}
+
+/**
+ * @brief Write sectors synchronously
+ * 
+ * @param sector First sector
+ * @param buffer Source
+ * @param size Size in bytes (multiple of the sector size)
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_write(uint64_t sector, void* buffer, size_t size)
+{
+  return virtio_blk_transfer(VIRTIO_BLK_OP_WRITE, sector, buffer, size);
+}
+
+/**
+ * @brief Block device interrupt handler
+ * 
+ * @param int_frame Interrupt frame
+ * @return int Handler result
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_irq_handler(struct interrupt_frame* int_frame)
+{
+  (void)int_frame;
+
+  if (!blk_dev.ready)
+  {
+    return -ENOTREADY;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&blk_lock);
+  blk_dev.stats.interrupts++;
+  virtio_device_ack_interrupt(blk_dev.dev);
+  virtio_blk_complete();
+  spin_unlock_irqrestore(&blk_lock, flags);
+
+  return EOK;
+}
+
+/**
+ * @brief Get the driver statistics
+ * 
+ * @param stats Output for the statistics
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtio_blk_get_stats(virtio_blk_stats_t* stats)
+{
+  if (!stats)
+  {
+    return;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&blk_lock);
+  *stats = blk_dev.stats;
+  spin_unlock_irqrestore(&blk_lock, flags);
+}
+
+/**
+ * @brief Print the result of a benchmark run
+ * 
+ * @param name Run name
+ * @param bytes Bytes read
+ * @param ios Caller requests
+ * @param ticks Elapsed timer ticks
+ * @param issued Device requests after merging
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void virtio_blk_bench_print(const char* name, uint64_t bytes, uint64_t ios, uint64_t ticks, uint64_t issued)
+{
+  uint64_t frequency = timer_read_frequency();
+  if (ticks == 0)
+  {
+    ticks = 1;
+  }
+
+  uart_send_string(name);
+  uart_send_string(": ");
+  uart_send_string(uint_to_str((bytes * frequency) / ticks / 1024));
+  uart_send_string(" KB/s, ");
+  uart_send_string(uint_to_str((ios * frequency) / ticks));
+  uart_send_string(" IOPS, ");
+  uart_send_string(uint_to_str(ios));
+  uart_send_string(" requests as ");
+  uart_send_string(uint_to_str(issued));
+  uart_send_string(" device requests\n");
+}
+
+/**
+ * @brief Run batches of 4 KB reads and wait for each batch
+ * 
+ * @param reqs Request array of VIRTIO_BLK_BENCH_BATCH entries
+ * @param buffer Buffer of VIRTIO_BLK_BENCH_BATCH * 4 KB
+ * @param ios Number of reads
+ * @param random true for random sectors, sequential otherwise
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int virtio_blk_bench_run(virtio_blk_request_t* reqs, uint8_t* buffer, uint64_t ios, bool random)
+{
+  const uint64_t io_sectors = VIRTIO_BLK_BENCH_IO_SIZE / VIRTIO_BLK_SECTOR_SIZE;
+  uint64_t blocks = blk_dev.capacity / io_sectors;
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  uint64_t done = 0;
+  int res = EOK;
+
+  while (done < ios)
+  {
+    uint64_t batch = ios - done < VIRTIO_BLK_BENCH_BATCH ? ios - done : VIRTIO_BLK_BENCH_BATCH;
+    uint64_t submitted = 0;
+
+    for (uint64_t i = 0; i < batch; i++)
+    {
+      uint64_t block = done + i;
+      if (random)
+      {
+        seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+        block = seed >> 33;
+      }
+
+      virtio_blk_request_init(&reqs[i], VIRTIO_BLK_OP_READ, (block % blocks) * io_sectors,
+                              buffer + (i * VIRTIO_BLK_BENCH_IO_SIZE), VIRTIO_BLK_BENCH_IO_SIZE);
+      res = virtio_blk_submit(&reqs[i]);
+      if (res < 0)
+      {
+        break;
+      }
+      submitted++;
+    }
+
+    virtio_blk_kick();
+
+    // The requests must not be reused before the device is done with them
+    for (uint64_t i = 0; i < submitted; i++)
+    {
+      int req_res = virtio_blk_wait(&reqs[i]);
+      res = res == EOK ? req_res : res;
+    }
+
+    if (res < 0)
+    {
+      return res;
+    }
+
+    done += batch;
+  }
+
+  return EOK;
+}
+
+/**
+ * @brief Measure sequential and random read throughput
+ * 
+ * Sequential reads are submitted as 4 KB requests and merged by the
+ * driver, random reads hit 4 KB aligned blocks across the device.
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_benchmark()
+{
+  if (!blk_dev.ready)
+  {
+    return -ENOTREADY;
+  }
+
+  uint64_t io_sectors = VIRTIO_BLK_BENCH_IO_SIZE / VIRTIO_BLK_SECTOR_SIZE;
+  if (blk_dev.capacity < io_sectors * VIRTIO_BLK_BENCH_BATCH)
+  {
+    uart_send_string("virtio-blk: device too small for the benchmark\n");
+    return -EINVARG;
+  }
+
+  virtio_blk_request_t* reqs = (virtio_blk_request_t*)kzalloc(VIRTIO_BLK_BENCH_BATCH * sizeof(virtio_blk_request_t));
+  uint8_t* buffer = (uint8_t*)kmalloc(VIRTIO_BLK_BENCH_BATCH * VIRTIO_BLK_BENCH_IO_SIZE);
+  int res = EOK;
+
+  if (!reqs || !buffer)
+  {
+    res = -ENOMEM;
+    goto out;
+  }
+
+  uart_send_string("\n=== virtio-blk Read Benchmark ===\n");
+
+  uint64_t seq_ios = VIRTIO_BLK_BENCH_SEQ_BYTES / VIRTIO_BLK_BENCH_IO_SIZE;
+  if (seq_ios > blk_dev.capacity / io_sectors)
+  {
+    seq_ios = blk_dev.capacity / io_sectors;
+  }
+
+  uint64_t issued = blk_dev.stats.issued;
+  uint64_t start = timer_read_counter();
+  res = virtio_blk_bench_run(reqs, buffer, seq_ios, false);
+  uint64_t ticks = timer_read_counter() - start;
+  if (res < 0)
+  {
+    goto out;
+  }
+  virtio_blk_bench_print("Sequential 4K", seq_ios * VIRTIO_BLK_BENCH_IO_SIZE, seq_ios, ticks, blk_dev.stats.issued - issued);
+
+  issued = blk_dev.stats.issued;
+  start = timer_read_counter();
+  res = virtio_blk_bench_run(reqs, buffer, VIRTIO_BLK_BENCH_RANDOM_IOS, true);
+  ticks = timer_read_counter() - start;
+  if (res < 0)
+  {
+    goto out;
+  }
+  virtio_blk_bench_print("Random 4K", VIRTIO_BLK_BENCH_RANDOM_IOS * VIRTIO_BLK_BENCH_IO_SIZE,
+                         VIRTIO_BLK_BENCH_RANDOM_IOS, ticks, blk_dev.stats.issued - issued);
+
+  uart_send_string("Interrupts: ");
+  uart_send_string(uint_to_str(blk_dev.stats.interrupts));
+  uart_send_string(", merged requests: ");
+  uart_send_string(uint_to_str(blk_dev.stats.merged));
+  uart_send_string("\n");
+
+out:
+  if (reqs)
+    kfree(reqs);
+  if (buffer)
+    kfree(buffer);
+
+  if (res < 0)
+  {
+    uart_send_string("virtio-blk: benchmark failed\n");
+  }
+
+  return res;
+}
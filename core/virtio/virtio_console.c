@@ -0,0 +1,932 @@
+/*
+ * virtio_console.c - This file implements the virtio console driver.
+ * Ports are announced by the device on the control queue, each open
+ * port owns a ring of DMA buffers that producers fill without waiting
+ * and that the device drains to the host chardev.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#include "virtio_console.h"
+
+#include <uart.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <synapse/virtio/virtio.h>
+#include <synapse/string/string.h>
+#include <synapse/memory/memory.h>
+#include <synapse/memory/heap/kheap.h>
+#include <synapse/smp/smp.h>
+#include <synapse/interrupts/interrupt.h>
+#include <synapse/sync/spinlock.h>
+#include <synapse/timer/counter.h>
+
+// Descriptors per queue, every buffer takes one
+#define VIRTIO_CONSOLE_QUEUE_SIZE 16
+
+// How long the device may take to announce its ports
+#define VIRTIO_CONSOLE_DISCOVERY_MS 20
+
+// Benchmark configuration
+#define VIRTIO_CONSOLE_BENCH_BYTES (8 * 1024 * 1024)
+#define VIRTIO_CONSOLE_BENCH_CHUNK 4096
+#define VIRTIO_CONSOLE_UART_BYTES_PER_SEC (115200 / 10) // 8N1 at 115200 baud
+
+// Transmit buffer, owned by the device while in flight
+typedef struct virtio_console_buffer
+{
+  uint8_t* data;
+  uint32_t len; // Bytes filled
+  bool in_flight;
+} virtio_console_buffer_t;
+
+typedef struct virtio_console_port
+{
+  bool present;        // Announced by the device
+  bool open;           // Opened by the driver
+  bool host_connected; // Host side of the chardev is open
+  bool is_console;     // Text console rather than a data channel
+  char name[VIRTIO_CONSOLE_NAME_MAX];
+  virtqueue_t* tx;
+  virtio_console_buffer_t buffers[VIRTIO_CONSOLE_TX_BUFFERS];
+  uint32_t fill; // Buffer producers write to, buffers are used in ring order
+  virtio_console_stats_t stats;
+} virtio_console_port_t;
+
+// Control message slot, read or written by the device
+typedef struct virtio_console_ctrl_buffer
+{
+  uint8_t data[VIRTIO_CONSOLE_CTRL_BUFFER_SIZE];
+  bool in_use;
+} virtio_console_ctrl_buffer_t;
+
+// Console device state
+typedef struct virtio_console_device
+{
+  virtio_device_t* dev;
+  bool multiport;
+  uint32_t port_count; // Ports driven
+  bool use_irq;        // Completion interrupt registered
+  bool ready;
+
+  virtqueue_t* ctrl_rx; // Messages from the device
+  virtqueue_t* ctrl_tx; // Messages to the device
+  virtio_console_ctrl_buffer_t ctrl_rx_buffers[VIRTIO_CONSOLE_CTRL_BUFFERS];
+  virtio_console_ctrl_buffer_t ctrl_tx_buffers[VIRTIO_CONSOLE_CTRL_BUFFERS];
+
+  virtio_console_port_t ports[VIRTIO_CONSOLE_MAX_PORTS];
+  int trace_port; // Port opened for the trace data, -1 if none
+  uint64_t interrupts;
+} virtio_console_device_t;
+
+static virtio_console_device_t con_dev;
+
+// Guards the queues, the transmit and control buffers and the port state.
+// Taken with IRQs masked, the interrupt handler may run on any CPU
+static spinlock_t con_lock = SPINLOCK_INIT;
+
+/**
+ * @brief Get the transmit queue index of a port, port 0 keeps the
+ * queues of a single port device and the control pair comes next
+ * 
+ * @param port Port number
+ * @return uint32_t Queue index
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static uint32_t virtio_console_tx_queue(uint32_t port)
+{
+  return port == 0 ? 1 : (port * 2) + 3;
+}
+
+/**
+ * @brief Give a control buffer back to the device.
+ * Called with con_lock held.
+ * 
+ * @param buffer Control buffer
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int virtio_console_post_ctrl(virtio_console_ctrl_buffer_t* buffer)
+{
+  virtio_buf_t buf = { buffer->data, VIRTIO_CONSOLE_CTRL_BUFFER_SIZE, true };
+  return virtqueue_add(con_dev.ctrl_rx, &buf, 1, buffer);
+}
+
+/**
+ * @brief Queue a control message for the device.
+ * Called with con_lock held.
+ * 
+ * @param port Port number
+ * @param event Event
+ * @param value Event value
+ * @return int EOK on success, -ENOMEM if every message slot is in flight
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int virtio_console_send_ctrl(uint32_t port, virtio_console_event_t event, uint16_t value)
+{
+  virtio_console_ctrl_buffer_t* buffer;
+  while ((buffer = (virtio_console_ctrl_buffer_t*)virtqueue_get_used(con_dev.ctrl_tx, NULL)) != NULL)
+  {
+    buffer->in_use = false;
+  }
+
+  for (uint32_t i = 0; i < VIRTIO_CONSOLE_CTRL_BUFFERS; i++)
+  {
+    buffer = &con_dev.ctrl_tx_buffers[i];
+    if (buffer->in_use)
+    {
+      continue;
+    }
+
+    struct virtio_console_control* msg = (struct virtio_console_control*)buffer->data;
+    msg->id = port;
+    msg->event = event;
+    msg->value = value;
+
+    virtio_buf_t buf = { buffer->data, sizeof(struct virtio_console_control), false };
+    int res = virtqueue_add(con_dev.ctrl_tx, &buf, 1, buffer);
+    if (res < 0)
+    {
+      return res;
+    }
+
+    buffer->in_use = true;
+    virtqueue_kick(con_dev.ctrl_tx);
+    return EOK;
+  }
+
+  return -ENOMEM;
+}
+
+/**
+ * @brief Handle one control message from the device.
+ * Called with con_lock held.
+ * 
+ * @param data Message
+ * @param len Bytes written by the device
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void virtio_console_handle_ctrl(const uint8_t* data, uint32_t len)
+{
+  if (len < sizeof(struct virtio_console_control))
+  {
+    return;
+  }
+
+  const struct virtio_console_control* msg = (const struct virtio_console_control*)data;
+  if (msg->id >= con_dev.port_count)
+  {
+    // Ports past our limit are refused so the host does not wait on them
+    if (msg->event == VIRTIO_CONSOLE_DEVICE_ADD)
+    {
+      virtio_console_send_ctrl(msg->id, VIRTIO_CONSOLE_PORT_READY, 0);
+    }
+    return;
+  }
+
+  virtio_console_port_t* port = &con_dev.ports[msg->id];
+  switch (msg->event)
+  {
+    case VIRTIO_CONSOLE_DEVICE_ADD:
+      port->present = true;
+      virtio_console_send_ctrl(msg->id, VIRTIO_CONSOLE_PORT_READY, 1);
+      break;
+
+    case VIRTIO_CONSOLE_DEVICE_REMOVE:
+      port->present = false;
+      port->open = false;
+      port->host_connected = false;
+      break;
+
+    case VIRTIO_CONSOLE_CONSOLE_PORT:
+      port->is_console = true;
+      break;
+
+    case VIRTIO_CONSOLE_PORT_OPEN:
+      port->host_connected = msg->value != 0;
+      break;
+
+    case VIRTIO_CONSOLE_PORT_NAME:
+    {
+      uint32_t name_len = len - sizeof(struct virtio_console_control);
+      if (name_len >= VIRTIO_CONSOLE_NAME_MAX)
+      {
+        name_len = VIRTIO_CONSOLE_NAME_MAX - 1;
+      }
+
+      memcpy(port->name, (void*)(data + sizeof(struct virtio_console_control)), name_len);
+      port->name[name_len] = '\0';
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Handle the control messages the device sent and recycle their
+ * buffers. Called with con_lock held.
+ * 
+ * @return int Number of messages handled
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int virtio_console_process_ctrl()
+{
+  if (!con_dev.multiport)
+  {
+    return 0;
+  }
+
+  virtio_console_ctrl_buffer_t* buffer;
+  uint32_t len = 0;
+  int handled = 0;
+
+  while ((buffer = (virtio_console_ctrl_buffer_t*)virtqueue_get_used(con_dev.ctrl_rx, &len)) != NULL)
+  {
+    virtio_console_handle_ctrl(buffer->data, len);
+    virtio_console_post_ctrl(buffer);
+    handled++;
+  }
+
+  if (handled > 0)
+  {
+    virtqueue_kick(con_dev.ctrl_rx);
+  }
+
+  return handled;
+}
+
+/**
+ * @brief Recycle the transmit buffers the device consumed.
+ * Called with con_lock held.
+ * 
+ * @param port Port
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void virtio_console_complete(virtio_console_port_t* port)
+{
+  virtio_console_buffer_t* buffer;
+  while ((buffer = (virtio_console_buffer_t*)virtqueue_get_used(port->tx, NULL)) != NULL)
+  {
+    buffer->len = 0;
+    buffer->in_flight = false;
+    port->stats.completed++;
+  }
+}
+
+/**
+ * @brief Hand the buffer being filled to the device and move to the
+ * next one. Called with con_lock held.
+ * 
+ * @param port Port
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static int virtio_console_submit(virtio_console_port_t* port)
+{
+  virtio_console_buffer_t* buffer = &port->buffers[port->fill];
+
+  // The device reads the buffer in place, no bounce copy
+  virtio_buf_t buf = { buffer->data, buffer->len, false };
+  int res = virtqueue_add(port->tx, &buf, 1, buffer);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  buffer->in_flight = true;
+  port->fill = (port->fill + 1) % VIRTIO_CONSOLE_TX_BUFFERS;
+  port->stats.buffers++;
+  virtqueue_kick(port->tx);
+
+  return EOK;
+}
+
+/**
+ * @brief Get an open port
+ * 
+ * @param port Port number
+ * @return virtio_console_port_t* Port, or NULL if it is not open
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static virtio_console_port_t* virtio_console_get_open_port(uint32_t port)
+{
+  if (!con_dev.ready || port >= con_dev.port_count || !con_dev.ports[port].open)
+  {
+    return NULL;
+  }
+
+  return &con_dev.ports[port];
+}
+
+/**
+ * @brief Free the resources of every port and reset the device
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static void virtio_console_teardown()
+{
+  virtio_device_reset(con_dev.dev);
+
+  for (uint32_t i = 0; i < VIRTIO_CONSOLE_MAX_PORTS; i++)
+  {
+    virtio_console_port_t* port = &con_dev.ports[i];
+    for (uint32_t j = 0; j < VIRTIO_CONSOLE_TX_BUFFERS; j++)
+    {
+      if (port->buffers[j].data)
+        kfree(port->buffers[j].data);
+    }
+
+    if (port->tx)
+      virtqueue_destroy(port->tx);
+  }
+
+  if (con_dev.ctrl_rx)
+    virtqueue_destroy(con_dev.ctrl_rx);
+  if (con_dev.ctrl_tx)
+    virtqueue_destroy(con_dev.ctrl_tx);
+
+  con_dev.dev->claimed = false;
+}
+
+/**
+ * @brief Find the first virtio console device, set it up and open the
+ * trace port if the host provides one
+ * 
+ * With multiport the device announces its ports on the control queue
+ * once the driver is ready, the transmit queues of all of them are set
+ * up first since queues cannot be added after DRIVER_OK. Receive queues
+ * are left unset: ports only carry data to the host.
+ * 
+ * @return int EOK on success, -ENOENT if there is no device,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_init()
+{
+  int res = EOK;
+
+  if (con_dev.ready)
+  {
+    return EOK;
+  }
+
+  memset(&con_dev, 0, sizeof(con_dev));
+  con_dev.trace_port = -1;
+
+  con_dev.dev = virtio_mmio_claim(VIRTIO_ID_CONSOLE);
+  if (!con_dev.dev)
+  {
+    return -ENOENT;
+  }
+
+  res = virtio_device_setup(con_dev.dev, 1ULL << VIRTIO_CONSOLE_F_MULTIPORT);
+  if (res < 0)
+  {
+    goto fail;
+  }
+
+  // Configuration: cols (u16), rows (u16), max_nr_ports (u32), emerg_wr (u32)
+  con_dev.multiport = virtio_device_has_feature(con_dev.dev, VIRTIO_CONSOLE_F_MULTIPORT);
+  con_dev.port_count = 1;
+  if (con_dev.multiport)
+  {
+    con_dev.port_count = virtio_config_read32(con_dev.dev, 4);
+    if (con_dev.port_count > VIRTIO_CONSOLE_MAX_PORTS)
+    {
+      con_dev.port_count = VIRTIO_CONSOLE_MAX_PORTS;
+    }
+  }
+
+  for (uint32_t i = 0; i < con_dev.port_count; i++)
+  {
+    res = virtqueue_create(con_dev.dev, virtio_console_tx_queue(i), VIRTIO_CONSOLE_QUEUE_SIZE, &con_dev.ports[i].tx);
+    if (res < 0)
+    {
+      goto fail;
+    }
+  }
+
+  if (con_dev.multiport)
+  {
+    res = virtqueue_create(con_dev.dev, 2, VIRTIO_CONSOLE_QUEUE_SIZE, &con_dev.ctrl_rx);
+    if (res < 0)
+    {
+      goto fail;
+    }
+
+    res = virtqueue_create(con_dev.dev, 3, VIRTIO_CONSOLE_QUEUE_SIZE, &con_dev.ctrl_tx);
+    if (res < 0)
+    {
+      goto fail;
+    }
+
+    for (uint32_t i = 0; i < VIRTIO_CONSOLE_CTRL_BUFFERS; i++)
+    {
+      res = virtio_console_post_ctrl(&con_dev.ctrl_rx_buffers[i]);
+      if (res < 0)
+      {
+        goto fail;
+      }
+    }
+  }
+  else
+  {
+    // A single port device has its console port from the start
+    con_dev.ports[0].present = true;
+    con_dev.ports[0].host_connected = true;
+    con_dev.ports[0].is_console = true;
+  }
+
+  // Without the interrupt controller completions are reaped by the
+  // producers. The interrupt is pinned to this CPU
+  con_dev.use_irq = interrupt_register_handler(con_dev.dev->irq, virtio_console_irq_handler) == EOK &&
+                    interrupt_pin_affinity(con_dev.dev->irq, smp_processor_id()) == EOK &&
+                    interrupt_enable(con_dev.dev->irq) == EOK;
+
+  virtio_device_ready(con_dev.dev);
+  con_dev.ready = true;
+
+  if (con_dev.multiport)
+  {
+    uint64_t flags = spin_lock_irqsave(&con_lock);
+    virtqueue_kick(con_dev.ctrl_rx);
+    res = virtio_console_send_ctrl(0, VIRTIO_CONSOLE_DEVICE_READY, 1);
+    spin_unlock_irqrestore(&con_lock, flags);
+    if (res < 0)
+    {
+      con_dev.ready = false;
+      goto fail;
+    }
+
+    // Port announcements and names follow DEVICE_READY
+    uint64_t wait = (timer_read_frequency() * VIRTIO_CONSOLE_DISCOVERY_MS) / 1000;
+    uint64_t start = timer_read_counter();
+    while (timer_read_counter() - start < wait)
+    {
+      virtio_console_poll();
+    }
+  }
+
+  uart_send_string("virtio-console: ");
+  uart_send_string(uint_to_str(con_dev.port_count));
+  uart_send_string(con_dev.multiport ? " ports" : " port");
+  uart_send_string(con_dev.use_irq ? ", interrupt driven\n" : ", polled\n");
+
+  for (uint32_t i = 0; i < con_dev.port_count; i++)
+  {
+    virtio_console_port_t* port = &con_dev.ports[i];
+    if (!port->present)
+    {
+      continue;
+    }
+
+    uart_send_string("  port ");
+    uart_send_string(uint_to_str(i));
+    uart_send_string(": ");
+    uart_send_string(port->name[0] ? port->name : "(unnamed)");
+    uart_send_string(port->is_console ? ", console" : "");
+    uart_send_string(port->host_connected ? ", connected\n" : "\n");
+  }
+
+  int trace = virtio_console_find_port(VIRTIO_CONSOLE_TRACE_PORT);
+  if (trace >= 0 && virtio_console_open((uint32_t)trace) == EOK)
+  {
+    con_dev.trace_port = trace;
+  }
+
+  return EOK;
+
+fail:
+  virtio_console_teardown();
+  uart_send_string("virtio-console: device setup failed\n");
+  return res;
+}
+
+/**
+ * @brief Check if a console device is ready
+ * 
+ * @return bool true if virtio_console_init() succeeded
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool virtio_console_present()
+{
+  return con_dev.ready;
+}
+
+/**
+ * @brief Find a port by the name the host gave it
+ * 
+ * @param name Port name (e.g. VIRTIO_CONSOLE_TRACE_PORT)
+ * @return int Port number, -ENOENT if there is no such port
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_find_port(const char* name)
+{
+  if (!con_dev.ready || !name)
+  {
+    return -ENOENT;
+  }
+
+  for (uint32_t i = 0; i < con_dev.port_count; i++)
+  {
+    virtio_console_port_t* port = &con_dev.ports[i];
+    if (port->present && strncmp(port->name, name, VIRTIO_CONSOLE_NAME_MAX) == 0)
+    {
+      return (int)i;
+    }
+  }
+
+  return -ENOENT;
+}
+
+/**
+ * @brief Allocate the transmit buffers of a port and tell the host it
+ * is open
+ * 
+ * @param port Port number
+ * @return int EOK on success, -ENOENT if the device has no such port,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_open(uint32_t port)
+{
+  if (!con_dev.ready)
+  {
+    return -ENOTREADY;
+  }
+
+  if (port >= con_dev.port_count || !con_dev.ports[port].present)
+  {
+    return -ENOENT;
+  }
+
+  virtio_console_port_t* p = &con_dev.ports[port];
+  if (p->open)
+  {
+    return EOK;
+  }
+
+  for (uint32_t i = 0; i < VIRTIO_CONSOLE_TX_BUFFERS; i++)
+  {
+    if (p->buffers[i].data)
+    {
+      continue;
+    }
+
+    p->buffers[i].data = (uint8_t*)kmalloc(VIRTIO_CONSOLE_TX_BUFFER_SIZE);
+    if (!p->buffers[i].data)
+    {
+      return -ENOMEM;
+    }
+  }
+
+  int res = EOK;
+  uint64_t flags = spin_lock_irqsave(&con_lock);
+  if (con_dev.multiport)
+  {
+    res = virtio_console_send_ctrl(port, VIRTIO_CONSOLE_PORT_OPEN, 1);
+  }
+
+  if (res == EOK)
+  {
+    p->fill = 0;
+    p->open = true;
+  }
+  spin_unlock_irqrestore(&con_lock, flags);
+
+  return res;
+}
+
+/**
+ * @brief Copy data to the transmit buffers of a port, never waits
+ * 
+ * @param port Port number
+ * @param data Data
+ * @param size Size in bytes
+ * @return int Bytes accepted, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_write(uint32_t port, const void* data, size_t size)
+{
+  virtio_console_port_t* p = virtio_console_get_open_port(port);
+  if (!p)
+  {
+    return -ENOTREADY;
+  }
+
+  if (!data && size > 0)
+  {
+    return -EINVARG;
+  }
+
+  const uint8_t* src = (const uint8_t*)data;
+  size_t accepted = 0;
+  int res = EOK;
+
+  uint64_t flags = spin_lock_irqsave(&con_lock);
+
+  while (accepted < size)
+  {
+    virtio_console_buffer_t* buffer = &p->buffers[p->fill];
+    if (buffer->in_flight)
+    {
+      virtio_console_complete(p);
+      if (buffer->in_flight)
+      {
+        break;
+      }
+    }
+
+    size_t len = size - accepted;
+    if (len > VIRTIO_CONSOLE_TX_BUFFER_SIZE - buffer->len)
+    {
+      len = VIRTIO_CONSOLE_TX_BUFFER_SIZE - buffer->len;
+    }
+
+    memcpy(buffer->data + buffer->len, (void*)(src + accepted), (int)len);
+    buffer->len += len;
+    accepted += len;
+
+    if (buffer->len == VIRTIO_CONSOLE_TX_BUFFER_SIZE)
+    {
+      res = virtio_console_submit(p);
+      if (res < 0)
+      {
+        break;
+      }
+    }
+  }
+
+  p->stats.writes++;
+  p->stats.bytes += accepted;
+  p->stats.dropped += size - accepted;
+
+  spin_unlock_irqrestore(&con_lock, flags);
+
+  return res < 0 ? res : (int)accepted;
+}
+
+/**
+ * @brief Hand the partly filled buffer of a port to the device
+ * 
+ * @param port Port number
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_flush(uint32_t port)
+{
+  virtio_console_port_t* p = virtio_console_get_open_port(port);
+  if (!p)
+  {
+    return -ENOTREADY;
+  }
+
+  int res = EOK;
+  uint64_t flags = spin_lock_irqsave(&con_lock);
+
+  virtio_console_buffer_t* buffer = &p->buffers[p->fill];
+  if (!buffer->in_flight && buffer->len > 0)
+  {
+    res = virtio_console_submit(p);
+  }
+
+  spin_unlock_irqrestore(&con_lock, flags);
+
+  return res;
+}
+
+/**
+ * @brief Write to the trace port opened by virtio_console_init()
+ * 
+ * @param data Data
+ * @param size Size in bytes
+ * @return int Bytes accepted, -ENOENT if there is no trace port
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_trace_write(const void* data, size_t size)
+{
+  if (!con_dev.ready || con_dev.trace_port < 0)
+  {
+    return -ENOENT;
+  }
+
+  return virtio_console_write((uint32_t)con_dev.trace_port, data, size);
+}
+
+/**
+ * @brief Recycle the buffers the device consumed and handle control
+ * messages, for callers running with IRQs masked
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtio_console_poll()
+{
+  if (!con_dev.ready)
+  {
+    return;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&con_lock);
+
+  virtio_console_process_ctrl();
+  for (uint32_t i = 0; i < con_dev.port_count; i++)
+  {
+    if (con_dev.ports[i].open)
+    {
+      virtio_console_complete(&con_dev.ports[i]);
+    }
+  }
+
+  spin_unlock_irqrestore(&con_lock, flags);
+}
+
+/**
+ * @brief Console device interrupt handler
+ * 
+ * @param int_frame Interrupt frame
+ * @return int Handler result
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_irq_handler(struct interrupt_frame* int_frame)
+{
+  (void)int_frame;
+
+  if (!con_dev.ready)
+  {
+    return -ENOTREADY;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&con_lock);
+  con_dev.interrupts++;
+  virtio_device_ack_interrupt(con_dev.dev);
+  spin_unlock_irqrestore(&con_lock, flags);
+
+  virtio_console_poll();
+
+  return EOK;
+}
+
+/**
+ * @brief Get the counters of a port
+ * 
+ * @param port Port number
+ * @param stats Output for the counters
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_get_stats(uint32_t port, virtio_console_stats_t* stats)
+{
+  if (!stats)
+  {
+    return -EINVARG;
+  }
+
+  if (!con_dev.ready || port >= con_dev.port_count)
+  {
+    return -ENOENT;
+  }
+
+  uint64_t flags = spin_lock_irqsave(&con_lock);
+  *stats = con_dev.ports[port].stats;
+  spin_unlock_irqrestore(&con_lock, flags);
+
+  return EOK;
+}
+
+/**
+ * @brief Measure the throughput of the trace port against the PL011
+ * 
+ * The producer polls for completions when the buffers are all in flight
+ * instead of dropping, so every byte reaches the host.
+ * 
+ * @return int EOK on success, -ENOENT if there is no trace port,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_benchmark()
+{
+  if (!con_dev.ready || con_dev.trace_port < 0)
+  {
+    return -ENOENT;
+  }
+
+  uint32_t port = (uint32_t)con_dev.trace_port;
+  uint8_t* chunk = (uint8_t*)kmalloc(VIRTIO_CONSOLE_BENCH_CHUNK);
+  if (!chunk)
+  {
+    return -ENOMEM;
+  }
+
+  for (uint32_t i = 0; i < VIRTIO_CONSOLE_BENCH_CHUNK; i++)
+  {
+    chunk[i] = (uint8_t)i;
+  }
+
+  uart_send_string("\n=== virtio-console Trace Port Benchmark ===\n");
+
+  int res = EOK;
+  uint64_t sent = 0;
+  uint64_t start = timer_read_counter();
+
+  while (sent < VIRTIO_CONSOLE_BENCH_BYTES)
+  {
+    uint64_t offset = sent % VIRTIO_CONSOLE_BENCH_CHUNK;
+    res = virtio_console_write(port, chunk + offset, VIRTIO_CONSOLE_BENCH_CHUNK - offset);
+    if (res < 0)
+    {
+      goto out;
+    }
+
+    if ((size_t)res < VIRTIO_CONSOLE_BENCH_CHUNK - offset)
+    {
+      virtio_console_poll();
+    }
+    sent += (uint64_t)res;
+  }
+
+  res = virtio_console_flush(port);
+  if (res < 0)
+  {
+    goto out;
+  }
+
+  // Wait for the host to take every buffer
+  virtio_console_stats_t stats;
+  do
+  {
+    virtio_console_poll();
+    virtio_console_get_stats(port, &stats);
+  } while (stats.completed < stats.buffers);
+
+  uint64_t ticks = timer_read_counter() - start;
+  uint64_t frequency = timer_read_frequency();
+  if (ticks == 0)
+  {
+    ticks = 1;
+  }
+
+  uart_send_string("Trace port: ");
+  uart_send_string(uint_to_str(sent / 1024));
+  uart_send_string(" KB in ");
+  uart_send_string(uint_to_str((ticks * 1000) / frequency));
+  uart_send_string(" ms, ");
+  uart_send_string(uint_to_str((sent * frequency) / ticks / 1024));
+  uart_send_string(" KB/s, ");
+  uart_send_string(uint_to_str(stats.buffers));
+  uart_send_string(" buffers\n");
+
+  uart_send_string("PL011 at 115200 baud: ");
+  uart_send_string(uint_to_str(sent / VIRTIO_CONSOLE_UART_BYTES_PER_SEC));
+  uart_send_string(" s for the same data\n");
+
+  res = EOK;
+
+out:
+  kfree(chunk);
+  return res;
+}
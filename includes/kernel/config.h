@@ -4,7 +4,7 @@
  *
  * Author: Fedi Nabli
  * Date: 2 Mar 2025
- * Last Modified: 8 Apr 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __KERNEL_CONFIG_H_
@@ -20,6 +20,10 @@
 #define AI_MEMORY_MIN_BLOCK_SIZE 64
 #define AI_MEMORY_MAX_BLOCKS 4096
 
+// Maximum number of page colours tracked by the AI allocator
+// (L2 way size / PAGE_SIZE, 16 for a 1MB 16-way Cortex-A53 L2)
+#define AI_MEMORY_MAX_COLOURS 64
+
 // Memory alignement constants
 #define AI_MEMORY_ALIGN_SIMD 32 // For NEON/SVE instructions
 
@@ -34,11 +38,21 @@
 
 #define SYNAPSE_MAX_PROCESSES 64
 #define SYNAPSE_MAX_PROCESSES_ALLOCATIONS 128
+#define SYNAPSE_PROCESS_ALLOCATION_SLOTS (2 * SYNAPSE_MAX_PROCESSES_ALLOCATIONS) // Hash slots, half full at most
 #define SYNAPSE_PROCESS_STACK_SIZE (128 * 1024) // 128KB
 #define SYNAPSE_MAX_PROCESS_NAME 64
 
+// Pre-zeroed blocks the zero pool worker keeps ready
+#define ZERO_POOL_PAGES 32 // One heap block each, for kzalloc()
+#define ZERO_POOL_STACKS 2 // SYNAPSE_PROCESS_STACK_SIZE each
+
+#define SYNAPSE_MAX_KTHREADS 16
+#define SYNAPSE_KTHREAD_STACK_SIZE (8 * 1024) // 8KB
+
 #define CPU_FREQ_HZ 1000000000 // 1GHz
 
+#define CACHE_LINE_SIZE 64 // Cortex-A53 L1 and L2 line
+
 // Timer tick interval in ms
 #define SCHEDULER_TICKS_MS 10
 
@@ -0,0 +1,106 @@
+/*
+ * bf16.h - This file defines the BFLOAT16 conversions and kernels.
+ * BF16 tensors are loaded into FP32 registers, accumulated in FP32
+ * and optionally rounded back to BF16 on store.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_AI_BF16_H_
+#define __SYNAPSE_AI_BF16_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/memory/ai_memory/ai_memory.h>
+
+// Elementwise operations
+typedef enum
+{
+  BF16_OP_ADD, // c = a + b
+  BF16_OP_SUB, // c = a - b
+  BF16_OP_MUL, // c = a * b
+  BF16_OP_COUNT // Number of operations
+} bf16_op_t;
+
+/**
+ * @brief Convert a FLOAT32 value to BF16, round to nearest even
+ * 
+ * @param value FLOAT32 value
+ * @return uint16_t BF16 bits, NaN stays a (quiet) NaN
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint16_t ai_bf16_from_f32(float value);
+
+/**
+ * @brief Convert a BF16 value to FLOAT32 (exact)
+ * 
+ * @param value BF16 bits
+ * @return float FLOAT32 value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float ai_bf16_to_f32(uint16_t value);
+
+/**
+ * @brief Convert a tensor between FLOAT32 and BFLOAT16 (either direction)
+ * 
+ * @param src Source tensor
+ * @param dst Destination tensor with the same number of elements
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_bf16_convert(tensor_t* src, tensor_t* dst);
+
+/**
+ * @brief Matrix product C = A x B with FP32 accumulation
+ * 
+ * A is M x K, B is K x N and C is M x N, all row-major. A and B may each
+ * be BFLOAT16 or FLOAT32, C is FLOAT32 or BFLOAT16 (rounded on store).
+ * 
+ * @param a Left operand
+ * @param b Right operand
+ * @param c Output
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_bf16_gemm(tensor_t* a, tensor_t* b, tensor_t* c);
+
+/**
+ * @brief Elementwise operation computed in FP32
+ * 
+ * Operands may each be BFLOAT16 or FLOAT32 and must have the same
+ * number of elements.
+ * 
+ * @param op Operation
+ * @param a First operand
+ * @param b Second operand
+ * @param c Output, FLOAT32 or BFLOAT16 (rounded on store)
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_bf16_elementwise(bf16_op_t op, tensor_t* a, tensor_t* b, tensor_t* c);
+
+/**
+ * @brief Test BF16 tensors: round to nearest even conversion, FP32 range,
+ * GEMM with FP32 and BF16 output and elementwise operations
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int bf16_test();
+
+#endif
@@ -0,0 +1,144 @@
+/*
+ * detect.h - This file defines the object detection post-processing
+ * kernels: best class per anchor, score threshold with stream
+ * compaction, top-k selection and class-aware non-maximum suppression.
+ * Candidates are carried as INT32 index tensors into the anchor tensors,
+ * so boxes and scores are never copied.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_AI_DETECT_H_
+#define __SYNAPSE_AI_DETECT_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/memory/ai_memory/ai_memory.h>
+
+// Box coordinates, in the order of the last dimension of a box tensor
+typedef enum
+{
+  DETECT_BOX_X1 = 0,
+  DETECT_BOX_Y1,
+  DETECT_BOX_X2,
+  DETECT_BOX_Y2,
+  DETECT_BOX_COORDS // Values per box
+} detect_box_coord_t;
+
+/**
+ * @brief Keep the best class of every anchor
+ * 
+ * @param class_scores FLOAT32 scores, N x C
+ * @param scores FLOAT32 output, N elements
+ * @param classes INT32 output, N elements
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_best_class(tensor_t* class_scores, tensor_t* scores, tensor_t* classes);
+
+/**
+ * @brief Compact the indices of the anchors scoring above a threshold
+ * 
+ * Blocks of anchors without a survivor are skipped four at a time, the
+ * survivors keep their anchor order.
+ * 
+ * @param scores FLOAT32 scores, N elements
+ * @param threshold Lowest score kept (exclusive)
+ * @param indices INT32 output of at least N elements
+ * @param count Output for the number of survivors
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_threshold(tensor_t* scores, float threshold, tensor_t* indices, size_t* count);
+
+/**
+ * @brief Move the k best candidates to the front, by decreasing score
+ * 
+ * A min-heap of k candidates is kept while scanning, O(n log k). The
+ * order of the other candidates is not kept.
+ * 
+ * @param scores FLOAT32 scores, N elements
+ * @param indices INT32 candidate indices into scores, sorted in place
+ * @param count Number of candidates
+ * @param k Candidates to keep
+ * @param out_count Output for min(k, count)
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_top_k(tensor_t* scores, tensor_t* indices, size_t count, size_t k, size_t* out_count);
+
+/**
+ * @brief Non-maximum suppression over candidates sorted by decreasing
+ * score, kept candidates are moved to the front
+ * 
+ * Each candidate is compared with the kept boxes four at a time, a row
+ * of the IoU matrix, and stops at the first overlap. Boxes of different
+ * classes never suppress each other.
+ * 
+ * @param boxes FLOAT32 boxes, N x DETECT_BOX_COORDS (x1, y1, x2, y2)
+ * @param classes INT32 class per anchor, N elements, NULL to ignore classes
+ * @param indices INT32 candidate indices into boxes, compacted in place
+ * @param count Number of candidates
+ * @param iou_threshold Overlap above which the weaker box is suppressed
+ * @param max_out Most boxes kept
+ * @param out_count Output for the number of boxes kept
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_nms(tensor_t* boxes, tensor_t* classes, tensor_t* indices, size_t count, float iou_threshold,
+                  size_t max_out, size_t* out_count);
+
+/**
+ * @brief Threshold, top-k and NMS in one call
+ * 
+ * @param boxes FLOAT32 boxes, N x DETECT_BOX_COORDS
+ * @param scores FLOAT32 scores, N elements
+ * @param classes INT32 class per anchor, NULL to ignore classes
+ * @param score_threshold Lowest score kept (exclusive)
+ * @param k Candidates passed to NMS
+ * @param iou_threshold NMS overlap threshold
+ * @param max_out Most detections
+ * @param indices INT32 output of at least N elements, detections first
+ * @param out_count Output for the number of detections
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_postprocess(tensor_t* boxes, tensor_t* scores, tensor_t* classes, float score_threshold, size_t k,
+                          float iou_threshold, size_t max_out, tensor_t* indices, size_t* out_count);
+
+/**
+ * @brief Time every step on 10k synthetic anchors against a scalar full
+ * sort and all-pairs NMS
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_detect_benchmark();
+
+/**
+ * @brief Test detection post-processing: threshold compaction, top-k
+ * order and class-aware NMS
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int detect_test();
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * int4.h - This file defines the packed 4-bit weight operations.
+ * Weights are stored as two INT4 / UINT4 values per byte with one
+ * scale per group and widened in registers by the GEMV / GEMM kernels.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_AI_INT4_H_
+#define __SYNAPSE_AI_INT4_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/memory/ai_memory/ai_memory.h>
+
+/**
+ * @brief Quantise a FLOAT32 tensor into a packed tensor of the same shape,
+ * INT4 groups are symmetric, UINT4 groups get a zero point
+ * 
+ * @param src FLOAT32 tensor
+ * @param dst Packed tensor from ai_tensor_create_packed
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_int4_pack(tensor_t* src, tensor_t* dst);
+
+/**
+ * @brief Dequantise a packed tensor into a FLOAT32 tensor of the same shape
+ * 
+ * @param src Packed tensor
+ * @param dst FLOAT32 tensor
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_int4_unpack(tensor_t* src, tensor_t* dst);
+
+/**
+ * @brief Matrix-vector product with packed weights, y = W x
+ * 
+ * @param w Packed N x K weights
+ * @param x FLOAT32 input of K elements
+ * @param y FLOAT32 output of N elements
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_int4_gemv(tensor_t* w, tensor_t* x, tensor_t* y);
+
+/**
+ * @brief Matrix product with packed weights, Y = X W^T (linear layer)
+ * 
+ * @param x FLOAT32 M x K activations
+ * @param w Packed N x K weights
+ * @param y FLOAT32 M x N output
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_int4_gemm(tensor_t* x, tensor_t* w, tensor_t* y);
+
+/**
+ * @brief Test packed INT4 / UINT4 weights: quantisation error, GEMV
+ * against the dequantised weights and GEMV cycles against FLOAT32
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int int4_test();
+
+#endif
@@ -0,0 +1,260 @@
+/*
+ * pipeline.h - This file defines the sensor frame pipeline. A fixed
+ * pool of frame tensors circulates through stages (capture, preprocess,
+ * infer, post-process...) linked by lock-free single-producer /
+ * single-consumer rings, so every stage works on a different frame.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_AI_PIPELINE_H_
+#define __SYNAPSE_AI_PIPELINE_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/memory/ai_memory/ai_memory.h>
+
+// Most stages in a pipeline, the first is the source and the last the sink
+#define PIPELINE_MAX_STAGES 8
+
+// Entries of the ring between two stages (power of 2)
+#define PIPELINE_QUEUE_SIZE 4
+
+// Frames in flight per stage link (triple buffering)
+#define PIPELINE_BUFFERS_PER_LINK 3
+
+// Largest frame pool
+#define PIPELINE_MAX_FRAMES (PIPELINE_BUFFERS_PER_LINK * PIPELINE_MAX_STAGES)
+
+// Stage polled by any CPU
+#define PIPELINE_CPU_ANY 0xFFFFFFFF
+
+// What a stage does when its output ring is full
+typedef enum
+{
+  PIPELINE_POLICY_BLOCK,      // Wait for the next stage, stalls propagate to the source
+  PIPELINE_POLICY_DROP_OLDEST // Recycle the oldest queued frame, the source never waits
+} pipeline_policy_t;
+
+// Frame of the pool
+typedef struct pipeline_frame
+{
+  tensor_t* tensor;   // Frame data
+  uint32_t index;     // Position in the pool
+  uint64_t sequence;  // Capture number
+  uint64_t timestamp; // Counter when the source got the frame
+} pipeline_frame_t;
+
+// Lock-free single producer / single consumer ring of frames
+typedef struct pipeline_queue
+{
+  volatile uint32_t head; // Next entry to consume, the producer moves it to drop the oldest entry
+  volatile uint32_t tail; // Next entry to fill, only written by the producer
+  pipeline_frame_t* entries[PIPELINE_QUEUE_SIZE];
+} pipeline_queue_t;
+
+// Stage callback, a negative return drops the frame
+typedef int (*PIPELINE_STAGE_FN)(pipeline_frame_t* frame, void* private_data);
+
+typedef struct pipeline_stage_config
+{
+  const char* name;
+  PIPELINE_STAGE_FN fn;
+  void* private_data;
+  pipeline_policy_t policy; // When the output ring is full
+  uint32_t cpu;             // CPU polling the stage, or PIPELINE_CPU_ANY
+} pipeline_stage_config_t;
+
+// Stage counters, in generic timer ticks
+typedef struct pipeline_stage_stats
+{
+  uint64_t frames;     // Frames processed
+  uint64_t drops;      // Frames recycled from the output ring
+  uint64_t stalls;     // Polls without a free frame or output entry
+  uint64_t errors;     // Frames dropped by the callback
+  uint64_t busy_ticks; // Time spent in the callback
+  uint64_t max_ticks;  // Slowest frame
+} pipeline_stage_stats_t;
+
+typedef struct pipeline_stage
+{
+  pipeline_stage_config_t config;
+  pipeline_queue_t out; // Ring to the next stage, unused by the sink
+  pipeline_stage_stats_t stats;
+} pipeline_stage_t;
+
+// End to end counters, in generic timer ticks
+typedef struct pipeline_stats
+{
+  uint64_t captured;      // Frames the source filled
+  uint64_t completed;     // Frames the sink finished
+  uint64_t dropped;       // Frames recycled or failed on the way
+  uint64_t avg_latency;   // Source to sink, per completed frame
+  uint64_t max_latency;
+  uint64_t slowest_stage; // Mean callback time of the slowest stage
+  uint32_t frames_per_sec;
+} pipeline_stats_t;
+
+typedef struct pipeline
+{
+  pipeline_stage_t stages[PIPELINE_MAX_STAGES];
+  size_t stage_count;
+  pipeline_frame_t frames[PIPELINE_MAX_FRAMES];
+  uint32_t frame_count;
+  uint32_t free_next[PIPELINE_MAX_FRAMES]; // Free list links
+  volatile uint64_t free_head;             // ABA tag << 32 | (index + 1), 0 when empty
+  volatile uint32_t free_count;
+  uint64_t capture_limit;  // The source stops at this sequence
+  uint64_t next_sequence;  // Written by the source only
+  uint64_t completed;      // Written by the sink only
+  uint64_t latency_ticks;
+  uint64_t max_latency_ticks;
+  uint64_t first_capture;  // Counter of the first capture
+  uint64_t last_complete;  // Counter of the last completion
+} pipeline_t;
+
+/**
+ * @brief Create a pipeline and its frame pool
+ * 
+ * The pool holds PIPELINE_BUFFERS_PER_LINK frames per stage link, plus
+ * the one the sink works on. The first stage is the source: it fills
+ * frames taken from the pool. The last one is the sink: its frames go
+ * back to the pool.
+ * 
+ * @param stages Stage configurations, copied (2 to PIPELINE_MAX_STAGES)
+ * @param stage_count Number of stages
+ * @param shape Frame tensor shape
+ * @param ndim Number of dimensions
+ * @param dtype Frame tensor type
+ * @param out_pipeline Output for the pipeline
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_create(pipeline_stage_config_t* stages, size_t stage_count, size_t* shape, size_t ndim,
+                    tensor_dtype_t dtype, pipeline_t** out_pipeline);
+
+/**
+ * @brief Destroy a pipeline and its frame pool
+ * 
+ * @param pipeline Pipeline
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void pipeline_destroy(pipeline_t* pipeline);
+
+/**
+ * @brief Let the source capture more frames
+ * 
+ * @param pipeline Pipeline
+ * @param frames Frames to capture
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void pipeline_start(pipeline_t* pipeline, uint64_t frames);
+
+/**
+ * @brief Run one step of every stage pinned to a CPU
+ * 
+ * Stages are polled from the sink back to the source, a frame moves one
+ * stage per poll. With one CPU per stage a step lasts as long as the
+ * slowest stage.
+ * 
+ * @param pipeline Pipeline
+ * @param cpu CPU polling, PIPELINE_CPU_ANY polls every stage
+ * @return int Number of stages that processed a frame
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_poll(pipeline_t* pipeline, uint32_t cpu);
+
+/**
+ * @brief Check if every allowed frame was captured and left the pipeline
+ * 
+ * @param pipeline Pipeline
+ * @return bool true once the pool is full again
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool pipeline_idle(pipeline_t* pipeline);
+
+/**
+ * @brief Capture frames and poll every stage on this CPU until they
+ * have all left the pipeline
+ * 
+ * @param pipeline Pipeline
+ * @param frames Frames to capture
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_run(pipeline_t* pipeline, uint64_t frames);
+
+/**
+ * @brief Get the end to end statistics of a pipeline
+ * 
+ * @param pipeline Pipeline
+ * @param stats Output for the statistics
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void pipeline_get_stats(pipeline_t* pipeline, pipeline_stats_t* stats);
+
+/**
+ * @brief Synthetic camera for testing, fills an INT8 frame with a
+ * pattern derived from its sequence number
+ * 
+ * @param frame Frame
+ * @param private_data Unused
+ * @return int EOK
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_synthetic_source(pipeline_frame_t* frame, void* private_data);
+
+/**
+ * @brief Check a frame filled by pipeline_synthetic_source()
+ * 
+ * @param frame Frame
+ * @param offset Value added to every byte by the stages
+ * @return bool true if the pattern matches
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool pipeline_synthetic_check(pipeline_frame_t* frame, int8_t offset);
+
+/**
+ * @brief Run a capture / preprocess / infer / post-process pipeline on
+ * synthetic frames and report latency and throughput per stage
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_benchmark();
+
+/**
+ * @brief Test the frame pipeline: in order delivery with back-pressure,
+ * drop-oldest on a slow sink pinned to another CPU and pool accounting
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int pipeline_test();
+
+#endif
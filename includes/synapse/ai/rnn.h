@@ -0,0 +1,182 @@
+/*
+ * rnn.h - This file defines the recurrent cells. LSTM and GRU cells
+ * run one time step per call: gate GEMV, activations and state update
+ * in one pass over prepacked weights, with no tensor created per step.
+ * Hidden state persists across calls in a table of states bound to a
+ * stream id, one per sensor or control loop.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_AI_RNN_H_
+#define __SYNAPSE_AI_RNN_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/memory/ai_memory/ai_memory.h>
+
+// Most streams with a live state
+#define AI_RNN_MAX_STATES 16
+// Output rows computed together, one NEON register of accumulators
+#define AI_RNN_TILE_ROWS 4
+
+// Cell types, weights follow the PyTorch layouts
+typedef enum
+{
+  AI_RNN_LSTM, // Gates i, f, g, o
+  AI_RNN_GRU   // Gates r, z, n
+} ai_rnn_type_t;
+
+// Weights prepacked for the GEMV: tiles of AI_RNN_TILE_ROWS rows stored
+// column by column, so every input element feeds a whole tile
+typedef struct
+{
+  tensor_t* weights; // FLOAT32 or INT8, tiles x (cols * AI_RNN_TILE_ROWS)
+  tensor_t* scales;  // FLOAT32 scale per row, INT8 weights only
+  size_t rows;
+  size_t cols;
+} ai_rnn_matrix_t;
+
+typedef struct
+{
+  ai_rnn_type_t type;
+  tensor_dtype_t dtype; // TENSOR_TYPE_FLOAT32 or TENSOR_TYPE_INT8 weights
+  size_t input_size;
+  size_t hidden_size;
+  ai_rnn_matrix_t gates;       // LSTM: i, f, o, g on [x; h], GRU: r, z on [x; h]
+  ai_rnn_matrix_t candidate_x; // GRU: n on x
+  ai_rnn_matrix_t candidate_h; // GRU: n on h, kept apart because r gates it
+  tensor_t* bias;     // FLOAT32, input and hidden biases merged where they add
+  tensor_t* xh;       // FLOAT32 [x; h] of the current step
+  tensor_t* xh_q;     // INT8 [x; h], INT8 weights only
+  tensor_t* preact;   // FLOAT32 gate pre-activations
+} ai_rnn_cell_t;
+
+// Hidden state of one stream
+typedef struct
+{
+  bool in_use;
+  uint32_t stream_id;
+  ai_rnn_type_t type;
+  size_t hidden_size;
+  tensor_t* hidden; // FLOAT32 h
+  tensor_t* cell;   // FLOAT32 c, LSTM only
+  uint64_t steps;   // Steps since the last reset
+} ai_rnn_state_t;
+
+/**
+ * @brief Create a cell and prepack its weights
+ * 
+ * @param type Cell type
+ * @param dtype TENSOR_TYPE_FLOAT32, or TENSOR_TYPE_INT8 to quantize the
+ * weights per row
+ * @param w_ih FLOAT32 input weights, G*H x I (G = 4 for LSTM, 3 for GRU)
+ * @param w_hh FLOAT32 hidden weights, G*H x H
+ * @param b_ih FLOAT32 input bias, G*H elements, may be NULL
+ * @param b_hh FLOAT32 hidden bias, G*H elements, may be NULL
+ * @param out_cell Output for the cell
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_cell_create(ai_rnn_type_t type, tensor_dtype_t dtype, tensor_t* w_ih, tensor_t* w_hh, tensor_t* b_ih,
+                       tensor_t* b_hh, ai_rnn_cell_t** out_cell);
+
+/**
+ * @brief Destroy a cell
+ * 
+ * @param cell Cell
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void ai_rnn_cell_destroy(ai_rnn_cell_t* cell);
+
+/**
+ * @brief Get the state of a stream, creating a zeroed one on first use
+ * 
+ * @param stream_id Stream id chosen by the caller
+ * @param cell Cell the state is used with
+ * @param out_state Output for the state
+ * @return int EOK on success, -EINVAL if the stream is bound to another
+ * cell shape, -ENOMEM if every state is in use
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_state_bind(uint32_t stream_id, ai_rnn_cell_t* cell, ai_rnn_state_t** out_state);
+
+/**
+ * @brief Find the state of a stream
+ * 
+ * @param stream_id Stream id
+ * @return ai_rnn_state_t* State, NULL if the stream has none
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+ai_rnn_state_t* ai_rnn_state_find(uint32_t stream_id);
+
+/**
+ * @brief Zero the state of a stream, at the start of a new sequence
+ * 
+ * @param stream_id Stream id
+ * @return int EOK on success, -ENOENT if the stream has no state
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_state_reset(uint32_t stream_id);
+
+/**
+ * @brief Free the state of a stream
+ * 
+ * @param stream_id Stream id
+ * @return int EOK on success, -ENOENT if the stream has no state
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_state_release(uint32_t stream_id);
+
+/**
+ * @brief Run one time step and update the state in place
+ * 
+ * @param cell Cell
+ * @param state State bound with the cell
+ * @param x FLOAT32 input, I elements
+ * @param y FLOAT32 output for the new h, may be NULL
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_cell_step(ai_rnn_cell_t* cell, ai_rnn_state_t* state, tensor_t* x, tensor_t* y);
+
+/**
+ * @brief Time a step of IMU sized LSTM and GRU cells, FP32 and INT8,
+ * against an unpacked row-major step
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_rnn_benchmark();
+
+/**
+ * @brief Test the recurrent cells: LSTM and GRU steps, FP32 and INT8,
+ * and states bound to streams
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rnn_test();
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * sparse.h - This file defines the sparse tensor operations.
+ * Pruned weights are stored as CSR or block sparse (BSR) tensors
+ * and multiplied with dense activations.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_AI_SPARSE_H_
+#define __SYNAPSE_AI_SPARSE_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/memory/ai_memory/ai_memory.h>
+
+/**
+ * @brief Convert a dense 2D row-major tensor to a sparse tensor, elements
+ * (or whole blocks) equal to zero are not stored
+ * 
+ * @param dense Dense tensor to convert
+ * @param format TENSOR_FORMAT_CSR or TENSOR_FORMAT_BSR
+ * @param block_rows Rows per block (BSR only, 1 or 4 use the fast kernels)
+ * @param block_cols Columns per block (BSR only, 4 uses the fast kernels)
+ * @return tensor_t* Sparse tensor, or NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+tensor_t* ai_sparse_from_dense(tensor_t* dense, tensor_format_t format, size_t block_rows, size_t block_cols);
+
+/**
+ * @brief Expand a sparse tensor into a dense 2D row-major tensor
+ * 
+ * @param sparse Sparse tensor
+ * @param dense Dense tensor of the same shape and type
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_sparse_to_dense(tensor_t* sparse, tensor_t* dense);
+
+/**
+ * @brief Multiply sparse weights with dense activations, C = A x B
+ * 
+ * A is a sparse M x K tensor, B a dense K x N tensor and C a dense M x N
+ * tensor, all row-major. FLOAT32 x FLOAT32 gives FLOAT32, INT8 x INT8
+ * gives INT32.
+ * 
+ * @param a Sparse weights
+ * @param b Dense activations
+ * @param c Dense output
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_sparse_matmul(tensor_t* a, tensor_t* b, tensor_t* c);
+
+/**
+ * @brief Get the number of stored elements of a sparse tensor, zeros
+ * inside stored blocks included
+ * 
+ * @param sparse Sparse tensor
+ * @return size_t Number of stored elements
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t ai_sparse_get_stored_elements(tensor_t* sparse);
+
+/**
+ * @brief Test sparse tensor conversion and sparse-dense matmul against
+ * a dense reference for every sparse format
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int sparse_test();
+
+#endif
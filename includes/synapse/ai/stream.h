@@ -0,0 +1,206 @@
+/*
+ * stream.h - This file defines the streaming weight loader.
+ * Models larger than the AI pool keep their weights on block storage
+ * or in a model image, layer N + 1 is fetched into a ring of weight
+ * buffers while layer N computes.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_AI_STREAM_H_
+#define __SYNAPSE_AI_STREAM_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/virtio/virtio_blk.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+
+// Largest ring of weight buffers
+#define AI_STREAM_MAX_SLOTS 8
+
+// Where the weights live
+typedef enum
+{
+  AI_STREAM_SOURCE_MEMORY, // Model image in memory, copied into the ring
+  AI_STREAM_SOURCE_BLOCK   // virtio block device, read asynchronously
+} ai_stream_source_type_t;
+
+typedef struct
+{
+  ai_stream_source_type_t type;
+  const uint8_t* image; // Model image (memory source)
+  uint64_t base_sector; // First sector of the model (block source)
+} ai_stream_source_t;
+
+// Weights of one layer, offset relative to the start of the model
+typedef struct
+{
+  uint64_t offset; // Sector aligned for a block source
+  size_t size;
+} ai_stream_layer_t;
+
+// State of a weight buffer
+typedef enum
+{
+  AI_STREAM_SLOT_FREE,
+  AI_STREAM_SLOT_LOADING, // Read in flight
+  AI_STREAM_SLOT_READY,   // Loaded, not acquired yet
+  AI_STREAM_SLOT_IN_USE   // Acquired by the compute
+} ai_stream_slot_state_t;
+
+typedef struct
+{
+  tensor_t* buffer; // INT8 tensor from the AI pool
+  size_t layer;     // Layer held by the buffer
+  ai_stream_slot_state_t state;
+  virtio_blk_request_t req;
+  uint64_t io_start;          // Counter when the read was issued
+  volatile uint64_t io_end;   // Counter when the read completed
+  uint64_t compute_start;     // Counter when the layer was acquired
+} ai_stream_slot_t;
+
+// Overlap statistics, in generic timer ticks
+typedef struct
+{
+  uint64_t layers;        // Layers acquired
+  uint64_t loads;         // Layers fetched from the source
+  uint64_t bytes;         // Bytes fetched
+  uint64_t io_ticks;      // Time reads were in flight
+  uint64_t stall_ticks;   // Time acquire waited for a read
+  uint64_t compute_ticks; // Time layers were held by the compute
+} ai_stream_stats_t;
+
+typedef struct
+{
+  ai_stream_source_t source;
+  ai_stream_layer_t* layers;
+  size_t layer_count;
+  size_t slot_size; // Bytes per weight buffer
+  size_t slot_count;
+  ai_stream_slot_t slots[AI_STREAM_MAX_SLOTS];
+  size_t next_fetch; // Next layer to prefetch, wraps for the next pass
+  ai_stream_stats_t stats;
+} ai_weight_stream_t;
+
+// Compute callback of ai_stream_run()
+typedef int (*AI_STREAM_LAYER_FN)(size_t layer, void* weights, size_t size, void* private_data);
+
+/**
+ * @brief Create a weight stream
+ * 
+ * The ring takes slot_count buffers of the largest layer from the AI
+ * pool, more buffers prefetch further ahead. With as many buffers as
+ * layers the whole model stays resident after the first pass.
+ * 
+ * @param source Where the weights live
+ * @param layers Layer table, copied
+ * @param layer_count Number of layers
+ * @param slot_count Weight buffers in the ring (1 to AI_STREAM_MAX_SLOTS)
+ * @param out_stream Output for the stream
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_stream_create(ai_stream_source_t* source, ai_stream_layer_t* layers, size_t layer_count,
+                     size_t slot_count, ai_weight_stream_t** out_stream);
+
+/**
+ * @brief Destroy a weight stream, waiting for reads in flight
+ * 
+ * @param stream Stream
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void ai_stream_destroy(ai_weight_stream_t* stream);
+
+/**
+ * @brief Get the weights of a layer, waiting for them if needed, and
+ * start fetching the following layers into the free buffers
+ * 
+ * @param stream Stream
+ * @param layer Layer index
+ * @param weights Output for the weights
+ * @param size Output for the size of the weights, may be NULL
+ * @return int EOK on success, -EINUSE if every buffer is acquired,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_stream_acquire(ai_weight_stream_t* stream, size_t layer, void** weights, size_t* size);
+
+/**
+ * @brief Give back the buffer of a layer once its compute is done
+ * 
+ * @param stream Stream
+ * @param layer Layer index
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_stream_release(ai_weight_stream_t* stream, size_t layer);
+
+/**
+ * @brief Run every layer in order, one acquire / compute / release each
+ * 
+ * @param stream Stream
+ * @param fn Compute callback
+ * @param private_data Data passed to the callback
+ * @return int EOK on success, first error otherwise
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_stream_run(ai_weight_stream_t* stream, AI_STREAM_LAYER_FN fn, void* private_data);
+
+/**
+ * @brief Get the statistics of a stream
+ * 
+ * @param stream Stream
+ * @param stats Output for the statistics
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void ai_stream_get_stats(ai_weight_stream_t* stream, ai_stream_stats_t* stats);
+
+/**
+ * @brief Get the share of read time hidden behind compute
+ * 
+ * @param stream Stream
+ * @return uint32_t Overlap efficiency in percent
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t ai_stream_get_overlap(ai_weight_stream_t* stream);
+
+/**
+ * @brief Stream layers from the block device with rings of 1 to 3
+ * buffers and report the compute / IO overlap
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int ai_stream_benchmark();
+
+/**
+ * @brief Test the streaming weight loader: layers larger than the ring
+ * stream in order, out of order acquires and buffer exhaustion
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int stream_test();
+
+#endif
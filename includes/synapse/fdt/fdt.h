@@ -0,0 +1,290 @@
+/*
+ * fdt.h - This file defines the flattened device tree parser. The blob
+ * handed over by the loader is parsed once at boot into a platform
+ * description (memory, interrupt controller, UART, timer, PSCI, virtio
+ * slots, initrd) that falls back to the QEMU virt layout.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_FDT_H_
+#define __SYNAPSE_FDT_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#define FDT_MAGIC 0xD00DFEED
+
+// Oldest blob version the reader understands
+#define FDT_MIN_VERSION 16
+
+// Structure block tokens
+#define FDT_BEGIN_NODE 0x1
+#define FDT_END_NODE   0x2
+#define FDT_PROP       0x3
+#define FDT_NOP        0x4
+#define FDT_END        0x9
+
+// Limits of the platform description
+#define FDT_MAX_MEMORY_BANKS 8
+#define FDT_MAX_RESERVED     16
+#define FDT_MAX_VIRTIO_SLOTS 32
+#define FDT_MAX_DEPTH        8
+#define FDT_MAX_CPUS         8 // GICv2 CPU interfaces
+
+// QEMU virt layout, used when the loader passes no device tree
+#define FDT_DEFAULT_RAM_BASE  0x40000000
+#define FDT_DEFAULT_RAM_SIZE  0x40000000
+#define FDT_DEFAULT_GICD_BASE 0x08000000
+#define FDT_DEFAULT_GICC_BASE 0x08010000
+#define FDT_DEFAULT_UART_BASE 0x09000000
+#define FDT_DEFAULT_UART_IRQ  33
+#define FDT_DEFAULT_VIRTIO_BASE   0x0A000000
+#define FDT_DEFAULT_VIRTIO_STRIDE 0x200
+#define FDT_DEFAULT_VIRTIO_IRQ    48
+
+// Physical address range
+typedef struct
+{
+  uint64_t base;
+  uint64_t size;
+} fdt_range_t;
+
+// How PSCI calls reach the firmware
+typedef enum
+{
+  FDT_PSCI_NONE = 0,
+  FDT_PSCI_SMC,
+  FDT_PSCI_HVC
+} fdt_psci_method_t;
+
+// Generic timer interrupts, in the order of the timer node
+typedef enum
+{
+  FDT_TIMER_SECURE_PHYS = 0,
+  FDT_TIMER_PHYS,
+  FDT_TIMER_VIRT,
+  FDT_TIMER_HYP,
+  FDT_TIMER_IRQ_COUNT
+} fdt_timer_irq_t;
+
+// virtio-mmio transport slot
+typedef struct
+{
+  uint64_t base;
+  uint32_t irq; // GIC interrupt ID
+} fdt_virtio_slot_t;
+
+// Platform description, interrupts are GIC interrupt IDs
+typedef struct
+{
+  fdt_range_t memory[FDT_MAX_MEMORY_BANKS];
+  uint32_t memory_count;
+  fdt_range_t reserved[FDT_MAX_RESERVED]; // Memory reservation block and /reserved-memory
+  uint32_t reserved_count;
+  uint64_t gicd_base; // GICv2 distributor
+  uint64_t gicc_base; // GICv2 CPU interface
+  uint64_t uart_base; // PL011
+  uint32_t uart_irq;
+  uint32_t timer_irqs[FDT_TIMER_IRQ_COUNT];
+  fdt_psci_method_t psci_method;
+  fdt_virtio_slot_t virtio[FDT_MAX_VIRTIO_SLOTS]; // Sorted by address
+  uint32_t virtio_count;
+  uint64_t initrd_start; // 0 if there is no initrd
+  uint64_t initrd_end;
+  uint32_t cpu_count;
+  uint64_t cpu_mpidr[FDT_MAX_CPUS]; // MPIDR affinity of each CPU node, in tree order
+  bool from_device_tree; // false when the QEMU virt defaults are used
+} fdt_platform_t;
+
+// Blob header, all fields are big-endian
+struct fdt_header
+{
+  uint32_t magic;
+  uint32_t totalsize;
+  uint32_t off_dt_struct;
+  uint32_t off_dt_strings;
+  uint32_t off_mem_rsvmap;
+  uint32_t version;
+  uint32_t last_comp_version;
+  uint32_t boot_cpuid_phys;
+  uint32_t size_dt_strings;
+  uint32_t size_dt_struct;
+};
+
+/**
+ * @brief Read a big-endian 32-bit value of the blob
+ * 
+ * @param ptr Value address, 4-byte aligned
+ * @return uint32_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint32_t fdt_read_u32(const void* ptr)
+{
+  return __builtin_bswap32(*(const uint32_t*)ptr);
+}
+
+/**
+ * @brief Read a value made of one or two 32-bit cells
+ * 
+ * @param ptr First cell
+ * @param cells Number of cells (1 or 2)
+ * @return uint64_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t fdt_read_cells(const void* ptr, uint32_t cells)
+{
+  const uint32_t* cell = (const uint32_t*)ptr;
+  return cells == 2 ? ((uint64_t)fdt_read_u32(cell) << 32) | fdt_read_u32(cell + 1) : fdt_read_u32(cell);
+}
+
+/**
+ * @brief Check the blob handed over by the loader and parse the platform
+ * description, nothing is allocated
+ * 
+ * @param address Blob address
+ * @return int EOK on success, -EINVARG if there is no blob,
+ * -EINVAL if the blob is not a supported device tree
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fdt_init(uintptr_t address);
+
+/**
+ * @brief Check if a device tree is available
+ * 
+ * @return bool true if fdt_init() succeeded
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool fdt_present();
+
+/**
+ * @brief Get the blob address
+ * 
+ * @return const void* Blob, NULL if there is none
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const void* fdt_get_blob();
+
+/**
+ * @brief Get the blob size
+ * 
+ * @return size_t Size in bytes, 0 if there is no blob
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t fdt_get_size();
+
+/**
+ * @brief Find a node by its full path, a component without a unit
+ * address matches the node whatever its unit address
+ * 
+ * @param path Absolute path (e.g. "/chosen")
+ * @return int Node offset, -ENOENT if there is no such node
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fdt_path_offset(const char* path);
+
+/**
+ * @brief Get a property of a node
+ * 
+ * @param node Node offset
+ * @param name Property name
+ * @param len Output for the value length, may be NULL
+ * @return const void* Value, NULL if the node has no such property
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const void* fdt_get_property(int node, const char* name, uint32_t* len);
+
+/**
+ * @brief Get the first subnode of a node
+ * 
+ * @param node Node offset
+ * @return int Subnode offset, -ENOENT if the node has none
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fdt_first_subnode(int node);
+
+/**
+ * @brief Get the next sibling of a node
+ * 
+ * @param node Node offset
+ * @return int Sibling offset, -ENOENT if the node is the last one
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fdt_next_subnode(int node);
+
+/**
+ * @brief Get the name of a node, with its unit address
+ * 
+ * @param node Node offset
+ * @return const char* Name, NULL if the offset is not a node
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const char* fdt_node_name(int node);
+
+/**
+ * @brief Check if a node lists a string in its compatible property
+ * 
+ * @param node Node offset
+ * @param compatible Compatible string
+ * @return bool true if the node is compatible
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool fdt_node_is_compatible(int node, const char* compatible);
+
+/**
+ * @brief Get the platform description
+ * 
+ * @return const fdt_platform_t* Description from the device tree, or the
+ * QEMU virt defaults if there is none
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const fdt_platform_t* fdt_get_platform();
+
+/**
+ * @brief Print the platform description
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void fdt_print_platform();
+
+/**
+ * @brief Test the platform description: RAM banks, device bases, sorted
+ * virtio slots, node walking and heap reservations
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fdt_test();
+
+#endif
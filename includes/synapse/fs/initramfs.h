@@ -0,0 +1,259 @@
+/*
+ * initramfs.h - This file defines the read-only RAM filesystem built
+ * from the cpio archive handed over by the loader. Files are served
+ * straight from the archive, nothing is copied at mount time.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_FS_INITRAMFS_H_
+#define __SYNAPSE_FS_INITRAMFS_H_
+
+#include <kernel/config.h>
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+// cpio "newc" format, the "crc" variant carries a checksum of each file
+#define CPIO_NEWC_MAGIC "070701"
+#define CPIO_CRC_MAGIC "070702"
+#define CPIO_NEWC_HEADER_SIZE 110
+#define CPIO_TRAILER "TRAILER!!!"
+
+// File type bits of the mode
+#define INITRAMFS_MODE_TYPE_MASK 0170000
+#define INITRAMFS_MODE_DIR       0040000
+#define INITRAMFS_MODE_FILE      0100000
+#define INITRAMFS_MODE_SYMLINK   0120000
+
+// Path lookup hash buckets (power of 2)
+#define INITRAMFS_HASH_BUCKETS 64
+
+// Open files per filesystem
+#define INITRAMFS_MAX_OPEN_FILES 32
+
+// Longest path accepted by the lookup
+#define INITRAMFS_MAX_PATH 256
+
+// Owner of the files opened by the kernel itself
+#define INITRAMFS_OWNER_KERNEL ((pid_t)SYNAPSE_MAX_PROCESSES)
+
+// File of the archive
+typedef struct initramfs_inode
+{
+  const char* path; // Path inside the archive, without a leading "/"
+  uint32_t path_len;
+  uint32_t hash; // Hash of the path
+  uint32_t mode; // Type and permissions
+  const uint8_t* data; // Contents, inside the archive
+  size_t size;
+  void* copy; // Page aligned copy for mmap() of unaligned contents
+  uint32_t map_count; // Open files mapping the contents
+  bool has_check; // Entry of a "crc" archive
+  uint32_t check; // Sum of the bytes of the contents, modulo 2^32
+  int next; // Next inode of the hash bucket, -1 at the end
+} initramfs_inode_t;
+
+// Open file
+typedef struct initramfs_file
+{
+  bool used;
+  pid_t owner; // Process, or INITRAMFS_OWNER_KERNEL
+  int inode;
+  size_t offset; // Read position
+  bool mapped; // mmap() was called on the file
+} initramfs_file_t;
+
+// File information
+typedef struct initramfs_stat
+{
+  uint32_t ino; // Inode number
+  uint32_t mode; // Type and permissions
+  size_t size; // Size in bytes
+  bool zero_copy; // Contents are page aligned, mmap() returns the archive
+} initramfs_stat_t;
+
+typedef struct initramfs
+{
+  const uint8_t* archive;
+  size_t archive_size;
+  initramfs_inode_t* inodes;
+  size_t inode_count;
+  int buckets[INITRAMFS_HASH_BUCKETS]; // First inode of each bucket, -1 if empty
+  initramfs_file_t files[INITRAMFS_MAX_OPEN_FILES];
+} initramfs_t;
+
+/**
+ * @brief Mount the archive passed with -initrd as the root filesystem,
+ * its location comes from the /chosen node of the device tree
+ * 
+ * @return int EOK on success, -ENOENT if there is no archive,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_init();
+
+/**
+ * @brief Get the root filesystem
+ * 
+ * @return initramfs_t* Root filesystem, NULL if none is mounted
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+initramfs_t* initramfs_get_root();
+
+/**
+ * @brief Index a cpio archive, the archive must stay in memory until the
+ * filesystem is unmounted
+ * 
+ * @param fs Filesystem
+ * @param archive cpio "newc" archive
+ * @param size Archive size in bytes
+ * @return int EOK on success, -EINVAL if the archive is malformed,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_mount(initramfs_t* fs, const void* archive, size_t size);
+
+/**
+ * @brief Drop the index of a filesystem
+ * 
+ * @param fs Filesystem
+ * @return int EOK on success, -EINUSE while files are open
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_unmount(initramfs_t* fs);
+
+/**
+ * @brief Check the contents of every file of a "crc" archive against the
+ * checksum of its header, before a model image is trusted
+ * 
+ * @param fs Filesystem
+ * @return int Files checked, -EIO if one does not match, -EINVARG on a
+ * bad filesystem
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_verify(initramfs_t* fs);
+
+/**
+ * @brief Find a file, for kernel users that read it in place
+ * 
+ * @param fs Filesystem
+ * @param path Path, with or without a leading "/"
+ * @param data Output for the contents, inside the archive
+ * @param size Output for the size, may be NULL
+ * @return int EOK on success, -ENOENT if there is no such file
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_lookup(initramfs_t* fs, const char* path, const void** data, size_t* size);
+
+/**
+ * @brief Get the information of a file
+ * 
+ * @param fs Filesystem
+ * @param path Path
+ * @param stat Output for the information
+ * @return int EOK on success, -ENOENT if there is no such file
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_stat(initramfs_t* fs, const char* path, initramfs_stat_t* stat);
+
+/**
+ * @brief Open a file for reading
+ * 
+ * @param fs Filesystem
+ * @param owner Process opening the file, or INITRAMFS_OWNER_KERNEL
+ * @param path Path
+ * @return int File descriptor, -ENOENT if there is no such file,
+ * -EPMAX if too many files are open
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_open(initramfs_t* fs, pid_t owner, const char* path);
+
+/**
+ * @brief Read from the current position of a file
+ * 
+ * @param fs Filesystem
+ * @param owner Process owning the file
+ * @param fd File descriptor
+ * @param buffer Destination
+ * @param size Bytes to read
+ * @return int Bytes read, 0 at the end of the file, negative error code
+ * on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_read(initramfs_t* fs, pid_t owner, int fd, void* buffer, size_t size);
+
+/**
+ * @brief Get the contents of a file without copying them
+ * 
+ * Page aligned contents are returned in place. Others are copied once to
+ * a page aligned buffer shared by every mapping of the file. The address
+ * stays valid until the file is closed.
+ * 
+ * @param fs Filesystem
+ * @param owner Process owning the file
+ * @param fd File descriptor
+ * @param addr Output for the contents
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_mmap(initramfs_t* fs, pid_t owner, int fd, const void** addr);
+
+/**
+ * @brief Close a file
+ * 
+ * @param fs Filesystem
+ * @param owner Process owning the file
+ * @param fd File descriptor
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_close(initramfs_t* fs, pid_t owner, int fd);
+
+/**
+ * @brief Close every file of a process
+ * 
+ * @param fs Filesystem
+ * @param owner Process
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void initramfs_close_all(initramfs_t* fs, pid_t owner);
+
+/**
+ * @brief Test the initramfs: archive parsing, hashed lookup, stat, read,
+ * in place and copied mmap, open file accounting and checksums
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int initramfs_test();
+
+#endif
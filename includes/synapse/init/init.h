@@ -0,0 +1,84 @@
+/*
+ * init.h - This file defines parallel boot initialisation. Boot steps are
+ * given as a table of tasks, each naming the earlier tasks it depends on.
+ * Every CPU takes the next task whose dependencies are done until the
+ * table is empty, so independent steps run side by side, and the run
+ * returns once all of them have finished: the barrier before the
+ * scheduler starts.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_INIT_INIT_H_
+#define __SYNAPSE_INIT_INIT_H_
+
+#include <synapse/types.h>
+
+// Tasks of one run, dependencies are a bitmask of task indexes
+#define INIT_MAX_TASKS 32
+
+/* Init task states */
+#define INIT_PENDING 0
+#define INIT_RUNNING 1
+#define INIT_DONE    2
+
+// Function run by an init task, a negative result fails the task
+typedef int (*INIT_FUNCTION)(void* arg);
+
+typedef struct
+{
+  const char* name;
+  INIT_FUNCTION function;
+  void* arg;
+  uint32_t deps; // Bit i set if task i must be done first, i below this task
+  int32_t cpu; // CPU to run on, TASK_CPU_ANY for any
+
+  volatile uint32_t state;
+  int result; // -ENOTREADY if skipped because a dependency failed
+  uint64_t start; // Counter when the task started
+  uint64_t end; // Counter when it returned
+  uint32_t ran_on;
+} init_task_t;
+
+/**
+ * @brief Run a table of init tasks on the first CPUs and wait until every
+ * task is done. A task whose dependency failed is skipped
+ * 
+ * @param tasks Tasks, their state is reset
+ * @param count Number of tasks, up to INIT_MAX_TASKS
+ * @param cpus CPUs to use, 1 to smp_cpu_count()
+ * @return int Number of failed or skipped tasks, -EINVARG on a bad table:
+ * a dependency on the task itself or a later one, or a task pinned to a
+ * CPU not used
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int init_run(init_task_t* tasks, uint32_t count, uint32_t cpus);
+
+/**
+ * @brief Print the time and CPU of each task of a run, and the boot time
+ * saved against running them one after another
+ * 
+ * @param tasks Tasks of a finished run
+ * @param count Number of tasks
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void init_print_report(const init_task_t* tasks, uint32_t count);
+
+/**
+ * @brief Test parallel boot initialisation: dependency order, tasks
+ * pinned to a CPU, skipping after a failure and bad tables
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int init_test();
+
+#endif
@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 28 Mar 2025
- * Last Modified: 28 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_INTERRUPT_H_
@@ -15,8 +15,12 @@
 // ARM GICv2 constants (Generic Interrupt Controller)
 #define GIC_BASE_ADDRESS ((uintptr_t)0x08000000)
 
+// GIC bases, from the device tree (QEMU virt layout until interrupt_init())
+extern uintptr_t gic_distributor_base;
+extern uintptr_t gic_cpu_base;
+
 // GIC Distriibutor registers
-#define GICD_BASE           (GIC_BASE_ADDRESS)
+#define GICD_BASE           (gic_distributor_base)
 #define GICD_CTLR           (*((volatile uint32_t*)(GICD_BASE + 0x000)))
 #define GICD_TYPER          (*((volatile uint32_t*)(GICD_BASE + 0x004)))
 #define GICD_IIDR           (*((volatile uint32_t*)(GICD_BASE + 0x008)))
@@ -25,10 +29,27 @@
 #define GICD_ICENABLER(n)   (*((volatile uint32_t*)(GICD_BASE + 0x180 + ((n) * 4))))
 #define GICD_ISPENDR(n)     (*((volatile uint32_t*)(GICD_BASE + 0x200 + ((n) * 4))))
 #define GICD_ICPENDR(n)     (*((volatile uint32_t*)(GICD_BASE + 0x280 + ((n) * 4))))
+#define GICD_IPRIORITYR(n)  (*((volatile uint8_t*)(GICD_BASE + 0x400 + (n)))) // Byte per interrupt
+#define GICD_ITARGETSR(n)   (*((volatile uint8_t*)(GICD_BASE + 0x800 + (n)))) // Byte per interrupt
 #define GICD_ICFGR(n)       (*((volatile uint32_t*)(GICD_BASE + 0xC00 + ((n) * 4))))
+#define GICD_SGIR           (*((volatile uint32_t*)(GICD_BASE + 0xF00)))
+
+// Software generated interrupts (SGI) take IDs 0-15, the filter of
+// GICD_SGIR sends one to the requesting CPU only
+#define GIC_SGI_COUNT 16
+#define GIC_SGI_TARGET_SELF (2 << 24)
+
+// First shared peripheral interrupt (SPI), lower IDs are banked per CPU
+#define GIC_SPI_BASE 32
+
+// Priority given to enabled shared peripheral interrupts
+#define GIC_SPI_PRIORITY 0xA0
+
+// GICv2 routes a shared peripheral interrupt to a mask of up to 8 CPUs
+#define GIC_MAX_TARGET_CPUS 8
 
 // GIC CPU Interface registers
-#define GICC_BASE           (GIC_BASE_ADDRESS + 0x10000)
+#define GICC_BASE           (gic_cpu_base)
 #define GICC_CTLR           (*((volatile uint32_t*)(GICC_BASE + 0x000)))
 #define GICC_PMR            (*((volatile uint32_t*)(GICC_BASE + 0x004)))
 #define GICC_BPR            (*((volatile uint32_t*)(GICC_BASE + 0x008)))
@@ -72,6 +93,11 @@ struct interrupt_frame
   reg_t sp; // Stack pointer (x31)
   reg_t elr_el1; // Exception Link Register (return address)
   reg_t spsr_el1; // Saved processor state
+
+  // FP/SIMD state, tensor kernels use it in tasks and handlers
+  reg_t fpsr;
+  reg_t fpcr;
+  reg_t fp_regs[64]; // q0-q31, low word first
 };
 
 // Interrupt handler type
@@ -104,7 +130,8 @@ int interrupt_init();
 int interrupt_register_handler(uint32_t interrupt_num, INTERRUPT_HANDLER handler);
 
 /**
- * @brief Unregister an interrupt handler
+ * @brief Unregister an interrupt handler, on return it no longer runs
+ * on any CPU (unless called from the handler itself)
  * 
  * @param interrupt_num Interrupt number to unregister
  * @return int EOK on success, negative error code on failure
@@ -156,6 +183,151 @@ int interrupt_enable_all();
  */
 int interrupt_disable_all();
 
+/**
+ * @brief Mask IRQs on the current CPU and return the previous mask state
+ * 
+ * @return uint64_t Saved DAIF value for interrupt_local_restore()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t interrupt_local_save();
+
+/**
+ * @brief Restore the IRQ mask state saved by interrupt_local_save()
+ * 
+ * @param flags Saved DAIF value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void interrupt_local_restore(uint64_t flags);
+
+/**
+ * @brief Check if IRQs are masked on the current CPU
+ * 
+ * @return true If IRQs are masked
+ * @return false If IRQs are taken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool interrupt_local_masked();
+
+/**
+ * @brief Send a software generated interrupt to the current CPU
+ * 
+ * @param sgi_id SGI ID, below GIC_SGI_COUNT
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int interrupt_send_sgi_self(uint32_t sgi_id);
+
+/**
+ * @brief Get the number of IRQs taken, summed over every CPU
+ * 
+ * @return uint64_t IRQs taken, spurious ones included
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t interrupt_get_irq_count();
+
+/**
+ * @brief Get the number of spurious IRQs, summed over every CPU
+ * 
+ * @return uint64_t IRQs the GIC acknowledged with a special ID
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t interrupt_get_spurious_count();
+
+/**
+ * @brief Get the number of times an interrupt was taken
+ * 
+ * @param interrupt_num Interrupt number
+ * @param cpu CPU index, SMP_MAX_CPUS for the sum over every CPU
+ * @return uint64_t Times taken, 0 on a bad argument
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t interrupt_get_count(uint32_t interrupt_num, uint32_t cpu);
+
+/**
+ * @brief Route a shared peripheral interrupt to a set of CPUs, the
+ * balancer leaves it there afterwards
+ * 
+ * @param interrupt_num Interrupt number, GIC_SPI_BASE or above
+ * @param cpu_mask Bit i set for CPU i, online CPUs only
+ * @return int EOK on success, -EINVARG on a bad argument, -EINUSE if the
+ * interrupt is pinned, -ENOTREADY before interrupt_init()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int interrupt_set_affinity(uint32_t interrupt_num, uint32_t cpu_mask);
+
+/**
+ * @brief Route a shared peripheral interrupt to one CPU for good, for
+ * drivers that wait for it on that CPU. Neither the balancer nor
+ * interrupt_set_affinity() move it afterwards
+ * 
+ * @param interrupt_num Interrupt number, GIC_SPI_BASE or above
+ * @param cpu Online CPU
+ * @return int EOK on success, -EINVARG on a bad argument, -EINUSE if the
+ * interrupt is already pinned, -ENOTREADY before interrupt_init()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int interrupt_pin_affinity(uint32_t interrupt_num, uint32_t cpu);
+
+/**
+ * @brief Get the CPUs a shared peripheral interrupt is routed to
+ * 
+ * @param interrupt_num Interrupt number, GIC_SPI_BASE or above
+ * @return uint32_t Bit i set for CPU i, 0 on a bad argument
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t interrupt_get_affinity(uint32_t interrupt_num);
+
+/**
+ * @brief Spread the device interrupts whose affinity was never set over
+ * the CPUs running no real-time thread, busiest interrupt first
+ * 
+ * @return int Interrupts moved, -ENOTREADY before interrupt_init()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int interrupt_balance();
+
+/**
+ * @brief Print the routing and the per-CPU count of every interrupt taken
+ * or handled
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void interrupt_print_stats();
+
+/**
+ * @brief Time the delivery of a shared peripheral interrupt routed to
+ * each CPU in turn
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int interrupt_affinity_benchmark();
+
 /**
  * @brief Main IRQ handler called from exception vector
  * 
@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 8 Apr 2025
- * Last Modified: 9 Apr 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_INTERRUPTS_SYSCALL_H_
@@ -12,6 +12,7 @@
 #include <synapse/bool.h>
 #include <synapse/types.h>
 
+#include <synapse/fs/initramfs.h>
 #include <synapse/interrupts/interrupt.h>
 
 // System call numbers
@@ -21,7 +22,15 @@
 #define SYSCALL_PROCESS_GET_ARGS  3
 #define SYSCALL_PRINT_CHAR        4
 #define SYSCALL_PRINT_STRING      5
-#define SYSCALL_MAX               6
+#define SYSCALL_MEMORY_PRESSURE_SUBSCRIBE 6
+#define SYSCALL_MEMORY_PRESSURE_POLL      7
+#define SYSCALL_FILE_OPEN         8
+#define SYSCALL_FILE_READ         9
+#define SYSCALL_FILE_STAT         10
+#define SYSCALL_FILE_MMAP         11
+#define SYSCALL_FILE_CLOSE        12
+#define SYSCALL_IRQ_SET_AFFINITY  13
+#define SYSCALL_MAX               14
 
 /**
  * @brief Initialize system call interface
@@ -48,6 +57,17 @@ int syscall_init();
  */
 int syscall_handler(int syscall_num, long arg1, long arg2, long arg3, long arg4);
 
+/**
+ * @brief Get the number of system calls dispatched, summed over every CPU
+ * 
+ * @param syscall_num System call number, or SYSCALL_MAX for all of them
+ * @return uint64_t System calls dispatched
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t syscall_get_count(int syscall_num);
+
 // /**
 //  * @brief C handler for SVC (Supervisor Call) interrupts
 //  * 
@@ -141,4 +161,97 @@ int syscall_print_char(char c);
  */
 int syscall_print_string(const char* str);
 
+/**
+ * @brief Memory pressure subscription system call wrapper
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_memory_pressure_subscribe();
+
+/**
+ * @brief Memory pressure poll system call wrapper
+ * 
+ * @return int Highest pressure level since the last poll (MEMORY_PRESSURE_*),
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_memory_pressure_poll();
+
+/**
+ * @brief Open file system call wrapper
+ * 
+ * @param path Path of the file
+ * @return int File descriptor, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_open(const char* path);
+
+/**
+ * @brief Read file system call wrapper
+ * 
+ * @param fd File descriptor
+ * @param buffer Destination
+ * @param size Bytes to read
+ * @return int Bytes read, 0 at the end of the file, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_read(int fd, void* buffer, size_t size);
+
+/**
+ * @brief File information system call wrapper
+ * 
+ * @param path Path of the file
+ * @param stat Output for the information
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_stat(const char* path, initramfs_stat_t* stat);
+
+/**
+ * @brief Map file system call wrapper, the contents are not copied
+ * 
+ * @param fd File descriptor
+ * @param addr Output for the contents, valid until the file is closed
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_mmap(int fd, const void** addr);
+
+/**
+ * @brief Close file system call wrapper
+ * 
+ * @param fd File descriptor
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_close(int fd);
+
+/**
+ * @brief IRQ affinity system call wrapper
+ * 
+ * @param irq Shared peripheral interrupt number
+ * @param cpu_mask Bit i set for CPU i
+ * @return int EOK on success, -EINUSE if a driver pinned the interrupt,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int syscall_irq_set_affinity(uint32_t irq, uint32_t cpu_mask);
+
 #endif
\ No newline at end of file
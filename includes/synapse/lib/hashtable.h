@@ -0,0 +1,133 @@
+/*
+ * hashtable.h - This file defines the open-addressing hash table mapping
+ * 64-bit keys (pointers, IDs) to pointers. Slots are given by the caller
+ * and the table never allocates. Collisions use Robin Hood probing: an
+ * entry far from its home slot takes the place of one closer to its own,
+ * which keeps every probe sequence short, lets lookups stop early on a
+ * miss, and removal shifts the following entries back instead of leaving
+ * tombstones.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_LIB_HASHTABLE_H_
+#define __SYNAPSE_LIB_HASHTABLE_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+// Highest load, in eighths of the capacity, before inserts fail
+#define HASH_TABLE_MAX_LOAD 7
+
+typedef struct
+{
+  uint64_t key;
+  void* value;
+  uint32_t distance; // Probe distance + 1, 0 for an empty slot
+} hash_slot_t;
+
+typedef struct
+{
+  hash_slot_t* slots;
+  uint64_t mask; // Capacity - 1
+  size_t count;
+} hash_table_t;
+
+/**
+ * @brief Hash a 64-bit key, every input bit affects every output bit
+ * 
+ * @param key Key
+ * @return uint64_t Hash
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t hash_u64(uint64_t key)
+{
+  // Finalizer of SplitMix64
+  key ^= key >> 30;
+  key *= 0xBF58476D1CE4E5B9ULL;
+  key ^= key >> 27;
+  key *= 0x94D049BB133111EBULL;
+  key ^= key >> 31;
+  return key;
+}
+
+/**
+ * @brief Initialize an empty table
+ * 
+ * @param table Table
+ * @param slots Storage of capacity slots
+ * @param capacity Slots, a power of two
+ * @return int EOK on success, -EINVARG on a bad argument
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int hash_table_init(hash_table_t* table, hash_slot_t* slots, size_t capacity);
+
+/**
+ * @brief Add a key
+ * 
+ * @param table Table
+ * @param key Key
+ * @param value Value, returned by lookups
+ * @return int EOK on success, -EINUSE if the key is present, -ENOMEM
+ * if the table is at HASH_TABLE_MAX_LOAD
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int hash_table_insert(hash_table_t* table, uint64_t key, void* value);
+
+/**
+ * @brief Look a key up
+ * 
+ * @param table Table
+ * @param key Key
+ * @return void* Value, NULL if the key is absent
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* hash_table_find(const hash_table_t* table, uint64_t key);
+
+/**
+ * @brief Remove a key
+ * 
+ * @param table Table
+ * @param key Key
+ * @return void* Value of the key, NULL if it was absent
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* hash_table_remove(hash_table_t* table, uint64_t key);
+
+/**
+ * @brief Get the number of keys
+ * 
+ * @param table Table
+ * @return size_t Keys
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline size_t hash_table_count(const hash_table_t* table)
+{
+  return table->count;
+}
+
+/**
+ * @brief Time lookups in the table against a linear scan of the same keys
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int hash_table_benchmark();
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * rbtree.h - This file defines the intrusive red-black tree. Nodes are
+ * embedded in the objects indexed, so the tree never allocates, and the
+ * order comes from a compare function of the tree. An optional augment
+ * callback recomputes data cached in a node from its children (subtree
+ * sizes, maxima...), it runs on every node whose subtree changed.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_LIB_RBTREE_H_
+#define __SYNAPSE_LIB_RBTREE_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#define RB_RED   0
+#define RB_BLACK 1
+
+// Node embedded in an indexed object
+typedef struct rb_node
+{
+  struct rb_node* parent;
+  struct rb_node* left;
+  struct rb_node* right;
+  uint32_t colour;
+} rb_node_t;
+
+// Order of two nodes: negative, zero or positive like memcmp()
+typedef int (*RB_COMPARE)(const rb_node_t* a, const rb_node_t* b);
+
+// Recompute the data a node caches from its children
+typedef void (*RB_AUGMENT)(rb_node_t* node);
+
+typedef struct
+{
+  rb_node_t* root;
+  RB_COMPARE compare;
+  RB_AUGMENT augment; // NULL if nodes cache nothing
+  size_t count;
+} rb_tree_t;
+
+// Object containing a node
+#define rb_entry(ptr, type, member) ((type*)((uintptr_t)(ptr) - offsetof(type, member)))
+
+/**
+ * @brief Initialize an empty tree
+ * 
+ * @param tree Tree
+ * @param compare Order of the nodes
+ * @param augment Callback keeping cached data up to date, or NULL
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rb_tree_init(rb_tree_t* tree, RB_COMPARE compare, RB_AUGMENT augment);
+
+/**
+ * @brief Insert a node
+ * 
+ * @param tree Tree
+ * @param node Node, not in any tree
+ * @return int EOK on success, -EINUSE if an equal node is in the tree
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rb_insert(rb_tree_t* tree, rb_node_t* node);
+
+/**
+ * @brief Remove a node
+ * 
+ * @param tree Tree
+ * @param node Node of the tree
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rb_erase(rb_tree_t* tree, rb_node_t* node);
+
+/**
+ * @brief Find the node equal to a key
+ * 
+ * @param tree Tree
+ * @param key Node filled with the fields compared, not in the tree
+ * @return rb_node_t* Node, NULL if none
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_find(const rb_tree_t* tree, const rb_node_t* key);
+
+/**
+ * @brief Find the first node not ordered before a key
+ * 
+ * @param tree Tree
+ * @param key Node filled with the fields compared, not in the tree
+ * @return rb_node_t* Node, NULL if every node is smaller
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_lower_bound(const rb_tree_t* tree, const rb_node_t* key);
+
+/**
+ * @brief Get the smallest node
+ * 
+ * @param tree Tree
+ * @return rb_node_t* Node, NULL if the tree is empty
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_first(const rb_tree_t* tree);
+
+/**
+ * @brief Get the largest node
+ * 
+ * @param tree Tree
+ * @return rb_node_t* Node, NULL if the tree is empty
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_last(const rb_tree_t* tree);
+
+/**
+ * @brief Get the next node in order
+ * 
+ * @param node Node of a tree
+ * @return rb_node_t* Node, NULL after the largest
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_next(const rb_node_t* node);
+
+/**
+ * @brief Get the previous node in order
+ * 
+ * @param node Node of a tree
+ * @return rb_node_t* Node, NULL before the smallest
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+rb_node_t* rb_prev(const rb_node_t* node);
+
+/**
+ * @brief Check the tree: order, no red node with a red child, the same
+ * black height on every path, consistent parent links
+ * 
+ * @param tree Tree
+ * @return int Black height on success, -EFAULT if the tree is broken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rb_tree_validate(const rb_tree_t* tree);
+
+/**
+ * @brief Time lookups in the tree against a linear scan of the same keys
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rb_tree_benchmark();
+
+/**
+ * @brief Test the red-black tree and the hash table: random inserts and
+ * removals checked against a plain array, tree invariants, augmented
+ * data, ordered walks, and the load limit of the table
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rb_tree_test();
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * fastmath.h - This file defines the fast math library used by the
+ * activations. FP32 functions use range reduction and polynomials
+ * evaluated four lanes at a time, INT8 activations use a 256-entry
+ * table built once per (scale, zero-point) when the model is loaded.
+ *
+ * Maximum error against glibc libm rounded to FP32, sampled over the
+ * whole input range with and without fused multiply-add:
+ *   exp      1 ULP, 0 below -87.34 (no denormal results)
+ *   log      1 ULP, denormal inputs included
+ *   sigmoid  2 ULP
+ *   tanh     1 ULP
+ *   gelu     8e-8 absolute on [-10, 10], the tanh form itself
+ *   swish    2 ULP on [-10, 10]
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_MATH_FASTMATH_H_
+#define __SYNAPSE_MATH_FASTMATH_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/memory/ai_memory/ai_memory.h>
+
+// Entries of an INT8 lookup table, one per input code
+#define FASTMATH_LUT_SIZE 256
+
+// Functions of the library
+typedef enum
+{
+  FASTMATH_OP_EXP,
+  FASTMATH_OP_LOG,
+  FASTMATH_OP_SIGMOID,
+  FASTMATH_OP_TANH,
+  FASTMATH_OP_GELU,  // 0.5x(1 + tanh(sqrt(2/pi)(x + 0.044715x^3)))
+  FASTMATH_OP_SWISH, // x * sigmoid(x)
+  FASTMATH_OP_COUNT  // Number of functions
+} fastmath_op_t;
+
+// INT8 activation, real = scale * (code - zero_point) on both sides
+typedef struct fastmath_lut
+{
+  int8_t table[FASTMATH_LUT_SIZE]; // Output code, indexed by the input code as uint8_t
+  fastmath_op_t op;
+  float in_scale;
+  int32_t in_zero_point;
+  float out_scale;
+  int32_t out_zero_point;
+} fastmath_lut_t;
+
+/**
+ * @brief Exponential
+ * 
+ * @param x Input
+ * @return float e^x
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_exp(float x);
+
+/**
+ * @brief Natural logarithm
+ * 
+ * @param x Input
+ * @return float ln(x), NaN below 0 and -infinity at 0
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_log(float x);
+
+/**
+ * @brief Logistic function
+ * 
+ * @param x Input
+ * @return float 1 / (1 + e^-x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_sigmoid(float x);
+
+/**
+ * @brief Hyperbolic tangent
+ * 
+ * @param x Input
+ * @return float tanh(x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_tanh(float x);
+
+/**
+ * @brief GELU activation, tanh form
+ * 
+ * @param x Input
+ * @return float GELU(x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_gelu(float x);
+
+/**
+ * @brief Swish (SiLU) activation
+ * 
+ * @param x Input
+ * @return float x * sigmoid(x)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+float fastmath_swish(float x);
+
+/**
+ * @brief Apply a function to an array, four elements at a time
+ * 
+ * @param op Function
+ * @param src Input
+ * @param dst Output, may be src
+ * @param count Number of elements
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_apply(fastmath_op_t op, const float* src, float* dst, size_t count);
+
+/**
+ * @brief Apply a function to a FLOAT32 tensor
+ * 
+ * @param op Function
+ * @param src Input
+ * @param dst Output with the same number of elements, may be src
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_tensor(fastmath_op_t op, tensor_t* src, tensor_t* dst);
+
+/**
+ * @brief Build the lookup table of an INT8 activation, done once when
+ * the model is loaded
+ * 
+ * @param lut Table to fill
+ * @param op Function
+ * @param in_scale Input scale
+ * @param in_zero_point Input zero point
+ * @param out_scale Output scale
+ * @param out_zero_point Output zero point
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_lut_init(fastmath_lut_t* lut, fastmath_op_t op, float in_scale, int32_t in_zero_point,
+                      float out_scale, int32_t out_zero_point);
+
+/**
+ * @brief Apply an INT8 activation to a tensor
+ * 
+ * @param lut Table built by fastmath_lut_init()
+ * @param src INT8 input
+ * @param dst INT8 output with the same number of elements, may be src
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_lut_apply(const fastmath_lut_t* lut, tensor_t* src, tensor_t* dst);
+
+/**
+ * @brief Measure the throughput of every function, FP32 and INT8
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_benchmark();
+
+/**
+ * @brief Test the fast math library: accuracy against libm reference
+ * values, special values and INT8 tables
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int fastmath_test();
+
+#endif
@@ -4,7 +4,7 @@
  *
  * Author: Fedi Nabli
  * Date: 20 Mar 2025
- * Last Modified: 26 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_MEMORY_AI_MEMORY_H_
@@ -21,6 +21,9 @@ typedef enum
   TENSOR_TYPE_INT32,    // 32-bit integer
   TENSOR_TYPE_FLOAT16,  // 16-bit floating point
   TENSOR_TYPE_FLOAT32,  // 32-bit floating point
+  TENSOR_TYPE_INT4,     // 4-bit signed integer, two per byte
+  TENSOR_TYPE_UINT4,    // 4-bit unsigned integer, two per byte
+  TENSOR_TYPE_BFLOAT16, // 16-bit brain floating point (FP32 exponent)
   TENSOR_TYPE_COUNT     // Number of tensor types
 } tensor_dtype_t;
 
@@ -44,6 +47,40 @@ typedef enum
   TENSOR_MEM_DMA        = (1 << 5) // DMA-friendly memory
 } tensor_mem_flags_t;
 
+// Tensor storage formats
+typedef enum
+{
+  TENSOR_FORMAT_DENSE,  // Every element stored (default)
+  TENSOR_FORMAT_CSR,    // Compressed sparse row, 2D only
+  TENSOR_FORMAT_BSR     // Block sparse row, 2D only
+} tensor_format_t;
+
+// Page colour requests
+#define AI_MEMORY_COLOUR_NONE 0xFFFFFFFF // No colour constraint
+#define AI_MEMORY_COLOUR_ANY  0xFFFFFFFE // Rotate through colours
+
+// Sparse index of a CSR / BSR tensor, the values live in the tensor data,
+// one block_rows x block_cols row-major block per stored entry
+typedef struct
+{
+  size_t block_rows; // Rows per block (1 for CSR)
+  size_t block_cols; // Columns per block (1 for CSR)
+  size_t nnz; // Number of stored elements (CSR) or blocks (BSR)
+  uint32_t* row_ptr; // First entry of each (block) row, (block) rows + 1 entries
+  uint32_t* col_idx; // (Block) column of each stored entry
+} tensor_sparse_t;
+
+// Per-group quantisation of a packed tensor. Element i of a row (last
+// dimension) belongs to group i / group_size and its real value is
+// (q - zero_point) * scale
+typedef struct
+{
+  size_t group_size; // Elements per group along the last dimension
+  size_t group_count; // Total number of groups
+  float* scales; // One scale per group
+  uint8_t* zero_points; // One zero point per group (UINT4 only, NULL for INT4)
+} tensor_quant_t;
+
 // Tensor descriptor
 typedef struct
 {
@@ -51,12 +88,24 @@ typedef struct
   size_t* shape; // Array of dimensions
   size_t* strides; // Strides for each dimension
   size_t ndim; // Number of dimensions
-  size_t elem_size; // Size of each element in bytes
+  size_t elem_size; // Size of each element in bytes, 0 for packed sub-byte types
+  size_t elem_bits; // Size of each element in bits
   tensor_dtype_t dtype; // Data type
   tensor_layout_t layout; // Memory layour
   uint32_t flags; // Memory flags
+  uint32_t colour; // Cache colour of the first data page
+  tensor_format_t format; // Storage format
+  tensor_sparse_t* sparse; // Sparse index, NULL for dense tensors
+  tensor_quant_t* quant; // Group scales of packed tensors, NULL otherwise
 } tensor_t;
 
+// Tensor arena, hands out distinct colours to tensors live together
+typedef struct
+{
+  uint32_t next_colour; // Colour of the next tensor
+  uint32_t colours_used; // Colours already handed out, up to the colour count
+} ai_tensor_arena_t;
+
 /**
  * @brief Initialize the AI memory subsystem
  * 
@@ -83,6 +132,117 @@ int ai_memory_init(size_t pool_size);
  */
 tensor_t* ai_tensor_create(size_t* shape, size_t ndim, tensor_dtype_t dtype, tensor_layout_t layout, uint32_t flags);
 
+/**
+ * @brief Create a tensor whose data starts on a page of the given cache colour
+ * 
+ * @param shape Pointer to the shape array
+ * @param ndim Number of dimensions
+ * @param dtype Data type of the tensor elements
+ * @param layout Memory layout of the tensor
+ * @param flags Allocation flags
+ * @param colour Page colour, AI_MEMORY_COLOUR_ANY to rotate or AI_MEMORY_COLOUR_NONE
+ * @return tensor_t* Pointer to the created tensor, or NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+tensor_t* ai_tensor_create_coloured(size_t* shape, size_t ndim, tensor_dtype_t dtype, tensor_layout_t layout, uint32_t flags, uint32_t colour);
+
+/**
+ * @brief Get the number of page colours of the last level data cache
+ * 
+ * @return uint32_t Number of colours (1 if colouring is not possible)
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t ai_memory_get_colour_count();
+
+/**
+ * @brief Get the cache colour of an address
+ * 
+ * @param ptr Address to check
+ * @return uint32_t Page colour of the address
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t ai_memory_get_colour(void* ptr);
+
+/**
+ * @brief Initialize a tensor arena for tensors used at the same time
+ * 
+ * @param arena Arena to initialize
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void ai_tensor_arena_init(ai_tensor_arena_t* arena);
+
+/**
+ * @brief Create a tensor in an arena, its colours never overlap with the
+ * tensors previously created in the same arena. Once the arena has used
+ * every colour, further tensors are created without a colour
+ * 
+ * @param arena Arena the tensor belongs to
+ * @param shape Pointer to the shape array
+ * @param ndim Number of dimensions
+ * @param dtype Data type of the tensor elements
+ * @param layout Memory layout of the tensor
+ * @param flags Allocation flags
+ * @return tensor_t* Pointer to the created tensor, or NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+tensor_t* ai_tensor_arena_create(ai_tensor_arena_t* arena, size_t* shape, size_t ndim, tensor_dtype_t dtype, tensor_layout_t layout, uint32_t flags);
+
+/**
+ * @brief Create a packed INT4 / UINT4 tensor with per-group scales, groups
+ * run along the last dimension which must be even
+ * 
+ * @param shape Pointer to the shape array
+ * @param ndim Number of dimensions
+ * @param dtype TENSOR_TYPE_INT4 or TENSOR_TYPE_UINT4
+ * @param group_size Elements per group, even
+ * @param flags Allocation flags
+ * @return tensor_t* Pointer to the created tensor, or NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+tensor_t* ai_tensor_create_packed(size_t* shape, size_t ndim, tensor_dtype_t dtype, size_t group_size, uint32_t flags);
+
+/**
+ * @brief Get the number of bits of an element of a tensor type
+ * 
+ * @param dtype Tensor data type
+ * @return size_t Element size in bits
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t ai_tensor_get_elem_bits(tensor_dtype_t dtype);
+
+/**
+ * @brief Create an empty 2D sparse tensor, the caller fills the index
+ * and the values
+ * 
+ * @param rows Number of rows
+ * @param cols Number of columns
+ * @param dtype Data type of the tensor elements
+ * @param format TENSOR_FORMAT_CSR or TENSOR_FORMAT_BSR
+ * @param block_rows Rows per block (BSR only, must divide rows)
+ * @param block_cols Columns per block (BSR only, must divide cols)
+ * @param nnz Number of stored elements (CSR) or blocks (BSR)
+ * @param flags Allocation flags
+ * @return tensor_t* Pointer to the created tensor, or NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+tensor_t* ai_tensor_create_sparse(size_t rows, size_t cols, tensor_dtype_t dtype, tensor_format_t format, size_t block_rows, size_t block_cols, size_t nnz, uint32_t flags);
+
 /**
  * @brief Destroy a tensor and free its memory
  * 
@@ -134,7 +294,7 @@ size_t ai_tensor_get_alignment(tensor_t* tensor);
  * @brief Get total tensor size in bytes
  * 
  * @param tensor Pointer to the tensor
- * @return size_t Total size of the tensor in bytes
+ * @return size_t Total size of the tensor data in bytes (stored values for sparse tensors)
  * 
  * @author Fedi Nabli
  * @date 21 Mar 2025
@@ -179,6 +339,18 @@ int ai_tensor_copy_data(tensor_t* tensor, void* data, size_t size);
  */
 tensor_t* ai_tensor_view(tensor_t* tensor, size_t* start_indices, size_t* shape);
 
+/**
+ * @brief Clear free small blocks ahead of zeroed allocations, called by
+ * the zero pool worker
+ * 
+ * @param max_blocks Most blocks to clear
+ * @return size_t Blocks cleared, 0 once every free block holds zeros
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t ai_memory_zero_free_blocks(size_t max_blocks);
+
 /**
  * @brief Print AI memory pool statistics
  * 
@@ -4,7 +4,7 @@
  *
  * Author: Fedi Nabli
  * Date: 6 Mar 2025
- * Last Modified: 27 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_MEMORY_KHEAP_H_
@@ -14,7 +14,8 @@
 
 /**
  * @brief Initializes the kernel heap with dynamic size based on
- * available RAM
+ * available RAM. Its table is cleared by kheap_clear_table() before the
+ * first allocation, in parts if several CPUs share the work
  * 
  * @author Fedi Nabli
  * @date 6 Mar 2025
@@ -23,6 +24,18 @@
  */
 void kheap_init(size_t ram_size);
 
+/**
+ * @brief Clear one part of the kernel heap table, every part must be
+ * cleared before the first allocation
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ * 
+ * @param part part to clear, below parts
+ * @param parts number of equal parts the table is split in
+ */
+void kheap_clear_table(uint32_t part, uint32_t parts);
+
 /**
  * @brief Allocated requested amount in the memory
  * and returns the address
@@ -36,7 +49,8 @@ void kheap_init(size_t ram_size);
 void* kmalloc(size_t size);
 
 /**
- * @brief Allocates memory and initializes it to zero
+ * @brief Allocates memory and initializes it to zero. Sizes the zero pool
+ * keeps are taken from it, others are cleared here
  * 
  * @param size Amount of memory needed in bytes
  * @return void* Start address of the zero-initialized memory allocated
@@ -46,6 +60,20 @@ void* kmalloc(size_t size);
  */
 void* kzalloc(size_t size);
 
+/**
+ * @brief Allocates page aligned memory whose first page has the requested
+ * cache colour, used to keep concurrently used buffers in different cache sets
+ * 
+ * @param size Amount of memory needed in bytes
+ * @param colour Requested colour of the first page
+ * @param colours Number of page colours of the cache
+ * @return void* Start address of the memory allocated
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* kmalloc_coloured(size_t size, uint32_t colour, uint32_t colours);
+
 /**
  * @brief Frees memory region previously allocated to ptr
  * 
@@ -56,4 +84,38 @@ void* kzalloc(size_t size);
  */
 void kfree(void* ptr);
 
+/**
+ * @brief Returns the number of free bytes in the kernel heap
+ * 
+ * @return size_t Free bytes
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t kheap_get_free_size();
+
+/**
+ * @brief Keeps the kernel heap away from a memory range owned by
+ * someone else (boot modules, device tree...)
+ * 
+ * @param ptr Start of the range
+ * @param size Size of the range in bytes
+ * @return int EOK on success, -EINUSE if part of the range is allocated
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int kheap_reserve(void* ptr, size_t size);
+
+/**
+ * @brief Returns the size of the kernel heap allocation starting at ptr
+ * 
+ * @param ptr Start address of the allocation
+ * @return size_t Size in bytes, 0 if ptr is not the start of an allocation
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t kheap_allocation_size(void* ptr);
+
 #endif
@@ -4,7 +4,7 @@
  *
  * Author: Fedi Nabli
  * Date: 21 Mar 2025
- * Last Modified: 26 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_MEMORY_SYSTEM_H_
@@ -19,7 +19,8 @@ typedef enum
   MEM_REGION_TYPE_RAM = 0,
   MEM_REGION_TYPE_DEVICE,
   MEM_REGION_TYPE_MMIO,
-  MEM_REGION_TYPE_KERNEL
+  MEM_REGION_TYPE_KERNEL,
+  MEM_REGION_TYPE_RESERVED // Firmware, device tree and boot modules
 } mem_region_type_t;
 
 // Memory region structure
@@ -34,21 +35,43 @@ typedef struct
 } mem_system_region_t;
 
 /**
- * @brief Initialize the complete memory system
- * 
- * This function initializes the entire memory system, including the kernel heap,
- * and AI memory subsystem. It also
- * registers memory regions for tracking and creates necessary identity mappings.
+ * @brief Lay the kernel heap out after the kernel. Its table is cleared
+ * with kheap_clear_table() next, then memory_system_claim_reserved()
+ * makes it usable
  * 
  * @param ram_size The total size of the RAM in bytes
  * @param kernel_start The start address of the kernel in physical memory
  * @param kernel_end The end address of the kernel in physical memory
- * @return int Returns EOK on success, or a negative error code on failure
  * 
  * @author Fedi Nabli
  * @date 21 Mar 2025
  */
-int memory_system_init(size_t ram_size, uintptr_t kernel_start, uintptr_t kernel_end);
+void memory_system_init_heap(size_t ram_size, uintptr_t kernel_start, uintptr_t kernel_end);
+
+/**
+ * @brief Set the memory pressure watermarks and claim the reserved ranges
+ * of the platform, once the heap table is cleared. The heap may be used
+ * afterwards
+ * 
+ * @param kernel_start The start address of the kernel in physical memory
+ * @param kernel_end The end address of the kernel in physical memory
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_system_claim_reserved(uintptr_t kernel_start, uintptr_t kernel_end);
+
+/**
+ * @brief Fill the AI memory pool from the kernel heap
+ * 
+ * @param ram_size The total size of the RAM in bytes
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_system_init_ai(size_t ram_size);
 
 /**
  * @brief Test the kernel heap allocator
@@ -70,6 +93,38 @@ int memory_test_kernel_heap();
  */
 int memory_test_ai_memory();
 
+/**
+ * @brief Test the zero pool: clearing around DC ZVA blocks, zeroed
+ * allocations from the pool and without it, draining, and the cleared
+ * small blocks of the AI pool
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_test_zero_pool();
+
+/**
+ * @brief Test shrinkers and pressure notifications
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_test_memory_pressure();
+
+/**
+ * @brief Benchmark cache conflict misses of aliased vs coloured tensors
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_bench_page_colouring();
+
 /**
  * @brief Print all registered memory regions
  * 
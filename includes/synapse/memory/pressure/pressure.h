@@ -0,0 +1,168 @@
+/*
+ * pressure.h - This file defines the memory pressure framework.
+ * Subsystems register shrinkers that release cached memory, allocators
+ * call them before failing and processes get notified on watermarks.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_MEMORY_PRESSURE_H_
+#define __SYNAPSE_MEMORY_PRESSURE_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+// Maximum number of registered shrinkers
+#define MEMORY_PRESSURE_MAX_SHRINKERS 16
+
+// Memory pressure levels
+typedef enum
+{
+  MEMORY_PRESSURE_NONE = 0,   // Free memory above the high watermark
+  MEMORY_PRESSURE_MODERATE,   // Free memory below the high watermark
+  MEMORY_PRESSURE_CRITICAL    // Free memory below the low watermark
+} memory_pressure_level_t;
+
+// Shrinker priorities, cheaper caches are shrunk first
+#define SHRINKER_PRIORITY_CHEAP     0 // Pure caches, trivially rebuilt
+#define SHRINKER_PRIORITY_NORMAL    1 // Caches that cost some work to rebuild
+#define SHRINKER_PRIORITY_EXPENSIVE 2 // Caches that cost a lot to rebuild
+
+// Shrinker callback, releases up to target bytes and returns the bytes freed
+typedef size_t (*SHRINKER_CALLBACK)(size_t target, void* private_data);
+
+/**
+ * @brief Initialize the memory pressure framework
+ * 
+ * @param total_size Total size of the kernel heap in bytes
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_init(size_t total_size);
+
+/**
+ * @brief Register a shrinker
+ * 
+ * @param name Name of the cache (for statistics)
+ * @param callback Function releasing memory
+ * @param private_data Data passed to the callback
+ * @param priority SHRINKER_PRIORITY_* value
+ * @return int Shrinker ID on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_register_shrinker(const char* name, SHRINKER_CALLBACK callback, void* private_data, int priority);
+
+/**
+ * @brief Unregister a shrinker
+ * 
+ * @param id Shrinker ID returned on registration
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_unregister_shrinker(int id);
+
+/**
+ * @brief Run the shrinkers, cheapest first, until target bytes are released
+ * 
+ * @param target Number of bytes to release
+ * @return size_t Number of bytes released
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t memory_pressure_reclaim(size_t target);
+
+/**
+ * @brief Update the pressure level from the current free memory, called by
+ * the allocators after each allocation and free
+ * 
+ * @param free_size Free memory in bytes
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void memory_pressure_update(size_t free_size);
+
+/**
+ * @brief Set the low and high watermarks
+ * 
+ * @param low Free bytes below which the pressure is critical
+ * @param high Free bytes below which the pressure is moderate
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_set_watermarks(size_t low, size_t high);
+
+/**
+ * @brief Get the low and high watermarks
+ * 
+ * @param low Output for the low watermark
+ * @param high Output for the high watermark
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void memory_pressure_get_watermarks(size_t* low, size_t* high);
+
+/**
+ * @brief Get the current memory pressure level
+ * 
+ * @return memory_pressure_level_t Current level
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+memory_pressure_level_t memory_pressure_get_level();
+
+/**
+ * @brief Subscribe a process to pressure notifications
+ * 
+ * @param pid Process ID
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_subscribe(pid_t pid);
+
+/**
+ * @brief Unsubscribe a process from pressure notifications
+ * 
+ * @param pid Process ID
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_unsubscribe(pid_t pid);
+
+/**
+ * @brief Get and clear the pending notification of a process
+ * 
+ * @param pid Process ID
+ * @return int Highest level notified since the last poll, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int memory_pressure_poll(pid_t pid);
+
+/**
+ * @brief Print memory pressure statistics
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void memory_pressure_print_stats();
+
+#endif
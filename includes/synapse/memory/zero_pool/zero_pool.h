@@ -0,0 +1,124 @@
+/*
+ * zero_pool.h - This file defines the pool of pre-zeroed memory. A low
+ * priority kernel thread clears heap blocks while the CPU has nothing
+ * else to run and keeps them for zeroed allocations: kzalloc() pages and
+ * process stacks. It also clears the free small blocks of the AI pool.
+ * An allocation takes a block from the pool when one is ready and only
+ * clears memory itself when the pool is empty.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_MEMORY_ZERO_POOL_H_
+#define __SYNAPSE_MEMORY_ZERO_POOL_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+/* Block classes of the pool */
+#define ZERO_POOL_PAGE    0 // One heap block
+#define ZERO_POOL_STACK   1 // A process stack
+#define ZERO_POOL_CLASSES 2
+
+// Free AI small blocks cleared per pass of the worker
+#define ZERO_POOL_AI_BATCH 64
+
+typedef struct
+{
+  uint32_t level[ZERO_POOL_CLASSES]; // Blocks ready
+  uint32_t target[ZERO_POOL_CLASSES]; // Blocks the worker refills to
+  uint64_t hits[ZERO_POOL_CLASSES]; // Allocations served by the pool
+  uint64_t misses[ZERO_POOL_CLASSES]; // Allocations cleared on demand
+  uint64_t refills; // Blocks cleared by the pool
+  uint64_t ai_blocks; // AI small blocks cleared ahead of use
+} zero_pool_stats_t;
+
+/**
+ * @brief Set memory to zero, with DC ZVA when the memory allows it
+ * 
+ * @param ptr Start of the memory
+ * @param size Size in bytes
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void zero_pool_clear(void* ptr, size_t size);
+
+/**
+ * @brief Take a zeroed block for an allocation of a pool class size
+ * 
+ * @param size Size of the allocation in bytes
+ * @return void* Zeroed heap allocation, freed with kfree(). NULL if the
+ * size has no class or the pool of its class is empty
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* zero_pool_alloc(size_t size);
+
+/**
+ * @brief Clear heap blocks until every class is at its target, as the
+ * worker does. Does nothing under memory pressure
+ * 
+ * @param max Most blocks to add
+ * @return uint32_t Blocks added
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t zero_pool_refill(uint32_t max);
+
+/**
+ * @brief Give every block of the pool back to the kernel heap
+ * 
+ * @return size_t Bytes released
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+size_t zero_pool_drain();
+
+/**
+ * @brief Register the shrinker of the pool and start its low priority
+ * worker, which runs once the scheduler does
+ * 
+ * @return int EOK on success, -EINUSE if started, -ENOMEM if the worker
+ * cannot be created
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int zero_pool_start();
+
+/**
+ * @brief Get the level and hit counts of the pool
+ * 
+ * @param stats Output
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void zero_pool_get_stats(zero_pool_stats_t* stats);
+
+/**
+ * @brief Print the level and hit rate of each class
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void zero_pool_print_stats();
+
+/**
+ * @brief Time zeroed allocations from the pool against clearing them on
+ * demand, and DC ZVA against memset
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int zero_pool_benchmark();
+
+#endif
@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 2 Apr 2025
- * Last Modified: 9 Apr 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_PROCESS_PROCESS_H_
@@ -14,6 +14,7 @@
 #include <synapse/bool.h>
 #include <synapse/types.h>
 #include <synapse/task/task.h>
+#include <synapse/lib/hashtable.h>
 
 // Process memory allocations structure
 struct process_allocation
@@ -39,6 +40,9 @@ struct process
 
   // Process memory
   struct process_allocation allocations[SYNAPSE_MAX_PROCESSES_ALLOCATIONS];
+  uint64_t allocations_used[SYNAPSE_MAX_PROCESSES_ALLOCATIONS / 64]; // Bit set per entry in use
+  hash_table_t allocation_index; // Allocated pointer to its entry
+  hash_slot_t allocation_slots[SYNAPSE_PROCESS_ALLOCATION_SLOTS];
 
   union
   {
@@ -66,6 +70,18 @@ struct process
  */
 void* process_malloc(struct process* process, size_t size);
 
+/**
+ * @brief Allocate zeroed memory for a process
+ * 
+ * @param process Process to allocate for
+ * @param size Size in bytes to allocate
+ * @return void* Pointer to allocated memory, NULL on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* process_zalloc(struct process* process, size_t size);
+
 /**
  * @brief Free memory allocated to a process
  * 
@@ -148,7 +164,8 @@ int process_memory_flush_icache(void* addr, size_t size);
 struct process* process_current();
 
 /**
- * @brief Get a process by ID
+ * @brief Get a process by ID, lock-free. The process stays valid until
+ * the caller leaves its RCU read section
  * 
  * @param id Process ID to look up
  * @return struct process* Pointer to process, NULL if not found
@@ -172,6 +189,21 @@ struct process* process_get(pid_t id);
  */
 int process_create(const char* name, void* program_data, size_t size, struct process** process_out);
 
+/**
+ * @brief Create and load a process from a file of the root filesystem,
+ * the binary is copied once straight from the archive
+ * 
+ * @param name Process name
+ * @param path Path of the program binary
+ * @param process_out Output parameter for created process
+ * @return int Process ID on success, -ENOENT if there is no such file,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int process_create_from_file(const char* name, const char* path, struct process** process_out);
+
 /**
  * @brief Create a process in a specific slot
  * 
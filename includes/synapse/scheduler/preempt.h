@@ -0,0 +1,243 @@
+/*
+ * preempt.h - This file defines kernel preemption control. Each CPU counts
+ * the sections in which the running task must not be switched out, every
+ * lock held is one. The scheduler tick only sets need_resched, the switch
+ * happens on IRQ exit when the count is zero, or right after the section
+ * that delayed it: preempt_enable() and cond_resched() raise a reschedule
+ * SGI and the task is switched out through the same IRQ path. The longest
+ * section of each CPU is recorded with the code that ended it.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_SCHEDULER_PREEMPT_H_
+#define __SYNAPSE_SCHEDULER_PREEMPT_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/smp/percpu.h>
+#include <synapse/timer/counter.h>
+
+struct interrupt_frame;
+
+// SGI raised to switch tasks outside of the tick
+#define PREEMPT_RESCHED_SGI 1
+
+// Bytes copied or zeroed by long operations between preemption points
+#define PREEMPT_CHUNK_SIZE (64 * 1024)
+
+// Preemption state of a CPU
+typedef struct
+{
+  uint32_t count; // Sections entered and not left
+  volatile uint32_t need_resched; // Set by the scheduler, cleared on the switch
+  uint64_t section_start; // Counter when count left zero
+  uint64_t worst_ticks; // Longest section
+  uintptr_t worst_site; // Address of the code that ended it
+} preempt_cpu_t;
+
+DECLARE_PER_CPU(preempt_cpu_t, preempt_cpu);
+
+/**
+ * @brief Register and enable the reschedule SGI
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int preempt_init();
+
+/**
+ * @brief Close a section: record its length, then switch tasks if the
+ * scheduler asked for it meanwhile
+ * 
+ * @param cpu Preemption state of the current CPU
+ * @param site Code ending the section
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void preempt_section_end(preempt_cpu_t* cpu, uintptr_t site);
+
+/**
+ * @brief Switch tasks now if the scheduler asked for it and the current
+ * code may be preempted, return at once otherwise
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void preempt_schedule();
+
+/**
+ * @brief Enter a section the running task is not switched out of,
+ * sections nest
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void preempt_disable()
+{
+  preempt_cpu_t* cpu = this_cpu_ptr(&preempt_cpu);
+  if (cpu->count++ == 0)
+  {
+    cpu->section_start = timer_read_counter_relaxed();
+  }
+  __asm__ volatile("" ::: "memory");
+}
+
+// Address of the code it is written in, even once inlined
+#define PREEMPT_THIS_IP ({ __label__ __here; __here: (uintptr_t)&&__here; })
+
+/**
+ * @brief Leave a section entered with preempt_disable(), for code ending
+ * it on behalf of its caller such as the unlock functions
+ * 
+ * @param site Code ending the section
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void preempt_enable_at(uintptr_t site)
+{
+  __asm__ volatile("" ::: "memory");
+  preempt_cpu_t* cpu = this_cpu_ptr(&preempt_cpu);
+  if (--cpu->count == 0)
+  {
+    preempt_section_end(cpu, site);
+  }
+}
+
+// Leave a section entered with preempt_disable(), ended where it is written
+#define preempt_enable() preempt_enable_at(PREEMPT_THIS_IP)
+
+/**
+ * @brief Leave a section without recording it or switching tasks, for
+ * code that checks need_resched itself
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void preempt_enable_no_resched()
+{
+  __asm__ volatile("" ::: "memory");
+  this_cpu_ptr(&preempt_cpu)->count--;
+}
+
+/**
+ * @brief Get the section nesting of the current CPU
+ * 
+ * @return uint32_t Sections entered and not left
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint32_t preempt_count()
+{
+  return this_cpu_read(preempt_cpu).count;
+}
+
+/**
+ * @brief Check if the scheduler asked the current CPU to switch tasks
+ * 
+ * @return true If a switch is pending
+ * @return false Otherwise
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool need_resched()
+{
+  return this_cpu_ptr(&preempt_cpu)->need_resched != 0;
+}
+
+/**
+ * @brief Preemption point for long loops: switch tasks if the scheduler
+ * asked for it, costs one load otherwise
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void cond_resched()
+{
+  if (need_resched())
+  {
+    preempt_schedule();
+  }
+}
+
+/**
+ * @brief Ask the current CPU to switch tasks at its next preemption point
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void preempt_set_need_resched();
+
+/**
+ * @brief Switch tasks on IRQ exit if the scheduler asked for it and the
+ * interrupted code was outside any section
+ * 
+ * @param int_frame Interrupt frame of the interrupted task
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void preempt_irq_exit(struct interrupt_frame* int_frame);
+
+/**
+ * @brief Check if the current code may be switched out
+ * 
+ * @return true If outside any section with IRQs taken
+ * @return false Otherwise
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool preemptible();
+
+/**
+ * @brief Get the longest section over every CPU
+ * 
+ * @param site Output for the code that ended it, may be NULL
+ * @return uint64_t Length in ns
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t preempt_worst_section_ns(uintptr_t* site);
+
+/**
+ * @brief Forget the longest sections of every CPU
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void preempt_reset_worst();
+
+/**
+ * @brief Time the preemption primitives and print the longest section
+ * since boot
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int preempt_benchmark();
+
+/**
+ * @brief Test preemption control: section nesting, locks counted as
+ * sections, the longest section tracker and need_resched handling
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int preempt_test();
+
+#endif
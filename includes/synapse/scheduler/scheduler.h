@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 9 Apr 2025
- * Last Modified: 9 Apr 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_SCHEDULER_H_
@@ -25,6 +25,17 @@
  */
 int scheduler_timer_handler(struct interrupt_frame* int_frame);
 
+/**
+ * @brief Save the interrupted task and switch to the next one, called on
+ * IRQ exit outside any non-preemptible section
+ * 
+ * @param int_frame Interrupt frame of the interrupted task
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void scheduler_preempt(struct interrupt_frame* int_frame);
+
 /**
  * @brief Initialize the scheduler
  * 
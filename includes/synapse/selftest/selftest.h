@@ -0,0 +1,25 @@
+/*
+ * selftest.h - This file defines the kernel self-test runner, run once at
+ * boot after the memory system is up
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_SELFTEST_H_
+#define __SYNAPSE_SELFTEST_H_
+
+/**
+ * @brief Run the memory system tests, then the test of every subsystem,
+ * stopping at the first failure
+ * 
+ * @return int EOK if every test passed, the error of the failed test
+ * otherwise
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int selftest_run();
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * semihost.h - This file defines the ARM semihosting client. Under QEMU
+ * (or a debugger) the kernel can open, read and write host files, read
+ * the host clock and exit with a status code. The client is only built
+ * with SEMIHOSTING=1, production images get stubs that fail with
+ * -ENOTREADY and never execute the trap.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_SEMIHOST_H_
+#define __SYNAPSE_SEMIHOST_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+// Operation numbers, passed in w0 to HLT #0xF000
+#define SEMIHOST_SYS_OPEN     0x01
+#define SEMIHOST_SYS_CLOSE    0x02
+#define SEMIHOST_SYS_WRITE    0x05
+#define SEMIHOST_SYS_READ     0x06
+#define SEMIHOST_SYS_CLOCK    0x10
+#define SEMIHOST_SYS_EXIT     0x18
+#define SEMIHOST_SYS_ELAPSED  0x30
+#define SEMIHOST_SYS_TICKFREQ 0x31
+
+// SYS_EXIT reason for a normal application exit
+#define SEMIHOST_ADP_STOPPED_APPLICATION_EXIT 0x20026
+
+// File open modes, the ISO C fopen() modes
+typedef enum
+{
+  SEMIHOST_OPEN_READ = 1,   // "rb"
+  SEMIHOST_OPEN_WRITE = 5,  // "wb", truncates
+  SEMIHOST_OPEN_APPEND = 9  // "ab"
+} semihost_mode_t;
+
+/**
+ * @brief Check if the client is built in
+ * 
+ * @return bool true with SEMIHOSTING=1
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool semihost_present();
+
+/**
+ * @brief Open a host file, relative paths start in the directory QEMU
+ * was launched from
+ * 
+ * @param path File path
+ * @param mode Open mode
+ * @return int Host handle, -EIO if the host refused,
+ * -ENOTREADY without semihosting
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_open(const char* path, semihost_mode_t mode);
+
+/**
+ * @brief Close a host file
+ * 
+ * @param handle Host handle
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_close(int handle);
+
+/**
+ * @brief Write to a host file
+ * 
+ * @param handle Host handle
+ * @param data Data
+ * @param size Size in bytes
+ * @return int EOK if everything was written, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_write(int handle, const void* data, size_t size);
+
+/**
+ * @brief Read from a host file
+ * 
+ * @param handle Host handle
+ * @param buffer Destination
+ * @param size Bytes to read
+ * @return int Bytes read, 0 at the end of the file, negative error code
+ * on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_read(int handle, void* buffer, size_t size);
+
+/**
+ * @brief Write a whole host file in one go
+ * 
+ * @param path File path, truncated if it exists
+ * @param data Data
+ * @param size Size in bytes
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_write_file(const char* path, const void* data, size_t size);
+
+/**
+ * @brief Read the host clock
+ * 
+ * @return int64_t Centiseconds since the run started, negative error code
+ * on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int64_t semihost_clock();
+
+/**
+ * @brief Read the host tick counter
+ * 
+ * @param ticks Output for the ticks since the run started
+ * @param frequency Output for the ticks per second, may be NULL
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_elapsed(uint64_t* ticks, uint64_t* frequency);
+
+/**
+ * @brief Stop the machine, QEMU exits with the status code
+ * 
+ * @param code Status code, 0 for success
+ * @return int -ENOTREADY without semihosting, does not return otherwise
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int semihost_exit(int code);
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * percpu.h - This file defines the per-CPU variables. DEFINE_PER_CPU()
+ * places a variable in the .percpu section, which is only a template:
+ * percpu_init() gives every CPU its own copy and stores the distance from
+ * the template to that copy in TPIDR_EL1. this_cpu_*() reach the copy of
+ * the calling CPU from that register, without any lock or shared store.
+ *
+ * Per-CPU counters build on it: each CPU adds to its own copy and readers
+ * sum every copy, so hot paths never bounce a shared cache line.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_SMP_PERCPU_H_
+#define __SYNAPSE_SMP_PERCPU_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/smp/smp.h>
+#include <synapse/sync/atomic.h>
+
+// Per-CPU area of each CPU, the .percpu section must fit in it
+#define PERCPU_AREA_SIZE 4096
+
+// Define a per-CPU variable, its initializer is the value of every CPU
+#define DEFINE_PER_CPU(type, name) \
+  __attribute__((section(".percpu"), aligned(8))) __typeof__(type) name
+
+// Declare a per-CPU variable defined in another file
+#define DECLARE_PER_CPU(type, name) extern __typeof__(type) name
+
+// Offset of the copy of each CPU from the template, set by percpu_init()
+extern uintptr_t percpu_offsets[SMP_MAX_CPUS];
+
+// Pointer to the copy of a per-CPU variable of the calling or a given CPU
+#define this_cpu_ptr(ptr) ((__typeof__(ptr))((uintptr_t)(ptr) + percpu_offset()))
+#define per_cpu_ptr(ptr, cpu) ((__typeof__(ptr))((uintptr_t)(ptr) + percpu_offsets[(cpu)]))
+
+// Copy of a per-CPU variable of a given CPU
+#define per_cpu(var, cpu) (*per_cpu_ptr(&(var), (cpu)))
+
+// Read and write the copy of the calling CPU
+#define this_cpu_read(var) (*(volatile __typeof__(var)*)this_cpu_ptr(&(var)))
+#define this_cpu_write(var, value) (*(volatile __typeof__(var)*)this_cpu_ptr(&(var)) = (value))
+
+// Per-CPU event counter
+typedef uint64_t percpu_counter_t;
+
+#define DEFINE_PER_CPU_COUNTER(name) DEFINE_PER_CPU(percpu_counter_t, name)
+#define DECLARE_PER_CPU_COUNTER(name) DECLARE_PER_CPU(percpu_counter_t, name)
+
+/**
+ * @brief Get the offset of the per-CPU copies of the calling CPU
+ * 
+ * @return uintptr_t TPIDR_EL1
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uintptr_t percpu_offset()
+{
+  uintptr_t offset;
+  __asm__ volatile("mrs %0, tpidr_el1" : "=r" (offset));
+  return offset;
+}
+
+/**
+ * @brief Add to the copy of a per-CPU counter of the calling CPU
+ * 
+ * @param counter Per-CPU counter
+ * @param value Value added
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void percpu_counter_add(percpu_counter_t* counter, uint64_t value)
+{
+  // Exclusive add on a line no other CPU writes, exact under IRQs and migration
+  atomic_add_relaxed_64(this_cpu_ptr(counter), value);
+}
+
+/**
+ * @brief Add one to the copy of a per-CPU counter of the calling CPU
+ * 
+ * @param counter Per-CPU counter
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void percpu_counter_inc(percpu_counter_t* counter)
+{
+  percpu_counter_add(counter, 1);
+}
+
+/**
+ * @brief Give every CPU its copy of the per-CPU variables and point
+ * TPIDR_EL1 of the boot CPU at copy 0
+ * 
+ * @return int EOK on success, -ENOMEM if the .percpu section does not
+ * fit in PERCPU_AREA_SIZE
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int percpu_init();
+
+/**
+ * @brief Point TPIDR_EL1 of the calling CPU at the copy of a CPU index
+ * 
+ * @param cpu CPU index
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void percpu_set_cpu(uint32_t cpu);
+
+/**
+ * @brief Sum the copies of a per-CPU counter over every CPU
+ * 
+ * @param counter Per-CPU counter
+ * @return uint64_t Total
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t percpu_counter_sum(percpu_counter_t* counter);
+
+/**
+ * @brief Set every copy of a per-CPU counter to zero, updates racing
+ * with it may be lost
+ * 
+ * @param counter Per-CPU counter
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void percpu_counter_reset(percpu_counter_t* counter);
+
+/**
+ * @brief Test the per-CPU variables: distinct copies per CPU, accessors
+ * of the calling CPU, and counters summed over every CPU
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int percpu_test();
+
+#endif
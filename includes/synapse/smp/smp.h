@@ -0,0 +1,127 @@
+/*
+ * smp.h - This file defines the secondary CPU bring-up. CPUs listed in
+ * the device tree are started with PSCI CPU_ON, each on its own stack,
+ * and then idle in WFE until CPU 0 hands them a function to run.
+ * QEMU starts them with -smp N (make run SMP=N).
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_SMP_H_
+#define __SYNAPSE_SMP_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/fdt/fdt.h>
+
+// Most CPUs brought up, one per GICv2 CPU interface
+#define SMP_MAX_CPUS FDT_MAX_CPUS
+// Stack of each secondary CPU
+#define SMP_STACK_SIZE 16384
+
+// PSCI 0.2 function IDs and return codes
+#define PSCI_CPU_ON_64           0xC4000003
+#define PSCI_SUCCESS             0
+#define PSCI_ALREADY_ON          (-4)
+
+// Function run on a CPU
+typedef void (*SMP_CALL_FUNCTION)(void* arg);
+
+// Per-CPU bring-up and call mailbox
+typedef struct smp_cpu
+{
+  uint64_t stack_top; // Read by the secondary entry in start.S, keep first
+  uint64_t mpidr;
+  uint32_t index;
+  volatile uint32_t online;
+  SMP_CALL_FUNCTION call;
+  void* call_arg;
+  volatile uint32_t call_seq; // Bumped by CPU 0 for every call
+  volatile uint32_t done_seq; // Set to call_seq when the call returns
+} smp_cpu_t;
+
+/**
+ * @brief Start every secondary CPU of the device tree and wait until
+ * they are online
+ * 
+ * @return int EOK on success (also with a single CPU), -ENOTREADY if
+ * the platform has no PSCI
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int smp_init();
+
+/**
+ * @brief Get the number of CPUs online, CPU 0 included
+ * 
+ * @return uint32_t CPUs online
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t smp_cpu_count();
+
+/**
+ * @brief Get the index of the calling CPU
+ * 
+ * @return uint32_t Index, 0 for the boot CPU
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t smp_processor_id();
+
+/**
+ * @brief Run a function on a secondary CPU without waiting for it,
+ * a previous call still running is waited for first
+ * 
+ * @param cpu Secondary CPU index
+ * @param fn Function
+ * @param arg Argument passed to fn
+ * @return int EOK on success, -EINVARG if the CPU is not an online secondary
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int smp_call(uint32_t cpu, SMP_CALL_FUNCTION fn, void* arg);
+
+/**
+ * @brief Wait until the last call of a secondary CPU has returned
+ * 
+ * @param cpu Secondary CPU index
+ * @return int EOK on success, -EINVARG if the CPU is not an online secondary
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int smp_wait(uint32_t cpu);
+
+/**
+ * @brief Run a function on the first CPUs at the same time, the caller
+ * being CPU 0, and wait until every one has returned
+ * 
+ * @param count CPUs to use, 1 to smp_cpu_count()
+ * @param fn Function
+ * @param arg Argument passed to fn on every CPU
+ * @return int EOK on success, -EINVARG if count is out of range
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int smp_run(uint32_t count, SMP_CALL_FUNCTION fn, void* arg);
+
+/**
+ * @brief C entry of a secondary CPU, called by start.S on its own stack
+ * 
+ * @param cpu Bring-up data of the CPU
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void smp_secondary_main(smp_cpu_t* cpu);
+
+#endif
@@ -4,7 +4,7 @@
  *
  * Author: Fedi Nabli
  * Date: 26 Mar 2025
- * Last Modified: 26 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_STRING_H_
@@ -145,4 +145,29 @@ bool isdigit(char c);
  */
 int tonumericdigit(char c);
 
+/**
+ * @brief Convert a number to a decimal string for UART output
+ * 
+ * @param value Number to convert
+ * @return char* String in a buffer of the calling CPU, valid until its
+ * next conversion
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+char* uint_to_str(uint64_t value);
+
+/**
+ * @brief Convert a number to a hex string with a 0x prefix and no leading
+ * zeros for UART output
+ * 
+ * @param value Number to convert
+ * @return char* String in a buffer of the calling CPU, valid until its
+ * next conversion
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+char* uint_to_hex(uint64_t value);
+
 #endif
\ No newline at end of file
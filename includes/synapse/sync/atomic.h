@@ -0,0 +1,437 @@
+/*
+ * atomic.h - This file defines the kernel atomic operations: acquire
+ * loads, release stores, compare-and-swap, fetch-add and exchange on
+ * 32-bit and 64-bit words, a relaxed add for per-CPU counters, plus the
+ * barriers and event hints used by the locks. ARMv8.0 cores (Cortex-A53)
+ * use load/store exclusive loops, building with LSE=1 (-DSYNAPSE_LSE)
+ * switches to the ARMv8.1 CAS, LDADD and SWP instructions, which need a
+ * core that has them.
+ *
+ * Read-modify-write operations are acquire-release, except the relaxed
+ * add. Exclusives work on any memory under QEMU, silicon needs cacheable
+ * normal memory (MMU on).
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_SYNC_ATOMIC_H_
+#define __SYNAPSE_SYNC_ATOMIC_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#ifdef SYNAPSE_LSE
+#define ATOMIC_LSE_ENABLED true
+#else
+#define ATOMIC_LSE_ENABLED false
+#endif
+
+/**
+ * @brief Full barrier between the CPUs of the inner shareable domain
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void smp_mb()
+{
+  __asm__ volatile("dmb ish" ::: "memory");
+}
+
+/**
+ * @brief Order earlier loads before later loads and stores
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void smp_rmb()
+{
+  __asm__ volatile("dmb ishld" ::: "memory");
+}
+
+/**
+ * @brief Order earlier stores before later stores
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void smp_wmb()
+{
+  __asm__ volatile("dmb ishst" ::: "memory");
+}
+
+/**
+ * @brief Hint that the CPU is spinning
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void cpu_relax()
+{
+  __asm__ volatile("yield" ::: "memory");
+}
+
+/**
+ * @brief Sleep until an event, a store to a word armed by
+ * atomic_load_exclusive_32/64() or an interrupt
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void cpu_wait_event()
+{
+  __asm__ volatile("wfe" ::: "memory");
+}
+
+/**
+ * @brief Wake every CPU sleeping in cpu_wait_event()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void cpu_send_event()
+{
+  __asm__ volatile("dsb ish\n\tsev" ::: "memory");
+}
+
+/**
+ * @brief Load with acquire ordering
+ * 
+ * @param ptr Word
+ * @return uint32_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint32_t atomic_load_acquire_32(const volatile uint32_t* ptr)
+{
+  uint32_t value;
+  __asm__ volatile("ldar %w0, %1" : "=r" (value) : "Q" (*ptr) : "memory");
+  return value;
+}
+
+/**
+ * @brief Load with acquire ordering
+ * 
+ * @param ptr Word
+ * @return uint64_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t atomic_load_acquire_64(const volatile uint64_t* ptr)
+{
+  uint64_t value;
+  __asm__ volatile("ldar %0, %1" : "=r" (value) : "Q" (*ptr) : "memory");
+  return value;
+}
+
+/**
+ * @brief Store with release ordering
+ * 
+ * @param ptr Word
+ * @param value Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void atomic_store_release_32(volatile uint32_t* ptr, uint32_t value)
+{
+  __asm__ volatile("stlr %w1, %0" : "=Q" (*ptr) : "r" (value) : "memory");
+}
+
+/**
+ * @brief Store with release ordering
+ * 
+ * @param ptr Word
+ * @param value Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void atomic_store_release_64(volatile uint64_t* ptr, uint64_t value)
+{
+  __asm__ volatile("stlr %1, %0" : "=Q" (*ptr) : "r" (value) : "memory");
+}
+
+/**
+ * @brief Acquire load that also arms the exclusive monitor, a store by
+ * another CPU to the word then wakes cpu_wait_event()
+ * 
+ * @param ptr Word
+ * @return uint32_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint32_t atomic_load_exclusive_32(const volatile uint32_t* ptr)
+{
+  uint32_t value;
+  __asm__ volatile("ldaxr %w0, %1" : "=r" (value) : "Q" (*ptr) : "memory");
+  return value;
+}
+
+/**
+ * @brief Acquire load that also arms the exclusive monitor, a store by
+ * another CPU to the word then wakes cpu_wait_event()
+ * 
+ * @param ptr Word
+ * @return uint64_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t atomic_load_exclusive_64(const volatile uint64_t* ptr)
+{
+  uint64_t value;
+  __asm__ volatile("ldaxr %0, %1" : "=r" (value) : "Q" (*ptr) : "memory");
+  return value;
+}
+
+/**
+ * @brief Compare-and-swap
+ * 
+ * @param ptr Word
+ * @param expected Value the word must hold
+ * @param desired Value stored if it does
+ * @return uint32_t Previous value, the swap happened if it equals expected
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint32_t atomic_cas_32(volatile uint32_t* ptr, uint32_t expected, uint32_t desired)
+{
+#ifdef SYNAPSE_LSE
+  __asm__ volatile(".arch_extension lse\n\t"
+                   "casal %w0, %w2, %1"
+                   : "+r" (expected), "+Q" (*ptr)
+                   : "r" (desired)
+                   : "memory");
+  return expected;
+#else
+  uint32_t old;
+  uint32_t failed;
+  __asm__ volatile("1: ldaxr %w0, %2\n\t"
+                   "cmp %w0, %w3\n\t"
+                   "b.ne 2f\n\t"
+                   "stlxr %w1, %w4, %2\n\t"
+                   "cbnz %w1, 1b\n"
+                   "2:"
+                   : "=&r" (old), "=&r" (failed), "+Q" (*ptr)
+                   : "r" (expected), "r" (desired)
+                   : "cc", "memory");
+  return old;
+#endif
+}
+
+/**
+ * @brief Compare-and-swap
+ * 
+ * @param ptr Word
+ * @param expected Value the word must hold
+ * @param desired Value stored if it does
+ * @return uint64_t Previous value, the swap happened if it equals expected
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t atomic_cas_64(volatile uint64_t* ptr, uint64_t expected, uint64_t desired)
+{
+#ifdef SYNAPSE_LSE
+  __asm__ volatile(".arch_extension lse\n\t"
+                   "casal %0, %2, %1"
+                   : "+r" (expected), "+Q" (*ptr)
+                   : "r" (desired)
+                   : "memory");
+  return expected;
+#else
+  uint64_t old;
+  uint32_t failed;
+  __asm__ volatile("1: ldaxr %0, %2\n\t"
+                   "cmp %0, %3\n\t"
+                   "b.ne 2f\n\t"
+                   "stlxr %w1, %4, %2\n\t"
+                   "cbnz %w1, 1b\n"
+                   "2:"
+                   : "=&r" (old), "=&r" (failed), "+Q" (*ptr)
+                   : "r" (expected), "r" (desired)
+                   : "cc", "memory");
+  return old;
+#endif
+}
+
+/**
+ * @brief Add to a word
+ * 
+ * @param ptr Word
+ * @param value Value added, (uint32_t)-n subtracts n
+ * @return uint32_t Previous value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint32_t atomic_fetch_add_32(volatile uint32_t* ptr, uint32_t value)
+{
+  uint32_t old;
+#ifdef SYNAPSE_LSE
+  __asm__ volatile(".arch_extension lse\n\t"
+                   "ldaddal %w2, %w0, %1"
+                   : "=r" (old), "+Q" (*ptr)
+                   : "r" (value)
+                   : "memory");
+#else
+  uint32_t sum;
+  uint32_t failed;
+  __asm__ volatile("1: ldaxr %w0, %3\n\t"
+                   "add %w1, %w0, %w4\n\t"
+                   "stlxr %w2, %w1, %3\n\t"
+                   "cbnz %w2, 1b"
+                   : "=&r" (old), "=&r" (sum), "=&r" (failed), "+Q" (*ptr)
+                   : "r" (value)
+                   : "memory");
+#endif
+  return old;
+}
+
+/**
+ * @brief Add to a word
+ * 
+ * @param ptr Word
+ * @param value Value added, (uint64_t)-n subtracts n
+ * @return uint64_t Previous value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t atomic_fetch_add_64(volatile uint64_t* ptr, uint64_t value)
+{
+  uint64_t old;
+#ifdef SYNAPSE_LSE
+  __asm__ volatile(".arch_extension lse\n\t"
+                   "ldaddal %2, %0, %1"
+                   : "=r" (old), "+Q" (*ptr)
+                   : "r" (value)
+                   : "memory");
+#else
+  uint64_t sum;
+  uint32_t failed;
+  __asm__ volatile("1: ldaxr %0, %3\n\t"
+                   "add %1, %0, %4\n\t"
+                   "stlxr %w2, %1, %3\n\t"
+                   "cbnz %w2, 1b"
+                   : "=&r" (old), "=&r" (sum), "=&r" (failed), "+Q" (*ptr)
+                   : "r" (value)
+                   : "memory");
+#endif
+  return old;
+}
+
+/**
+ * @brief Swap a word with a new value
+ * 
+ * @param ptr Word
+ * @param value Value stored
+ * @return uint32_t Previous value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint32_t atomic_xchg_32(volatile uint32_t* ptr, uint32_t value)
+{
+  uint32_t old;
+#ifdef SYNAPSE_LSE
+  __asm__ volatile(".arch_extension lse\n\t"
+                   "swpal %w2, %w0, %1"
+                   : "=r" (old), "+Q" (*ptr)
+                   : "r" (value)
+                   : "memory");
+#else
+  uint32_t failed;
+  __asm__ volatile("1: ldaxr %w0, %2\n\t"
+                   "stlxr %w1, %w3, %2\n\t"
+                   "cbnz %w1, 1b"
+                   : "=&r" (old), "=&r" (failed), "+Q" (*ptr)
+                   : "r" (value)
+                   : "memory");
+#endif
+  return old;
+}
+
+/**
+ * @brief Swap a word with a new value
+ * 
+ * @param ptr Word
+ * @param value Value stored
+ * @return uint64_t Previous value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t atomic_xchg_64(volatile uint64_t* ptr, uint64_t value)
+{
+  uint64_t old;
+#ifdef SYNAPSE_LSE
+  __asm__ volatile(".arch_extension lse\n\t"
+                   "swpal %2, %0, %1"
+                   : "=r" (old), "+Q" (*ptr)
+                   : "r" (value)
+                   : "memory");
+#else
+  uint32_t failed;
+  __asm__ volatile("1: ldaxr %0, %2\n\t"
+                   "stlxr %w1, %3, %2\n\t"
+                   "cbnz %w1, 1b"
+                   : "=&r" (old), "=&r" (failed), "+Q" (*ptr)
+                   : "r" (value)
+                   : "memory");
+#endif
+  return old;
+}
+
+/**
+ * @brief Add to a word without ordering, for words written by a single
+ * CPU (per-CPU counters), still exact if an IRQ or another CPU interleaves
+ * 
+ * @param ptr Word
+ * @param value Value added
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void atomic_add_relaxed_64(volatile uint64_t* ptr, uint64_t value)
+{
+#ifdef SYNAPSE_LSE
+  __asm__ volatile(".arch_extension lse\n\t"
+                   "stadd %1, %0"
+                   : "+Q" (*ptr)
+                   : "r" (value));
+#else
+  uint64_t sum;
+  uint32_t failed;
+  __asm__ volatile("1: ldxr %0, %2\n\t"
+                   "add %0, %0, %3\n\t"
+                   "stxr %w1, %0, %2\n\t"
+                   "cbnz %w1, 1b"
+                   : "=&r" (sum), "=&r" (failed), "+Q" (*ptr)
+                   : "r" (value));
+#endif
+}
+
+/**
+ * @brief Check if the CPU implements the LSE atomics
+ * (ID_AA64ISAR0_EL1.Atomic), required by a LSE=1 build
+ * 
+ * @return bool true if CAS, LDADD and SWP are available
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool atomic_lse_supported()
+{
+  uint64_t isar0;
+  __asm__ volatile("mrs %0, id_aa64isar0_el1" : "=r" (isar0));
+  return ((isar0 >> 20) & 0xF) >= 2;
+}
+
+#endif
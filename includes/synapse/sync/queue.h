@@ -0,0 +1,442 @@
+/*
+ * queue.h - This file defines the lock-free queues of the kernel, all
+ * header-only and working on storage given by the caller:
+ *
+ * - spsc_ring_t: bounded ring for one producer and one consumer. Each side
+ *   owns its index on its own cache line and keeps a copy of the other
+ *   index, so the shared lines only move when the ring looks full or empty.
+ * - mpsc_queue_t: unbounded intrusive list for many producers and one
+ *   consumer (Vyukov). Pushing is one exchange, nodes are embedded in the
+ *   objects queued, nothing is allocated.
+ * - mpmc_ring_t: bounded ring for many producers and many consumers
+ *   (Vyukov). Every cell carries a sequence telling which lap of the ring
+ *   may use it next, both ends claim a position with a compare-and-swap.
+ *
+ * None of them sleeps or masks IRQs. A handler may push to a queue its CPU
+ * also pushes to outside of it, except for the single-producer ring.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_SYNC_QUEUE_H_
+#define __SYNAPSE_SYNC_QUEUE_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+#include <synapse/status.h>
+
+#include <kernel/config.h>
+#include <synapse/sync/atomic.h>
+
+// Bounded single-producer single-consumer ring
+typedef struct
+{
+  void** slots;
+  uint64_t mask; // Capacity - 1
+
+  // Producer line
+  volatile uint64_t tail __attribute__((aligned(CACHE_LINE_SIZE)));
+  uint64_t head_cache; // Last head seen by the producer
+
+  // Consumer line
+  volatile uint64_t head __attribute__((aligned(CACHE_LINE_SIZE)));
+  uint64_t tail_cache; // Last tail seen by the consumer
+} __attribute__((aligned(CACHE_LINE_SIZE))) spsc_ring_t;
+
+// Link embedded in the objects of a MPSC queue
+typedef struct mpsc_node
+{
+  struct mpsc_node* volatile next;
+} mpsc_node_t;
+
+// Unbounded multi-producer single-consumer intrusive queue
+typedef struct
+{
+  // Producer line, swapped by every push
+  mpsc_node_t* volatile tail __attribute__((aligned(CACHE_LINE_SIZE)));
+
+  // Consumer line
+  mpsc_node_t* head __attribute__((aligned(CACHE_LINE_SIZE)));
+  mpsc_node_t stub; // Queued when the last node is taken
+} __attribute__((aligned(CACHE_LINE_SIZE))) mpsc_queue_t;
+
+// Cell of a MPMC ring
+typedef struct
+{
+  volatile uint64_t seq; // Position allowed to use the cell next
+  void* data;
+} mpmc_cell_t;
+
+// Bounded multi-producer multi-consumer ring
+typedef struct
+{
+  mpmc_cell_t* cells;
+  uint64_t mask; // Capacity - 1
+
+  volatile uint64_t enqueue_pos __attribute__((aligned(CACHE_LINE_SIZE)));
+  volatile uint64_t dequeue_pos __attribute__((aligned(CACHE_LINE_SIZE)));
+} __attribute__((aligned(CACHE_LINE_SIZE))) mpmc_ring_t;
+
+/**
+ * @brief Initialize an empty SPSC ring
+ * 
+ * @param ring Ring
+ * @param slots Storage of capacity pointers
+ * @param capacity Slots, a power of two
+ * @return int EOK on success, -EINVARG on a bad argument
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline int spsc_ring_init(spsc_ring_t* ring, void** slots, uint64_t capacity)
+{
+  if (!ring || !slots || capacity == 0 || (capacity & (capacity - 1)) != 0)
+  {
+    return -EINVARG;
+  }
+
+  ring->slots = slots;
+  ring->mask = capacity - 1;
+  ring->tail = 0;
+  ring->head_cache = 0;
+  ring->head = 0;
+  ring->tail_cache = 0;
+
+  return EOK;
+}
+
+/**
+ * @brief Add an item at the tail, from the producer only
+ * 
+ * @param ring Ring
+ * @param item Item
+ * @return bool true if added, false if the ring is full
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool spsc_ring_push(spsc_ring_t* ring, void* item)
+{
+  uint64_t tail = ring->tail;
+
+  if (tail - ring->head_cache > ring->mask)
+  {
+    // Looks full, the consumer may have moved since
+    ring->head_cache = atomic_load_acquire_64(&ring->head);
+    if (tail - ring->head_cache > ring->mask)
+    {
+      return false;
+    }
+  }
+
+  ring->slots[tail & ring->mask] = item;
+  atomic_store_release_64(&ring->tail, tail + 1);
+
+  return true;
+}
+
+/**
+ * @brief Take the item at the head, from the consumer only
+ * 
+ * @param ring Ring
+ * @param item Set to the item
+ * @return bool true if taken, false if the ring is empty
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool spsc_ring_pop(spsc_ring_t* ring, void** item)
+{
+  uint64_t head = ring->head;
+
+  if (head == ring->tail_cache)
+  {
+    // Looks empty, the producer may have moved since
+    ring->tail_cache = atomic_load_acquire_64(&ring->tail);
+    if (head == ring->tail_cache)
+    {
+      return false;
+    }
+  }
+
+  *item = ring->slots[head & ring->mask];
+  // The slot is read before the producer may reuse it
+  atomic_store_release_64(&ring->head, head + 1);
+
+  return true;
+}
+
+/**
+ * @brief Count the items of a SPSC ring, exact only when neither side
+ * is running
+ * 
+ * @param ring Ring
+ * @return uint64_t Items queued
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t spsc_ring_count(spsc_ring_t* ring)
+{
+  uint64_t head = atomic_load_acquire_64(&ring->head);
+  return atomic_load_acquire_64(&ring->tail) - head;
+}
+
+/**
+ * @brief Initialize an empty MPSC queue
+ * 
+ * @param queue Queue
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void mpsc_queue_init(mpsc_queue_t* queue)
+{
+  queue->stub.next = NULL;
+  queue->head = &queue->stub;
+  atomic_store_release_64((volatile uint64_t*)&queue->tail, (uint64_t)(uintptr_t)&queue->stub);
+}
+
+/**
+ * @brief Add a node at the tail, from any CPU or IRQ handler
+ * 
+ * @param queue Queue
+ * @param node Node, not queued anywhere
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void mpsc_queue_push(mpsc_queue_t* queue, mpsc_node_t* node)
+{
+  node->next = NULL;
+
+  // The exchange orders the producers, linking may lag behind it
+  mpsc_node_t* prev = (mpsc_node_t*)(uintptr_t)atomic_xchg_64((volatile uint64_t*)&queue->tail, (uint64_t)(uintptr_t)node);
+  atomic_store_release_64((volatile uint64_t*)&prev->next, (uint64_t)(uintptr_t)node);
+}
+
+/**
+ * @brief Take the node at the head, from the consumer only
+ * 
+ * @param queue Queue
+ * @return mpsc_node_t* Node, NULL if the queue is empty or a producer
+ * has swapped the tail but not linked its node yet
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline mpsc_node_t* mpsc_queue_pop(mpsc_queue_t* queue)
+{
+  mpsc_node_t* head = queue->head;
+  mpsc_node_t* next = (mpsc_node_t*)(uintptr_t)atomic_load_acquire_64((volatile uint64_t*)&head->next);
+
+  // Step over the stub
+  if (head == &queue->stub)
+  {
+    if (!next)
+    {
+      return NULL;
+    }
+
+    queue->head = next;
+    head = next;
+    next = (mpsc_node_t*)(uintptr_t)atomic_load_acquire_64((volatile uint64_t*)&head->next);
+  }
+
+  if (next)
+  {
+    queue->head = next;
+    return head;
+  }
+
+  // Head is the last node linked, unless a push is half done
+  mpsc_node_t* tail = (mpsc_node_t*)(uintptr_t)atomic_load_acquire_64((volatile uint64_t*)&queue->tail);
+  if (head != tail)
+  {
+    return NULL;
+  }
+
+  // Queue the stub behind it so the last node can leave
+  mpsc_queue_push(queue, &queue->stub);
+  next = (mpsc_node_t*)(uintptr_t)atomic_load_acquire_64((volatile uint64_t*)&head->next);
+  if (next)
+  {
+    queue->head = next;
+    return head;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Check if a MPSC queue is empty, from the consumer only
+ * 
+ * @param queue Queue
+ * @return bool true if no node is queued
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool mpsc_queue_empty(mpsc_queue_t* queue)
+{
+  return queue->head == &queue->stub &&
+         atomic_load_acquire_64((volatile uint64_t*)&queue->stub.next) == 0 &&
+         atomic_load_acquire_64((volatile uint64_t*)&queue->tail) == (uint64_t)(uintptr_t)&queue->stub;
+}
+
+/**
+ * @brief Initialize an empty MPMC ring
+ * 
+ * @param ring Ring
+ * @param cells Storage of capacity cells
+ * @param capacity Cells, a power of two of at least 2
+ * @return int EOK on success, -EINVARG on a bad argument
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline int mpmc_ring_init(mpmc_ring_t* ring, mpmc_cell_t* cells, uint64_t capacity)
+{
+  if (!ring || !cells || capacity < 2 || (capacity & (capacity - 1)) != 0)
+  {
+    return -EINVARG;
+  }
+
+  for (uint64_t i = 0; i < capacity; i++)
+  {
+    cells[i].seq = i;
+    cells[i].data = NULL;
+  }
+
+  ring->cells = cells;
+  ring->mask = capacity - 1;
+  ring->enqueue_pos = 0;
+  ring->dequeue_pos = 0;
+  smp_wmb();
+
+  return EOK;
+}
+
+/**
+ * @brief Add an item at the tail, from any CPU
+ * 
+ * @param ring Ring
+ * @param item Item
+ * @return bool true if added, false if the ring is full
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool mpmc_ring_push(mpmc_ring_t* ring, void* item)
+{
+  mpmc_cell_t* cell;
+  uint64_t pos = ring->enqueue_pos;
+
+  for (;;)
+  {
+    cell = &ring->cells[pos & ring->mask];
+    int64_t diff = (int64_t)(atomic_load_acquire_64(&cell->seq) - pos);
+
+    if (diff == 0)
+    {
+      // The cell is free for this lap, claim the position
+      uint64_t old = atomic_cas_64(&ring->enqueue_pos, pos, pos + 1);
+      if (old == pos)
+      {
+        break;
+      }
+      pos = old;
+    }
+    else if (diff < 0)
+    {
+      // The cell still holds the item of the previous lap
+      return false;
+    }
+    else
+    {
+      // Another producer took the position
+      pos = ring->enqueue_pos;
+    }
+  }
+
+  cell->data = item;
+  atomic_store_release_64(&cell->seq, pos + 1);
+
+  return true;
+}
+
+/**
+ * @brief Take the item at the head, from any CPU
+ * 
+ * @param ring Ring
+ * @param item Set to the item
+ * @return bool true if taken, false if the ring is empty
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool mpmc_ring_pop(mpmc_ring_t* ring, void** item)
+{
+  mpmc_cell_t* cell;
+  uint64_t pos = ring->dequeue_pos;
+
+  for (;;)
+  {
+    cell = &ring->cells[pos & ring->mask];
+    int64_t diff = (int64_t)(atomic_load_acquire_64(&cell->seq) - (pos + 1));
+
+    if (diff == 0)
+    {
+      // The cell holds the item of this lap, claim the position
+      uint64_t old = atomic_cas_64(&ring->dequeue_pos, pos, pos + 1);
+      if (old == pos)
+      {
+        break;
+      }
+      pos = old;
+    }
+    else if (diff < 0)
+    {
+      // No producer has filled the cell yet
+      return false;
+    }
+    else
+    {
+      // Another consumer took the position
+      pos = ring->dequeue_pos;
+    }
+  }
+
+  *item = cell->data;
+  // Hand the cell to the producers of the next lap
+  atomic_store_release_64(&cell->seq, pos + ring->mask + 1);
+
+  return true;
+}
+
+/**
+ * @brief Time the queues on 1 to all online CPUs, in cycles per item
+ * moved from a producer to a consumer
+ * 
+ * @return int EOK on success, -EFAULT if items were lost or duplicated
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int queue_benchmark();
+
+/**
+ * @brief Test the lock-free queues: capacity and order on one CPU, then
+ * producers and consumers on separate CPUs, where every item must be
+ * taken exactly once and in push order per producer
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int queue_test();
+
+#endif
@@ -0,0 +1,203 @@
+/*
+ * rcu.h - This file defines read-copy-update for read-mostly tables.
+ * Readers run between rcu_read_lock() and rcu_read_unlock() without
+ * writing any shared memory. Writers publish a new pointer with
+ * rcu_assign_pointer(), then wait with synchronize_rcu(), or queue a
+ * callback with call_rcu(), until every CPU has passed a quiescent state.
+ * Only then is the old version freed.
+ *
+ * A read section masks IRQs on its CPU, so the scheduler cannot switch
+ * tasks inside it, and it must not block. Quiescent states are IRQ entry,
+ * task switches, idle secondary CPUs and explicit rcu_quiescent_state()
+ * calls from long loops. An IRQ taken by an idle CPU brackets its
+ * handler with rcu_irq_enter() and rcu_irq_exit().
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_SYNC_RCU_H_
+#define __SYNAPSE_SYNC_RCU_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/smp/percpu.h>
+#include <synapse/sync/atomic.h>
+
+// Read section state of each CPU
+DECLARE_PER_CPU(uint32_t, rcu_nesting);
+DECLARE_PER_CPU(uint64_t, rcu_irq_flags); // DAIF saved by the outermost rcu_read_lock()
+
+// Load a pointer published with rcu_assign_pointer(), inside a read section
+#define rcu_dereference(p) (*(volatile __typeof__(p)*)&(p))
+
+// Publish a pointer, everything written to the new version before is visible first
+#define rcu_assign_pointer(p, v) \
+  atomic_store_release_64((volatile uint64_t*)&(p), (uint64_t)(uintptr_t)(v))
+
+struct rcu_head;
+
+// Callback run once the grace period of call_rcu() is over
+typedef void (*RCU_CALLBACK)(struct rcu_head* head);
+
+// Deferred reclamation request, embedded in the object it frees
+typedef struct rcu_head
+{
+  struct rcu_head* next;
+  RCU_CALLBACK func;
+  uint64_t gp_seq; // Grace period the callback waits for
+} rcu_head_t;
+
+/**
+ * @brief Enter a read section, sections nest
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void rcu_read_lock()
+{
+  uint64_t flags;
+  __asm__ volatile("mrs %0, daif\n\t"
+                   "msr daifset, #2"
+                   : "=r" (flags) :: "memory");
+
+  uint32_t* nesting = this_cpu_ptr(&rcu_nesting);
+  if ((*nesting)++ == 0)
+  {
+    this_cpu_write(rcu_irq_flags, flags);
+  }
+  __asm__ volatile("" ::: "memory");
+}
+
+/**
+ * @brief Leave a read section, the outermost one restores the IRQ state
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline void rcu_read_unlock()
+{
+  __asm__ volatile("" ::: "memory");
+  uint32_t* nesting = this_cpu_ptr(&rcu_nesting);
+  if (--(*nesting) == 0)
+  {
+    __asm__ volatile("msr daif, %0" :: "r" (this_cpu_read(rcu_irq_flags)) : "memory");
+  }
+}
+
+/**
+ * @brief Check if the calling CPU is inside a read section
+ * 
+ * @return bool true inside rcu_read_lock()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool rcu_read_lock_held()
+{
+  return this_cpu_read(rcu_nesting) != 0;
+}
+
+/**
+ * @brief Report a quiescent state of the calling CPU, ignored inside a
+ * read section
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_quiescent_state();
+
+/**
+ * @brief Note a task switch on the calling CPU: the outgoing context is
+ * abandoned, so are its read sections, which is a quiescent state
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_note_context_switch();
+
+/**
+ * @brief Mark the calling CPU idle, grace periods stop waiting for it
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_idle_enter();
+
+/**
+ * @brief Mark the calling CPU busy again, before it reads anything
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_idle_exit();
+
+/**
+ * @brief Leave idle for an IRQ taken while the CPU sleeps, its handler
+ * reads like any other code
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_irq_enter();
+
+/**
+ * @brief Go back to idle after an IRQ, if rcu_irq_enter() left it
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_irq_exit();
+
+/**
+ * @brief Wait until every read section running at the call has ended,
+ * must not be called inside a read section
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void synchronize_rcu();
+
+/**
+ * @brief Run a callback once every read section running at the call has
+ * ended, without waiting
+ * 
+ * @param head Request embedded in the object to reclaim
+ * @param func Callback, runs from the timer tick or rcu_barrier()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void call_rcu(rcu_head_t* head, RCU_CALLBACK func);
+
+/**
+ * @brief Run the queued callbacks whose grace period is over
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_process_callbacks();
+
+/**
+ * @brief Wait for a grace period and run every callback queued before
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rcu_barrier();
+
+/**
+ * @brief Test RCU: read sections nest and mask IRQs, grace periods end,
+ * callbacks run after rcu_barrier(), and readers on other CPUs never see
+ * an object reclaimed under them
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int rcu_test();
+
+#endif
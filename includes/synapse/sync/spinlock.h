@@ -0,0 +1,406 @@
+/*
+ * spinlock.h - This file defines the kernel locks, built on atomic.h:
+ *  - ticket spinlock, FIFO order, the default for short critical sections
+ *  - MCS queue lock, each waiter spins on its own node so a contended
+ *    hand-over only touches the next waiter's cache line
+ *  - reader-writer spinlock, readers share the lock, writers wait for
+ *    every reader to leave (readers are preferred)
+ * Waiters sleep in WFE until the lock word changes. The _irqsave variants
+ * also mask IRQs on the local CPU, needed for any lock an IRQ handler takes.
+ * A CPU holding a lock is not preempted (see preempt.h).
+ *
+ * Building with LOCK_STATS=1 (-DSYNAPSE_LOCK_STATS) counts acquisitions
+ * and contention per lock.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_SYNC_SPINLOCK_H_
+#define __SYNAPSE_SYNC_SPINLOCK_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+// Static initializers, every lock starts unlocked when zeroed
+#define SPINLOCK_INIT {0}
+#define MCS_LOCK_INIT {0}
+#define RWLOCK_INIT   {0}
+
+// Reader-writer lock word: writer bit, reader count below it
+#define RWLOCK_WRITER 0x80000000U
+
+// Contention statistics of one lock
+typedef struct
+{
+  uint64_t acquisitions;
+  uint64_t contended; // Acquisitions that had to wait
+  uint64_t spins;     // Wake-ups while waiting
+} lock_stats_t;
+
+// Ticket spinlock
+typedef struct
+{
+  volatile uint32_t next;  // Next ticket handed out
+  volatile uint32_t owner; // Ticket holding the lock
+#ifdef SYNAPSE_LOCK_STATS
+  lock_stats_t stats;
+#endif
+} spinlock_t;
+
+// MCS queue node, one per waiter, lives on the waiter's stack until unlock
+typedef struct mcs_node
+{
+  volatile uint64_t next;   // struct mcs_node* queued behind this one
+  volatile uint32_t locked; // Set by the previous holder on hand-over
+} mcs_node_t;
+
+// MCS queue lock
+typedef struct
+{
+  volatile uint64_t tail; // mcs_node_t* of the last waiter, 0 when free
+#ifdef SYNAPSE_LOCK_STATS
+  lock_stats_t stats;
+#endif
+} mcs_lock_t;
+
+// Reader-writer spinlock
+typedef struct
+{
+  volatile uint32_t value; // RWLOCK_WRITER, or the number of readers
+#ifdef SYNAPSE_LOCK_STATS
+  lock_stats_t stats;
+#endif
+} rwlock_t;
+
+/**
+ * @brief Initialize a ticket spinlock
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void spin_lock_init(spinlock_t* lock);
+
+/**
+ * @brief Take a ticket spinlock, waiters are served in arrival order
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void spin_lock(spinlock_t* lock);
+
+/**
+ * @brief Take a ticket spinlock if it is free
+ * 
+ * @param lock Lock
+ * @return bool true if the lock was taken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool spin_trylock(spinlock_t* lock);
+
+/**
+ * @brief Release a ticket spinlock
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void spin_unlock(spinlock_t* lock);
+
+/**
+ * @brief Check if a ticket spinlock is held
+ * 
+ * @param lock Lock
+ * @return bool true if held
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool spin_is_locked(spinlock_t* lock);
+
+/**
+ * @brief Mask IRQs on the local CPU, then take a ticket spinlock
+ * 
+ * @param lock Lock
+ * @return uint64_t Saved IRQ state for spin_unlock_irqrestore()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t spin_lock_irqsave(spinlock_t* lock);
+
+/**
+ * @brief Release a ticket spinlock, then restore the IRQ state
+ * 
+ * @param lock Lock
+ * @param flags Value returned by spin_lock_irqsave()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void spin_unlock_irqrestore(spinlock_t* lock, uint64_t flags);
+
+/**
+ * @brief Initialize a MCS queue lock
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void mcs_lock_init(mcs_lock_t* lock);
+
+/**
+ * @brief Take a MCS queue lock
+ * 
+ * @param lock Lock
+ * @param node Queue node of the caller, kept until mcs_unlock()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void mcs_lock(mcs_lock_t* lock, mcs_node_t* node);
+
+/**
+ * @brief Take a MCS queue lock if it is free
+ * 
+ * @param lock Lock
+ * @param node Queue node of the caller, kept until mcs_unlock()
+ * @return bool true if the lock was taken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool mcs_trylock(mcs_lock_t* lock, mcs_node_t* node);
+
+/**
+ * @brief Release a MCS queue lock, handing it to the next waiter
+ * 
+ * @param lock Lock
+ * @param node Node passed to mcs_lock()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void mcs_unlock(mcs_lock_t* lock, mcs_node_t* node);
+
+/**
+ * @brief Mask IRQs on the local CPU, then take a MCS queue lock
+ * 
+ * @param lock Lock
+ * @param node Queue node of the caller
+ * @return uint64_t Saved IRQ state for mcs_unlock_irqrestore()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t mcs_lock_irqsave(mcs_lock_t* lock, mcs_node_t* node);
+
+/**
+ * @brief Release a MCS queue lock, then restore the IRQ state
+ * 
+ * @param lock Lock
+ * @param node Node passed to mcs_lock_irqsave()
+ * @param flags Value returned by mcs_lock_irqsave()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void mcs_unlock_irqrestore(mcs_lock_t* lock, mcs_node_t* node, uint64_t flags);
+
+/**
+ * @brief Initialize a reader-writer spinlock
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void rwlock_init(rwlock_t* lock);
+
+/**
+ * @brief Take a reader-writer spinlock for reading
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void read_lock(rwlock_t* lock);
+
+/**
+ * @brief Take a reader-writer spinlock for reading if no writer holds it
+ * 
+ * @param lock Lock
+ * @return bool true if the lock was taken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool read_trylock(rwlock_t* lock);
+
+/**
+ * @brief Release a reader-writer spinlock taken for reading
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void read_unlock(rwlock_t* lock);
+
+/**
+ * @brief Take a reader-writer spinlock for writing
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void write_lock(rwlock_t* lock);
+
+/**
+ * @brief Take a reader-writer spinlock for writing if nobody holds it
+ * 
+ * @param lock Lock
+ * @return bool true if the lock was taken
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool write_trylock(rwlock_t* lock);
+
+/**
+ * @brief Release a reader-writer spinlock taken for writing
+ * 
+ * @param lock Lock
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void write_unlock(rwlock_t* lock);
+
+/**
+ * @brief Mask IRQs on the local CPU, then take a reader-writer spinlock
+ * for reading
+ * 
+ * @param lock Lock
+ * @return uint64_t Saved IRQ state for read_unlock_irqrestore()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t read_lock_irqsave(rwlock_t* lock);
+
+/**
+ * @brief Release a reader-writer spinlock taken for reading, then
+ * restore the IRQ state
+ * 
+ * @param lock Lock
+ * @param flags Value returned by read_lock_irqsave()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void read_unlock_irqrestore(rwlock_t* lock, uint64_t flags);
+
+/**
+ * @brief Mask IRQs on the local CPU, then take a reader-writer spinlock
+ * for writing
+ * 
+ * @param lock Lock
+ * @return uint64_t Saved IRQ state for write_unlock_irqrestore()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t write_lock_irqsave(rwlock_t* lock);
+
+/**
+ * @brief Release a reader-writer spinlock taken for writing, then
+ * restore the IRQ state
+ * 
+ * @param lock Lock
+ * @param flags Value returned by write_lock_irqsave()
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void write_unlock_irqrestore(rwlock_t* lock, uint64_t flags);
+
+/**
+ * @brief Get the statistics of a ticket spinlock
+ * 
+ * @param lock Lock
+ * @return const lock_stats_t* Statistics, NULL without LOCK_STATS=1
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const lock_stats_t* spin_lock_stats(spinlock_t* lock);
+
+/**
+ * @brief Get the statistics of a MCS queue lock
+ * 
+ * @param lock Lock
+ * @return const lock_stats_t* Statistics, NULL without LOCK_STATS=1
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const lock_stats_t* mcs_lock_stats(mcs_lock_t* lock);
+
+/**
+ * @brief Get the statistics of a reader-writer spinlock
+ * 
+ * @param lock Lock
+ * @return const lock_stats_t* Statistics, NULL without LOCK_STATS=1
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+const lock_stats_t* rwlock_stats(rwlock_t* lock);
+
+/**
+ * @brief Print the statistics of a lock
+ * 
+ * @param name Lock name
+ * @param stats Statistics, nothing is printed if NULL
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void lock_stats_print(const char* name, const lock_stats_t* stats);
+
+/**
+ * @brief Time a contended counter update under every lock on 1 to all
+ * online CPUs, against a per-CPU counter and a plain atomic fetch-add
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int spinlock_benchmark();
+
+/**
+ * @brief Test the atomics and locks: results of every atomic operation,
+ * trylock exclusion rules, IRQ mask save and restore, and lost updates
+ * of a counter shared by every online CPU
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int spinlock_test();
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * kthread.h - This file defines kernel threads: a function run as a
+ * schedulable EL1 task with a small stack of its own, without the process,
+ * program copy and allocation table a kernel process carries. Threads may
+ * be pinned to a CPU and are asked to stop with kthread_stop(), which they
+ * notice by polling kthread_should_stop().
+ *
+ * Only the boot CPU runs the scheduler so far. A thread pinned to a
+ * secondary is accepted and counted by kthread_rt_cpu_mask(), but it does
+ * not run until that CPU schedules tasks.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_TASK_KTHREAD_H_
+#define __SYNAPSE_TASK_KTHREAD_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/task/task.h>
+
+/* Kernel thread run states */
+#define KTHREAD_CREATED 0 // Not started yet
+#define KTHREAD_RUNNING 1
+#define KTHREAD_EXITED  2 // Function returned, or stopped before it started
+
+// Function run by a kernel thread, its result is returned by kthread_stop()
+typedef int (*KTHREAD_FUNCTION)(void* arg);
+
+struct kthread
+{
+  struct task* task;
+  KTHREAD_FUNCTION function;
+  void* arg;
+  void* stack;
+
+  volatile uint32_t run_state;
+  volatile uint32_t should_stop;
+  int result;
+};
+
+/**
+ * @brief Create a kernel thread, ready to be scheduled
+ * 
+ * @param function Function to run
+ * @param arg Argument of the function
+ * @param priority TASK_PRIORITY_LOW threads only run when nothing else is
+ * ready, TASK_PRIORITY_NORMAL ones take turns with processes and
+ * TASK_PRIORITY_HIGH ones run first
+ * @param cpu CPU to run on, below smp_cpu_count(), TASK_CPU_ANY for any.
+ * A thread pinned to a secondary waits until that CPU schedules
+ * @return struct kthread* New thread, NULL on a bad argument, when out of
+ * memory or when SYNAPSE_MAX_KTHREADS threads exist
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+struct kthread* kthread_create(KTHREAD_FUNCTION function, void* arg, uint8_t priority, int32_t cpu);
+
+/**
+ * @brief Ask a thread to stop, wait for its function to return and free
+ * it. The caller must let the scheduler run, IRQs unmasked
+ * 
+ * @param thread Thread, not the calling one
+ * @return int Result of the function, -ENOTREADY if it never started,
+ * -EINVARG on a bad thread
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int kthread_stop(struct kthread* thread);
+
+/**
+ * @brief Check if the running thread was asked to stop
+ * 
+ * @return true If kthread_stop() was called on the running thread
+ * @return false Otherwise, or outside a kernel thread
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool kthread_should_stop();
+
+/**
+ * @brief Get the running kernel thread
+ * 
+ * @return struct kthread* Thread, NULL outside a kernel thread
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+struct kthread* kthread_current();
+
+/**
+ * @brief Pick the next ready thread the calling CPU may run, round robin
+ * 
+ * @param min_priority Lowest priority picked
+ * @return struct task* Task of the thread, NULL if none is ready
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+struct task* kthread_pick_next(uint8_t min_priority);
+
+/**
+ * @brief Get the CPUs running real-time threads: high priority threads
+ * pinned to a CPU
+ * 
+ * @return uint32_t Bit i set for CPU i
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t kthread_rt_cpu_mask();
+
+/**
+ * @brief Time thread creation and stopping, and compare the memory of a
+ * thread with the one of a kernel process
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int kthread_benchmark();
+
+/**
+ * @brief Test kernel threads: argument checks, the initial context, the
+ * picks of the scheduler with priorities and pinning, the real-time CPUs,
+ * the thread limit, and stopping threads that never started
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int kthread_test();
+
+#endif
@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 31 Mar 2025
- * Last Modified: 31 Mar 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_TASK_TASK_H_
@@ -13,6 +13,7 @@
 #include <synapse/types.h>
 
 struct process;
+struct kthread;
 struct interrupt_frame;
 
 /* Task States */
@@ -27,6 +28,9 @@ struct interrupt_frame;
 #define TASK_PRIORITY_NORMAL  1
 #define TASK_PRIORITY_HIGH    2
 
+/* Task not pinned to a CPU */
+#define TASK_CPU_ANY (-1)
+
 /* Task structures  */
 struct task_registers
 {
@@ -67,6 +71,11 @@ struct task_registers
   reg_t pc; // Program counter
   reg_t spsr_el1; // Save Program Status Register for EL1
   reg_t elr_el1; // Exception Link register for EL1
+
+  // FP/SIMD state
+  reg_t fpsr;
+  reg_t fpcr;
+  reg_t fp_regs[64]; // q0-q31, low word first
 };
 
 struct task
@@ -83,6 +92,9 @@ struct task
   struct process* process; // Owning process
   struct task* next;
   struct task* prev;
+
+  struct kthread* kthread; // Kernel thread run by the task, NULL for processes
+  int32_t cpu; // CPU the task is pinned to, TASK_CPU_ANY if none
 };
 
 // Task context assembly functions
@@ -109,6 +121,22 @@ struct task* task_current();
  */
 struct task* task_new(uint8_t task_priority);
 
+/**
+ * @brief Check if a task may run on a CPU
+ * 
+ * @param task Task
+ * @param cpu CPU index
+ * @return true If the task is pinned to the CPU or not pinned at all
+ * @return false If the task is pinned to another CPU
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline bool task_runs_on(const struct task* task, uint32_t cpu)
+{
+  return task->cpu == TASK_CPU_ANY || task->cpu == (int32_t)cpu;
+}
+
 /**
  * @brief Free task and remove from list
  * 
@@ -153,6 +181,16 @@ int task_current_save_state();
  */
 int task_switch(struct task* task);
 
+/**
+ * @brief Get the number of task switches, summed over every CPU
+ * 
+ * @return uint64_t Task switches
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t task_get_switch_count();
+
 /**
  * @brief Schedule next task to run
  * 
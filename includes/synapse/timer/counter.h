@@ -0,0 +1,62 @@
+/*
+ * counter.h - This file defines the reads of the generic timer counter
+ * used to time boot steps, benchmarks and statistics
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_TIMER_COUNTER_H_
+#define __SYNAPSE_TIMER_COUNTER_H_
+
+#include <synapse/types.h>
+
+/**
+ * @brief Read the counter of the generic timer, after the instructions
+ * before it have completed
+ * 
+ * @return uint64_t Counter value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t timer_read_counter()
+{
+  uint64_t value;
+  __asm__ volatile("isb; mrs %0, cntpct_el0" : "=r" (value));
+  return value;
+}
+
+/**
+ * @brief Read the counter of the generic timer without a barrier, for
+ * timestamps on hot paths where a few instructions of skew do not matter
+ * 
+ * @return uint64_t Counter value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t timer_read_counter_relaxed()
+{
+  uint64_t value;
+  __asm__ volatile("mrs %0, cntpct_el0" : "=r" (value));
+  return value;
+}
+
+/**
+ * @brief Read the frequency of the generic timer
+ * 
+ * @return uint64_t Frequency in Hz
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+static inline uint64_t timer_read_frequency()
+{
+  uint64_t value;
+  __asm__ volatile("mrs %0, cntfrq_el0" : "=r" (value));
+  return value;
+}
+
+#endif
@@ -3,7 +3,7 @@
  *
  * Author: Fedi Nabli
  * Date: 8 Apr 2025
- * Last Modified: 8 Apr 2025
+ * Last Modified: 18 Oct 2026
  */
 
 #ifndef __SYNAPSE_TIMER_H_
@@ -18,7 +18,7 @@
 * ARM Generic Timer registers
 * These are accessed via system registers in AArch64
 */
-// Timer IRQ number in GIC
+// Timer IRQ number in GIC without a device tree
 #define TIMER_IRQ 30 // PPI Interrupt
  
 // Timer management functions
@@ -97,7 +97,7 @@ int timer_enable();
 int timer_disable();
 
 /**
-* @brief Get the number of timer ticks
+* @brief Get the number of timer ticks of the calling CPU
 * 
 * @return uint64_t Current tick cout
 * 
@@ -116,4 +116,14 @@ uint64_t timer_get_ticks();
 */
 uint64_t timer_get_ms();
 
+/**
+* @brief Get the interrupt of the non-secure physical timer
+* 
+* @return uint32_t PPI interrupt ID, from the device tree
+* 
+* @author Fedi Nabli
+* @date 18 Oct 2026
+*/
+uint32_t timer_get_irq();
+
 #endif
\ No newline at end of file
@@ -0,0 +1,343 @@
+/*
+ * virtio.h - This file defines the virtio-mmio transport and the
+ * split virtqueues shared by the virtio device drivers
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_VIRTIO_H_
+#define __SYNAPSE_VIRTIO_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+// Most virtio-mmio transports, they come from the device tree
+#define VIRTIO_MMIO_SLOTS 32
+
+// virtio-mmio registers
+#define VIRTIO_MMIO_MAGIC_VALUE         0x000
+#define VIRTIO_MMIO_VERSION             0x004
+#define VIRTIO_MMIO_DEVICE_ID           0x008
+#define VIRTIO_MMIO_VENDOR_ID           0x00C
+#define VIRTIO_MMIO_DEVICE_FEATURES     0x010
+#define VIRTIO_MMIO_DEVICE_FEATURES_SEL 0x014
+#define VIRTIO_MMIO_DRIVER_FEATURES     0x020
+#define VIRTIO_MMIO_DRIVER_FEATURES_SEL 0x024
+#define VIRTIO_MMIO_GUEST_PAGE_SIZE     0x028 // Legacy only
+#define VIRTIO_MMIO_QUEUE_SEL           0x030
+#define VIRTIO_MMIO_QUEUE_NUM_MAX       0x034
+#define VIRTIO_MMIO_QUEUE_NUM           0x038
+#define VIRTIO_MMIO_QUEUE_ALIGN         0x03C // Legacy only
+#define VIRTIO_MMIO_QUEUE_PFN           0x040 // Legacy only
+#define VIRTIO_MMIO_QUEUE_READY         0x044
+#define VIRTIO_MMIO_QUEUE_NOTIFY        0x050
+#define VIRTIO_MMIO_INTERRUPT_STATUS    0x060
+#define VIRTIO_MMIO_INTERRUPT_ACK       0x064
+#define VIRTIO_MMIO_STATUS              0x070
+#define VIRTIO_MMIO_QUEUE_DESC_LOW      0x080
+#define VIRTIO_MMIO_QUEUE_DESC_HIGH     0x084
+#define VIRTIO_MMIO_QUEUE_DRIVER_LOW    0x090
+#define VIRTIO_MMIO_QUEUE_DRIVER_HIGH   0x094
+#define VIRTIO_MMIO_QUEUE_DEVICE_LOW    0x0A0
+#define VIRTIO_MMIO_QUEUE_DEVICE_HIGH   0x0A4
+#define VIRTIO_MMIO_CONFIG_GENERATION   0x0FC
+#define VIRTIO_MMIO_CONFIG              0x100
+
+#define VIRTIO_MMIO_MAGIC 0x74726976 // "virt"
+
+// Device status bits
+#define VIRTIO_STATUS_ACKNOWLEDGE 1
+#define VIRTIO_STATUS_DRIVER      2
+#define VIRTIO_STATUS_DRIVER_OK   4
+#define VIRTIO_STATUS_FEATURES_OK 8
+#define VIRTIO_STATUS_FAILED      128
+
+// Interrupt status bits
+#define VIRTIO_INTERRUPT_USED_RING 1
+#define VIRTIO_INTERRUPT_CONFIG    2
+
+// Device independent feature bits
+#define VIRTIO_F_VERSION_1 32
+
+// Device IDs
+#define VIRTIO_ID_BLOCK   2
+#define VIRTIO_ID_CONSOLE 3
+
+// Descriptor flags
+#define VIRTQ_DESC_F_NEXT  1 // Buffer continues in the next descriptor
+#define VIRTQ_DESC_F_WRITE 2 // Buffer is written by the device
+
+// Set by the device when it does not need to be notified
+#define VIRTQ_USED_F_NO_NOTIFY 1
+
+// Largest queue size used by the drivers
+#define VIRTQ_MAX_SIZE 128
+
+// Queue memory alignment (legacy devices take a page frame number)
+#define VIRTQ_ALIGN 4096
+
+struct virtq_desc
+{
+  uint64_t addr;  // Physical address of the buffer
+  uint32_t len;   // Length of the buffer
+  uint16_t flags; // VIRTQ_DESC_F_* flags
+  uint16_t next;  // Next descriptor of the chain
+};
+
+struct virtq_avail
+{
+  uint16_t flags;
+  uint16_t idx;    // Next free slot of the ring
+  uint16_t ring[]; // Heads of the chains offered to the device
+};
+
+struct virtq_used_elem
+{
+  uint32_t id;  // Head of the chain
+  uint32_t len; // Bytes written by the device
+};
+
+struct virtq_used
+{
+  uint16_t flags;
+  uint16_t idx; // Next slot the device will fill
+  struct virtq_used_elem ring[];
+};
+
+// A virtio-mmio device found on the bus
+typedef struct virtio_device
+{
+  uintptr_t base;     // MMIO base address
+  uint32_t version;   // 1 for legacy devices, 2 for virtio 1.0
+  uint32_t device_id; // VIRTIO_ID_* value
+  uint32_t irq;       // GIC interrupt ID
+  uint64_t features;  // Negotiated features
+  bool claimed;       // Bound to a driver
+} virtio_device_t;
+
+// One buffer of a descriptor chain
+typedef struct virtio_buf
+{
+  void* addr;         // Buffer address (identity mapped)
+  uint32_t len;       // Buffer length
+  bool device_writes; // true if the device writes the buffer
+} virtio_buf_t;
+
+// Split virtqueue
+typedef struct virtqueue
+{
+  virtio_device_t* dev;
+  uint32_t index;            // Queue index on the device
+  uint16_t size;             // Number of descriptors
+  struct virtq_desc* desc;   // Descriptor table
+  struct virtq_avail* avail; // Driver ring
+  struct virtq_used* used;   // Device ring
+  void* ring_memory;         // Allocation holding the three parts
+  uint16_t free_head;        // First free descriptor
+  uint16_t num_free;         // Number of free descriptors
+  uint16_t last_used;        // Next used ring slot to consume
+  void* cookies[VIRTQ_MAX_SIZE];    // Caller data per chain head
+  uint16_t chain_len[VIRTQ_MAX_SIZE]; // Descriptors per chain head
+} virtqueue_t;
+
+/**
+ * @brief Probe the virtio-mmio transports listed by the device tree
+ * 
+ * @return int Number of devices found, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_mmio_init();
+
+/**
+ * @brief Bind the first unclaimed device of a type to a driver
+ * 
+ * @param device_id VIRTIO_ID_* value
+ * @return virtio_device_t* Device, or NULL if none is left
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+virtio_device_t* virtio_mmio_claim(uint32_t device_id);
+
+/**
+ * @brief Reset a device, acknowledge it and negotiate features
+ * 
+ * @param dev Device
+ * @param driver_features Features understood by the driver
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_device_setup(virtio_device_t* dev, uint64_t driver_features);
+
+/**
+ * @brief Tell the device the driver is ready, after the queues are set up
+ * 
+ * @param dev Device
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtio_device_ready(virtio_device_t* dev);
+
+/**
+ * @brief Reset a device, stopping all queues
+ * 
+ * @param dev Device
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtio_device_reset(virtio_device_t* dev);
+
+/**
+ * @brief Acknowledge the pending interrupts of a device
+ * 
+ * @param dev Device
+ * @return uint32_t VIRTIO_INTERRUPT_* bits that were pending
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t virtio_device_ack_interrupt(virtio_device_t* dev);
+
+/**
+ * @brief Check if a feature was negotiated
+ * 
+ * @param dev Device
+ * @param bit Feature bit
+ * @return bool true if the feature is in use
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool virtio_device_has_feature(virtio_device_t* dev, uint32_t bit);
+
+/**
+ * @brief Read a byte of the device configuration space
+ * 
+ * @param dev Device
+ * @param offset Offset in the configuration space
+ * @return uint8_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint8_t virtio_config_read8(virtio_device_t* dev, uint32_t offset);
+
+/**
+ * @brief Read a 16-bit value of the device configuration space
+ * 
+ * @param dev Device
+ * @param offset Offset in the configuration space
+ * @return uint16_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint16_t virtio_config_read16(virtio_device_t* dev, uint32_t offset);
+
+/**
+ * @brief Read a 32-bit value of the device configuration space
+ * 
+ * @param dev Device
+ * @param offset Offset in the configuration space
+ * @return uint32_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint32_t virtio_config_read32(virtio_device_t* dev, uint32_t offset);
+
+/**
+ * @brief Read a 64-bit value of the device configuration space, retried
+ * until both halves come from the same configuration generation
+ * 
+ * @param dev Device
+ * @param offset Offset in the configuration space
+ * @return uint64_t Value
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t virtio_config_read64(virtio_device_t* dev, uint32_t offset);
+
+/**
+ * @brief Create a split virtqueue and hand it to the device
+ * 
+ * @param dev Device
+ * @param index Queue index
+ * @param max_size Upper bound on the queue size (VIRTQ_MAX_SIZE at most)
+ * @param out_vq Output for the queue
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtqueue_create(virtio_device_t* dev, uint32_t index, uint16_t max_size, virtqueue_t** out_vq);
+
+/**
+ * @brief Free a virtqueue, the device must be reset first
+ * 
+ * @param vq Queue
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtqueue_destroy(virtqueue_t* vq);
+
+/**
+ * @brief Offer a descriptor chain to the device, without notifying it
+ * 
+ * Buffers read by the device must come before the buffers it writes.
+ * 
+ * @param vq Queue
+ * @param bufs Buffers of the chain
+ * @param count Number of buffers
+ * @param cookie Caller data returned by virtqueue_get_used(), not NULL
+ * @return int EOK on success, -ENOMEM if the queue is full
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtqueue_add(virtqueue_t* vq, virtio_buf_t* bufs, uint16_t count, void* cookie);
+
+/**
+ * @brief Get the number of free descriptors
+ * 
+ * @param vq Queue
+ * @return uint16_t Free descriptors
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint16_t virtqueue_free_count(virtqueue_t* vq);
+
+/**
+ * @brief Notify the device of all chains added since the last kick
+ * 
+ * @param vq Queue
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtqueue_kick(virtqueue_t* vq);
+
+/**
+ * @brief Take the next chain completed by the device
+ * 
+ * @param vq Queue
+ * @param len Output for the bytes written by the device, may be NULL
+ * @return void* Cookie of the chain, NULL if nothing completed
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void* virtqueue_get_used(virtqueue_t* vq, uint32_t* len);
+
+#endif
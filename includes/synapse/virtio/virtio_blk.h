@@ -0,0 +1,240 @@
+/*
+ * virtio_blk.h - This file defines the virtio block device driver.
+ * Requests are queued, merged with their neighbours when their sectors
+ * are adjacent and completed asynchronously from the device interrupt.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_VIRTIO_BLK_H_
+#define __SYNAPSE_VIRTIO_BLK_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/interrupts/interrupt.h>
+#include <synapse/memory/ai_memory/ai_memory.h>
+
+#define VIRTIO_BLK_SECTOR_SIZE 512
+
+// Scatter-gather segments of one request
+#define VIRTIO_BLK_MAX_SEGMENTS 8
+
+// Device specific feature bits
+#define VIRTIO_BLK_F_SIZE_MAX 1 // Maximum size of a segment
+#define VIRTIO_BLK_F_SEG_MAX  2 // Maximum number of segments of a request
+#define VIRTIO_BLK_F_RO       5 // Device is read-only
+#define VIRTIO_BLK_F_FLUSH    9 // Cache flush command
+
+// Request types
+typedef enum
+{
+  VIRTIO_BLK_OP_READ = 0,
+  VIRTIO_BLK_OP_WRITE = 1,
+  VIRTIO_BLK_OP_FLUSH = 4
+} virtio_blk_op_t;
+
+// One buffer of a request, written to or read from in place
+typedef struct virtio_blk_segment
+{
+  void* addr;
+  uint32_t len;
+} virtio_blk_segment_t;
+
+struct virtio_blk_request;
+
+// Completion callback, called from the interrupt handler or the waiter with
+// the driver lock held: it must not submit, kick or wait
+typedef void (*VIRTIO_BLK_CALLBACK)(struct virtio_blk_request* req);
+
+// Block request, owned by the caller until it completes
+typedef struct virtio_blk_request
+{
+  virtio_blk_op_t op;
+  uint64_t sector; // First sector
+  virtio_blk_segment_t segments[VIRTIO_BLK_MAX_SEGMENTS];
+  uint32_t segment_count;
+  VIRTIO_BLK_CALLBACK callback; // May be NULL
+  void* private_data;
+  volatile bool done;
+  int result; // EOK or negative error code once done
+
+  // Driver private
+  struct virtio_blk_request* next;
+} virtio_blk_request_t;
+
+// Driver statistics
+typedef struct virtio_blk_stats
+{
+  uint64_t submitted;  // Requests submitted by callers
+  uint64_t issued;     // Requests sent to the device after merging
+  uint64_t merged;     // Requests merged into a neighbour
+  uint64_t completed;  // Requests completed
+  uint64_t interrupts; // Device interrupts handled
+  uint64_t bytes;      // Bytes transferred
+} virtio_blk_stats_t;
+
+/**
+ * @brief Find the first virtio block device and set it up
+ * 
+ * @return int EOK on success, -ENOENT if there is no device,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_init();
+
+/**
+ * @brief Check if a block device is ready
+ * 
+ * @return bool true if virtio_blk_init() succeeded
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool virtio_blk_present();
+
+/**
+ * @brief Get the capacity of the device
+ * 
+ * @return uint64_t Number of sectors
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+uint64_t virtio_blk_get_capacity();
+
+/**
+ * @brief Prepare a request with a single buffer
+ * 
+ * @param req Request
+ * @param op Request type
+ * @param sector First sector
+ * @param buffer Buffer, used in place
+ * @param size Size in bytes (multiple of the sector size)
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_request_init(virtio_blk_request_t* req, virtio_blk_op_t op, uint64_t sector, void* buffer, size_t size);
+
+/**
+ * @brief Add a buffer to a request
+ * 
+ * @param req Request
+ * @param buffer Buffer, used in place
+ * @param size Size in bytes
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_request_add_segment(virtio_blk_request_t* req, void* buffer, size_t size);
+
+/**
+ * @brief Prepare a request transferring straight into or out of a tensor
+ * 
+ * @param req Request
+ * @param op VIRTIO_BLK_OP_READ or VIRTIO_BLK_OP_WRITE
+ * @param sector First sector
+ * @param tensor Dense tensor whose size is a multiple of the sector size
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_request_tensor(virtio_blk_request_t* req, virtio_blk_op_t op, uint64_t sector, tensor_t* tensor);
+
+/**
+ * @brief Queue a request, it is sent to the device by virtio_blk_kick()
+ * 
+ * @param req Prepared request
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_submit(virtio_blk_request_t* req);
+
+/**
+ * @brief Merge the queued requests and send as many as fit to the device
+ * with a single notification
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtio_blk_kick();
+
+/**
+ * @brief Wait for a request to complete
+ * 
+ * @param req Submitted request
+ * @return int Result of the request
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_wait(virtio_blk_request_t* req);
+
+/**
+ * @brief Read sectors synchronously
+ * 
+ * @param sector First sector
+ * @param buffer Destination
+ * @param size Size in bytes (multiple of the sector size)
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_read(uint64_t sector, void* buffer, size_t size);
+
+/**
+ * @brief Write sectors synchronously
+ * 
+ * @param sector First sector
+ * @param buffer Source
+ * @param size Size in bytes (multiple of the sector size)
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_write(uint64_t sector, void* buffer, size_t size);
+
+/**
+ * @brief Block device interrupt handler
+ * 
+ * @param int_frame Interrupt frame
+ * @return int Handler result
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_irq_handler(struct interrupt_frame* int_frame);
+
+/**
+ * @brief Get the driver statistics
+ * 
+ * @param stats Output for the statistics
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtio_blk_get_stats(virtio_blk_stats_t* stats);
+
+/**
+ * @brief Measure sequential and random read throughput
+ * 
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_blk_benchmark();
+
+#endif
@@ -0,0 +1,201 @@
+/*
+ * virtio_console.h - This file defines the virtio console driver. Each
+ * port of a multiport device is a separate host channel (chardev file or
+ * socket), producers copy into DMA buffers handed to the transmit queue
+ * and never wait for the host.
+ *
+ * Author: Fedi Nabli
+ * Date: 18 Oct 2026
+ * Last Modified: 18 Oct 2026
+ */
+
+#ifndef __SYNAPSE_VIRTIO_CONSOLE_H_
+#define __SYNAPSE_VIRTIO_CONSOLE_H_
+
+#include <synapse/bool.h>
+#include <synapse/types.h>
+
+#include <synapse/interrupts/interrupt.h>
+
+// Device specific feature bits
+#define VIRTIO_CONSOLE_F_SIZE      0 // Console size in the configuration
+#define VIRTIO_CONSOLE_F_MULTIPORT 1 // Several ports and a control queue pair
+
+// Ports driven, the device may offer more
+#define VIRTIO_CONSOLE_MAX_PORTS 8
+
+// Longest port name, with its terminator
+#define VIRTIO_CONSOLE_NAME_MAX 32
+
+// Transmit buffers per open port, each is filled then handed to the device
+#define VIRTIO_CONSOLE_TX_BUFFERS 8
+#define VIRTIO_CONSOLE_TX_BUFFER_SIZE (16 * 1024)
+
+// Control messages posted to or queued for the device
+#define VIRTIO_CONSOLE_CTRL_BUFFERS 8
+#define VIRTIO_CONSOLE_CTRL_BUFFER_SIZE 64
+
+// Port the binary trace, profile and benchmark data goes to
+#define VIRTIO_CONSOLE_TRACE_PORT "synapse.trace"
+
+// Control message events
+typedef enum
+{
+  VIRTIO_CONSOLE_DEVICE_READY = 0,  // Driver is ready for port announcements
+  VIRTIO_CONSOLE_DEVICE_ADD = 1,    // Device added a port
+  VIRTIO_CONSOLE_DEVICE_REMOVE = 2, // Device removed a port
+  VIRTIO_CONSOLE_PORT_READY = 3,    // Driver set up a port
+  VIRTIO_CONSOLE_CONSOLE_PORT = 4,  // Port is a text console
+  VIRTIO_CONSOLE_RESIZE = 5,        // Console size changed
+  VIRTIO_CONSOLE_PORT_OPEN = 6,     // Port opened, by the driver or the host
+  VIRTIO_CONSOLE_PORT_NAME = 7      // Port name follows the message
+} virtio_console_event_t;
+
+// Control message, on the control queue pair
+struct virtio_console_control
+{
+  uint32_t id;    // Port number
+  uint16_t event; // virtio_console_event_t
+  uint16_t value;
+};
+
+// Port counters
+typedef struct virtio_console_stats
+{
+  uint64_t writes;    // Producer calls
+  uint64_t bytes;     // Bytes accepted
+  uint64_t dropped;   // Bytes refused because every buffer was in flight
+  uint64_t buffers;   // Buffers handed to the device
+  uint64_t completed; // Buffers the device consumed
+} virtio_console_stats_t;
+
+/**
+ * @brief Find the first virtio console device, set it up and open the
+ * trace port if the host provides one
+ * 
+ * @return int EOK on success, -ENOENT if there is no device,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_init();
+
+/**
+ * @brief Check if a console device is ready
+ * 
+ * @return bool true if virtio_console_init() succeeded
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+bool virtio_console_present();
+
+/**
+ * @brief Find a port by the name the host gave it
+ * 
+ * @param name Port name (e.g. VIRTIO_CONSOLE_TRACE_PORT)
+ * @return int Port number, -ENOENT if there is no such port
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_find_port(const char* name);
+
+/**
+ * @brief Allocate the transmit buffers of a port and tell the host it
+ * is open
+ * 
+ * @param port Port number
+ * @return int EOK on success, -ENOENT if the device has no such port,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_open(uint32_t port);
+
+/**
+ * @brief Copy data to the transmit buffers of a port, never waits
+ * 
+ * Full buffers go to the device straight away, the last one stays until
+ * it fills or virtio_console_flush() is called. When every buffer is in
+ * flight the rest of the data is dropped and counted.
+ * 
+ * @param port Port number
+ * @param data Data
+ * @param size Size in bytes
+ * @return int Bytes accepted, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_write(uint32_t port, const void* data, size_t size);
+
+/**
+ * @brief Hand the partly filled buffer of a port to the device
+ * 
+ * @param port Port number
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_flush(uint32_t port);
+
+/**
+ * @brief Write to the trace port opened by virtio_console_init()
+ * 
+ * @param data Data
+ * @param size Size in bytes
+ * @return int Bytes accepted, -ENOENT if there is no trace port
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_trace_write(const void* data, size_t size);
+
+/**
+ * @brief Recycle the buffers the device consumed and handle control
+ * messages, for callers running with IRQs masked
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+void virtio_console_poll();
+
+/**
+ * @brief Console device interrupt handler
+ * 
+ * @param int_frame Interrupt frame
+ * @return int Handler result
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_irq_handler(struct interrupt_frame* int_frame);
+
+/**
+ * @brief Get the counters of a port
+ * 
+ * @param port Port number
+ * @param stats Output for the counters
+ * @return int EOK on success, negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_get_stats(uint32_t port, virtio_console_stats_t* stats);
+
+/**
+ * @brief Measure the throughput of the trace port against the PL011
+ * 
+ * @return int EOK on success, -ENOENT if there is no trace port,
+ * negative error code on failure
+ * 
+ * @author Fedi Nabli
+ * @date 18 Oct 2026
+ */
+int virtio_console_benchmark();
+
+#endif